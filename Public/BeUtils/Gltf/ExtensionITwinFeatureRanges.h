@@ -0,0 +1,45 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ExtensionITwinFeatureRanges.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <CesiumUtility/ExtensibleObject.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace BeUtils
+{
+	/**
+	 * @brief glTF extension storing the feature IDs of a primitive's vertices (_FEATURE_ID_0) as a
+	 * run-length table: it is computed by the GltfTuner in a worker thread, so that the game thread
+	 * can map features to vertices without reading the feature ID of each vertex.
+	 */
+	struct ExtensionITwinFeatureRanges final : public CesiumUtility::ExtensibleObject
+	{
+		static inline constexpr const char* TypeName = "ExtensionITwinFeatureRanges";
+		static inline constexpr const char* ExtensionName = "ITWIN_feature_ranges";
+
+		/**
+		 * @brief Consecutive vertices sharing the same feature ID.
+		 */
+		struct Range
+		{
+			int64_t featureId = -1;
+			uint32_t firstVertex = 0;
+			uint32_t vertexCount = 0;
+		};
+
+		/**
+		 * @brief Ranges in increasing order of vertex index. Vertices without a valid feature ID
+		 * (ie. negative) are not covered by any range.
+		 */
+		std::vector<Range> ranges;
+	};
+} // namespace BeUtils
@@ -44,6 +44,9 @@ public:
 		void SetColors(const std::vector<std::array<_T, _n>>& colors);
 		template<class _T>
 		void SetFeatureIds(const std::vector<std::array<_T, 1>>& featureIds, bool bShareBufferForMatIDs = false);
+		//! Attaches the run-length table of the feature IDs (see ExtensionITwinFeatureRanges).
+		template<class _T>
+		void SetFeatureRanges(const std::vector<std::array<_T, 1>>& featureIds);
 		void SetITwinMaterialID(uint64_t materialId);
 	private:
 		MeshPrimitive(GltfBuilder& builder, CesiumGltf::MeshPrimitive& primitive);
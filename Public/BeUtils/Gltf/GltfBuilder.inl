@@ -15,6 +15,9 @@
 #include <CesiumGltf/Accessor.h>
 #include <CesiumGltf/MeshPrimitive.h>
 #include <CesiumGltf/ExtensionExtMeshFeatures.h>
+#include <BeUtils/Gltf/ExtensionITwinFeatureRanges.h>
+#include <cmath>
+#include <type_traits>
 
 namespace BeUtils
 {
@@ -92,6 +95,34 @@ void GltfBuilder::MeshPrimitive::SetFeatureIds(const std::vector<std::array<_T,
 	}
 }
 
+template<class _T>
+void GltfBuilder::MeshPrimitive::SetFeatureRanges(const std::vector<std::array<_T, 1>>& featureIds)
+{
+	auto& ranges = primitive_.addExtension<BeUtils::ExtensionITwinFeatureRanges>().ranges;
+	ranges.clear();
+	for (size_t vertex = 0; vertex < featureIds.size(); ++vertex)
+	{
+		// Same conversion as CesiumGltf::FeatureIdFromAccessor, used by cesium-unreal to read feature IDs.
+		int64_t featureId;
+		if constexpr (std::is_floating_point_v<_T>)
+			featureId = static_cast<int64_t>(std::round(featureIds[vertex][0]));
+		else
+			featureId = static_cast<int64_t>(featureIds[vertex][0]);
+		if (featureId < 0)
+			continue;
+		if (!ranges.empty() && ranges.back().featureId == featureId
+			&& ranges.back().firstVertex + ranges.back().vertexCount == vertex)
+		{
+			++ranges.back().vertexCount;
+		}
+		else
+		{
+			ranges.push_back({ featureId, static_cast<uint32_t>(vertex), 1 });
+		}
+	}
+	ranges.shrink_to_fit();
+}
+
 template<class _T>
 int32_t GltfBuilder::AddBufferView(const std::vector<_T>& data, const std::optional<int32_t>& target)
 {
@@ -9,11 +9,14 @@
 #include <BeUtils/Gltf/GltfMaterialTuner.h>
 
 #include <BeUtils/Gltf/ExtensionITwinMaterial.h>
+#include <BeUtils/Gltf/TextureCache.h>
+#include <BeUtils/Misc/ImageKernels.h>
 #include <CesiumGltf/ExtensionKhrTextureTransform.h>
 #include <CesiumGltfContent/ImageManipulation.h>
 #include <CesiumGltfReader/GltfReader.h>
 
 #include <fstream>
+#include <optional>
 #include <spdlog/fmt/fmt.h>
 
 #include <SDK/Core/ITwinAPI/ITwinMaterial.inl>
@@ -122,11 +125,6 @@ namespace BeUtils
 	}
 
 
-#define RED_TO_BW_FACTOR	0.35f
-#define GREEN_TO_BW_FACTOR	0.50f
-#define BLUE_TO_BW_FACTOR	0.15f
-
-
 	using ReadImageResult = AdvViz::expected<
 		CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset>,
 		GenericFailureDetails>;
@@ -169,7 +167,18 @@ namespace BeUtils
 		return DecodeImageCesium(imageData, imageDesc);
 	}
 
-	static ReadImageResult GetImageCesium(GltfMaterialHelper::TextureAccess const& texAccess,
+	//! Source texture of a merge: either an already decoded image, or the encoded content (PNG/JPG) of the
+	//! texture, which only needs to be decoded if the merged texture is not found in the texture cache.
+	struct SourceImage
+	{
+		CesiumUtility::IntrusivePointer<CesiumGltf::ImageAsset> pDecoded;
+		std::vector<std::byte> encoded;
+		std::string desc;
+	};
+
+	using GetSourceImageResult = AdvViz::expected<SourceImage, GenericFailureDetails>;
+
+	static GetSourceImageResult GetSourceImage(GltfMaterialHelper::TextureAccess const& texAccess,
 		GltfMaterialHelper const& matHelper,
 		std::string_view const& channelName,
 		WLock const& lock)
@@ -179,11 +188,20 @@ namespace BeUtils
 		// can be freed at any time once transferred to the GPU, so we should *not* access it anymore.
 		if (texAccess.HasValidCesiumImage(true))
 		{
-			return texAccess.cesiumImage->pAsset;
+			return SourceImage{ .pDecoded = texAccess.cesiumImage->pAsset };
 		}
 		else if (!texAccess.filePath.empty())
 		{
-			return ReadImageCesium(texAccess.filePath, channelName);
+			SourceImage source;
+			source.desc = fmt::format("{} image from '{}'",
+				channelName, texAccess.filePath.generic_string());
+			source.encoded = ReadFileContent(texAccess.filePath);
+			if (source.encoded.empty())
+			{
+				return AdvViz::make_unexpected(GenericFailureDetails{
+					fmt::format("failed reading {}", source.desc) });
+			}
+			return source;
 		}
 		// If the texture can be reloaded (either from the decoration service or from packaged material
 		// library), do it now - else return an error.
@@ -191,13 +209,7 @@ namespace BeUtils
 		std::string imgError;
 		if (GltfMaterialTuner::LoadTextureBuffer(texAccess.texKey, matHelper, lock, cesiumBuffer, imgError))
 		{
-			CesiumGltf::Image image;
-			auto loadResult = GltfMaterialTuner::LoadImageCesium(image, cesiumBuffer, texAccess.texKey.id);
-			if (!loadResult)
-			{
-				return AdvViz::make_unexpected(loadResult.error());
-			}
-			return image.pAsset;
+			return SourceImage{ .encoded = std::move(cesiumBuffer), .desc = texAccess.texKey.id };
 		}
 
 		if (imgError.empty())
@@ -221,6 +233,110 @@ namespace BeUtils
 		return AdvViz::make_unexpected(GenericFailureDetails{ imgError });
 	}
 
+	static ReadImageResult DecodeSourceImage(SourceImage const& source)
+	{
+		if (source.pDecoded)
+		{
+			return source.pDecoded;
+		}
+		return DecodeImageCesium(source.encoded, source.desc);
+	}
+
+	/// Add the content of the source image to the key of a merged texture in the texture cache.
+	static void HashSourceImage(SourceImage const& source, TextureCache::KeyBuilder& keyBuilder)
+	{
+		keyBuilder.Add(static_cast<bool>(source.pDecoded));
+		if (source.pDecoded)
+		{
+			auto const& img(*source.pDecoded);
+			keyBuilder.Add(img.width).Add(img.height).Add(img.channels).Add(img.bytesPerChannel)
+				.Add(img.pixelData.data(), img.pixelData.size());
+		}
+		else
+		{
+			keyBuilder.Add(uint64_t(source.encoded.size()))
+				.Add(source.encoded.data(), source.encoded.size());
+		}
+	}
+
+	static ReadImageResult GetImageCesium(GltfMaterialHelper::TextureAccess const& texAccess,
+		GltfMaterialHelper const& matHelper,
+		std::string_view const& channelName,
+		WLock const& lock)
+	{
+		auto sourceResult = GetSourceImage(texAccess, matHelper, channelName, lock);
+		if (!sourceResult)
+		{
+			return AdvViz::make_unexpected(sourceResult.error());
+		}
+		return DecodeSourceImage(*sourceResult);
+	}
+
+
+	namespace
+	{
+		/// Increment this when the merge or the resampling of textures changes, to invalidate the textures
+		/// cached by previous versions.
+		/// 2: fixed-point intensity and box-filtered thumbnails (see ImageKernels).
+		constexpr uint32_t MERGED_TEXTURE_CACHE_VERSION = 2;
+
+		/// Flag stored with merged textures in the texture cache.
+		constexpr uint32_t MERGED_TEXTURE_NEEDS_TRANSLUCENCY = 1;
+
+		inline std::shared_ptr<TextureCache> GetMergedTextureCache(GltfMaterialHelper const& matHelper,
+			RWLockBase const& lock)
+		{
+			// Merged textures are cached in the per model texture directory.
+			return TextureCache::Get(matHelper.GetTextureDirectory(lock) / "merged");
+		}
+
+		/// Return the cached merged texture for the given key, if any.
+		std::optional<GltfMaterialTuner::FormatTextureResultData> FindMergedTexture(TextureCache& cache,
+			TextureCache::Key key,
+			uint32_t& flags)
+		{
+			auto const entry = cache.Find(key);
+			if (!entry)
+			{
+				return std::nullopt;
+			}
+			auto imgResult = ReadImageCesium(entry->filePath, "merged");
+			if (!imgResult)
+			{
+				BE_LOGW("ITwinMaterial", "discarding cached texture: " << imgResult.error().message);
+				cache.Remove(key);
+				return std::nullopt;
+			}
+			flags = entry->flags;
+			CesiumGltf::Image image;
+			image.pAsset = *imgResult;
+			return GltfMaterialTuner::FormatTextureResultData{ entry->filePath, std::move(image) };
+		}
+
+		/// Save the merged texture to PNG in the texture cache.
+		GltfMaterialTuner::FormatTextureResult StoreMergedTexture(TextureCache& cache,
+			TextureCache::Key key,
+			CesiumGltf::Image&& image,
+			uint32_t flags)
+		{
+			using namespace CesiumGltfContent;
+
+			BE_ASSERT(image.pAsset && !image.pAsset->pixelData.empty());
+			auto const pngOutData = ImageManipulation::savePng(*image.pAsset);
+			if (pngOutData.empty())
+			{
+				return AdvViz::make_unexpected(GenericFailureDetails{ "failed formatting PNG image" });
+			}
+			auto const filePath = cache.Store(key, pngOutData, flags);
+			if (!filePath)
+			{
+				return AdvViz::make_unexpected(GenericFailureDetails{
+					fmt::format("failed writing image content to '{}'", cache.GetDirectory().generic_string()) });
+			}
+			return GltfMaterialTuner::FormatTextureResultData{ *filePath, std::move(image) };
+		}
+	}
+
 
 	static GltfMaterialTuner::SaveCesiumImageResult SaveImageCesiumIfNeeded(
 		CesiumGltf::Image const& targetImg,
@@ -282,27 +398,26 @@ namespace BeUtils
 	}
 
 	GltfMaterialTuner::FormatTextureResult GltfMaterialTuner::MergeColorAlphaFilesImpl(
-		GltfMaterialHelper::TextureAccess const& colorTexture,
-		GltfMaterialHelper::TextureAccess const& alphaTexture,
-		bool& isTranslucencyNeeded,
-		WLock const& lock) const
+		SourceImage const* colorSource,
+		SourceImage const& alphaSource,
+		bool& isTranslucencyNeeded) const
 	{
 		using namespace CesiumGltfReader;
 		using namespace CesiumGltfContent;
 
 		isTranslucencyNeeded = false;
 
-		bool const hasColorTexture = colorTexture.IsValid();
+		bool const hasColorTexture = (colorSource != nullptr);
 		ReadImageResult colorImageResult;
 		if (hasColorTexture)
 		{
-			colorImageResult = GetImageCesium(colorTexture, *materialHelper_, "color", lock);
+			colorImageResult = DecodeSourceImage(*colorSource);
 			if (!colorImageResult)
 			{
 				return AdvViz::make_unexpected(colorImageResult.error());
 			}
 		}
-		ReadImageResult alphaImageResult = GetImageCesium(alphaTexture, *materialHelper_, "opacity", lock);
+		ReadImageResult alphaImageResult = DecodeSourceImage(alphaSource);
 		if (!alphaImageResult)
 		{
 			return AdvViz::make_unexpected(alphaImageResult.error());
@@ -348,8 +463,6 @@ namespace BeUtils
 		targetImg.pixelData.resize(static_cast<size_t>(
 			nbPixels * targetImg.channels * targetImg.bytesPerChannel), defaultPixComponent);
 
-		CesiumGltf::ImageAsset targetAlphaImg = targetImg;
-
 		// Resize color and alpha to the final size
 		if (hasColorTexture)
 		{
@@ -367,35 +480,34 @@ namespace BeUtils
 			// targetImg has already the good size, and was filled with white pixels => nothing more to do
 		}
 
-		if (!ImageManipulation::blitImage(targetAlphaImg,
-			{ 0, 0, targetImg.width, targetImg.height },
-			alphaImg,
-			{ 0, 0, alphaImg.width, alphaImg.height }))
+		// The alpha image is only copied if it needs resizing.
+		CesiumGltf::ImageAsset resizedAlphaImg;
+		bool const needAlphaResizing = alphaImg.width != targetImg.width
+			|| alphaImg.height != targetImg.height;
+		if (needAlphaResizing)
 		{
-			return AdvViz::make_unexpected(GenericFailureDetails{ "could not blit source alpha image" });
+			resizedAlphaImg = targetImg;
+			if (!ImageManipulation::blitImage(resizedAlphaImg,
+				{ 0, 0, targetImg.width, targetImg.height },
+				alphaImg,
+				{ 0, 0, alphaImg.width, alphaImg.height }))
+			{
+				return AdvViz::make_unexpected(GenericFailureDetails{ "could not blit source alpha image" });
+			}
 		}
+		auto const& actualAlphaImg = needAlphaResizing ? resizedAlphaImg : alphaImg;
 
 		// Only 8-bit supported by Cesium image reader (if an update allows 16-bit in the future, then we
-		// need to adapt the code in the loop on pixels, below)
+		// need to adapt the image kernels, below)
 		BE_ASSERT(targetImg.bytesPerChannel == 1);
 
-		// Then just copy alpha
-		std::byte* pTargetAlphaByte = targetImg.pixelData.data() + 3;
-		std::byte const* pSrcAlphaBytes = targetAlphaImg.pixelData.data();
-		int32_t const offsetPerPix = targetImg.channels * targetImg.bytesPerChannel;
-		for (int32_t pix(0); pix < nbPixels; ++pix)
-		{
-			float const fAlphaByte = RED_TO_BW_FACTOR * static_cast<float>(pSrcAlphaBytes[0])
-				+ GREEN_TO_BW_FACTOR * static_cast<float>(pSrcAlphaBytes[1])
-				+ BLUE_TO_BW_FACTOR * static_cast<float>(pSrcAlphaBytes[2]);
-			*pTargetAlphaByte = static_cast<std::byte>(std::clamp(fAlphaByte, 0.f, 255.f));
+		// Then just copy alpha (intensity of the alpha map)
+		ImageKernels::ExtractIntensity(targetImg.pixelData.data(), 3 /*A*/,
+			actualAlphaImg.pixelData.data(), static_cast<size_t>(nbPixels));
 
-			// Translucency will be required in Unreal material as soon as we have not a pure mask.
-			isTranslucencyNeeded = isTranslucencyNeeded || (fAlphaByte > 0.5f && fAlphaByte < 254.5f);
-
-			pTargetAlphaByte += offsetPerPix;
-			pSrcAlphaBytes += offsetPerPix;
-		}
+		// Translucency will be required in Unreal material as soon as we have not a pure mask.
+		isTranslucencyNeeded = ImageKernels::HasPartialAlpha(targetImg.pixelData.data(),
+			static_cast<size_t>(nbPixels), ImageKernels::EAlphaSource::AlphaChannel);
 		return GltfMaterialTuner::FormatTextureResultData{
 			std::filesystem::path{},
 			std::move(outImage)
@@ -416,6 +528,7 @@ namespace BeUtils
 		{
 			GltfMaterialHelper::TextureAccess srcTexAccess = {};
 			MergeImageInput const chanInfo = {};
+			SourceImage source = {}; // filled by GetSourceImages
 		};
 		// We are limited by R,G,B,A channels in target texture, so we will never have more than 4 entries
 		using EntryVec = boost::container::small_vector<Entry, 4>;
@@ -451,14 +564,42 @@ namespace BeUtils
 			return true;
 		}
 
+		//! Fetch the content of all source textures.
+		AdvViz::expected<bool, GenericFailureDetails> GetSourceImages(GltfMaterialHelper const& materialHelper,
+			WLock const& lock)
+		{
+			for (auto& entry : entries_)
+			{
+				auto sourceResult = GetSourceImage(entry.srcTexAccess,
+					materialHelper,
+					AdvViz::SDK::GetChannelName(entry.chanInfo.materialChannel),
+					lock);
+				if (!sourceResult)
+				{
+					return AdvViz::make_unexpected(sourceResult.error());
+				}
+				entry.source = std::move(*sourceResult);
+			}
+			return true;
+		}
+
+		//! Add the merge parameters and the content of all source textures to the cache key.
+		void AddToCacheKey(TextureCache::KeyBuilder& keyBuilder) const
+		{
+			keyBuilder.Add(uint64_t(entries_.size()));
+			for (auto const& entry : entries_)
+			{
+				keyBuilder.Add(entry.chanInfo.matChannelShortPrefix).Add(entry.chanInfo.rgbaChan);
+				HashSourceImage(entry.source, keyBuilder);
+			}
+		}
+
 	private:
 		EntryVec entries_;
 	};
 
 	GltfMaterialTuner::FormatTextureResult GltfMaterialTuner::MergeIntensityChannelsImpl(
-		MergeImageInputArray const& srcTextures,
-		std::filesystem::path const& outputTexPath,
-		WLock const& lock) const
+		MergeImageInputArray const& srcTextures) const
 	{
 		using namespace CesiumGltfReader;
 		using namespace CesiumGltfContent;
@@ -478,10 +619,7 @@ namespace BeUtils
 		ImageWithInfoVec imagesWithInfo;
 		for (auto const& inputData : srcTextures.GetData())
 		{
-			auto imgResult = GetImageCesium(inputData.srcTexAccess,
-				*materialHelper_,
-				AdvViz::SDK::GetChannelName(inputData.chanInfo.materialChannel),
-				lock);
+			auto imgResult = DecodeSourceImage(inputData.source);
 			if (!imgResult)
 			{
 				return AdvViz::make_unexpected(imgResult.error());
@@ -537,25 +675,14 @@ namespace BeUtils
 			auto const& actualSrcImage = needResizing ? resizedSrcImage : srcImage;
 
 			// Only 8-bit supported by Cesium image reader (if an update allows 16-bit in the future, then we
-			// should adapt the code in the loop on pixels, below)
+			// should adapt the image kernels, below)
 			BE_ASSERT(targetImg.bytesPerChannel == 1);
 
 			// Then extract intensity and copy it to the appropriate pixel component
 			// ImageCesium uses the order R,G,B,A, which matches our enum AdvViz::SDK::ETextureChannel and thus
 			// allows to write this:
-			std::byte* pTargetByte = targetImg.pixelData.data() + static_cast<size_t>(chanInfo.rgbaChan);
-			std::byte const* pSrcBytes = actualSrcImage.pixelData.data();
-			int32_t const offsetPerPix = targetImg.channels * targetImg.bytesPerChannel;
-			for (int32_t pix(0); pix < nbPixels; ++pix)
-			{
-				float const fIntensByte = RED_TO_BW_FACTOR * static_cast<float>(pSrcBytes[0])
-					+ GREEN_TO_BW_FACTOR * static_cast<float>(pSrcBytes[1])
-					+ BLUE_TO_BW_FACTOR * static_cast<float>(pSrcBytes[2]);
-				*pTargetByte = static_cast<std::byte>(std::clamp(fIntensByte, 0.f, 255.f));
-
-				pTargetByte += offsetPerPix;
-				pSrcBytes += offsetPerPix;
-			}
+			ImageKernels::ExtractIntensity(targetImg.pixelData.data(), static_cast<unsigned>(chanInfo.rgbaChan),
+				actualSrcImage.pixelData.data(), static_cast<size_t>(nbPixels));
 			return true;
 		};
 
@@ -568,15 +695,8 @@ namespace BeUtils
 			}
 		}
 
-		// Save the merged texture to PNG if needed.
-		auto const saveImgOpt = SaveImageCesiumIfNeeded(outImage, outputTexPath);
-		if (!saveImgOpt)
-		{
-			return AdvViz::make_unexpected(saveImgOpt.error());
-		}
-
 		return GltfMaterialTuner::FormatTextureResultData{
-			outputTexPath,
+			std::filesystem::path{},
 			std::move(outImage)
 		};
 	}
@@ -608,6 +728,18 @@ namespace BeUtils
 		}
 	}
 
+	/*static*/
+	std::filesystem::path GltfMaterialTuner::thumbnailCacheDir_;
+	/*static*/
+	std::mutex GltfMaterialTuner::thumbnailCacheMutex_;
+
+	/*static*/
+	void GltfMaterialTuner::SetThumbnailCacheDirectory(std::filesystem::path const& cacheDir)
+	{
+		std::unique_lock<std::mutex> lock(thumbnailCacheMutex_);
+		thumbnailCacheDir_ = cacheDir;
+	}
+
 	/*static*/
 	GltfMaterialTuner::LoadCesiumImageResult
 	GltfMaterialTuner::ResampleTextureBuffer(
@@ -623,6 +755,31 @@ namespace BeUtils
 			return AdvViz::make_unexpected(GenericFailureDetails{ "wrong desired size" });
 		}
 
+		std::filesystem::path thumbnailCacheDir;
+		{
+			std::unique_lock<std::mutex> lock(thumbnailCacheMutex_);
+			thumbnailCacheDir = thumbnailCacheDir_;
+		}
+		std::shared_ptr<TextureCache> const cache = thumbnailCacheDir.empty()
+			? nullptr : TextureCache::Get(thumbnailCacheDir);
+		TextureCache::Key cacheKey = 0;
+		if (cache)
+		{
+			cacheKey = TextureCache::KeyBuilder()
+				.Add("thumbnail").Add(MERGED_TEXTURE_CACHE_VERSION).Add(desiredSize)
+				.Add(fullSizeCesiumBuffer.data(), fullSizeCesiumBuffer.size())
+				.Get();
+			if (auto const entry = cache->Find(cacheKey))
+			{
+				thumbnailCesiumBuffer = ReadFileContent(entry->filePath);
+				if (!thumbnailCesiumBuffer.empty())
+				{
+					return true;
+				}
+				cache->Remove(cacheKey);
+			}
+		}
+
 		// Note that the input buffer should correspond to a format supported by Cesium (PNG/JPG)
 		CesiumGltf::Image image;
 		auto loadResult = LoadImageCesium(image, fullSizeCesiumBuffer, contextInfo);
@@ -653,7 +810,14 @@ namespace BeUtils
 		targetImg.pixelData.resize(static_cast<size_t>(
 			targetImg.width * targetImg.height * targetImg.channels * targetImg.bytesPerChannel), std::byte(255));
 
-		if (!ImageManipulation::blitImage(targetImg,
+		if (srcImage.channels == 4 && srcImage.bytesPerChannel == 1)
+		{
+			// Box filter followed by a bilinear filter: unlike a plain bilinear resampling, all source
+			// pixels contribute to the thumbnail.
+			ImageKernels::Downsample(targetImg.pixelData.data(), targetImg.width, targetImg.height,
+				srcImage.pixelData.data(), srcImage.width, srcImage.height);
+		}
+		else if (!ImageManipulation::blitImage(targetImg,
 			{ 0, 0, targetImg.width, targetImg.height },
 			srcImage,
 			{ 0, 0, srcImage.width, srcImage.height }))
@@ -665,6 +829,10 @@ namespace BeUtils
 		{
 			return AdvViz::make_unexpected(GenericFailureDetails{ "failed formatting PNG thumbnail" });
 		}
+		if (cache)
+		{
+			cache->Store(cacheKey, thumbnailCesiumBuffer);
+		}
 		return true;
 	}
 
@@ -772,68 +940,61 @@ namespace BeUtils
 		bool& needTranslucentMat,
 		WLock const& lock)
 	{
-		bool const hasColorTexture = colorTex.HasTexture();
-
-		// Test if the merged texture already exists locally. If not, create it now.
-		std::size_t const hashTex1 = hasColorTexture ? std::hash<std::string>()(colorTex.texture) : 0;
-		std::size_t const hashTex2 = std::hash<std::string>()(alphaTex.texture);
-		std::string const basename_MergedTex = fmt::format("c_{0:#x}-a_{1:#x}", hashTex1, hashTex2);
-		std::string const basename_MergedTex_masked = basename_MergedTex + "_masked.png";
-		std::string const basename_MergedTex_blend = basename_MergedTex + "_blend.png";
-
-		auto const textureDir = materialHelper_->GetTextureDirectory(lock); // per model texture cache
-		std::filesystem::path const mergedTexturePath_masked = textureDir / basename_MergedTex_masked;
-		std::filesystem::path const mergedTexturePath_blend = textureDir / basename_MergedTex_blend;
-
-#if 0
-		std::error_code ec;
-		bool const hasCachedMergedTex_masked = std::filesystem::exists(mergedTexturePath_masked, ec);
-		bool const hasCachedMergedTex_blend = std::filesystem::exists(mergedTexturePath_blend, ec);
-		// Normally, the alpha texture should be either masked or translucent, but since we use a hash of the
-		// filename, the case could happen... Also, if the user edits the alpha texture file without renaming
-		// it, we could also switch from one type to the other, and thus get the 2 versions here.
-		BE_ASSERT(!(hasCachedMergedTex_masked && hasCachedMergedTex_blend), "2 alpha names with same hash?");
-		if (hasCachedMergedTex_masked)
+		GltfMaterialHelper::TextureAccess const alphaTexAccess = materialHelper_->GetTextureAccess(alphaTex, lock);
+		if (!alphaTexAccess.IsValid())
 		{
-			needTranslucentMat = false;
-			return mergedTexturePath_masked;
+			return AdvViz::make_unexpected(GenericFailureDetails{ "no alpha texture to merge" });
 		}
-		else if (hasCachedMergedTex_blend)
+		std::optional<SourceImage> colorSource;
+		if (colorTex.HasTexture())
 		{
-			needTranslucentMat = true;
-			return mergedTexturePath_blend;
+			GltfMaterialHelper::TextureAccess const colorTexAccess = materialHelper_->GetTextureAccess(colorTex, lock);
+			if (colorTexAccess.IsValid())
+			{
+				auto colorResult = GetSourceImage(colorTexAccess, *materialHelper_, "color", lock);
+				if (!colorResult)
+				{
+					return AdvViz::make_unexpected(colorResult.error());
+				}
+				colorSource = std::move(*colorResult);
+			}
+		}
+		auto const alphaResult = GetSourceImage(alphaTexAccess, *materialHelper_, "opacity", lock);
+		if (!alphaResult)
+		{
+			return AdvViz::make_unexpected(alphaResult.error());
 		}
-#endif
 
-		// Actually create a new texture now, merging color (if any) and alpha
-		GltfMaterialHelper::TextureAccess const emptyAccess;
-		GltfMaterialHelper::TextureAccess const colorTexAccess = hasColorTexture
-			? materialHelper_->GetTextureAccess(colorTex, lock)
-			: emptyAccess;
-		GltfMaterialHelper::TextureAccess const alphaTexAccess = materialHelper_->GetTextureAccess(alphaTex, lock);
-		if (!alphaTexAccess.IsValid())
+		// Test if the merged texture already exists locally. Its key depends on the content of the source
+		// textures (and not on their names), so that it is still valid in a later session unless one of
+		// the source files has been edited.
+		TextureCache::KeyBuilder keyBuilder;
+		keyBuilder.Add("color-alpha").Add(MERGED_TEXTURE_CACHE_VERSION).Add(colorSource.has_value());
+		if (colorSource)
 		{
-			return AdvViz::make_unexpected(GenericFailureDetails{ "no alpha texture to merge" });
+			HashSourceImage(*colorSource, keyBuilder);
 		}
-		auto const mergeRes = MergeColorAlphaFilesImpl(colorTexAccess, alphaTexAccess, needTranslucentMat, lock);
-		if (!mergeRes)
+		HashSourceImage(*alphaResult, keyBuilder);
+		TextureCache::Key const cacheKey = keyBuilder.Get();
+
+		auto const cache = GetMergedTextureCache(*materialHelper_, lock);
+		uint32_t cachedFlags = 0;
+		if (auto cachedTexture = FindMergedTexture(*cache, cacheKey, cachedFlags))
 		{
-			return AdvViz::make_unexpected(mergeRes.error());
+			// The alpha mode depends only on the source alpha map content, so it is cached as well.
+			needTranslucentMat = (cachedFlags & MERGED_TEXTURE_NEEDS_TRANSLUCENCY) != 0;
+			return std::move(*cachedTexture);
 		}
-		// The output file path will depend on the alpha mode (this is done like this to avoid having to
-		// store this information (which depends only on the source alpha map content) elsewhere.
-		std::filesystem::path const mergedTexturePath =
-			needTranslucentMat ? mergedTexturePath_blend : mergedTexturePath_masked;
 
-		auto const saveImgOpt = SaveImageCesiumIfNeeded(mergeRes->cesiumImage, mergedTexturePath);
-		if (!saveImgOpt)
+		// Actually create a new texture now, merging color (if any) and alpha
+		auto mergeRes = MergeColorAlphaFilesImpl(colorSource ? &*colorSource : nullptr, *alphaResult,
+			needTranslucentMat);
+		if (!mergeRes)
 		{
-			return AdvViz::make_unexpected(saveImgOpt.error());
+			return AdvViz::make_unexpected(mergeRes.error());
 		}
-		return GltfMaterialTuner::FormatTextureResultData{
-			mergedTexturePath,
-			std::move(mergeRes->cesiumImage)
-		};
+		return StoreMergedTexture(*cache, cacheKey, std::move(mergeRes->cesiumImage),
+			needTranslucentMat ? MERGED_TEXTURE_NEEDS_TRANSLUCENCY : 0u);
 	}
 
 
@@ -855,30 +1016,39 @@ namespace BeUtils
 		AdvViz::SDK::ITwinChannelMap const& tex2, MergeImageInput const& chanInfo2,
 		WLock const& lock)
 	{
-		bool const hasTexture1 = tex1.HasTexture();
-		bool const hasTexture2 = tex2.HasTexture();
-
-		// Test if the merged texture already exists locally. If not, create it now.
-		std::size_t const tex1_hash = hasTexture1 ? std::hash<std::string>()(tex1.texture) : 0;
-		std::size_t const tex2_hash = hasTexture2 ? std::hash<std::string>()(tex2.texture) : 0;
-		std::string const basename_MergedTex = fmt::format("{0}_{1:#x}-{2}_{3:#x}.png",
-			chanInfo1.matChannelShortPrefix, tex1_hash,
-			chanInfo2.matChannelShortPrefix, tex2_hash);
+		MergeImageInputArray srcTextures;
+		srcTextures.AddSourceTexture(tex1, chanInfo1, *materialHelper_, lock);
+		srcTextures.AddSourceTexture(tex2, chanInfo2, *materialHelper_, lock);
+		if (srcTextures.GetData().empty())
+		{
+			return AdvViz::make_unexpected(GenericFailureDetails{ "no textures to merge" });
+		}
+		auto const sourcesResult = srcTextures.GetSourceImages(*materialHelper_, lock);
+		if (!sourcesResult)
+		{
+			return AdvViz::make_unexpected(sourcesResult.error());
+		}
 
-		auto const textureDir = materialHelper_->GetTextureDirectory(lock); // per model texture cache
-		std::filesystem::path const mergedTexturePath = textureDir / basename_MergedTex;
+		// Test if the merged texture already exists locally (see MergeColorAlpha).
+		TextureCache::KeyBuilder keyBuilder;
+		keyBuilder.Add("intensity").Add(MERGED_TEXTURE_CACHE_VERSION);
+		srcTextures.AddToCacheKey(keyBuilder);
+		TextureCache::Key const cacheKey = keyBuilder.Get();
 
-		//std::error_code ec;
-		//if (std::filesystem::exists(mergedTexturePath, ec))
-		//{
-		//	return mergedTexturePath;
-		//}
+		auto const cache = GetMergedTextureCache(*materialHelper_, lock);
+		uint32_t cachedFlags = 0;
+		if (auto cachedTexture = FindMergedTexture(*cache, cacheKey, cachedFlags))
+		{
+			return std::move(*cachedTexture);
+		}
 
 		// Actually create a new texture now, merging the one or two channels.
-		MergeImageInputArray srcTextures;
-		srcTextures.AddSourceTexture(tex1, chanInfo1, *materialHelper_, lock);
-		srcTextures.AddSourceTexture(tex2, chanInfo2, *materialHelper_, lock);
-		return MergeIntensityChannelsImpl(srcTextures, mergedTexturePath, lock);
+		auto mergeRes = MergeIntensityChannelsImpl(srcTextures);
+		if (!mergeRes)
+		{
+			return AdvViz::make_unexpected(mergeRes.error());
+		}
+		return StoreMergedTexture(*cache, cacheKey, std::move(mergeRes->cesiumImage), 0);
 	}
 
 	GltfMaterialTuner::FormatTextureResult GltfMaterialTuner::MergeMetallicRoughness(
@@ -1418,41 +1588,14 @@ namespace BeUtils
 				BE_LOGE("ITwinMaterial", "cannot compute blend mode from empty cesium image");
 				return false;
 			}
-			int32_t const nbPixels = cesiumImg.width * cesiumImg.height;
-			int32_t const offsetPerPix = cesiumImg.channels * cesiumImg.bytesPerChannel;
-
-			if (channel == AdvViz::SDK::EChannelType::Color)
-			{
-				// Iterate on the alpha channel of the pixels.
-				std::byte const* pAlphaByte = cesiumImg.pixelData.data() + 3;
-				for (int32_t pix(0); pix < nbPixels; ++pix)
-				{
-					uint8_t const alpha = static_cast<uint8_t>(*pAlphaByte); // no '<' or '>' with std::byte
-					if (alpha > 0 && alpha < 255)
-					{
-						return true;
-					}
-					pAlphaByte += offsetPerPix;
-				}
-				return false;
-			}
-			else
-			{
-				std::byte const* pBytes = cesiumImg.pixelData.data();
-				for (int32_t pix(0); pix < nbPixels; ++pix)
-				{
-					float const fAlphaByte = RED_TO_BW_FACTOR * static_cast<float>(pBytes[0])
-						+ GREEN_TO_BW_FACTOR * static_cast<float>(pBytes[1])
-						+ BLUE_TO_BW_FACTOR * static_cast<float>(pBytes[2]);
-					// Translucency will be required in Unreal material as soon as we have not a pure mask.
-					if (fAlphaByte > 0.5f && fAlphaByte < 254.5f)
-					{
-						return true;
-					}
-					pBytes += offsetPerPix;
-				}
-				return false;
-			}
+			size_t const nbPixels = static_cast<size_t>(cesiumImg.width) * cesiumImg.height;
+
+			// For color textures, alpha is read in the alpha channel of the pixels. Else, we have an opacity
+			// map, and translucency will be required in Unreal material as soon as we have not a pure mask.
+			return ImageKernels::HasPartialAlpha(cesiumImg.pixelData.data(), nbPixels,
+				channel == AdvViz::SDK::EChannelType::Color
+					? ImageKernels::EAlphaSource::AlphaChannel
+					: ImageKernels::EAlphaSource::Intensity);
 		}
 	}
 
@@ -17,6 +17,7 @@
 #include <SDK/Core/Tools/Error.h>
 
 #include <functional>
+#include <mutex>
 
 
 namespace BeUtils
@@ -31,6 +32,7 @@ namespace BeUtils
 	};
 
 	struct MergeImageInput;
+	struct SourceImage;
 
 
 	//! Class used during the tuning a glTF model.
@@ -105,12 +107,16 @@ namespace BeUtils
 			std::vector<std::byte>& cesiumBuffer,
 			std::string& strError);
 
+		//! Computes a reduced version of the given image (PNG/JPG), encoded as PNG. If a thumbnail cache
+		//! directory was set, thumbnails are cached there, keyed by the content of the full size image.
 		static LoadCesiumImageResult ResampleTextureBuffer(
 			std::vector<std::byte> const& fullSizeCesiumBuffer,
 			std::vector<std::byte>& thumbnailCesiumBuffer,
 			uint32_t desiredSize,
 			std::string const& contextInfo);
 
+		static void SetThumbnailCacheDirectory(std::filesystem::path const& cacheDir);
+
 	protected:
 		//! Merge color (if any) and alpha textures into one single texture, and return the resulting image
 		//! path (or an error).
@@ -149,10 +155,9 @@ namespace BeUtils
 			RLock const& lock);
 
 		FormatTextureResult MergeColorAlphaFilesImpl(
-			GltfMaterialHelper::TextureAccess const& colorTexture,
-			GltfMaterialHelper::TextureAccess const& alphaTexture,
-			bool& isTranslucencyNeeded,
-			WLock const& lock) const;
+			SourceImage const* colorSource,
+			SourceImage const& alphaSource,
+			bool& isTranslucencyNeeded) const;
 
 		//! Generic merge method between one or two intensity channels.
 		FormatTextureResult MergeIntensityChannels(
@@ -162,9 +167,7 @@ namespace BeUtils
 
 		class MergeImageInputArray;
 		FormatTextureResult MergeIntensityChannelsImpl(
-			MergeImageInputArray const& srcTextures,
-			std::filesystem::path const& outputTexPath,
-			WLock const& lock) const;
+			MergeImageInputArray const& srcTextures) const;
 
 		int32_t MergeMetallicRoughnessTextures(AdvViz::SDK::ITwinChannelMap const& metallicTex,
 			AdvViz::SDK::ITwinChannelMap const& roughnessTex,
@@ -219,6 +222,11 @@ namespace BeUtils
 		// External function to load texture bytes (not in BeUtils as it may need to rely on a specific file
 		// system like in Unreal...)
 		static LoadTextureBufferFunc loadTextureBufferFunc_;
+
+		// Where ResampleTextureBuffer caches its thumbnails (no cache if empty). Read by worker threads,
+		// hence guarded by thumbnailCacheMutex_.
+		static std::filesystem::path thumbnailCacheDir_;
+		static std::mutex thumbnailCacheMutex_;
 	};
 
 
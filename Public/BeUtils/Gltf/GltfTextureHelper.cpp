@@ -22,19 +22,19 @@ namespace BeUtils
 {
 
 
-	bool DownloadTexture(std::string const& textureURI,
+	CesiumAsync::Future<bool> DownloadTextureAsync(std::string const& textureURI,
 		std::shared_ptr<std::string const> const& accessToken,
 		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
 		CesiumAsync::AsyncSystem const& asyncSystem,
-		std::function<bool(std::vector<uint8_t> const&)>&& inCallback)
+		TextureBufferCallback&& inCallback)
 	{
 		if (textureURI.empty())
 		{
-			return false;
+			return asyncSystem.createResolvedFuture(false);
 		}
 		if (!accessToken || accessToken->empty())
 		{
-			return false;
+			return asyncSystem.createResolvedFuture(false);
 		}
 
 		std::vector<CesiumAsync::IAssetAccessor::THeader> const tHeaders =
@@ -45,33 +45,35 @@ namespace BeUtils
 			}
 		};
 
-		bool bSuccess = false;
-		std::string strError;
-		// This call should be very fast, as the image, if available, is already in Cesium cache.
-		// And since we test TexAccess.cesiumImage before coming here, we *know* that the image is indeed
-		// available.
-		pAssetAccessor
+		return pAssetAccessor
 			->get(asyncSystem, textureURI, tHeaders)
-			.thenImmediately([&bSuccess, callback = std::move(inCallback)](
+			.thenImmediately([callback = std::move(inCallback)](
 				std::shared_ptr<CesiumAsync::IAssetRequest>&& pRequest) {
 			const CesiumAsync::IAssetResponse* pResponse = pRequest->response();
-			if (pResponse) {
-				const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(pResponse->data().data());
-				std::vector<uint8_t> buffer;
-				buffer.assign(dataPtr, dataPtr + pResponse->data().size());
-				bSuccess = callback(buffer);
-			}
-		}).catchImmediately([&strError](std::exception&& e) {
-			strError = e.what();
-		}).wait();
-
-		if (!strError.empty())
-		{
+			if (!pResponse)
+				return false;
+			// Pass the data of the response as is (no copy).
+			auto const responseData = pResponse->data();
+			return callback(std::span<uint8_t const>(
+				reinterpret_cast<const uint8_t*>(responseData.data()), responseData.size()));
+		}).catchImmediately([textureURI](std::exception&& e) {
 			BE_LOGE("ITwinDecoration", "Exception while retrieving texture from '"
-				<< textureURI << "': " << strError);
-		}
-		return bSuccess;
+				<< textureURI << "': " << e.what());
+			return false;
+		});
+	}
 
+	bool DownloadTexture(std::string const& textureURI,
+		std::shared_ptr<std::string const> const& accessToken,
+		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+		CesiumAsync::AsyncSystem const& asyncSystem,
+		TextureBufferCallback&& inCallback)
+	{
+		// This call should be very fast, as the image, if available, is already in Cesium cache.
+		// And since we test TexAccess.cesiumImage before coming here, we *know* that the image is indeed
+		// available.
+		return DownloadTextureAsync(textureURI, accessToken, pAssetAccessor, asyncSystem,
+			std::move(inCallback)).wait();
 	}
 
 
@@ -124,26 +126,8 @@ namespace BeUtils
 
 	}
 
-	void ResolveTexturesMatchingSource(
-		AdvViz::SDK::ETextureSource TexSource,
-		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
-		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
-		std::map<std::string, GltfMaterialHelperPtr> const& imodelToMatHelper,
-		std::shared_ptr<std::string const> const& accessToken,
-		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
-		CesiumAsync::AsyncSystem const& asyncSystem,
-		WLock const* pLock /*= nullptr*/)
+	namespace
 	{
-		BE_ASSERT(TexSource == AdvViz::SDK::ETextureSource::Decoration
-			|| TexSource == AdvViz::SDK::ETextureSource::Library);
-
-		// Download decoration textures if needed.
-
-		CesiumGltfReader::GltfReaderResult gltfResult;
-		auto& model = gltfResult.model.emplace();
-		auto& images = model.images;
-		images.reserve(perModelTextures.size() * 5);
-
 		struct LoadedImageInfo
 		{
 			size_t imgIndex = 0;
@@ -154,82 +138,163 @@ namespace BeUtils
 			std::shared_ptr<BeUtils::GltfMaterialHelper> matHelper;
 			std::vector<LoadedImageInfo> imageInfos;
 		};
-		std::vector<IModelImageVec> imageCorresp;
-		imageCorresp.reserve(perModelTextures.size());
+		struct FetchedImages
+		{
+			std::vector<IModelImageVec> imageCorresp;
+			std::vector<CesiumGltf::Image> images;
+			bool bSuccess = true;
+		};
 
-		size_t gltfImageIndex = 0;
-		for (auto const& [imodelid, textureSet] : perModelTextures)
+		/// Starts the download of all textures of the given source, without touching the material helpers.
+		CesiumAsync::Future<FetchedImages> FetchTexturesMatchingSource(
+			AdvViz::SDK::ETextureSource TexSource,
+			AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+			AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+			std::map<std::string, GltfMaterialHelperPtr> const& imodelToMatHelper,
+			std::shared_ptr<std::string const> const& accessToken,
+			std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+			CesiumAsync::AsyncSystem const& asyncSystem)
 		{
-			auto itMatHelper = imodelToMatHelper.find(imodelid);
-			if (itMatHelper == imodelToMatHelper.end())
-				continue;
-			auto glTFMatHelper = itMatHelper->second;
-			if (!glTFMatHelper)
-				continue;
-
-			IModelImageVec& imodelImgs = imageCorresp.emplace_back();
-			imodelImgs.matHelper = glTFMatHelper;
-			imodelImgs.imageInfos.reserve(textureSet.size());
-
-			// Download (or read from sqlite cache) all decoration textures used by this model
-			for (auto const& texKey : textureSet)
+			BE_ASSERT(TexSource == AdvViz::SDK::ETextureSource::Decoration
+				|| TexSource == AdvViz::SDK::ETextureSource::Library);
+
+			// Download decoration textures if needed.
+
+			CesiumGltfReader::GltfReaderResult gltfResult;
+			auto& model = gltfResult.model.emplace();
+			auto& images = model.images;
+			images.reserve(perModelTextures.size() * 5);
+
+			std::vector<IModelImageVec> imageCorresp;
+			imageCorresp.reserve(perModelTextures.size());
+
+			size_t gltfImageIndex = 0;
+			for (auto const& [imodelid, textureSet] : perModelTextures)
 			{
-				if (texKey.eSource == TexSource)
+				auto itMatHelper = imodelToMatHelper.find(imodelid);
+				if (itMatHelper == imodelToMatHelper.end())
+					continue;
+				auto glTFMatHelper = itMatHelper->second;
+				if (!glTFMatHelper)
+					continue;
+
+				IModelImageVec& imodelImgs = imageCorresp.emplace_back();
+				imodelImgs.matHelper = glTFMatHelper;
+				imodelImgs.imageInfos.reserve(textureSet.size());
+
+				// Download (or read from sqlite cache) all decoration textures used by this model
+				for (auto const& texKey : textureSet)
 				{
-					imodelImgs.imageInfos.push_back({ gltfImageIndex, texKey });
-					auto& gltfImage = images.emplace_back();
-					gltfImageIndex++;
-					gltfImage.uri = matPersistenceMngr.GetRelativeURL(texKey);
+					if (texKey.eSource == TexSource)
+					{
+						imodelImgs.imageInfos.push_back({ gltfImageIndex, texKey });
+						auto& gltfImage = images.emplace_back();
+						gltfImageIndex++;
+						gltfImage.uri = matPersistenceMngr.GetRelativeURL(texKey);
+					}
 				}
 			}
-		}
 
-		if (gltfImageIndex == 0)
-		{
-			// Nothing to do.
-			return;
+			if (gltfImageIndex == 0)
+			{
+				// Nothing to do.
+				return asyncSystem.createResolvedFuture(FetchedImages{});
+			}
+
+			// Actually download textures (all at once). Note that we use Cesium's sqlite caching system, so
+			// this should be fast except for the very first time).
+			std::string const baseUrl = matPersistenceMngr.GetBaseURL(TexSource);
+
+			// We restrict the formats to JPG and PNG, so we can leave the default options (no need to setup
+			// Ktx2TranscodeTargets...)
+			CesiumGltfReader::GltfReaderOptions gltfOptions;
+			return CesiumGltfReader::GltfReader::resolveExternalData(
+				asyncSystem,
+				baseUrl,
+				GetHeadersForSource(TexSource, *accessToken),
+				pAssetAccessor,
+				gltfOptions,
+				std::move(gltfResult))
+				.thenImmediately([imageCorresp = std::move(imageCorresp), TexSource,
+					pMatPersistenceMngr = &matPersistenceMngr](CesiumGltfReader::GltfReaderResult&& result) mutable
+			{
+				if (!result.model)
+				{
+					return FetchedImages{ .bSuccess = false };
+				}
+				if (TexSource == AdvViz::SDK::ETextureSource::Decoration)
+				{
+					// Report the textures missing on the decoration service, so that they can be uploaded
+					// again (the persistence manager is owned by the application for the whole session).
+					for (IModelImageVec const& imodelImgs : imageCorresp)
+					{
+						for (LoadedImageInfo const& info : imodelImgs.imageInfos)
+						{
+							if (!result.model->images[info.imgIndex].pAsset)
+								pMatPersistenceMngr->OnDecorationTextureFetchFailed(info.texKey.id);
+						}
+					}
+				}
+				return FetchedImages{
+					.imageCorresp = std::move(imageCorresp),
+					.images = std::move(result.model->images)
+				};
+			}).catchImmediately([baseUrl](std::exception&& e) {
+				BE_LOGE("ITwinDecoration", "Exception while retrieving textures from '"
+					<< baseUrl << "': " << e.what());
+				return FetchedImages{ .bSuccess = false };
+			});
 		}
 
-		// Actually download textures. Note that we use Cesium's sqlite caching system, so this should be fast
-		// except for the very first time).
-		std::string const baseUrl = matPersistenceMngr.GetBaseURL(TexSource);
-
-		std::string strError;
-
-		// We restrict the formats to JPG and PNG, so we can leave the default options (no need to setup
-		// Ktx2TranscodeTargets...)
-		CesiumGltfReader::GltfReaderOptions gltfOptions;
-		CesiumGltfReader::GltfReader::resolveExternalData(
-			asyncSystem,
-			baseUrl,
-			GetHeadersForSource(TexSource, *accessToken),
-			pAssetAccessor,
-			gltfOptions,
-			std::move(gltfResult))
-			.thenImmediately([imageCorresp, pLock](CesiumGltfReader::GltfReaderResult&& result)
+		/// Dispatches the downloaded images to the appropriate material helper.
+		void StoreFetchedImages(FetchedImages& fetched, WLock const* pLock)
 		{
-			auto& cesiumImages = result.model->images;
-			// Dispatch the downloaded images to the appropriate material helper
-			for (IModelImageVec const& imodelImgs : imageCorresp)
+			for (IModelImageVec const& imodelImgs : fetched.imageCorresp)
 			{
 				OptionalWLock OptLock(*imodelImgs.matHelper, pLock);
 				auto const& lock = OptLock.GetLock();
 				for (LoadedImageInfo const& info : imodelImgs.imageInfos)
 				{
 					imodelImgs.matHelper->StoreCesiumImage(info.texKey,
-						std::move(cesiumImages[info.imgIndex]),
+						std::move(fetched.images[info.imgIndex]),
 						lock);
 				}
 			}
-		}).catchImmediately([&strError](std::exception&& e) {
-			strError = e.what();
-		}).wait();
+		}
+	}
 
-		if (!strError.empty())
+	CesiumAsync::Future<bool> ResolveTexturesMatchingSourceAsync(
+		AdvViz::SDK::ETextureSource TexSource,
+		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+		std::map<std::string, GltfMaterialHelperPtr> const& imodelToMatHelper,
+		std::shared_ptr<std::string const> const& accessToken,
+		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+		CesiumAsync::AsyncSystem const& asyncSystem)
+	{
+		return FetchTexturesMatchingSource(TexSource, matPersistenceMngr, perModelTextures,
+			imodelToMatHelper, accessToken, pAssetAccessor, asyncSystem)
+			.thenInWorkerThread([](FetchedImages&& fetched)
 		{
-			BE_LOGE("ITwinDecoration", "Exception while retrieving textures from '"
-				<< baseUrl << "': " << strError);
-		}
+			// Each material helper is only locked while its images are stored.
+			StoreFetchedImages(fetched, nullptr);
+			return fetched.bSuccess;
+		});
+	}
+
+	void ResolveTexturesMatchingSource(
+		AdvViz::SDK::ETextureSource TexSource,
+		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+		std::map<std::string, GltfMaterialHelperPtr> const& imodelToMatHelper,
+		std::shared_ptr<std::string const> const& accessToken,
+		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+		CesiumAsync::AsyncSystem const& asyncSystem,
+		WLock const* pLock /*= nullptr*/)
+	{
+		FetchedImages fetched = FetchTexturesMatchingSource(TexSource, matPersistenceMngr, perModelTextures,
+			imodelToMatHelper, accessToken, pAssetAccessor, asyncSystem).wait();
+		StoreFetchedImages(fetched, pLock);
 	}
 
 } // namespace BeUtils
@@ -9,9 +9,13 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <memory>
+#include <span>
 #include <string>
 
+#include <CesiumAsync/Future.h>
+
 #include <SDK/Core/Visualization/TextureKey.h>
 #include <SDK/Core/Visualization/TextureUsage.h>
 
@@ -28,17 +32,46 @@ namespace AdvViz::SDK
 
 namespace BeUtils
 {
+	/// Callback receiving the bytes of a downloaded texture. They belong to the response of the request,
+	/// and are thus only valid during the call.
+	using TextureBufferCallback = std::function<bool(std::span<uint8_t const>)>;
+
+	/// Downloads the given texture without blocking the caller.
+	/// \return Future resolved with the value returned by inCallback, or false if the texture could not be
+	/// downloaded.
+	CesiumAsync::Future<bool> DownloadTextureAsync(std::string const& textureURI,
+		std::shared_ptr<std::string const> const& accessToken,
+		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+		CesiumAsync::AsyncSystem const& asyncSystem,
+		TextureBufferCallback&& inCallback);
+
+	/// Same as DownloadTextureAsync, but waits for the download to finish.
 	bool DownloadTexture(std::string const& textureURI,
 		std::shared_ptr<std::string const> const& accessToken,
 		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
 		CesiumAsync::AsyncSystem const& asyncSystem,
-		std::function<bool(std::vector<uint8_t> const&)>&& inCallback);
+		TextureBufferCallback&& inCallback);
 
 
 	class GltfMaterialHelper;
 	using GltfMaterialHelperPtr = std::shared_ptr<GltfMaterialHelper>;
 	class WLock;
 
+	/// Downloads all the textures of the given source used by the iModels, concurrently and without
+	/// blocking the caller, and stores them in the corresponding material helpers. The lock of each
+	/// material helper is only taken once its textures are downloaded, to store the images.
+	/// \return Future resolved with false if the download failed.
+	CesiumAsync::Future<bool> ResolveTexturesMatchingSourceAsync(
+		AdvViz::SDK::ETextureSource TexSource,
+		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+		std::map<std::string, GltfMaterialHelperPtr> const& imodelToMatHelper,
+		std::shared_ptr<std::string const> const& accessToken,
+		std::shared_ptr<CesiumAsync::IAssetAccessor> const& pAssetAccessor,
+		CesiumAsync::AsyncSystem const& asyncSystem);
+
+	/// Same as ResolveTexturesMatchingSourceAsync, but waits for the textures to be stored. To be used
+	/// when the caller already holds the lock of the material helper (pLock).
 	void ResolveTexturesMatchingSource(
 		AdvViz::SDK::ETextureSource TexSource,
 		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
@@ -21,6 +21,11 @@
 #include <glm/gtc/matrix_access.hpp>
 #include <rapidjson/document.h>
 #include <SDK/Core/Tools/Assert.h>
+// Just a wrapper for async++.h that disables some warnings
+#include <CesiumAsync/Impl/cesium-async++.h>
+
+#include <algorithm>
+#include <span>
 
 namespace BeUtils
 {
@@ -149,13 +154,126 @@ struct GltfTunerVersions
 	int64_t anim4DRulesVersion_ = -1;
 };
 
+//! Flat table mapping element IDs to the indices of their groups (material or anim4D groups).
+//! Entries are sorted by element ID, then group index. An element contained in several groups has one
+//! entry per group, and the last group wins (as if groups were processed one after the other).
+class ElementGroupTable
+{
+public:
+	static constexpr uint32_t none = (uint32_t)-1;
+
+	//! Builds the table from all the groups.
+	template<class _Groups>
+	static ElementGroupTable Build(const _Groups& groups)
+	{
+		ElementGroupTable table;
+		size_t count = 0;
+		for (const auto& group: groups)
+			count += group.elements_.size();
+		table.entries_.reserve(count);
+		for (uint32_t groupIndex = 0; groupIndex < (uint32_t)groups.size(); ++groupIndex)
+			for (const auto elementId: groups[groupIndex].elements_)
+				table.entries_.push_back({elementId, groupIndex});
+		table.Sort();
+		return table;
+	}
+	//! Builds the table for newGroups from the table of oldGroups: only the entries of the groups whose
+	//! elements have changed are updated, which is cheaper than a full Build when a single group changes.
+	//! When no element list has changed (eg. only materials were edited), the old table is shared as-is.
+	template<class _Groups>
+	static std::shared_ptr<const ElementGroupTable> Update(std::shared_ptr<const ElementGroupTable> const& oldTable,
+		const _Groups& oldGroups, const _Groups& newGroups)
+	{
+		const auto& oldEntries = oldTable->entries_;
+		const size_t groupCount = std::max(oldGroups.size(), newGroups.size());
+		std::vector<bool> changed(groupCount, false);
+		size_t changedCount = 0;
+		std::vector<Entry> added;
+		for (uint32_t groupIndex = 0; groupIndex < (uint32_t)groupCount; ++groupIndex)
+		{
+			if (groupIndex < oldGroups.size() && groupIndex < newGroups.size()
+				&& oldGroups[groupIndex].elements_ == newGroups[groupIndex].elements_)
+			{
+				continue;
+			}
+			changed[groupIndex] = true;
+			++changedCount;
+			if (groupIndex < newGroups.size())
+				for (const auto elementId: newGroups[groupIndex].elements_)
+					added.push_back({elementId, groupIndex});
+		}
+		if (changedCount == 0)
+			return oldTable;
+		if (changedCount == groupCount)
+			return std::make_shared<const ElementGroupTable>(Build(newGroups));
+		auto tablePtr = std::make_shared<ElementGroupTable>();
+		auto& table = *tablePtr;
+		std::sort(added.begin(), added.end());
+		table.entries_.reserve(oldEntries.size() + added.size());
+		auto addedIt = added.cbegin();
+		for (const auto& entry: oldEntries)
+		{
+			if (changed[entry.second])
+				continue;
+			for (; addedIt != added.cend() && *addedIt < entry; ++addedIt)
+				table.entries_.push_back(*addedIt);
+			table.entries_.push_back(entry);
+		}
+		table.entries_.insert(table.entries_.end(), addedIt, added.cend());
+		table.entries_.erase(std::unique(table.entries_.begin(), table.entries_.end()), table.entries_.end());
+		return tablePtr;
+	}
+	//! Returns the index of the (last) group containing the element, or none.
+	uint32_t Find(uint64_t elementId) const
+	{
+		const auto it = std::upper_bound(entries_.cbegin(), entries_.cend(), Entry{elementId, none});
+		return (it == entries_.cbegin() || std::prev(it)->first != elementId) ? none : std::prev(it)->second;
+	}
+	size_t Size() const { return entries_.size(); }
+
+private:
+	using Entry = std::pair<uint64_t, uint32_t>; //!< element ID, group index
+	void Sort()
+	{
+		std::sort(entries_.begin(), entries_.end());
+		entries_.erase(std::unique(entries_.begin(), entries_.end()), entries_.end());
+	}
+	std::vector<Entry> entries_;
+};
+
+//! Material rules with additional precomputed derived data. Immutable once published.
+struct MaterialRulesEx
+{
+	std::vector<GltfTuner::Rules::MaterialGroup> groups_;
+	std::unordered_set<uint64_t> itwinMatIDsToSplit_;
+	std::shared_ptr<const ElementGroupTable> elementToGroup_ = std::make_shared<const ElementGroupTable>();
+};
+
+//! 4D animation rules with additional precomputed derived data. Immutable once published.
+struct Anim4DRulesEx
+{
+	std::vector<GltfTuner::Rules::Anim4DGroup> groups_;
+	std::shared_ptr<const ElementGroupTable> elementToGroup_ = std::make_shared<const ElementGroupTable>();
+};
+
 //! Rules with additional precomputed derived data.
+//! Published as immutable snapshots: each tuning task keeps the snapshot it started with, while new rules
+//! are being prepared. Material and anim4D rules are shared between snapshots when they do not change.
 struct GltfTunerRulesEx : public GltfTunerVersions
 {
 	int64_t version_ = -1;
-	GltfTuner::Rules tuningRules_;
-	//! Maps each element ID to the index of its containing group.
-	std::unordered_map<uint64_t, std::pair<size_t, size_t>> elementToGroups_;
+	std::shared_ptr<const MaterialRulesEx> material_ = std::make_shared<const MaterialRulesEx>();
+	std::shared_ptr<const Anim4DRulesEx> anim4D_ = std::make_shared<const Anim4DRulesEx>();
+
+	static constexpr size_t none = (size_t)-1;
+	//! Returns the indices of the material and anim4D groups containing the element (none if not found).
+	std::pair<size_t, size_t> FindGroups(uint64_t elementId) const
+	{
+		const auto toIndex = [](uint32_t groupIndex)
+			{ return groupIndex == ElementGroupTable::none ? none : (size_t)groupIndex; };
+		return {toIndex(material_->elementToGroup_->Find(elementId)),
+				toIndex(anim4D_->elementToGroup_->Find(elementId))};
+	}
 };
 
 class GltfTunerHelper : public GltfMaterialTuner
@@ -197,12 +315,32 @@ public:
 	{
 		bool hasMaterialFeatureId_ = false;
 	};
-	using ClusterList = std::unordered_map<ClusterId, Cluster,
-		decltype([](const auto& x){return boost::pfr::hash_fields(x);}),
-		boost::pfr::equal_to<>>;
+	struct ClusterIdHash
+	{
+		size_t operator()(const ClusterId& x) const { return boost::pfr::hash_fields(x); }
+	};
+	using ClusterList = std::unordered_map<ClusterId, Cluster, ClusterIdHash, boost::pfr::equal_to<>>;
+	//! The clusters of a single primitive. Primitives are processed independently (in parallel), then
+	//! their clusters are merged into the clusters of the mesh (see MergeClusters).
+	struct PrimitiveClusters
+	{
+		std::vector<ClusterId> ids_; //!< in order of first use in the primitive
+		std::vector<Cluster> clusters_; //!< same order as ids_
+		//! An index referencing a vertex which was first added to another cluster of the primitive.
+		//! It happens when a vertex is shared by pieces of different elements (not expected from the
+		//! Mesh Export Service): the index is then relative to the cluster of the vertex.
+		struct CrossIndex
+		{
+			uint32_t slot_ = 0; //!< cluster containing the index
+			uint32_t indexPos_ = 0; //!< position of the index in this cluster
+			uint32_t vertexSlot_ = 0; //!< cluster containing the vertex
+		};
+		std::vector<CrossIndex> crossIndices_;
+	};
 	const CesiumGltf::Model& model_; //!< The input model.
 	const GltfTunerRulesEx& rulesEx_;
 	const glm::dmat4& tileTransform_; //!< The tile transformation
+	const bool bParallel_; //!< Whether primitives are classified in parallel (always true except in tests)
 	using UInt64AccessorView = CesiumGltf::AccessorView<uint64_t>;
 	std::optional<UInt64AccessorView> elementPropertyTableView_;
 	std::optional<UInt64AccessorView> materialPropertyTableView_;
@@ -211,11 +349,13 @@ public:
 	GltfTunerHelper(const CesiumGltf::Model& model,
 		const GltfTunerRulesEx& rulesEx,
 		const std::shared_ptr<GltfMaterialHelper>& materialHelper,
-		const glm::dmat4& tileTransform)
+		const glm::dmat4& tileTransform,
+		bool const bParallel = true)
 		: GltfMaterialTuner(materialHelper)
 		, model_(model)
 		, rulesEx_(rulesEx)
 		, tileTransform_(tileTransform)
+		, bParallel_(bParallel)
 	{
 	}
 	CesiumGltf::Model Tune()
@@ -297,14 +437,15 @@ public:
 		auto gltfTextures = model_.textures;
 		auto gltfImages = model_.images;
 
-		// Process the primitives of each mesh.
-		// Note: we do not merge primitives belonging to different meshes,
-		// since it would break the structure of the model's scene.
+		// Classify the pieces of all the primitives, in parallel, each primitive into its own clusters.
+		std::vector<const CesiumGltf::MeshPrimitive*> allPrimitives;
 		for (const auto& mesh: model_.meshes)
-		{
-			ClusterList clusters;
 			for (const auto& primitive: mesh.primitives)
+				allPrimitives.push_back(&primitive);
+		std::vector<PrimitiveClusters> primitiveClusters(allPrimitives.size());
+		const auto processPrimitive = [&](size_t primitiveIndex)
 			{
+				const auto& primitive = *allPrimitives[primitiveIndex];
 				// Look for the _FEATURE_ID_X corresponding to our metadata.
 				const auto getFeatureIdsAccessorIndex = [&](std::optional<UInt64AccessorView> const& propTableView, int64_t propTableIndex)
 					{
@@ -343,8 +484,27 @@ public:
 					AccessorViews::Maker<AccessorViews::Indices>{primitive.indices},
 					AccessorViews::Maker<AccessorViews::FeatureIds>{elementFeatIdsAccessorIndex},
 					AccessorViews::Maker<AccessorViews::Colors>{colorAttributeIt == primitive.attributes.end() ? -1 : colorAttributeIt->second}),
-					primitive, { .hasMaterialFeatureId_ = primHasMaterialIDs }, clusters);
-			}
+					primitive, { .hasMaterialFeatureId_ = primHasMaterialIDs }, primitiveClusters[primitiveIndex]);
+			};
+		if (bParallel_ && allPrimitives.size() > 1)
+		{
+			async::parallel_for(async::irange(size_t(0), allPrimitives.size()), processPrimitive);
+		}
+		else
+		{
+			for (size_t primitiveIndex = 0; primitiveIndex < allPrimitives.size(); ++primitiveIndex)
+				processPrimitive(primitiveIndex);
+		}
+
+		// Process the primitives of each mesh.
+		// Note: we do not merge primitives belonging to different meshes,
+		// since it would break the structure of the model's scene.
+		size_t firstPrimitiveOfMesh = 0;
+		for (const auto& mesh: model_.meshes)
+		{
+			ClusterList clusters;
+			MergeClusters(std::span(primitiveClusters).subspan(firstPrimitiveOfMesh, mesh.primitives.size()), clusters);
+			firstPrimitiveOfMesh += mesh.primitives.size();
 			int32_t const meshIndex = static_cast<int32_t>(gltfBuilder.GetModel().meshes.size());
 			gltfBuilder.GetModel().meshes.emplace_back();
 			CesiumGltf::Node const* nodeUsingThisMesh = nullptr;
@@ -427,7 +587,12 @@ public:
 				if (!cluster.colors_.empty() && !matInfo.overrideColor_)
 					primitive.SetColors(cluster.colors_);
 				if (!cluster.featureIds_.empty())
+				{
 					primitive.SetFeatureIds(cluster.featureIds_, clusterId.hasMaterialFeatureId_);
+					// Done here in a worker thread, to spare the game thread from reading each vertex's
+					// feature ID when the primitive is loaded (see UITwinSceneMappingBuilder).
+					primitive.SetFeatureRanges(cluster.featureIds_);
+				}
 				if (clusterId.itwinMaterialID_) // the final primitive will have 1 iTwin material
 					primitive.SetITwinMaterialID(*clusterId.itwinMaterialID_);
 			}
@@ -452,6 +617,83 @@ public:
 		return std::move(gltfBuilder.GetModel());
 	}
 private:
+	//! Merges the clusters of the primitives of a mesh, in the order of the primitives: the result is the
+	//! same as if all the primitives had been added to the same clusters, one after the other.
+	static void MergeClusters(std::span<PrimitiveClusters> primitives, ClusterList& clusters)
+	{
+		// Size each cluster up front.
+		std::vector<std::vector<Cluster*>> targets(primitives.size());
+		std::unordered_map<Cluster*, std::pair<size_t, size_t>> totalSizes; // vertices, indices
+		for (size_t p = 0; p < primitives.size(); ++p)
+		{
+			for (size_t slot = 0; slot < primitives[p].ids_.size(); ++slot)
+			{
+				Cluster* target = &clusters[primitives[p].ids_[slot]];
+				targets[p].push_back(target);
+				auto& sizes = totalSizes[target];
+				sizes.first += primitives[p].clusters_[slot].positions_.size();
+				sizes.second += primitives[p].clusters_[slot].indices_.size();
+			}
+		}
+		const auto reserve = [&](Cluster& cluster)
+			{
+				const auto& sizes = totalSizes[&cluster];
+				cluster.indices_.reserve(sizes.second);
+				cluster.positions_.reserve(sizes.first);
+				if (!cluster.normals_.empty())
+					cluster.normals_.reserve(sizes.first);
+				if (!cluster.uvs_.empty())
+					cluster.uvs_.reserve(sizes.first);
+				if (!cluster.colors_.empty())
+					cluster.colors_.reserve(sizes.first);
+				if (!cluster.featureIds_.empty())
+					cluster.featureIds_.reserve(sizes.first);
+			};
+		const auto append = [](auto& dst, const auto& src)
+			{
+				dst.insert(dst.end(), src.begin(), src.end());
+			};
+		std::vector<uint32_t> vertexOffsets, indexOffsets;
+		for (size_t p = 0; p < primitives.size(); ++p)
+		{
+			auto& primitive = primitives[p];
+			const size_t slotCount = primitive.ids_.size();
+			vertexOffsets.resize(slotCount);
+			indexOffsets.resize(slotCount);
+			for (size_t slot = 0; slot < slotCount; ++slot)
+			{
+				vertexOffsets[slot] = (uint32_t)targets[p][slot]->positions_.size();
+				indexOffsets[slot] = (uint32_t)targets[p][slot]->indices_.size();
+			}
+			for (size_t slot = 0; slot < slotCount; ++slot)
+			{
+				Cluster& dst = *targets[p][slot];
+				Cluster& src = primitive.clusters_[slot];
+				if (dst.indices_.empty() && dst.positions_.empty())
+				{
+					// First primitive using this cluster.
+					dst = std::move(src);
+					reserve(dst);
+					continue;
+				}
+				append(dst.positions_, src.positions_);
+				append(dst.normals_, src.normals_);
+				append(dst.uvs_, src.uvs_);
+				append(dst.colors_, src.colors_);
+				append(dst.featureIds_, src.featureIds_);
+				const uint32_t vertexOffset = vertexOffsets[slot];
+				for (const auto& index: src.indices_)
+					dst.indices_.push_back({index[0] + vertexOffset});
+			}
+			for (const auto& crossIndex: primitive.crossIndices_)
+			{
+				auto& index = targets[p][crossIndex.slot_]->indices_[indexOffsets[crossIndex.slot_] + crossIndex.indexPos_][0];
+				index = index - vertexOffsets[crossIndex.slot_] + vertexOffsets[crossIndex.vertexSlot_];
+			}
+			primitive = {};
+		}
+	}
+
 	//! This function recursively "builds" specialized versions ProcessPrimitive2,
 	//! one for each combination of the given accessor views.
 	//! One issue with this technique is that it can result in code bloat,
@@ -461,7 +703,7 @@ private:
 	void ProcessPrimitive(const _AccessorViewMakers& accessorViewMakers,
 		const CesiumGltf::MeshPrimitive& primitive,
 		const PrimitiveExtraProperties& primProps,
-		ClusterList& clusters,
+		PrimitiveClusters& clusters,
 		const _CurAccessorViews& accessorViews = {})
 	{
 		if constexpr (_curIndex == std::tuple_size<_AccessorViewMakers>::value)
@@ -543,7 +785,7 @@ private:
 	}
 	template<class _AccessorViews>
 	void ProcessPrimitive2(const CesiumGltf::MeshPrimitive& primitive, 
-		const PrimitiveExtraProperties& primProps, ClusterList& clusters, const _AccessorViews& accessorViews)
+		const PrimitiveExtraProperties& primProps, PrimitiveClusters& clusters, const _AccessorViews& accessorViews)
 	{
 		// Retrieve the accessor views for attributes having fixed data type.
 		const CesiumGltf::AccessorView<std::array<float, 3>> positions(
@@ -556,34 +798,28 @@ private:
 			};
 		const auto normals = getView("NORMAL", (std::array<float, 3>*)0);
 		const auto uvs = getView("TEXCOORD_0", (std::array<float, 2>*)0);
-		// A vertex can be referenced by multiple indices (that's the purpose of the index buffer).
-		// So once a vertex has been processed (ie. added to a cluster), we record its position inside the
-		// cluster's vertices.
-		std::vector<int> newIndices(positions.size(), -1);
-		// This function processes one "piece" (triangle, line...)
-		const auto processPiece = [&](const auto& indexIndices)
+		const bool hasFeatureId =
+			accessorViews.featureIds_.status() == CesiumGltf::AccessorViewStatus::Valid;
+		const bool hasNormals = normals.status() == CesiumGltf::AccessorViewStatus::Valid;
+		const bool hasUVs = uvs.status() == CesiumGltf::AccessorViewStatus::Valid;
+		const bool hasColors = accessorViews.colors_.status() == CesiumGltf::AccessorViewStatus::Valid;
+		// Material IDs can now be combined with features
+		const bool hasMaterialFeatureId = primProps.hasMaterialFeatureId_;
+		BE_ASSERT(!hasMaterialFeatureId || (hasFeatureId && materialPropertyTableView_));
+		// Returns the cluster of a piece, from the feature ID of its first vertex.
+		// We assume all the vertices of a piece have the same element ID.
+		const auto getClusterId = [&](int64_t const firstFeatureId)
 			{
-				constexpr size_t none = (size_t)-1;
-				const bool hasFeatureId =
-					accessorViews.featureIds_.status() == CesiumGltf::AccessorViewStatus::Valid;
-				// Get the element ID from the first vertex.
-				// We assume all the vertices of this piece have the same element ID.
-				int64_t const firstFeatureId = hasFeatureId
-					? static_cast<int64_t>(accessorViews.featureIds_[accessorViews.indices_[indexIndices[0]][0]][0])
-					: 0;
+				constexpr size_t none = GltfTunerRulesEx::none;
 				const auto elementId = hasFeatureId ? (*elementPropertyTableView_)[firstFeatureId] : 0;
 				// Find the group (in the rules) that contains this element ID, if any.
-				const auto groupIt = rulesEx_.elementToGroups_.find(elementId);
-
-				// Material IDs can now be combined with features
-				const bool hasMaterialFeatureId = primProps.hasMaterialFeatureId_;
-				BE_ASSERT(!hasMaterialFeatureId || (hasFeatureId && materialPropertyTableView_));
+				const auto [materialGroup, anim4DGroup] = rulesEx_.FindGroups(elementId);
 
 				// Get the original material identifier in the iModel, if it was exported by the Mesh-Export
 				// Service (should be the case since 08/2024)
 				std::optional<uint64_t> itwinMatID;
 				int32_t material = -1;
-				if (groupIt == rulesEx_.elementToGroups_.end() || none == groupIt->second.first)
+				if (none == materialGroup)
 				{
 					// For the material:
 					// - if the element ID is in a group, use this group's material,
@@ -596,45 +832,147 @@ private:
 				}
 				else
 				{
-					auto& matGroup = rulesEx_.tuningRules_.materialGroups_[groupIt->second.first];
+					auto& matGroup = rulesEx_.material_->groups_[materialGroup];
 					material = matGroup.material_;
 					itwinMatID = matGroup.itwinMaterialID_;
 				}
 				// We should only take the iTwin material into account for the final splitting if the rules
 				// say so:
 				std::optional<uint64_t> itwinMatIDForCluster;
-				if (itwinMatID && rulesEx_.tuningRules_.itwinMatIDsToSplit_.find(*itwinMatID)
-								!= rulesEx_.tuningRules_.itwinMatIDsToSplit_.cend())
+				if (itwinMatID && rulesEx_.material_->itwinMatIDsToSplit_.find(*itwinMatID)
+								!= rulesEx_.material_->itwinMatIDsToSplit_.cend())
 				{
 					itwinMatIDForCluster = itwinMatID;
 				}
-				// Find the cluster where this piece will be added.
-				auto& cluster = clusters[ClusterId{
+				return ClusterId{
 					.material_ = material,
 					.itwinMaterialID_ = itwinMatIDForCluster,
-					.anim4DIds_ = (groupIt == rulesEx_.elementToGroups_.end() || none == groupIt->second.second)
+					.anim4DIds_ = (none == anim4DGroup)
 						? std::optional<Anim4DId>{}
-						: rulesEx_.tuningRules_.anim4DGroups_[groupIt->second.second].ids_,
+						: rulesEx_.anim4D_->groups_[anim4DGroup].ids_,
 					.mode_ = GetConvertedPrimitiveMode(primitive.mode),
-					.hasNormal_ = normals.status() == CesiumGltf::AccessorViewStatus::Valid,
-					.hasUV_ = uvs.status() == CesiumGltf::AccessorViewStatus::Valid,
-					.hasColor_ = (accessorViews.colors_.status() == CesiumGltf::AccessorViewStatus::Valid),
+					.hasNormal_ = hasNormals,
+					.hasUV_ = hasUVs,
+					.hasColor_ = hasColors,
 					.hasFeatureId_ = hasFeatureId,
 					.hasMaterialFeatureId_ = hasMaterialFeatureId,
-					.elementGroupIndex_ =
-						(groupIt == rulesEx_.elementToGroups_.end()) ? -1 : (int)groupIt->second.first
-				}];
+					.elementGroupIndex_ = (none == materialGroup) ? -1 : (int)materialGroup
+				};
+			};
+		// Calls processPiece for each "piece" (triangle, line...), depending on the primitive topology.
+		// The indices to use for triangle strips etc are specified here:
+		// https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview.
+		const auto forEachPiece = [&](const auto& processPiece)
+			{
+				switch (primitive.mode)
+				{
+					case CesiumGltf::MeshPrimitive::Mode::POINTS:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size(); ++pieceIndex)
+							processPiece(std::to_array({pieceIndex}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::LINES:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()/2; ++pieceIndex)
+							processPiece(std::to_array({2*pieceIndex, 2*pieceIndex+1}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::LINE_LOOP:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size(); ++pieceIndex)
+							processPiece(std::to_array({pieceIndex, (pieceIndex+1)%(int)accessorViews.indices_.size()}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::LINE_STRIP:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-1; ++pieceIndex)
+							processPiece(std::to_array({pieceIndex, pieceIndex+1}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::TRIANGLES:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()/3; ++pieceIndex)
+							processPiece(std::to_array({3*pieceIndex, 3*pieceIndex+1, 3*pieceIndex+2}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::TRIANGLE_STRIP:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-2; ++pieceIndex)
+							processPiece(std::to_array({pieceIndex, pieceIndex+1+pieceIndex%2, pieceIndex+2-pieceIndex%2}));
+						break;
+					case CesiumGltf::MeshPrimitive::Mode::TRIANGLE_FAN:
+						for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-2; ++pieceIndex)
+							processPiece(std::to_array({pieceIndex+1, pieceIndex+2, 0}));
+						break;
+				}
+			};
+
+		// 1st pass: find the cluster of each piece, and count the indices and vertices of each cluster so
+		// that they can be allocated at once.
+		// Consecutive pieces usually belong to the same element, so the last cluster is remembered.
+		std::unordered_map<ClusterId, uint32_t, ClusterIdHash, boost::pfr::equal_to<>> slots;
+		std::vector<uint32_t> pieceSlots;
+		// Cluster in which each vertex is added (the cluster of the first piece referencing it).
+		std::vector<int> vertexSlots(positions.size(), -1);
+		std::vector<size_t> indexCounts, vertexCounts;
+		int64_t lastFeatureId = 0;
+		uint32_t lastSlot = 0;
+		forEachPiece([&](const auto& indexIndices)
+			{
+				int64_t const firstFeatureId = hasFeatureId
+					? static_cast<int64_t>(accessorViews.featureIds_[accessorViews.indices_[indexIndices[0]][0]][0])
+					: 0;
+				if (pieceSlots.empty() || firstFeatureId != lastFeatureId)
+				{
+					const auto [slotIt, isNew] = slots.try_emplace(getClusterId(firstFeatureId), (uint32_t)clusters.ids_.size());
+					if (isNew)
+					{
+						clusters.ids_.push_back(slotIt->first);
+						indexCounts.push_back(0);
+						vertexCounts.push_back(0);
+					}
+					lastSlot = slotIt->second;
+					lastFeatureId = firstFeatureId;
+				}
+				pieceSlots.push_back(lastSlot);
+				indexCounts[lastSlot] += indexIndices.size();
+				for (const auto indexIndex: indexIndices)
+				{
+					const auto index = accessorViews.indices_[indexIndex][0];
+					if (vertexSlots[index] == -1)
+					{
+						vertexSlots[index] = (int)lastSlot;
+						++vertexCounts[lastSlot];
+					}
+				}
+			});
+		clusters.clusters_.resize(clusters.ids_.size());
+		for (size_t slot = 0; slot < clusters.clusters_.size(); ++slot)
+		{
+			auto& cluster = clusters.clusters_[slot];
+			cluster.indices_.reserve(indexCounts[slot]);
+			cluster.positions_.reserve(vertexCounts[slot]);
+			if (hasNormals)
+				cluster.normals_.reserve(vertexCounts[slot]);
+			if (hasUVs)
+				cluster.uvs_.reserve(vertexCounts[slot]);
+			if (hasColors)
+				cluster.colors_.reserve(vertexCounts[slot]);
+			if (hasFeatureId)
+				cluster.featureIds_.reserve(vertexCounts[slot]);
+		}
+
+		// 2nd pass: fill the clusters.
+		// A vertex can be referenced by multiple indices (that's the purpose of the index buffer).
+		// So once a vertex has been processed (ie. added to a cluster), we record its position inside the
+		// cluster's vertices.
+		std::vector<int> newIndices(positions.size(), -1);
+		size_t pieceIndex = 0;
+		forEachPiece([&](const auto& indexIndices)
+			{
+				const uint32_t slot = pieceSlots[pieceIndex++];
+				auto& cluster = clusters.clusters_[slot];
 				for (const auto indexIndex: indexIndices)
 				{
 					const auto index = accessorViews.indices_[indexIndex][0];
 					if (newIndices[index] == -1)
 					{
 						cluster.positions_.push_back(positions[index]);
-						if (normals.status() == CesiumGltf::AccessorViewStatus::Valid)
+						if (hasNormals)
 							cluster.normals_.push_back(normals[index]);
-						if (uvs.status() == CesiumGltf::AccessorViewStatus::Valid)
+						if (hasUVs)
 							cluster.uvs_.push_back(uvs[index]);
-						if (accessorViews.colors_.status() == CesiumGltf::AccessorViewStatus::Valid)
+						if (hasColors)
 							cluster.colors_.push_back([&]
 								{
 									// Convert color to VEC4<UNSIGNED_BYTE>.
@@ -674,49 +1012,19 @@ private:
 												static_assert(std::is_void_v<InputColor>);
 										}();
 								}());
-						if (accessorViews.featureIds_.status() == CesiumGltf::AccessorViewStatus::Valid)
+						if (hasFeatureId)
 							cluster.featureIds_.push_back({(float)accessorViews.featureIds_[index][0]});
 
 						// Record the position of this vertex inside its cluster.
 						newIndices[index] = (int)cluster.positions_.size()-1;
 					}
+					else if (vertexSlots[index] != (int)slot)
+					{
+						clusters.crossIndices_.push_back({slot, (uint32_t)cluster.indices_.size(), (uint32_t)vertexSlots[index]});
+					}
 					cluster.indices_.push_back({(uint32_t)newIndices[index]});
 				}
-			};
-		// Process each piece, depending on the primitive topology.
-		// The indices to use for triangle strips etc are specified here:
-		// https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#meshes-overview.
-		switch (primitive.mode)
-		{
-			case CesiumGltf::MeshPrimitive::Mode::POINTS:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size(); ++pieceIndex)
-					processPiece(std::to_array({pieceIndex}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::LINES:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()/2; ++pieceIndex)
-					processPiece(std::to_array({2*pieceIndex, 2*pieceIndex+1}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::LINE_LOOP:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size(); ++pieceIndex)
-					processPiece(std::to_array({pieceIndex, (pieceIndex+1)%(int)accessorViews.indices_.size()}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::LINE_STRIP:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-1; ++pieceIndex)
-					processPiece(std::to_array({pieceIndex, pieceIndex+1}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::TRIANGLES:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()/3; ++pieceIndex)
-					processPiece(std::to_array({3*pieceIndex, 3*pieceIndex+1, 3*pieceIndex+2}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::TRIANGLE_STRIP:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-2; ++pieceIndex)
-					processPiece(std::to_array({pieceIndex, pieceIndex+1+pieceIndex%2, pieceIndex+2-pieceIndex%2}));
-				break;
-			case CesiumGltf::MeshPrimitive::Mode::TRIANGLE_FAN:
-				for (auto pieceIndex = 0; pieceIndex < accessorViews.indices_.size()-2; ++pieceIndex)
-					processPiece(std::to_array({pieceIndex+1, pieceIndex+2, 0}));
-				break;
-		}
+			});
 	}
 
 };
@@ -728,10 +1036,13 @@ struct GltfTuner::Impl : public GltfTunerVersions
 {
 	//! std::move'd to rulesEx_ when actually tuning and rulesVersion_ has changed, so don't reuse after that
 	Rules nextTuningRules_;
-	GltfTunerRulesEx rulesEx_;
+	//! Current rules snapshot: tuning tasks hold a reference to it, so it is replaced, never modified.
+	std::shared_ptr<const GltfTunerRulesEx> rulesEx_ = std::make_shared<const GltfTunerRulesEx>();
 	//! apply() and SetRules() can be called by different threads (typically Tune() is called on a background
 	//! thread), so we have to protect access to data used by both methods.
 	std::shared_mutex mutex_;
+	//! Serializes the computation of new snapshots, which is done without holding mutex_.
+	std::mutex updateMutex_;
 
 	std::vector<ITwinMaterialInfo> itwinMaterials_;
 	std::shared_ptr<GltfMaterialHelper> materialHelper_;
@@ -753,68 +1064,57 @@ GltfTuner::~GltfTuner()
 
 void GltfTuner::Impl::UpdateRulesIfNeeded(Cesium3DTilesSelection::GltfModifier const& tuner)
 {
-	BeUtils::WLock wlock(mutex_);
-	// Test if we should recompute rules derived data.
-	bool newMatRules = false, newAnim4DRules = false;
-	if (tuner.getCurrentVersion() && (*tuner.getCurrentVersion()) > rulesEx_.version_)
 	{
-		if (materialRulesVersion_ > rulesEx_.materialRulesVersion_)
-		{
-			newMatRules = true;
-			rulesEx_.materialRulesVersion_ = materialRulesVersion_;
-			rulesEx_.tuningRules_.materialGroups_ = std::move(nextTuningRules_.materialGroups_);
-			rulesEx_.tuningRules_.itwinMatIDsToSplit_ =
-				std::move(nextTuningRules_.itwinMatIDsToSplit_);
-		}
-		if (anim4DRulesVersion_ > rulesEx_.anim4DRulesVersion_)
-		{
-			newAnim4DRules = true;
-			rulesEx_.anim4DRulesVersion_ = anim4DRulesVersion_;
-			rulesEx_.tuningRules_.anim4DGroups_ = std::move(nextTuningRules_.anim4DGroups_);
-		}
-		rulesEx_.version_ = *tuner.getCurrentVersion();
-		constexpr size_t none = (size_t)-1;
-		auto& elemToGroups = rulesEx_.elementToGroups_;
-		if (newMatRules && newAnim4DRules) // clear all
-			elemToGroups.clear();
-		else if (newMatRules) // clear material group indices
-			std::for_each(elemToGroups.begin(), elemToGroups.end(),
-						  [](auto& groupIndices) { groupIndices.second.first = none; });
-		else if (newAnim4DRules) // clear anim4D group indices
-			std::for_each(elemToGroups.begin(), elemToGroups.end(),
-						  [](auto& groupIndices) { groupIndices.second.second = none; });
-		// remove useless (none;none) entries from the map
-		for (auto it = elemToGroups.begin(); it != elemToGroups.end();)
-			if (it->second == std::make_pair(none, none))
-				it = elemToGroups.erase(it);
-			else
-				++it;
-		// add/update mappings to material and/or anim4D groups
-		if (newMatRules)
-		{
-			auto const& matGrps = rulesEx_.tuningRules_.materialGroups_;
-			for (auto groupIndex = 0; groupIndex < matGrps.size(); ++groupIndex)
-				for (const auto elementId : matGrps[groupIndex].elements_)
-				{
-					auto known = rulesEx_.elementToGroups_
-						.try_emplace(elementId, std::make_pair(groupIndex, none));
-					if (!known.second) // was already in map
-						known.first->second.first = groupIndex;
-				}
-		}
-		if (newAnim4DRules)
+		BeUtils::RLock rlock(mutex_);
+		if (!tuner.getCurrentVersion() || (*tuner.getCurrentVersion()) <= rulesEx_->version_)
+			return;
+	}
+	std::unique_lock updateLock(updateMutex_);
+	// Take the new rules (if still needed: another thread may have done it in the meantime).
+	std::shared_ptr<const GltfTunerRulesEx> oldRulesEx;
+	Rules newRules;
+	GltfTunerVersions newVersions;
+	int64_t newVersion = -1;
+	{
+		BeUtils::WLock wlock(mutex_);
+		if (!tuner.getCurrentVersion() || (*tuner.getCurrentVersion()) <= rulesEx_->version_)
+			return;
+		oldRulesEx = rulesEx_;
+		newVersion = *tuner.getCurrentVersion();
+		newVersions = *this;
+		if (materialRulesVersion_ > oldRulesEx->materialRulesVersion_)
 		{
-			auto const& anim4DGrps = rulesEx_.tuningRules_.anim4DGroups_;
-			for (auto groupIndex = 0; groupIndex < anim4DGrps.size(); ++groupIndex)
-				for (const auto elementId : anim4DGrps[groupIndex].elements_)
-				{
-					auto known = rulesEx_.elementToGroups_
-						.try_emplace(elementId, std::make_pair(none, groupIndex));
-					if (!known.second) // was already in map
-						known.first->second.second = groupIndex;
-				}
+			newRules.materialGroups_ = std::move(nextTuningRules_.materialGroups_);
+			newRules.itwinMatIDsToSplit_ = std::move(nextTuningRules_.itwinMatIDsToSplit_);
 		}
+		if (anim4DRulesVersion_ > oldRulesEx->anim4DRulesVersion_)
+			newRules.anim4DGroups_ = std::move(nextTuningRules_.anim4DGroups_);
 	}
+	// Compute derived data for the new snapshot, sharing what has not changed with the current one.
+	auto newRulesEx = std::make_shared<GltfTunerRulesEx>(*oldRulesEx);
+	newRulesEx->version_ = newVersion;
+	if (newVersions.materialRulesVersion_ > oldRulesEx->materialRulesVersion_)
+	{
+		auto material = std::make_shared<MaterialRulesEx>();
+		material->elementToGroup_ = ElementGroupTable::Update(oldRulesEx->material_->elementToGroup_,
+			oldRulesEx->material_->groups_, newRules.materialGroups_);
+		material->groups_ = std::move(newRules.materialGroups_);
+		material->itwinMatIDsToSplit_ = std::move(newRules.itwinMatIDsToSplit_);
+		newRulesEx->material_ = std::move(material);
+		newRulesEx->materialRulesVersion_ = newVersions.materialRulesVersion_;
+	}
+	if (newVersions.anim4DRulesVersion_ > oldRulesEx->anim4DRulesVersion_)
+	{
+		auto anim4D = std::make_shared<Anim4DRulesEx>();
+		anim4D->elementToGroup_ = ElementGroupTable::Update(oldRulesEx->anim4D_->elementToGroup_,
+			oldRulesEx->anim4D_->groups_, newRules.anim4DGroups_);
+		anim4D->groups_ = std::move(newRules.anim4DGroups_);
+		newRulesEx->anim4D_ = std::move(anim4D);
+		newRulesEx->anim4DRulesVersion_ = newVersions.anim4DRulesVersion_;
+	}
+	// Publish it.
+	BeUtils::WLock wlock(mutex_);
+	rulesEx_ = std::move(newRulesEx);
 }
 
 CesiumAsync::Future<void> GltfTuner::onRegister(
@@ -885,22 +1185,21 @@ CesiumAsync::Future<std::optional<Cesium3DTilesSelection::GltfModifierOutput>> G
 		glm::dvec4(0.),
 		glm::dvec4(0.),
 		impl_->rootTranslation_);
-	// Need to lock also during GltfTunerHelper::Tune(..), because several background cesium threads can call
-	// GltfTuner::apply(..) at the same time! But here we only need a shared_lock, whereas UpdateRulesIfNeeded
-	// of course requires a unique_lock.
+	// Several background cesium threads can call GltfTuner::apply(..) at the same time, and the rules can be
+	// edited while tiles are being tuned: each task captures the current rules snapshot, so the lock is only
+	// needed to read it.
 	BeUtils::RLock rlock(impl_->mutex_);
 	if (getCurrentVersion()
 		&& Cesium3DTilesSelection::GltfModifierVersionExtension::getVersion(input.previousModel)
 			!= (*getCurrentVersion()))
 	{
 		return input.asyncSystem.runInWorkerThread(
-			[this, tileTransform_shifted, previousModel=std::move(input.previousModel)]()
+			[rulesEx = impl_->rulesEx_, materialHelper = impl_->materialHelper_, tileTransform_shifted,
+			 previousModel = std::move(input.previousModel)]()
 			-> std::optional<Cesium3DTilesSelection::GltfModifierOutput>
 			{
 				return Cesium3DTilesSelection::GltfModifierOutput{
-					GltfTunerHelper(previousModel, impl_->rulesEx_, impl_->materialHelper_,
-									tileTransform_shifted)
-						.Tune()
+					GltfTunerHelper(previousModel, *rulesEx, materialHelper, tileTransform_shifted).Tune()
 				};
 			});
 	}
@@ -908,7 +1207,7 @@ CesiumAsync::Future<std::optional<Cesium3DTilesSelection::GltfModifierOutput>> G
 }
 
 bool GltfTuner::applyForUnitTest(const CesiumGltf::Model& model, const glm::dmat4& tileTransform,
-								 CesiumGltf::Model& tunedModel)
+								 CesiumGltf::Model& tunedModel, bool const bParallel /*= true*/)
 {
 	impl_->UpdateRulesIfNeeded(*this);
 	glm::dmat4x4 const tileTransform_shifted = tileTransform - glm::dmat4x4(
@@ -917,9 +1216,12 @@ bool GltfTuner::applyForUnitTest(const CesiumGltf::Model& model, const glm::dmat
 	if (getCurrentVersion()
 		&& Cesium3DTilesSelection::GltfModifierVersionExtension::getVersion(model) < (*getCurrentVersion()))
 	{
+		const auto rulesEx = impl_->rulesEx_;
+		const int64_t version = *getCurrentVersion();
+		rlock.unlock();
 		tunedModel = std::move(
-			GltfTunerHelper(model, impl_->rulesEx_, impl_->materialHelper_, tileTransform_shifted).Tune());
-		Cesium3DTilesSelection::GltfModifierVersionExtension::setVersion(tunedModel, *getCurrentVersion());
+			GltfTunerHelper(model, *rulesEx, impl_->materialHelper_, tileTransform_shifted, bParallel).Tune());
+		Cesium3DTilesSelection::GltfModifierVersionExtension::setVersion(tunedModel, version);
 		return true;
 	}
 	return false;
@@ -932,8 +1234,8 @@ int64_t GltfTuner::SetMaterialRules(Rules&& tuningRules)
 	BeUtils::WLock wlock(impl_->mutex_);
 	// Optimize when resetting this type of rules several times
 	if (tuningRules.materialGroups_.empty() && tuningRules.itwinMatIDsToSplit_.empty()
-		&& impl_->rulesEx_.tuningRules_.materialGroups_.empty()
-		&& impl_->rulesEx_.tuningRules_.itwinMatIDsToSplit_.empty())
+		&& impl_->rulesEx_->material_->groups_.empty()
+		&& impl_->rulesEx_->material_->itwinMatIDsToSplit_.empty())
 	{
 		return getCurrentVersion() ? (*getCurrentVersion()) : std::numeric_limits<int64_t>::max();
 	}
@@ -950,7 +1252,7 @@ int64_t GltfTuner::SetAnim4DRules(Rules&& tuningRules)
 	// For now we assume it is the responsibility of the caller to call this only when needed.
 	BeUtils::WLock wlock(impl_->mutex_);
 	// Optimize when resetting this type of rules several times
-	if (tuningRules.anim4DGroups_.empty() && impl_->rulesEx_.tuningRules_.anim4DGroups_.empty())
+	if (tuningRules.anim4DGroups_.empty() && impl_->rulesEx_->anim4D_->groups_.empty())
 	{
 		return getCurrentVersion() ? (*getCurrentVersion()) : std::numeric_limits<int64_t>::max();
 	}
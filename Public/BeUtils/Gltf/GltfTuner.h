@@ -110,8 +110,9 @@ public:
 
 	void SetMaterialHelper(std::shared_ptr<GltfMaterialHelper> const& matHelper);
 
+	/// \param bParallel Pass false to classify the primitives sequentially, in the calling thread.
 	bool applyForUnitTest(const CesiumGltf::Model& model, const glm::dmat4& tileTransform,
-		CesiumGltf::Model& tunedModel);
+		CesiumGltf::Model& tunedModel, bool const bParallel = true);
 
 private:
 	CesiumAsync::Future<void> onRegister(
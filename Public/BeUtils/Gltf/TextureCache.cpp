@@ -0,0 +1,359 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TextureCache.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <BeUtils/Gltf/TextureCache.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <spdlog/fmt/fmt.h>
+
+#include <SDK/Core/Tools/Assert.h>
+#include <SDK/Core/Tools/Log.h>
+
+namespace BeUtils
+{
+
+	namespace
+	{
+		constexpr uint64_t FNV_PRIME = 0x100000001b3;
+		constexpr char const* INDEX_FILE_NAME = "index.txt";
+		constexpr char const* INDEX_HEADER_V1 = "BeUtilsTextureCache 1";
+		//! Version 2: journal of "+ key bytes lastUse flags" and "- key" records, the last one wins.
+		constexpr char const* INDEX_HEADER = "BeUtilsTextureCache 2";
+
+		std::string FormatAddRecord(uint64_t key, uint64_t bytes, uint64_t lastUse, uint32_t flags)
+		{
+			return fmt::format("+ {:016x} {} {} {}\n", key, bytes, lastUse, flags);
+		}
+	}
+
+	TextureCache::KeyBuilder& TextureCache::KeyBuilder::Add(void const* data, std::size_t size)
+	{
+		// FNV-1a, processing 8 bytes at a time (textures can be large), with an additional shift to
+		// propagate the high bits of each word to the low bits of the hash.
+		auto const* bytes = static_cast<unsigned char const*>(data);
+		std::size_t i = 0;
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t word;
+			std::memcpy(&word, bytes + i, sizeof(uint64_t));
+			hash_ = (hash_ ^ word) * FNV_PRIME;
+			hash_ ^= hash_ >> 29;
+		}
+		for (; i < size; ++i)
+		{
+			hash_ = (hash_ ^ uint64_t(bytes[i])) * FNV_PRIME;
+		}
+		return *this;
+	}
+
+	TextureCache::KeyBuilder& TextureCache::KeyBuilder::Add(std::string_view const& str)
+	{
+		// Include the length, so that consecutive strings cannot be confused.
+		Add(uint64_t(str.size()));
+		return Add(str.data(), str.size());
+	}
+
+	/*static*/
+	std::shared_ptr<TextureCache> TextureCache::Get(std::filesystem::path const& directory)
+	{
+		static std::mutex registryMutex;
+		// Caches are kept until exit, so that their index is only read once.
+		static std::map<std::filesystem::path, std::shared_ptr<TextureCache>> registry;
+
+		std::filesystem::path const key = directory.lexically_normal();
+		std::unique_lock<std::mutex> lock(registryMutex);
+		auto& cache = registry[key];
+		if (!cache)
+		{
+			cache = std::make_shared<TextureCache>(key);
+		}
+		return cache;
+	}
+
+	TextureCache::TextureCache(std::filesystem::path const& directory, uint64_t maxBytes)
+		: directory_(directory)
+		, maxBytes_(maxBytes)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		LoadIndex();
+	}
+
+	TextureCache::~TextureCache()
+	{
+		Flush();
+	}
+
+	void TextureCache::SetMaxBytes(uint64_t maxBytes)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		maxBytes_ = maxBytes;
+		std::string records;
+		if (std::size_t const recordCount = EvictIfNeeded(records))
+		{
+			AppendToIndex(records, recordCount);
+		}
+	}
+
+	uint64_t TextureCache::GetMaxBytes() const
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		return maxBytes_;
+	}
+
+	uint64_t TextureCache::GetTotalBytes() const
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		return totalBytes_;
+	}
+
+	std::size_t TextureCache::GetEntryCount() const
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		return entries_.size();
+	}
+
+	std::filesystem::path TextureCache::GetFilePath(Key key) const
+	{
+		return directory_ / fmt::format("{:016x}.png", key);
+	}
+
+	std::optional<TextureCache::Entry> TextureCache::Find(Key key)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		auto it = entries_.find(key);
+		if (it == entries_.end())
+		{
+			return std::nullopt;
+		}
+		std::filesystem::path filePath = GetFilePath(key);
+		std::error_code ec;
+		if (!std::filesystem::exists(filePath, ec))
+		{
+			// The file was removed behind our back.
+			totalBytes_ -= it->second.bytes;
+			entries_.erase(it);
+			AppendToIndex(fmt::format("- {:016x}\n", key), 1);
+			return std::nullopt;
+		}
+		// Last uses are only saved when the index is rewritten (see Flush).
+		it->second.lastUse = ++useCounter_;
+		isDirty_ = true;
+		return Entry{ std::move(filePath), it->second.flags };
+	}
+
+	std::optional<std::filesystem::path> TextureCache::Store(Key key, std::vector<std::byte> const& content,
+		uint32_t flags)
+	{
+		std::filesystem::path const filePath = GetFilePath(key);
+		std::error_code ec;
+		std::filesystem::create_directories(directory_, ec);
+
+		// Write to a temporary file first, so that an interrupted write never leaves a truncated entry.
+		std::filesystem::path tmpPath = filePath;
+		tmpPath += fmt::format(".{:x}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+		{
+			std::ofstream file(tmpPath, std::ios::binary | std::ios::out | std::ios::trunc);
+			if (file)
+			{
+				file.write(reinterpret_cast<char const*>(content.data()), content.size());
+			}
+			if (!file)
+			{
+				BE_LOGW("ITwinMaterial", "could not write texture cache entry " << tmpPath.generic_string());
+				file.close();
+				std::filesystem::remove(tmpPath, ec);
+				return std::nullopt;
+			}
+		}
+		std::filesystem::rename(tmpPath, filePath, ec);
+		if (ec)
+		{
+			BE_LOGW("ITwinMaterial", "could not write texture cache entry " << filePath.generic_string()
+				<< ": " << ec.message());
+			std::filesystem::remove(tmpPath, ec);
+			return std::nullopt;
+		}
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		IndexEntry& entry = entries_[key];
+		totalBytes_ -= entry.bytes;
+		entry.bytes = content.size();
+		entry.lastUse = ++useCounter_;
+		entry.flags = flags;
+		totalBytes_ += entry.bytes;
+		std::string records = FormatAddRecord(key, entry.bytes, entry.lastUse, entry.flags);
+		std::size_t const recordCount = 1 + EvictIfNeeded(records);
+		AppendToIndex(records, recordCount);
+		return filePath;
+	}
+
+	void TextureCache::Remove(Key key)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		auto it = entries_.find(key);
+		if (it == entries_.end())
+		{
+			return;
+		}
+		totalBytes_ -= it->second.bytes;
+		entries_.erase(it);
+		std::error_code ec;
+		std::filesystem::remove(GetFilePath(key), ec);
+		AppendToIndex(fmt::format("- {:016x}\n", key), 1);
+	}
+
+	void TextureCache::Flush()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		SaveIndex();
+	}
+
+	std::size_t TextureCache::EvictIfNeeded(std::string& records)
+	{
+		if (totalBytes_ <= maxBytes_)
+		{
+			return 0;
+		}
+		// Evict down to 7/8 of the budget, so that it does not happen again at the next insertion.
+		uint64_t const target = maxBytes_ - maxBytes_ / 8;
+		std::vector<std::pair<uint64_t, Key>> byLastUse;
+		byLastUse.reserve(entries_.size());
+		for (auto const& [key, entry] : entries_)
+		{
+			byLastUse.emplace_back(entry.lastUse, key);
+		}
+		std::sort(byLastUse.begin(), byLastUse.end());
+		std::error_code ec;
+		std::size_t evictedCount = 0;
+		for (auto const& [lastUse, key] : byLastUse)
+		{
+			if (totalBytes_ <= target)
+			{
+				break;
+			}
+			auto it = entries_.find(key);
+			totalBytes_ -= it->second.bytes;
+			entries_.erase(it);
+			std::filesystem::remove(GetFilePath(key), ec);
+			records += fmt::format("- {:016x}\n", key);
+			++evictedCount;
+		}
+		return evictedCount;
+	}
+
+	void TextureCache::LoadIndex()
+	{
+		std::ifstream file(directory_ / INDEX_FILE_NAME);
+		if (!file)
+		{
+			return;
+		}
+		std::string header;
+		std::getline(file, header);
+		bool const isV1 = (header == INDEX_HEADER_V1);
+		if (!isV1 && header != INDEX_HEADER)
+		{
+			BE_LOGW("ITwinMaterial", "ignoring texture cache index with unknown format in "
+				<< directory_.generic_string());
+			return;
+		}
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::istringstream record(line);
+			char op = '+';
+			if (!isV1)
+			{
+				record >> op;
+			}
+			Key key = 0;
+			if (!(record >> std::hex >> key >> std::dec))
+			{
+				continue;
+			}
+			++indexRecordCount_;
+			auto it = entries_.find(key);
+			if (it != entries_.end())
+			{
+				totalBytes_ -= it->second.bytes;
+				entries_.erase(it);
+			}
+			IndexEntry entry;
+			if (op == '+' && record >> entry.bytes >> entry.lastUse >> entry.flags)
+			{
+				entries_.emplace(key, entry);
+				totalBytes_ += entry.bytes;
+				useCounter_ = std::max(useCounter_, entry.lastUse);
+			}
+		}
+		// An index in the previous format is rewritten before anything is appended to it.
+		hasValidIndex_ = !isV1;
+	}
+
+	void TextureCache::AppendToIndex(std::string const& records, std::size_t recordCount)
+	{
+		indexRecordCount_ += recordCount;
+		// Compact the journal once most of its records are overridden.
+		if (!hasValidIndex_ || indexRecordCount_ > 2 * entries_.size() + 64)
+		{
+			isDirty_ = true;
+			SaveIndex();
+			return;
+		}
+		std::ofstream file(directory_ / INDEX_FILE_NAME, std::ios::out | std::ios::app);
+		file << records;
+		if (!file)
+		{
+			BE_LOGW("ITwinMaterial", "could not write texture cache index in " << directory_.generic_string());
+			// Rewrite the whole index next time.
+			hasValidIndex_ = false;
+		}
+	}
+
+	void TextureCache::SaveIndex()
+	{
+		if (!isDirty_)
+		{
+			return;
+		}
+		std::error_code ec;
+		std::filesystem::create_directories(directory_, ec);
+		std::filesystem::path const indexPath = directory_ / INDEX_FILE_NAME;
+		std::filesystem::path tmpPath = indexPath;
+		tmpPath += ".tmp";
+		{
+			std::ofstream file(tmpPath, std::ios::out | std::ios::trunc);
+			file << INDEX_HEADER << '\n';
+			for (auto const& [key, entry] : entries_)
+			{
+				file << FormatAddRecord(key, entry.bytes, entry.lastUse, entry.flags);
+			}
+			if (!file)
+			{
+				BE_LOGW("ITwinMaterial", "could not write texture cache index in " << directory_.generic_string());
+				return;
+			}
+		}
+		std::filesystem::rename(tmpPath, indexPath, ec);
+		if (ec)
+		{
+			BE_LOGW("ITwinMaterial", "could not write texture cache index in " << directory_.generic_string()
+				<< ": " << ec.message());
+			return;
+		}
+		indexRecordCount_ = entries_.size();
+		hasValidIndex_ = true;
+		isDirty_ = false;
+	}
+
+} // namespace BeUtils
@@ -0,0 +1,120 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TextureCache.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace BeUtils
+{
+
+	//! Persistent, content-addressed cache for textures computed from other textures (merged material
+	//! channels, thumbnails...).
+	//! Each entry is keyed by a hash of the source texture contents and of the parameters of the
+	//! computation, so that an entry can be reused as long as none of them changes, even in another
+	//! session. Entries are stored as individual files in the cache directory, and listed in a small
+	//! index file holding their size and last use: when the total size exceeds the budget, the least
+	//! recently used entries are evicted.
+	//! The index is a journal: new and removed entries are appended to it, and it is only rewritten
+	//! (compacted, with the last use of each entry) by Flush.
+	class TextureCache
+	{
+	public:
+		using Key = uint64_t;
+
+		//! Incremental (non-cryptographic) hash of the data identifying an entry.
+		class KeyBuilder
+		{
+		public:
+			KeyBuilder& Add(void const* data, std::size_t size);
+			KeyBuilder& Add(std::string_view const& str);
+			template <typename T>
+			std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>, KeyBuilder&> Add(T const value) {
+				return Add(&value, sizeof(T));
+			}
+			Key Get() const { return hash_; }
+
+		private:
+			uint64_t hash_ = 0xcbf29ce484222325;
+		};
+
+		struct Entry
+		{
+			std::filesystem::path filePath;
+			uint32_t flags = 0; //!< Additional information on the content, defined by the caller.
+		};
+
+		static constexpr uint64_t DEFAULT_MAX_BYTES = uint64_t(1) << 30;
+
+		//! Returns the cache stored in the given directory (shared by all callers using this directory).
+		static std::shared_ptr<TextureCache> Get(std::filesystem::path const& directory);
+
+		TextureCache(std::filesystem::path const& directory, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+		~TextureCache();
+
+		std::filesystem::path const& GetDirectory() const { return directory_; }
+
+		void SetMaxBytes(uint64_t maxBytes);
+		uint64_t GetMaxBytes() const;
+		uint64_t GetTotalBytes() const;
+		std::size_t GetEntryCount() const;
+
+		//! Returns the entry for the given key, if it is cached, and marks it as used.
+		std::optional<Entry> Find(Key key);
+
+		//! Writes the given content (PNG) for the given key, and returns the path of the new entry's file.
+		//! Least recently used entries may be evicted.
+		std::optional<std::filesystem::path> Store(Key key, std::vector<std::byte> const& content,
+			uint32_t flags = 0);
+
+		//! Removes the entry (typically because its file could not be decoded).
+		void Remove(Key key);
+
+		//! Rewrites the index file if it was modified since it was read or last written.
+		void Flush();
+
+	private:
+		struct IndexEntry
+		{
+			uint64_t bytes = 0;
+			uint64_t lastUse = 0;
+			uint32_t flags = 0;
+		};
+
+		std::filesystem::path GetFilePath(Key key) const;
+		void LoadIndex();
+		void SaveIndex();
+		//! Appends the given records to the index file (or rewrites it when it needs to be compacted).
+		void AppendToIndex(std::string const& records, std::size_t recordCount);
+		//! Evicts the least recently used entries if needed, adding their removal records to records.
+		std::size_t EvictIfNeeded(std::string& records);
+
+		std::filesystem::path const directory_;
+		mutable std::mutex mutex_;
+		std::unordered_map<Key, IndexEntry> entries_;
+		uint64_t maxBytes_ = DEFAULT_MAX_BYTES;
+		uint64_t totalBytes_ = 0;
+		uint64_t useCounter_ = 0;
+		//! Number of records in the index file, including the overridden ones.
+		std::size_t indexRecordCount_ = 0;
+		//! Whether the index file exists in the current format (else records cannot be appended to it).
+		bool hasValidIndex_ = false;
+		//! Whether the index file should be rewritten (eg. last uses have changed).
+		bool isDirty_ = false;
+	};
+
+} // namespace BeUtils
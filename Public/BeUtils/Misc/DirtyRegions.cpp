@@ -0,0 +1,170 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: DirtyRegions.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <BeUtils/Misc/DirtyRegions.h>
+
+#include <SDK/Core/Tools/Assert.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace BeUtils
+{
+
+	namespace
+	{
+		//! Smallest rectangle containing both a and b.
+		DirtyRegions::Rect Union(DirtyRegions::Rect const& a, DirtyRegions::Rect const& b)
+		{
+			uint32_t const x0 = std::min(a.x, b.x);
+			uint32_t const y0 = std::min(a.y, b.y);
+			uint32_t const x1 = std::max(a.x + a.width, b.x + b.width);
+			uint32_t const y1 = std::max(a.y + a.height, b.y + b.height);
+			return { x0, y0, x1 - x0, y1 - y0 };
+		}
+	}
+
+	void DirtyRegions::Reset(uint32_t width, uint32_t height)
+	{
+		width_ = width;
+		height_ = height;
+		rowMin_.assign(height, std::numeric_limits<uint32_t>::max());
+		rowMax_.assign(height, 0);
+		MarkAll();
+	}
+
+	void DirtyRegions::MarkPixel(uint32_t x, uint32_t y)
+	{
+		if (x >= width_ || y >= height_)
+		{
+			BE_ISSUE("pixel out of image", x, y);
+			return;
+		}
+		if (allDirty_)
+		{
+			return;
+		}
+		rowMin_[y] = std::min(rowMin_[y], x);
+		rowMax_[y] = std::max(rowMax_[y], x);
+		if (IsDirty())
+		{
+			firstDirtyRow_ = std::min(firstDirtyRow_, y);
+			lastDirtyRow_ = std::max(lastDirtyRow_, y);
+		}
+		else
+		{
+			firstDirtyRow_ = lastDirtyRow_ = y;
+		}
+	}
+
+	void DirtyRegions::MarkAll()
+	{
+		if (width_ == 0 || height_ == 0)
+		{
+			return;
+		}
+		std::fill(rowMin_.begin(), rowMin_.end(), 0);
+		std::fill(rowMax_.begin(), rowMax_.end(), width_ - 1);
+		firstDirtyRow_ = 0;
+		lastDirtyRow_ = height_ - 1;
+		allDirty_ = true;
+	}
+
+	void DirtyRegions::Clear()
+	{
+		if (IsDirty())
+		{
+			// Only the dirty rows need resetting.
+			std::fill(rowMin_.begin() + firstDirtyRow_, rowMin_.begin() + lastDirtyRow_ + 1,
+				std::numeric_limits<uint32_t>::max());
+			std::fill(rowMax_.begin() + firstDirtyRow_, rowMax_.begin() + lastDirtyRow_ + 1, 0);
+		}
+		firstDirtyRow_ = 1;
+		lastDirtyRow_ = 0;
+		allDirty_ = false;
+	}
+
+	void DirtyRegions::Coalesce(std::vector<Rect>& rects, std::size_t maxRects, uint64_t regionCost) const
+	{
+		rects.clear();
+		if (!IsDirty())
+		{
+			return;
+		}
+		if (allDirty_ || maxRects <= 1)
+		{
+			rects.push_back({ 0, firstDirtyRow_, width_, lastDirtyRow_ - firstDirtyRow_ + 1 });
+			if (!allDirty_)
+			{
+				uint32_t x0 = width_, x1 = 0;
+				for (uint32_t y = firstDirtyRow_; y <= lastDirtyRow_; ++y)
+				{
+					if (rowMin_[y] <= rowMax_[y])
+					{
+						x0 = std::min(x0, rowMin_[y]);
+						x1 = std::max(x1, rowMax_[y]);
+					}
+				}
+				rects.back().x = x0;
+				rects.back().width = x1 - x0 + 1;
+			}
+			return;
+		}
+		// Grow a rectangle row by row, as long as the clean pixels it covers cost less than a new region.
+		for (uint32_t y = firstDirtyRow_; y <= lastDirtyRow_; ++y)
+		{
+			if (rowMin_[y] > rowMax_[y])
+			{
+				continue;
+			}
+			Rect const row{ rowMin_[y], y, rowMax_[y] - rowMin_[y] + 1, 1 };
+			if (!rects.empty())
+			{
+				Rect const merged = Union(rects.back(), row);
+				if (merged.Area() <= rects.back().Area() + row.Area() + regionCost)
+				{
+					rects.back() = merged;
+					continue;
+				}
+			}
+			rects.push_back(row);
+		}
+		// Then merge neighbouring rectangles until there are few enough, cheapest merges first. Rectangles are
+		// sorted by y and do not overlap vertically, so the union of two neighbours does not overlap the others.
+		std::vector<uint64_t> costs, sortedCosts;
+		while (rects.size() > maxRects)
+		{
+			std::size_t const excess = rects.size() - maxRects;
+			costs.resize(rects.size() - 1);
+			for (std::size_t i = 0; i + 1 < rects.size(); ++i)
+			{
+				costs[i] = Union(rects[i], rects[i + 1]).Area() - rects[i].Area() - rects[i + 1].Area();
+			}
+			sortedCosts = costs;
+			std::nth_element(sortedCosts.begin(), sortedCosts.begin() + (excess - 1), sortedCosts.end());
+			uint64_t const maxCost = sortedCosts[excess - 1];
+			// Merge disjoint pairs (at least one) in a single pass, so that the loop runs only a few times.
+			std::size_t merges = 0, kept = 0;
+			for (std::size_t i = 0; i < rects.size(); )
+			{
+				if (merges < excess && i + 1 < rects.size() && costs[i] <= maxCost)
+				{
+					rects[kept++] = Union(rects[i], rects[i + 1]);
+					i += 2;
+					++merges;
+				}
+				else
+				{
+					rects[kept++] = rects[i++];
+				}
+			}
+			rects.resize(kept);
+		}
+	}
+
+} // namespace BeUtils
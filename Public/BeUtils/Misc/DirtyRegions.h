@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: DirtyRegions.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace BeUtils
+{
+
+//! Tracks which pixels of an image were modified since the last upload, so that only the modified regions
+//! need to be uploaded: used by the dynamic textures storing per-feature properties (highlight, 4D color...),
+//! where each update usually touches a few pixels only.
+//! The dirty pixels of each row are tracked as a single span [min, max], and Coalesce() merges the spans of
+//! neighbouring rows into rectangles when it does not add too many clean pixels.
+class DirtyRegions
+{
+public:
+	struct Rect
+	{
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+
+		uint64_t Area() const { return uint64_t(width) * height; }
+		bool operator==(Rect const&) const = default;
+	};
+
+	DirtyRegions() = default;
+	//! The whole image is initially dirty.
+	DirtyRegions(uint32_t width, uint32_t height) { Reset(width, height); }
+
+	//! Resizes the tracked image: the whole image becomes dirty.
+	void Reset(uint32_t width, uint32_t height);
+	uint32_t Width() const { return width_; }
+	uint32_t Height() const { return height_; }
+
+	void MarkPixel(uint32_t x, uint32_t y);
+	//! Marks a pixel given by its index in row-major order.
+	void MarkPixel(uint32_t pixel) { MarkPixel(pixel % width_, pixel / width_); }
+	void MarkAll();
+	//! Marks everything as clean, typically after an upload.
+	void Clear();
+	bool IsDirty() const { return firstDirtyRow_ <= lastDirtyRow_; }
+	bool IsAllDirty() const { return allDirty_; }
+
+	//! Computes non-overlapping rectangles covering all dirty pixels, in increasing order of y.
+	//! \param maxRects Maximum number of rectangles: neighbouring rectangles are merged until there are no
+	//!		more than this.
+	//! \param regionCost Number of (clean) pixels it is worth uploading to save a rectangle, ie. the
+	//!		estimated overhead of a separate upload.
+	void Coalesce(std::vector<Rect>& rects, std::size_t maxRects = 16, uint64_t regionCost = 256) const;
+
+private:
+	uint32_t width_ = 0;
+	uint32_t height_ = 0;
+	//! Dirty span of each row: the row is clean when rowMin_ > rowMax_.
+	std::vector<uint32_t> rowMin_;
+	std::vector<uint32_t> rowMax_;
+	//! Range of the dirty rows: nothing is dirty when firstDirtyRow_ > lastDirtyRow_.
+	uint32_t firstDirtyRow_ = 1;
+	uint32_t lastDirtyRow_ = 0;
+	//! Avoids coalescing when everything is to be uploaded anyway.
+	bool allDirty_ = false;
+};
+
+} // namespace BeUtils
@@ -0,0 +1,674 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ImageKernels.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "ImageKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+	#define BE_IMAGE_KERNELS_X64 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		// MSVC accepts AVX2 intrinsics in any function.
+		#define BE_TARGET_AVX2
+	#else
+		#define BE_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define BE_IMAGE_KERNELS_NEON 1
+	#include <arm_neon.h>
+#endif
+
+namespace BeUtils::ImageKernels
+{
+
+	namespace
+	{
+		// Bilinear weights are stored on 7 bits, so that the horizontally interpolated values (at most
+		// 255 * 128) fit in signed 16-bit integers (see _mm_madd_epi16).
+		constexpr int BILINEAR_SHIFT = 7;
+		constexpr int BILINEAR_ONE = 1 << BILINEAR_SHIFT;
+
+		inline uint8_t* Bytes(std::byte* p) { return reinterpret_cast<uint8_t*>(p); }
+		inline uint8_t const* Bytes(std::byte const* p) { return reinterpret_cast<uint8_t const*>(p); }
+
+		//--------------------------------------------------------------------------------------------------
+		// Scalar implementation (reference)
+		//--------------------------------------------------------------------------------------------------
+
+		void ExtractIntensityScalar(uint8_t* dst, unsigned dstChannel, uint8_t const* src, std::size_t pixelCount)
+		{
+			for (std::size_t i = 0; i < pixelCount; ++i, dst += 4, src += 4)
+			{
+				dst[dstChannel] = Intensity(src[0], src[1], src[2]);
+			}
+		}
+
+		bool HasPartialAlphaScalar(uint8_t const* src, std::size_t pixelCount, EAlphaSource alphaSource)
+		{
+			for (std::size_t i = 0; i < pixelCount; ++i, src += 4)
+			{
+				uint8_t const alpha = (alphaSource == EAlphaSource::AlphaChannel)
+					? src[3] : Intensity(src[0], src[1], src[2]);
+				if (alpha != 0 && alpha != 255)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Computes dstWidth pixels of a downsampled row from 2 source rows.
+		void Box2xRowScalar(uint8_t* dst, uint8_t const* row0, uint8_t const* row1, int dstWidth)
+		{
+			for (int x = 0; x < dstWidth; ++x, dst += 4, row0 += 8, row1 += 8)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					dst[c] = static_cast<uint8_t>((row0[c] + row0[c + 4] + row1[c] + row1[c + 4] + 2) >> 2);
+				}
+			}
+		}
+
+		// Interpolates count values between 2 horizontally interpolated rows (see ResampleBilinear).
+		void LerpRowScalar(uint8_t* dst, uint16_t const* top, uint16_t const* bottom, std::size_t count,
+			int bottomWeight)
+		{
+			int const topWeight = BILINEAR_ONE - bottomWeight;
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				dst[i] = static_cast<uint8_t>(
+					(top[i] * topWeight + bottom[i] * bottomWeight + (1 << (2 * BILINEAR_SHIFT - 1)))
+						>> (2 * BILINEAR_SHIFT));
+			}
+		}
+
+#if BE_IMAGE_KERNELS_X64
+		//--------------------------------------------------------------------------------------------------
+		// SSE2 implementation (always available on x64)
+		//--------------------------------------------------------------------------------------------------
+
+		// Returns the intensities of 4 pixels, as 32-bit integers.
+		inline __m128i IntensitySSE2(__m128i const pixels)
+		{
+			__m128i const zero = _mm_setzero_si128();
+			__m128i const weights = _mm_setr_epi16(90, 128, 38, 0, 90, 128, 38, 0);
+			// (90 R + 128 G, 38 B) for each pixel
+			__m128 const lo = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), weights));
+			__m128 const hi = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), weights));
+			__m128i const sum = _mm_add_epi32(
+				_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+				_mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+			return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(128)), 8);
+		}
+
+		void ExtractIntensitySSE2(uint8_t* dst, unsigned dstChannel, uint8_t const* src, std::size_t pixelCount)
+		{
+			__m128i const shift = _mm_cvtsi32_si128(static_cast<int>(8 * dstChannel));
+			__m128i const keepMask = _mm_set1_epi32(static_cast<int>(~(0xFFu << (8 * dstChannel))));
+			std::size_t i = 0;
+			for (; i + 4 <= pixelCount; i += 4)
+			{
+				__m128i const value = _mm_sll_epi32(
+					IntensitySSE2(_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 4 * i))), shift);
+				__m128i* const pDst = reinterpret_cast<__m128i*>(dst + 4 * i);
+				_mm_storeu_si128(pDst, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(pDst), keepMask), value));
+			}
+			ExtractIntensityScalar(dst + 4 * i, dstChannel, src + 4 * i, pixelCount - i);
+		}
+
+		bool HasPartialAlphaSSE2(uint8_t const* src, std::size_t pixelCount, EAlphaSource alphaSource)
+		{
+			__m128i const zero = _mm_setzero_si128();
+			std::size_t i = 0;
+			if (alphaSource == EAlphaSource::AlphaChannel)
+			{
+				__m128i const full = _mm_set1_epi8(-1);
+				for (; i + 4 <= pixelCount; i += 4)
+				{
+					__m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 4 * i));
+					__m128i const isOpaqueOrEmpty = _mm_or_si128(
+						_mm_cmpeq_epi8(pixels, zero), _mm_cmpeq_epi8(pixels, full));
+					if ((_mm_movemask_epi8(isOpaqueOrEmpty) & 0x8888) != 0x8888)
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				__m128i const full = _mm_set1_epi32(255);
+				for (; i + 4 <= pixelCount; i += 4)
+				{
+					__m128i const alpha = IntensitySSE2(
+						_mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 4 * i)));
+					__m128i const isOpaqueOrEmpty = _mm_or_si128(
+						_mm_cmpeq_epi32(alpha, zero), _mm_cmpeq_epi32(alpha, full));
+					if (_mm_movemask_epi8(isOpaqueOrEmpty) != 0xFFFF)
+					{
+						return true;
+					}
+				}
+			}
+			return HasPartialAlphaScalar(src + 4 * i, pixelCount - i, alphaSource);
+		}
+
+		// Returns the 2 downsampled pixels computed from 4 pixels of 2 rows, as 16-bit integers.
+		inline __m128i Box2xSSE2(__m128i const row0, __m128i const row1)
+		{
+			__m128i const zero = _mm_setzero_si128();
+			__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+			__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+			lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+			hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+			return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_set1_epi16(2)), 2);
+		}
+
+		void Box2xRowSSE2(uint8_t* dst, uint8_t const* row0, uint8_t const* row1, int dstWidth)
+		{
+			int x = 0;
+			for (; x + 4 <= dstWidth; x += 4)
+			{
+				__m128i const* const p0 = reinterpret_cast<__m128i const*>(row0 + 8 * x);
+				__m128i const* const p1 = reinterpret_cast<__m128i const*>(row1 + 8 * x);
+				__m128i const first = Box2xSSE2(_mm_loadu_si128(p0), _mm_loadu_si128(p1));
+				__m128i const second = Box2xSSE2(_mm_loadu_si128(p0 + 1), _mm_loadu_si128(p1 + 1));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4 * x), _mm_packus_epi16(first, second));
+			}
+			Box2xRowScalar(dst + 4 * x, row0 + 8 * x, row1 + 8 * x, dstWidth - x);
+		}
+
+		// Returns 8 interpolated values, as 16-bit integers.
+		inline __m128i LerpSSE2(__m128i const top, __m128i const bottom, __m128i const weights)
+		{
+			__m128i const rounding = _mm_set1_epi32(1 << (2 * BILINEAR_SHIFT - 1));
+			__m128i const lo = _mm_srli_epi32(_mm_add_epi32(
+				_mm_madd_epi16(_mm_unpacklo_epi16(top, bottom), weights), rounding), 2 * BILINEAR_SHIFT);
+			__m128i const hi = _mm_srli_epi32(_mm_add_epi32(
+				_mm_madd_epi16(_mm_unpackhi_epi16(top, bottom), weights), rounding), 2 * BILINEAR_SHIFT);
+			return _mm_packs_epi32(lo, hi);
+		}
+
+		void LerpRowSSE2(uint8_t* dst, uint16_t const* top, uint16_t const* bottom, std::size_t count,
+			int bottomWeight)
+		{
+			// (top weight, bottom weight) pairs
+			__m128i const weights = _mm_set1_epi32((bottomWeight << 16) | (BILINEAR_ONE - bottomWeight));
+			std::size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				__m128i const* const pTop = reinterpret_cast<__m128i const*>(top + i);
+				__m128i const* const pBottom = reinterpret_cast<__m128i const*>(bottom + i);
+				__m128i const first = LerpSSE2(_mm_loadu_si128(pTop), _mm_loadu_si128(pBottom), weights);
+				__m128i const second = LerpSSE2(_mm_loadu_si128(pTop + 1), _mm_loadu_si128(pBottom + 1), weights);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(first, second));
+			}
+			LerpRowScalar(dst + i, top + i, bottom + i, count - i, bottomWeight);
+		}
+
+		//--------------------------------------------------------------------------------------------------
+		// AVX2 implementation (the same as SSE2, on 2 128-bit lanes)
+		//--------------------------------------------------------------------------------------------------
+
+		BE_TARGET_AVX2 inline __m256i IntensityAVX2(__m256i const pixels)
+		{
+			__m256i const zero = _mm256_setzero_si256();
+			__m256i const weights = _mm256_setr_epi16(90, 128, 38, 0, 90, 128, 38, 0,
+				90, 128, 38, 0, 90, 128, 38, 0);
+			__m256 const lo = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpacklo_epi8(pixels, zero), weights));
+			__m256 const hi = _mm256_castsi256_ps(_mm256_madd_epi16(_mm256_unpackhi_epi8(pixels, zero), weights));
+			__m256i const sum = _mm256_add_epi32(
+				_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0))),
+				_mm256_castps_si256(_mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1))));
+			return _mm256_srli_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(128)), 8);
+		}
+
+		BE_TARGET_AVX2 void ExtractIntensityAVX2(uint8_t* dst, unsigned dstChannel, uint8_t const* src,
+			std::size_t pixelCount)
+		{
+			__m128i const shift = _mm_cvtsi32_si128(static_cast<int>(8 * dstChannel));
+			__m256i const keepMask = _mm256_set1_epi32(static_cast<int>(~(0xFFu << (8 * dstChannel))));
+			std::size_t i = 0;
+			for (; i + 8 <= pixelCount; i += 8)
+			{
+				__m256i const value = _mm256_sll_epi32(
+					IntensityAVX2(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 4 * i))), shift);
+				__m256i* const pDst = reinterpret_cast<__m256i*>(dst + 4 * i);
+				_mm256_storeu_si256(pDst,
+					_mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(pDst), keepMask), value));
+			}
+			ExtractIntensityScalar(dst + 4 * i, dstChannel, src + 4 * i, pixelCount - i);
+		}
+
+		BE_TARGET_AVX2 bool HasPartialAlphaAVX2(uint8_t const* src, std::size_t pixelCount, EAlphaSource alphaSource)
+		{
+			__m256i const zero = _mm256_setzero_si256();
+			std::size_t i = 0;
+			if (alphaSource == EAlphaSource::AlphaChannel)
+			{
+				__m256i const full = _mm256_set1_epi8(-1);
+				for (; i + 8 <= pixelCount; i += 8)
+				{
+					__m256i const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 4 * i));
+					__m256i const isOpaqueOrEmpty = _mm256_or_si256(
+						_mm256_cmpeq_epi8(pixels, zero), _mm256_cmpeq_epi8(pixels, full));
+					if ((static_cast<uint32_t>(_mm256_movemask_epi8(isOpaqueOrEmpty)) & 0x88888888u) != 0x88888888u)
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				__m256i const full = _mm256_set1_epi32(255);
+				for (; i + 8 <= pixelCount; i += 8)
+				{
+					__m256i const alpha = IntensityAVX2(
+						_mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 4 * i)));
+					__m256i const isOpaqueOrEmpty = _mm256_or_si256(
+						_mm256_cmpeq_epi32(alpha, zero), _mm256_cmpeq_epi32(alpha, full));
+					if (static_cast<uint32_t>(_mm256_movemask_epi8(isOpaqueOrEmpty)) != 0xFFFFFFFFu)
+					{
+						return true;
+					}
+				}
+			}
+			return HasPartialAlphaScalar(src + 4 * i, pixelCount - i, alphaSource);
+		}
+
+		BE_TARGET_AVX2 inline __m256i Box2xAVX2(__m256i const row0, __m256i const row1)
+		{
+			__m256i const zero = _mm256_setzero_si256();
+			__m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero), _mm256_unpacklo_epi8(row1, zero));
+			__m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero), _mm256_unpackhi_epi8(row1, zero));
+			lo = _mm256_add_epi16(lo, _mm256_srli_si256(lo, 8));
+			hi = _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8));
+			return _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_set1_epi16(2)), 2);
+		}
+
+		BE_TARGET_AVX2 void Box2xRowAVX2(uint8_t* dst, uint8_t const* row0, uint8_t const* row1, int dstWidth)
+		{
+			int x = 0;
+			for (; x + 8 <= dstWidth; x += 8)
+			{
+				__m256i const* const p0 = reinterpret_cast<__m256i const*>(row0 + 8 * x);
+				__m256i const* const p1 = reinterpret_cast<__m256i const*>(row1 + 8 * x);
+				// 128-bit lanes: (0,1 | 2,3) and (4,5 | 6,7)
+				__m256i const first = Box2xAVX2(_mm256_loadu_si256(p0), _mm256_loadu_si256(p1));
+				__m256i const second = Box2xAVX2(_mm256_loadu_si256(p0 + 1), _mm256_loadu_si256(p1 + 1));
+				__m256i const packed = _mm256_packus_epi16(first, second); // 0,1,4,5 | 2,3,6,7
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 4 * x),
+					_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+			}
+			Box2xRowSSE2(dst + 4 * x, row0 + 8 * x, row1 + 8 * x, dstWidth - x);
+		}
+
+		BE_TARGET_AVX2 void LerpRowAVX2(uint8_t* dst, uint16_t const* top, uint16_t const* bottom,
+			std::size_t count, int bottomWeight)
+		{
+			__m256i const weights = _mm256_set1_epi32((bottomWeight << 16) | (BILINEAR_ONE - bottomWeight));
+			__m256i const rounding = _mm256_set1_epi32(1 << (2 * BILINEAR_SHIFT - 1));
+			std::size_t i = 0;
+			for (; i + 16 <= count; i += 16)
+			{
+				__m256i const t = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(top + i));
+				__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(bottom + i));
+				__m256i const lo = _mm256_srli_epi32(_mm256_add_epi32(
+					_mm256_madd_epi16(_mm256_unpacklo_epi16(t, b), weights), rounding), 2 * BILINEAR_SHIFT);
+				__m256i const hi = _mm256_srli_epi32(_mm256_add_epi32(
+					_mm256_madd_epi16(_mm256_unpackhi_epi16(t, b), weights), rounding), 2 * BILINEAR_SHIFT);
+				__m256i const values = _mm256_packs_epi32(lo, hi);
+				__m256i const packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(values, values),
+					_MM_SHUFFLE(3, 1, 2, 0));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+			}
+			LerpRowSSE2(dst + i, top + i, bottom + i, count - i, bottomWeight);
+		}
+
+		bool HasAVX2()
+		{
+	#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			bool const hasOSXSave = (info[2] & (1 << 27)) != 0;
+			bool const hasAVX = (info[2] & (1 << 28)) != 0;
+			if (!hasOSXSave || !hasAVX || (_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+	#else
+			return __builtin_cpu_supports("avx2");
+	#endif
+		}
+#endif // BE_IMAGE_KERNELS_X64
+
+#if BE_IMAGE_KERNELS_NEON
+		//--------------------------------------------------------------------------------------------------
+		// NEON implementation (always available on arm64)
+		//--------------------------------------------------------------------------------------------------
+
+		inline uint8x8_t IntensityNEON(uint8x8_t const r, uint8x8_t const g, uint8x8_t const b)
+		{
+			uint16x8_t sum = vmull_u8(r, vdup_n_u8(90));
+			sum = vmlal_u8(sum, g, vdup_n_u8(128));
+			sum = vmlal_u8(sum, b, vdup_n_u8(38));
+			return vrshrn_n_u16(sum, 8);
+		}
+
+		inline uint8x16_t IntensityNEON(uint8x16x4_t const& pixels)
+		{
+			return vcombine_u8(
+				IntensityNEON(vget_low_u8(pixels.val[0]), vget_low_u8(pixels.val[1]), vget_low_u8(pixels.val[2])),
+				IntensityNEON(vget_high_u8(pixels.val[0]), vget_high_u8(pixels.val[1]), vget_high_u8(pixels.val[2])));
+		}
+
+		void ExtractIntensityNEON(uint8_t* dst, unsigned dstChannel, uint8_t const* src, std::size_t pixelCount)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= pixelCount; i += 16)
+			{
+				uint8x16x4_t dstPixels = vld4q_u8(dst + 4 * i);
+				dstPixels.val[dstChannel] = IntensityNEON(vld4q_u8(src + 4 * i));
+				vst4q_u8(dst + 4 * i, dstPixels);
+			}
+			ExtractIntensityScalar(dst + 4 * i, dstChannel, src + 4 * i, pixelCount - i);
+		}
+
+		bool HasPartialAlphaNEON(uint8_t const* src, std::size_t pixelCount, EAlphaSource alphaSource)
+		{
+			std::size_t i = 0;
+			for (; i + 16 <= pixelCount; i += 16)
+			{
+				uint8x16x4_t const pixels = vld4q_u8(src + 4 * i);
+				uint8x16_t const alpha = (alphaSource == EAlphaSource::AlphaChannel)
+					? pixels.val[3] : IntensityNEON(pixels);
+				uint8x16_t const isOpaqueOrEmpty = vorrq_u8(
+					vceqq_u8(alpha, vdupq_n_u8(0)), vceqq_u8(alpha, vdupq_n_u8(255)));
+				if (vminvq_u8(isOpaqueOrEmpty) == 0)
+				{
+					return true;
+				}
+			}
+			return HasPartialAlphaScalar(src + 4 * i, pixelCount - i, alphaSource);
+		}
+
+		void Box2xRowNEON(uint8_t* dst, uint8_t const* row0, uint8_t const* row1, int dstWidth)
+		{
+			int x = 0;
+			for (; x + 8 <= dstWidth; x += 8)
+			{
+				uint8x16x4_t const p0 = vld4q_u8(row0 + 8 * x);
+				uint8x16x4_t const p1 = vld4q_u8(row1 + 8 * x);
+				uint8x8x4_t result;
+				for (int c = 0; c < 4; ++c)
+				{
+					result.val[c] = vrshrn_n_u16(vaddq_u16(vpaddlq_u8(p0.val[c]), vpaddlq_u8(p1.val[c])), 2);
+				}
+				vst4_u8(dst + 4 * x, result);
+			}
+			Box2xRowScalar(dst + 4 * x, row0 + 8 * x, row1 + 8 * x, dstWidth - x);
+		}
+
+		void LerpRowNEON(uint8_t* dst, uint16_t const* top, uint16_t const* bottom, std::size_t count,
+			int bottomWeight)
+		{
+			uint16_t const topWeight = static_cast<uint16_t>(BILINEAR_ONE - bottomWeight);
+			std::size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				uint16x8_t const t = vld1q_u16(top + i);
+				uint16x8_t const b = vld1q_u16(bottom + i);
+				uint32x4_t lo = vmull_n_u16(vget_low_u16(t), topWeight);
+				lo = vmlal_n_u16(lo, vget_low_u16(b), static_cast<uint16_t>(bottomWeight));
+				uint32x4_t hi = vmull_n_u16(vget_high_u16(t), topWeight);
+				hi = vmlal_n_u16(hi, vget_high_u16(b), static_cast<uint16_t>(bottomWeight));
+				uint16x8_t const values = vcombine_u16(
+					vrshrn_n_u32(lo, 2 * BILINEAR_SHIFT), vrshrn_n_u32(hi, 2 * BILINEAR_SHIFT));
+				vst1_u8(dst + i, vmovn_u16(values));
+			}
+			LerpRowScalar(dst + i, top + i, bottom + i, count - i, bottomWeight);
+		}
+#endif // BE_IMAGE_KERNELS_NEON
+
+		//--------------------------------------------------------------------------------------------------
+		// Dispatch
+		//--------------------------------------------------------------------------------------------------
+
+		struct KernelTable
+		{
+			void (*extractIntensity)(uint8_t*, unsigned, uint8_t const*, std::size_t);
+			bool (*hasPartialAlpha)(uint8_t const*, std::size_t, EAlphaSource);
+			void (*box2xRow)(uint8_t*, uint8_t const*, uint8_t const*, int);
+			void (*lerpRow)(uint8_t*, uint16_t const*, uint16_t const*, std::size_t, int);
+		};
+
+		KernelTable const& GetKernelTable(EInstructionSet instructionSet)
+		{
+			static KernelTable const scalarTable = {
+				ExtractIntensityScalar, HasPartialAlphaScalar, Box2xRowScalar, LerpRowScalar };
+			switch (instructionSet)
+			{
+#if BE_IMAGE_KERNELS_X64
+			case EInstructionSet::SSE2:
+			{
+				static KernelTable const table = {
+					ExtractIntensitySSE2, HasPartialAlphaSSE2, Box2xRowSSE2, LerpRowSSE2 };
+				return table;
+			}
+			case EInstructionSet::AVX2:
+			{
+				static KernelTable const table = {
+					ExtractIntensityAVX2, HasPartialAlphaAVX2, Box2xRowAVX2, LerpRowAVX2 };
+				return table;
+			}
+#endif
+#if BE_IMAGE_KERNELS_NEON
+			case EInstructionSet::NEON:
+			{
+				static KernelTable const table = {
+					ExtractIntensityNEON, HasPartialAlphaNEON, Box2xRowNEON, LerpRowNEON };
+				return table;
+			}
+#endif
+			default:
+				return scalarTable;
+			}
+		}
+
+		std::atomic<EInstructionSet>& CurrentInstructionSet()
+		{
+			static std::atomic<EInstructionSet> instructionSet = GetBestInstructionSet();
+			return instructionSet;
+		}
+
+		inline KernelTable const& Kernels()
+		{
+			return GetKernelTable(CurrentInstructionSet().load(std::memory_order_relaxed));
+		}
+
+	} // anonymous namespace
+
+	EInstructionSet GetBestInstructionSet()
+	{
+#if BE_IMAGE_KERNELS_X64
+		static bool const hasAVX2 = HasAVX2();
+		return hasAVX2 ? EInstructionSet::AVX2 : EInstructionSet::SSE2;
+#elif BE_IMAGE_KERNELS_NEON
+		return EInstructionSet::NEON;
+#else
+		return EInstructionSet::Scalar;
+#endif
+	}
+
+	bool IsSupported(EInstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+		case EInstructionSet::Scalar:
+			return true;
+		case EInstructionSet::SSE2:
+		case EInstructionSet::AVX2:
+			return GetBestInstructionSet() == EInstructionSet::AVX2
+				|| GetBestInstructionSet() == instructionSet;
+		case EInstructionSet::NEON:
+			return GetBestInstructionSet() == EInstructionSet::NEON;
+		}
+		return false;
+	}
+
+	EInstructionSet GetInstructionSet()
+	{
+		return CurrentInstructionSet().load(std::memory_order_relaxed);
+	}
+
+	bool SetInstructionSet(EInstructionSet instructionSet)
+	{
+		if (!IsSupported(instructionSet))
+		{
+			return false;
+		}
+		CurrentInstructionSet().store(instructionSet, std::memory_order_relaxed);
+		return true;
+	}
+
+	char const* GetInstructionSetName(EInstructionSet instructionSet)
+	{
+		switch (instructionSet)
+		{
+		case EInstructionSet::Scalar: return "Scalar";
+		case EInstructionSet::SSE2: return "SSE2";
+		case EInstructionSet::AVX2: return "AVX2";
+		case EInstructionSet::NEON: return "NEON";
+		}
+		return "?";
+	}
+
+	void ExtractIntensity(std::byte* dst, unsigned dstChannel, std::byte const* src, std::size_t pixelCount)
+	{
+		Kernels().extractIntensity(Bytes(dst), dstChannel & 3, Bytes(src), pixelCount);
+	}
+
+	bool HasPartialAlpha(std::byte const* src, std::size_t pixelCount, EAlphaSource alphaSource)
+	{
+		return Kernels().hasPartialAlpha(Bytes(src), pixelCount, alphaSource);
+	}
+
+	void DownsampleBox2x(std::byte* dst, std::byte const* src, int width, int height)
+	{
+		auto const box2xRow = Kernels().box2xRow;
+		int const dstWidth = width / 2;
+		int const dstHeight = height / 2;
+		std::size_t const srcStride = 4 * static_cast<std::size_t>(width);
+		for (int y = 0; y < dstHeight; ++y)
+		{
+			uint8_t const* const row0 = Bytes(src) + 2 * y * srcStride;
+			box2xRow(Bytes(dst) + 4 * static_cast<std::size_t>(y) * dstWidth, row0, row0 + srcStride, dstWidth);
+		}
+	}
+
+	void ResampleBilinear(std::byte* dst, int dstWidth, int dstHeight,
+		std::byte const* src, int srcWidth, int srcHeight)
+	{
+		if (dstWidth <= 0 || dstHeight <= 0 || srcWidth <= 0 || srcHeight <= 0)
+		{
+			return;
+		}
+		// Source coordinate (pixel centers are aligned) -> 2 source pixels and the weight of the second one.
+		struct Tap
+		{
+			int i0 = 0;
+			int i1 = 0;
+			int weight1 = 0;
+		};
+		auto const computeTap = [](int i, int srcSize, int dstSize)
+		{
+			float const s = std::clamp((i + 0.5f) * srcSize / dstSize - 0.5f, 0.f, static_cast<float>(srcSize - 1));
+			Tap tap;
+			tap.i0 = static_cast<int>(s);
+			tap.i1 = std::min(tap.i0 + 1, srcSize - 1);
+			tap.weight1 = static_cast<int>((s - tap.i0) * BILINEAR_ONE + 0.5f);
+			return tap;
+		};
+		std::vector<Tap> columnTaps(dstWidth);
+		for (int x = 0; x < dstWidth; ++x)
+		{
+			columnTaps[x] = computeTap(x, srcWidth, dstWidth);
+		}
+
+		// Source rows interpolated horizontally (this part is not vectorized, as it requires gathering
+		// pixels), kept while they are used by consecutive destination rows.
+		std::size_t const rowSize = 4 * static_cast<std::size_t>(dstWidth);
+		std::vector<uint16_t> rowBuffers[2] = { std::vector<uint16_t>(rowSize), std::vector<uint16_t>(rowSize) };
+		int bufferRows[2] = { -1, -1 };
+		auto const getRow = [&](int srcY, int avoidBuffer) -> uint16_t const*
+		{
+			for (int k = 0; k < 2; ++k)
+			{
+				if (bufferRows[k] == srcY)
+					return rowBuffers[k].data();
+			}
+			int const k = (avoidBuffer == 0) ? 1 : 0;
+			uint8_t const* const srcRow = Bytes(src) + 4 * static_cast<std::size_t>(srcY) * srcWidth;
+			uint16_t* out = rowBuffers[k].data();
+			for (Tap const& tap : columnTaps)
+			{
+				uint8_t const* const p0 = srcRow + 4 * tap.i0;
+				uint8_t const* const p1 = srcRow + 4 * tap.i1;
+				for (int c = 0; c < 4; ++c)
+				{
+					*out++ = static_cast<uint16_t>(p0[c] * (BILINEAR_ONE - tap.weight1) + p1[c] * tap.weight1);
+				}
+			}
+			bufferRows[k] = srcY;
+			return rowBuffers[k].data();
+		};
+
+		auto const lerpRow = Kernels().lerpRow;
+		for (int y = 0; y < dstHeight; ++y)
+		{
+			Tap const tap = computeTap(y, srcHeight, dstHeight);
+			uint16_t const* const top = getRow(tap.i0, -1);
+			int const topBuffer = (top == rowBuffers[0].data()) ? 0 : 1;
+			uint16_t const* const bottom = getRow(tap.i1, topBuffer);
+			lerpRow(Bytes(dst) + y * rowSize, top, bottom, rowSize, tap.weight1);
+		}
+	}
+
+	void Downsample(std::byte* dst, int dstWidth, int dstHeight,
+		std::byte const* src, int srcWidth, int srcHeight)
+	{
+		std::vector<std::byte> buffers[2];
+		std::byte const* current = src;
+		int width = srcWidth;
+		int height = srcHeight;
+		for (int k = 0; width >= 2 * dstWidth && height >= 2 * dstHeight && width >= 2 && height >= 2; k ^= 1)
+		{
+			buffers[k].resize(4 * static_cast<std::size_t>(width / 2) * (height / 2));
+			DownsampleBox2x(buffers[k].data(), current, width, height);
+			current = buffers[k].data();
+			width /= 2;
+			height /= 2;
+		}
+		if (width == dstWidth && height == dstHeight)
+		{
+			std::memcpy(dst, current, 4 * static_cast<std::size_t>(width) * height);
+		}
+		else
+		{
+			ResampleBilinear(dst, dstWidth, dstHeight, current, width, height);
+		}
+	}
+
+} // namespace BeUtils::ImageKernels
@@ -0,0 +1,73 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ImageKernels.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//! Pixel kernels used to merge and resample textures. All images are 8-bit RGBA, without padding between
+//! rows. Each kernel has a scalar implementation (the reference) and SSE2/AVX2 (x64) and NEON (arm64)
+//! implementations, which produce exactly the same results.
+namespace BeUtils::ImageKernels
+{
+
+	enum class EInstructionSet : uint8_t
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON,
+	};
+
+	//! Returns the best instruction set supported by the current CPU.
+	EInstructionSet GetBestInstructionSet();
+	//! Returns whether the current CPU supports the given instruction set.
+	bool IsSupported(EInstructionSet instructionSet);
+	//! Instruction set used by the kernels (the best supported one, unless changed by SetInstructionSet).
+	EInstructionSet GetInstructionSet();
+	//! Forces the instruction set used by the kernels (for tests and benchmarks, typically). Returns false
+	//! if it is not supported.
+	bool SetInstructionSet(EInstructionSet instructionSet);
+	char const* GetInstructionSetName(EInstructionSet instructionSet);
+
+	//! Intensity of a color, used when a color texture is used as an intensity map (0.35 R + 0.5 G + 0.15 B,
+	//! in 8-bit fixed point).
+	inline uint8_t Intensity(uint8_t r, uint8_t g, uint8_t b)
+	{
+		return static_cast<uint8_t>((90u * r + 128u * g + 38u * b + 128u) >> 8);
+	}
+
+	//! Writes the intensity of each pixel of src into the component dstChannel (0 to 3 for R, G, B, A) of the
+	//! corresponding pixel of dst. The other components of dst are left unchanged.
+	void ExtractIntensity(std::byte* dst, unsigned dstChannel, std::byte const* src, std::size_t pixelCount);
+
+	enum class EAlphaSource : uint8_t
+	{
+		AlphaChannel,	//!< alpha is read in the A component
+		Intensity,		//!< alpha is the intensity of the R, G, B components (opacity maps)
+	};
+
+	//! Returns whether some pixel has a partial alpha (neither 0 nor 255): such a texture requires blending,
+	//! whereas masking is enough for the others.
+	bool HasPartialAlpha(std::byte const* src, std::size_t pixelCount, EAlphaSource alphaSource);
+
+	//! Halves the size of the image (box filter on 2x2 pixels). The destination size is (width/2, height/2):
+	//! the last column (resp. row) is ignored if the width (resp. height) is odd.
+	void DownsampleBox2x(std::byte* dst, std::byte const* src, int width, int height);
+
+	//! Resamples the image to the given size, using a bilinear filter.
+	void ResampleBilinear(std::byte* dst, int dstWidth, int dstHeight,
+		std::byte const* src, int srcWidth, int srcHeight);
+
+	//! Reduces the image to the given size: the image is halved with a box filter as long as it is at least
+	//! twice as large as the destination, then resampled with a bilinear filter.
+	void Downsample(std::byte* dst, int dstWidth, int dstHeight,
+		std::byte const* src, int srcWidth, int srcHeight);
+
+} // namespace BeUtils::ImageKernels
@@ -0,0 +1,132 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: IntervalIndex.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <BeUtils/Misc/IntervalIndex.h>
+
+#include <algorithm>
+
+namespace BeUtils
+{
+
+	namespace
+	{
+		//! Below this level, subtrees are small enough to be scanned linearly.
+		constexpr int LINEAR_SCAN_LEVEL = 3;
+	}
+
+	void IntervalIndex::Build(std::vector<Interval>&& intervals)
+	{
+		intervals_ = std::move(intervals);
+		intervals_.erase(std::remove_if(intervals_.begin(), intervals_.end(),
+			[](Interval const& interval) { return interval.last < interval.first; }), intervals_.end());
+		std::sort(intervals_.begin(), intervals_.end(),
+			[](Interval const& a, Interval const& b) { return a.first < b.first; });
+		int64_t const n = static_cast<int64_t>(intervals_.size());
+		maxLast_.resize(intervals_.size());
+		rootLevel_ = -1;
+		if (n == 0)
+		{
+			return;
+		}
+		// In the implicit tree, node i is at level k if its k lowest bits are 1 and bit k is 0: leaves are
+		// the even indices, their parents are the indices ending with 01, etc.
+		// The tree is complete, ie. its rightmost nodes may be out of the array: lastIndex and lastMax track
+		// the rightmost node actually in the array, at the level being processed, and its max value.
+		int64_t lastIndex = 0;
+		double lastMax = 0.;
+		for (int64_t i = 0; i < n; i += 2)
+		{
+			lastIndex = i;
+			lastMax = maxLast_[i] = intervals_[i].last;
+		}
+		int k = 1;
+		for (; (int64_t(1) << k) <= n; ++k)
+		{
+			int64_t const x = int64_t(1) << (k - 1);
+			int64_t const step = x << 2;
+			for (int64_t i = (x << 1) - 1; i < n; i += step)
+			{
+				double const leftMax = maxLast_[i - x];
+				double const rightMax = (i + x < n) ? maxLast_[i + x] : lastMax;
+				maxLast_[i] = std::max({ intervals_[i].last, leftMax, rightMax });
+			}
+			lastIndex = ((lastIndex >> k) & 1) ? (lastIndex - x) : (lastIndex + x);
+			if (lastIndex < n)
+			{
+				lastMax = std::max(lastMax, maxLast_[lastIndex]);
+			}
+		}
+		rootLevel_ = k - 1;
+	}
+
+	void IntervalIndex::Clear()
+	{
+		intervals_.clear();
+		maxLast_.clear();
+		rootLevel_ = -1;
+	}
+
+	void IntervalIndex::Query(double first, double last, std::vector<Id>& out) const
+	{
+		if (rootLevel_ < 0 || last < first)
+		{
+			return;
+		}
+		std::size_t const firstOut = out.size();
+		int64_t const n = static_cast<int64_t>(intervals_.size());
+		struct StackEntry
+		{
+			int64_t node;
+			int level;
+			bool leftDone;
+		};
+		// Depth is bounded by the tree height (2 entries per level at most)
+		StackEntry stack[130];
+		int top = 0;
+		stack[top++] = { (int64_t(1) << rootLevel_) - 1, rootLevel_, false };
+		while (top > 0)
+		{
+			StackEntry const cur = stack[--top];
+			if (cur.level <= LINEAR_SCAN_LEVEL)
+			{
+				// Small subtree: scan all its nodes.
+				int64_t const begin = (cur.node >> cur.level) << cur.level;
+				int64_t const end = std::min(begin + (int64_t(1) << (cur.level + 1)) - 1, n);
+				for (int64_t i = begin; i < end && intervals_[i].first <= last; ++i)
+				{
+					if (first <= intervals_[i].last)
+					{
+						out.push_back(intervals_[i].id);
+					}
+				}
+			}
+			else if (!cur.leftDone)
+			{
+				// Come back to this node after its left child. The left child may be out of the array, in which
+				// case its subtree is partially in it.
+				int64_t const left = cur.node - (int64_t(1) << (cur.level - 1));
+				stack[top++] = { cur.node, cur.level, true };
+				if (left >= n || maxLast_[left] >= first)
+				{
+					stack[top++] = { left, cur.level - 1, false };
+				}
+			}
+			else if (cur.node < n && intervals_[cur.node].first <= last)
+			{
+				if (first <= intervals_[cur.node].last)
+				{
+					out.push_back(intervals_[cur.node].id);
+				}
+				stack[top++] = { cur.node + (int64_t(1) << (cur.level - 1)), cur.level - 1, false };
+			}
+		}
+		// The traversal visits the intervals in the order of their first bounds: sort the results by id.
+		std::sort(out.begin() + firstOut, out.end());
+	}
+
+} // namespace BeUtils
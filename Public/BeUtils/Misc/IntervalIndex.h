@@ -0,0 +1,55 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: IntervalIndex.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace BeUtils
+{
+
+//! Static index of closed intervals [first, last], to quickly find those intersecting a given range: used to
+//! find which timelines of a 4D schedule may change between two times.
+//! Implemented as an implicit augmented interval tree (same principle as the cgranges library): intervals
+//! are sorted by their first bound, the sorted array is seen as a balanced binary tree, and each node stores
+//! the largest last bound of its subtree. Queries are in O(log(n) + k), where k is the number of results.
+class IntervalIndex
+{
+public:
+	using Id = uint32_t;
+	struct Interval
+	{
+		double first = 0.;
+		double last = 0.;
+		Id id = 0;
+	};
+
+	IntervalIndex() = default;
+	explicit IntervalIndex(std::vector<Interval>&& intervals) { Build(std::move(intervals)); }
+
+	//! (Re)builds the index. Empty intervals (last < first) are ignored.
+	void Build(std::vector<Interval>&& intervals);
+	void Clear();
+	//! Number of indexed intervals.
+	std::size_t Size() const { return intervals_.size(); }
+	bool IsEmpty() const { return intervals_.empty(); }
+
+	//! Appends to out the ids of the intervals intersecting [first, last], in increasing order.
+	void Query(double first, double last, std::vector<Id>& out) const;
+
+private:
+	//! Intervals, sorted by their first bound.
+	std::vector<Interval> intervals_;
+	//! Largest last bound of the subtree rooted at each node (same indices as intervals_).
+	std::vector<double> maxLast_;
+	//! Level of the root node (leaves are at level 0).
+	int rootLevel_ = -1;
+};
+
+} // namespace BeUtils
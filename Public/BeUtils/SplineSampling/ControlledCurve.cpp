@@ -9,6 +9,8 @@
 
 #include "ControlledCurve.h"
 
+#include <SDK/Core/Tools/Assert.h>
+
 namespace BeUtils::path
 {
 	template <typename V>
@@ -17,6 +19,22 @@ namespace BeUtils::path
 
 	}
 
+	template <typename V>
+	void GenericCurve<V>::GetPositionsAndTangentsAtCoords(std::span<value_type const> coords,
+		std::span<V> outPositions, std::span<V> outTangents) const
+	{
+		BE_ASSERT(outPositions.size() == coords.size());
+		BE_ASSERT(outTangents.empty() || outTangents.size() == coords.size());
+		for (size_t i = 0; i < coords.size(); ++i)
+		{
+			outPositions[i] = GetPositionAtCoord(coords[i]);
+		}
+		for (size_t i = 0; i < outTangents.size(); ++i)
+		{
+			outTangents[i] = GetTangentAtCoord(coords[i]);
+		}
+	}
+
 	template class GenericCurve<glm::dvec3>;
 	template class ControlledCurve<glm::dvec3>;
 
@@ -12,6 +12,7 @@
 #include <BeUtils/SplineSampling/MathTypes.h>
 
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace BeUtils
@@ -35,6 +36,14 @@ namespace path
 		/// Get tangent at a given linear abscissa.
 		virtual V GetTangentAtCoord(value_type const & u) const = 0;
 
+		/// Get positions, and optionally tangents, for a batch of linear abscissas.
+		/// The default implementation evaluates them one by one: curves able to share some work between
+		/// the evaluations (coordinate system conversion, span lookup...) should override it.
+		/// \param outPositions Must have the same size as coords.
+		/// \param outTangents Either empty, or of the same size as coords.
+		virtual void GetPositionsAndTangentsAtCoords(std::span<value_type const> coords,
+			std::span<V> outPositions, std::span<V> outTangents) const;
+
 		///// Get "TBN" (Tangent, Binormal, Normal) vector triplet at a given linear abscissa.
 		///// Note that we enforce "stability" of the base (no abrupt orientation changes in the
 		///// middle of the curve) as long as the tangent vector is not (almost) colinear to Z.
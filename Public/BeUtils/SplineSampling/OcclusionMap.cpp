@@ -15,6 +15,8 @@
 #include <BeUtils/Misc/Random.h>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 // Just a wrapper for async++.h that disables some warnings
 #include <CesiumAsync/Impl/cesium-async++.h>
 
@@ -41,22 +43,77 @@ namespace BeUtils
 
 	bool OcclusionMap::IsConstant() const
 	{
-		if (pData_.empty())
+		// an empty map can be considered as constant.
+		size_t const insideCount = insideCells_.CountSetCells();
+		return insideCount == 0
+			|| insideCount == static_cast<size_t>(nWidth_) * nHeight_
+			|| fabs(dInsideValue_ - dOutsideValue_) <= 1e-4;
+	}
+
+	double OcclusionMap::GetValueAt(int x, int y) const
+	{
+		if (insideCells_.GetWidth() != nWidth_ || insideCells_.GetHeight() != nHeight_)
 		{
-			// an empty map can be considered as constant.
-			return true;
+			// map not built yet
+			return dOutsideValue_;
 		}
-		else
+		return insideCells_.Get(x, y) ? dInsideValue_ : dOutsideValue_;
+	}
+
+	double OcclusionMap::GetValueAtCell(int cellIndex) const
+	{
+		return GetValueAt(cellIndex % nWidth_, cellIndex / nWidth_);
+	}
+
+	double OcclusionMap::EvaluateValueAt(double x, double y, int cellIndex) const
+	{
+		if (!bInterpolate_)
 		{
-			// check that all values are the same.
-			double dRefVal(pData_[0]);
-			for (size_t i(1); i < pData_.size(); ++i)
-			{
-				if (fabs(pData_[i] - dRefVal) > 1e-4)
-					return false;
-			}
-			return true;
+			BE_ASSERT(cellIndex >= 0);
+			return GetValueAtCell(cellIndex);
+		}
+		if (insideCells_.GetWidth() != nWidth_ || insideCells_.GetHeight() != nHeight_)
+		{
+			// map not built yet
+			return dOutsideValue_;
+		}
+		// same bilinear interpolation as in TBasic2DMap::TInterpolateValueAt
+		x = std::clamp(dWorldToX_ * (x - dStartX_), 0., (double)nWidth_);
+		y = std::clamp(dWorldToY_ * (y - dStartY_), 0., (double)nHeight_);
+
+		int x0 = (int)floor(x);
+		int y0 = (int)floor(y);
+		if (x0 == nWidth_) x0 = nWidth_ - 1;
+		if (y0 == nHeight_) y0 = nHeight_ - 1;
+
+		int x1 = (x0 == nWidth_ - 1) ? x0 : x0 + 1;
+		int y1 = (y0 == nHeight_ - 1) ? y0 : y0 + 1;
+
+		bool const b00 = insideCells_.Get(x0, y0);
+		bool const b01 = insideCells_.Get(x0, y1);
+		bool const b10 = insideCells_.Get(x1, y0);
+		bool const b11 = insideCells_.Get(x1, y1);
+		if (b00 == b01 && b00 == b10 && b00 == b11)
+		{
+			// away from the border of the pattern
+			return b00 ? dInsideValue_ : dOutsideValue_;
 		}
+
+		double fx = x - x0;
+		double fy = y - y0;
+		double fx1 = 1.0 - fx;
+		double fy1 = 1.0 - fy;
+
+		auto const value = [this](bool bInside) { return bInside ? dInsideValue_ : dOutsideValue_; };
+		return (value(b00) * fx1 * fy1) + (value(b01) * fx1 * fy)
+			+ (value(b10) * fx * fy1) + (value(b11) * fx * fy);
+	}
+
+	double OcclusionMap::ComputeMeanValue() const
+	{
+		size_t const nCells = static_cast<size_t>(nWidth_) * nHeight_;
+		size_t const insideCount = insideCells_.CountSetCells();
+		return (dInsideValue_ * insideCount + dOutsideValue_ * (nCells - insideCount)) / nCells;
 	}
 
 #if IS_EON_DEV()
@@ -68,7 +125,7 @@ namespace BeUtils
 			img.SetFilePath(strDumpPath_);
 			for (int i = 0; i < nWidth_; i++)
 				for (int j = 0; j < nHeight_; j++)
-					img.SetPixelGrayscaleNoGammaConversion(i, j, (float)pData_[i + j * nWidth_]);
+					img.SetPixelGrayscaleNoGammaConversion(i, j, (float)GetValueAt(i, j));
 
 			eon::modul2::WriteImage(img, strDumpPath_).leak();
 		}
@@ -187,26 +244,20 @@ namespace BeUtils
 
 		struct SplineOcclMapData
 		{
-			std::vector<double>& pData_;
+			TiledBitmask& insideCells_;
 			OcclusionMap const& occlusionMap_;
-			double dOcclusionValue_inside_;
-			double dOcclusionValue_outside_;
 
 			ProgressHelper& progHelper_;
 			std::atomic_bool bCancelledPopulating_ = false;
 
 			SplineOcclMapData(
-				Population2DPattern const& p2DPath,
-				std::vector<double>& pData,
+				TiledBitmask& insideCells,
 				OcclusionMap const& occ,
 				ProgressHelper& progHelper)
-				: pData_(pData)
+				: insideCells_(insideCells)
 				, occlusionMap_(occ)
 				, progHelper_(progHelper)
 			{
-				const double dInfluence = std::clamp(p2DPath.GetOcclusionInfluence(), 0., 1.);
-				dOcclusionValue_inside_ = p2DPath.IsOcclusion() ? (1. - dInfluence) : dInfluence;
-				dOcclusionValue_outside_ = p2DPath.IsOcclusion() ? 1. : 0.;
 			}
 
 			bool CancelledPopulating() const { return bCancelledPopulating_; }
@@ -217,68 +268,45 @@ namespace BeUtils
 			public SplineOcclMapData
 		{
 			std::vector<Segment_2D> const& segments_;
-			//std::vector<Intersection2DSorter> localIntersectionsVec_;
 
 		public:
 			SplineOcclMapLoopIter(
-				Population2DPattern const& p2DPath,
-				std::vector<double>& pData,
+				TiledBitmask& insideCells,
 				OcclusionMap const& occ,
 				ProgressHelper& progHelper,
 				std::vector<Segment_2D> const& segments)
-				: SplineOcclMapData(p2DPath, pData, occ, progHelper)
+				: SplineOcclMapData(insideCells, occ, progHelper)
 				, segments_(segments)
 			{
 				//masterThreadName_ = eon::ThreadNameInfo("ECO-SplinePop loop");
 			}
 
-			//void WillBecomeParallel(const int nbWorkingThreads) override
-			//{
-			//	localIntersectionsVec_.resize(nbWorkingThreads);
-			//}
-			//
-			//void RunOnce(const int64_t j, tools::multiproc::ParallelContext const* ctxt) override
-			//{
-
 			void RunSubTask(const int j)
 			{
-				//if (bCancelledPopulating_)
-				//	return;
-
-				//const int threadId = ctxt->GetMyWorkingThreadIndex();
-				//Intersection2DSorter & localIntersections = localIntersectionsVec_[threadId];
-
 				thread_local static Intersection2DSorter localIntersections;
 				const double y = occlusionMap_.GetStart2DPosY() + j * occlusionMap_.GetCellHeight();
 				// find all segments intersected by line (Y=y)
 				localIntersections.FindAndSort2DIntersectionsMatchingY(segments_, y);
-				// we must know whether the starting point is inside the enclosure.
-				// Note that we can revert the behavior using the SetOcclusion function
-				bool bInside = false;
-				Intersection2DIterator itInter = localIntersections.intersections_.begin(),
-					endInter = localIntersections.intersections_.end();
-				double x = occlusionMap_.GetStart2DPosX();
-				int nCellIndex = occlusionMap_.GetWidth() * static_cast<int>(j);
-				// const bool isMasterThread = ctxt->AmITheMasterThread();
-				for (int i = 0; i < occlusionMap_.GetWidth(); ++i)
+
+				const double x0 = occlusionMap_.GetStart2DPosX();
+				const double cellWidth = occlusionMap_.GetCellWidth();
+				const int width = occlusionMap_.GetWidth();
+				if (cellWidth <= 0.)
+					return;
+				// index of the first cell whose center is at or after x
+				auto const firstCellFrom = [&](double x)
+				{
+					return (int)std::clamp(std::ceil((x - x0) / cellWidth), 0., (double)width);
+				};
+				// A cell is inside the enclosure when an odd number of intersections lie before its center:
+				// fill the spans between consecutive pairs of intersections, one word at a time.
+				Intersection2DVector const& intersections = localIntersections.intersections_;
+				for (size_t k = 0; k < intersections.size(); k += 2)
 				{
-					while (itInter != endInter && itInter->ptInter_.x <= x)
-					{
-						bInside = !bInside;
-						itInter++;
-					}
-					pData_[nCellIndex] = bInside ? dOcclusionValue_inside_ : dOcclusionValue_outside_;
-					x += occlusionMap_.GetCellWidth();
-					nCellIndex++;
-					//if (isMasterThread && !progHelper_.Continue())
-					//{
-					//	bCancelledPopulating_ = true;
-					//	break;
-					//}
-					//if (bCancelledPopulating_)
-					//{
-					//	break;
-					//}
+					const int xBegin = firstCellFrom(intersections[k].ptInter_.x);
+					const int xEnd = (k + 1 < intersections.size())
+						? firstCellFrom(intersections[k + 1].ptInter_.x) : width;
+					insideCells_.SetSpan(j, xBegin, xEnd);
 				}
 			}
 		};
@@ -287,9 +315,9 @@ namespace BeUtils
 
 	bool OcclusionMap::BuildFrom2DPattern(Population2DPattern const& p2DPath)
 	{
-		// initialize arrays
-		pData_.clear();
-		pData_.resize(nCells_, 1.0);
+		// initialize arrays (until a valid pattern is rasterized, the map is uniformly 1)
+		insideCells_.Resize(nWidth_, nHeight_);
+		dInsideValue_ = dOutsideValue_ = 1.;
 
 		BE_ASSERT(nHeight_ * nWidth_ <= nCells_, "map size too short for given cell subdivision");
 
@@ -344,10 +372,13 @@ namespace BeUtils
 				return true;
 			}
 
+			const double dInfluence = std::clamp(p2DPath.GetOcclusionInfluence(), 0., 1.);
+			dInsideValue_ = p2DPath.IsOcclusion() ? (1. - dInfluence) : dInfluence;
+			dOutsideValue_ = p2DPath.IsOcclusion() ? 1. : 0.;
+
 			// generate map from segments through a scan-line algorithm
 			SplineOcclMapLoopIter iter(
-				p2DPath,
-				pData_,
+				insideCells_,
 				*this,
 				progHelper,
 				segments);
@@ -415,43 +446,105 @@ namespace BeUtils
 		}
 	}
 
-	size_t OcclusionMap::GetSampledPositions(std::vector<glm::dvec3>& outPositions,
-		bool forceAligned, uint32_t randSeed) const
+	namespace
 	{
-		outPositions.clear();
-		BE_ASSERT(nCells_ > 0 && (int)pData_.size() == nCells_);
+		//! Seed of the random generator used for a tile, decorrelated from the seeds of its neighbours
+		//! (SplitMix64 finalizer).
+		uint32_t GetTileSeed(uint32_t randSeed, int tileIndex)
+		{
+			uint64_t z = (uint64_t(randSeed) << 32) + uint64_t(tileIndex) + 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return static_cast<uint32_t>(z ^ (z >> 31));
+		}
+	}
 
-		RandomNumberGenerator rand(randSeed);
+	TiledBitmask::Word OcclusionMap::GetSampledCells(int tileX, int y) const
+	{
+		// Cells not fully occluded
+		TiledBitmask::Word const inside = insideCells_.GetWord(tileX, y);
+		TiledBitmask::Word const validMask = insideCells_.GetValidMask(tileX);
+		return ((dInsideValue_ > 0) ? (inside & validMask) : 0)
+			| ((dOutsideValue_ > 0) ? (~inside & validMask) : 0);
+	}
 
-		int cellIndex = 0;
-		double y = GetStart2DPosY();
-		for (int j = 0; j < GetHeight(); ++j)
+	size_t OcclusionMap::CountSampledCells(int tileIndex) const
+	{
+		int const tileX = tileIndex % insideCells_.CountTilesX();
+		int const yBegin = (tileIndex / insideCells_.CountTilesX()) * TiledBitmask::TileSize;
+		int const yEnd = std::min(yBegin + TiledBitmask::TileSize, nHeight_);
+		size_t count = 0;
+		for (int y = yBegin; y < yEnd; ++y)
 		{
-			double x = GetStart2DPosX();
-			for (int i = 0; i < GetWidth(); ++i)
+			count += std::popcount(GetSampledCells(tileX, y));
+		}
+		return count;
+	}
+
+	size_t OcclusionMap::SampleTile(int tileIndex, bool forceAligned, uint32_t randSeed,
+		glm::dvec3* outPositions) const
+	{
+		int const tileX = tileIndex % insideCells_.CountTilesX();
+		int const yBegin = (tileIndex / insideCells_.CountTilesX()) * TiledBitmask::TileSize;
+		int const yEnd = std::min(yBegin + TiledBitmask::TileSize, nHeight_);
+
+		RandomNumberGenerator rand(randSeed);
+		size_t nPositions = 0;
+		for (int y = yBegin; y < yEnd; ++y)
+		{
+			double const cellY = GetStart2DPosY() + y * GetCellHeight();
+			for (TiledBitmask::Word cells = GetSampledCells(tileX, y); cells != 0; cells &= cells - 1)
 			{
-				if (pData_[cellIndex] > 0)
+				int const x = tileX * TiledBitmask::TileSize + std::countr_zero(cells);
+				double const cellX = GetStart2DPosX() + x * GetCellWidth();
+				if (forceAligned)
+				{
+					outPositions[nPositions++] = glm::dvec3(cellX, cellY, 0.);
+				}
+				else if (FindRandLocation(outPositions[nPositions], cellX, cellY, x + y * nWidth_, *this, rand))
 				{
-					// The current cell belongs to the spline's interior => add a sample.
-					if (forceAligned)
-					{
-						outPositions.emplace_back(x, y, 0.);
-					}
-					else
-					{
-						glm::dvec3 location;
-						if (FindRandLocation(location, x, y, cellIndex, *this, rand))
-						{
-							outPositions.emplace_back(location);
-						}
-					}
+					nPositions++;
 				}
-				x += GetCellWidth();
-				cellIndex++;
 			}
-			y += GetCellHeight();
 		}
+		return nPositions;
+	}
+
+	size_t OcclusionMap::GetSampledPositions(std::vector<glm::dvec3>& outPositions,
+		bool forceAligned, uint32_t randSeed) const
+	{
+		outPositions.clear();
+		BE_ASSERT(nCells_ > 0 && insideCells_.GetWidth() == nWidth_ && insideCells_.GetHeight() == nHeight_);
 
+		// Each tile is given a range of outPositions large enough for all its candidate cells (counted
+		// with popcount)...
+		int const nTiles = insideCells_.CountTiles();
+		std::vector<size_t> tileOffsets(nTiles + 1, 0);
+		for (int tileIndex = 0; tileIndex < nTiles; ++tileIndex)
+		{
+			tileOffsets[tileIndex + 1] = tileOffsets[tileIndex] + CountSampledCells(tileIndex);
+		}
+		outPositions.resize(tileOffsets.back());
+		std::vector<size_t> tileCounts(nTiles, 0);
+		async::parallel_for(async::irange(0LL, (int64_t)nTiles),
+			[this, &outPositions, &tileOffsets, &tileCounts, forceAligned, randSeed](auto tileIndex)
+		{
+			tileCounts[tileIndex] = SampleTile((int)tileIndex, forceAligned, GetTileSeed(randSeed, (int)tileIndex),
+				outPositions.data() + tileOffsets[tileIndex]);
+		});
+
+		// ... then the ranges are packed in tile order, whatever the order in which tiles were sampled.
+		size_t nPositions = 0;
+		for (int tileIndex = 0; tileIndex < nTiles; ++tileIndex)
+		{
+			auto const itTile = outPositions.begin() + tileOffsets[tileIndex];
+			if (nPositions != tileOffsets[tileIndex])
+			{
+				std::copy(itTile, itTile + tileCounts[tileIndex], outPositions.begin() + nPositions);
+			}
+			nPositions += tileCounts[tileIndex];
+		}
+		outPositions.resize(nPositions);
 		return outPositions.size();
 	}
 
@@ -11,18 +11,23 @@
 
 #include "Basic2DMap.h"
 #include "SplineDefines.h"
+#include "TiledBitmask.h"
 
 
 namespace BeUtils
 {
 	class Population2DPattern;
 
-	class OcclusionMap : public BasicDouble2DMap
+	class OcclusionMap : protected BasicDouble2DMap
 	{
 		//------------------------------------------------------------------------
 		// 2D Occlusion Map.
 		//	based on a regular subdivision grid of the area to occlude.
 		//	a value of 1 means no occlusion, whereas 0 means a total occlusion.
+		//	A single pattern is rasterized in the map, so cells take only two
+		//	values: the cells inside the pattern are stored as a tiled bitmask,
+		//	and the values of the base class (pData_) are not allocated: hence the
+		//	protected inheritance, only the geometry of the grid is exposed.
 		//------------------------------------------------------------------------
 
 		using Base = BasicDouble2DMap;
@@ -40,19 +45,52 @@ namespace BeUtils
 
 		virtual ~OcclusionMap();
 
+		using Base::CountCells;
+		using Base::GetWidth;
+		using Base::GetHeight;
+		using Base::GetResolution;
+		using Base::GetCellWidth;
+		using Base::GetCellHeight;
+		using Base::GetStart2DPosX;
+		using Base::GetStart2DPosY;
+		using Base::GetSuperSamplingFactor;
+		using Base::Get2DBoxInfo;
+#if IS_EON_DEV()
+		using Base::SetDumpToImagePath;
+#endif
 
 		bool IsConstant() const;
 
+		//! Same as in the base class, but reading the tiled bitmask instead of pData_.
+		double GetValueAtCell(int cellIndex) const;
+		double EvaluateValueAt(double x, double y, int cellIndex) const;
+		[[nodiscard]] double ComputeMeanValue() const;
+
 		bool BuildFrom2DPattern(Population2DPattern const& p2DPath);
 
+		//! Samples the cells of the map which are not fully occluded. Tiles of the map are sampled in
+		//! parallel, each with its own random generator seeded from randSeed and the tile index, so that
+		//! the result does not depend on the number of threads.
 		size_t GetSampledPositions(std::vector<glm::dvec3>& outPositions,
 			bool forceAligned, uint32_t randSeed) const;
 
+		TiledBitmask const& GetInsideCells() const { return insideCells_; }
+
 #if IS_EON_DEV()
 		//! Creates an image from the current map. (Debug purpose)
 		void DumpToImage() const override;
 #endif
 
+	private:
+		double GetValueAt(int x, int y) const;
+		TiledBitmask::Word GetSampledCells(int tileX, int y) const;
+		size_t CountSampledCells(int tileIndex) const;
+		size_t SampleTile(int tileIndex, bool forceAligned, uint32_t randSeed, glm::dvec3* outPositions) const;
+
+	private:
+		TiledBitmask insideCells_;
+		double dInsideValue_ = 1.;
+		double dOutsideValue_ = 1.;
 	};
 
 
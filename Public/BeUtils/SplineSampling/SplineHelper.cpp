@@ -11,12 +11,23 @@
 
 #include "SplineUtils.h"
 
+#include <algorithm>
+
 namespace BeUtils
 {
 	//-----------------------------------
 	// class CachedSegmentsContainer
 	//-----------------------------------
 
+	namespace
+	{
+		auto FindResolution(std::vector<CachedSegments> const& cachedArray, double dU)
+		{
+			return std::lower_bound(cachedArray.begin(), cachedArray.end(), dU,
+				[](CachedSegments const& cached, double value) { return cached.dU_ < value; });
+		}
+	}
+
 	bool CachedSegmentsContainer::RecordSegments(std::vector<Segment_2D> const& segments,
 		BoundingBox const& bbox, E2DProjection projection, double dU, double dUTolerance /*=1e-8*/)
 	{
@@ -24,74 +35,211 @@ namespace BeUtils
 		// inserts the new data sorted by resolution.
 		CacheArray& vectorToFill(perProjectionData_[(int)projection]);
 
+		auto const itDuplicate = FindResolution(vectorToFill, dU - dUTolerance);
+		if (itDuplicate != vectorToFill.end() && fabs(dU - itDuplicate->dU_) < dUTolerance)
+		{
+			BE_ISSUE("This resolution already exists in cache");
+			return false;
+		}
+
 		CachedSegments recData;
 		recData.segments_ = segments;
 		recData.bbox_ = bbox;
 		recData.dU_ = dU;
+		vectorToFill.insert(FindResolution(vectorToFill, dU), std::move(recData));
+		return true;
+	}
 
-		// we could optimize a little by using a dichotomy here...
-		size_t nSize = vectorToFill.size();
+	//! Retrieves the given set of segments at given resolution and projection, if it exists.
+	bool CachedSegmentsContainer::RetrieveSegments(std::vector<Segment_2D>& segments,
+		BoundingBox& bbox, E2DProjection projection, double dU, double dUTolerance /*= 1e-8*/) const
+	{
+		// each array is sorted by resolution (dU)
+		CacheArray const& cachedArray(perProjectionData_[(size_t)projection]);
+		auto const it = FindResolution(cachedArray, dU - dUTolerance);
+		if (it != cachedArray.end() && fabs(dU - it->dU_) < dUTolerance)
+		{
+			segments = it->segments_;
+			bbox = it->bbox_;
+			return true;
+		}
+		return false;
+	}
 
-		bool bInsert = false;
-		bool bDuplicate = false;
-		size_t whereToInsert = 0;
-		for (size_t i = 0; i < nSize && !bInsert; i++)
+	void CachedSegmentsContainer::Clear()
+	{
+		// clear all cached sets (and free memory at once)
+		for (int c = 0; c < 3; c++)
 		{
-			if (vectorToFill[i].dU_ >= dU)
-			{
-				bDuplicate = fabs(dU - vectorToFill[i].dU_) < dUTolerance;
-				whereToInsert = i;
-				bInsert = true;
-			}
+			CacheArray().swap(perProjectionData_[c]);
 		}
+	}
+
+	//-----------------------------------
+	// class ArcLengthTable
+	//-----------------------------------
 
-		if (bInsert)
+	void ArcLengthTable::Build(SplineHelper const& spline, TransformHolder const& transform,
+		E2DProjection projection /*= None*/, size_t samplesPerSpan /*= 32*/)
+	{
+		transform_ = transform;
+		projection_ = projection;
+		samplesPerSpan_ = samplesPerSpan;
+		spanStarts_.clear();
+		lengthsInSpans_.clear();
+		spanCount_ = 0;
+		if (spline.CountControlPoints() < 2 || samplesPerSpan_ == 0)
 		{
-			if (bDuplicate)
-			{
-				BE_ISSUE("This resolution already exists in cache");
-				return false;
-			}
+			return;
+		}
+		// For a closed curve, the first control point also ends the last span.
+		spanCount_ = spline.GetSplineCurve()->PointCount(true) - 1;
+		spanStarts_.resize(spanCount_ + 1, 0.);
+		lengthsInSpans_.resize(spanCount_ * samplesPerSpan_, 0.);
+		for (size_t span = 0; span < spanCount_; ++span)
+		{
+			SampleSpan(spline, span);
+		}
+		UpdateSpanStarts(0);
+	}
 
-			vectorToFill.insert(vectorToFill.begin() + whereToInsert, recData);
-			return true;
+	void ArcLengthTable::UpdateAroundControlPoint(SplineHelper const& spline, size_t controlPointIndex)
+	{
+		SplineCurve const& curve = *spline.GetSplineCurve();
+		if (IsEmpty() || curve.PointCount(true) != spanCount_ + 1)
+		{
+			Build(spline, transform_, projection_, samplesPerSpan_);
+			return;
 		}
-		else
+		// Span i joins control points i and i+1, and depends on the tangents at these points, which are
+		// themselves computed from points i-1 and i+2.
+		std::ptrdiff_t const spanCount = (std::ptrdiff_t)spanCount_;
+		bool const bCyclic = curve.IsCyclic();
+		std::array<size_t, 4> spans;
+		size_t numSpans = 0;
+		for (std::ptrdiff_t offset = -2; offset <= 1; ++offset)
 		{
-			// append new data at end.
-			vectorToFill.push_back(recData);
-			return true;
+			std::ptrdiff_t span = (std::ptrdiff_t)controlPointIndex + offset;
+			if (bCyclic)
+				span = ((span % spanCount) + spanCount) % spanCount;
+			else if (span < 0 || span >= spanCount)
+				continue;
+			if (std::find(spans.begin(), spans.begin() + numSpans, (size_t)span) == spans.begin() + numSpans)
+				spans[numSpans++] = (size_t)span;
 		}
+		if (numSpans == 0)
+		{
+			return;
+		}
+		for (size_t i = 0; i < numSpans; ++i)
+		{
+			SampleSpan(spline, spans[i]);
+		}
+		UpdateSpanStarts(*std::min_element(spans.begin(), spans.begin() + numSpans));
 	}
 
-	//! Retrieves the given set of segments at given resolution and projection, if it exists.
-	bool CachedSegmentsContainer::RetrieveSegments(std::vector<Segment_2D>& segments,
-		BoundingBox& bbox, E2DProjection projection, double dU, double dUTolerance /*= 1e-8*/) const
+	bool ArcLengthTable::IsBuiltFor(TransformHolder const& transform, E2DProjection projection) const
 	{
-		auto it = perProjectionData_[(size_t)projection].begin();
-		auto end = perProjectionData_[(size_t)projection].end();
+		return projection_ == projection
+			&& transform_.transfrom_ == transform.transfrom_
+			&& transform_.pos_ == transform.pos_;
+	}
 
-		for (; it != end; it++)
+	void ArcLengthTable::SampleSpan(SplineHelper const& spline, size_t span)
+	{
+		size_t const totalSamples = spanCount_ * samplesPerSpan_;
+		std::vector<value_type> coords(samplesPerSpan_ + 1);
+		for (size_t k = 0; k <= samplesPerSpan_; ++k)
 		{
-			if (fabs(dU - it->dU_) < dUTolerance)
-			{
-				segments = it->segments_;
-				bbox = it->bbox_;
-				return true;
-			}
+			coords[k] = value_type(span * samplesPerSpan_ + k) / value_type(totalSamples);
+		}
+		std::vector<SplineHelper::vector_type> positions;
+		spline.GetPositionsAndTangents_world(coords, transform_, positions);
+
+		Basic2DProjector const proj(projection_);
+		value_type* lengths = &lengthsInSpans_[span * samplesPerSpan_];
+		value_type length = 0.;
+		SplineHelper::vector_type prevPosition = proj.Project(positions[0]);
+		for (size_t k = 1; k <= samplesPerSpan_; ++k)
+		{
+			SplineHelper::vector_type const curPosition = proj.Project(positions[k]);
+			length += glm::distance(curPosition, prevPosition);
+			lengths[k - 1] = length;
+			prevPosition = curPosition;
+		}
+	}
+
+	void ArcLengthTable::UpdateSpanStarts(size_t firstSpan)
+	{
+		for (size_t span = firstSpan; span < spanCount_; ++span)
+		{
+			spanStarts_[span + 1] = spanStarts_[span] + lengthsInSpans_[(span + 1) * samplesPerSpan_ - 1];
+		}
+	}
 
-			if (it->dU_ > dU + dUTolerance) // optimization possible because each array is sorted by resolution (dU)
-				return false;
+	ArcLengthTable::value_type ArcLengthTable::GetCoordInSpan(size_t span, size_t sample,
+		value_type lengthInSpan) const
+	{
+		// sample is the first one reaching lengthInSpan: interpolate from the previous one.
+		value_type const* lengths = &lengthsInSpans_[span * samplesPerSpan_];
+		value_type const prevLength = (sample == 0) ? 0. : lengths[sample - 1];
+		value_type const delta = lengths[sample] - prevLength;
+		value_type const t = (delta > 0.) ? std::clamp((lengthInSpan - prevLength) / delta, 0., 1.) : 0.;
+		return (value_type(span * samplesPerSpan_ + sample) + t) / value_type(spanCount_ * samplesPerSpan_);
+	}
+
+	ArcLengthTable::value_type ArcLengthTable::GetCoordAtLength(value_type length) const
+	{
+		if (IsEmpty())
+		{
+			return 0.;
 		}
-		return false;
+		length = std::clamp(length, 0., GetLength());
+		// Last span starting before the given length
+		auto const itFirstStart = spanStarts_.begin() + 1;
+		size_t const span = std::distance(itFirstStart, std::upper_bound(itFirstStart, spanStarts_.end() - 1, length));
+		value_type const lengthInSpan = length - spanStarts_[span];
+		auto const itSpanBegin = lengthsInSpans_.begin() + span * samplesPerSpan_;
+		auto const itSample = std::lower_bound(itSpanBegin, itSpanBegin + samplesPerSpan_, lengthInSpan);
+		size_t const sample = std::min<size_t>(std::distance(itSpanBegin, itSample), samplesPerSpan_ - 1);
+		return GetCoordInSpan(span, sample, lengthInSpan);
 	}
 
-	void CachedSegmentsContainer::Clear()
+	void ArcLengthTable::GetCoordsAtLengths(std::span<value_type const> lengths,
+		std::span<value_type> outCoords) const
 	{
-		// clear all cached sets (and free memory at once)
-		for (int c = 0; c < 3; c++)
+		BE_ASSERT(outCoords.size() == lengths.size());
+		if (IsEmpty())
 		{
-			CacheArray().swap(perProjectionData_[c]);
+			std::fill(outCoords.begin(), outCoords.end(), 0.);
+			return;
+		}
+		if (!std::is_sorted(lengths.begin(), lengths.end()))
+		{
+			for (size_t i = 0; i < lengths.size(); ++i)
+			{
+				outCoords[i] = GetCoordAtLength(lengths[i]);
+			}
+			return;
+		}
+		// Both the span and the sample can only move forward.
+		value_type const totalLength = GetLength();
+		size_t span = 0, sample = 0;
+		for (size_t i = 0; i < lengths.size(); ++i)
+		{
+			value_type const length = std::clamp(lengths[i], 0., totalLength);
+			while (span + 1 < spanCount_ && spanStarts_[span + 1] <= length)
+			{
+				++span;
+				sample = 0;
+			}
+			value_type const lengthInSpan = length - spanStarts_[span];
+			value_type const* spanLengths = &lengthsInSpans_[span * samplesPerSpan_];
+			while (sample + 1 < samplesPerSpan_ && spanLengths[sample] < lengthInSpan)
+			{
+				++sample;
+			}
+			outCoords[i] = GetCoordInSpan(span, sample, lengthInSpan);
 		}
 	}
 
@@ -115,7 +263,7 @@ namespace BeUtils
 
 	SplineHelper& SplineHelper::operator= (const SplineHelper& rhs)
 	{
-		pCurve_ = rhs.pCurve_;
+		SetSplineCurve(rhs.pCurve_);
 		return *this;
 	}
 
@@ -144,6 +292,33 @@ namespace BeUtils
 		return pCurve_->GetTangentAtCoord(u);
 	}
 
+	void SplineHelper::GetPositionsAndTangents_world(std::span<value_type const> coords,
+		TransformHolder const& transform,
+		std::vector<vector_type>& positions, std::vector<vector_type>* tangents /*= nullptr*/) const
+	{
+		positions.resize(coords.size());
+		if (tangents)
+		{
+			tangents->resize(coords.size());
+		}
+		pCurve_->GetPositionsAndTangentsAtCoords(coords, positions,
+			tangents ? std::span<vector_type>(*tangents) : std::span<vector_type>());
+
+		// Transform to World in plain loops, which the compiler can vectorize.
+		glm::dmat3x3 const& m = transform.transfrom_;
+		for (vector_type& pos : positions)
+		{
+			pos = (m * pos) + transform.pos_;
+		}
+		if (tangents)
+		{
+			for (vector_type& tangent : *tangents)
+			{
+				tangent = m * tangent;
+			}
+		}
+	}
+
 	//void SplineHelper::GetWorldTBNAtCoord(value_type const& u,
 	//	vector_type& tangent, vector_type& binormal, vector_type& normal,
 	//	TransformHolder const& toWorld) const
@@ -164,8 +339,8 @@ namespace BeUtils
 	{
 		samples.clear();
 
-		double maxVelocity(0.0);
-		double const evalLen = EvalSplineLength(transform, maxVelocity,	0.01 /*dU*/, projection);
+		ArcLengthTable const& arcLengths = GetArcLengthTable(transform, projection);
+		double const evalLen = arcLengths.GetLength();
 		if (evalLen <= 0.)
 		{
 			BE_ISSUE("degenerated spline");
@@ -207,52 +382,21 @@ namespace BeUtils
 			}
 			targetNbSamples = *pFixedNbSamples;
 		}
-		samples.reserve(targetNbSamples);
-
-		// first sample the curve
-		const size_t numberOfSamples = std::max<size_t>(100, targetNbSamples * 10);
-		std::vector<value_type> samplesCumulatedDist(numberOfSamples, 0.0);
-		std::vector<vector_type> projSamples(numberOfSamples, vector_type(0.0));
-		vector_type prevPosition = proj.Project(GetPosition_world(0.0, transform));
-		projSamples[0] = prevPosition;
-		value_type const dU = value_type(1.0) / value_type(numberOfSamples - 1);
-		value_type u = dU;
-		for (size_t i = 1; i < numberOfSamples; ++i, u += dU)
-		{
-			vector_type const curPosition = proj.Project(GetPosition_world(u, transform));
-			projSamples[i] = curPosition;
-			samplesCumulatedDist[i] = samplesCumulatedDist[i - 1] + glm::distance(curPosition, prevPosition);
-			prevPosition = curPosition;
-		}
-		// Divide the length in equally-sized pieces
 
-		if (samplingMode == EPathRegularSamplingMode::FixedNbSamples && targetNbSamples > 1)
+		// Divide the length in equally-sized pieces, and find the matching abscissas in the arc-length table
+		std::vector<value_type> lengths(targetNbSamples);
+		for (size_t i = 0; i < targetNbSamples; ++i)
 		{
-			// Adjust deltaLength
-			deltaLength = samplesCumulatedDist.back() / value_type(targetNbSamples - 1);
+			lengths[i] = std::min(deltaLength * i, evalLen);
 		}
+		std::vector<value_type> coords(targetNbSamples);
+		arcLengths.GetCoordsAtLengths(lengths, coords);
 
-		// Always add the 1st sample
-		samples.push_back(projSamples[0]);
-
-		size_t iStart = 1, iLast = targetNbSamples;
-		value_type distOffset = 0.;
-		auto const distBegin = samplesCumulatedDist.begin();
-		auto const distEnd = samplesCumulatedDist.end();
-		auto itDist = distBegin;
-		for (size_t iCoord = iStart; iCoord <= iLast; ++iCoord)
+		GetPositionsAndTangents_world(coords, transform, samples);
+		for (vector_type& sample : samples)
 		{
-			value_type const valueToReach = deltaLength * iCoord + distOffset;
-			// Look for the smallest sample which length is bigger than the requested length
-			auto itLower = std::lower_bound(itDist, distEnd, valueToReach);
-			if (itLower != distEnd)
-			{
-				samples.push_back(projSamples[std::distance(distBegin, itLower)]);
-				itDist = itLower;
-			}
+			sample = proj.Project(sample);
 		}
-		BE_ASSERT(samplingMode == EPathRegularSamplingMode::FixedSpacing
-			|| samples.size() == targetNbSamples);
 		return samples.size();
 	}
 
@@ -438,9 +582,37 @@ namespace BeUtils
 		return segments.size();
 	}
 
+	ArcLengthTable const& SplineHelper::GetArcLengthTable(TransformHolder const& transform,
+		E2DProjection projection /*= None*/) const
+	{
+		std::optional<ArcLengthTable>& table = arcLengthTables_[(size_t)((int)projection + 1)];
+		if (!table || !table->IsBuiltFor(transform, projection))
+		{
+			table.emplace();
+			table->Build(*this, transform, projection);
+		}
+		return *table;
+	}
+
 	void SplineHelper::InvalidateCache()
 	{
 		cache_.Clear();
+		for (auto& table : arcLengthTables_)
+		{
+			table.reset();
+		}
+	}
+
+	void SplineHelper::OnControlPointMoved(size_t index)
+	{
+		cache_.Clear();
+		for (auto& table : arcLengthTables_)
+		{
+			if (table)
+			{
+				table->UpdateAroundControlPoint(*this, index);
+			}
+		}
 	}
 
 	SplineHelper::value_type SplineHelper::GetTotalDeltaU() const
@@ -486,15 +658,21 @@ namespace BeUtils
 
 		if (numControlPoints >= 2)
 		{
-			double u = 0.0; //GetStartTime();
 			double u_end = 1.0; //GetEndTime();
 
-			vector_type vPrev = projector.Project(GetPosition_world(u, transform));
-			u += dU;
+			std::vector<value_type> coords;
+			coords.reserve((size_t)(u_end / dU) + 2);
+			for (double u = 0.0 /*GetStartTime()*/; u <= u_end; u += dU)
+			{
+				coords.push_back(u);
+			}
+			std::vector<vector_type> positions;
+			GetPositionsAndTangents_world(coords, transform, positions);
 
-			for (; u <= u_end; u += dU)
+			vector_type vPrev = projector.Project(positions[0]);
+			for (size_t i = 1; i < positions.size(); ++i)
 			{
-				vector_type vPos = projector.Project(GetPosition_world(u, transform));
+				vector_type vPos = projector.Project(positions[i]);
 
 				double dSegmentLen = glm::length(vPos - vPrev);
 				double localVelocity = dSegmentLen / dU;
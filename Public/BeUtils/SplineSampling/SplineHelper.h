@@ -16,7 +16,10 @@
 #include <BeUtils/SplineSampling/ControlledCurve.h>
 
 #include <array>
+#include <optional>
+#include <span>
 #include <variant>
+#include <vector>
 
 
 namespace BeUtils
@@ -56,6 +59,66 @@ namespace BeUtils
 	};
 
 
+	class SplineHelper;
+
+	//------------------------------------------------------------
+	//
+	//	Arc-length table of a spline.
+	//
+	//------------------------------------------------------------
+	//! Length along the spline (in world coordinates, projected along given axis) tabulated at regular
+	//! abscissa steps within each span between two consecutive control points. Converting a length into a
+	//! curvilinear abscissa is then a binary search followed by a linear interpolation, instead of a new
+	//! sampling of the curve.
+	//! Spans are assumed to share the abscissa range evenly (which is the case of Unreal splines evaluated
+	//! by time), so that moving a control point only requires to re-sample the spans depending on it.
+	class ArcLengthTable
+	{
+	public:
+		using value_type = SplineCurve::value_type;
+
+		//! Samples the whole spline.
+		//! @param samplesPerSpan Number of length increments tabulated in each span.
+		void Build(SplineHelper const& spline, TransformHolder const& transform,
+			E2DProjection projection = E2DProjection::None, size_t samplesPerSpan = 32);
+
+		//! Re-samples the spans depending on the given control point, ie. the two spans on each side of it
+		//! since automatic tangents also depend on the neighbour control points. The whole table is rebuilt
+		//! if the number of control points has changed.
+		void UpdateAroundControlPoint(SplineHelper const& spline, size_t controlPointIndex);
+
+		bool IsEmpty() const { return spanStarts_.empty(); }
+		bool IsBuiltFor(TransformHolder const& transform, E2DProjection projection) const;
+
+		//! Returns the total length of the spline.
+		value_type GetLength() const { return IsEmpty() ? 0. : spanStarts_.back(); }
+
+		//! Returns the curvilinear abscissa at which the length along the spline, from its start, reaches
+		//! the given value (clamped to [0, GetLength()]).
+		value_type GetCoordAtLength(value_type length) const;
+
+		//! Same as GetCoordAtLength for a batch of lengths. When lengths are sorted, which is the case when
+		//! distributing samples along the spline, they are all inverted during a single pass on the table.
+		//! @param outCoords Must have the same size as lengths.
+		void GetCoordsAtLengths(std::span<value_type const> lengths, std::span<value_type> outCoords) const;
+
+	private:
+		void SampleSpan(SplineHelper const& spline, size_t span);
+		void UpdateSpanStarts(size_t firstSpan);
+		value_type GetCoordInSpan(size_t span, size_t sample, value_type lengthInSpan) const;
+
+	private:
+		TransformHolder transform_;
+		E2DProjection projection_ = E2DProjection::None;
+		size_t spanCount_ = 0;
+		size_t samplesPerSpan_ = 0;
+		//! Length from the start of the spline to the start of each span (plus total length at the end).
+		std::vector<value_type> spanStarts_;
+		//! For each span, length from its start to each of its samples (the last one being its length).
+		std::vector<value_type> lengthsInSpans_;
+	};
+
+
 	//------------------------------------------------------------
 	//
 	//	SplineHelper -> encapsulates a spline for use in the
@@ -85,6 +148,10 @@ namespace BeUtils
 		vector_type GetPosition_world(value_type const& u, TransformHolder const& transform) const;
 		//! Returns the tangent of the spline for curvilinear abscissa u (in Object coordinates).
 		vector_type GetTangentAtCoord(value_type const& u) const;
+		//! Returns the World positions, and optionally tangents, of the spline for a batch of curvilinear
+		//! abscissas. Prefer this to successive calls to GetPosition_world when sampling many positions.
+		void GetPositionsAndTangents_world(std::span<value_type const> coords, TransformHolder const& transform,
+			std::vector<vector_type>& positions, std::vector<vector_type>* tangents = nullptr) const;
 
 		//! Returns the number of control points in the spline.
 		size_t CountControlPoints() const;
@@ -114,9 +181,18 @@ namespace BeUtils
 			E2DProjection projection = E2DProjection::None) const;
 
 
+		//! Returns the arc-length table of the spline for given transformation and projection, building
+		//! it on first request.
+		ArcLengthTable const& GetArcLengthTable(TransformHolder const& transform,
+			E2DProjection projection = E2DProjection::None) const;
+
 		//! Clean cache (data recorded to avoid recomputing the spline for a given resolution several times).
 		void InvalidateCache();
 
+		//! To be called when a single control point was moved: the cached arc-length tables are only
+		//! updated around this point, instead of being recomputed from scratch.
+		void OnControlPointMoved(size_t index);
+
 
 		//---------------------------------------------------------------------------------------------------------
 		// Conversion to segments (useful for display, conversion to a map, etc.)
@@ -169,5 +245,6 @@ namespace BeUtils
 		SplineCurve const* pCurve_;
 
 		mutable CachedSegmentsContainer cache_; //!< Cache used to avoid recomputing the same spline at a given resolution several times).
+		mutable std::array<std::optional<ArcLengthTable>, 4> arcLengthTables_; //!< One per projection (including None).
 	};
 }
@@ -16,7 +16,7 @@
 
 namespace BeUtils
 {
-	static void SampleSplineInterior(SplineCurve const& spline,
+	static void SampleSplineInterior(SplineHelper const& splineHelper,
 		TransformHolder const& transform,
 		BoundingBox const& samplingBox_World,
 		glm::dvec3 const& averageInstanceDims_World,
@@ -60,7 +60,6 @@ namespace BeUtils
 
 		OcclusionMap surfaceGrid(samplingBox_World, cellsAlongX, cellsAlongY);
 
-		SplineHelper splineHelper(&spline);
 		SplinePattern spline2DEffect(transform, splineHelper);
 		spline2DEffect.SetOcclusion(false);
 		surfaceGrid.BuildFrom2DPattern(spline2DEffect);
@@ -68,13 +67,12 @@ namespace BeUtils
 		surfaceGrid.GetSampledPositions(outPositions, params.forceAligned, params.randSeed);
 	}
 
-	static void SampleSplinePath(SplineCurve const& spline,
+	static void SampleSplinePath(SplineHelper const& splineHelper,
 		TransformHolder const& transform,
 		glm::dvec3 const& /*averageInstanceDims_World*/,
 		SplineSamplingParameters const& params,
 		std::vector<SplineCurve::vector_type>& outPositions)
 	{
-		SplineHelper const splineHelper(&spline);
 		SplineHelper::EPathRegularSamplingMode const mode = params.fixedSpacing
 			? SplineHelper::EPathRegularSamplingMode::FixedSpacing
 			: SplineHelper::EPathRegularSamplingMode::FixedNbSamples;
@@ -102,14 +100,25 @@ namespace BeUtils
 		glm::dvec3 const& averageInstanceDims_World,
 		SplineSamplingParameters const& params,
 		std::vector<SplineCurve::vector_type>& outPositions)
+	{
+		SplineHelper const splineHelper(&spline);
+		SampleSpline(splineHelper, transform, samplingBox_World, averageInstanceDims_World, params, outPositions);
+	}
+
+	void SampleSpline(SplineHelper const& splineHelper,
+		TransformHolder const& transform,
+		BoundingBox const& samplingBox_World,
+		glm::dvec3 const& averageInstanceDims_World,
+		SplineSamplingParameters const& params,
+		std::vector<SplineCurve::vector_type>& outPositions)
 	{
 		if (params.samplingMode == ESplineSamplingMode::Interior)
 		{
-			SampleSplineInterior(spline, transform, samplingBox_World, averageInstanceDims_World, params, outPositions);
+			SampleSplineInterior(splineHelper, transform, samplingBox_World, averageInstanceDims_World, params, outPositions);
 		}
 		else
 		{
-			SampleSplinePath(spline, transform, averageInstanceDims_World, params, outPositions);
+			SampleSplinePath(splineHelper, transform, averageInstanceDims_World, params, outPositions);
 		}
 	}
 }
@@ -15,6 +15,8 @@
 
 namespace BeUtils
 {
+	class SplineHelper;
+
 	enum class ESplineSamplingMode
 	{
 		AlongPath,
@@ -50,4 +52,14 @@ namespace BeUtils
 		glm::dvec3 const& averageInstanceDims_World,
 		SplineSamplingParameters const& params,
 		std::vector<SplineCurve::vector_type>& outPositions);
+
+	//! Sample a spline wrapped in a helper which is kept between samplings, so that the data it caches
+	//! (arc-length tables, baked segments) is reused, and only updated where the spline was edited (see
+	//! SplineHelper::OnControlPointMoved).
+	void SampleSpline(SplineHelper const& splineHelper,
+		TransformHolder const& transform,
+		BoundingBox const& samplingBox_World,
+		glm::dvec3 const& averageInstanceDims_World,
+		SplineSamplingParameters const& params,
+		std::vector<SplineCurve::vector_type>& outPositions);
 }
@@ -0,0 +1,110 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TiledBitmask.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace BeUtils
+{
+	//------------------------------------------------------------------------
+	// Grid of bits, split into square tiles of TileSize x TileSize cells.
+	//	Each row of a tile is held by a single word, so that spans of cells
+	//	are set one word (ie. up to 64 cells) at a time, and cells are counted
+	//	with popcount. Tiles are stored row by row.
+	//------------------------------------------------------------------------
+	class TiledBitmask
+	{
+	public:
+		using Word = uint64_t;
+		static constexpr int TileSize = 64;
+
+		TiledBitmask() {}
+
+		//! Resizes the grid, and clears all its cells.
+		void Resize(int width, int height)
+		{
+			nWidth_ = std::max(width, 0);
+			nHeight_ = std::max(height, 0);
+			nTilesX_ = (nWidth_ + TileSize - 1) / TileSize;
+			nTilesY_ = (nHeight_ + TileSize - 1) / TileSize;
+			words_.assign(static_cast<size_t>(nTilesX_) * nTilesY_ * TileSize, 0);
+		}
+
+		int GetWidth() const { return nWidth_; }
+		int GetHeight() const { return nHeight_; }
+		int CountTilesX() const { return nTilesX_; }
+		int CountTilesY() const { return nTilesY_; }
+		int CountTiles() const { return nTilesX_ * nTilesY_; }
+
+		bool Get(int x, int y) const
+		{
+			return (GetWord(static_cast<unsigned>(x) / TileSize, y) >> (static_cast<unsigned>(x) % TileSize)) & 1;
+		}
+
+		//! Sets the cells [xBegin, xEnd[ of row y. Rows can be set concurrently, since they do not share
+		//! any word.
+		void SetSpan(int y, int xBegin, int xEnd)
+		{
+			xBegin = std::max(xBegin, 0);
+			xEnd = std::min(xEnd, nWidth_);
+			if (xBegin >= xEnd || y < 0 || y >= nHeight_)
+				return;
+			int const lastTileX = (xEnd - 1) / TileSize;
+			for (int tileX = xBegin / TileSize; tileX <= lastTileX; ++tileX)
+			{
+				int const first = std::max(xBegin - tileX * TileSize, 0);
+				int const last = std::min(xEnd - tileX * TileSize, TileSize); // excluded
+				Word const highBits = (last == TileSize) ? ~Word(0) : ((Word(1) << last) - 1);
+				WordAt(tileX, y) |= highBits & (~Word(0) << first);
+			}
+		}
+
+		//! Returns the cells of row y covered by tile column tileX, as a word (bit i <=> x = tileX * TileSize + i).
+		Word GetWord(int tileX, int y) const
+		{
+			return words_[GetWordIndex(tileX, y)];
+		}
+
+		//! Bits of the words of tile column tileX which lie inside the grid.
+		Word GetValidMask(int tileX) const
+		{
+			int const count = std::min(nWidth_ - tileX * TileSize, TileSize);
+			return (count >= TileSize) ? ~Word(0) : ((Word(1) << count) - 1);
+		}
+
+		size_t CountSetCells() const
+		{
+			size_t count = 0;
+			for (Word const word : words_)
+				count += std::popcount(word);
+			return count;
+		}
+
+	private:
+		size_t GetWordIndex(int tileX, int y) const
+		{
+			// coordinates are never negative: unsigned divisions are plain shifts
+			size_t const row = static_cast<unsigned>(y);
+			return ((row / TileSize) * nTilesX_ + static_cast<unsigned>(tileX)) * TileSize + (row % TileSize);
+		}
+
+		Word& WordAt(int tileX, int y)
+		{
+			return words_[GetWordIndex(tileX, y)];
+		}
+
+		std::vector<Word> words_;
+		int nWidth_ = 0, nHeight_ = 0;
+		int nTilesX_ = 0, nTilesY_ = 0;
+	};
+}
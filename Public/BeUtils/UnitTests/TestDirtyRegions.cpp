@@ -0,0 +1,146 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestDirtyRegions.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/Misc/DirtyRegions.h>
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	using BeUtils::DirtyRegions;
+	using Rects = std::vector<DirtyRegions::Rect>;
+
+	//! Checks that the rectangles are sorted, do not overlap, and cover all the given pixels.
+	void CheckCoverage(DirtyRegions const& regions, Rects const& rects,
+		std::vector<std::vector<bool>> const& dirty)
+	{
+		std::vector<std::vector<int>> coverCount(regions.Height(), std::vector<int>(regions.Width(), 0));
+		for (std::size_t i = 0; i < rects.size(); ++i)
+		{
+			auto const& rect = rects[i];
+			REQUIRE(rect.width > 0);
+			REQUIRE(rect.height > 0);
+			REQUIRE(rect.x + rect.width <= regions.Width());
+			REQUIRE(rect.y + rect.height <= regions.Height());
+			if (i > 0)
+				REQUIRE(rects[i - 1].y + rects[i - 1].height <= rect.y);
+			for (uint32_t y = rect.y; y < rect.y + rect.height; ++y)
+				for (uint32_t x = rect.x; x < rect.x + rect.width; ++x)
+					++coverCount[y][x];
+		}
+		for (uint32_t y = 0; y < regions.Height(); ++y)
+			for (uint32_t x = 0; x < regions.Width(); ++x)
+			{
+				REQUIRE(coverCount[y][x] <= 1);
+				if (dirty[y][x])
+					REQUIRE(coverCount[y][x] == 1);
+			}
+	}
+}
+
+TEST_CASE("TestDirtyRegions")
+{
+	SECTION("Basics")
+	{
+		DirtyRegions regions(10, 8);
+		Rects rects;
+		// Everything is dirty initially, so that the first upload is complete.
+		CHECK(regions.IsAllDirty());
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 0, 0, 10, 8 } }));
+		regions.MarkPixel(3, 3);
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 0, 0, 10, 8 } }));
+		regions.Clear();
+		CHECK(!regions.IsDirty());
+		regions.Coalesce(rects);
+		CHECK(rects.empty());
+		regions.MarkPixel(3, 2);
+		CHECK(regions.IsDirty());
+		CHECK(!regions.IsAllDirty());
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 3, 2, 1, 1 } }));
+		// Row-major index.
+		regions.MarkPixel(7 + 2 * 10);
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 3, 2, 5, 1 } }));
+		regions.Clear();
+		regions.MarkAll();
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 0, 0, 10, 8 } }));
+	}
+
+	SECTION("Coalescing")
+	{
+		DirtyRegions regions(100, 100);
+		regions.Clear();
+		Rects rects;
+		// Neighbouring rows are merged...
+		regions.MarkPixel(10, 10);
+		regions.MarkPixel(11, 11);
+		regions.Coalesce(rects);
+		CHECK(rects == Rects({ { 10, 10, 2, 2 } }));
+		// ...but not distant pixels, unless they cost less than a region.
+		regions.MarkPixel(90, 80);
+		regions.Coalesce(rects, 16, 16);
+		CHECK(rects == Rects({ { 10, 10, 2, 2 }, { 90, 80, 1, 1 } }));
+		regions.Coalesce(rects, 16, 100 * 100);
+		CHECK(rects == Rects({ { 10, 10, 81, 71 } }));
+		// The maximum number of rectangles is respected.
+		regions.Coalesce(rects, 1, 0);
+		CHECK(rects == Rects({ { 10, 10, 81, 71 } }));
+	}
+
+	SECTION("RandomWrites")
+	{
+		std::mt19937 gen(1234);
+		for (uint32_t const dim : { 1u, 2u, 7u, 64u, 300u })
+		{
+			for (int const pixelCount : { 1, 5, 50, 2000 })
+			{
+				INFO("dim = " << dim << ", pixelCount = " << pixelCount);
+				DirtyRegions regions(dim, dim);
+				regions.Clear();
+				std::vector<std::vector<bool>> dirty(dim, std::vector<bool>(dim, false));
+				std::uniform_int_distribution<uint32_t> pixel(0, dim * dim - 1);
+				uint64_t spansArea = 0;
+				for (int i = 0; i < pixelCount; ++i)
+				{
+					uint32_t const p = pixel(gen);
+					regions.MarkPixel(p);
+					dirty[p / dim][p % dim] = true;
+				}
+				for (auto const& row : dirty)
+				{
+					auto const first = std::find(row.begin(), row.end(), true);
+					if (first != row.end())
+						spansArea += (row.rend() - std::find(row.rbegin(), row.rend(), true)) - (first - row.begin());
+				}
+				Rects rects;
+				for (std::size_t const maxRects : { std::size_t(1), std::size_t(4), std::size_t(16), dim * std::size_t(2) })
+				{
+					regions.Coalesce(rects, maxRects, 0);
+					CheckCoverage(regions, rects, dirty);
+					REQUIRE(rects.size() <= maxRects);
+					if (maxRects >= dim)
+					{
+						// Without any limit nor cost for regions, rectangles are merged only when it does not
+						// upload more pixels than the row spans.
+						uint64_t area = 0;
+						for (auto const& rect : rects)
+							area += rect.Area();
+						REQUIRE(area == spansArea);
+					}
+				}
+				regions.Coalesce(rects);
+				CheckCoverage(regions, rects, dirty);
+			}
+		}
+	}
+}
@@ -7,12 +7,15 @@
 +--------------------------------------------------------------------------------------*/
 
 #include <catch2/catch_all.hpp>
+#include <BeUtils/Gltf/ExtensionITwinFeatureRanges.h>
 #include <BeUtils/Gltf/ExtensionITwinMaterialID.h>
 #include <BeUtils/Gltf/GltfTuner.h>
 #include <BeUtils/Gltf/GltfBuilder.h>
+#include <CesiumGltf/AccessorUtility.h>
 #include <CesiumGltf/ExtensionModelExtStructuralMetadata.h>
 #include <CesiumGltf/ExtensionExtMeshFeatures.h>
 #include <CesiumGltfWriter/GltfWriter.h>
+#include <chrono>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
@@ -619,6 +622,44 @@ TEST_CASE("TestSplitAndMerge")
 	CheckGltf(expectedBuilder.GetModel(), out_tuned);
 }
 
+TEST_CASE("TestEditMaterialRules")
+{
+	// Editing the rules of a tuner must give the same result as applying the new rules to a new tuner,
+	// even though derived data are updated incrementally.
+	BeUtils::GltfBuilder gltfBuilder;
+	gltfBuilder.AddMetadataProperty(FEATURE_TABLE_NAME, "element", std::vector<uint64_t>{100,101,102,103});
+	gltfBuilder.GetModel().meshes.emplace_back();
+	int v = 0;
+	AddMeshPrimitive({.gltfBuilder = gltfBuilder,
+		.patches = {{{v++,0},{v++,0},{v++,0}}, {{v++,1},{v++,1},{v++,1}},
+					{{v++,2},{v++,2},{v++,2}}, {{v++,3},{v++,3},{v++,3}}},
+		.material = 0});
+	const auto tune = [&](BeUtils::GltfTuner& tuner)
+		{
+			CesiumGltf::Model out_tuned;
+			tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_tuned);
+			return out_tuned;
+		};
+	const auto tuneWithNewTuner = [&](BeUtils::GltfTuner::Rules&& rules)
+		{
+			BeUtils::GltfTuner tuner(true);
+			tuner.SetMaterialRules(std::move(rules));
+			return tune(tuner);
+		};
+	BeUtils::GltfTuner tuner(true);
+	tuner.SetMaterialRules({{{{100,101}, 1}, {{102}, 2}}});
+	CheckGltf(tuneWithNewTuner({{{{100,101}, 1}, {{102}, 2}}}), tune(tuner));
+	// Only the elements of the second group change (101 now belongs to both groups: the last one wins).
+	tuner.SetMaterialRules({{{{100,101}, 1}, {{101,102,103}, 2}}});
+	CheckGltf(tuneWithNewTuner({{{{100,101}, 1}, {{101,102,103}, 2}}}), tune(tuner));
+	// Only a material changes.
+	tuner.SetMaterialRules({{{{100,101}, 3}, {{101,102,103}, 2}}});
+	CheckGltf(tuneWithNewTuner({{{{100,101}, 3}, {{101,102,103}, 2}}}), tune(tuner));
+	// A group is removed.
+	tuner.SetMaterialRules({{{{100,101}, 3}}});
+	CheckGltf(tuneWithNewTuner({{{{100,101}, 3}}}), tune(tuner));
+}
+
 TEST_CASE("TestPropertyTableValuesIndex")
 {
 	// This test verifies that PropertyTableProperty::values is correctly set by the tuner.
@@ -748,4 +789,135 @@ TEST_CASE("TestSplitMaterialFeatureId_OneMaterial")
 	CesiumGltf::Model out_tuned;
 	tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_tuned);
 	CheckGltf(expectedBuilder.GetModel(), out_tuned);
-}
\ No newline at end of file
+}
+
+TEST_CASE("TestFeatureRanges")
+{
+	// Features of various sizes, some of them shared by several primitives (merged or not), and in several
+	// material groups, so that the tuned primitives interleave the features in different ways.
+	BeUtils::GltfBuilder gltfBuilder;
+	gltfBuilder.AddMetadataProperty(FEATURE_TABLE_NAME, "element", std::vector<uint64_t>{100,101,102,103,104});
+	gltfBuilder.GetModel().meshes.emplace_back();
+	int v = 0;
+	for (int p = 0; p < 6; ++p)
+	{
+		std::vector<Patch> patches;
+		for (int i = 0; i < 5; ++i)
+		{
+			const float featureId = float((p+i*i)%5);
+			Patch patch;
+			for (int j = 0; j < 3+(p+i)%4; ++j)
+				patch.push_back({v++, featureId});
+			patches.push_back(std::move(patch));
+		}
+		AddMeshPrimitive({.gltfBuilder = gltfBuilder, .patches = std::move(patches), .material = p%2});
+	}
+	BeUtils::GltfTuner tuner(true);
+	tuner.SetMaterialRules({{{{101,103}, 2}}});
+	CesiumGltf::Model out_tuned;
+	tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_tuned);
+	int checkedPrimitives = 0;
+	for (const auto& mesh: out_tuned.meshes)
+		for (const auto& primitive: mesh.primitives)
+		{
+			const auto* rangesExt = primitive.getExtension<BeUtils::ExtensionITwinFeatureRanges>();
+			REQUIRE(rangesExt);
+			// Expand the table and compare with the feature IDs read per vertex, as cesium-unreal does.
+			const auto featureIdAttribute = primitive.attributes.find("_FEATURE_ID_0");
+			REQUIRE(featureIdAttribute != primitive.attributes.end());
+			const auto featureIdView = CesiumGltf::getFeatureIdAccessorView(out_tuned, primitive, 0);
+			const auto vertexCount = std::visit(CesiumGltf::CountFromAccessor{}, featureIdView);
+			std::vector<int64_t> expanded(vertexCount, -1);
+			uint32_t nextVertex = 0;
+			for (const auto& range: rangesExt->ranges)
+			{
+				REQUIRE(range.vertexCount > 0);
+				REQUIRE(range.firstVertex >= nextVertex);
+				nextVertex = range.firstVertex + range.vertexCount;
+				REQUIRE(nextVertex <= (uint32_t)vertexCount);
+				std::fill_n(expanded.begin() + range.firstVertex, range.vertexCount, range.featureId);
+			}
+			for (int64_t vertex = 0; vertex < vertexCount; ++vertex)
+				REQUIRE(expanded[vertex] == std::visit(CesiumGltf::FeatureIdFromAccessor{vertex}, featureIdView));
+			// The table is run-length encoded: adjacent ranges have different features.
+			for (size_t r = 1; r < rangesExt->ranges.size(); ++r)
+				REQUIRE((rangesExt->ranges[r].featureId != rangesExt->ranges[r-1].featureId
+					|| rangesExt->ranges[r].firstVertex != rangesExt->ranges[r-1].firstVertex + rangesExt->ranges[r-1].vertexCount));
+			++checkedPrimitives;
+		}
+	REQUIRE(checkedPrimitives > 1);
+}
+
+//! Builds a mesh made of many primitives of many elements, spread in several material groups.
+void AddManyPrimitives(BeUtils::GltfBuilder& gltfBuilder, int primitiveCount, int patchesPerPrimitive,
+	int elementCount)
+{
+	std::vector<uint64_t> elementIds(elementCount);
+	for (int i = 0; i < elementCount; ++i)
+		elementIds[i] = 100+i;
+	gltfBuilder.AddMetadataProperty(FEATURE_TABLE_NAME, "element", elementIds);
+	gltfBuilder.GetModel().meshes.emplace_back();
+	int v = 0;
+	for (int p = 0; p < primitiveCount; ++p)
+	{
+		std::vector<Patch> patches;
+		for (int i = 0; i < patchesPerPrimitive; ++i)
+		{
+			const float featureId = float((p*patchesPerPrimitive+i)/4%elementCount);
+			Patch patch;
+			for (int j = 0; j < 5; ++j)
+				patch.push_back({v++, featureId});
+			patches.push_back(std::move(patch));
+		}
+		AddMeshPrimitive({.gltfBuilder = gltfBuilder,
+			.patches = std::move(patches),
+			.material = p%3,
+			.indexFormat = {CesiumGltf::Accessor::ComponentType::UNSIGNED_INT}});
+	}
+}
+
+TEST_CASE("TestParallelTuneMatchesSequential")
+{
+	// Primitives are classified in parallel then merged: the result must be the same as when they are
+	// classified one after the other.
+	BeUtils::GltfBuilder gltfBuilder;
+	AddManyPrimitives(gltfBuilder, 12, 100, 60);
+	BeUtils::GltfTuner tuner(true);
+	tuner.SetMaterialRules({{{{100,101,102,103,104,105,106,107,108,109}, 3},
+		{{130,131,132,133,134,135,136,137,138,139}, 4}}});
+	CesiumGltf::Model out_sequential;
+	REQUIRE(tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_sequential, false));
+	CesiumGltf::Model out_parallel;
+	REQUIRE(tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_parallel, true));
+	REQUIRE(out_sequential.meshes.size() == 1);
+	REQUIRE(out_sequential.meshes[0].primitives.size() > 1);
+	CheckGltf(out_sequential, out_parallel);
+}
+
+TEST_CASE("TestTuneBenchmark", "[.][benchmark]")
+{
+	// Many primitives of many elements, spread in several material groups: primitives are processed in
+	// parallel, the result must not depend on the scheduling.
+	constexpr int primitiveCount = 32;
+	constexpr int patchesPerPrimitive = 2000;
+	BeUtils::GltfBuilder gltfBuilder;
+	AddManyPrimitives(gltfBuilder, primitiveCount, patchesPerPrimitive, 1000);
+	BeUtils::GltfTuner tuner(true);
+	tuner.SetMaterialRules({{{{100,101,102,103,104,105,106,107,108,109}, 3},
+		{{200,201,202,203,204,205,206,207,208,209}, 4}}});
+	CesiumGltf::Model reference;
+	tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), reference);
+	constexpr int iterations = 10;
+	const auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		CesiumGltf::Model out_tuned;
+		tuner.applyForUnitTest(gltfBuilder.GetModel(), glm::dmat4x4(1.0), out_tuned);
+		REQUIRE(out_tuned.buffers.size() == reference.buffers.size());
+		for (int bufferIndex = 0; bufferIndex < (int)reference.buffers.size(); ++bufferIndex)
+			REQUIRE([&]{return reference.buffers[bufferIndex].cesium.data == out_tuned.buffers[bufferIndex].cesium.data;}());
+	}
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Tune " << primitiveCount << " primitives x " << patchesPerPrimitive << " patches: "
+		<< elapsed.count()/iterations << " ms" << std::endl;
+}
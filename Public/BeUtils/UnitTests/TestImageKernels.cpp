@@ -0,0 +1,182 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestImageKernels.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/Misc/ImageKernels.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using namespace BeUtils::ImageKernels;
+
+	std::vector<std::byte> MakeRandomImage(int width, int height, uint32_t seed)
+	{
+		std::mt19937 gen(seed);
+		std::uniform_int_distribution<int> dist(0, 255);
+		std::vector<std::byte> image(4 * static_cast<std::size_t>(width) * height);
+		for (auto& b : image)
+			b = static_cast<std::byte>(dist(gen));
+		return image;
+	}
+
+	//! Instruction sets supported by the current CPU, other than the scalar reference.
+	std::vector<EInstructionSet> GetSimdInstructionSets()
+	{
+		std::vector<EInstructionSet> sets;
+		for (auto set : { EInstructionSet::SSE2, EInstructionSet::AVX2, EInstructionSet::NEON })
+			if (IsSupported(set))
+				sets.push_back(set);
+		return sets;
+	}
+
+	//! Restores the default instruction set at the end of a test.
+	struct ScopedInstructionSet
+	{
+		EInstructionSet const previous_ = GetInstructionSet();
+		~ScopedInstructionSet() { SetInstructionSet(previous_); }
+	};
+}
+
+TEST_CASE("TestImageKernels")
+{
+	ScopedInstructionSet scopedSet;
+	// Odd sizes, to test the scalar code handling the remaining pixels of each row in the SIMD kernels.
+	int const width = 67, height = 37;
+	std::vector<std::byte> const src = MakeRandomImage(width, height, 42);
+	std::size_t const pixelCount = static_cast<std::size_t>(width) * height;
+
+	SECTION("Intensity")
+	{
+		CHECK(Intensity(0, 0, 0) == 0);
+		CHECK(Intensity(255, 255, 255) == 255);
+		CHECK(Intensity(255, 0, 0) == 90);
+		CHECK(Intensity(0, 255, 0) == 128);
+	}
+
+	// Results of the scalar implementation.
+	REQUIRE(SetInstructionSet(EInstructionSet::Scalar));
+	std::vector<std::vector<std::byte>> refIntensity(4, MakeRandomImage(width, height, 7));
+	for (unsigned chan = 0; chan < 4; ++chan)
+		ExtractIntensity(refIntensity[chan].data(), chan, src.data(), pixelCount);
+	std::vector<std::byte> refBox((width / 2) * (height / 2) * 4);
+	DownsampleBox2x(refBox.data(), src.data(), width, height);
+	std::vector<std::byte> refBilinear(29 * 13 * 4), refUpsampled(101 * 53 * 4), refDownsampled(11 * 6 * 4);
+	ResampleBilinear(refBilinear.data(), 29, 13, src.data(), width, height);
+	ResampleBilinear(refUpsampled.data(), 101, 53, src.data(), width, height);
+	Downsample(refDownsampled.data(), 11, 6, src.data(), width, height);
+
+	SECTION("Scalar")
+	{
+		for (std::size_t i = 0; i < pixelCount; ++i)
+		{
+			auto const* p = reinterpret_cast<uint8_t const*>(src.data()) + 4 * i;
+			auto const* q = reinterpret_cast<uint8_t const*>(refIntensity[1].data()) + 4 * i;
+			REQUIRE(q[1] == Intensity(p[0], p[1], p[2]));
+		}
+		// Box filter on a uniform image, and resampling to the same size, are exact.
+		std::vector<std::byte> const uniform(4 * 8 * 8, std::byte(77));
+		std::vector<std::byte> out(4 * 4 * 4);
+		DownsampleBox2x(out.data(), uniform.data(), 8, 8);
+		CHECK(out == std::vector<std::byte>(4 * 4 * 4, std::byte(77)));
+		std::vector<std::byte> same(src.size());
+		ResampleBilinear(same.data(), width, height, src.data(), width, height);
+		CHECK(same == src);
+	}
+
+	SECTION("HasPartialAlpha")
+	{
+		std::vector<std::byte> image(4 * 100, std::byte(255));
+		for (std::size_t i = 0; i < 100; i += 2)
+			image[4 * i + 3] = std::byte(0);
+		for (auto set : GetSimdInstructionSets())
+		{
+			INFO(GetInstructionSetName(set));
+			REQUIRE(SetInstructionSet(set));
+			CHECK(!HasPartialAlpha(image.data(), 100, EAlphaSource::AlphaChannel));
+			CHECK(!HasPartialAlpha(image.data(), 100, EAlphaSource::Intensity));
+			// Partial alpha in the last pixel (processed by the scalar code, except for SSE2) or in the middle.
+			for (std::size_t pix : { 99, 50 })
+			{
+				auto modified = image;
+				modified[4 * pix + 3] = std::byte(128);
+				CHECK(HasPartialAlpha(modified.data(), 100, EAlphaSource::AlphaChannel));
+				CHECK(!HasPartialAlpha(modified.data(), 100, EAlphaSource::Intensity));
+				modified[4 * pix + 1] = std::byte(0);
+				CHECK(HasPartialAlpha(modified.data(), 100, EAlphaSource::Intensity));
+			}
+		}
+	}
+
+	SECTION("SimdMatchesScalar")
+	{
+		for (auto set : GetSimdInstructionSets())
+		{
+			INFO(GetInstructionSetName(set));
+			REQUIRE(SetInstructionSet(set));
+			for (unsigned chan = 0; chan < 4; ++chan)
+			{
+				auto dst = MakeRandomImage(width, height, 7);
+				ExtractIntensity(dst.data(), chan, src.data(), pixelCount);
+				CHECK(dst == refIntensity[chan]);
+			}
+			CHECK(HasPartialAlpha(src.data(), pixelCount, EAlphaSource::AlphaChannel));
+
+			std::vector<std::byte> box(refBox.size());
+			DownsampleBox2x(box.data(), src.data(), width, height);
+			CHECK(box == refBox);
+			std::vector<std::byte> bilinear(refBilinear.size()), upsampled(refUpsampled.size()),
+				downsampled(refDownsampled.size());
+			ResampleBilinear(bilinear.data(), 29, 13, src.data(), width, height);
+			CHECK(bilinear == refBilinear);
+			ResampleBilinear(upsampled.data(), 101, 53, src.data(), width, height);
+			CHECK(upsampled == refUpsampled);
+			Downsample(downsampled.data(), 11, 6, src.data(), width, height);
+			CHECK(downsampled == refDownsampled);
+		}
+	}
+}
+
+TEST_CASE("TestImageKernelsBenchmark", "[.][benchmark]")
+{
+	ScopedInstructionSet scopedSet;
+	std::vector<EInstructionSet> sets = GetSimdInstructionSets();
+	sets.insert(sets.begin(), EInstructionSet::Scalar);
+	for (int const size : { 4096, 8192 })
+	{
+		std::vector<std::byte> const src = MakeRandomImage(size, size, 42);
+		std::vector<std::byte> dst(src.size());
+		std::vector<std::byte> const opaque(src.size(), std::byte(255)); // no early exit in HasPartialAlpha
+		std::vector<std::byte> thumbnail(4 * 256 * 256);
+		std::size_t const pixelCount = static_cast<std::size_t>(size) * size;
+		for (auto set : sets)
+		{
+			REQUIRE(SetInstructionSet(set));
+			std::string const suffix = std::string(" ") + std::to_string(size) + " " + GetInstructionSetName(set);
+			BENCHMARK("ExtractIntensity" + suffix)
+			{
+				ExtractIntensity(dst.data(), 3, src.data(), pixelCount);
+				return dst[3];
+			};
+			BENCHMARK("HasPartialAlpha" + suffix)
+			{
+				return HasPartialAlpha(opaque.data(), pixelCount, EAlphaSource::Intensity);
+			};
+			BENCHMARK("DownsampleBox2x" + suffix)
+			{
+				DownsampleBox2x(dst.data(), src.data(), size, size);
+				return dst[0];
+			};
+			BENCHMARK("Downsample to 256" + suffix)
+			{
+				Downsample(thumbnail.data(), 256, 256, src.data(), size, size);
+				return thumbnail[0];
+			};
+		}
+	}
+}
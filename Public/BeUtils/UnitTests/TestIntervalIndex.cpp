@@ -0,0 +1,96 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestIntervalIndex.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/Misc/IntervalIndex.h>
+#include <random>
+
+namespace
+{
+	using BeUtils::IntervalIndex;
+
+	//! Synthetic 4D schedule: most tasks are short with respect to the whole schedule, a few span most of it.
+	std::vector<IntervalIndex::Interval> MakeSchedule(std::size_t taskCount, uint32_t seed)
+	{
+		std::mt19937 gen(seed);
+		double const scheduleLength = 1000.;
+		std::uniform_real_distribution<double> start(0., scheduleLength);
+		std::exponential_distribution<double> duration(1. / 5.);
+		std::vector<IntervalIndex::Interval> tasks(taskCount);
+		for (std::size_t i = 0; i < taskCount; ++i)
+		{
+			auto& task = tasks[i];
+			task.id = static_cast<IntervalIndex::Id>(i);
+			task.first = start(gen);
+			task.last = task.first + ((i % 100 == 0) ? scheduleLength : duration(gen));
+			if (i % 50 == 1)
+				task.last = task.first; // single keyframe
+		}
+		return tasks;
+	}
+
+	std::vector<IntervalIndex::Id> BruteForce(std::vector<IntervalIndex::Interval> const& tasks,
+		double first, double last)
+	{
+		std::vector<IntervalIndex::Id> ids;
+		for (auto const& task : tasks)
+			if (task.first <= last && first <= task.last && task.first <= task.last)
+				ids.push_back(task.id);
+		return ids;
+	}
+}
+
+TEST_CASE("TestIntervalIndex")
+{
+	SECTION("Empty")
+	{
+		IntervalIndex index;
+		std::vector<IntervalIndex::Id> ids;
+		index.Query(0., 10., ids);
+		CHECK(ids.empty());
+		index.Build({ { 5., 4., 0 } }); // empty interval
+		CHECK(index.IsEmpty());
+	}
+
+	SECTION("Bounds")
+	{
+		IntervalIndex index({ { 0., 10., 0 }, { 10., 20., 1 }, { 30., 30., 2 } });
+		using Ids = std::vector<IntervalIndex::Id>;
+		Ids ids;
+		index.Query(10., 10., ids);
+		CHECK(ids == Ids({ 0, 1 }));
+		ids.clear();
+		index.Query(21., 29.9, ids);
+		CHECK(ids.empty());
+		index.Query(25., 35., ids);
+		CHECK(ids == Ids({ 2 }));
+		index.Query(-5., -1., ids); // appends
+		CHECK(ids == Ids({ 2 }));
+	}
+
+	SECTION("SyntheticSchedules")
+	{
+		for (std::size_t const taskCount : { 1, 2, 3, 7, 16, 17, 100, 1000, 20000 })
+		{
+			INFO("taskCount = " << taskCount);
+			auto const tasks = MakeSchedule(taskCount, static_cast<uint32_t>(taskCount));
+			IntervalIndex const index{ std::vector<IntervalIndex::Interval>(tasks) };
+			std::mt19937 gen(42);
+			std::uniform_real_distribution<double> time(-10., 1010.);
+			for (int query = 0; query < 200; ++query)
+			{
+				// Mostly small increments, like during playback, and a few large jumps.
+				double const t0 = time(gen);
+				double const t1 = t0 + ((query % 10 == 0) ? 300. : 0.05);
+				std::vector<IntervalIndex::Id> ids;
+				index.Query(t0, t1, ids);
+				REQUIRE(ids == BruteForce(tasks, t0, t1));
+			}
+		}
+	}
+}
@@ -0,0 +1,188 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestOcclusionMap.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/SplineSampling/OcclusionMap.h>
+#include <BeUtils/SplineSampling/SplineHelper.h>
+#include <BeUtils/SplineSampling/SplinePattern.h>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using BeUtils::OcclusionMap;
+	using BeUtils::TiledBitmask;
+
+	//! Closed polyline, each side being a span of the curve.
+	class PolygonCurve : public BeUtils::SplineCurve
+	{
+	public:
+		explicit PolygonCurve(std::vector<glm::dvec3> const& points) : points_(points) {}
+
+		glm::dvec3 GetPositionAtCoord(double const& u) const override
+		{
+			auto const [i, t] = GetSide(u);
+			return points_[i] + t * (points_[(i + 1) % points_.size()] - points_[i]);
+		}
+
+		glm::dvec3 GetTangentAtCoord(double const& u) const override
+		{
+			size_t const i = GetSide(u).first;
+			return double(points_.size()) * (points_[(i + 1) % points_.size()] - points_[i]);
+		}
+
+		bool IsCyclic() const override { return true; }
+		size_t PointCount(const bool accountForCyclicity) const override
+		{
+			return points_.size() + (accountForCyclicity ? 1 : 0);
+		}
+		glm::dvec3 GetPositionAtIndex(size_t idx) const override { return points_[idx]; }
+
+	private:
+		std::pair<size_t, double> GetSide(double u) const
+		{
+			double const s = std::clamp(u, 0., 1.) * points_.size();
+			size_t const i = std::min((size_t)s, points_.size() - 1);
+			return { i, s - i };
+		}
+
+		std::vector<glm::dvec3> points_;
+	};
+
+	std::vector<glm::dvec3> MakeDisk(size_t pointCount, double radius)
+	{
+		std::vector<glm::dvec3> points(pointCount);
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			double const angle = 2. * std::numbers::pi * i / pointCount;
+			points[i] = glm::dvec3(radius * std::cos(angle), radius * std::sin(angle), 0.);
+		}
+		return points;
+	}
+
+	BeUtils::BoundingBox MakeBox(double halfSize)
+	{
+		BeUtils::BoundingBox box;
+		box.min = { -halfSize, -halfSize, 0. };
+		box.max = { halfSize, halfSize, 0. };
+		return box;
+	}
+
+	//! Occlusion map of the interior of the given polygon, as done in SampleSpline.
+	void BuildInteriorMap(OcclusionMap& map, PolygonCurve const& curve)
+	{
+		BeUtils::TransformHolder const identity;
+		BeUtils::SplineHelper const helper(&curve);
+		BeUtils::SplinePattern pattern(identity, helper);
+		pattern.SetOcclusion(false);
+		map.BuildFrom2DPattern(pattern);
+	}
+}
+
+TEST_CASE("TestOcclusionMap")
+{
+	SECTION("TiledBitmask")
+	{
+		int const width = 300, height = 130;
+		TiledBitmask mask;
+		mask.Resize(width, height);
+		CHECK(mask.CountTilesX() == 5);
+		CHECK(mask.CountTilesY() == 3);
+		std::vector<bool> ref(width * height, false);
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<int> xDist(-10, width + 10), yDist(0, height - 1);
+		for (int i = 0; i < 500; ++i)
+		{
+			int const y = yDist(gen);
+			int xBegin = xDist(gen), xEnd = xDist(gen);
+			if (xBegin > xEnd)
+				std::swap(xBegin, xEnd);
+			mask.SetSpan(y, xBegin, xEnd);
+			for (int x = std::max(xBegin, 0); x < std::min(xEnd, width); ++x)
+				ref[x + y * width] = true;
+		}
+		size_t refCount = 0;
+		bool bSame = true;
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+			{
+				bSame = bSame && (mask.Get(x, y) == ref[x + y * width]);
+				refCount += ref[x + y * width] ? 1 : 0;
+			}
+		CHECK(bSame);
+		CHECK(mask.CountSetCells() == refCount);
+		CHECK(mask.GetValidMask(4) == (TiledBitmask::Word(1) << 44) - 1);
+
+		mask.Resize(width, height);
+		CHECK(mask.CountSetCells() == 0);
+	}
+
+	SECTION("Rasterization")
+	{
+		// 100x100 square in a 120x120 map, cells of 1x1
+		OcclusionMap map(MakeBox(60.), 120, 120);
+		PolygonCurve const square({ { -50., -50., 0. }, { 50., -50., 0. }, { 50., 50., 0. }, { -50., 50., 0. } });
+		BuildInteriorMap(map, square);
+		CHECK(map.GetInsideCells().CountSetCells() == 100 * 100);
+		CHECK(!map.IsConstant());
+		CHECK(std::abs(map.ComputeMeanValue() - (100. * 100.) / (120. * 120.)) < 1e-9);
+		CHECK(map.EvaluateValueAt(0., 0., -1) == 1.);
+		CHECK(map.EvaluateValueAt(-59., 59., -1) == 0.);
+		CHECK(map.GetValueAtCell(0) == 0.);
+		CHECK(map.GetValueAtCell(60 + 60 * 120) == 1.);
+
+		std::vector<glm::dvec3> positions;
+		CHECK(map.GetSampledPositions(positions, true, 0) == 100 * 100);
+		bool bAllInside = true;
+		for (auto const& pos : positions)
+			bAllInside = bAllInside && std::abs(pos.x) < 50. && std::abs(pos.y) < 50.;
+		CHECK(bAllInside);
+	}
+
+	SECTION("Deterministic sampling")
+	{
+		OcclusionMap map(MakeBox(300.), 400, 400);
+		PolygonCurve const disk(MakeDisk(64, 280.));
+		BuildInteriorMap(map, disk);
+		std::vector<glm::dvec3> positions, positions2;
+		map.GetSampledPositions(positions, false, 1234);
+		CHECK(positions.size() > map.GetInsideCells().CountSetCells() / 2);
+		CHECK(positions.size() <= map.GetInsideCells().CountSetCells());
+		for (int i = 0; i < 3; ++i)
+		{
+			map.GetSampledPositions(positions2, false, 1234);
+			CHECK(positions2 == positions);
+		}
+		map.GetSampledPositions(positions2, false, 4321);
+		CHECK(positions2 != positions);
+	}
+}
+
+// Hidden by default, run with: BeUtils_UnitTests "[benchmark]"
+TEST_CASE("TestOcclusionMapBenchmark", "[.][benchmark]")
+{
+	// 1 km² forest, cells of 1 m²
+	PolygonCurve const disk(MakeDisk(256, 564.));
+	OcclusionMap map(MakeBox(600.), 1200, 1200);
+	std::vector<glm::dvec3> positions;
+	BENCHMARK("BuildFrom2DPattern 1km2")
+	{
+		BuildInteriorMap(map, disk);
+		return map.GetInsideCells().CountSetCells();
+	};
+	BENCHMARK("GetSampledPositions 1km2")
+	{
+		return map.GetSampledPositions(positions, false, 0xbac1981);
+	};
+	BENCHMARK("GetSampledPositions aligned 1km2")
+	{
+		return map.GetSampledPositions(positions, true, 0xbac1981);
+	};
+}
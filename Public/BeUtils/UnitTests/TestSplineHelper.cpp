@@ -0,0 +1,311 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestSplineHelper.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/SplineSampling/SplineHelper.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace
+{
+	using BeUtils::SplineHelper;
+	using BeUtils::ArcLengthTable;
+	using BeUtils::TransformHolder;
+	using BeUtils::E2DProjection;
+
+	//! Catmull-Rom spline, whose spans share the abscissa range evenly like Unreal splines evaluated by time.
+	class CatmullRomCurve : public BeUtils::SplineCurve
+	{
+	public:
+		CatmullRomCurve(std::vector<glm::dvec3> const& points, bool bCyclic)
+			: points_(points), bCyclic_(bCyclic)
+		{
+		}
+
+		glm::dvec3 GetPositionAtCoord(double const& u) const override
+		{
+			auto const [p, t] = GetSpan(u);
+			double const t2 = t * t, t3 = t2 * t;
+			return 0.5 * ((2. * p[1]) + (p[2] - p[0]) * t + (2. * p[0] - 5. * p[1] + 4. * p[2] - p[3]) * t2
+				+ (3. * p[1] - p[0] - 3. * p[2] + p[3]) * t3);
+		}
+
+		glm::dvec3 GetTangentAtCoord(double const& u) const override
+		{
+			auto const [p, t] = GetSpan(u);
+			return 0.5 * ((p[2] - p[0]) + 2. * (2. * p[0] - 5. * p[1] + 4. * p[2] - p[3]) * t
+				+ 3. * (3. * p[1] - p[0] - 3. * p[2] + p[3]) * t * t);
+		}
+
+		bool IsCyclic() const override { return bCyclic_; }
+
+		size_t PointCount(const bool accountForCyclicity) const override
+		{
+			return points_.size() + ((accountForCyclicity && bCyclic_) ? 1 : 0);
+		}
+
+		glm::dvec3 GetPositionAtIndex(size_t idx) const override { return points_[idx]; }
+
+		void MovePoint(size_t idx, glm::dvec3 const& pos) { points_[idx] = pos; }
+
+	private:
+		std::pair<std::array<glm::dvec3, 4>, double> GetSpan(double u) const
+		{
+			std::ptrdiff_t const n = (std::ptrdiff_t)points_.size();
+			std::ptrdiff_t const spanCount = bCyclic_ ? n : n - 1;
+			double const s = std::clamp(u, 0., 1.) * spanCount;
+			std::ptrdiff_t const span = std::min((std::ptrdiff_t)s, spanCount - 1);
+			std::array<glm::dvec3, 4> p;
+			for (std::ptrdiff_t k = 0; k < 4; ++k)
+			{
+				std::ptrdiff_t i = span + k - 1;
+				i = bCyclic_ ? ((i % n) + n) % n : std::clamp<std::ptrdiff_t>(i, 0, n - 1);
+				p[k] = points_[i];
+			}
+			return { p, s - span };
+		}
+
+		std::vector<glm::dvec3> points_;
+		bool const bCyclic_;
+	};
+
+	std::vector<glm::dvec3> MakeCircle(size_t pointCount, double radius)
+	{
+		std::vector<glm::dvec3> points(pointCount);
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			double const angle = 2. * std::numbers::pi * i / pointCount;
+			points[i] = glm::dvec3(radius * std::cos(angle), radius * std::sin(angle), 0.);
+		}
+		return points;
+	}
+
+	//! Road-like curve: irregular spacing between control points, and some elevation.
+	std::vector<glm::dvec3> MakeRoad(size_t pointCount)
+	{
+		std::vector<glm::dvec3> points(pointCount);
+		double x = 0.;
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			x += 10. + 40. * (i % 3);
+			points[i] = glm::dvec3(x, 30. * std::sin(0.7 * i), 2. * (i % 5));
+		}
+		return points;
+	}
+
+	bool IsSameTable(ArcLengthTable const& lhs, ArcLengthTable const& rhs)
+	{
+		if (lhs.GetLength() != rhs.GetLength())
+			return false;
+		for (int i = 0; i <= 100; ++i)
+		{
+			double const length = lhs.GetLength() * i / 100.;
+			if (lhs.GetCoordAtLength(length) != rhs.GetCoordAtLength(length))
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST_CASE("TestSplineHelper")
+{
+	TransformHolder const identity;
+
+	SECTION("Arc length")
+	{
+		double const radius = 100.;
+		CatmullRomCurve const circle(MakeCircle(16, radius), true);
+		SplineHelper const helper(&circle);
+		ArcLengthTable const& table = helper.GetArcLengthTable(identity);
+		CHECK(std::abs(table.GetLength() - 2. * std::numbers::pi * radius) < 0.01 * radius);
+		// Symmetric curve: half of the length is reached halfway
+		CHECK(std::abs(table.GetCoordAtLength(0.5 * table.GetLength()) - 0.5) < 1e-9);
+		CHECK(table.GetCoordAtLength(-1.) == 0.);
+		CHECK(table.GetCoordAtLength(2. * table.GetLength()) == 1.);
+		// Same table for the same parameters
+		CHECK(&helper.GetArcLengthTable(identity) == &table);
+
+		// Projection
+		TransformHolder vertical;
+		vertical.transfrom_ = glm::dmat3x3(glm::dvec3(0., 0., 1.), glm::dvec3(0., 1., 0.), glm::dvec3(1., 0., 0.));
+		vertical.pos_ = glm::dvec3(10., 20., 30.);
+		CHECK(std::abs(helper.GetArcLengthTable(vertical, E2DProjection::Z_Axis).GetLength() - 4. * radius)
+			< 0.01 * radius);
+	}
+
+	SECTION("Inversion")
+	{
+		CatmullRomCurve const road(MakeRoad(12), false);
+		SplineHelper const helper(&road);
+		ArcLengthTable const& table = helper.GetArcLengthTable(identity);
+		std::vector<double> lengths;
+		for (int i = 0; i <= 1000; ++i)
+			lengths.push_back(table.GetLength() * i / 1000.);
+		std::vector<double> coords(lengths.size());
+		table.GetCoordsAtLengths(lengths, coords);
+		for (size_t i = 0; i < lengths.size(); ++i)
+		{
+			CHECK(coords[i] == table.GetCoordAtLength(lengths[i]));
+			if (i > 0)
+				CHECK(coords[i] >= coords[i - 1]);
+		}
+		// Unsorted batch
+		std::swap(lengths.front(), lengths.back());
+		table.GetCoordsAtLengths(lengths, coords);
+		CHECK(coords.front() == 1.);
+		CHECK(coords.back() == 0.);
+	}
+
+	SECTION("Regular samples")
+	{
+		CatmullRomCurve const road(MakeRoad(12), false);
+		SplineHelper const helper(&road);
+		std::vector<SplineHelper::vector_type> samples;
+		REQUIRE(helper.GetRegularSamples(samples, SplineHelper::EPathRegularSamplingMode::FixedNbSamples,
+			size_t(50), identity) == 50);
+		CHECK(samples.front() == road.GetPositionAtCoord(0.));
+		CHECK(glm::distance(samples.back(), road.GetPositionAtCoord(1.)) < 1e-6);
+		// Samples are evaluated at the abscissas given by the arc-length table...
+		ArcLengthTable const& table = helper.GetArcLengthTable(identity);
+		double const spacing = table.GetLength() / 49.;
+		std::vector<double> coords(samples.size());
+		for (size_t i = 0; i < samples.size(); ++i)
+			coords[i] = table.GetCoordAtLength(i * spacing);
+		for (size_t i = 1; i < samples.size(); ++i)
+		{
+			CHECK(samples[i] == road.GetPositionAtCoord(coords[i]));
+			// ...which matches the length along the curve, measured with a much finer sampling
+			double fineLength = 0.;
+			int const fineSampleCount = 2000;
+			for (int k = 0; k < fineSampleCount; ++k)
+			{
+				double const u0 = coords[i - 1] + (coords[i] - coords[i - 1]) * k / fineSampleCount;
+				double const u1 = coords[i - 1] + (coords[i] - coords[i - 1]) * (k + 1) / fineSampleCount;
+				fineLength += glm::distance(road.GetPositionAtCoord(u0), road.GetPositionAtCoord(u1));
+			}
+			CHECK(std::abs(fineLength - spacing) < 1e-2 * spacing);
+		}
+
+		REQUIRE(helper.GetRegularSamples(samples, SplineHelper::EPathRegularSamplingMode::FixedSpacing,
+			10., identity, E2DProjection::Z_Axis) > 1);
+		for (auto const& sample : samples)
+			CHECK(sample.z == 0.);
+	}
+
+	SECTION("Batch evaluation")
+	{
+		CatmullRomCurve const road(MakeRoad(6), false);
+		SplineHelper const helper(&road);
+		TransformHolder transform;
+		transform.transfrom_ = glm::dmat3x3(2.);
+		transform.pos_ = glm::dvec3(1., 2., 3.);
+		std::vector<double> const coords = { 0., 0.1, 0.33, 0.5, 0.99, 1. };
+		std::vector<SplineHelper::vector_type> positions, tangents;
+		helper.GetPositionsAndTangents_world(coords, transform, positions, &tangents);
+		REQUIRE(positions.size() == coords.size());
+		REQUIRE(tangents.size() == coords.size());
+		for (size_t i = 0; i < coords.size(); ++i)
+		{
+			CHECK(positions[i] == helper.GetPosition_world(coords[i], transform));
+			CHECK(tangents[i] == transform.transfrom_ * helper.GetTangentAtCoord(coords[i]));
+		}
+	}
+
+	SECTION("Incremental update")
+	{
+		for (bool const bCyclic : { false, true })
+		{
+			CatmullRomCurve road(MakeRoad(10), bCyclic);
+			SplineHelper helper(&road);
+			for (size_t const movedPoint : { size_t(0), size_t(1), size_t(5), size_t(8), size_t(9) })
+			{
+				helper.GetArcLengthTable(identity);
+				helper.GetArcLengthTable(identity, E2DProjection::Z_Axis);
+				road.MovePoint(movedPoint, road.GetPositionAtIndex(movedPoint) + glm::dvec3(15., -20., 5.));
+				helper.OnControlPointMoved(movedPoint);
+
+				SplineHelper const rebuilt(&road);
+				CHECK(IsSameTable(helper.GetArcLengthTable(identity), rebuilt.GetArcLengthTable(identity)));
+				CHECK(IsSameTable(helper.GetArcLengthTable(identity, E2DProjection::Z_Axis),
+					rebuilt.GetArcLengthTable(identity, E2DProjection::Z_Axis)));
+			}
+		}
+	}
+
+	SECTION("Closed loop")
+	{
+		for (size_t const pointCount : { size_t(3), size_t(4), size_t(5) })
+		{
+			// The closing span is part of the table: the loop is longer than the open curve.
+			CatmullRomCurve const open(MakeRoad(pointCount), false);
+			CatmullRomCurve loop(MakeRoad(pointCount), true);
+			CHECK(SplineHelper(&loop).GetArcLengthTable(identity).GetLength()
+				> SplineHelper(&open).GetArcLengthTable(identity).GetLength());
+
+			SplineHelper helper(&loop);
+			for (size_t const movedPoint : { size_t(0), pointCount / 2, pointCount - 1 })
+			{
+				helper.GetArcLengthTable(identity);
+				loop.MovePoint(movedPoint, loop.GetPositionAtIndex(movedPoint) + glm::dvec3(-25., 10., 3.));
+				helper.OnControlPointMoved(movedPoint);
+
+				SplineHelper const rebuilt(&loop);
+				CHECK(IsSameTable(helper.GetArcLengthTable(identity), rebuilt.GetArcLengthTable(identity)));
+			}
+		}
+	}
+
+	SECTION("Segments cache")
+	{
+		BeUtils::CachedSegmentsContainer cache;
+		BeUtils::BoundingBox bbox;
+		std::vector<BeUtils::Segment_2D> segments;
+		for (double const dU : { 0.1, 0.01, 0.05, 0.2 })
+		{
+			segments.assign(1, BeUtils::Segment_2D({ 0., 0. }, { dU, 0. }));
+			CHECK(cache.RecordSegments(segments, bbox, E2DProjection::Z_Axis, dU));
+		}
+		for (double const dU : { 0.2, 0.01, 0.1, 0.05 })
+		{
+			REQUIRE(cache.RetrieveSegments(segments, bbox, E2DProjection::Z_Axis, dU + 1e-10));
+			CHECK(segments.front().posEnd_.x == dU);
+		}
+		CHECK(!cache.RetrieveSegments(segments, bbox, E2DProjection::Z_Axis, 0.02));
+		CHECK(!cache.RetrieveSegments(segments, bbox, E2DProjection::X_Axis, 0.1));
+		CHECK(!cache.RetrieveSegments(segments, bbox, E2DProjection::Z_Axis, 0.3));
+	}
+}
+
+// Hidden by default, run with: BeUtils_UnitTests "[benchmark]"
+TEST_CASE("TestSplineHelperBenchmark", "[.][benchmark]")
+{
+	TransformHolder const identity;
+	CatmullRomCurve road(MakeRoad(200), false);
+	SplineHelper helper(&road);
+	std::vector<SplineHelper::vector_type> samples;
+	BENCHMARK("GetRegularSamples 2000")
+	{
+		return helper.GetRegularSamples(samples, SplineHelper::EPathRegularSamplingMode::FixedNbSamples,
+			size_t(2000), identity);
+	};
+	BENCHMARK("Move a control point")
+	{
+		road.MovePoint(100, road.GetPositionAtIndex(100) + glm::dvec3(0., 1., 0.));
+		helper.OnControlPointMoved(100);
+		return helper.GetArcLengthTable(identity).GetLength();
+	};
+	BENCHMARK("Rebuild after moving a control point")
+	{
+		road.MovePoint(100, road.GetPositionAtIndex(100) + glm::dvec3(0., 1., 0.));
+		helper.InvalidateCache();
+		return helper.GetArcLengthTable(identity).GetLength();
+	};
+}
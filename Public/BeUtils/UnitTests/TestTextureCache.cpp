@@ -0,0 +1,78 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TestTextureCache.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <catch2/catch_all.hpp>
+#include <BeUtils/Gltf/TextureCache.h>
+#include <filesystem>
+
+TEST_CASE("TestTextureCache")
+{
+	using BeUtils::TextureCache;
+
+	auto const cacheDir = std::filesystem::path(BEUTILS_WORK_DIR) / "TestTextureCache";
+	std::filesystem::remove_all(cacheDir);
+
+	auto const makeKey = [](int i) { return TextureCache::KeyBuilder().Add("test").Add(i).Get(); };
+	CHECK(makeKey(1) != makeKey(2));
+	CHECK(TextureCache::KeyBuilder().Add("ab").Add("c").Get() != TextureCache::KeyBuilder().Add("a").Add("bc").Get());
+
+	std::vector<std::byte> const content(1000, std::byte(42));
+	std::vector<std::filesystem::path> filePaths;
+	auto const checkEvicted = [&](std::initializer_list<int> indices, TextureCache& cache)
+	{
+		for (int i : indices)
+		{
+			CHECK(!cache.Find(makeKey(i)));
+			CHECK(!std::filesystem::exists(filePaths[i]));
+		}
+	};
+	{
+		TextureCache cache(cacheDir, 4500);
+		for (int i = 0; i < 4; ++i)
+		{
+			auto const filePath = cache.Store(makeKey(i), content, uint32_t(i));
+			REQUIRE(filePath);
+			CHECK(std::filesystem::file_size(*filePath) == content.size());
+			filePaths.push_back(*filePath);
+		}
+		CHECK(cache.GetTotalBytes() == 4000);
+		REQUIRE(cache.Find(makeKey(0)));
+		// The least recently used entries are evicted, down to 7/8 of the budget.
+		filePaths.push_back(cache.Store(makeKey(4), content).value());
+		CHECK(cache.GetEntryCount() == 3);
+		CHECK(cache.GetTotalBytes() == 3000);
+		checkEvicted({ 1, 2 }, cache);
+	}
+	{
+		// Entries are listed in the index file written by the previous session.
+		TextureCache cache(cacheDir, 4500);
+		CHECK(cache.GetEntryCount() == 3);
+		CHECK(cache.GetTotalBytes() == 3000);
+		auto const entry = cache.Find(makeKey(3));
+		REQUIRE(entry);
+		CHECK(entry->flags == 3);
+		CHECK(std::filesystem::exists(entry->filePath));
+		CHECK(!cache.Find(makeKey(7)));
+
+		// Last uses are kept from one session to the next.
+		filePaths.push_back(cache.Store(makeKey(5), content).value());
+		filePaths.push_back(cache.Store(makeKey(6), content).value());
+		CHECK(cache.GetEntryCount() == 3);
+		CHECK(cache.GetTotalBytes() == 3000);
+		checkEvicted({ 0, 4 }, cache);
+
+		// New and evicted entries are appended to the index without waiting for Flush.
+		TextureCache other(cacheDir, 4500);
+		CHECK(other.GetEntryCount() == 3);
+		CHECK(other.GetTotalBytes() == 3000);
+		for (int i : { 3, 5, 6 })
+		{
+			CHECK(other.Find(makeKey(i)));
+		}
+	}
+}
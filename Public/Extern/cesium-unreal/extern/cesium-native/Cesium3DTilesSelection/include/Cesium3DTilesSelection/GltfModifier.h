@@ -3,14 +3,21 @@
 #include <Cesium3DTilesSelection/GltfModifierState.h>
 #include <Cesium3DTilesSelection/Tile.h>
 #include <Cesium3DTilesSelection/TileLoadRequester.h>
+#include <Cesium3DTilesSelection/TileLoadTask.h>
 #include <CesiumAsync/AsyncSystem.h>
 #include <CesiumAsync/Future.h>
 #include <CesiumGltf/Model.h>
 
 #include <spdlog/fwd.h>
 
+#include <chrono>
+#include <cstddef>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace CesiumAsync {
 
@@ -95,11 +102,48 @@ struct GltfModifierOutput {
  * A just-constructed modifier is considered nilpotent, meaning nothing will
  * happen until @ref trigger has been called at least once.
  *
+ * Already-loaded tiles are modified in the order of their current load
+ * priority, as computed by the {@link TilesetViewGroup} instances: tiles in
+ * view are modified first, then the tiles that are not visited anymore.
+ *
  * The @ref apply function is called from a worker thread. All other methods
  * must only be called from the main thread.
  */
 class GltfModifier : private TileLoadRequester {
 public:
+  /**
+   * @brief Statistics about the modification of the already-loaded tiles,
+   * since the last call to @ref trigger.
+   */
+  struct Statistics {
+    /**
+     * @brief The number of tiles waiting to be modified in a worker thread.
+     */
+    size_t tilesQueued = 0;
+
+    /**
+     * @brief The number of tiles modified in a worker thread since the last
+     * call to @ref trigger.
+     */
+    size_t tilesModified = 0;
+
+    /**
+     * @brief The time, in seconds, between the last call to @ref trigger and
+     * the end of the first tile modification, or `std::nullopt` if no tile
+     * has been modified yet.
+     */
+    std::optional<double> timeToFirstModification;
+
+    /**
+     * @brief The time, in seconds, between the last call to @ref trigger and
+     * the end of the modification of the first tile needed by a view (i.e.
+     * loaded with a {@link TileLoadPriorityGroup::Normal} or
+     * {@link TileLoadPriorityGroup::Urgent} priority), or `std::nullopt` if no
+     * such tile has been modified yet.
+     */
+    std::optional<double> timeToFirstVisibleModification;
+  };
+
   /**
    * @brief Gets the current version number, or `std::nullopt` if the
    * `GltfModifier` is currently inactive.
@@ -132,6 +176,27 @@ public:
    */
   void trigger();
 
+  /**
+   * @brief Gets the statistics about the modification of the already-loaded
+   * tiles since the last call to @ref trigger.
+   */
+  Statistics getStatistics() const;
+
+  /**
+   * @brief Sets the maximum number of already-loaded tiles for which a
+   * modification can be started in a worker thread in a single frame.
+   *
+   * Limiting it leaves room for loading new tiles when many tiles need to be
+   * modified. There is no limit by default.
+   */
+  void setMaximumModificationsPerFrame(size_t maximum) noexcept;
+
+  /**
+   * @brief Gets the maximum number of already-loaded tiles for which a
+   * modification can be started in a worker thread in a single frame.
+   */
+  size_t getMaximumModificationsPerFrame() const noexcept;
+
   /**
    * @brief Implement this method to apply custom modification to a glTF model.
    * It is called by the @ref Tileset from within a worker thread.
@@ -260,6 +325,25 @@ private:
    */
   bool canRecomputeUpsampledTile(const Tile& tile) const;
 
+  /**
+   * @private
+   *
+   * @brief Called by {@link TilesetViewGroup} when it adds a tile to its
+   * worker thread load queue, to record the current load priority of the tile.
+   *
+   * @param task The load task of the tile.
+   */
+  void onTileLoadTask(const TileLoadTask& task);
+
+  /**
+   * @private
+   *
+   * @brief Called by @ref Tileset once per frame, before the worker thread
+   * load requests are processed. The tiles to modify are then sorted by their
+   * last known load priority.
+   */
+  void onStartWorkerThreadLoadRequests();
+
   // TileLoadRequester implementation
   double getWeight() const override;
   bool hasMoreTilesToLoadInWorkerThread() const override;
@@ -276,7 +360,24 @@ private:
   std::vector<Tile::ConstPointer> _workerThreadQueue;
   std::vector<Tile::ConstPointer> _mainThreadQueue;
 
+  struct TilePriority {
+    TileLoadPriorityGroup group;
+    double priority;
+  };
+  // Priorities of the tiles visited since the worker thread queue was last
+  // sorted.
+  std::unordered_map<const Tile*, TilePriority> _tilePriorities;
+  size_t _maximumModificationsPerFrame = std::numeric_limits<size_t>::max();
+  size_t _modificationsThisFrame = 0;
+
+  Statistics _statistics;
+  std::chrono::steady_clock::time_point _triggerTime;
+  // Tiles needed by a view since the last trigger, until one of them has been
+  // modified.
+  std::unordered_set<const Tile*> _visibleTiles;
+
   friend class TilesetContentManager;
+  friend class TilesetViewGroup;
   friend class MockTilesetContentManagerForGltfModifier;
 };
 
@@ -15,9 +15,14 @@
 
 #include <spdlog/logger.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 namespace Cesium3DTilesSelection {
@@ -26,7 +31,11 @@ GltfModifier::GltfModifier()
     : _currentVersion(),
       _pRootTile(nullptr),
       _workerThreadQueue(),
-      _mainThreadQueue(){};
+      _mainThreadQueue(),
+      _tilePriorities(),
+      _statistics(),
+      _triggerTime(),
+      _visibleTiles(){};
 
 GltfModifier::~GltfModifier() = default;
 
@@ -45,6 +54,10 @@ void GltfModifier::trigger() {
     ++(*this->_currentVersion);
   }
 
+  this->_statistics = Statistics();
+  this->_triggerTime = std::chrono::steady_clock::now();
+  this->_visibleTiles.clear();
+
   if (!this->isRegistered()) {
     return;
   }
@@ -60,6 +73,20 @@ void GltfModifier::trigger() {
   }
 }
 
+GltfModifier::Statistics GltfModifier::getStatistics() const {
+  Statistics statistics = this->_statistics;
+  statistics.tilesQueued = this->_workerThreadQueue.size();
+  return statistics;
+}
+
+void GltfModifier::setMaximumModificationsPerFrame(size_t maximum) noexcept {
+  this->_maximumModificationsPerFrame = maximum;
+}
+
+size_t GltfModifier::getMaximumModificationsPerFrame() const noexcept {
+  return this->_maximumModificationsPerFrame;
+}
+
 bool GltfModifier::canRecomputeUpsampledTile(const Tile& tile) const {
   std::optional<int64_t> modelVersion = this->getCurrentVersion();
   if (!modelVersion)
@@ -211,6 +238,8 @@ void GltfModifier::onUnregister(TilesetContentManager& /* contentManager */) {
   this->unregister();
   this->_mainThreadQueue.clear();
   this->_workerThreadQueue.clear();
+  this->_tilePriorities.clear();
+  this->_visibleTiles.clear();
 }
 
 CesiumAsync::Future<void> GltfModifier::onRegister(
@@ -237,7 +266,81 @@ void GltfModifier::onOldVersionContentLoadingComplete(const Tile& tile) {
   }
 }
 
+void GltfModifier::onTileLoadTask(const TileLoadTask& task) {
+  if (!this->isActive() || this->_workerThreadQueue.empty())
+    return;
+
+  // Keep the highest priority if the tile is needed by several view groups.
+  const TilePriority priority{task.group, task.priority};
+  auto [it, inserted] = this->_tilePriorities.try_emplace(task.pTile, priority);
+  if (!inserted && (it->second.group < priority.group ||
+                    (it->second.group == priority.group &&
+                     it->second.priority > priority.priority))) {
+    it->second = priority;
+  }
+
+  if (task.group != TileLoadPriorityGroup::Preload &&
+      !this->_statistics.timeToFirstVisibleModification) {
+    this->_visibleTiles.insert(task.pTile);
+  }
+}
+
+void GltfModifier::onStartWorkerThreadLoadRequests() {
+  this->_modificationsThisFrame = 0;
+  if (this->_tilePriorities.empty())
+    return;
+
+  // Sort the queue so that the highest priority tiles are at the back, like in
+  // TilesetViewGroup. Tiles which were not visited keep their relative order,
+  // after all the visited tiles. Tiles which do not need modification anymore
+  // (because they were already modified through a view group's queue) are
+  // removed.
+  std::vector<std::pair<TilePriority, Tile::ConstPointer>> sorted;
+  sorted.reserve(this->_workerThreadQueue.size());
+  for (Tile::ConstPointer& pTile : this->_workerThreadQueue) {
+    if (!this->needsWorkerThreadModification(*pTile))
+      continue;
+    auto it = this->_tilePriorities.find(pTile.get());
+    const TilePriority priority =
+        it == this->_tilePriorities.end()
+            ? TilePriority{
+                  TileLoadPriorityGroup::Preload,
+                  std::numeric_limits<double>::max()}
+            : it->second;
+    sorted.emplace_back(priority, std::move(pTile));
+  }
+  std::stable_sort(
+      sorted.begin(),
+      sorted.end(),
+      [](const auto& lhs, const auto& rhs) {
+        if (lhs.first.group == rhs.first.group)
+          return lhs.first.priority > rhs.first.priority;
+        else
+          return lhs.first.group < rhs.first.group;
+      });
+
+  this->_workerThreadQueue.clear();
+  for (auto& entry : sorted) {
+    this->_workerThreadQueue.emplace_back(std::move(entry.second));
+  }
+  this->_tilePriorities.clear();
+}
+
 void GltfModifier::onWorkerThreadApplyComplete(const Tile& tile) {
+  ++this->_statistics.tilesModified;
+  const double elapsed = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() -
+                             this->_triggerTime)
+                             .count();
+  if (!this->_statistics.timeToFirstModification) {
+    this->_statistics.timeToFirstModification = elapsed;
+  }
+  if (!this->_statistics.timeToFirstVisibleModification &&
+      this->_visibleTiles.contains(&tile)) {
+    this->_statistics.timeToFirstVisibleModification = elapsed;
+    this->_visibleTiles.clear();
+  }
+
   // GltfModifier::apply just finished, so now we need to do the main-thread
   // processing of the new version. But if the new version is already outdated,
   // we need to do worker thread modification (again) instead of main thread
@@ -254,13 +357,15 @@ void GltfModifier::onWorkerThreadApplyComplete(const Tile& tile) {
 double GltfModifier::getWeight() const { return 0.5; }
 
 bool GltfModifier::hasMoreTilesToLoadInWorkerThread() const {
-  return !this->_workerThreadQueue.empty();
+  return !this->_workerThreadQueue.empty() &&
+         this->_modificationsThisFrame < this->_maximumModificationsPerFrame;
 }
 
 const Tile* GltfModifier::getNextTileToLoadInWorkerThread() {
   CESIUM_ASSERT(!this->_workerThreadQueue.empty());
   const Tile* pResult = this->_workerThreadQueue.back().get();
   this->_workerThreadQueue.pop_back();
+  ++this->_modificationsThisFrame;
   return pResult;
 }
 
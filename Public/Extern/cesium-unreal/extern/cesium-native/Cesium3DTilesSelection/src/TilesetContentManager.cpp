@@ -2024,6 +2024,10 @@ void TilesetContentManager::processWorkerThreadLoadRequests(
     return;
   }
 
+  if (this->_externals.pGltfModifier) {
+    this->_externals.pGltfModifier->onStartWorkerThreadLoadRequests();
+  }
+
   WeightedRoundRobin wrr{
       this->_roundRobinValueWorker,
       this->_requesters,
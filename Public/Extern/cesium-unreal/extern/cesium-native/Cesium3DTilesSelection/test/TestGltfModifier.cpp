@@ -7,6 +7,7 @@
 #include <Cesium3DTilesSelection/Tile.h>
 #include <Cesium3DTilesSelection/TileContent.h>
 #include <Cesium3DTilesSelection/TileLoadRequester.h>
+#include <Cesium3DTilesSelection/TileLoadTask.h>
 #include <CesiumGeometry/BoundingSphere.h>
 #include <CesiumGltf/Model.h>
 #include <CesiumNativeTests/SimpleAssetAccessor.h>
@@ -40,6 +41,15 @@ public:
     modifier.onOldVersionContentLoadingComplete(tile);
   }
 
+  static void
+  onTileLoadTask(GltfModifier& modifier, const TileLoadTask& task) {
+    modifier.onTileLoadTask(task);
+  }
+
+  static void onStartWorkerThreadLoadRequests(GltfModifier& modifier) {
+    modifier.onStartWorkerThreadLoadRequests();
+  }
+
   static void
   onUnregister(GltfModifier& modifier, TilesetContentManager& contentManager) {
     return modifier.onUnregister(contentManager);
@@ -156,6 +166,71 @@ TEST_CASE("GltfModifier") {
     }
   }
 
+  SUBCASE("orders worker thread modifications by tile load priority") {
+    TileLoadRequester* pRequester =
+        MockTilesetContentManagerForGltfModifier::getTileLoadRequester(
+            *pModifier);
+
+    REQUIRE(pTile->getChildren().size() >= 2);
+    Tile* pChild0 = &pTile->getChildren()[0];
+    Tile* pChild1 = &pTile->getChildren()[1];
+    for (Tile* pChild : {pChild0, pChild1}) {
+      MockTilesetContentManagerTestFixture::setTileLoadState(
+          *pChild,
+          TileLoadState::ContentLoaded);
+      TileContent childContent;
+      childContent.setContentKind(
+          std::make_unique<TileRenderContent>(CesiumGltf::Model{}));
+      MockTilesetContentManagerTestFixture::setTileContent(
+          *pChild,
+          std::move(childContent));
+      pChild->addReference();
+      pTile->addReference();
+    }
+
+    pModifier->trigger();
+    CHECK(pModifier->getStatistics().tilesQueued == 3);
+
+    // The first child is urgent, the root is needed by the view, the second
+    // child was not visited.
+    MockTilesetContentManagerForGltfModifier::onTileLoadTask(
+        *pModifier,
+        TileLoadTask{pTile, TileLoadPriorityGroup::Normal, 2.0});
+    MockTilesetContentManagerForGltfModifier::onTileLoadTask(
+        *pModifier,
+        TileLoadTask{pChild0, TileLoadPriorityGroup::Urgent, 5.0});
+    // A lower value means a higher priority.
+    MockTilesetContentManagerForGltfModifier::onTileLoadTask(
+        *pModifier,
+        TileLoadTask{pTile, TileLoadPriorityGroup::Normal, 1.0});
+    MockTilesetContentManagerForGltfModifier::onStartWorkerThreadLoadRequests(
+        *pModifier);
+
+    REQUIRE(pRequester->hasMoreTilesToLoadInWorkerThread());
+    CHECK(pRequester->getNextTileToLoadInWorkerThread() == pChild0);
+    REQUIRE(pRequester->hasMoreTilesToLoadInWorkerThread());
+    CHECK(pRequester->getNextTileToLoadInWorkerThread() == pTile);
+    REQUIRE(pRequester->hasMoreTilesToLoadInWorkerThread());
+    CHECK(pRequester->getNextTileToLoadInWorkerThread() == pChild1);
+    CHECK_FALSE(pRequester->hasMoreTilesToLoadInWorkerThread());
+
+    SUBCASE("limits the modifications per frame") {
+      pModifier->setMaximumModificationsPerFrame(1);
+      pModifier->trigger();
+      MockTilesetContentManagerForGltfModifier::onStartWorkerThreadLoadRequests(
+          *pModifier);
+      REQUIRE(pRequester->hasMoreTilesToLoadInWorkerThread());
+      pRequester->getNextTileToLoadInWorkerThread();
+      CHECK_FALSE(pRequester->hasMoreTilesToLoadInWorkerThread());
+
+      // Next frame.
+      MockTilesetContentManagerForGltfModifier::onStartWorkerThreadLoadRequests(
+          *pModifier);
+      CHECK(pRequester->hasMoreTilesToLoadInWorkerThread());
+      CHECK(pModifier->getStatistics().tilesQueued == 2);
+    }
+  }
+
   SUBCASE("clears load queues on unregister") {
     const TileLoadRequester* pRequester =
         MockTilesetContentManagerForGltfModifier::getTileLoadRequester(
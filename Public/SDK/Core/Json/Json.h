@@ -10,6 +10,7 @@
 #include <rfl/json.hpp>
 #include <rfl.hpp>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <filesystem>
 #include "../Tools/Assert.h"
@@ -64,8 +65,9 @@ namespace AdvViz::SDK::Json {
 			return false;
 		}
 	}
+	/// Same as FromString, for Json text which is not held by a std::string (eg. a memory-mapped file).
 	template<typename Type>
-	inline bool FromStream(Type& t, const std::string& s, std::string& parseError, bool bLogParseError = true) {
+	inline bool FromStringView(Type& t, std::string_view s, std::string& parseError, bool bLogParseError = true) {
 		auto result = rfl::json::read<Type>(s);
 		if (result.has_value())
 		{
@@ -92,6 +94,11 @@ namespace AdvViz::SDK::Json {
 		}
 	}
 
+	template<typename Type>
+	inline bool FromStream(Type& t, const std::string& s, std::string& parseError, bool bLogParseError = true) {
+		return FromStringView(t, std::string_view(s), parseError, bLogParseError);
+	}
+
 	template<typename Type>
 	inline bool FromString(Type& t, const std::string& s,
 						   std::string& parseError, bool bLogParseError = true) {
@@ -104,6 +111,177 @@ namespace AdvViz::SDK::Json {
 		return FromString(t, s, parseJsonError, true);
 	}
 
+	namespace ScanImpl
+	{
+		constexpr size_t npos = std::string_view::npos;
+
+		inline size_t SkipWhitespace(std::string_view json, size_t pos)
+		{
+			while (pos < json.size()
+				&& (json[pos] == ' ' || json[pos] == '\n' || json[pos] == '\r' || json[pos] == '\t'))
+			{
+				++pos;
+			}
+			return pos;
+		}
+
+		/// \param pos Position of the opening quote.
+		/// \return Position following the closing quote, or npos.
+		inline size_t SkipString(std::string_view json, size_t pos)
+		{
+			for (++pos; pos < json.size(); ++pos)
+			{
+				if (json[pos] == '\\')
+					++pos;
+				else if (json[pos] == '"')
+					return pos + 1;
+			}
+			return npos;
+		}
+
+		/// \param pos Position of the first character of the value.
+		/// \return Position following the value, or npos if it is truncated.
+		inline size_t SkipValue(std::string_view json, size_t pos)
+		{
+			if (pos >= json.size())
+				return npos;
+			if (json[pos] == '"')
+				return SkipString(json, pos);
+			if (json[pos] == '{' || json[pos] == '[')
+			{
+				int depth = 0;
+				while (pos < json.size())
+				{
+					char const c = json[pos];
+					if (c == '"')
+					{
+						pos = SkipString(json, pos);
+						if (pos == npos)
+							return npos;
+						continue;
+					}
+					if (c == '{' || c == '[')
+						++depth;
+					else if ((c == '}' || c == ']') && --depth == 0)
+						return pos + 1;
+					++pos;
+				}
+				return npos;
+			}
+			// Number, true, false or null
+			size_t const start = pos;
+			while (pos < json.size() && json[pos] != ',' && json[pos] != '}' && json[pos] != ']'
+				&& json[pos] != ' ' && json[pos] != '\n' && json[pos] != '\r' && json[pos] != '\t')
+			{
+				++pos;
+			}
+			return (pos > start) ? pos : npos;
+		}
+	}
+
+	/// Parses a JSON object holding a potentially huge array, without building the DOM of the whole
+	/// document nor the vector of its elements: the elements of the array member named arrayName are parsed
+	/// one by one, and passed to elementFct as they are reached. The other members are then parsed into
+	/// header, where the array member, if declared, is left empty.
+	/// \param elementFct Called with each element (TElement&&), returns false to skip the next ones.
+	/// \return false on a parse error, in which case the elements preceding it may already have been passed
+	///		to elementFct.
+	template<typename THeader, typename TElement, typename TElementFct>
+	inline bool FromStringVisitingArray(THeader& header, std::string_view json, std::string_view arrayName,
+		TElementFct const& elementFct, std::string& parseError, bool bLogParseError = true)
+	{
+		using namespace ScanImpl;
+		auto const onError = [&parseError, bLogParseError](std::string error, size_t pos)
+		{
+			parseError = std::move(error);
+			if (pos != npos)
+				parseError += " at offset " + std::to_string(pos);
+			if (bLogParseError)
+			{
+				BE_LOGE("json", "json parse error:" << parseError);
+			}
+			return false;
+		};
+
+		size_t arrayBegin = npos, arrayEnd = npos;
+		size_t pos = SkipWhitespace(json, 0);
+		if (pos >= json.size() || json[pos] != '{')
+			return onError("expected an object", pos);
+		pos = SkipWhitespace(json, pos + 1);
+		bool bHasMembers = (pos < json.size() && json[pos] != '}');
+		while (bHasMembers)
+		{
+			if (pos >= json.size() || json[pos] != '"')
+				return onError("expected a member name", pos);
+			size_t const nameEnd = SkipString(json, pos);
+			if (nameEnd == npos)
+				return onError("truncated member name", pos);
+			std::string_view const name = json.substr(pos + 1, nameEnd - pos - 2);
+			pos = SkipWhitespace(json, nameEnd);
+			if (pos >= json.size() || json[pos] != ':')
+				return onError("expected ':'", pos);
+			pos = SkipWhitespace(json, pos + 1);
+			if (name == arrayName && arrayBegin == npos && pos < json.size() && json[pos] == '[')
+			{
+				arrayBegin = pos;
+				bool bVisiting = true;
+				pos = SkipWhitespace(json, pos + 1);
+				bool bHasElements = (pos < json.size() && json[pos] != ']');
+				while (bHasElements)
+				{
+					size_t const elementEnd = SkipValue(json, pos);
+					if (elementEnd == npos)
+						return onError("truncated array element", pos);
+					if (bVisiting)
+					{
+						auto element = rfl::json::read<TElement>(json.substr(pos, elementEnd - pos));
+						if (!element.has_value())
+							return onError(element.error().what(), pos);
+						bVisiting = elementFct(std::move(element.value()));
+					}
+					pos = SkipWhitespace(json, elementEnd);
+					if (pos < json.size() && json[pos] == ',')
+						pos = SkipWhitespace(json, pos + 1);
+					else
+						bHasElements = false;
+				}
+				if (pos >= json.size() || json[pos] != ']')
+					return onError("expected ',' or ']'", pos);
+				arrayEnd = ++pos;
+			}
+			else
+			{
+				size_t const valueEnd = SkipValue(json, pos);
+				if (valueEnd == npos)
+					return onError("truncated value", pos);
+				pos = valueEnd;
+			}
+			pos = SkipWhitespace(json, pos);
+			if (pos < json.size() && json[pos] == ',')
+				pos = SkipWhitespace(json, pos + 1);
+			else
+				bHasMembers = false;
+		}
+		if (pos >= json.size() || json[pos] != '}')
+			return onError("expected ',' or '}'", pos);
+
+		std::string headerJson;
+		if (arrayBegin != npos)
+		{
+			headerJson.reserve(json.size() - (arrayEnd - arrayBegin) + 2);
+			headerJson.append(json.substr(0, arrayBegin)).append("[]").append(json.substr(arrayEnd));
+		}
+		else
+		{
+			headerJson = json;
+		}
+		auto result = rfl::json::read<THeader>(headerJson);
+		if (!result.has_value())
+			return onError(result.error().what(), npos);
+		header = std::move(result.value());
+		return true;
+	}
+
 	template<typename Type>
 	inline bool LoadFile(Type& t, const std::filesystem::path& jsonPath, std::string &parseError) {
 		if (!std::filesystem::exists(jsonPath))
@@ -8,8 +8,21 @@
 
 #include "Json.h"
 
+#include <chrono>
+#include <iostream>
+#include <optional>
 #include <variant>
 
+#if defined(_WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
 #include <rfl/json.hpp> //note: we should not include this but compiler error VS 2022 17.9.2: static function 'void yyjson_mut_doc_set_root(yyjson_mut_doc *,yyjson_mut_val *)' declared but not defined
 #include <rfl.hpp>
 
@@ -186,3 +199,151 @@ TEST_CASE(JsonTest, json_fromstring2) {
 	//REQUIRE(homer.age, 45);
 }
 #endif
+
+namespace
+{
+	struct Row
+	{
+		std::string id;
+		std::optional<std::string> name;
+		std::vector<double> matrix;
+	};
+
+	struct Links
+	{
+		std::optional<std::string> next;
+	};
+
+	struct PageHeader
+	{
+		int total_rows = 0;
+		Links _links;
+	};
+
+	struct Page
+	{
+		int total_rows = 0;
+		std::optional<std::vector<Row>> rows;
+		Links _links;
+	};
+
+	std::string MakePage(size_t numRows)
+	{
+		std::string json = "{\"total_rows\":" + std::to_string(numRows) + ",\"rows\":[";
+		for (size_t i = 0; i < numRows; ++i)
+		{
+			if (i > 0)
+				json += ',';
+			json += "{\"id\":\"0x" + std::to_string(i) + "\",\"name\":\"row \\\"" + std::to_string(i)
+				+ "\\\" [a]{b}\",\"matrix\":[1.5,0,0,0,1,0,0,0,1,-2.25,3," + std::to_string(i) + "]}";
+		}
+		return json + "], \"_links\": {\"next\": \"https://host/rows?$skip=1000&$top=1000\"}}";
+	}
+
+	/// Peak memory of the process, in bytes.
+	size_t GetPeakMemory()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.PeakWorkingSetSize;
+		return 0;
+#else
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+		return (size_t)usage.ru_maxrss;
+#else
+		return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+	}
+}
+
+TEST_CASE("JsonTest:FromStringVisitingArray") {
+	std::string const json = MakePage(5);
+	PageHeader header;
+	std::vector<Row> rows;
+	std::string parseError;
+	REQUIRE(AdvViz::SDK::Json::FromStringVisitingArray<PageHeader, Row>(header, json, "rows",
+		[&rows](Row&& row) { rows.push_back(std::move(row)); return true; }, parseError));
+	REQUIRE(header.total_rows == 5);
+	REQUIRE(header._links.next == "https://host/rows?$skip=1000&$top=1000");
+	REQUIRE(rows.size() == 5);
+	REQUIRE(rows[3].id == "0x3");
+	REQUIRE(rows[3].name == "row \"3\" [a]{b}");
+	REQUIRE(rows[3].matrix.size() == 12);
+	REQUIRE(rows[3].matrix[11] == 3.);
+
+	// Same result as parsing the whole document.
+	Page page;
+	REQUIRE(AdvViz::SDK::Json::FromString(page, json));
+	REQUIRE(page.rows);
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		REQUIRE(rows[i].id == (*page.rows)[i].id);
+		REQUIRE(rows[i].name == (*page.rows)[i].name);
+		REQUIRE(rows[i].matrix == (*page.rows)[i].matrix);
+	}
+
+	// The array member can be declared in the header, and is left empty.
+	Page pageHeader;
+	size_t numVisited = 0;
+	REQUIRE(AdvViz::SDK::Json::FromStringVisitingArray<Page, Row>(pageHeader, json, "rows",
+		[&numVisited](Row&&) { return ++numVisited < 2; }, parseError));
+	REQUIRE(numVisited == 2);
+	REQUIRE(pageHeader.total_rows == 5);
+	REQUIRE((pageHeader.rows && pageHeader.rows->empty()));
+
+	REQUIRE(AdvViz::SDK::Json::FromStringVisitingArray<PageHeader, Row>(header,
+		"{ \"total_rows\" : 0, \"rows\" : [ ] }", "rows", [](Row&&) { return true; }, parseError));
+	REQUIRE(header.total_rows == 0);
+
+	for (std::string const invalidJson : {
+		"[]",
+		"{\"total_rows\":2,\"rows\":[{\"id\":\"0x1\",\"matrix\":[]}",
+		"{\"total_rows\":2,\"rows\":[{\"id\":\"0x1\",\"matrix\":[]},{\"id\":3,\"matrix\":[]}]}",
+		"{\"total_rows\":2,\"rows\":[] \"_links\":{}}" })
+	{
+		parseError.clear();
+		REQUIRE(!AdvViz::SDK::Json::FromStringVisitingArray<PageHeader, Row>(header, invalidJson, "rows",
+			[](Row&&) { return true; }, parseError, false));
+		REQUIRE(!parseError.empty());
+	}
+}
+
+// Hidden by default, run with: JsonTest "[benchmark]"
+// Run it in a separate process for each variant to get meaningful peak memory values, eg.
+// JsonTest "JsonTest:FromStringVisitingArray: benchmark" -c "streamed", then -c "whole document".
+TEST_CASE("JsonTest:FromStringVisitingArray: benchmark", "[.][benchmark]") {
+	using Clock = std::chrono::steady_clock;
+	auto toMs = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	constexpr size_t PayloadSize = 100 * 1024 * 1024;
+	std::string const json = MakePage(PayloadSize / MakePage(1).size());
+	size_t const peakBefore = GetPeakMemory();
+	std::cout << "Payload: " << json.size() / (1024 * 1024) << " MB, peak memory before parsing: "
+		<< peakBefore / (1024 * 1024) << " MB" << std::endl;
+
+	SECTION("streamed") {
+		auto const start = Clock::now();
+		PageHeader header;
+		std::string parseError;
+		double sum = 0.;
+		REQUIRE(AdvViz::SDK::Json::FromStringVisitingArray<PageHeader, Row>(header, json, "rows",
+			[&sum](Row&& row) { sum += row.matrix.back(); return true; }, parseError));
+		std::cout << "Json::FromStringVisitingArray: " << toMs(Clock::now() - start) << " ms, peak memory +"
+			<< (GetPeakMemory() - peakBefore) / (1024 * 1024) << " MB" << std::endl;
+		REQUIRE(sum > 0.);
+	}
+	SECTION("whole document") {
+		auto const start = Clock::now();
+		Page page;
+		REQUIRE(AdvViz::SDK::Json::FromString(page, json));
+		double sum = 0.;
+		for (Row const& row : *page.rows)
+			sum += row.matrix.back();
+		std::cout << "Json::FromString: " << toMs(Clock::now() - start) << " ms, peak memory +"
+			<< (GetPeakMemory() - peakBefore) / (1024 * 1024) << " MB" << std::endl;
+		REQUIRE(sum > 0.);
+	}
+}
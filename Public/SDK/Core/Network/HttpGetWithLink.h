@@ -10,15 +10,90 @@
 #include "Network.h"
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+
 namespace AdvViz::SDK
 {
 	using namespace Tools;
 
-	template<typename T, typename VecTFct>
-	inline AdvViz::expected<void, std::string> HttpGetWithLink_ByBatch(const std::shared_ptr<Http>& http,
-		const std::string& url, const Http::Headers& headers,
-		const VecTFct& fct)
+	struct HttpGetWithLinkOptions
+	{
+		/// Maximum number of pages requested at the same time. With the default value, pages are requested
+		/// one after the other by following the "next" links.
+		/// With a higher value, if the first page gives the total number of rows and its "next" link uses the
+		/// $skip/$top parameters, the URLs of all remaining pages are deduced from it and the pages are
+		/// requested concurrently. Batches are still passed to the callback in order, in the calling thread.
+		/// Otherwise, we fall back to following the "next" links.
+		int maxConcurrentPages = 1;
+	};
+
+	namespace HttpGetWithLinkImpl
 	{
+		// Quick workaround for a bug in Decoration Service sometimes providing bad URLs with http
+		// instead of https protocol! (issue found for instances, which was causing bug #1609088).
+		inline std::string FixLinkProtocol(std::string const& link)
+		{
+			if (link.starts_with("http://localhost") || link.starts_with("http://127.0.0.1"))
+				return link; // don't change http when using localhost
+			return rfl::internal::strings::replace_all(link, "http://", "https://");
+		}
+
+		struct SUrlParameter
+		{
+			size_t valuePos = 0;
+			size_t valueLength = 0;
+			size_t value = 0;
+		};
+
+		/// Finds an integer parameter of the given URL, eg. FindUrlParameter(url, "$skip=").
+		inline std::optional<SUrlParameter> FindUrlParameter(std::string const& url,
+			std::string const& paramWithEqual)
+		{
+			size_t pos = url.find(paramWithEqual);
+			while (pos != std::string::npos && pos > 0 && url[pos - 1] != '?' && url[pos - 1] != '&')
+				pos = url.find(paramWithEqual, pos + 1);
+			if (pos == std::string::npos || pos == 0)
+				return std::nullopt;
+			SUrlParameter param;
+			param.valuePos = pos + paramWithEqual.size();
+			size_t const valueEnd = std::min(url.find('&', param.valuePos), url.size());
+			param.valueLength = valueEnd - param.valuePos;
+			if (param.valueLength == 0)
+				return std::nullopt;
+			for (size_t i = param.valuePos; i < valueEnd; ++i)
+			{
+				if (url[i] < '0' || url[i] > '9')
+					return std::nullopt;
+				param.value = param.value * 10 + (url[i] - '0');
+			}
+			return param;
+		}
+
+		/// Deduces the URLs of all pages following the first one from its "next" link, which must be of the
+		/// form "...$skip=<size of first page>...$top=<page size>...".
+		/// \return false if the link does not allow it, or if there is nothing more to load.
+		inline bool MakeNextPagesUrls(std::string const& nextLink, int totalRows, size_t firstPageSize,
+			std::vector<std::string>& outUrls)
+		{
+			outUrls.clear();
+			if (totalRows <= 0 || firstPageSize == 0 || (size_t)totalRows <= firstPageSize)
+				return false;
+			std::string const link = FixLinkProtocol(nextLink);
+			auto const skip = FindUrlParameter(link, "$skip=");
+			auto const top = FindUrlParameter(link, "$top=");
+			if (!skip || !top || skip->value != firstPageSize || top->value == 0)
+				return false;
+			for (size_t rowIndex = skip->value; rowIndex < (size_t)totalRows; rowIndex += top->value)
+			{
+				outUrls.push_back(link);
+				outUrls.back().replace(skip->valuePos, skip->valueLength, std::to_string(rowIndex));
+			}
+			return true;
+		}
+
 		struct SJsonLink
 		{
 			std::optional<std::string> prev;
@@ -26,60 +101,172 @@ namespace AdvViz::SDK
 			std::optional<std::string> next;
 		};
 
-		struct SJsonOut
+		/// What we need to know about a page to load the next ones.
+		struct SPageInfo
 		{
-			int total_rows = 0;
-			std::optional<std::vector<T>> rows;
-			SJsonLink _links;
+			int totalRows = 0;
+			size_t numRows = 0;
+			std::optional<std::string> next;
 		};
-		SJsonOut jOut;
 
-		long status = http->GetJson(jOut, url, headers);
-		bool continueLoading = true;
-		if (jOut.total_rows > 0 && !jOut.rows.has_value() && (status == 200 || status == 201))
+		inline bool IsPageStatusOK(long status)
 		{
-			BE_ISSUE("unexpected Json parsed value");
+			return status == 200 || status == 201;
 		}
-		while (continueLoading)
+
+		inline Http::Headers MakeJsonHeaders(const Http::Headers& headers)
 		{
-			if (status != 200 && status != 201)
-			{
-				continueLoading = false;
-				return AdvViz::make_unexpected(fmt::format("{} failed with status: {}", url, status));
-			}
-			if (jOut.rows)
+			Http::Headers h(headers);
+			h.emplace_back("accept", "application/json");
+			h.emplace_back("Content-Type", "application/json; charset=UTF-8");
+			return h;
+		}
+
+		/// Requests the given pages, with at most maxConcurrentPages requests in progress, and calls pageFct
+		/// for each page, in order, in the calling thread. Stops at the first error.
+		/// \param lastPage Receives the information of the last page.
+		template<typename PageFct>
+		inline AdvViz::expected<void, std::string> GetPagesInOrder(const std::shared_ptr<Http>& http,
+			std::vector<std::string> const& urls, const Http::Headers& jsonHeaders, int maxConcurrentPages,
+			const PageFct& pageFct, SPageInfo& lastPage)
+		{
+			using PageResult = expected<std::string, std::string>;
+			// Shared with the callbacks, which may still be pending if we return early.
+			struct SReceivedPages
 			{
-				auto ret = fct(*jOut.rows);
-					if (!ret)
-						return ret;
+				std::mutex mutex;
+				std::condition_variable cv;
+				std::map<size_t, PageResult> pages;
+			};
+			auto received = std::make_shared<SReceivedPages>();
 
-				jOut.rows->clear();
-			}
-			if (jOut._links.next.has_value() && !jOut._links.next.value().empty())
+			size_t nextToRequest = 0;
+			for (size_t nextToDeliver = 0; nextToDeliver < urls.size(); ++nextToDeliver)
 			{
-				
-				// Quick workaround for a bug in Decoration Service sometimes providing bad URLs with http
-				// instead of https protocol! (issue found for instances, which was causing bug #1609088).
-				if (!jOut._links.next.value().starts_with("http://localhost") &&
-					!jOut._links.next.value().starts_with("http://127.0.0.1")
-					) // don't change http when using localhost
+				// Pages requested but not delivered yet are counted, to bound the memory used when the
+				// callback is slower than the network.
+				for (; nextToRequest < urls.size()
+					&& nextToRequest < nextToDeliver + (size_t)maxConcurrentPages; ++nextToRequest)
 				{
-					std::string const nextUrl = rfl::internal::strings::replace_all(
-						jOut._links.next.value(),
-						"http://", "https://");
-					status = http->GetJson(jOut, nextUrl, headers, true);
+					http->AsyncGet([received, pageIndex = nextToRequest, url = urls[nextToRequest]](
+						const Http::Response& r)
+					{
+						PageResult result;
+						if (IsPageStatusOK(r.first))
+							result = r.second;
+						else
+							result = make_unexpected(fmt::format("{} failed with status: {}", url, r.first));
+						{
+							std::lock_guard<std::mutex> lock(received->mutex);
+							received->pages.emplace(pageIndex, std::move(result));
+						}
+						received->cv.notify_one();
+					},
+						urls[nextToRequest], jsonHeaders, true /*isFullUrl*/,
+						Http::EAsyncCallbackExecutionMode::WorkerThread);
 				}
-				else
+				PageResult page;
 				{
-					status = http->GetJson(jOut, jOut._links.next.value(), headers, true);
+					std::unique_lock<std::mutex> lock(received->mutex);
+					received->cv.wait(lock, [&] { return received->pages.contains(nextToDeliver); });
+					auto it = received->pages.find(nextToDeliver);
+					page = std::move(it->second);
+					received->pages.erase(it);
 				}
+				if (!page)
+					return AdvViz::make_unexpected(page.error());
+				lastPage = {};
+				auto ret = pageFct(*page, lastPage);
+				if (!ret)
+					return ret;
 			}
-			else
+			return {};
+		}
+
+		/// Loads all pages, following the "next" links, or requesting them concurrently when allowed by the
+		/// options and the format of the links (see HttpGetWithLinkOptions).
+		/// \param pageFct Parses the body of a page and passes its rows to the client code:
+		///		(std::string const& body, SPageInfo& outInfo) -> expected<void, std::string>
+		template<typename PageFct>
+		inline AdvViz::expected<void, std::string> GetPages(const std::shared_ptr<Http>& http,
+			const std::string& url, const Http::Headers& headers, const HttpGetWithLinkOptions& options,
+			const PageFct& pageFct)
+		{
+			Http::Headers const jsonHeaders = MakeJsonHeaders(headers);
+			std::string pageUrl = url;
+			Http::Response r = http->Get(url, jsonHeaders);
+			SPageInfo page;
+			std::vector<std::string> nextPagesUrls;
+			bool bFirstPage = true;
+			while (true)
 			{
-				continueLoading = false;
+				if (!IsPageStatusOK(r.first))
+				{
+					return AdvViz::make_unexpected(fmt::format("{} failed with status: {}", pageUrl, r.first));
+				}
+				page = {};
+				auto ret = pageFct(r.second, page);
+				if (!ret)
+					return ret;
+				if (bFirstPage
+					&& options.maxConcurrentPages > 1
+					&& page.next
+					&& MakeNextPagesUrls(*page.next, page.totalRows, page.numRows, nextPagesUrls))
+				{
+					ret = GetPagesInOrder(http, nextPagesUrls, jsonHeaders, options.maxConcurrentPages,
+						pageFct, page);
+					if (!ret)
+						return ret;
+					// If rows were added in the meantime, the last page may still have a "next" link,
+					// which we follow below.
+				}
+				bFirstPage = false;
+				if (!page.next || page.next->empty())
+					return {};
+				pageUrl = FixLinkProtocol(*page.next);
+				r = http->Get(pageUrl, jsonHeaders, true /*isFullUrl*/);
 			}
 		}
-		return {};
+	}
+
+	template<typename T, typename VecTFct>
+	inline AdvViz::expected<void, std::string> HttpGetWithLink_ByBatch(const std::shared_ptr<Http>& http,
+		const std::string& url, const Http::Headers& headers,
+		const VecTFct& fct,
+		const HttpGetWithLinkOptions& options = {})
+	{
+		struct SJsonOut
+		{
+			int total_rows = 0;
+			std::optional<std::vector<T>> rows;
+			HttpGetWithLinkImpl::SJsonLink _links;
+		};
+		bool bFirstPage = true;
+
+		return HttpGetWithLinkImpl::GetPages(http, url, headers, options,
+			[&fct, &bFirstPage](std::string const& body, HttpGetWithLinkImpl::SPageInfo& page)
+				-> expected<void, std::string>
+		{
+			SJsonOut jOut;
+			// Like Http::GetJson, a page which cannot be parsed ends the loading (the error is logged).
+			if (!Json::FromString(jOut, body))
+				return {};
+			if (bFirstPage && jOut.total_rows > 0 && !jOut.rows.has_value())
+			{
+				BE_ISSUE("unexpected Json parsed value");
+			}
+			bFirstPage = false;
+			page.totalRows = jOut.total_rows;
+			page.next = std::move(jOut._links.next);
+			if (jOut.rows)
+			{
+				page.numRows = jOut.rows->size();
+				auto ret = fct(*jOut.rows);
+				if (!ret)
+					return ret;
+			}
+			return {};
+		});
 	}
 
 	template<typename T, typename VecTFct, typename OnFinishTFct>
@@ -173,20 +360,42 @@ namespace AdvViz::SDK
 		http->AsyncGetJson(jOut, *resultCallBackPtr, url, headers);
 	}
 
+	/// Rows are parsed and passed to fct one by one, without building the vector of all rows of each page
+	/// (see Json::FromStringVisitingArray).
 	template<typename T, typename TFct>
 	inline AdvViz::expected<void, std::string> HttpGetWithLink(const std::shared_ptr<Http>& http,
 		const std::string& url, const Http::Headers& headers,
-		const TFct& fct)
+		const TFct& fct,
+		const HttpGetWithLinkOptions& options = {})
 	{
-		return HttpGetWithLink_ByBatch<T>(http, url, headers,
-			[&fct](std::vector<T>& rows) -> expected<void, std::string>
+		struct SJsonPageHeader
 		{
-			for (auto& row : rows)
+			int total_rows = 0;
+			HttpGetWithLinkImpl::SJsonLink _links;
+		};
+
+		return HttpGetWithLinkImpl::GetPages(http, url, headers, options,
+			[&fct](std::string const& body, HttpGetWithLinkImpl::SPageInfo& page) -> expected<void, std::string>
+		{
+			expected<void, std::string> ret;
+			SJsonPageHeader pageHeader;
+			std::string parseError;
+			bool const bParsed = Json::FromStringVisitingArray<SJsonPageHeader, T>(pageHeader, body, "rows",
+				[&fct, &ret, &page](T&& row)
 			{
-				auto ret = fct(row);
-				if (!ret)
-					return ret;
-			}
+				++page.numRows;
+				ret = fct(row);
+				return ret.has_value();
+			},
+				parseError);
+			if (!ret)
+				return ret;
+			// The rows preceding a parse error were already passed to fct: the loading must fail, and not
+			// end as if the collection was complete.
+			if (!bParsed)
+				return AdvViz::make_unexpected("Invalid page: " + parseError);
+			page.totalRows = pageHeader.total_rows;
+			page.next = std::move(pageHeader._links.next);
 			return {};
 		});
 	}
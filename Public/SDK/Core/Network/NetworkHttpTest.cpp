@@ -7,8 +7,16 @@
 +--------------------------------------------------------------------------------------*/
 
 #include "Network.h"
+#include "HttpGetWithLink.h"
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
 // For now, unit tests regarding ITwinAPI are done in the Unreal plugin (see WebServicesTest.cpp)
 // We could o them in the SDK as well, but it would require to transfer/share the same mock server
 // as in the plugin, and it has few interest until we actually use the SDK for another platform
@@ -56,8 +64,20 @@ private:
 		const std::string& method,
 		const std::string& /*data*/,
 		const std::vector<UrlArg>& /*urlArguments*/,
-		const std::vector<Header>& /*headers*/)
+		const std::vector<Header>& headers)
 	{
+		if (method == "GET" && matchesPrefix(url, "/binary")) {
+			return Response(200, std::string("\x01\x00\xFFbin", 6))
+				.addHeader(Header("Content-Type", "application/octet-stream"));
+		}
+		if (method == "GET" && matchesPrefix(url, "/acceptencoding")) {
+			// Echoes the encodings accepted by the client.
+			for (auto const& header : headers) {
+				if (header.key == "Accept-Encoding")
+					return Response(200, header.value).addHeader(Header("Content-Type", "text/plain"));
+			}
+			return Response(200, "").addHeader(Header("Content-Type", "text/plain"));
+		}
 		if (method == "GET" && matchesPrefix(url, "/json")) {
 			// Do something and return response
 			return Response(200, "{\n  \"slideshow\": {\n    \"author\": \"Yours Truly\", \n    \"date\": \"date of publication\", \n    \"slides\": [\n      {\n        \"title\": \"Wake up to WonderWidgets!\", \n        \"type\": \"all\"\n      }, \n      {\n        \"items\": [\n          \"Why <em>WonderWidgets</em> are great\", \n          \"Who <em>buys</em> WonderWidgets\"\n        ], \n        \"title\": \"Overview\", \n        \"type\": \"all\"\n      }\n    ], \n    \"title\": \"Sample Slide Show\"\n  }\n}\n");
@@ -162,6 +182,343 @@ TEST_CASE("HttpTest:GetJsonPartialOBJ") {
 }
 
 
+TEST_CASE("HttpTest:ResponseHeadersAndRawData") {
+	std::unique_ptr<httpmock::MockServer> httpMockM = HTTPMock::MakeServer();
+	HTTPMock* httpMock = static_cast<HTTPMock*>(httpMockM.get());
+	auto http = AdvViz::SDK::Http::New();
+	http->SetBaseUrl(httpMock->GetUrl().c_str());
+
+	AdvViz::SDK::Http::Response r = http->Get("binary");
+	REQUIRE(r.first == 200);
+	REQUIRE(r.headers_);
+	REQUIRE(std::find_if(r.headers_->begin(), r.headers_->end(), [](auto const& header)
+		{ return header.first == "Content-Type" && header.second == "application/octet-stream"; })
+		!= r.headers_->end());
+	REQUIRE(r.rawdata_);
+	REQUIRE(*r.rawdata_ == AdvViz::SDK::Http::RawData({ 0x01, 0x00, 0xFF, 'b', 'i', 'n' }));
+
+	// Textual content is only provided as a string.
+	r = http->Get("acceptencoding");
+	REQUIRE(r.first == 200);
+	REQUIRE(!r.rawdata_);
+	REQUIRE(r.second.find("gzip") != std::string::npos);
+}
+
+/// Counts the requests it is processing simultaneously, each one taking some time.
+class ConcurrencyHTTPMock : public httpmock::MockServer {
+public:
+	static inline int latencyMs = 50;
+
+	static std::unique_ptr<httpmock::MockServer> MakeServer()
+	{
+		return httpmock::getFirstRunningMockServer<ConcurrencyHTTPMock>(9400);
+	}
+
+	explicit ConcurrencyHTTPMock(int port) : MockServer(port)
+	{
+		// Otherwise requests would be processed one at a time whatever the client does.
+		setThreadPerConnection(true);
+	}
+
+	std::string GetUrl()
+	{
+		return "http://localhost:" + std::to_string(getPort());
+	}
+
+	int GetMaxRunning() const { return maxRunning_; }
+	void ResetMaxRunning() { maxRunning_ = 0; }
+
+private:
+	Response responseHandler(
+		const std::string& url,
+		const std::string& method,
+		const std::string& /*data*/,
+		const std::vector<UrlArg>& /*urlArguments*/,
+		const std::vector<Header>& /*headers*/)
+	{
+		if (method != "GET" || url != "/slow")
+			return Response(404, "Not Found");
+		int const running = ++running_;
+		for (int maxRunning = maxRunning_; running > maxRunning
+			&& !maxRunning_.compare_exchange_weak(maxRunning, running); )
+		{
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		--running_;
+		return Response(200, "{}").addHeader(Header("Content-Type", "application/json"));
+	}
+
+	std::atomic<int> running_ = 0;
+	std::atomic<int> maxRunning_ = 0;
+};
+
+TEST_CASE("HttpTest:ConnectionOptions") {
+	std::unique_ptr<httpmock::MockServer> httpMockM = HTTPMock::MakeServer();
+	HTTPMock* httpMock = static_cast<HTTPMock*>(httpMockM.get());
+	std::unique_ptr<httpmock::MockServer> slowMockM = ConcurrencyHTTPMock::MakeServer();
+	ConcurrencyHTTPMock* slowMock = static_cast<ConcurrencyHTTPMock*>(slowMockM.get());
+	constexpr uint32_t maxConnections = 2;
+	auto const defaultOptions = AdvViz::SDK::Http::GetDefaultConnectionOptions();
+	AdvViz::SDK::Http::SetDefaultConnectionOptions(
+		{ .maxConnectionsPerHost = maxConnections, .acceptCompressedContent = false });
+	auto http = AdvViz::SDK::Http::New();
+	AdvViz::SDK::Http::SetDefaultConnectionOptions(defaultOptions);
+	http->SetBaseUrl(httpMock->GetUrl().c_str());
+
+	AdvViz::SDK::Http::Response r = http->Get("acceptencoding");
+	REQUIRE(r.first == 200);
+	REQUIRE(r.second.find("gzip") == std::string::npos);
+
+	// Asynchronous requests to a same host wait for one of the allowed connections.
+	constexpr int numRequests = 12;
+	std::string const slowUrl = slowMock->GetUrl() + "/slow";
+	std::atomic<int> numSucceeded = 0;
+	std::atomic<int> numPending = numRequests;
+	auto finished = std::make_shared<std::promise<void>>();
+	for (int i = 0; i < numRequests; ++i)
+	{
+		http->AsyncGet([&numSucceeded, &numPending, finished](AdvViz::SDK::Http::Response const& response)
+		{
+			if (response.first == 200)
+				++numSucceeded;
+			if (--numPending == 0)
+				finished->set_value();
+		}, slowUrl, {}, /*isFullUrl*/true);
+	}
+	// ...but synchronous ones, which may come from the game thread, do not wait for them.
+	std::this_thread::sleep_for(std::chrono::milliseconds(ConcurrencyHTTPMock::latencyMs / 2));
+	r = http->Get(slowUrl, {}, /*isFullUrl*/true);
+	CHECK(r.first == 200);
+	CHECK(numPending > 0);
+
+	REQUIRE(finished->get_future().wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+	CHECK(numSucceeded == numRequests);
+	CHECK(slowMock->GetMaxRunning() >= 2);
+	CHECK(slowMock->GetMaxRunning() <= int(maxConnections) + 1); // + the synchronous request
+
+	// Without the synchronous request, the bound is strict.
+	slowMock->ResetMaxRunning();
+	numSucceeded = 0;
+	numPending = numRequests;
+	finished = std::make_shared<std::promise<void>>();
+	for (int i = 0; i < numRequests; ++i)
+	{
+		http->AsyncGet([&numSucceeded, &numPending, finished](AdvViz::SDK::Http::Response const& response)
+		{
+			if (response.first == 200)
+				++numSucceeded;
+			if (--numPending == 0)
+				finished->set_value();
+		}, slowUrl, {}, /*isFullUrl*/true);
+	}
+	REQUIRE(finished->get_future().wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+	CHECK(numSucceeded == numRequests);
+	CHECK(slowMock->GetMaxRunning() == int(maxConnections));
+}
+
+// Hidden by default, run with: NetworkTest "[benchmark]"
+TEST_CASE("HttpTest:ConnectionReuse: benchmark", "[.][benchmark]")
+{
+	using Clock = std::chrono::steady_clock;
+	auto toMs = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	std::unique_ptr<httpmock::MockServer> httpMockM = HTTPMock::MakeServer();
+	HTTPMock* httpMock = static_cast<HTTPMock*>(httpMockM.get());
+	auto const defaultOptions = AdvViz::SDK::Http::GetDefaultConnectionOptions();
+	int const numRequests = 1000;
+
+	for (bool reuseConnections : { false, true })
+	{
+		AdvViz::SDK::Http::SetDefaultConnectionOptions({ .reuseConnections = reuseConnections });
+		auto http = AdvViz::SDK::Http::New();
+		http->SetBaseUrl(httpMock->GetUrl().c_str());
+
+		// Latency: one request after the other, like ECSQL paging.
+		auto start = Clock::now();
+		for (int i = 0; i < numRequests; ++i)
+			REQUIRE(http->GetJsonStr("json").first == 200);
+		double const sequentialMs = toMs(Clock::now() - start);
+
+		// Throughput: all requests at once, like instance saves.
+		start = Clock::now();
+		std::promise<void> finished;
+		std::atomic<int> numPending = numRequests;
+		std::atomic<int> numSucceeded = 0;
+		for (int i = 0; i < numRequests; ++i)
+		{
+			http->AsyncGet([&](AdvViz::SDK::Http::Response const& response)
+			{
+				if (response.first == 200)
+					++numSucceeded;
+				if (--numPending == 0)
+					finished.set_value();
+			}, "json");
+		}
+		finished.get_future().wait();
+		double const concurrentMs = toMs(Clock::now() - start);
+		CHECK(numSucceeded == numRequests);
+
+		std::cout << "Http (" << (reuseConnections ? "connections reused" : "new connection per request")
+			<< ") - " << numRequests << " sequential requests: " << sequentialMs << " ms ("
+			<< sequentialMs / numRequests << " ms/request), concurrent: " << concurrentMs << " ms ("
+			<< numRequests * 1000. / concurrentMs << " requests/s)" << std::endl;
+	}
+	AdvViz::SDK::Http::SetDefaultConnectionOptions(defaultOptions);
+}
+
+/// Serves a paged collection like the Decoration Service does, with some latency for each request.
+class PagedHTTPMock : public httpmock::MockServer {
+public:
+	static inline int totalRows = 0;
+	static inline int latencyMs = 0;
+	/// Index of a row sent with an invalid type, if any.
+	static inline int invalidRow = -1;
+
+	static std::unique_ptr<httpmock::MockServer> MakeServer()
+	{
+		return httpmock::getFirstRunningMockServer<PagedHTTPMock>(9300);
+	}
+
+	explicit PagedHTTPMock(int port) : MockServer(port)
+	{
+		// Otherwise the injected latency would serialize concurrent requests.
+		setThreadPerConnection(true);
+	}
+
+	std::string GetUrl()
+	{
+		return "http://localhost:" + std::to_string(getPort());
+	}
+
+	int GetRequestCount() const { return requestCount_; }
+
+private:
+	Response responseHandler(
+		const std::string& url,
+		const std::string& method,
+		const std::string& /*data*/,
+		const std::vector<UrlArg>& urlArguments,
+		const std::vector<Header>& /*headers*/)
+	{
+		if (method != "GET" || url != "/rows")
+			return Response(404, "Not Found");
+		++requestCount_;
+		int skip = 0, top = 1000;
+		for (auto const& arg : urlArguments)
+		{
+			if (arg.key == "$skip")
+				skip = std::stoi(arg.value);
+			else if (arg.key == "$top")
+				top = std::stoi(arg.value);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		std::string body = "{\"total_rows\":" + std::to_string(totalRows) + ",\"rows\":[";
+		for (int i = skip; i < std::min(skip + top, totalRows); ++i)
+		{
+			body += (i > skip ? ",{\"index\":" : "{\"index\":")
+				+ ((i == invalidRow) ? "\"invalid\"" : std::to_string(i)) + "}";
+		}
+		body += "],\"_links\":{\"self\":\"" + GetUrl() + "/rows?$skip=" + std::to_string(skip) + "&$top="
+			+ std::to_string(top) + "\"";
+		if (skip + top < totalRows)
+		{
+			body += ",\"next\":\"" + GetUrl() + "/rows?$skip=" + std::to_string(skip + top) + "&$top="
+				+ std::to_string(top) + "\"";
+		}
+		return Response(200, body + "}}");
+	}
+
+	std::atomic<int> requestCount_ = 0;
+};
+
+struct PagedRow {
+	int index = -1;
+};
+
+/// Loads all rows of the collection, and checks that they were received in order.
+static bool LoadPagedRows(const std::shared_ptr<AdvViz::SDK::Http>& http, int maxConcurrentPages, int pageSize)
+{
+	int nextIndex = 0;
+	bool inOrder = true;
+	auto ret = AdvViz::SDK::HttpGetWithLink<PagedRow>(http,
+		"rows?$skip=0&$top=" + std::to_string(pageSize), {},
+		[&](PagedRow const& row) -> AdvViz::expected<void, std::string>
+		{
+			inOrder = inOrder && (row.index == nextIndex);
+			++nextIndex;
+			return {};
+		},
+		{ .maxConcurrentPages = maxConcurrentPages });
+	return ret && inOrder && nextIndex == PagedHTTPMock::totalRows;
+}
+
+TEST_CASE("HttpTest:GetWithLinkConcurrentPages")
+{
+	std::unique_ptr<httpmock::MockServer> httpMockM = PagedHTTPMock::MakeServer();
+	PagedHTTPMock* httpMock = static_cast<PagedHTTPMock*>(httpMockM.get());
+	auto http = AdvViz::SDK::Http::New();
+	http->SetBaseUrl(httpMock->GetUrl().c_str());
+	PagedHTTPMock::latencyMs = 0;
+
+	for (int totalRows : { 0, 7, 10, 95 })
+	{
+		PagedHTTPMock::totalRows = totalRows;
+		REQUIRE(LoadPagedRows(http, 1, 10));
+		REQUIRE(LoadPagedRows(http, 4, 10));
+	}
+	// A failing page stops the loading.
+	auto ret = AdvViz::SDK::HttpGetWithLink<PagedRow>(http, "rows?$skip=0&$top=10", {},
+		[](PagedRow const& row) -> AdvViz::expected<void, std::string>
+		{
+			if (row.index == 42)
+				return AdvViz::make_unexpected("stop");
+			return {};
+		},
+		{ .maxConcurrentPages = 4 });
+	REQUIRE(!ret);
+	REQUIRE(ret.error() == "stop");
+
+	// So does a page which cannot be parsed, even though its first rows were already received.
+	PagedHTTPMock::invalidRow = 42;
+	int numReceived = 0;
+	ret = AdvViz::SDK::HttpGetWithLink<PagedRow>(http, "rows?$skip=0&$top=10", {},
+		[&numReceived](PagedRow const&) -> AdvViz::expected<void, std::string>
+		{
+			++numReceived;
+			return {};
+		},
+		{ .maxConcurrentPages = 4 });
+	PagedHTTPMock::invalidRow = -1;
+	REQUIRE(!ret);
+	REQUIRE(numReceived < PagedHTTPMock::totalRows);
+}
+
+// Hidden by default, run with: NetworkTest "[benchmark]"
+TEST_CASE("HttpTest:GetWithLinkConcurrentPages: benchmark", "[.][benchmark]")
+{
+	using Clock = std::chrono::steady_clock;
+	auto toMs = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+
+	std::unique_ptr<httpmock::MockServer> httpMockM = PagedHTTPMock::MakeServer();
+	PagedHTTPMock* httpMock = static_cast<PagedHTTPMock*>(httpMockM.get());
+	auto http = AdvViz::SDK::Http::New();
+	http->SetBaseUrl(httpMock->GetUrl().c_str());
+	PagedHTTPMock::totalRows = 20000;
+	PagedHTTPMock::latencyMs = 50;
+	int const pageSize = 1000;
+
+	for (int maxConcurrentPages : { 1, 2, 4, 8 })
+	{
+		int const requestsBefore = httpMock->GetRequestCount();
+		auto start = Clock::now();
+		REQUIRE(LoadPagedRows(http, maxConcurrentPages, pageSize));
+		std::cout << "HttpGetWithLink - " << PagedHTTPMock::totalRows << " rows, "
+			<< (httpMock->GetRequestCount() - requestsBefore) << " pages, " << PagedHTTPMock::latencyMs
+			<< " ms latency, " << maxConcurrentPages << " concurrent page(s): " << toMs(Clock::now() - start)
+			<< " ms" << std::endl;
+	}
+}
+
 #if TEST_ITWINAPI_REQUESTS_IN_SDK()
 
 struct ITwinInfoHolder
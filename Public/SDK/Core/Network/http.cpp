@@ -8,10 +8,30 @@
 
 
 #include "http.h"
+#include <mutex>
 #include <string.h>
 
 namespace AdvViz::SDK 
 {
+	namespace
+	{
+		std::mutex defaultConnectionOptionsMutex;
+		Http::ConnectionOptions defaultConnectionOptions;
+	}
+
+	/*static*/
+	void Http::SetDefaultConnectionOptions(ConnectionOptions const& options)
+	{
+		std::lock_guard<std::mutex> lock(defaultConnectionOptionsMutex);
+		defaultConnectionOptions = options;
+	}
+
+	/*static*/
+	Http::ConnectionOptions Http::GetDefaultConnectionOptions()
+	{
+		std::lock_guard<std::mutex> lock(defaultConnectionOptionsMutex);
+		return defaultConnectionOptions;
+	}
 
 	Http::Http()
 	{}
@@ -97,6 +97,26 @@ namespace AdvViz::SDK {
 			GameThread = MainThread, /* convenient alias for Unreal world */
 		};
 
+		/// Settings for the implementations managing their own connections (cpr). Unreal's HTTP module has
+		/// its own settings (see [HTTP] section of the engine configuration).
+		struct ConnectionOptions
+		{
+			/// Keep the connections alive between requests, so that successive requests to a same host
+			/// do not pay for the TCP and TLS handshakes again.
+			bool reuseConnections = true;
+			/// Maximum number of simultaneous connections to a same host, when connections are reused.
+			/// Further asynchronous requests to this host wait for one of them to be available, whereas
+			/// synchronous requests (which may be issued from the game thread) use an extra connection.
+			uint32_t maxConnectionsPerHost = 8;
+			/// Negotiate HTTP/2 with the servers supporting it (over TLS only), HTTP/1.1 otherwise.
+			bool allowHttp2 = true;
+			/// Ask for compressed responses (gzip, deflate). They are decompressed transparently.
+			bool acceptCompressedContent = true;
+		};
+		/// Applies to the instances created afterwards.
+		static void SetDefaultConnectionOptions(ConnectionOptions const& options);
+		static ConnectionOptions GetDefaultConnectionOptions();
+
 		virtual ~Http();
 
 		void SetAccessToken(std::shared_ptr<ThreadSafeAccessToken> p) { accessToken_ = p; }
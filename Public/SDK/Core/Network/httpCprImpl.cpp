@@ -17,6 +17,7 @@
 #ifdef WITH_HTTPCPR
 #include <cpr/cpr.h>
 #include "httpCprImpl.h"
+#include <algorithm>
 #endif 
 
 namespace AdvViz::SDK
@@ -53,10 +54,210 @@ extern "C" {
 
 namespace AdvViz::SDK::Impl
 {
+	namespace
+	{
+		/// Sessions are pooled by scheme, host and port.
+		std::string GetHostKey(std::string const& url)
+		{
+			size_t const schemeEnd = url.find("://");
+			size_t const hostStart = (schemeEnd == std::string::npos) ? 0 : schemeEnd + 3;
+			return url.substr(0, url.find_first_of("/?#", hostStart));
+		}
+
+		cpr::Header ToCprHeader(Http::Headers const& headers)
+		{
+			cpr::Header h;
+			for (auto& i : headers)
+				h[i.first] = i.second;
+			return h;
+		}
+
+		bool IsTextualContentType(std::string const& contentType)
+		{
+			return contentType.starts_with("text/")
+				|| contentType.find("json") != std::string::npos
+				|| contentType.find("xml") != std::string::npos;
+		}
+
+		Http::Response ConvertResponse(cpr::Response&& r)
+		{
+			Http::Response resp(r.status_code, std::move(r.text));
+			if (r.status_code == 0)
+				return resp;
+			resp.headers_ = std::make_unique<Http::Headers>();
+			resp.headers_->reserve(r.header.size());
+			for (auto const& [key, value] : r.header)
+				resp.headers_->emplace_back(key, value);
+			// Same as the Unreal implementation: binary content (keyframes, thumbnails...) is also provided
+			// as raw data. Compressed responses have already been decompressed by curl at this point.
+			auto const contentType = r.header.find("Content-Type");
+			if (contentType != r.header.end() && !IsTextualContentType(contentType->second)
+				&& !resp.second.empty())
+			{
+				resp.rawdata_ = std::make_shared<Http::RawData>(resp.second.begin(), resp.second.end());
+			}
+			return resp;
+		}
+	}
+
+	struct CprSessionPool::CurlShare
+	{
+		CURLSH* handle = nullptr;
+		std::mutex mutexes[CURL_LOCK_DATA_LAST];
+
+		CurlShare()
+		{
+			handle = curl_share_init();
+			if (!handle)
+				return;
+			curl_share_setopt(handle, CURLSHOPT_LOCKFUNC, &CurlShare::Lock);
+			curl_share_setopt(handle, CURLSHOPT_UNLOCKFUNC, &CurlShare::Unlock);
+			curl_share_setopt(handle, CURLSHOPT_USERDATA, this);
+			curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+			curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900 // 7.57.0
+			curl_share_setopt(handle, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+		}
+
+		~CurlShare()
+		{
+			if (handle)
+				curl_share_cleanup(handle);
+		}
+
+		static void Lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+		{
+			static_cast<CurlShare*>(userptr)->mutexes[data].lock();
+		}
+
+		static void Unlock(CURL*, curl_lock_data data, void* userptr)
+		{
+			static_cast<CurlShare*>(userptr)->mutexes[data].unlock();
+		}
+	};
+
+	CprSessionPool::CprSessionPool(Http::ConnectionOptions const& options)
+		: options_(options)
+	{
+		if (options_.reuseConnections)
+			share_ = std::make_unique<CurlShare>();
+	}
+
+	CprSessionPool::~CprSessionPool()
+	{
+		// The curl handles must be released before the share handle they use.
+		hosts_.clear();
+		share_.reset();
+	}
+
+	std::unique_ptr<cpr::Session> CprSessionPool::MakeSession() const
+	{
+		auto session = std::make_unique<cpr::Session>();
+		session->SetHttpVersion(cpr::HttpVersion{ options_.allowHttp2
+			? cpr::HttpVersionCode::VERSION_2_0_TLS : cpr::HttpVersionCode::VERSION_1_1 });
+		if (options_.acceptCompressedContent)
+		{
+			session->SetAcceptEncoding(cpr::AcceptEncoding{
+				cpr::AcceptEncodingMethods::gzip, cpr::AcceptEncodingMethods::deflate });
+		}
+		if (share_ && share_->handle)
+			curl_easy_setopt(session->GetCurlHolder()->handle, CURLOPT_SHARE, share_->handle);
+		return session;
+	}
+
+	std::unique_ptr<cpr::Session> CprSessionPool::Acquire(std::string const& host, EVerb verb,
+		bool const bMayWait, bool& bPooled)
+	{
+		bPooled = options_.reuseConnections;
+		if (!options_.reuseConnections)
+			return MakeSession();
+		uint32_t const maxSessions = std::max(options_.maxConnectionsPerHost, 1u);
+		std::unique_lock<std::mutex> lock(mutex_);
+		HostSessions& sessions = hosts_[host];
+		while (true)
+		{
+			auto const it = sessions.idle.find(verb);
+			if (it != sessions.idle.end())
+			{
+				auto session = std::move(it->second);
+				sessions.idle.erase(it);
+				return session;
+			}
+			if (sessions.numSessions < maxSessions)
+			{
+				++sessions.numSessions;
+				lock.unlock();
+				return MakeSession();
+			}
+			if (!sessions.idle.empty())
+			{
+				// All sessions are idle for other verbs: replace one of them.
+				auto replaced = std::move(sessions.idle.begin()->second);
+				sessions.idle.erase(sessions.idle.begin());
+				lock.unlock();
+				replaced.reset();
+				return MakeSession();
+			}
+			if (!bMayWait)
+			{
+				// Synchronous requests must not wait for the asynchronous ones in progress: use a session
+				// outside the pool (its connection is still shared through the curl share handle).
+				bPooled = false;
+				lock.unlock();
+				return MakeSession();
+			}
+			sessionReleased_.wait(lock);
+		}
+	}
+
+	void CprSessionPool::Release(std::string const& host, EVerb verb, std::unique_ptr<cpr::Session>&& session,
+		bool const bPooled)
+	{
+		if (!bPooled)
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			hosts_[host].idle.emplace(verb, std::move(session));
+		}
+		sessionReleased_.notify_all();
+	}
+
+	Http::Response CprSessionPool::Perform(EVerb verb, std::string const& url, cpr::Header const& header,
+		cpr::Authentication const* auth, SetContentFct const& setContent, bool const bAsync)
+	{
+		std::string const host = GetHostKey(url);
+		bool bPooled = false;
+		std::unique_ptr<cpr::Session> session = Acquire(host, verb, /*bMayWait*/bAsync, bPooled);
+		session->SetUrl(cpr::Url{ url });
+		session->SetHeader(header);
+		if (auth)
+			session->SetAuth(*auth);
+		if (setContent)
+			setContent(*session);
+		cpr::Response r;
+		switch (verb)
+		{
+		case EVerb::Get:		r = session->Get(); break;
+		case EVerb::Post:
+		case EVerb::PostFile:	r = session->Post(); break;
+		case EVerb::Put:		r = session->Put(); break;
+		case EVerb::Patch:		r = session->Patch(); break;
+		case EVerb::Delete:		r = session->Delete(); break;
+		}
+		Release(host, verb, std::move(session), bPooled);
+		return ConvertResponse(std::move(r));
+	}
+
+
+	HttpCpr::HttpCpr()
+		: sessionPool_(std::make_shared<CprSessionPool>(GetDefaultConnectionOptions()))
+	{
+	}
 
 	void HttpCpr::SetBasicAuth(const char* login, const char* passwd)
 	{
-		auth_ = std::make_unique<cpr::Authentication>(login, passwd, cpr::AuthMode::BASIC);
+		auth_ = std::make_shared<cpr::Authentication>(login, passwd, cpr::AuthMode::BASIC);
 	}
 
 	bool HttpCpr::DecodeBase64(const std::string& src, RawData& buffer) const
@@ -78,163 +279,105 @@ namespace AdvViz::SDK::Impl
 		return bSuccess;
 	}
 
+	std::string HttpCpr::MakeFullUrl(std::string const& url, bool isFullUrl) const
+	{
+		if (isFullUrl || url.starts_with("http:") || url.starts_with("https:"))
+			return url;
+		return GetBaseUrlStr() + '/' + url;
+	}
+
+	Http::Response HttpCpr::Perform(EVerb verb, std::string const& fullUrl, const Headers& headers,
+		CprSessionPool::SetContentFct const& setContent /*= {}*/) const
+	{
+		return sessionPool_->Perform(verb, fullUrl, ToCprHeader(headers), auth_.get(), setContent,
+			/*bAsync*/false);
+	}
+
+	void HttpCpr::PerformAsync(std::function<void(const Response&)> callback, EVerb verb,
+		std::string const& fullUrl, const Headers& headers,
+		CprSessionPool::SetContentFct const& setContent /*= {}*/) const
+	{
+		// Like cpr::GetCallback & co, but with a session from the pool.
+		cpr::async([callback, verb, fullUrl, setContent, header = ToCprHeader(headers),
+			pool = sessionPool_, auth = auth_]()
+		{
+			callback(pool->Perform(verb, fullUrl, header, auth.get(), setContent, /*bAsync*/true));
+		});
+	}
+
 	Http::Response HttpCpr::DoPut(const std::string& url,
 								  const BodyParams& body /*= {} */,
 								  const Headers& headers /*= {} */)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Put(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Put(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-		);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Put, MakeFullUrl(url, false), headers,
+			[&body](cpr::Session& session) { session.SetBody(cpr::Body{ body.str() }); });
 	}
 
 	Http::Response HttpCpr::DoPutBinaryFile(const std::string& url,
 		const std::string& filePath, const Headers& headers /*= {}*/)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Put(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body(cpr::File(filePath))
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Put(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body(cpr::File(filePath))
-				, h
-			);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Put, MakeFullUrl(url, false), headers,
+			[&filePath](cpr::Session& session) { session.SetBody(cpr::Body(cpr::File(filePath))); });
 	}
 
 	Http::Response HttpCpr::DoPatch(const std::string& url,
 									const BodyParams& body /*= {} */,
 									const Headers& headers /*= {} */)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Patch(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Patch(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-		);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Patch, MakeFullUrl(url, false), headers,
+			[&body](cpr::Session& session) { session.SetBody(cpr::Body{ body.str() }); });
 	}
 
 	void HttpCpr::DoAsyncPatch(std::function<void(const Response&)> callback, const std::string& url,
 		const BodyParams& body, const Headers& headers, EAsyncCallbackExecutionMode /*asyncCBExecMode*/)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::PatchCallback([callback](cpr::Response r) {
-			Response resp(r.status_code, std::move(r.text));
-			callback(resp);
-		}
-			, cpr::Url{ GetBaseUrlStr() + '/' + url }
-			, cpr::Body{ body.str() }
-		, h);
+		PerformAsync(callback, EVerb::Patch, MakeFullUrl(url, false), headers,
+			[bodyStr = body.str()](cpr::Session& session) { session.SetBody(cpr::Body{ bodyStr }); });
 	}
 
 	Http::Response HttpCpr::DoPost(const std::string& url,
 								   const BodyParams& body /*= {} */,
 								   const Headers& headers /*= {} */)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Post(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Post(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-		);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Post, MakeFullUrl(url, false), headers,
+			[&body](cpr::Session& session) { session.SetBody(cpr::Body{ body.str() }); });
 	}
 
 	void HttpCpr::DoAsyncPost(std::function<void(const Response&)> callback, const std::string& url,
 		const BodyParams& body, const Headers& headers, EAsyncCallbackExecutionMode /*asyncCBExecMode*/)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::PostCallback([callback](cpr::Response r) {
-			Response resp(r.status_code, std::move(r.text));
-			callback(resp);
-			}
-			, cpr::Url{ GetBaseUrlStr() + '/' + url}
-			, cpr::Body{ body.str() }
-		, h);
+		PerformAsync(callback, EVerb::Post, MakeFullUrl(url, false), headers,
+			[bodyStr = body.str()](cpr::Session& session) { session.SetBody(cpr::Body{ bodyStr }); });
 	}
 
 	void HttpCpr::DoAsyncPut(std::function<void(const Response&)> callback, const std::string& url,
 		const BodyParams& body, const Headers& headers, EAsyncCallbackExecutionMode /*asyncCBExecMode*/)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::PutCallback([callback](cpr::Response r) {
-			Response resp(r.status_code, std::move(r.text));
-			callback(resp);
-			}
-			, cpr::Url{ GetBaseUrlStr() + '/' + url }
-			, cpr::Body{ body.str() }
-		, h);
+		PerformAsync(callback, EVerb::Put, MakeFullUrl(url, false), headers,
+			[bodyStr = body.str()](cpr::Session& session) { session.SetBody(cpr::Body{ bodyStr }); });
+	}
+
+	namespace
+	{
+		cpr::Multipart MakeMultipart(const std::string& fileParamName, const std::string& filePath,
+			const Http::KeyValueVector& extraParams)
+		{
+			cpr::Multipart multipart({});
+			multipart.parts.reserve(1 + extraParams.size());
+			for (auto& i : extraParams)
+				multipart.parts.emplace_back(i.first, i.second);
+			multipart.parts.emplace_back(fileParamName, cpr::File{ filePath });
+			return multipart;
+		}
 	}
 
 	Http::Response HttpCpr::DoPostFile(const std::string& url,
 		const std::string& fileParamName, const std::string& filePath,
 		const KeyValueVector& extraParams /*= {}*/, const Headers& headers /*= {}*/)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Multipart multipart({});
-		multipart.parts.reserve(1 + extraParams.size());
-		for (auto& i : extraParams)	
-			multipart.parts.emplace_back(i.first, i.second);
-		multipart.parts.emplace_back(fileParamName, cpr::File{ filePath });
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Post(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, multipart
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Post(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, multipart
-				, h
-			);
-		return Response(r.status_code, std::move(r.text));
+		cpr::Multipart const multipart = MakeMultipart(fileParamName, filePath, extraParams);
+		return Perform(EVerb::PostFile, MakeFullUrl(url, false), headers,
+			[&multipart](cpr::Session& session) { session.SetMultipart(multipart); });
 	}
 
 	void HttpCpr::DoAsyncPostFile(std::function<void(const Response&)> callback, const std::string& url,
@@ -242,89 +385,35 @@ namespace AdvViz::SDK::Impl
 		const KeyValueVector& extraParams /*= {}*/, const Headers& headers /*= {}*/,
 		EAsyncCallbackExecutionMode /*asyncCBExecMode*/ /*= Default */)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Multipart multipart({});
-		multipart.parts.reserve(1 + extraParams.size());
-		for (auto& i : extraParams)
-			multipart.parts.emplace_back(i.first, i.second);
-		multipart.parts.emplace_back(fileParamName, cpr::File{ filePath });
-
-		cpr::PostCallback(
-			[callback](cpr::Response r) {
-			Response resp(r.status_code, std::move(r.text));
-			callback(resp);
-		}
-			, cpr::Url{ GetBaseUrlStr() + '/' + url }
-			, multipart
-			, h
-		);
+		PerformAsync(callback, EVerb::PostFile, MakeFullUrl(url, false), headers,
+			[multipart = MakeMultipart(fileParamName, filePath, extraParams)](cpr::Session& session)
+		{
+			session.SetMultipart(multipart);
+		});
 	}
 
 	Http::Response HttpCpr::DoGet(const std::string& url,
 								  const Headers& headers /*= {} */,
 								  bool isFullUrl /*= false*/)
 	{
-		if (!isFullUrl && (url.starts_with("http:") || url.starts_with("https:")))
-			isFullUrl = true;
-
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Get(cpr::Url{ isFullUrl ? url : (GetBaseUrlStr() + '/' + url) }
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Get(cpr::Url{ isFullUrl ? url : (GetBaseUrlStr() + '/' + url) }
-				, h
-			);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Get, MakeFullUrl(url, isFullUrl), headers);
 	}
 
 
 	void HttpCpr::DoAsyncGet(std::function<void(const Response&)> callback, const std::string& url,
 		const Headers& headers /*= {}*/,
 		bool isFullUrl /*= false*/,
-		EAsyncCallbackExecutionMode asyncCBExecMode /*= Default */)
-	{
-		if (!isFullUrl && (url.starts_with("http:") || url.starts_with("https:")))
-			isFullUrl = true;
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::GetCallback([callback](cpr::Response r) {
-				Response resp(r.status_code, std::move(r.text));
-				callback(resp);
-			}, 
-			cpr::Url{ isFullUrl ? url : (GetBaseUrlStr() + '/' + url) }
-			, h);
+		EAsyncCallbackExecutionMode /*asyncCBExecMode*/ /*= Default */)
+	{
+		PerformAsync(callback, EVerb::Get, MakeFullUrl(url, isFullUrl), headers);
 	}
 
 	Http::Response HttpCpr::DoDelete(const std::string& url,
 									const BodyParams& body /*= {} */,
 									const Headers& headers /*= {} */)
 	{
-
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::Response r;
-		if (auth_)
-			r = cpr::Delete(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-				, *auth_
-			);
-		else
-			r = cpr::Delete(cpr::Url{ GetBaseUrlStr() + '/' + url }
-				, cpr::Body{ body.str() }
-				, h
-		);
-		return Response(r.status_code, std::move(r.text));
+		return Perform(EVerb::Delete, MakeFullUrl(url, false), headers,
+			[&body](cpr::Session& session) { session.SetBody(cpr::Body{ body.str() }); });
 	}
 
 	void HttpCpr::DoAsyncDelete(std::function<void(const Response&)> callback,
@@ -333,16 +422,8 @@ namespace AdvViz::SDK::Impl
 								const Headers& headers /*= {}*/,
 								EAsyncCallbackExecutionMode /*asyncCBExecMode*/ /*= Default */)
 	{
-		cpr::Header h;
-		for (auto& i : headers)
-			h[i.first] = i.second;
-		cpr::DeleteCallback([callback](cpr::Response r) {
-				Response resp(r.status_code, std::move(r.text));
-				callback(resp);
-			},
-			cpr::Url{ GetBaseUrlStr() + '/' + url },
-			cpr::Body{ body.str() },
-			h);
+		PerformAsync(callback, EVerb::Delete, MakeFullUrl(url, false), headers,
+			[bodyStr = body.str()](cpr::Session& session) { session.SetBody(cpr::Body{ bodyStr }); });
 	}
 
 	std::string HttpCpr::GetBaseUrlStr() const
@@ -9,6 +9,9 @@
 
 #include <cpr/cpr.h>
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <string>
 #include "http.h"
 
@@ -17,10 +20,60 @@ namespace AdvViz::SDK
 #ifdef WITH_HTTPCPR
 	namespace Impl
 	{
+		/// Keeps the cpr sessions alive between requests, grouped by host, so that successive requests
+		/// reuse the same curl handles and thus the same connections (keep-alive). The connection cache, DNS
+		/// cache and TLS sessions are also shared between all sessions of the pool.
+		class CprSessionPool
+		{
+		public:
+			/// Sessions are not shared between verbs, as cpr keeps the body of the previous request.
+			enum class EVerb : uint8_t
+			{
+				Get,
+				Post,
+				PostFile,
+				Put,
+				Patch,
+				Delete,
+			};
+			using SetContentFct = std::function<void(cpr::Session&)>;
+
+			explicit CprSessionPool(Http::ConnectionOptions const& options);
+			~CprSessionPool();
+
+			/// Performs a request with a session for the url's host. If the maximum number of connections to
+			/// this host is reached, asynchronous requests wait for a session to be available, whereas
+			/// synchronous ones, which must not block the calling thread any longer, use an extra session.
+			/// \param setContent Sets the body of the request, if any.
+			Http::Response Perform(EVerb verb, std::string const& url, cpr::Header const& header,
+				cpr::Authentication const* auth, SetContentFct const& setContent, bool const bAsync);
+
+		private:
+			struct HostSessions
+			{
+				std::multimap<EVerb, std::unique_ptr<cpr::Session>> idle;
+				uint32_t numSessions = 0;
+			};
+
+			std::unique_ptr<cpr::Session> MakeSession() const;
+			/// \param bPooled Set to false for an extra session, which must not be returned to the pool.
+			std::unique_ptr<cpr::Session> Acquire(std::string const& host, EVerb verb, bool const bMayWait,
+				bool& bPooled);
+			void Release(std::string const& host, EVerb verb, std::unique_ptr<cpr::Session>&& session,
+				bool const bPooled);
+
+			Http::ConnectionOptions const options_;
+			std::mutex mutex_;
+			std::condition_variable sessionReleased_;
+			std::map<std::string, HostSessions> hosts_;
+			struct CurlShare;
+			std::unique_ptr<CurlShare> share_;
+		};
+
 		class HttpCpr : public Http, Tools::TypeId<HttpCpr>
 		{
 		public:
-			HttpCpr() {}
+			HttpCpr();
 			void SetBasicAuth(const char* login, const char* passwd) override;
 			bool DecodeBase64(const std::string& src, RawData& buffer) const override;
 			Http::Response DoPut(const std::string& url, const BodyParams& body = {}, const Headers& headers = {}) override;
@@ -57,12 +110,19 @@ namespace AdvViz::SDK
 			bool SupportsExecuteAsyncCallbackInMainThread() const override { return false; }
 
 		private:
-			std::unique_ptr<cpr::Authentication> auth_;
+			using EVerb = CprSessionPool::EVerb;
 
-			std::string GetBaseUrlStr() const;
-
-			
+			std::shared_ptr<cpr::Authentication> auth_;
+			/// Shared with the asynchronous requests in progress.
+			std::shared_ptr<CprSessionPool> sessionPool_;
 
+			std::string GetBaseUrlStr() const;
+			std::string MakeFullUrl(std::string const& url, bool isFullUrl) const;
+			Http::Response Perform(EVerb verb, std::string const& fullUrl, const Headers& headers,
+				CprSessionPool::SetContentFct const& setContent = {}) const;
+			void PerformAsync(std::function<void(const Response&)> callback, EVerb verb,
+				std::string const& fullUrl, const Headers& headers,
+				CprSessionPool::SetContentFct const& setContent = {}) const;
 		};
 	};
 #endif
@@ -55,6 +55,7 @@ namespace AdvViz::SDK::Tools
 				std::cerr << info.to_string() << std::endl;
 				(void)fflush(stderr);
 			}
+			FlushLog();
 			std::abort();
 			// Breaking here as debug CRT allows aborts to be ignored, if someone wants to make a
 			// debug build of this library
@@ -7,67 +7,253 @@
 +--------------------------------------------------------------------------------------*/
 
 
-// This code was moved from JsonQueriesCacheInit.cpp to suppress a warning which was persisting despite the
-// _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING macro, probably due to the way UE manages low-level
-// includes.
+// This code was moved from JsonQueriesCacheInit.cpp.
 //
 // Initial author: Ghislain Cottat
-#define _SILENCE_CXX17_CODECVT_HEADER_DEPRECATION_WARNING
 
 #include "JsonCacheUtilities.h"
 
 #include "Assert.h"
+#include "Log.h"
+#include "TaskManager.h"
 
-#include <codecvt>
-#include <locale>
+#include <algorithm>
 #include <fstream>
 
+#if defined(_WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
 namespace AdvViz::SDK::Tools
 {
-
-	/// Logic from FPlaylistReaderDASH::GetXMLResponseString
-	EFileBOM HasBOM(std::filesystem::path const& Filepath, uint64_t& FileSize)
+	namespace
 	{
-		std::streamoff const FileOffset =
-			std::ifstream(Filepath, std::ios_base::ate | std::ios_base::binary).tellg();
-		if (FileOffset <= 0)
-			return EFileBOM::Unknown;
-		FileSize = static_cast<uint64_t>(FileOffset);
-		std::fstream Ifs(Filepath);
-		if (!Ifs.good())
-			return EFileBOM::Unknown;
-		uint8_t const Byte0 = static_cast<uint8_t>( (FileSize > 0) ? Ifs.get() : 0 );
-		uint8_t const Byte1 = static_cast<uint8_t>( (FileSize > 1) ? Ifs.get() : 0 );
-		uint8_t const Byte2 = static_cast<uint8_t>( (FileSize > 2) ? Ifs.get() : 0 );
-		uint8_t const Byte3 = static_cast<uint8_t>( (FileSize > 3) ? Ifs.get() : 0 );
-		if (FileSize > 3 && Byte0 == 0xEF && Byte1 == 0xBB && Byte2 == 0xBF)
-		{
-			return EFileBOM::UTF8;
-		}
-		else if (FileSize >= 2 && Byte0 == 0xFE && Byte1 == 0xFF)
+		/// Logic from FPlaylistReaderDASH::GetXMLResponseString
+		EFileBOM DetectBOM(uint8_t const* Bytes, uint64_t const FileSize)
 		{
-			return EFileBOM::UTF16_BE;
+			uint8_t const Byte0 = (FileSize > 0) ? Bytes[0] : 0;
+			uint8_t const Byte1 = (FileSize > 1) ? Bytes[1] : 0;
+			uint8_t const Byte2 = (FileSize > 2) ? Bytes[2] : 0;
+			uint8_t const Byte3 = (FileSize > 3) ? Bytes[3] : 0;
+			if (FileSize > 3 && Byte0 == 0xEF && Byte1 == 0xBB && Byte2 == 0xBF)
+			{
+				return EFileBOM::UTF8;
+			}
+			else if (FileSize >= 2 && Byte0 == 0xFE && Byte1 == 0xFF)
+			{
+				return EFileBOM::UTF16_BE;
+			}
+			else if (FileSize >= 2 && Byte0 == 0xFF && Byte1 == 0xFE)
+			{
+				return EFileBOM::UTF16_LE;
+			}
+			else if (FileSize >= 4 && Byte0 == 0x00 && Byte1 == 0x00 && Byte2 == 0xFE && Byte3 == 0xFF)
+			{
+				return EFileBOM::UTF32_BE;
+			}
+			else if (FileSize >= 4 && Byte0 == 0xFF && Byte1 == 0xFE && Byte2 == 0x00 && Byte3 == 0x00)
+			{
+				return EFileBOM::UTF32_LE;
+			}
+			return EFileBOM::None;
 		}
-		else if (FileSize >= 2 && Byte0 == 0xFF && Byte1 == 0xFE)
+
+		/// Private (copy-on-write) mapping of a whole file: the mapped bytes can be modified, without
+		/// modifying the file.
+		class FMappedFile
 		{
-			return EFileBOM::UTF16_LE;
-		}
-		else if (FileSize >= 4 && Byte0 == 0x00 && Byte1 == 0x00 && Byte2 == 0xFE && Byte3 == 0xFF)
+		public:
+			FMappedFile() = default;
+			FMappedFile(FMappedFile const&) = delete;
+			FMappedFile& operator=(FMappedFile const&) = delete;
+			~FMappedFile() { Close(); }
+
+			/// \return false if the file could not be opened or mapped. An empty file is not mapped (Data is null).
+			bool Open(std::filesystem::path const& Filepath)
+			{
+				Close();
+#if defined(_WIN32)
+				HANDLE const File = CreateFileW(Filepath.c_str(), GENERIC_READ,
+					FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL, nullptr);
+				if (File == INVALID_HANDLE_VALUE)
+					return false;
+				LARGE_INTEGER FileSize;
+				HANDLE Mapping = nullptr;
+				bool const bHasSize = GetFileSizeEx(File, &FileSize);
+				if (bHasSize && FileSize.QuadPart > 0)
+					Mapping = CreateFileMappingW(File, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+				CloseHandle(File);
+				if (bHasSize && FileSize.QuadPart == 0)
+					return true; // empty files cannot be mapped
+				if (!Mapping)
+					return false;
+				// The view keeps a reference on the mapping object.
+				Data = static_cast<char*>(MapViewOfFile(Mapping, FILE_MAP_COPY, 0, 0, 0));
+				CloseHandle(Mapping);
+				if (!Data)
+					return false;
+				Size = static_cast<uint64_t>(FileSize.QuadPart);
+#else
+				int const File = open(Filepath.c_str(), O_RDONLY | O_CLOEXEC);
+				if (File < 0)
+					return false;
+				struct stat FileStat;
+				void* Mapped = MAP_FAILED;
+				bool const bHasSize = (fstat(File, &FileStat) == 0);
+				if (bHasSize && FileStat.st_size > 0)
+				{
+					Mapped = mmap(nullptr, static_cast<size_t>(FileStat.st_size), PROT_READ | PROT_WRITE,
+						MAP_PRIVATE, File, 0);
+				}
+				close(File);
+				if (bHasSize && FileStat.st_size == 0)
+					return true; // empty files cannot be mapped
+				if (Mapped == MAP_FAILED)
+					return false;
+				Data = static_cast<char*>(Mapped);
+				Size = static_cast<uint64_t>(FileStat.st_size);
+#endif
+				return true;
+			}
+
+			void Close()
+			{
+				if (!Data)
+					return;
+#if defined(_WIN32)
+				UnmapViewOfFile(Data);
+#else
+				munmap(Data, static_cast<size_t>(Size));
+#endif
+				Data = nullptr;
+				Size = 0;
+			}
+
+			char* Data = nullptr;
+			uint64_t Size = 0;
+		};
+
+		constexpr std::string_view ReplyKey = "\"reply\":";
+		constexpr std::u16string_view ReplyKey16 = u"\"reply\":";
+
+		/// Truncates the Json text before its "reply" member, found at ReplyPos, overwriting the comma which
+		/// precedes it (it would be an error in JSON5 in dicts), so that the result is a valid Json object.
+		std::string_view TruncateBeforeReply(char* Text, size_t const ReplyPos)
 		{
-			return EFileBOM::UTF32_BE;
+			std::string_view const Json(Text, ReplyPos);
+			size_t const Comma = Json.find_last_of(',');
+			if (std::string_view::npos == Comma)
+			{
+				BE_ISSUE("no comma");
+				return Json;
+			}
+			Text[Comma] = '}';
+			return Json.substr(0, Comma + 1);
 		}
-		else if (FileSize >= 4 && Byte0 == 0xFF && Byte1 == 0xFE && Byte2 == 0x00 && Byte3 == 0x00)
+
+		/// Note: UTF-16 code units are read in the byte order of the platform, which is little-endian on
+		/// all the platforms we support.
+		void AppendUTF16AsUTF8(std::u16string_view const Text, std::string& Out)
 		{
-			return EFileBOM::UTF32_LE;
+			Out.reserve(Out.size() + Text.size());
+			for (size_t i = 0; i < Text.size(); ++i)
+			{
+				uint32_t CodePoint = Text[i];
+				if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && i + 1 < Text.size()
+					&& Text[i + 1] >= 0xDC00 && Text[i + 1] <= 0xDFFF)
+				{
+					CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Text[i + 1] - 0xDC00);
+					++i;
+				}
+				if (CodePoint < 0x80)
+				{
+					Out += static_cast<char>(CodePoint);
+				}
+				else if (CodePoint < 0x800)
+				{
+					Out += static_cast<char>(0xC0 | (CodePoint >> 6));
+					Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+				}
+				else if (CodePoint < 0x10000)
+				{
+					Out += static_cast<char>(0xE0 | (CodePoint >> 12));
+					Out += static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F));
+					Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+				}
+				else
+				{
+					Out += static_cast<char>(0xF0 | (CodePoint >> 18));
+					Out += static_cast<char>(0x80 | ((CodePoint >> 12) & 0x3F));
+					Out += static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F));
+					Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+				}
+			}
 		}
-		return EFileBOM::None;
+
+	} // ns anonymous
+
+	EFileBOM HasBOM(std::filesystem::path const& Filepath, uint64_t& FileSize)
+	{
+		std::ifstream Ifs(Filepath, std::ios_base::ate | std::ios_base::binary);
+		if (!Ifs.good())
+			return EFileBOM::Unknown;
+		std::streamoff const FileOffset = Ifs.tellg();
+		if (FileOffset <= 0)
+			return EFileBOM::Unknown;
+		FileSize = static_cast<uint64_t>(FileOffset);
+		uint8_t Bytes[4] = {};
+		Ifs.seekg(0);
+		Ifs.read(reinterpret_cast<char*>(Bytes), static_cast<std::streamsize>(std::min<uint64_t>(FileSize, 4)));
+		return DetectBOM(Bytes, FileSize);
 	}
 
-	std::string LoadCacheFileToStringWithoutReply(std::filesystem::path const& Filepath)
+	class CacheFileWithoutReply::Impl
+	{
+	public:
+		FMappedFile File;
+		/// UTF-8 conversion of the Json, for UTF-16 files only
+		std::string ConvertedJson;
+		std::string_view Json;
+		EFileBOM BOM = EFileBOM::Unknown;
+	};
+
+	CacheFileWithoutReply::CacheFileWithoutReply()
+		: impl_(std::make_unique<Impl>())
 	{
-		uint64_t FileSize;
-		EFileBOM const BOM = HasBOM(Filepath, FileSize);
-		switch (BOM)
+	}
+
+	CacheFileWithoutReply::~CacheFileWithoutReply() = default;
+	CacheFileWithoutReply::CacheFileWithoutReply(CacheFileWithoutReply&&) noexcept = default;
+	CacheFileWithoutReply& CacheFileWithoutReply::operator=(CacheFileWithoutReply&&) noexcept = default;
+
+	bool CacheFileWithoutReply::Load(std::filesystem::path const& Filepath)
+	{
+		impl_ = std::make_unique<Impl>();
+		Impl& Self = *impl_;
+		if (!Self.File.Open(Filepath))
+		{
+			BE_LOGE("AdvVizSDK", "Cannot open cache file " << Filepath.string());
+			return false;
+		}
+		if (Self.File.Size == 0)
+		{
+			// Eg. a file whose writing was interrupted: it is simply ignored.
+			BE_LOGW("AdvVizSDK", "Empty cache file " << Filepath.string());
+			return false;
+		}
+		char* const Data = Self.File.Data;
+		uint64_t const FileSize = Self.File.Size;
+		Self.BOM = DetectBOM(reinterpret_cast<uint8_t const*>(Data), FileSize);
+		switch (Self.BOM)
 		{
 		case EFileBOM::UTF16_BE:
 		case EFileBOM::UTF32_BE:
@@ -80,74 +266,72 @@ namespace AdvViz::SDK::Tools
 		case EFileBOM::UTF8:
 		case EFileBOM::None:
 		{
-			std::ifstream Ifs(Filepath);
-			if (EFileBOM::UTF8 == BOM)
-			{
-				// No, codecvt_utf8 is for conversion to UCS2 or UTF-32...
-				//Ifs.imbue(std::locale(Ifs.getloc(), new std::codecvt_utf8<char, std::consume_header>));
-				Ifs.get(); Ifs.get(); Ifs.get(); // just skip the BOM
-			}
-			std::string FileString, Line;
-			FileString.reserve(FileSize + 32);
-			while (std::getline(Ifs, Line))
-			{
-				// cheat: don't read reply at all - see doc on FRflReply class
-				if (std::string::npos == Line.find("\"reply\":"))
-				{
-					FileString += Line;
-				}
-				else
-				{
-					// Need to overwrite the trailing comma, it is an error in JSON5 in dicts
-					auto const Comma = FileString.find_last_of(',');
-					if (std::string::npos == Comma)
-					{
-						BE_ISSUE("no comma");
-					}
-					else
-					{
-						FileString[Comma] = '}';
-					}
-					break;
-				}
-			}
-			return FileString;
+			size_t const BOMSize = (EFileBOM::UTF8 == Self.BOM) ? 3 : 0; // just skip the BOM
+			char* const Text = Data + BOMSize;
+			std::string_view const Json(Text, static_cast<size_t>(FileSize) - BOMSize);
+			// Single scan, which stops at the reply: its pages are never read from the disk.
+			size_t const ReplyPos = Json.find(ReplyKey);
+			Self.Json = (std::string_view::npos == ReplyPos) ? Json : TruncateBeforeReply(Text, ReplyPos);
+			return true;
 		}
 		// this is the one I really need, at least on Windows, because apparently UE Json writer will use this
 		// assumedly when non-ascii characters are encountered.
 		case EFileBOM::UTF16_LE:
 		{
-			// open as a byte stream
-			std::wifstream Ifs(Filepath, std::ios::binary);
-			// apply BOM-sensitive UTF-16 facet
-			Ifs.imbue(std::locale(Ifs.getloc(),
-				new std::codecvt_utf16<wchar_t, /*MaxCode default:*/0x10ffff, std::consume_header>));
-			std::wstring FileString, Line;
-			FileString.reserve(FileSize / 2 + 32);
-			while (std::getline(Ifs, Line))
-			{
-				if (std::wstring::npos == Line.find(L"\"reply\":"))
-				{
-					FileString += Line;
-				}
-				else
-				{
-					auto const Comma = FileString.find_last_of(L',');
-					if (std::wstring::npos == Comma)
-					{
-						BE_ISSUE("no comma");
-					}
-					else
-					{
-						FileString[Comma] = '}';
-					}
-					break;
-				}
-			}
-			return std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.to_bytes(FileString);
+			// The mapping is page-aligned, so the code units following the BOM are properly aligned.
+			std::u16string_view const Text(reinterpret_cast<char16_t const*>(Data + 2),
+				static_cast<size_t>(FileSize - 2) / 2);
+			size_t const ReplyPos = Text.find(ReplyKey16);
+			// Only convert the part preceding the reply.
+			AppendUTF16AsUTF8(Text.substr(0, ReplyPos), Self.ConvertedJson);
+			Self.Json = (std::u16string_view::npos == ReplyPos) ? std::string_view(Self.ConvertedJson)
+				: TruncateBeforeReply(Self.ConvertedJson.data(), Self.ConvertedJson.size());
+			// The mapping is not needed anymore.
+			Self.File.Close();
+			return true;
+		}
 		}
+		Self.File.Close();
+		return false;
+	}
+
+	std::string_view CacheFileWithoutReply::GetJson() const
+	{
+		return impl_ ? impl_->Json : std::string_view();
+	}
+
+	EFileBOM CacheFileWithoutReply::GetBOM() const
+	{
+		return impl_ ? impl_->BOM : EFileBOM::Unknown;
+	}
+
+	std::string LoadCacheFileToStringWithoutReply(std::filesystem::path const& Filepath)
+	{
+		CacheFileWithoutReply File;
+		if (!File.Load(Filepath))
+			return {};
+		return std::string(File.GetJson());
+	}
+
+	std::vector<CacheFileWithoutReply> LoadCacheFilesWithoutReply(std::vector<std::filesystem::path> const& Filepaths)
+	{
+		std::vector<CacheFileWithoutReply> Files(Filepaths.size());
+		// Loading one file takes a few microseconds only: group them to amortize the cost of scheduling tasks.
+		constexpr size_t FilesPerTask = 64;
+		std::vector<std::shared_ptr<ITask>> Tasks;
+		Tasks.reserve(Filepaths.size() / FilesPerTask + 1);
+		for (size_t Begin = 0; Begin < Filepaths.size(); Begin += FilesPerTask)
+		{
+			size_t const End = std::min(Begin + FilesPerTask, Filepaths.size());
+			Tasks.push_back(GetTaskManager().AddTask([&Files, &Filepaths, Begin, End]()
+				{
+					for (size_t i = Begin; i < End; ++i)
+						Files[i].Load(Filepaths[i]);
+				},
+				ITaskManager::EType::background));
 		}
-		return {};
+		WaitTasks(Tasks);
+		return Files;
 	}
 
 } // ns. AdvViz::SDK::Tools
@@ -10,6 +10,10 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "../AdvVizLinkType.h"
 
 namespace AdvViz::SDK::Tools
@@ -27,8 +31,37 @@ namespace AdvViz::SDK::Tools
 
 	ADVVIZ_LINK EFileBOM HasBOM(std::filesystem::path const& filepath, uint64_t& fileSize);
 
+	/// Json content of a cache file, truncated before its `"reply":` member, which is most of the file
+	/// (see LoadCacheFileToStringWithoutReply).
+	/// The file is memory-mapped (copy-on-write): for UTF-8 files, with or without BOM, the Json is a view
+	/// into the mapping, where only the comma preceding the reply is overwritten, so the pages of the reply
+	/// are never read. UTF-16 LE files are converted to UTF-8, up to the reply.
+	class ADVVIZ_LINK CacheFileWithoutReply
+	{
+	public:
+		CacheFileWithoutReply();
+		~CacheFileWithoutReply();
+		CacheFileWithoutReply(CacheFileWithoutReply&&) noexcept;
+		CacheFileWithoutReply& operator=(CacheFileWithoutReply&&) noexcept;
+
+		/// \return false if the file could not be opened, is empty, or has an unsupported encoding.
+		bool Load(std::filesystem::path const& filepath);
+		/// Valid as long as this object is alive and not reloaded. Empty if Load failed.
+		std::string_view GetJson() const;
+		EFileBOM GetBOM() const;
+
+	private:
+		class Impl;
+		std::unique_ptr<Impl> impl_;
+	};
+
 	/// Load the full content of a file in a string, dealing with different encoding formats, while
 	/// discarding the `"reply":` prefix the file may start with.
 	/// (Very specific to the way we cache Json replies in the iTwin schedule cache mechanism...)
 	ADVVIZ_LINK std::string LoadCacheFileToStringWithoutReply(std::filesystem::path const& Filepath);
+
+	/// Loads the given cache files in parallel, using the task manager. The result has one entry per file,
+	/// in the same order; the Json of the files which could not be loaded is empty.
+	ADVVIZ_LINK std::vector<CacheFileWithoutReply> LoadCacheFilesWithoutReply(
+		std::vector<std::filesystem::path> const& filepaths);
 }
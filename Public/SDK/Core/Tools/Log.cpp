@@ -9,8 +9,12 @@
 
 #include <catch2/catch_session.hpp>
 #include <array>
+#include <chrono>
+#include <exception>
 #include <filesystem>
+#include <mutex>
 #include <shared_mutex>
+#include <thread>
 #define PLOG_ENABLE_WCHAR_INPUT 1
 #define PLOG_CHAR_IS_UTF8 1
 #include "Log.h"
@@ -21,6 +25,7 @@
 #include "plog/Formatters/TxtFormatter.h"
 
 #include "LockableObject.h"
+#include "MPSCRingBuffer.h"
 #include "Assert.h"
 #include "CrashInfo.h"
 #include "../Singleton/singleton.h"
@@ -45,12 +50,220 @@ namespace AdvViz::SDK::Tools::Internal
 #endif 
 
 namespace AdvViz::SDK::Tools::Internal
-{ 
+{
+	/// Message captured by the thread calling BE_LOG, and written by the log writer thread.
+	struct LogRecord
+	{
+		plog::util::Time time = {};
+		unsigned int tid = 0;
+		plog::Severity severity = plog::none;
+		// Pointers to string literals (__FILE__, __FUNCTION__)
+		const char* srcPath = nullptr;
+		const char* func = nullptr;
+		int line = 0;
+		std::string channel;
+		std::string msg;
+	};
+
+	/// plog record reporting the time and thread of the BE_LOG call, instead of those of the writer thread.
+	class DeferredRecord : public plog::Record
+	{
+	public:
+		explicit DeferredRecord(LogRecord const& rec)
+			: plog::Record(rec.severity, rec.func, (size_t)rec.line, rec.srcPath, nullptr, PLOG_DEFAULT_INSTANCE_ID)
+			, time_(rec.time)
+			, tid_(rec.tid)
+		{}
+
+		const plog::util::Time& getTime() const override { return time_; }
+		unsigned int getTid() const override { return tid_; }
+
+	private:
+		plog::util::Time time_;
+		unsigned int tid_;
+	};
+
+	/// Writes the messages queued by the logging threads to the plog appenders, from a background thread,
+	/// so that logging threads never wait for file or console I/O.
+	class AsyncLogWriter
+	{
+	public:
+		AsyncLogWriter(plog::Logger<PLOG_DEFAULT_INSTANCE_ID>& logger, AsyncLogOptions const& options)
+			: logger_(logger)
+			, queue_(options.queueCapacity)
+		{
+			SetOptions(options);
+			thread_ = std::thread([this]() { Run(); });
+		}
+
+		/// Writes the remaining messages and joins the writer thread. Called by ShutdownLog, never from the
+		/// writer thread itself.
+		void Stop()
+		{
+			if (std::this_thread::get_id() == thread_.get_id())
+				return;
+			stop_ = true;
+			WakeUp();
+			if (thread_.joinable())
+				thread_.join();
+			// In case the thread was terminated before it could write everything.
+			Drain();
+		}
+
+		/// Fallback for when ShutdownLog was not called: joining from a static destructor can deadlock (under
+		/// the loader lock when the library is unloaded), so the thread is only asked to stop and detached.
+		/// Returns false if the thread may still use this object, which must then be leaked.
+		bool Abandon()
+		{
+			if (!thread_.joinable())
+				return true;
+			stop_ = true;
+			WakeUp();
+			thread_.detach();
+			return false;
+		}
+
+		void SetOptions(AsyncLogOptions const& options)
+		{
+			bool const wasEnabled = enabled_.exchange(options.enabled);
+			overflowPolicy_ = options.overflowPolicy;
+			// Once no new message can be queued, write the pending ones, to keep the order of the messages
+			// logged synchronously from now on.
+			if (!options.enabled && wasEnabled)
+				Flush();
+		}
+
+		bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed) && !stop_.load(std::memory_order_relaxed); }
+
+		void Push(std::string const& channel, std::string const& msg, plog::Severity sev,
+			const char* srcPath, const char* func, int line)
+		{
+			auto const fill = [&](LogRecord& rec)
+			{
+				plog::util::ftime(&rec.time);
+				rec.tid = plog::util::gettid();
+				rec.severity = sev;
+				rec.srcPath = srcPath;
+				rec.func = func;
+				rec.line = line;
+				rec.channel.assign(channel);
+				rec.msg.assign(msg);
+			};
+			while (!queue_.TryPush(fill))
+			{
+				if (overflowPolicy_ == LogOverflowPolicy::drop || stop_)
+				{
+					++dropped_;
+					return;
+				}
+				WakeUp();
+				std::this_thread::yield();
+			}
+			// Paired with the fence in Run: either the writer sees the new message before going idle,
+			// or we see it idle and wake it up.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (idle_.load(std::memory_order_relaxed))
+				WakeUp();
+		}
+
+		void Flush()
+		{
+			if (std::this_thread::get_id() == thread_.get_id())
+				return;
+			size_t const target = queue_.NumPushed();
+			WakeUp();
+			// Bounded wait, as this is also called when the process is crashing, maybe from the writer
+			// thread's own failure.
+			auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (written_.load(std::memory_order_acquire) < target
+				&& std::chrono::steady_clock::now() < deadline)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+
+	private:
+		void Run()
+		{
+			while (true)
+			{
+				if (Drain() > 0)
+					continue;
+				if (stop_)
+					break;
+				uint32_t const wakeUps = wakeUps_.load();
+				idle_.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (queue_.IsEmpty() && !stop_)
+					wakeUps_.wait(wakeUps);
+				idle_.store(false, std::memory_order_relaxed);
+			}
+		}
+
+		size_t Drain()
+		{
+			// Do not keep the memory of exceptionally long messages in the queue's slots.
+			constexpr size_t MaxRetainedCapacity = 64 * 1024;
+			size_t count = 0;
+			while (queue_.TryPop([this](LogRecord& rec)
+				{
+					Write(rec);
+					if (rec.msg.capacity() > MaxRetainedCapacity)
+						std::string().swap(rec.msg);
+				}))
+			{
+				++count;
+			}
+			if (size_t const dropped = dropped_.exchange(0); dropped > 0)
+			{
+				LogRecord rec;
+				plog::util::ftime(&rec.time);
+				rec.tid = plog::util::gettid();
+				rec.severity = plog::warning;
+				rec.srcPath = __FILE__;
+				rec.func = __FUNCTION__;
+				rec.line = __LINE__;
+				rec.channel = "AdvVizSDK";
+				rec.msg = std::to_string(dropped) + " log messages were dropped (queue full)";
+				Write(rec);
+			}
+			written_.store(queue_.NumPopped(), std::memory_order_release);
+			return count;
+		}
+
+		void Write(LogRecord const& rec)
+		{
+			DeferredRecord record(rec);
+			logger_ += record.ref() << "[" << rec.channel << "] " << rec.msg;
+		}
+
+		void WakeUp()
+		{
+			wakeUps_.fetch_add(1);
+			wakeUps_.notify_one();
+		}
+
+		plog::Logger<PLOG_DEFAULT_INSTANCE_ID>& logger_;
+		MPSCRingBuffer<LogRecord> queue_;
+		std::atomic<bool> enabled_ = true;
+		std::atomic<LogOverflowPolicy> overflowPolicy_ = LogOverflowPolicy::block;
+		std::atomic<bool> stop_ = false;
+		std::atomic<bool> idle_ = false;
+		std::atomic<uint32_t> wakeUps_ = 0;
+		std::atomic<size_t> written_ = 0;
+		std::atomic<size_t> dropped_ = 0;
+		std::thread thread_;
+	};
+
 	struct LogGlobals
 	{
 		plog::Logger<PLOG_DEFAULT_INSTANCE_ID>* plog_;
 		RWLockableObject<std::unordered_map<std::uint64_t, ILogPtr>, std::shared_mutex> logMap;
 		std::atomic<bool> logInitialized = false;
+		LockableObject<AsyncLogOptions, std::mutex> asyncLogOptions;
+		// Set by InitLog, reset by ShutdownLog (or when the writer is destroyed at exit).
+		std::atomic<AsyncLogWriter*> asyncLogWriter = nullptr;
+		std::terminate_handler previousTerminateHandler = nullptr;
 		LogGlobals()
 		{
 			static plog::Logger<PLOG_DEFAULT_INSTANCE_ID> logger(plog::verbose); // should be ok because LogGlobals() is called only once
@@ -78,6 +291,12 @@ namespace AdvViz::SDK::Tools
 	void Log::DoLog(const std::string& msg, Level lev, const char* srcPath, const char* func, int line)
 	{
 		plog::Severity sev(g_LevelToSeverity[int(lev)]);
+		Internal::AsyncLogWriter* asyncLogWriter = Internal::GetLogGlobals().asyncLogWriter.load(std::memory_order_acquire);
+		if (asyncLogWriter && asyncLogWriter->IsEnabled())
+		{
+			asyncLogWriter->Push(name_, msg, sev, srcPath, func, line);
+			return;
+		}
 		(*Internal::GetLogGlobals().plog_) += plog::Record(sev, func, line, srcPath, nullptr, PLOG_DEFAULT_INSTANCE_ID).ref() << "[" << name_ << "] " << msg;
 	}
 
@@ -138,6 +357,32 @@ namespace AdvViz::SDK::Tools
 
 			auto& appender = Internal::GetLogGlobals().plog_->addAppender(&consoleAppender).addAppender(&fileAppender);
 			Internal::AddVSDebugOutput(appender);
+
+			// Created after the appenders, so that it is destroyed before them. The writer thread is stopped
+			// and joined by ShutdownLog: the destructor only detaches it if ShutdownLog was not called.
+			struct AsyncLogWriterHolder
+			{
+				std::unique_ptr<Internal::AsyncLogWriter> writer;
+				AsyncLogWriterHolder()
+					: writer(std::make_unique<Internal::AsyncLogWriter>(*Internal::GetLogGlobals().plog_, GetAsyncLogOptions()))
+				{
+					Internal::GetLogGlobals().asyncLogWriter = writer.get();
+				}
+				~AsyncLogWriterHolder()
+				{
+					Internal::GetLogGlobals().asyncLogWriter = nullptr;
+					if (!writer->Abandon())
+						(void)writer.release();
+				}
+			};
+			static AsyncLogWriterHolder asyncLogWriterHolder;
+			Internal::GetLogGlobals().previousTerminateHandler = std::set_terminate([]()
+			{
+				FlushLog();
+				if (Internal::GetLogGlobals().previousTerminateHandler)
+					Internal::GetLogGlobals().previousTerminateHandler();
+				std::abort();
+			});
 			Internal::GetLogGlobals().logInitialized = true;
 			CreateLogChannel("AdvVizSDK", Level::info);
 		}
@@ -148,6 +393,35 @@ namespace AdvViz::SDK::Tools
 		return Internal::GetLogGlobals().logInitialized;
 	}
 
+	void SetAsyncLogOptions(AsyncLogOptions const& options)
+	{
+		{
+			auto asyncLogOptions(Internal::GetLogGlobals().asyncLogOptions.GetAutoLock());
+			asyncLogOptions.Get() = options;
+		}
+		if (auto* asyncLogWriter = Internal::GetLogGlobals().asyncLogWriter.load())
+			asyncLogWriter->SetOptions(options);
+	}
+
+	AsyncLogOptions GetAsyncLogOptions()
+	{
+		auto asyncLogOptions(Internal::GetLogGlobals().asyncLogOptions.GetAutoLock());
+		return asyncLogOptions.Get();
+	}
+
+	void FlushLog()
+	{
+		if (auto* asyncLogWriter = Internal::GetLogGlobals().asyncLogWriter.load())
+			asyncLogWriter->Flush();
+	}
+
+	void ShutdownLog()
+	{
+		// From now on, messages are written synchronously.
+		if (auto* asyncLogWriter = Internal::GetLogGlobals().asyncLogWriter.exchange(nullptr))
+			asyncLogWriter->Stop();
+	}
+
 	ILogPtr GetLog(const std::uint64_t channel, const char* name)
 	{
 		{
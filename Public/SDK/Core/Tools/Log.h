@@ -12,8 +12,11 @@
 #include "FactoryClass.h"
 #include "Extension.h"
 #include "Hash.h"
+#include <algorithm>
 #include <string>
+#include <string_view>
 #include <memory>
+#include <optional>
 #include <sstream>
 
 namespace AdvViz::SDK::Tools
@@ -42,6 +45,87 @@ namespace AdvViz::SDK::Tools
 
 	typedef std::shared_ptr<ILog> ILogPtr;
 
+	enum class LogOverflowPolicy
+	{
+		block,	// the logging thread waits for the writer thread to free a slot
+		drop	// the message is dropped; the number of dropped messages is logged later
+	};
+
+	struct AsyncLogOptions
+	{
+		// When enabled, the messages logged through the Log class are queued and written to the log
+		// appenders (file, console...) by a background thread, once InitLog has been called.
+		bool enabled = true;
+		// Number of messages the queue can hold. Only read by InitLog.
+		size_t queueCapacity = 4096;
+		LogOverflowPolicy overflowPolicy = LogOverflowPolicy::block;
+	};
+
+	/// Stream used by BE_LOG to format a message. The stream and resulting string of the calling thread are
+	/// reused from one message to the next, so that logging does not allocate once their buffers have grown.
+	/// A nested BE_LOG (typically from an operator<< used in the message) gets its own stream.
+	class LogStream
+	{
+	public:
+		LogStream()
+		{
+			Cache& cache = GetCache();
+			if (!cache.inUse)
+			{
+				cache.inUse = true;
+				cache_ = &cache;
+				static const std::ios defaultFormat(nullptr);
+				cache.stream.copyfmt(defaultFormat);
+				cache.stream.clear();
+				cache.stream.seekp(0);
+			}
+			else
+				ownStream_.emplace();
+		}
+
+		~LogStream()
+		{
+			if (cache_)
+				cache_->inUse = false;
+		}
+
+		LogStream(LogStream const&) = delete;
+		LogStream& operator=(LogStream const&) = delete;
+
+		std::ostream& Get() { return cache_ ? cache_->stream : *ownStream_; }
+
+		std::string const& Str()
+		{
+			if (!cache_)
+			{
+				ownText_ = ownStream_->str();
+				return ownText_;
+			}
+			// The stream buffer may still hold the end of a longer, previous message.
+			std::string_view const text = cache_->stream.view();
+			cache_->text.assign(text.data(), std::min(text.size(), (size_t)cache_->stream.tellp()));
+			return cache_->text;
+		}
+
+	private:
+		struct Cache
+		{
+			std::ostringstream stream;
+			std::string text;
+			bool inUse = false;
+		};
+
+		static Cache& GetCache()
+		{
+			thread_local Cache cache;
+			return cache;
+		}
+
+		Cache* cache_ = nullptr;
+		std::optional<std::ostringstream> ownStream_;
+		std::string ownText_;
+	};
+
 	class Log : public ILog, public Tools::ExtensionSupport, Tools::TypeId<Log>
 	{
 	public:
@@ -68,6 +152,17 @@ namespace AdvViz::SDK::Tools
 	ADVVIZ_LINK void CreateAdvVizLogChannels();
 
 	ADVVIZ_LINK ILogPtr GetLog(const std::uint64_t channel, const char* name);
+
+	// To be called before InitLog, except for enabled and overflowPolicy which can be changed at any time.
+	ADVVIZ_LINK void SetAsyncLogOptions(AsyncLogOptions const& options);
+	ADVVIZ_LINK AsyncLogOptions GetAsyncLogOptions();
+	// Wait until all queued messages have been written (or a few seconds at most). It is called when the
+	// process terminates or aborts after a failed assertion.
+	ADVVIZ_LINK void FlushLog();
+	// Write the queued messages and stop the background writer thread; later messages are written synchronously.
+	// To be called when the SDK is torn down (eg. when the module using it is shut down), and not from a static
+	// destructor, where joining the thread could deadlock.
+	ADVVIZ_LINK void ShutdownLog();
 }
 
 #define BE_GETLOG(channel) (AdvViz::SDK::Tools::GetLog(GenHashCT(channel), channel))
@@ -75,9 +170,9 @@ namespace AdvViz::SDK::Tools
 #define BE_LOG(lev, channel, message) { \
 	static auto l_log = BE_GETLOG(channel); \
 	if(l_log && l_log->Enabled(lev)) { \
-		std::ostringstream log_stream; \
-		log_stream << message; \
-		l_log->DoLog(log_stream.str(), lev, __FILE__, __FUNCTION__, __LINE__); } \
+		AdvViz::SDK::Tools::LogStream log_stream; \
+		log_stream.Get() << message; \
+		l_log->DoLog(log_stream.Str(), lev, __FILE__, __FUNCTION__, __LINE__); } \
 	}
 
 #ifdef RELEASE_CONFIG
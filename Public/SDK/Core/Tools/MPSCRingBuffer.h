@@ -0,0 +1,116 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: MPSCRingBuffer.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace AdvViz::SDK::Tools
+{
+	/** Bounded lock-free queue with multiple producers and a single consumer.
+	 * Each slot carries a sequence number telling whether it is free for the producer of a given turn, or
+	 * filled for the consumer (D. Vyukov's bounded queue). Slots are filled and read in place, so that
+	 * their value (eg. a std::string) keeps its capacity from one turn to the next:
+	 * @code
+	 * MPSCRingBuffer<std::string> queue(1024);
+	 * queue.TryPush([&](std::string& slot) { slot.assign(text); }); // any thread
+	 * queue.TryPop([&](std::string& slot) { Write(slot); });        // consumer thread only
+	 * @endcode
+	 */
+	template<typename T>
+	class MPSCRingBuffer
+	{
+	public:
+		/// \param capacity Rounded up to a power of two.
+		explicit MPSCRingBuffer(size_t capacity)
+		{
+			size_t roundedCapacity = 2;
+			while (roundedCapacity < capacity)
+				roundedCapacity *= 2;
+			mask_ = roundedCapacity - 1;
+			slots_.reset(new Slot[roundedCapacity]);
+			for (size_t i = 0; i < roundedCapacity; ++i)
+				slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		MPSCRingBuffer(MPSCRingBuffer const&) = delete;
+		MPSCRingBuffer& operator=(MPSCRingBuffer const&) = delete;
+
+		/// Reserves a slot and calls fillFct(T&) on it. Can be called from any thread.
+		/// \return false, without calling fillFct, if the queue is full.
+		template<typename TFillFct>
+		bool TryPush(TFillFct&& fillFct)
+		{
+			size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+			Slot* slot = nullptr;
+			for (;;)
+			{
+				slot = &slots_[pos & mask_];
+				size_t const seq = slot->sequence.load(std::memory_order_acquire);
+				std::intptr_t const diff = (std::intptr_t)seq - (std::intptr_t)pos;
+				if (diff == 0)
+				{
+					if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+					return false; // the consumer has not read this slot yet
+				else
+					pos = enqueuePos_.load(std::memory_order_relaxed);
+			}
+			fillFct(slot->value);
+			slot->sequence.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Calls readFct(T&) on the oldest filled slot, then frees the slot. Consumer thread only.
+		/// \return false if no slot is ready to be read.
+		template<typename TReadFct>
+		bool TryPop(TReadFct&& readFct)
+		{
+			size_t const pos = dequeuePos_.load(std::memory_order_relaxed);
+			Slot& slot = slots_[pos & mask_];
+			if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+				return false;
+			readFct(slot.value);
+			slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+			dequeuePos_.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		/// Whether the oldest slot is ready to be read. Consumer thread only.
+		bool IsEmpty() const
+		{
+			size_t const pos = dequeuePos_.load(std::memory_order_relaxed);
+			return slots_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+		}
+
+		size_t Capacity() const { return mask_ + 1; }
+		/// Number of slots reserved by producers since the creation of the queue.
+		size_t NumPushed() const { return enqueuePos_.load(std::memory_order_acquire); }
+		/// Number of slots read by the consumer since the creation of the queue.
+		size_t NumPopped() const { return dequeuePos_.load(std::memory_order_acquire); }
+
+	private:
+		static constexpr size_t CacheLineSize = 64;
+
+		struct alignas(CacheLineSize) Slot
+		{
+			std::atomic<size_t> sequence;
+			T value;
+		};
+
+		std::unique_ptr<Slot[]> slots_;
+		size_t mask_ = 0;
+		alignas(CacheLineSize) std::atomic<size_t> enqueuePos_ = 0;
+		alignas(CacheLineSize) std::atomic<size_t> dequeuePos_ = 0;
+	};
+}
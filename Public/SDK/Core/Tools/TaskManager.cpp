@@ -11,36 +11,406 @@
 #include "TaskManager.h"
 #include "Core/Tools/FactoryClassInternalHelper.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace AdvViz::SDK::Tools {
 
 	DEFINEFACTORYGLOBALS(Task);
-	
+
+	class Task::Impl
+	{
+	public:
+		std::atomic<bool> completed_ = false;
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		std::function<bool()> waitHelper_;
+	};
+
+	Task::Task():impl_(new Impl())
+	{
+	}
+
+	Task::~Task()
+	{
+	}
+
 	bool Task::IsCompleted()
 	{
-		return true;
+		return GetImpl().completed_.load(std::memory_order_acquire);
 	}
 
-	void Task::Wait(){
-		return;
-	};
+	void Task::Wait()
+	{
+		Impl& impl = GetImpl();
+		while (!impl.completed_.load(std::memory_order_acquire))
+		{
+			if (impl.waitHelper_ && impl.waitHelper_())
+				continue;
+			// Nothing to help with: sleep until completion, but wake up from time to time since
+			// new tasks (on which ours may depend) can be added meanwhile.
+			std::unique_lock<std::mutex> lock(impl.mutex_);
+			impl.cv_.wait_for(lock, std::chrono::milliseconds(1), [&impl]() {
+				return impl.completed_.load(std::memory_order_acquire);
+				});
+		}
+	}
+
+	void Task::SetCompleted()
+	{
+		Impl& impl = GetImpl();
+		{
+			std::lock_guard<std::mutex> lock(impl.mutex_);
+			impl.completed_.store(true, std::memory_order_release);
+		}
+		impl.cv_.notify_all();
+	}
+
+	void Task::SetWaitHelper(std::function<bool()> const& helper)
+	{
+		GetImpl().waitHelper_ = helper;
+	}
+
+	Task::Impl& Task::GetImpl()
+	{
+		return *impl_;
+	}
+
+	const Task::Impl& Task::GetImpl() const
+	{
+		return *impl_;
+	}
+
+	namespace
+	{
+		struct PendingTask
+		{
+			std::function<void()> fct_;
+			std::shared_ptr<Task> task_;
+		};
+
+		void RunPendingTask(PendingTask& pending)
+		{
+			try
+			{
+				pending.fct_();
+			}
+			catch (std::exception& e)
+			{
+				BE_LOGE("AdvVizSDK", "Task raised an exception: " << e.what());
+			}
+			pending.task_->SetCompleted();
+		}
+
+		// foreground high, background high, foreground normal, background normal, foreground low, background low
+		constexpr std::size_t QueueLevelCount = 6;
+
+		std::size_t GetQueueLevel(ITaskManager::EType type, ITaskManager::EPriority priority)
+		{
+			std::size_t level = 0;
+			switch (priority)
+			{
+			case ITaskManager::EPriority::high: level = 0; break;
+			case ITaskManager::EPriority::normal: level = 2; break;
+			case ITaskManager::EPriority::low: level = 4; break;
+			}
+			if (type == ITaskManager::EType::background)
+				++level;
+			return level;
+		}
+
+		// One queue per priority level. The owner pushes and pops at the back (LIFO, cache friendly),
+		// other threads steal from the front (oldest tasks first).
+		class WorkQueue
+		{
+		public:
+			void Push(PendingTask&& pending, std::size_t level)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				levels_[level].emplace_back(std::move(pending));
+			}
+
+			bool Pop(PendingTask& pending, std::size_t level, bool bSteal)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				auto& queue = levels_[level];
+				if (queue.empty())
+					return false;
+				if (bSteal)
+				{
+					pending = std::move(queue.front());
+					queue.pop_front();
+				}
+				else
+				{
+					pending = std::move(queue.back());
+					queue.pop_back();
+				}
+				return true;
+			}
+
+		private:
+			std::mutex mutex_;
+			std::array<std::deque<PendingTask>, QueueLevelCount> levels_;
+		};
+
+		class ThreadPool
+		{
+		public:
+			ThreadPool(std::size_t workerCount)
+				: queues_(workerCount + 1)
+			{
+			}
+
+			~ThreadPool()
+			{
+				BE_ASSERT(workers_.empty(), "ThreadPool::Stop must be called before destruction");
+			}
+
+			void Start()
+			{
+				std::size_t workerCount = queues_.size() - 1;
+				workers_.reserve(workerCount);
+				for (std::size_t i = 0; i < workerCount; ++i)
+					workers_.emplace_back([this, i]() { WorkerLoop(i); });
+			}
+
+			void Stop()
+			{
+				{
+					std::lock_guard<std::mutex> lock(sleepMutex_);
+					bStop_ = true;
+				}
+				sleepCv_.notify_all();
+				for (auto& worker : workers_)
+					worker.join();
+				workers_.clear();
+			}
+
+			void Push(PendingTask&& pending, std::size_t level)
+			{
+				// Tasks added from a worker of this pool go to its own queue, others go to the shared one.
+				std::size_t queueIndex = (t_currentPool == this) ? t_currentWorker : queues_.size() - 1;
+				queues_[queueIndex].Push(std::move(pending), level);
+				pendingCount_.fetch_add(1, std::memory_order_release);
+				{
+					// Taking the lock avoids missing the wake-up of a worker about to sleep.
+					std::lock_guard<std::mutex> lock(sleepMutex_);
+				}
+				sleepCv_.notify_one();
+			}
+
+			// Run one pending task, if any. Can be called from any thread.
+			bool TryRunOne()
+			{
+				PendingTask pending;
+				if (!TryPop(pending))
+					return false;
+				RunPendingTask(pending);
+				return true;
+			}
+
+		private:
+			bool TryPop(PendingTask& pending)
+			{
+				if (pendingCount_.load(std::memory_order_acquire) == 0)
+					return false;
+				bool const bIsWorker = (t_currentPool == this);
+				std::size_t const ownIndex = bIsWorker ? t_currentWorker : queues_.size() - 1;
+				for (std::size_t level = 0; level < QueueLevelCount; ++level)
+				{
+					if (queues_[ownIndex].Pop(pending, level, !bIsWorker))
+					{
+						pendingCount_.fetch_sub(1, std::memory_order_acq_rel);
+						return true;
+					}
+					// steal, starting from our neighbour to spread contention
+					for (std::size_t i = 1; i < queues_.size(); ++i)
+					{
+						std::size_t const victim = (ownIndex + i) % queues_.size();
+						if (queues_[victim].Pop(pending, level, true))
+						{
+							pendingCount_.fetch_sub(1, std::memory_order_acq_rel);
+							return true;
+						}
+					}
+				}
+				return false;
+			}
+
+			void WorkerLoop(std::size_t index)
+			{
+				t_currentPool = this;
+				t_currentWorker = index;
+				for (;;)
+				{
+					if (TryRunOne())
+						continue;
+					std::unique_lock<std::mutex> lock(sleepMutex_);
+					sleepCv_.wait(lock, [this]() {
+						return bStop_ || pendingCount_.load(std::memory_order_acquire) > 0;
+						});
+					if (bStop_ && pendingCount_.load(std::memory_order_acquire) == 0)
+						break;
+				}
+				t_currentPool = nullptr;
+			}
+
+			static thread_local ThreadPool* t_currentPool;
+			static thread_local std::size_t t_currentWorker;
+
+			// one queue per worker, plus the shared one (last) for tasks added by other threads
+			std::vector<WorkQueue> queues_;
+			std::vector<std::thread> workers_;
+			std::atomic<std::size_t> pendingCount_ = 0;
+			std::mutex sleepMutex_;
+			std::condition_variable sleepCv_;
+			bool bStop_ = false;
+		};
+
+		thread_local ThreadPool* ThreadPool::t_currentPool = nullptr;
+		thread_local std::size_t ThreadPool::t_currentWorker = 0;
+	}
 
 	class TaskManager::Impl {
+	public:
+		std::shared_ptr<ThreadPool> pool_;
+		std::size_t workerCount_ = 0;
+
+		std::mutex mainMutex_;
+		std::deque<PendingTask> mainQueue_;
+		std::atomic<std::thread::id> mainThreadId_;
+		// Set once the host has called ProcessMainThreadTasks: until then, nobody would run the
+		// queued main tasks.
+		std::atomic<bool> hostDrainsMainTasks_ = false;
+
+		bool IsMainThread() const
+		{
+			return std::this_thread::get_id() == mainThreadId_.load();
+		}
+
+		bool TryRunOneMainTask()
+		{
+			PendingTask pending;
+			{
+				std::lock_guard<std::mutex> lock(mainMutex_);
+				if (mainQueue_.empty())
+					return false;
+				pending = std::move(mainQueue_.front());
+				mainQueue_.pop_front();
+			}
+			RunPendingTask(pending);
+			return true;
+		}
 	};
 
 	DEFINEFACTORYGLOBALS(TaskManager);
 
-	TaskManager::TaskManager():impl_(new Impl())
+	TaskManager::TaskManager()
+		: TaskManager(GetDefaultWorkerCount())
+	{
+	}
+
+	TaskManager::TaskManager(std::size_t workerCount):impl_(new Impl())
 	{
+		impl_->workerCount_ = workerCount;
+		impl_->mainThreadId_ = std::this_thread::get_id();
+		if (workerCount > 0)
+		{
+			impl_->pool_ = std::make_shared<ThreadPool>(workerCount);
+			impl_->pool_->Start();
+		}
 	}
 
 	TaskManager::~TaskManager()
 	{
+		if (impl_->pool_)
+			impl_->pool_->Stop();
+		// Main tasks must not be run by another thread: only complete the remaining ones from the
+		// main thread, and otherwise release their waiters without running them.
+		if (impl_->IsMainThread())
+		{
+			while (impl_->TryRunOneMainTask()) {}
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(impl_->mainMutex_);
+			if (!impl_->mainQueue_.empty())
+			{
+				BE_LOGW("AdvVizSDK", "TaskManager destroyed outside the main thread, "
+					<< impl_->mainQueue_.size() << " main task(s) were not run");
+			}
+			for (auto& pending : impl_->mainQueue_)
+				pending.task_->SetCompleted();
+			impl_->mainQueue_.clear();
+		}
+	}
+
+	std::shared_ptr<ITask> TaskManager::AddTask(const std::function<void()>& fct, EType type, EPriority priority)
+	{
+		std::shared_ptr<Task> task(new Task());
+		Impl* impl = impl_.get();
+		bool const bRunNow = !impl->pool_
+			|| (type == EType::main && (impl->IsMainThread() || !impl->hostDrainsMainTasks_.load()));
+		if (bRunNow)
+		{
+			// No workers (all tasks are run now, as before the pool existed), or a main task which can be
+			// run now: either we already are in the main thread, or nobody would ever run the queue.
+			PendingTask pending{ fct, task };
+			RunPendingTask(pending);
+			return task;
+		}
+
+		std::weak_ptr<ThreadPool> poolWeak(impl->pool_);
+		task->SetWaitHelper([impl, poolWeak]() {
+			// Main tasks can only be run by the main thread, which thus drains them while waiting, in
+			// case the awaited task depends on one of them.
+			if (impl->IsMainThread() && impl->TryRunOneMainTask())
+				return true;
+			auto pool = poolWeak.lock();
+			return pool && pool->TryRunOne();
+			});
+		if (type == EType::main)
+		{
+			std::lock_guard<std::mutex> lock(impl->mainMutex_);
+			impl->mainQueue_.push_back(PendingTask{ fct, task });
+		}
+		else
+		{
+			impl->pool_->Push(PendingTask{ fct, task }, GetQueueLevel(type, priority));
+		}
+		return task;
+	}
+
+	std::size_t TaskManager::ProcessMainThreadTasks(std::chrono::microseconds maxDuration)
+	{
+		impl_->mainThreadId_ = std::this_thread::get_id();
+		impl_->hostDrainsMainTasks_ = true;
+		auto const start = std::chrono::steady_clock::now();
+		std::size_t count = 0;
+		while (impl_->TryRunOneMainTask())
+		{
+			++count;
+			if (maxDuration.count() > 0 && std::chrono::steady_clock::now() - start >= maxDuration)
+				break;
+		}
+		return count;
 	}
 
-	std::shared_ptr<ITask> TaskManager::AddTask(const std::function<void()>& fct, EType /*type*/, EPriority /*priority*/)
+	std::size_t TaskManager::GetWorkerCount() const
 	{
-		fct();
-		return std::shared_ptr<ITask>(ITask::New());
+		return impl_->workerCount_;
+	}
+
+	std::size_t TaskManager::GetDefaultWorkerCount()
+	{
+		return std::max(std::thread::hardware_concurrency(), 2u) - 1;
 	}
 
 	TaskManager::Impl& TaskManager::GetImpl()
@@ -65,5 +435,5 @@ namespace AdvViz::SDK::Tools {
 			p.instance_ = ITaskManager::New();
 		return *p.instance_;
 	}
-	
+
 }
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <Core/Tools/Tools.h>
+#include <chrono>
 
 namespace AdvViz::SDK::Tools {
 
@@ -22,10 +23,26 @@ namespace AdvViz::SDK::Tools {
 	class ADVVIZ_LINK Task : public ITask, public Tools::TypeId<Task>
 	{
 	public:
-		// return always true
+		Task();
+		~Task();
+
+		// return true once SetCompleted has been called
 		bool IsCompleted() override;
-		// nothing to wait
+		// block until the task is completed. While waiting, the calling thread helps running
+		// pending tasks (if a helper was provided), so waiting from a worker cannot deadlock the pool.
 		void Wait() override;
+
+		// Mark the task as completed and wake up waiting threads.
+		void SetCompleted();
+		// Function called in loop by Wait() while the task is not completed. It should run at most
+		// one pending task and return true if it did.
+		void SetWaitHelper(std::function<bool()> const& helper);
+
+		class Impl;
+		Impl& GetImpl();
+		const Impl& GetImpl() const;
+	private:
+		const std::unique_ptr<Impl> impl_;
 	};
 
 	class ADVVIZ_LINK ITaskManager : public Tools::Factory<ITaskManager>, public Tools::ExtensionSupport
@@ -34,6 +51,8 @@ namespace AdvViz::SDK::Tools {
 		enum class EType {
 			background,
 			foreground,
+			/// Run on the main thread (the game thread in Unreal). Such a task is run immediately when added
+			/// from the main thread, and waiting for it from the main thread runs it instead of blocking.
 			main
 		};
 		enum class EPriority {
@@ -46,16 +65,37 @@ namespace AdvViz::SDK::Tools {
 	};
 
 	
+	/// Default task manager: a work-stealing thread pool.
+	/// - background and foreground tasks are run by the workers, highest priority first (at same
+	///   priority, foreground tasks are run before background ones). Each worker has its own queues:
+	///   tasks added from a worker go to its queues, and idle workers steal from the others.
+	/// - main tasks are stored in a dedicated queue, which has to be drained by the host by calling
+	///   ProcessMainThreadTasks regularly (typically once per frame). Until the host does so, and
+	///   whenever they are added from the main thread, main tasks are run immediately by AddTask.
+	///   Waiting for a task from the main thread runs the queued main tasks meanwhile.
+	/// Without workers (explicit opt-out), tasks of all types are run immediately by AddTask, in the
+	/// calling thread. Hosts having their own scheduler (eg. Unreal) can still override AddTask.
 	class ADVVIZ_LINK TaskManager : public ITaskManager, public Tools::TypeId<TaskManager>
 	{
 	public:
+		/// Creates a pool with GetDefaultWorkerCount() workers.
 		TaskManager();
+		/// Creates a pool with the given number of workers. With 0 workers, all tasks are run
+		/// immediately by AddTask, in the calling thread.
+		explicit TaskManager(std::size_t workerCount);
 		~TaskManager();
 
-		// need to be implement by host
-		// current implementation does nothing, just run fct. 
 		std::shared_ptr<ITask> AddTask(const std::function<void()>& fct, EType type = EType::foreground, EPriority priority = EPriority::normal) override;
 
+		/// Run the pending main tasks, until the queue is empty or maxDuration is elapsed (no time
+		/// limit if maxDuration is zero). Must be called from the main thread, which it records as such.
+		/// Returns the number of tasks run.
+		std::size_t ProcessMainThreadTasks(std::chrono::microseconds maxDuration = std::chrono::microseconds(0));
+
+		std::size_t GetWorkerCount() const;
+		/// One worker per hardware thread, minus one for the caller.
+		static std::size_t GetDefaultWorkerCount();
+
 		using Tools::TypeId<TaskManager>::GetTypeId;
 		std::uint64_t GetDynTypeId() const override { return GetTypeId(); }
 		bool IsTypeOf(std::uint64_t i) const override { return (i == GetTypeId()) || TaskManager::IsTypeOf(i); }
@@ -82,7 +122,7 @@ namespace AdvViz::SDK::Tools {
 		auto it = t.rbegin();
 		auto itEnd = t.rend();
 		for (;it !=  itEnd; ++it)
-			if (!it->IsCompleted())
+			if (!(*it)->IsCompleted())
 				return false;
 		return true;
 	}
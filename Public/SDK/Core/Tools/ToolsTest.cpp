@@ -9,7 +9,11 @@
 #include <catch2/catch_all.hpp>
 
 #include "Tools.h"
+#include "JsonCacheUtilities.h"
+#include "MPSCRingBuffer.h"
 #include "SharedRecursiveMutex.h"
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -243,6 +247,270 @@ TEST_CASE("Tools:Log")
 
 }
 
+TEST_CASE("Tools:MPSCRingBuffer")
+{
+	MPSCRingBuffer<std::string> queue(5);
+	REQUIRE(queue.Capacity() == 8);
+	REQUIRE(queue.IsEmpty());
+	REQUIRE(!queue.TryPop([](std::string&) {}));
+	for (int i = 0; i < 8; ++i)
+		REQUIRE(queue.TryPush([i](std::string& slot) { slot = std::to_string(i); }));
+	REQUIRE(!queue.TryPush([](std::string&) { FAIL("The queue should be full"); }));
+	std::string value;
+	REQUIRE(queue.TryPop([&value](std::string& slot) { value = slot; }));
+	REQUIRE(value == "0");
+	REQUIRE(queue.TryPush([](std::string& slot) { slot = "8"; }));
+	for (int i = 1; i <= 8; ++i)
+	{
+		REQUIRE(queue.TryPop([&value](std::string& slot) { value = slot; }));
+		REQUIRE(value == std::to_string(i));
+	}
+	REQUIRE(queue.IsEmpty());
+	REQUIRE(queue.NumPushed() == 9);
+	REQUIRE(queue.NumPopped() == 9);
+
+	// Several producers: each one's values must be received in order, none lost.
+	constexpr int NumProducers = 4;
+	constexpr int NumValues = 20000;
+	MPSCRingBuffer<std::pair<int, int>> sharedQueue(64);
+	std::vector<std::thread> producers;
+	for (int p = 0; p < NumProducers; ++p)
+	{
+		producers.emplace_back([&sharedQueue, p]() {
+			for (int i = 0; i < NumValues; ++i)
+			{
+				while (!sharedQueue.TryPush([p, i](std::pair<int, int>& slot) { slot = { p, i }; }))
+					std::this_thread::yield();
+			}
+		});
+	}
+	std::vector<int> nextValues(NumProducers, 0);
+	bool bInOrder = true;
+	for (int received = 0; received < NumProducers * NumValues; )
+	{
+		if (sharedQueue.TryPop([&](std::pair<int, int>& slot) {
+				bInOrder = bInOrder && slot.second == nextValues[slot.first];
+				nextValues[slot.first] = slot.second + 1;
+			}))
+		{
+			++received;
+		}
+	}
+	for (auto& producer : producers)
+		producer.join();
+	REQUIRE(bInOrder);
+	REQUIRE(sharedQueue.IsEmpty());
+}
+
+TEST_CASE("Tools:Log - Async")
+{
+	using namespace Tools;
+
+	ILog::SetNewFct([](std::string s, Level level) {
+		return static_cast<ILog*>(new Log(s, level));
+	});
+	InitLog("log_Test.txt");
+	REQUIRE(GetAsyncLogOptions().enabled);
+	CreateLogChannel("testAsync", Level::info);
+
+	// Messages logged from several threads must all end up in the log file once flushed.
+	std::string const marker = "async-" + std::to_string(
+		std::chrono::steady_clock::now().time_since_epoch().count());
+	constexpr int NumThreads = 4;
+	constexpr int NumMessages = 100;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < NumThreads; ++t)
+	{
+		threads.emplace_back([&marker, t]() {
+			for (int i = 0; i < NumMessages; ++i)
+				BE_LOGI("testAsync", marker << " thread " << t << " message " << std::hex << i);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	FlushLog();
+
+	// Rolled files are named log_Test.1.txt etc.
+	int numFound = 0;
+	std::error_code ec;
+	auto const logDir = std::filesystem::temp_directory_path() / "ITwinAdvViz" / "Logs";
+	for (auto const& entry : std::filesystem::directory_iterator(logDir, ec))
+	{
+		if (entry.path().filename().string().rfind("log_Test", 0) != 0)
+			continue;
+		std::ifstream file(entry.path());
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.find(marker) != std::string::npos)
+				++numFound;
+		}
+	}
+	REQUIRE(numFound == NumThreads * NumMessages);
+}
+
+// Compares the time spent in BE_LOG by the logging threads, with and without the async writer.
+// Hidden by default, run with: ToolsTest "[benchmark]"
+TEST_CASE("Tools:Log - Benchmark", "[.][benchmark]")
+{
+	using namespace Tools;
+
+	ILog::SetNewFct([](std::string s, Level level) {
+		return static_cast<ILog*>(new Log(s, level));
+	});
+	InitLog("log_Test.txt");
+	CreateLogChannel("benchLog", Level::info);
+	AsyncLogOptions const initialOptions = GetAsyncLogOptions();
+
+	auto runBench = [](int threadCount, int messageCount)
+	{
+		std::vector<std::thread> threads;
+		auto start = std::chrono::steady_clock::now();
+		for (int t = 0; t < threadCount; ++t)
+		{
+			threads.emplace_back([t, messageCount]() {
+				for (int i = 0; i < messageCount; ++i)
+					BE_LOGI("benchLog", "keyframe " << i << " of thread " << t << " at time " << i * 0.04 << "s");
+			});
+		}
+		for (auto& thread : threads)
+			thread.join();
+		auto const loggedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		FlushLog();
+		auto const writtenUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		return std::make_pair(loggedUs, writtenUs);
+	};
+
+	constexpr int TotalMessages = 20000;
+	for (int threadCount : { 1, 2, 4, 8 })
+	{
+		int const messageCount = TotalMessages / threadCount;
+		AsyncLogOptions options = initialOptions;
+		options.enabled = false;
+		SetAsyncLogOptions(options);
+		double const syncUs = runBench(threadCount, messageCount).first;
+		options.enabled = true;
+		SetAsyncLogOptions(options);
+		auto const [asyncUs, asyncWrittenUs] = runBench(threadCount, messageCount);
+		std::cout << "Log bench: " << threadCount << " threads"
+			<< " | sync: " << TotalMessages / syncUs << " msg/us"
+			<< " | async: " << TotalMessages / asyncUs << " msg/us in logging threads, "
+			<< TotalMessages / asyncWrittenUs << " msg/us written" << std::endl;
+	}
+	SetAsyncLogOptions(initialOptions);
+}
+
+namespace JsonCacheTest
+{
+	void WriteFile(std::filesystem::path const& path, std::string const& bytes)
+	{
+		std::ofstream(path, std::ios::binary) << bytes;
+	}
+
+	std::string ToUTF16LEWithBOM(std::u16string const& text)
+	{
+		std::string bytes = "\xFF\xFE";
+		for (char16_t c : text)
+		{
+			bytes += (char)(c & 0xFF);
+			bytes += (char)(c >> 8);
+		}
+		return bytes;
+	}
+
+	std::string MakeCacheFile(std::string const& url, std::string const& reply)
+	{
+		return "{\n\t\"url\": \"" + url + "\",\n\t\"verb\": \"GET\",\n\t\"connectedSuccessfully\": true,"
+			"\n\t\"responseCode\": 200,\n\t\"reply\": " + reply + "\n}\n";
+	}
+}
+
+TEST_CASE("Tools:JsonCacheUtilities")
+{
+	using namespace JsonCacheTest;
+	auto const dir = std::filesystem::temp_directory_path() / "ITwinAdvViz" / "JsonCacheTest";
+	std::filesystem::create_directories(dir);
+
+	std::string const content = MakeCacheFile("https://host/query?a=1,2", "{\"rows\": [1, 2, 3]}");
+	std::string const expected = "{\n\t\"url\": \"https://host/query?a=1,2\",\n\t\"verb\": \"GET\","
+		"\n\t\"connectedSuccessfully\": true,\n\t\"responseCode\": 200}";
+	WriteFile(dir / "utf8.json", content);
+	WriteFile(dir / "utf8bom.json", "\xEF\xBB\xBF" + content);
+	WriteFile(dir / "noreply.json", "{\"url\": \"u\", \"verb\": \"GET\"}");
+	WriteFile(dir / "utf16.json", ToUTF16LEWithBOM(
+		u"{\n\t\"url\": \"hé中\U0001F600\",\n\t\"responseCode\": 200,\n\t\"reply\": \"...\"\n}"));
+	WriteFile(dir / "empty.json", "");
+
+	CacheFileWithoutReply file;
+	REQUIRE(file.Load(dir / "utf8.json"));
+	REQUIRE(file.GetBOM() == EFileBOM::None);
+	REQUIRE(file.GetJson() == expected);
+	REQUIRE(file.Load(dir / "utf8bom.json"));
+	REQUIRE(file.GetBOM() == EFileBOM::UTF8);
+	REQUIRE(file.GetJson() == expected);
+	REQUIRE(file.Load(dir / "noreply.json"));
+	REQUIRE(file.GetJson() == "{\"url\": \"u\", \"verb\": \"GET\"}");
+	REQUIRE(file.Load(dir / "utf16.json"));
+	REQUIRE(file.GetBOM() == EFileBOM::UTF16_LE);
+	REQUIRE(file.GetJson() == "{\n\t\"url\": \"h\xC3\xA9\xE4\xB8\xAD\xF0\x9F\x98\x80\",\n\t\"responseCode\": 200}");
+	REQUIRE(!file.Load(dir / "empty.json"));
+	REQUIRE(file.GetJson().empty());
+	REQUIRE(!file.Load(dir / "missing.json"));
+	REQUIRE(file.GetJson().empty());
+
+	// The mapping is private: the file itself is left untouched.
+	std::ifstream in(dir / "utf8.json", std::ios::binary);
+	REQUIRE(std::string(std::istreambuf_iterator<char>(in), {}) == content);
+	REQUIRE(LoadCacheFileToStringWithoutReply(dir / "utf8bom.json") == expected);
+
+	std::vector<std::filesystem::path> paths;
+	for (int i = 0; i < 200; ++i)
+		paths.push_back(dir / ((i % 2) ? "utf8.json" : "utf8bom.json"));
+	paths.push_back(dir / "missing.json");
+	std::vector<CacheFileWithoutReply> const files = LoadCacheFilesWithoutReply(paths);
+	REQUIRE(files.size() == paths.size());
+	for (size_t i = 0; i + 1 < files.size(); ++i)
+		REQUIRE(files[i].GetJson() == expected);
+	REQUIRE(files.back().GetJson().empty());
+	std::filesystem::remove_all(dir);
+}
+
+// Compares loading a warm query cache file by file and in parallel.
+// Hidden by default, run with: ToolsTest "[benchmark]"
+TEST_CASE("Tools:JsonCacheUtilities - Benchmark", "[.][benchmark]")
+{
+	using namespace JsonCacheTest;
+	auto const dir = std::filesystem::temp_directory_path() / "ITwinAdvViz" / "JsonCacheBench";
+	std::filesystem::create_directories(dir);
+	constexpr int NumFiles = 20000;
+	std::string reply = "{\"data\": [";
+	for (int i = 0; i < 1000; ++i)
+		reply += (i ? ",\n" : "") + std::string("[\"0x") + std::to_string(i) + "\", 1.5, 2.5, 3.5]";
+	reply += "]}";
+	std::vector<std::filesystem::path> paths;
+	for (int i = 0; i < NumFiles; ++i)
+	{
+		paths.push_back(dir / (std::to_string(i) + ".json"));
+		WriteFile(paths.back(), MakeCacheFile("https://host/query/" + std::to_string(i), reply));
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	size_t totalSize = 0;
+	for (auto const& path : paths)
+		totalSize += LoadCacheFileToStringWithoutReply(path).size();
+	auto const sequentialMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	size_t totalSizeBatch = 0;
+	for (auto const& file : LoadCacheFilesWithoutReply(paths))
+		totalSizeBatch += file.GetJson().size();
+	auto const batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	REQUIRE(totalSize == totalSizeBatch);
+	std::cout << "JsonCacheUtilities bench: " << NumFiles << " files of " << reply.size() / 1024 << " KB"
+		<< " | one by one: " << sequentialMs << " ms | batch: " << batchMs << " ms" << std::endl;
+	std::filesystem::remove_all(dir);
+}
+
 AdvViz::expected<int, std::string> to_int(char const* const text)
 {
 	char* pos = nullptr;
@@ -1031,6 +1299,150 @@ TEST_CASE("Tools:SharedRecursiveMutex - Stress test")
 	REQUIRE(sharedCounter.load() >= (numThreads / 2) * operationsPerThread);
 }
 
+TEST_CASE("Tools:TaskManager - Tasks are run by the pool")
+{
+	TaskManager taskManager(4);
+	REQUIRE(taskManager.GetWorkerCount() == 4);
+
+	const int taskCount = 1000;
+	std::atomic<int> counter = 0;
+	std::vector<std::shared_ptr<ITask>> tasks;
+	for (int i = 0; i < taskCount; ++i)
+	{
+		tasks.push_back(taskManager.AddTask([&counter]() { counter++; },
+			(i % 2) ? ITaskManager::EType::background : ITaskManager::EType::foreground,
+			static_cast<ITaskManager::EPriority>(i % 3)));
+	}
+	WaitTasks(tasks);
+	REQUIRE(AreTasksCompleted(tasks));
+	REQUIRE(counter.load() == taskCount);
+}
+
+TEST_CASE("Tools:TaskManager - Waiting from a task does not deadlock")
+{
+	// With a single worker, the nested task can only be run if Wait() helps the pool.
+	TaskManager taskManager(1);
+	std::atomic<int> counter = 0;
+	auto outer = taskManager.AddTask([&taskManager, &counter]() {
+		std::vector<std::shared_ptr<ITask>> inner;
+		for (int i = 0; i < 10; ++i)
+			inner.push_back(taskManager.AddTask([&counter]() { counter++; }));
+		WaitTasks(inner);
+		counter++;
+		});
+	outer->Wait();
+	REQUIRE(outer->IsCompleted());
+	REQUIRE(counter.load() == 11);
+}
+
+TEST_CASE("Tools:TaskManager - Main tasks")
+{
+	TaskManager taskManager(2);
+	const std::thread::id mainThreadId = std::this_thread::get_id();
+	// From now on, the main tasks added by workers are queued for this thread.
+	REQUIRE(taskManager.ProcessMainThreadTasks() == 0);
+	std::atomic<int> counter = 0;
+	std::atomic<bool> bWrongThread = false;
+	auto task = taskManager.AddTask([&]() {
+		// main tasks added from a worker must still be run by the main thread
+		for (int i = 0; i < 5; ++i)
+		{
+			taskManager.AddTask([&]() {
+				if (std::this_thread::get_id() != mainThreadId)
+					bWrongThread = true;
+				counter++;
+				}, ITaskManager::EType::main);
+		}
+		}, ITaskManager::EType::background);
+	// (not calling Wait, which would run the main tasks)
+	while (!task->IsCompleted())
+		std::this_thread::yield();
+	REQUIRE(counter.load() == 0);
+	REQUIRE(taskManager.ProcessMainThreadTasks() == 5);
+	REQUIRE(counter.load() == 5);
+	REQUIRE(!bWrongThread);
+
+	// main tasks added from the main thread are run at once
+	auto mainTask = taskManager.AddTask([&counter]() { counter++; }, ITaskManager::EType::main);
+	REQUIRE(mainTask->IsCompleted());
+	REQUIRE(counter.load() == 6);
+
+	// waiting from the main thread runs the main tasks the awaited task depends on
+	auto dependentTask = taskManager.AddTask([&]() {
+		taskManager.AddTask([&counter]() { counter++; }, ITaskManager::EType::main)->Wait();
+		}, ITaskManager::EType::background);
+	dependentTask->Wait();
+	REQUIRE(counter.load() == 7);
+}
+
+TEST_CASE("Tools:TaskManager - Default pool")
+{
+	TaskManager taskManager;
+	REQUIRE(taskManager.GetWorkerCount() == TaskManager::GetDefaultWorkerCount());
+	REQUIRE(taskManager.GetWorkerCount() > 0);
+}
+
+TEST_CASE("Tools:TaskManager - Inline execution")
+{
+	TaskManager taskManager(0);
+	REQUIRE(taskManager.GetWorkerCount() == 0);
+	int counter = 0;
+	auto task = taskManager.AddTask([&counter]() { counter++; });
+	REQUIRE(task->IsCompleted());
+	REQUIRE(counter == 1);
+}
+
+TEST_CASE("Tools:TaskManager - Waiting for a main task nobody pumps")
+{
+	// ProcessMainThreadTasks is never called here: main tasks added by workers must be run by AddTask.
+	TaskManager taskManager(2);
+	std::atomic<int> counter = 0;
+	auto task = taskManager.AddTask([&]() {
+		taskManager.AddTask([&counter]() { counter++; }, ITaskManager::EType::main)->Wait();
+		}, ITaskManager::EType::background);
+	task->Wait();
+	REQUIRE(task->IsCompleted());
+	REQUIRE(counter.load() == 1);
+}
+
+// Compares scheduling overhead and throughput of the pool against inline execution (0 workers).
+// Hidden by default, run with: ToolsTest "[benchmark]"
+TEST_CASE("Tools:TaskManager - Benchmark", "[.][benchmark]")
+{
+	auto runBench = [](std::size_t workerCount, int taskCount, int workPerTask)
+	{
+		TaskManager taskManager(workerCount);
+		std::atomic<std::uint64_t> sink = 0;
+		std::vector<std::shared_ptr<ITask>> tasks;
+		tasks.reserve(taskCount);
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < taskCount; ++i)
+		{
+			tasks.push_back(taskManager.AddTask([&sink, workPerTask, i]() {
+				std::uint64_t v = (std::uint64_t)i;
+				for (int k = 0; k < workPerTask; ++k)
+					v = v * 6364136223846793005ULL + 1442695040888963407ULL;
+				sink += v;
+				}, ITaskManager::EType::background));
+		}
+		WaitTasks(tasks);
+		auto duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+		return duration;
+	};
+
+	const std::size_t hwWorkers = TaskManager::GetDefaultWorkerCount();
+	for (int workPerTask : { 0, 1000, 100000 })
+	{
+		const int taskCount = workPerTask >= 100000 ? 1000 : 100000;
+		double inlineUs = runBench(0, taskCount, workPerTask);
+		double poolUs = runBench(hwWorkers, taskCount, workPerTask);
+		std::cout << "TaskManager bench: " << taskCount << " tasks, work " << workPerTask
+			<< " | inline: " << inlineUs / taskCount << " us/task"
+			<< " | pool(" << hwWorkers << "): " << poolUs / taskCount << " us/task"
+			<< " | speedup: " << inlineUs / poolUs << std::endl;
+	}
+}
+
 //TEST_CASE("Failure")
 //{
 //	INFO("This test is expected to fail an assertion.");
@@ -1048,6 +1460,7 @@ int main(int argc, char* argv[]) {
 	int result = Catch::Session().run(argc, argv);
 
 	// clean-up...
+	AdvViz::SDK::Tools::ShutdownLog();
 
 	return result;
 }
@@ -118,7 +118,8 @@ namespace AdvViz::SDK
 					auto annotation = AddAnnotation();
 					FromJsonAnnotation(annotation, row);
 					return {};
-				});
+				},
+				{ .maxConcurrentPages = 4 });
 
 			if (!ret)
 			{
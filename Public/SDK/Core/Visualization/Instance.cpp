@@ -20,11 +20,29 @@ namespace AdvViz::SDK
 		// other data
 		std::string name_;
 		std::string objectRef_;
-		std::optional<float3> colorShift_;
-		dmat3x4 transform_;
-		std::string animationid_;
 		std::optional<RefID> animPathId_;
 
+		// When set, transform, color shift and animation id are stored in this packed store.
+		InstancesStorePtr store_;
+		InstancesStore::Index storeIndex_ = 0;
+
+		// Transform, color shift and animation id of an instance outside any store. Only allocated when
+		// one of them is set, so that instances bound to a store stay small.
+		struct DetachedData
+		{
+			dmat3x4 transform_ = {};
+			std::optional<float3> colorShift_;
+			std::string animationid_;
+		};
+		std::unique_ptr<DetachedData> detached_;
+
+		DetachedData& GetDetachedData()
+		{
+			if (!detached_)
+				detached_ = std::make_unique<DetachedData>();
+			return *detached_;
+		}
+
 		RefID refId_; // identifies the instance (and may hold id defined by the server)
 		ESaveStatus saveStatus_ = ESaveStatus::NeverSaved;
 	};
@@ -35,8 +53,21 @@ namespace AdvViz::SDK
 	const IInstancesGroupPtr& Instance::GetGroup() const { return impl_->group_; }
 	void Instance::SetGroup(const IInstancesGroupPtr& group) { impl_->group_ = group; }
 
-	const std::string& Instance::GetAnimId() const { return impl_->animationid_; }
-	void Instance::SetAnimId(const std::string &id) { impl_->animationid_ = id; }
+	const std::string& Instance::GetAnimId() const
+	{
+		static const std::string noAnimId;
+		if (impl_->store_)
+			return impl_->store_->GetAnimId(impl_->storeIndex_);
+		return impl_->detached_ ? impl_->detached_->animationid_ : noAnimId;
+	}
+
+	void Instance::SetAnimId(const std::string &id)
+	{
+		if (impl_->store_)
+			impl_->store_->SetAnimId(impl_->storeIndex_, id);
+		else
+			impl_->GetDetachedData().animationid_ = id;
+	}
 
 	const std::optional<RefID>& Instance::GetAnimPathId() const { return impl_->animPathId_; }
 	void Instance::SetAnimPathId(const RefID& id) { impl_->animPathId_ = id; }
@@ -48,11 +79,69 @@ namespace AdvViz::SDK
 	const std::string& Instance::GetObjectRef() const { return impl_->objectRef_; }
 	void Instance::SetObjectRef(const std::string& objectRef) { impl_->objectRef_ = objectRef; }
 
-	std::optional<float3> Instance::GetColorShift() const { return impl_->colorShift_; }
-	void Instance::SetColorShift(const float3& color) { impl_->colorShift_ = color; }
+	std::optional<float3> Instance::GetColorShift() const
+	{
+		if (impl_->store_)
+			return impl_->store_->GetColorShift(impl_->storeIndex_);
+		return impl_->detached_ ? impl_->detached_->colorShift_ : std::nullopt;
+	}
+
+	void Instance::SetColorShift(const float3& color)
+	{
+		if (impl_->store_)
+			impl_->store_->SetColorShift(impl_->storeIndex_, color);
+		else
+			impl_->GetDetachedData().colorShift_ = color;
+	}
+
+	dmat3x4 Instance::GetTransform() const
+	{
+		if (impl_->store_)
+			return impl_->store_->GetTransform(impl_->storeIndex_);
+		return impl_->detached_ ? impl_->detached_->transform_ : dmat3x4{};
+	}
+
+	void Instance::SetTransform(const dmat3x4& mat)
+	{
+		if (impl_->store_)
+			impl_->store_->SetTransform(impl_->storeIndex_, mat);
+		else
+			impl_->GetDetachedData().transform_ = mat;
+	}
+
+	void Instance::SetStore(const InstancesStorePtr& store, InstancesStore::Index index)
+	{
+		Impl& impl = GetImpl();
+		if (store == impl.store_)
+		{
+			// Same store, the slot has just moved (data is already there).
+			impl.storeIndex_ = index;
+			return;
+		}
+		dmat3x4 const transform = GetTransform();
+		std::optional<float3> const colorShift = GetColorShift();
+		std::string const animId = GetAnimId();
+
+		impl.store_ = store;
+		impl.storeIndex_ = index;
+		if (store)
+		{
+			store->SetTransform(index, transform);
+			store->SetColorShift(index, colorShift);
+			store->SetAnimId(index, animId);
+			impl.detached_.reset();
+		}
+		else
+		{
+			Impl::DetachedData& detached = impl.GetDetachedData();
+			detached.transform_ = transform;
+			detached.colorShift_ = colorShift;
+			detached.animationid_ = animId;
+		}
+	}
 
-	const dmat3x4& Instance::GetTransform() const { return impl_->transform_; }
-	void Instance::SetTransform(const dmat3x4& mat) { impl_->transform_ = mat; }
+	const InstancesStorePtr& Instance::GetStore() const { return impl_->store_; }
+	InstancesStore::Index Instance::GetStoreIndex() const { return impl_->storeIndex_; }
 
 	ESaveStatus Instance::GetSaveStatus() const { return impl_->saveStatus_; }
 	void Instance::SetSaveStatus(ESaveStatus status) { impl_->saveStatus_ = status; }
@@ -20,6 +20,7 @@
 #include <Core/Tools/Tools.h>
 #include <Core/Tools/Types.h>
 #include <Core/Visualization/InstancesGroup.h>
+#include <Core/Visualization/InstancesStore.h>
 #include <Core/Visualization/SavableItem.h>
 
 MODULE_EXPORT namespace AdvViz::SDK
@@ -48,7 +49,7 @@ MODULE_EXPORT namespace AdvViz::SDK
 		virtual const std::string& GetObjectRef() const = 0;
 		virtual void SetObjectRef(const std::string& objectRef) = 0;
 
-		virtual const dmat3x4& GetTransform() const = 0;
+		virtual dmat3x4 GetTransform() const = 0;
 		virtual void SetTransform(const dmat3x4& mat) = 0;
 
 		virtual std::optional<float3> GetColorShift() const = 0;
@@ -57,6 +58,13 @@ MODULE_EXPORT namespace AdvViz::SDK
 		virtual expected<void, std::string> Update() = 0;
 
 		virtual void OnIndexChanged(const int32_t newIndex) = 0;
+
+		// Make the instance a handle to the given slot of a packed store: transform, color shift and
+		// animation id are then read and written there (current values are copied to the slot when
+		// binding to a new store). With a null store, these values are moved back into the instance.
+		virtual void SetStore(const InstancesStorePtr& store, InstancesStore::Index index) = 0;
+		virtual const InstancesStorePtr& GetStore() const = 0;
+		virtual InstancesStore::Index GetStoreIndex() const = 0;
 	};
 
 	class ADVVIZ_LINK Instance : public IInstance, Tools::TypeId<Instance>
@@ -87,7 +95,7 @@ MODULE_EXPORT namespace AdvViz::SDK
 		const std::string& GetObjectRef() const override;
 		void SetObjectRef(const std::string& objectRef) override;
 
-		const dmat3x4& GetTransform() const override;
+		dmat3x4 GetTransform() const override;
 		void SetTransform(const dmat3x4& mat) override;
 
 		std::optional<float3> GetColorShift() const override;
@@ -97,6 +105,10 @@ MODULE_EXPORT namespace AdvViz::SDK
 
 		void OnIndexChanged(const int32_t newIndex) override;
 
+		void SetStore(const InstancesStorePtr& store, InstancesStore::Index index) override;
+		const InstancesStorePtr& GetStore() const override;
+		InstancesStore::Index GetStoreIndex() const override;
+
 		using Tools::TypeId<Instance>::GetTypeId;
 		std::uint64_t GetDynTypeId() const override { return GetTypeId(); }
 		bool IsTypeOf(std::uint64_t i) const override { return (i == GetTypeId()) || IInstance::IsTypeOf(i); }
@@ -40,6 +40,24 @@ namespace AdvViz::SDK
 			std::map<ObjRefAndGPId, SharedInstVect> mapObjectRefToInstances_;
 			std::map<ObjRefAndGPId, SharedInstVect> mapObjectRefToDeletedInstances_;
 			std::vector<IInstancesGroupPtr> instancesGroupsToDelete_;
+			// Packed transforms, colors... of the instances in mapObjectRefToInstances_ (same indices).
+			std::map<ObjRefAndGPId, InstancesStorePtr> mapObjectRefToStore_;
+
+			InstancesStorePtr const& GetOrCreateStore(ObjRefAndGPId const& objRefAndGroup)
+			{
+				InstancesStorePtr& store = mapObjectRefToStore_[objRefAndGroup];
+				if (!store)
+					store = std::make_shared<InstancesStore>();
+				return store;
+			}
+
+			// Append the instance to the store of its object-ref/group (it must have just been pushed at
+			// the end of the corresponding instance vector).
+			void AddToStore(ObjRefAndGPId const& objRefAndGroup, IInstance& inst)
+			{
+				InstancesStorePtr const& store = GetOrCreateStore(objRefAndGroup);
+				inst.SetStore(store, store->Add());
+			}
 		};
 		Tools::RWLockableObject<SThreadSafeData> thdata_;
 
@@ -76,6 +94,7 @@ namespace AdvViz::SDK
 			thdata->mapIdToInstGroups_.clear();
 			thdata->mapObjectRefToInstances_.clear();
 			thdata->mapObjectRefToDeletedInstances_.clear();
+			thdata->mapObjectRefToStore_.clear();
 			thdata->groupIDMap_.clear();
 			thdata->instanceIDMap_.clear();
 		}
@@ -269,9 +288,12 @@ namespace AdvViz::SDK
 						gp->AddInstance(sharedInst);
 					}
 
-					thdata->mapObjectRefToInstances_[std::make_pair(row.objref, gpId)].push_back(sharedInst);
+					auto const objRefAndGroup = std::make_pair(row.objref, gpId);
+					thdata->mapObjectRefToInstances_[objRefAndGroup].push_back(sharedInst);
+					thdata->AddToStore(objRefAndGroup, *inst);
 					return {};
-				}
+				},
+				{ .maxConcurrentPages = 4 }
 			);
 			if (!ret)
 			{
@@ -337,7 +359,9 @@ namespace AdvViz::SDK
 						gp->AddInstance(sharedInst);
 					}
 
-					thdata->mapObjectRefToInstances_[std::make_pair(row.objref, gpId)].push_back(sharedInst);
+					auto const objRefAndGroup = std::make_pair(row.objref, gpId);
+					thdata->mapObjectRefToInstances_[objRefAndGroup].push_back(sharedInst);
+					thdata->AddToStore(objRefAndGroup, *inst);
 
 					onInstanceCreatedCallback(sharedInst);
 					return {};
@@ -906,9 +930,21 @@ namespace AdvViz::SDK
 		void SetInstanceCountByObjectRef(const std::string& objectRef, const RefID& gpId, uint64_t count)
 		{
 			auto thdata = thdata_.GetAutoLock();
-			SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[std::make_pair(objectRef, gpId)];
+			auto const objRefAndGroup = std::make_pair(objectRef, gpId);
+			SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[objRefAndGroup];
+			InstancesStorePtr const& store = thdata->GetOrCreateStore(objRefAndGroup);
 			uint64_t oldSize = currentInstances.size();
+			for (uint64_t i = count; i < oldSize; ++i)
+			{
+				// Discarded instances keep their own data.
+				if (currentInstances[i])
+				{
+					auto inst = currentInstances[i]->GetAutoLock();
+					inst->SetStore({}, 0);
+				}
+			}
 			currentInstances.resize(static_cast<size_t>(count));
+			store->Resize(static_cast<size_t>(count));
 
 			if (count > oldSize)
 			{
@@ -923,6 +959,7 @@ namespace AdvViz::SDK
 						IInstance* inst = IInstance::New();
 						sharedInst = MakeSharedLockableDataPtr<IInstance>(inst);
 						inst->SetObjectRef(objectRef);
+						inst->SetStore(store, (InstancesStore::Index)i);
 						inst->OnIndexChanged((int32_t)i);
 						inst->SetGroup(groupPtr);
 						group->AddInstance(sharedInst);
@@ -937,6 +974,7 @@ namespace AdvViz::SDK
 						IInstance* inst = IInstance::New();
 						sharedInst = MakeSharedLockableDataPtr<IInstance>(inst);
 						inst->SetObjectRef(objectRef);
+						inst->SetStore(store, (InstancesStore::Index)i);
 						inst->OnIndexChanged((int32_t)i);
 					}
 				}
@@ -946,12 +984,14 @@ namespace AdvViz::SDK
 		IInstancePtr AddInstance(const std::string& objectRef, const RefID& gpId)
 		{
 			auto thdata = thdata_.GetAutoLock();
-			SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[std::make_pair(objectRef, gpId)];
+			auto const objRefAndGroup = std::make_pair(objectRef, gpId);
+			SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[objRefAndGroup];
 			IInstance* inst = IInstance::New();
 			auto sharedInst = MakeSharedLockableDataPtr<IInstance>(inst);
 			inst->SetObjectRef(objectRef);
 			inst->OnIndexChanged((int32_t)currentInstances.size());
 			currentInstances.push_back(sharedInst);
+			thdata->AddToStore(objRefAndGroup, *inst);
 			auto group = GetInstancesGroup(gpId);
 			if (group)
 			{
@@ -974,6 +1014,17 @@ namespace AdvViz::SDK
 			return empty;
 		}
 
+		InstancesStorePtr GetInstancesStore(const std::string& objectRef, const RefID& gpId) const
+		{
+			auto thdata = thdata_.GetRAutoLock();
+			const auto it = thdata->mapObjectRefToStore_.find(std::make_pair(objectRef, gpId));
+			if (it != thdata->mapObjectRefToStore_.cend())
+			{
+				return it->second;
+			}
+			return {};
+		}
+
 		void RemoveInstancesByObjectRef(
 			const std::string& objectRef, const RefID& gpId,
 			const std::vector<int32_t>& indicesInDescendingOrder, bool bUseRemoveAtSwap)
@@ -982,42 +1033,73 @@ namespace AdvViz::SDK
 			auto pair = std::make_pair(objectRef, gpId);
 			SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[pair];
 			SharedInstVect& deletedInstances =  thdata->mapObjectRefToDeletedInstances_[pair];
+			InstancesStorePtr const& store = thdata->GetOrCreateStore(pair);
 
+			size_t firstShiftedIndex = currentInstances.size();
 			for (auto const& index : indicesInDescendingOrder)
 			{
 				if (index < currentInstances.size())
 				{
+					{
+						// The removed instance keeps its own copy of its data, as its slot is reused.
+						auto removedInst = currentInstances[index]->GetAutoLock();
+						removedInst->SetStore({}, 0);
+					}
 					deletedInstances.push_back(currentInstances[index]);
 					if (bUseRemoveAtSwap && currentInstances.size() > 1)
 					{
 						std::swap(currentInstances[index], currentInstances.back());
 						currentInstances.pop_back();
+						store->RemoveAt((InstancesStore::Index)index, true);
 
-						auto movedInst = currentInstances[index]->GetAutoLock();
-						movedInst->OnIndexChanged(index);
+						if ((size_t)index < currentInstances.size())
+						{
+							auto movedInst = currentInstances[index]->GetAutoLock();
+							movedInst->SetStore(store, (InstancesStore::Index)index);
+							movedInst->OnIndexChanged(index);
+						}
 					}
 					else
 					{
 						currentInstances.erase(currentInstances.begin() + index);
+						store->RemoveAt((InstancesStore::Index)index, false);
+						firstShiftedIndex = (size_t)index;
 					}
 				}
 			}
+			// Update the slots of shifted instances (their index is updated by the caller).
+			for (size_t i = firstShiftedIndex; i < currentInstances.size(); ++i)
+			{
+				auto shiftedInst = currentInstances[i]->GetAutoLock();
+				shiftedInst->SetStore(store, (InstancesStore::Index)i);
+			}
 		}
 
 		void RemoveGroupInstances(const RefID& gpId)
 		{
 			auto thdata = thdata_.GetAutoLock();
-			for (auto it = thdata->mapObjectRefToInstances_.begin(); it != thdata->mapObjectRefToInstances_.end(); ++it)
+			for (auto it = thdata->mapObjectRefToInstances_.begin(); it != thdata->mapObjectRefToInstances_.end(); )
 			{
 				if (it->first.second == gpId)
 				{
 					SharedInstVect& currentInstances = thdata->mapObjectRefToInstances_[it->first];
 					SharedInstVect& deletedInstances = thdata->mapObjectRefToDeletedInstances_[it->first];
-					for (auto& inst : currentInstances)
-						deletedInstances.push_back(inst);
+					for (auto& instPtr : currentInstances)
+					{
+						{
+							auto inst = instPtr->GetAutoLock();
+							inst->SetStore({}, 0);
+						}
+						deletedInstances.push_back(instPtr);
+					}
 					currentInstances.clear();
+					thdata->mapObjectRefToStore_.erase(it->first);
 					it = thdata->mapObjectRefToInstances_.erase(it);
 				}
+				else
+				{
+					++it;
+				}
 			}
 		}
 
@@ -1194,6 +1276,11 @@ namespace AdvViz::SDK
 		return GetImpl().GetInstancesByObjectRef(objectRef, gpId);
 	}
 
+	InstancesStorePtr InstancesManager::GetInstancesStore(const std::string& objectRef, const RefID& gpId) const
+	{
+		return GetImpl().GetInstancesStore(objectRef, gpId);
+	}
+
 	void InstancesManager::RemoveInstancesByObjectRef(const std::string& objectRef, const RefID& gpId,
 		const std::vector<int32_t>& indicesInDescendingOrder, bool bUseRemoveAtSwap)
 	{
@@ -40,6 +40,9 @@ MODULE_EXPORT namespace AdvViz::SDK
 		virtual IInstancePtr AddInstance(const std::string& objectRef, const RefID& gpId) = 0;
 		/// Get instances by object reference
 		virtual const SharedInstVect& GetInstancesByObjectRef(const std::string& objectRef, const RefID& gpId) const = 0;
+		/// Get the packed store holding the transforms, color shifts... of the instances returned by
+		/// GetInstancesByObjectRef (same indices). Use it for bulk reads/updates.
+		virtual InstancesStorePtr GetInstancesStore(const std::string& objectRef, const RefID& gpId) const = 0;
 		/// Remove instances by object reference (indices must be in descending order)
 		virtual void RemoveInstancesByObjectRef(const std::string& objectRef, const RefID& gpId,
 			const std::vector<int32_t>& indicesInDescendingOrder, bool bUseRemoveAtSwap) = 0;
@@ -90,6 +93,7 @@ MODULE_EXPORT namespace AdvViz::SDK
 		IInstancePtr AddInstance(const std::string& objectRef, const RefID& gpId) override;
 		/// Get instances by object reference
 		const SharedInstVect& GetInstancesByObjectRef(const std::string& objectRef, const RefID& gpId) const override;
+		InstancesStorePtr GetInstancesStore(const std::string& objectRef, const RefID& gpId) const override;
 		/// Remove instances by object reference (indices must be in descending order)
 		void RemoveInstancesByObjectRef(const std::string& objectRef, const RefID& gpId,
 			const std::vector<int32_t>& indicesInDescendingOrder, bool bUseRemoveAtSwap) override;
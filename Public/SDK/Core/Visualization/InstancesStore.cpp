@@ -0,0 +1,262 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: InstancesStore.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "InstancesStore.h"
+
+#include <algorithm>
+
+namespace AdvViz::SDK
+{
+	namespace
+	{
+		constexpr dmat3x4 IdentityTransform = { 1, 0, 0, 0,
+												0, 1, 0, 0,
+												0, 0, 1, 0 };
+	}
+
+	void InstancesStore::SData::Resize(std::size_t count)
+	{
+		std::size_t const chunkCount = (count + ChunkSize - 1) / ChunkSize;
+		if (chunkCount > chunks_.size())
+		{
+			chunks_.reserve(chunkCount);
+			while (chunks_.size() < chunkCount)
+				chunks_.push_back(std::make_unique<SChunk>());
+		}
+		else
+		{
+			// Keep one spare chunk to avoid reallocating when adding/removing around a chunk boundary.
+			chunks_.resize(std::min(chunks_.size(), chunkCount + 1));
+		}
+		// Initialize new slots.
+		for (std::size_t i = count_; i < count; ++i)
+		{
+			SChunk& chunk = ChunkOf(static_cast<Index>(i));
+			std::size_t const j = i % ChunkSize;
+			chunk.transforms_[j] = IdentityTransform;
+			chunk.colorShifts_[j] = { 0.f, 0.f, 0.f };
+			chunk.animIds_[j] = 0;
+			chunk.flags_[j] = EFlag::Dirty;
+		}
+		count_ = count;
+	}
+
+	void InstancesStore::SData::CopySlot(Index dst, Index src)
+	{
+		SChunk& dstChunk = ChunkOf(dst);
+		SChunk const& srcChunk = ChunkOf(src);
+		Index const d = dst % ChunkSize;
+		Index const s = src % ChunkSize;
+		dstChunk.transforms_[d] = srcChunk.transforms_[s];
+		dstChunk.colorShifts_[d] = srcChunk.colorShifts_[s];
+		dstChunk.animIds_[d] = srcChunk.animIds_[s];
+		dstChunk.flags_[d] = static_cast<std::uint8_t>(srcChunk.flags_[s] | EFlag::Dirty);
+	}
+
+	InstancesStore::InstancesStore()
+	{
+		auto data = data_.GetAutoLock();
+		// index 0 is reserved for "no animation"
+		data->animIdTable_.emplace_back();
+		data->animIdToIndex_[""] = 0;
+	}
+
+	InstancesStore::~InstancesStore()
+	{
+	}
+
+	std::size_t InstancesStore::GetCount() const
+	{
+		auto data = data_.GetRAutoLock();
+		return data->count_;
+	}
+
+	InstancesStore::Index InstancesStore::Add()
+	{
+		auto data = data_.GetAutoLock();
+		Index const index = static_cast<Index>(data->count_);
+		data->Resize(data->count_ + 1);
+		return index;
+	}
+
+	void InstancesStore::Resize(std::size_t count)
+	{
+		auto data = data_.GetAutoLock();
+		data->Resize(count);
+	}
+
+	void InstancesStore::RemoveAt(Index index, bool bSwapWithLast)
+	{
+		auto data = data_.GetAutoLock();
+		if (index >= data->count_)
+		{
+			BE_ISSUE("invalid instance index", index, data->count_);
+			return;
+		}
+		Index const last = static_cast<Index>(data->count_ - 1);
+		if (bSwapWithLast)
+		{
+			if (index != last)
+				data->CopySlot(index, last);
+		}
+		else
+		{
+			for (Index i = index; i < last; ++i)
+				data->CopySlot(i, i + 1);
+		}
+		data->Resize(last);
+	}
+
+	void InstancesStore::Clear()
+	{
+		auto data = data_.GetAutoLock();
+		data->chunks_.clear();
+		data->count_ = 0;
+	}
+
+	dmat3x4 InstancesStore::GetTransform(Index index) const
+	{
+		auto data = data_.GetRAutoLock();
+		BE_ASSERT(index < data->count_);
+		return data->ChunkOf(index).transforms_[index % ChunkSize];
+	}
+
+	void InstancesStore::SetTransform(Index index, const dmat3x4& mat)
+	{
+		auto data = data_.GetAutoLock();
+		BE_ASSERT(index < data->count_);
+		SChunk& chunk = data->ChunkOf(index);
+		chunk.transforms_[index % ChunkSize] = mat;
+		chunk.flags_[index % ChunkSize] |= EFlag::Dirty;
+	}
+
+	std::optional<float3> InstancesStore::GetColorShift(Index index) const
+	{
+		auto data = data_.GetRAutoLock();
+		BE_ASSERT(index < data->count_);
+		SChunk const& chunk = data->ChunkOf(index);
+		if (chunk.flags_[index % ChunkSize] & EFlag::HasColorShift)
+			return chunk.colorShifts_[index % ChunkSize];
+		return std::nullopt;
+	}
+
+	void InstancesStore::SetColorShift(Index index, const std::optional<float3>& color)
+	{
+		auto data = data_.GetAutoLock();
+		BE_ASSERT(index < data->count_);
+		SChunk& chunk = data->ChunkOf(index);
+		std::uint8_t& flags = chunk.flags_[index % ChunkSize];
+		if (color)
+		{
+			chunk.colorShifts_[index % ChunkSize] = *color;
+			flags |= EFlag::HasColorShift;
+		}
+		else
+		{
+			flags = static_cast<std::uint8_t>(flags & ~EFlag::HasColorShift);
+		}
+		flags |= EFlag::Dirty;
+	}
+
+	const std::string& InstancesStore::GetAnimId(Index index) const
+	{
+		auto data = data_.GetRAutoLock();
+		BE_ASSERT(index < data->count_);
+		return data->animIdTable_[data->ChunkOf(index).animIds_[index % ChunkSize]];
+	}
+
+	void InstancesStore::SetAnimId(Index index, const std::string& animId)
+	{
+		auto data = data_.GetAutoLock();
+		BE_ASSERT(index < data->count_);
+		auto it = data->animIdToIndex_.find(animId);
+		if (it == data->animIdToIndex_.end())
+		{
+			it = data->animIdToIndex_.emplace(animId, static_cast<std::uint32_t>(data->animIdTable_.size())).first;
+			data->animIdTable_.push_back(animId);
+		}
+		SChunk& chunk = data->ChunkOf(index);
+		chunk.animIds_[index % ChunkSize] = it->second;
+		chunk.flags_[index % ChunkSize] |= EFlag::Dirty;
+	}
+
+	bool InstancesStore::IsDirty(Index index) const
+	{
+		auto data = data_.GetRAutoLock();
+		BE_ASSERT(index < data->count_);
+		return (data->ChunkOf(index).flags_[index % ChunkSize] & EFlag::Dirty) != 0;
+	}
+
+	void InstancesStore::GetTransforms(Index first, std::size_t count, dmat3x4* out) const
+	{
+		auto data = data_.GetRAutoLock();
+		BE_ASSERT(first + count <= data->count_);
+		std::size_t done = 0;
+		while (done < count)
+		{
+			Index const index = static_cast<Index>(first + done);
+			std::size_t const offset = index % ChunkSize;
+			std::size_t const n = std::min<std::size_t>(count - done, ChunkSize - offset);
+			std::copy_n(&data->ChunkOf(index).transforms_[offset], n, out + done);
+			done += n;
+		}
+	}
+
+	void InstancesStore::SetTransforms(Index first, std::size_t count, const dmat3x4* in)
+	{
+		auto data = data_.GetAutoLock();
+		BE_ASSERT(first + count <= data->count_);
+		std::size_t done = 0;
+		while (done < count)
+		{
+			Index const index = static_cast<Index>(first + done);
+			std::size_t const offset = index % ChunkSize;
+			std::size_t const n = std::min<std::size_t>(count - done, ChunkSize - offset);
+			SChunk& chunk = data->ChunkOf(index);
+			std::copy_n(in + done, n, &chunk.transforms_[offset]);
+			for (std::size_t i = offset; i < offset + n; ++i)
+				chunk.flags_[i] |= EFlag::Dirty;
+			done += n;
+		}
+	}
+
+	void InstancesStore::SetTransforms(const Index* indices, std::size_t count, const dmat3x4* in)
+	{
+		auto data = data_.GetAutoLock();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			Index const index = indices[i];
+			BE_ASSERT(index < data->count_);
+			SChunk& chunk = data->ChunkOf(index);
+			chunk.transforms_[index % ChunkSize] = in[i];
+			chunk.flags_[index % ChunkSize] |= EFlag::Dirty;
+		}
+	}
+
+	std::vector<InstancesStore::Index> InstancesStore::GetDirtyIndices() const
+	{
+		auto data = data_.GetRAutoLock();
+		std::vector<Index> indices;
+		for (Index index = 0; index < data->count_; ++index)
+		{
+			if (data->ChunkOf(index).flags_[index % ChunkSize] & EFlag::Dirty)
+				indices.push_back(index);
+		}
+		return indices;
+	}
+
+	void InstancesStore::ClearDirtyFlags()
+	{
+		auto data = data_.GetAutoLock();
+		for (auto& chunk : data->chunks_)
+		{
+			for (auto& flags : chunk->flags_)
+				flags = static_cast<std::uint8_t>(flags & ~EFlag::Dirty);
+		}
+	}
+}
@@ -0,0 +1,150 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: InstancesStore.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#ifndef SDK_CPPMODULES
+	#include <array>
+	#include <cstdint>
+	#include <deque>
+	#include <memory>
+	#include <optional>
+	#include <shared_mutex>
+	#include <string>
+	#include <unordered_map>
+	#include <vector>
+	#ifndef MODULE_EXPORT
+		#define MODULE_EXPORT
+	#endif // !MODULE_EXPORT
+#endif
+
+#include <Core/Tools/Tools.h>
+#include <Core/Tools/Types.h>
+
+MODULE_EXPORT namespace AdvViz::SDK
+{
+	/// Packed storage for the per-instance data (transform, color shift, animation id and dirty flag) of
+	/// all the instances sharing the same object reference and group.
+	/// Data is stored as structure-of-arrays, in fixed-size chunks, so that the address of an element
+	/// never changes when the store grows. The whole store is protected by a single read/write lock:
+	/// prefer the bulk accessors (GetTransforms, SetTransforms, ForEachTransform...) to process many
+	/// instances.
+	class ADVVIZ_LINK InstancesStore
+	{
+	public:
+		using Index = std::uint32_t;
+		static constexpr Index ChunkSize = 256;
+
+		InstancesStore();
+		~InstancesStore();
+		InstancesStore(InstancesStore const&) = delete;
+		InstancesStore& operator=(InstancesStore const&) = delete;
+
+		std::size_t GetCount() const;
+		/// Append a new instance (identity transform, no color shift, no animation) and return its index.
+		Index Add();
+		/// Add or remove instances at the end of the store.
+		void Resize(std::size_t count);
+		/// Remove the instance at given index. If bSwapWithLast is true, the last instance is moved into
+		/// the removed slot, else all the following instances are shifted.
+		void RemoveAt(Index index, bool bSwapWithLast);
+		void Clear();
+
+		/// Single instance accessors (one lock per call). Values are returned by copy since the
+		/// store can be modified (or resized) by other threads once the lock is released; the
+		/// animation id table is append-only, so the returned string reference stays valid.
+		dmat3x4 GetTransform(Index index) const;
+		void SetTransform(Index index, const dmat3x4& mat);
+		std::optional<float3> GetColorShift(Index index) const;
+		void SetColorShift(Index index, const std::optional<float3>& color);
+		const std::string& GetAnimId(Index index) const;
+		void SetAnimId(Index index, const std::string& animId);
+		bool IsDirty(Index index) const;
+
+		/// Bulk accessors (one lock for the whole range).
+		void GetTransforms(Index first, std::size_t count, dmat3x4* out) const;
+		void SetTransforms(Index first, std::size_t count, const dmat3x4* in);
+		/// Set the transforms of the instances at given (arbitrary) indices.
+		void SetTransforms(const Index* indices, std::size_t count, const dmat3x4* in);
+		/// Call func(index, const dmat3x4&) for each instance, under a single read lock.
+		template<typename Func>
+		void ForEachTransform(Func&& func) const;
+		/// Call func(index, dmat3x4&) for each instance, under a single write lock. The instance is marked
+		/// as dirty if func returns true.
+		template<typename Func>
+		void UpdateTransforms(Func&& func);
+
+		/// Instances modified since the last call to ClearDirtyFlags.
+		std::vector<Index> GetDirtyIndices() const;
+		void ClearDirtyFlags();
+
+	private:
+		enum EFlag : std::uint8_t
+		{
+			HasColorShift = 0x1,
+			Dirty = 0x2,
+		};
+
+		struct SChunk
+		{
+			std::array<dmat3x4, ChunkSize> transforms_;
+			std::array<float3, ChunkSize> colorShifts_;
+			std::array<std::uint32_t, ChunkSize> animIds_; // index in animIdTable_
+			std::array<std::uint8_t, ChunkSize> flags_;
+		};
+
+		struct SData
+		{
+			std::vector<std::unique_ptr<SChunk>> chunks_;
+			std::size_t count_ = 0;
+			// Animation ids are shared by many instances: store them once (deque: references remain valid).
+			std::deque<std::string> animIdTable_;
+			std::unordered_map<std::string, std::uint32_t> animIdToIndex_;
+
+			inline SChunk& ChunkOf(Index index) { return *chunks_[index / ChunkSize]; }
+			inline const SChunk& ChunkOf(Index index) const { return *chunks_[index / ChunkSize]; }
+			void Resize(std::size_t count);
+			void CopySlot(Index dst, Index src);
+		};
+
+		Tools::RWLockableObject<SData, std::shared_mutex> data_;
+	};
+
+	template<typename Func>
+	void InstancesStore::ForEachTransform(Func&& func) const
+	{
+		auto data = data_.GetRAutoLock();
+		Index index = 0;
+		for (std::size_t c = 0; c < data->chunks_.size() && index < data->count_; ++c)
+		{
+			SChunk const& chunk = *data->chunks_[c];
+			Index const end = static_cast<Index>(std::min<std::size_t>(data->count_ - index, ChunkSize));
+			for (Index i = 0; i < end; ++i, ++index)
+				func(index, chunk.transforms_[i]);
+		}
+	}
+
+	template<typename Func>
+	void InstancesStore::UpdateTransforms(Func&& func)
+	{
+		auto data = data_.GetAutoLock();
+		Index index = 0;
+		for (std::size_t c = 0; c < data->chunks_.size() && index < data->count_; ++c)
+		{
+			SChunk& chunk = *data->chunks_[c];
+			Index const end = static_cast<Index>(std::min<std::size_t>(data->count_ - index, ChunkSize));
+			for (Index i = 0; i < end; ++i, ++index)
+			{
+				if (func(index, chunk.transforms_[i]))
+					chunk.flags_[i] |= EFlag::Dirty;
+			}
+		}
+	}
+
+	using InstancesStorePtr = std::shared_ptr<InstancesStore>;
+}
@@ -8,6 +8,7 @@
 
 
 #include "KeyframeAnimation.h"
+#include "KeyframeCodec.h"
 #include "Core/Network/HttpGetWithLink.h"
 #include "Core/Singleton/singleton.h"
 #include "Config.h"
@@ -242,7 +243,31 @@ namespace AdvViz::SDK
 			SAnimationChunk jout;
 			BE_ASSERT((bool)http_);
 			std::string url = "animations/" + animationId_ + "/animationKeyFramesChunks/" + serverSideData_.id.value();
-			if (http_->GetJson(jout, url) != 200)
+			const auto encoding = KeyframeCodec::GetPreferredEncoding();
+			if (encoding != KeyframeCodec::EEncoding::Json)
+			{
+				auto r = http_->Get(url, { {"accept", KeyframeCodec::GetAcceptHeader(encoding)} });
+				if (r.first != 200)
+					return make_unexpected("AnimationKeyframeChunk::Load failed");
+				IAnimationKeyframeInfo::TimelineResult keyframes;
+				auto decoded = KeyframeCodec::DecodeResponse(r, *http_, keyframes);
+				if (!decoded)
+					return make_unexpected("AnimationKeyframeChunk::Load failed: " + decoded.error());
+				if (decoded.value())
+				{
+					serverSideData_.translations = std::move(keyframes.translations);
+					serverSideData_.quaternions = std::move(keyframes.quaternions);
+					serverSideData_.scales = std::move(keyframes.scales);
+					serverSideData_.stateIds = std::move(keyframes.stateIds);
+					serverSideData_.boundingBox = keyframes.boundingBox;
+					serverSideData_.timeRange = keyframes.timeRange;
+					return {};
+				}
+				// the server answered in JSON
+				if (!Json::FromString(jout, r.second))
+					return make_unexpected("AnimationKeyframeChunk::Load failed (json parse error)");
+			}
+			else if (http_->GetJson(jout, url) != 200)
 				return make_unexpected("AnimationKeyframeChunk::Delete failed");
 
 			BE_ASSERT(jout.id.value() == serverSideData_.id.value());
@@ -812,7 +837,38 @@ namespace AdvViz::SDK
 		std::string url = "animations/" + impl.animationId_ + "/query/animationKeyFrames";
 
 		BE_ASSERT((bool)impl.http_);
-		impl.http_->AsyncPostJsonJBody(dataPtr, callbackfct, url, jin);
+		const auto encoding = KeyframeCodec::GetPreferredEncoding();
+		if (encoding == KeyframeCodec::EEncoding::Json)
+		{
+			impl.http_->AsyncPostJsonJBody(dataPtr, callbackfct, url, jin);
+			return {};
+		}
+
+		Http::Headers h;
+		h.emplace_back("accept", KeyframeCodec::GetAcceptHeader(encoding));
+		h.emplace_back("Content-Type", "application/json; charset=UTF-8");
+		if (auto token = impl.http_->GetAccessToken(); token && !token->IsEmpty())
+			h.emplace_back("Authorization", std::string("Bearer ") + *token->Get());
+		std::weak_ptr<Http> httpW(impl.http_);
+		impl.http_->AsyncPost([dataPtr, callbackfct, url, httpW](const Http::Response& r) {
+				long httpResult = r.first;
+				auto http = httpW.lock();
+				if (Http::IsSuccessful(r) && http)
+				{
+					auto dataLock(dataPtr->GetAutoLock());
+					auto decoded = KeyframeCodec::DecodeResponse(r, *http, dataLock.Get());
+					if (!decoded)
+					{
+						BE_LOGE("keyframeAnim", "AsyncQueryKeyframes: " << decoded.error() << " url: " << url);
+						httpResult = 500; // internal error during parsing
+					}
+					else if (!decoded.value() && !Json::FromString(dataLock.Get(), r.second))
+						httpResult = 500;
+				}
+				else
+					BE_LOGE("keyframeAnim", "AsyncQueryKeyframes failed code: " << r.first << " url: " << url);
+				callbackfct(httpResult, dataPtr);
+			}, url, Http::BodyParams(Json::ToString(jin)), h);
 
 		return {};
 	}
@@ -838,8 +894,23 @@ namespace AdvViz::SDK
 		std::string url = "animations/" + impl.animationId_ + "/query/animationKeyFrames";
 
 		BE_ASSERT((bool)impl.http_);
-		if (impl.http_->PostJsonJBody(jout, url, jin) != 200)
+		const auto encoding = KeyframeCodec::GetPreferredEncoding();
+		if (encoding == KeyframeCodec::EEncoding::Json)
+		{
+			if (impl.http_->PostJsonJBody(jout, url, jin) != 200)
+				return make_unexpected(std::string("query:") + url + " failed.");
+			return expected<void, std::string>();
+		}
+
+		auto r = impl.http_->Post(url, Http::BodyParams(Json::ToString(jin)),
+			{ {"accept", KeyframeCodec::GetAcceptHeader(encoding)}, {"Content-Type", "application/json; charset=UTF-8"} });
+		if (r.first != 200)
 			return make_unexpected(std::string("query:") + url + " failed.");
+		auto decoded = KeyframeCodec::DecodeResponse(r, *impl.http_, jout);
+		if (!decoded)
+			return make_unexpected(std::string("query:") + url + " failed: " + decoded.error());
+		if (!decoded.value() && !Json::FromString(jout, r.second))
+			return make_unexpected(std::string("query:") + url + " failed (json parse error).");
 
 		return expected<void, std::string>();
 	}
@@ -10,15 +10,15 @@
 
 #include "KeyframeAnimator.h"
 #include "KeyframeAnimation.h"
+#include "KeyframeBatch.h"
+#include "KeyframePrefetch.h"
 #include "InstancesManager.h"
 #include "Core/Tools/FactoryClassInternalHelper.h"
-#ifndef GLM_ENABLE_EXPERIMENTAL
-#define GLM_ENABLE_EXPERIMENTAL
-#endif
-#include <glm/gtx/quaternion.hpp>
-#include <glm/gtc/type_ptr.hpp>
 #include "Core/Tools/Log.h"
 
+#include <chrono>
+#include <cmath>
+
 //#define DEBUGCULLING //D-O-NOTC
 
 namespace AdvViz::SDK
@@ -40,68 +40,32 @@ namespace AdvViz::SDK
 	class InstanceWithPathExt : public Tools::Extension, public Tools::TypeId<InstanceWithPathExt>, public std::enable_shared_from_this<InstanceWithPathExt>
 	{
 	public:
-		typedef std::map<TimeRange, TimelineResultLockPtr, std::less<>> TTimelineResults; // order is reversed
+		typedef std::map<TimeRange, KeyframePrefetcher::WindowPtr, std::less<>> TTimelineResults; // order is reversed
 
-		InstanceWithPathExt(const IInstancePtr inst, const IAnimationKeyframeInfoWPtr kfInfo, const std::weak_ptr<IGCSTransform> &trans):instance_(inst), kfInfoPtr_(kfInfo), transform_(trans)
+		InstanceWithPathExt(const IInstancePtr inst, const IAnimationKeyframeInfoWPtr kfInfo, const std::shared_ptr<KeyframePrefetcher>& prefetcher)
+			:instance_(inst), kfInfoPtr_(kfInfo), prefetcher_(prefetcher)
 		{}
 
-		bool ProcessTransform(float time)
+		// Add the keyframes surrounding time to the batch. Returns false if they are not available (yet).
+		bool GatherKeyframes(float time, KeyframeBatch& batch)
 		{
-			auto kfInfoPtr = kfInfoPtr_.lock(); // lock shared_ptr
-			if (kfInfoPtr)
-			{
-				auto autoKeyframeslock(keyframes_.GetRAutoLock());
-				auto it = autoKeyframeslock.Get().lower_bound(time);
-				if (it == autoKeyframeslock.Get().end())
-					return false;
-				if (it->second.get() == nullptr)
-					return false;
-
-				auto autoResulock(it->second.get()->GetRAutoLock());
-				auto autolock(kfInfoPtr->GetRAutoLock());
-				const auto& kfInfo = autolock.Get();
-				if (autoResulock.Get().translations.empty())
-					return false;
-				IAnimationKeyframeInfo::TimelineValue value;
-				auto ret = kfInfo.GetInterpolatedValue(autoResulock.Get(), time, value);
-				if (!ret)
-					return false;
-				glm::mat3 matrix(glm::mat3_cast(glm::make_quat(&value.quaternion[0])));
-				if (value.scale.has_value())
-				{
-					auto& s = value.scale.value();
-					matrix[0] *= s[0];
-					matrix[1] *= s[1];
-					matrix[2] *= s[2];
-				}
-				dmat3x4 mat2;
-				for (int i = 0; i < 3; i++)
-					for (int j = 0; j < 3; j++)
-						ColRow3x4(mat2, i, j) = matrix[i][j];
-
-				double3 tr = { value.translation[0], value.translation[1], value.translation[2]};
-				if (auto transform = transform_.lock())
-					tr = transform->PositionToClient(tr);
-				
-				ColRow3x4(mat2, 0, 3) = tr[0];
-				ColRow3x4(mat2, 1, 3) = tr[1];
-				ColRow3x4(mat2, 2, 3) = tr[2];
-				auto instanceLock = instance_->GetAutoLock();
-				instanceLock->SetTransform(mat2);
-
-				#ifdef DEBUGCULLING
-					float3 col = { 1.f, 1.f, 1.f };
-					instance_->SetColorShift(col);
-				#endif
-				return true;
-			}
-			return false;
+			if (kfInfoPtr_.expired())
+				return false;
+			auto autoKeyframeslock(keyframes_.GetRAutoLock());
+			auto it = autoKeyframeslock.Get().lower_bound(time);
+			if (it == autoKeyframeslock.Get().end())
+				return false;
+			if (it->second->data_.get() == nullptr)
+				return false;
+
+			prefetcher_->Touch(*it->second);
+			auto autoResulock(it->second->data_->GetRAutoLock());
+			return batch.Add(autoResulock.Get(), time);
 		}
-		
-		const dmat3x4& GetTransform() const
+
+		const IInstancePtr& GetInstance() const
 		{
-			auto instanceLock = instance_->GetRAutoLock();
-			return instanceLock.Get().GetTransform();
+			return instance_;
 		}
 
 		void Update()
@@ -131,52 +95,78 @@ namespace AdvViz::SDK
 
 		void RequestLoad(const TimeRange &timeRange)
 		{
-			auto autoKeyframeslock(keyframes_.GetRAutoLock());
-			auto it = autoKeyframeslock->find(timeRange);
-			if (it == autoKeyframeslock->end())
 			{
-				// Check if a request is not already in progress
-				{
-					auto loadInProgressLoked = loadInProgress_.GetAutoLock();
-					auto pair = loadInProgressLoked->insert(timeRange);
-					if (pair.second == false)
-						return;
-				}
+				auto autoKeyframeslock(keyframes_.GetRAutoLock());
+				if (autoKeyframeslock->find(timeRange) != autoKeyframeslock->end())
+					return;
+			}
+			// The window may have been left behind (scrubbing) while this request was waiting.
+			if (!prefetcher_->IsWanted(timeRange))
+				return;
 
-				std::weak_ptr<InstanceWithPathExt> thisW(shared_from_this());
-				auto keyframes = MakeSharedLockableData<IAnimationKeyframeInfo::TimelineResult>();
-				auto kfInfoPtr = kfInfoPtr_.lock(); // lock shared_ptr
-				if (!kfInfoPtr) //IAnimationKeyframeInfo has been deleted
+			// Check if a request is not already in progress
+			{
+				auto loadInProgressLoked = loadInProgress_.GetAutoLock();
+				auto pair = loadInProgressLoked->insert(timeRange);
+				if (pair.second == false)
 					return;
+			}
 
-				auto autolock(kfInfoPtr->GetRAutoLock());
-				const auto& kfInfo = autolock.Get();
-				std::string kjInfoId = (std::string)kfInfo.GetId();
-				BE_LOGD("keyframeAnim", "AsyncQueryKeyframes(" << kjInfoId << "): timeRange:" << timeRange.begin << ", " << timeRange.end);
-				kfInfo.AsyncQueryKeyframes(keyframes,
-					[timeRange, thisW, kjInfoId=move(kjInfoId)](long httpRes, const TSharedLockableData<IAnimationKeyframeInfo::TimelineResult>& keyframes) {
-						BE_LOGD("keyframeAnim", "AsyncQueryKeyframesEnd(" << kjInfoId << "): timeRange:" << timeRange.begin << ", " << timeRange.end);
-						auto This(thisW.lock());
-						if (This)
+			std::weak_ptr<InstanceWithPathExt> thisW(shared_from_this());
+			auto keyframes = MakeSharedLockableData<IAnimationKeyframeInfo::TimelineResult>();
+			auto kfInfoPtr = kfInfoPtr_.lock(); // lock shared_ptr
+			if (!kfInfoPtr) //IAnimationKeyframeInfo has been deleted
+				return;
+
+			auto autolock(kfInfoPtr->GetRAutoLock());
+			const auto& kfInfo = autolock.Get();
+			std::string kjInfoId = (std::string)kfInfo.GetId();
+			BE_LOGD("keyframeAnim", "AsyncQueryKeyframes(" << kjInfoId << "): timeRange:" << timeRange.begin << ", " << timeRange.end);
+			prefetcher_->OnRequest();
+			kfInfo.AsyncQueryKeyframes(keyframes,
+				[timeRange, thisW, kjInfoId=move(kjInfoId), start = std::chrono::steady_clock::now()](long httpRes, const TSharedLockableData<IAnimationKeyframeInfo::TimelineResult>& keyframes) {
+					BE_LOGD("keyframeAnim", "AsyncQueryKeyframesEnd(" << kjInfoId << "): timeRange:" << timeRange.begin << ", " << timeRange.end);
+					auto This(thisW.lock());
+					if (This)
+					{
 						{
-							{
-								auto loadInProgressLocked = This->loadInProgress_.GetAutoLock();
-								loadInProgressLocked->erase(timeRange);
-							}
-
-							if (!(200 <= httpRes && httpRes < 300))
-								return;
-							This->AddKeyframes(timeRange, keyframes);
+							auto loadInProgressLocked = This->loadInProgress_.GetAutoLock();
+							loadInProgressLocked->erase(timeRange);
 						}
-					},
-					timeRange.begin, timeRange.end - timeRange.begin);
-			}
+
+						const bool bStale = !This->prefetcher_->IsWanted(timeRange);
+						This->prefetcher_->OnResponse(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(), bStale);
+						if (bStale || !(200 <= httpRes && httpRes < 300))
+							return;
+						This->AddKeyframes(timeRange, keyframes);
+					}
+				},
+				timeRange.begin, timeRange.end - timeRange.begin);
 		}
 
 		void AddKeyframes(const TimeRange& timeRange, const TimelineResultLockPtr &p)
+		{
+			auto window = std::make_shared<KeyframePrefetcher::Window>();
+			window->data_ = p;
+			window->range_ = timeRange;
+			std::weak_ptr<InstanceWithPathExt> thisW(shared_from_this());
+			window->onEvict_ = [thisW, timeRange]() {
+				if (auto This = thisW.lock())
+					This->RemoveKeyframes(timeRange);
+				};
+			{
+				auto lock = keyframes_.GetAutoLock();
+				if (!lock.Get().insert(std::make_pair(timeRange, window)).second)
+					return;
+			}
+			// note: keyframes_ must not be locked here, the prefetcher may evict windows of this item.
+			prefetcher_->Insert(window);
+		}
+
+		void RemoveKeyframes(const TimeRange& timeRange)
 		{
 			auto lock = keyframes_.GetAutoLock();
-			lock.Get().insert(std::make_pair(timeRange, p));
+			lock.Get().erase(timeRange);
 		}
 
 		using Tools::TypeId<InstanceWithPathExt>::GetTypeId;
@@ -184,9 +174,9 @@ namespace AdvViz::SDK
 	private:
 		IInstancePtr instance_;
 		IAnimationKeyframeInfoWPtr kfInfoPtr_;
+		std::shared_ptr<KeyframePrefetcher> prefetcher_;
 		Tools::RWLockableObject<TTimelineResults> keyframes_;
 		Tools::RWLockableObject<std::set<TimeRange>> loadInProgress_;
-		std::weak_ptr<IGCSTransform> transform_;
 	};
 
 	class KeyframeAnimator::Impl
@@ -204,9 +194,67 @@ namespace AdvViz::SDK
 		IKeyframeAnimator::Stat stat_;
 		bool bStatEnable = false;
 
-		double lastGetKeyframeInfoTime_ = -1.0f;
-		double lastGetKeyframeInfoTime2_ = -1.0f;
+		// Keyframe windows to load, and loaded windows of all the items.
+		std::shared_ptr<KeyframePrefetcher> prefetcher_ = std::make_shared<KeyframePrefetcher>();
+		std::optional<float> playbackSpeed_;
+		// Playback speed estimation, when it is not given.
+		float estimatedSpeed_ = 1.f;
+		bool hasLastProcess_ = false;
+		float lastProcessTime_ = 0.f;
+		std::chrono::steady_clock::time_point lastProcessClock_;
+
 		std::vector<BoundingBox> boundingBoxesTransformed_;
+
+		// Extensions of the processed items, to avoid locking each info to find them at each frame.
+		std::map<IAnimationKeyframeInfo::Id, std::weak_ptr<InstanceWithPathExt>> extensions_;
+
+		// Per frame buffers, kept to avoid reallocations.
+		struct SItem
+		{
+			std::shared_ptr<InstanceWithPathExt> ext_;
+			std::set<IAnimationKeyframeInfo::Id>::iterator infoIt_;
+		};
+		std::vector<SItem> items_;
+		std::vector<std::shared_ptr<InstanceWithPathExt>> notReadyItems_;
+		KeyframeBatch batch_;
+		std::vector<dmat3x4> transforms_;
+		BoundingBoxGrid grid_;
+
+		std::shared_ptr<InstanceWithPathExt> GetExtension(const IAnimationKeyframe& animationKeyframe, const IAnimationKeyframeInfo::Id& infoId)
+		{
+			auto it = extensions_.find(infoId);
+			if (it != extensions_.end())
+			{
+				if (auto ext = it->second.lock())
+					return ext;
+			}
+			auto info = animationKeyframe.GetAnimationKeyframeInfo(infoId);
+			if (!info)
+				return {};
+			auto lockInfo(info->GetRAutoLock());
+			auto ext = lockInfo->GetExtension<InstanceWithPathExt>();
+			if (ext)
+				extensions_[infoId] = ext;
+			return ext;
+		}
+
+		float GetPlaybackSpeed(float time)
+		{
+			if (playbackSpeed_)
+				return *playbackSpeed_;
+			const auto now = std::chrono::steady_clock::now();
+			if (hasLastProcess_)
+			{
+				const double elapsed = std::chrono::duration<double>(now - lastProcessClock_).count();
+				// jumps are not playback
+				if (elapsed > 0.0 && std::fabs(time - lastProcessTime_) <= prefetcher_->GetConfig().scrubThreshold)
+					estimatedSpeed_ = 0.8f * estimatedSpeed_ + 0.2f * (float)((time - lastProcessTime_) / elapsed);
+			}
+			hasLastProcess_ = true;
+			lastProcessTime_ = time;
+			lastProcessClock_ = now;
+			return estimatedSpeed_;
+		}
 	};
 
 	KeyframeAnimator::KeyframeAnimator(): impl_(new Impl)
@@ -232,7 +280,7 @@ namespace AdvViz::SDK
 
 		auto lock(animationKeyframePtr->GetAutoLock());
 		IAnimationKeyframe& animationKeyframe = lock.Get();
-		auto transform = animationKeyframe.GetGCSTransform();
+		GetImpl().extensions_.clear();
 		//const SharedInstVect& instances = GetImpl().population->GetInstanceManager()->GetInstancesByObjectRef(GetImpl().population->GetObjectRef(), GetImpl().population->GetInstancesGroup()->GetId());
 		for (auto& it : instances)
 		{
@@ -243,7 +291,7 @@ namespace AdvViz::SDK
 				auto& keyframeInfoId = instanceLock->GetAnimId();
 				auto animInfo = animationKeyframe.GetAnimationKeyframeInfo(IAnimationKeyframeInfo::Id(keyframeInfoId));
 				auto lockInfo(animInfo->GetAutoLock());
-				lockInfo->AddExtension(std::make_shared<InstanceWithPathExt>(inst, animInfo, transform));
+				lockInfo->AddExtension(std::make_shared<InstanceWithPathExt>(inst, animInfo, GetImpl().prefetcher_));
 			}
 		}
 
@@ -254,8 +302,23 @@ namespace AdvViz::SDK
 
 	void KeyframeAnimator::OnResetTime()
 	{
-		GetImpl().lastGetKeyframeInfoTime_ = -1.0;
-		GetImpl().lastGetKeyframeInfoTime2_ = -1.0;
+		GetImpl().prefetcher_->Reset();
+		GetImpl().hasLastProcess_ = false;
+	}
+
+	void KeyframeAnimator::SetPlaybackSpeed(float speed)
+	{
+		GetImpl().playbackSpeed_ = speed;
+	}
+
+	void KeyframeAnimator::SetPrefetchConfig(const KeyframePrefetcher::Config& config)
+	{
+		GetImpl().prefetcher_->SetConfig(config);
+	}
+
+	KeyframePrefetcher::Config KeyframeAnimator::GetPrefetchConfig() const
+	{
+		return GetImpl().prefetcher_->GetConfig();
 	}
 
 	void KeyframeAnimator::EnableStat(bool b)
@@ -280,12 +343,18 @@ namespace AdvViz::SDK
 		std::uint64_t requestCounter = requestCounterG; requestCounterG++;
 		TSharedLockableData<std::set<IAnimationKeyframeInfo::Id>> infoIds = MakeSharedLockableData<std::set<IAnimationKeyframeInfo::Id>>();
 		auto bboxInfoIds = GetImpl().bboxInfoIds_;
+		auto prefetcher = GetImpl().prefetcher_;
 		BE_LOGD("keyframeAnim", "AsyncQueryKeyframesInfos(" << requestCounter << ") " << " timeRange:" << timeRange.begin <<", " << timeRange.end);
 		// retreive keyframesinfo that match timerange & boundingboxes
-		auto ret = animationKeyframe.AsyncQueryKeyframesInfos(infoIds, [updateCurrentInfo, timeRange, animationKeyframePtr, requestCounter, bboxInfoIds](long httpRes, std::set<IAnimationKeyframeInfo::Id>& infoIds) {
+		auto ret = animationKeyframe.AsyncQueryKeyframesInfos(infoIds, [updateCurrentInfo, timeRange, animationKeyframePtr, requestCounter, bboxInfoIds, prefetcher](long httpRes, std::set<IAnimationKeyframeInfo::Id>& infoIds) {
 			if (!(200 <= httpRes && httpRes < 300))
 				return;
 			BE_LOGD("keyframeAnim", "AsyncQueryKeyframesInfos(" << requestCounter << ") End");
+			if (!prefetcher->IsWanted(timeRange))
+			{
+				BE_LOGD("keyframeAnim", "AsyncQueryKeyframesInfos(" << requestCounter << ") dropped, timeRange:" << timeRange.begin << ", " << timeRange.end);
+				return;
+			}
 
 			// for each keyframesinfo check if keyframe are not already in memory, else query them
 			for (auto& infoId : infoIds)
@@ -377,100 +446,153 @@ namespace AdvViz::SDK
 			boundingBoxesTransformed = clientBoundingBoxes;
 		}
 
-		if (time > GetImpl().lastGetKeyframeInfoTime_ + 1.0)
+		// query the items of the current window, and prefetch the next ones
 		{
-			GetImpl().lastGetKeyframeInfoTime_ = time;
-
-			BE_LOGD("keyframeAnim", "AsyncQueryKeyframesInfos time:" << time);
-
-			// query current with time
-			TimeRange timeRange1;
-			{
-				timeRange1.begin = std::floor((time+1.0f) / 20.0f) * 20.0f;
-				timeRange1.end = timeRange1.begin + 20.0f;
-				QueryKeyFrameInfos(boundingBoxesTransformed, timeRange1, true /*updateCurrentInfo*/);
-			}
-
-			// query futur : current time + 10s
-			if (time > GetImpl().lastGetKeyframeInfoTime2_ + 5.0)
+			const float speed = GetImpl().GetPlaybackSpeed(time);
+			const KeyframePrefetcher::Plan plan = GetImpl().prefetcher_->Update(time, speed);
+			if (plan.scrubbed)
+				BE_LOGD("keyframeAnim", "Scrub to time:" << time);
+			if (plan.queryCurrent)
 			{
-				GetImpl().lastGetKeyframeInfoTime2_ = time;
-				TimeRange timeRange;
-				timeRange.begin = std::ceil((time + 10.0f) / 20.0f) * 20.0f;
-				timeRange.end = timeRange.begin + 20.0f;
-				if (std::fabs(timeRange.begin - timeRange1.begin) > 1.0f)
-					QueryKeyFrameInfos(boundingBoxesTransformed, timeRange, false /*updateCurrentInfo*/);
+				BE_LOGD("keyframeAnim", "AsyncQueryKeyframesInfos time:" << time << " speed:" << speed);
+				QueryKeyFrameInfos(boundingBoxesTransformed, plan.current, true /*updateCurrentInfo*/);
 			}
-				
+			for (const auto& timeRange : plan.ahead)
+				QueryKeyFrameInfos(boundingBoxesTransformed, timeRange, false /*updateCurrentInfo*/);
 		}
 
-
 		auto animationKeyframePtr = GetImpl().animationKeyframe_.lock();
 		if (!animationKeyframePtr)
 			return make_unexpected("no animationKeyframe associated");
 		auto lock(animationKeyframePtr->GetRAutoLock());
 		const IAnimationKeyframe& animationKeyframe = lock.Get();
 
-		bool bStatEnable = GetImpl().bStatEnable;
-		auto& stat = GetImpl().stat_;
+		Impl& impl = GetImpl();
+		bool bStatEnable = impl.bStatEnable;
+		auto& stat = impl.stat_;
 
 		if (bStatEnable)
 			stat.numberPerBbox.clear();
 
-		auto infosIdLock = GetImpl().bboxInfoIds_->GetRAutoLock();
-		GetImpl().infoIds_.insert(infosIdLock.Get().second.begin(), infosIdLock.Get().second.end());
+		auto infosIdLock = impl.bboxInfoIds_->GetRAutoLock();
+		impl.infoIds_.insert(infosIdLock.Get().second.begin(), infosIdLock.Get().second.end());
 		if (bStatEnable)
 			stat.numberPerBbox.push_back((unsigned)infosIdLock.Get().second.size());
 
-		//const std::shared_ptr<const std::vector<BoundingBox>> bboxPtr = std::make_shared<std::vector<BoundingBox>>(clientBoundingBoxes);
-
-		stat.beforeCullingItems = (unsigned)GetImpl().infoIds_.size();
+		stat.beforeCullingItems = (unsigned)impl.infoIds_.size();
 		stat.itemsHidden = 0;
-		// update populations
-		for (auto it = GetImpl().infoIds_.begin(); it != GetImpl().infoIds_.end();)
+
+		using Clock = std::chrono::steady_clock;
+		auto const ElapsedMs = [](Clock::time_point& start) {
+			auto const now = Clock::now();
+			double const ms = std::chrono::duration<double, std::milli>(now - start).count();
+			start = now;
+			return ms;
+		};
+		auto phaseStart = Clock::now();
+
+		// 1. gather the keyframes of all the items into contiguous arrays
+		impl.items_.clear();
+		impl.notReadyItems_.clear();
+		impl.batch_.Clear();
+		for (auto it = impl.infoIds_.begin(); it != impl.infoIds_.end(); ++it)
 		{
-			const auto& infoId = *it;
-			auto info = animationKeyframe.GetAnimationKeyframeInfo(IAnimationKeyframeInfo::Id(infoId));
-			if (!info)
+			auto ext = impl.GetExtension(animationKeyframe, *it);
+			if (!ext)
 				continue;
-			auto lockInfo(info->GetRAutoLock());
-			if (auto ext = lockInfo->GetExtension<InstanceWithPathExt>())
+			if (ext->GatherKeyframes(time, impl.batch_))
 			{
-				bool erase = [this, ext, time, &clientBoundingBoxes, infoId]() {
-					bool validTrans = ext->ProcessTransform(time);
-					if (!validTrans) // we keep the item because it's probably just not ready (download in progress)
-					{
-						ext->Hide();
-						return false;
-					}
-					const dmat3x4& trans = ext->GetTransform(); //is in client coordinate system
-					double3 pos = { ColRow3x4(trans, 0, 3), ColRow3x4(trans, 1, 3), ColRow3x4(trans, 2, 3) };
-					for (auto& bb : clientBoundingBoxes)
-						if (bb.Contains(pos))
-						{
-							ext->Update();
-							return false;
-						}
-					ext->Hide();
-					return true;					
-				}();
-				if (erase)
-				{
-					it = GetImpl().infoIds_.erase(it);
-					stat.itemsHidden++;
-				}
-				else
-					++it;
+				impl.items_.push_back({ ext, it });
+				impl.prefetcher_->OnHit();
+			}
+			else // we keep the item because it's probably just not ready (download in progress)
+			{
+				impl.notReadyItems_.push_back(ext);
+				impl.prefetcher_->OnMiss();
+			}
+		}
+		stat.gatherTime = ElapsedMs(phaseStart);
+
+		// 2. interpolate all of them at once
+		std::vector<dmat3x4>& transforms = impl.transforms_;
+		impl.batch_.Interpolate(transforms);
+		if (transform)
+		{
+			for (auto& mat : transforms)
+			{
+				double3 tr = { ColRow3x4(mat, 0, 3), ColRow3x4(mat, 1, 3), ColRow3x4(mat, 2, 3) };
+				tr = transform->PositionToClient(tr);
+				ColRow3x4(mat, 0, 3) = tr[0];
+				ColRow3x4(mat, 1, 3) = tr[1];
+				ColRow3x4(mat, 2, 3) = tr[2];
+			}
+		}
+		stat.interpolationTime = ElapsedMs(phaseStart);
+
+		// 3. cull against the client bounding boxes: culled items are hidden (null transform)
+		impl.grid_.Build(clientBoundingBoxes);
+		std::vector<bool> visible(transforms.size());
+		for (size_t i = 0; i < transforms.size(); ++i)
+		{
+			const dmat3x4& mat = transforms[i];
+			visible[i] = impl.grid_.Contains(double3{ ColRow3x4(mat, 0, 3), ColRow3x4(mat, 1, 3), ColRow3x4(mat, 2, 3) });
+#ifndef DEBUGCULLING
+			if (!visible[i])
+				transforms[i].fill(0.0);
+#endif
+		}
+		stat.cullingTime = ElapsedMs(phaseStart);
+
+		// 4. write all the transforms (one lock per instance store), then notify the instances
+		std::map<InstancesStore*, std::pair<std::vector<InstancesStore::Index>, std::vector<dmat3x4>>> storeUpdates;
+		for (size_t i = 0; i < impl.items_.size(); ++i)
+		{
+			auto instanceLock = impl.items_[i].ext_->GetInstance()->GetAutoLock();
+			if (const auto& store = instanceLock->GetStore())
+			{
+				auto& update = storeUpdates[store.get()];
+				update.first.push_back(instanceLock->GetStoreIndex());
+				update.second.push_back(transforms[i]);
+			}
+			else
+			{
+				instanceLock->SetTransform(transforms[i]);
+			}
+		}
+		for (auto& [store, update] : storeUpdates)
+			store->SetTransforms(update.first.data(), update.first.size(), update.second.data());
+
+		for (size_t i = 0; i < impl.items_.size(); ++i)
+		{
+			auto& item = impl.items_[i];
+#ifdef DEBUGCULLING
+			{
+				float3 col = visible[i] ? float3{ 1.f, 1.f, 1.f } : float3{ 1.f, 0.f, 0.f };
+				item.ext_->GetInstance()->GetAutoLock()->SetColorShift(col);
+			}
+#endif
+			item.ext_->Update();
+			if (!visible[i])
+			{
+				impl.infoIds_.erase(item.infoIt_);
+				stat.itemsHidden++;
 			}
 		}
+		for (auto& ext : impl.notReadyItems_)
+			ext->Hide();
+		stat.updateTime = ElapsedMs(phaseStart);
+		stat.prefetch = impl.prefetcher_->GetCounters();
 
 		if (bStatEnable)
 		{
-			stat.numberVisibleItems = (unsigned)GetImpl().infoIds_.size();
+			stat.numberVisibleItems = (unsigned)impl.infoIds_.size();
 			std::stringstream s;
 			for (unsigned i = 0; i < stat.numberPerBbox.size(); ++i)
 				s << "\n" << i << ":" << stat.numberPerBbox[i];
-			BE_LOGD("keyframeAnim", "Stats:" << s.str() << "\n" << " itemsHidden:" << stat.itemsHidden << " numberVisibleItems" << stat.numberVisibleItems << " beforeCulling:" << stat.beforeCullingItems);
+			BE_LOGD("keyframeAnim", "Stats:" << s.str() << "\n" << " itemsHidden:" << stat.itemsHidden << " numberVisibleItems" << stat.numberVisibleItems << " beforeCulling:" << stat.beforeCullingItems
+				<< " gather:" << stat.gatherTime << "ms interpolation:" << stat.interpolationTime << "ms culling:" << stat.cullingTime << "ms update:" << stat.updateTime << "ms"
+				<< "\n prefetch hits:" << stat.prefetch.hits << " misses:" << stat.prefetch.misses << " requests:" << stat.prefetch.requests << " cancelled:" << stat.prefetch.cancelled
+				<< " evictions:" << stat.prefetch.evictions << " cached:" << stat.prefetch.cachedBytes << "B latency:" << stat.prefetch.averageLatency << "ms");
 		}
 
 		return {};
@@ -11,6 +11,7 @@
 #include <string>
 #include "Core/Tools/Tools.h"
 #include "KeyframeAnimation.h"
+#include "KeyframePrefetch.h"
 
 namespace AdvViz::SDK
 {
@@ -27,6 +28,13 @@ namespace AdvViz::SDK
 			unsigned beforeCullingItems;
 			unsigned itemsHidden;
 			std::vector<unsigned> numberPerBbox;
+			// Duration of each phase of the last Process call, in milliseconds.
+			double gatherTime = 0.0;
+			double interpolationTime = 0.0;
+			double cullingTime = 0.0;
+			double updateTime = 0.0;
+			// Keyframe loading, since the creation of the animator.
+			KeyframePrefetcher::Counters prefetch;
 		};
 		virtual expected<void, std::string> AssociateInstances(const IInstancesGroupPtr& gpPtr) = 0;
 		virtual expected<void, std::string> Process(float time, const std::vector<AdvViz::SDK::BoundingBox>& boundingBoxes, bool cameraMoved) = 0;
@@ -34,6 +42,11 @@ namespace AdvViz::SDK
 		virtual IAnimationKeyframePtr GetAnimation() const = 0;
 		virtual void SetInstanceManager(const std::shared_ptr<IInstancesManager>& instanceManager) = 0;
 		virtual void OnResetTime() = 0;
+		/// Playback speed, negative when playing backward. If it is not set, it is estimated from the
+		/// times passed to Process.
+		virtual void SetPlaybackSpeed(float speed) = 0;
+		virtual void SetPrefetchConfig(const KeyframePrefetcher::Config& config) = 0;
+		virtual KeyframePrefetcher::Config GetPrefetchConfig() const = 0;
 		virtual void EnableStat(bool b) = 0;
 		virtual const Stat& GetStat() const = 0;
 	};
@@ -48,6 +61,9 @@ namespace AdvViz::SDK
 		IAnimationKeyframePtr GetAnimation() const override;
 		void SetInstanceManager(const std::shared_ptr<IInstancesManager>& instanceManager) override;
 		void OnResetTime() override;
+		void SetPlaybackSpeed(float speed) override;
+		void SetPrefetchConfig(const KeyframePrefetcher::Config& config) override;
+		KeyframePrefetcher::Config GetPrefetchConfig() const override;
 		void EnableStat(bool b)override;
 		const IKeyframeAnimator::Stat& GetStat() const override;
 
@@ -0,0 +1,208 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframeBatch.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "KeyframeBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AdvViz::SDK
+{
+	void KeyframeBatch::Clear()
+	{
+		factor_.clear();
+		for (auto& v : tr0_) v.clear();
+		for (auto& v : tr1_) v.clear();
+		for (auto& v : q0_) v.clear();
+		for (auto& v : q1_) v.clear();
+	}
+
+	bool KeyframeBatch::Add(const IAnimationKeyframeInfo::TimelineResult& result, float time)
+	{
+		if (!((result.timeRange.begin <= time) && (time <= result.timeRange.end)))
+			return false;
+
+		const size_t nbKeys = result.translations.size() / 3;
+		if (nbKeys == 0)
+			return false;
+		const float fkey = nbKeys * (time - result.timeRange.begin) / (result.timeRange.end - result.timeRange.begin);
+		const size_t keyIndex1 = (size_t)fkey; //integer part of fkey
+		if (keyIndex1 > nbKeys - 1)
+			return false;
+		const size_t keyIndex2 = (keyIndex1 == nbKeys - 1) ? keyIndex1 : keyIndex1 + 1;
+		if (result.quaternions.size() < (keyIndex2 + 1) * 4)
+			return false;
+
+		factor_.push_back(fkey - keyIndex1);
+		for (size_t c = 0; c < 3; ++c)
+		{
+			tr0_[c].push_back(result.translations[keyIndex1 * 3 + c]);
+			tr1_[c].push_back(result.translations[keyIndex2 * 3 + c]);
+		}
+		for (size_t c = 0; c < 4; ++c)
+		{
+			q0_[c].push_back(result.quaternions[keyIndex1 * 4 + c]);
+			q1_[c].push_back(result.quaternions[keyIndex2 * 4 + c]);
+		}
+		return true;
+	}
+
+	void KeyframeBatch::Interpolate(std::vector<dmat3x4>& out)
+	{
+		const size_t count = GetCount();
+		for (auto& v : tr_) v.resize(count);
+		for (auto& v : rot_) v.resize(count);
+
+		// Each loop below works on plain arrays, without branches, so that the compiler can vectorize it.
+		const float* const s = factor_.data();
+		for (size_t c = 0; c < 3; ++c)
+		{
+			const float* const a = tr0_[c].data();
+			const float* const b = tr1_[c].data();
+			float* const r = tr_[c].data();
+			for (size_t i = 0; i < count; ++i)
+				r[i] = a[i] + (b[i] - a[i]) * s[i];
+		}
+
+		const float* const x0 = q0_[0].data(); const float* const y0 = q0_[1].data();
+		const float* const z0 = q0_[2].data(); const float* const w0 = q0_[3].data();
+		const float* const x1 = q1_[0].data(); const float* const y1 = q1_[1].data();
+		const float* const z1 = q1_[2].data(); const float* const w1 = q1_[3].data();
+		float* const r00 = rot_[0].data(); float* const r01 = rot_[1].data(); float* const r02 = rot_[2].data();
+		float* const r10 = rot_[3].data(); float* const r11 = rot_[4].data(); float* const r12 = rot_[5].data();
+		float* const r20 = rot_[6].data(); float* const r21 = rot_[7].data(); float* const r22 = rot_[8].data();
+		constexpr float epsilon = std::numeric_limits<float>::epsilon();
+		for (size_t i = 0; i < count; ++i)
+		{
+			// slerp (same as glm::slerp), taking the shortest path
+			float cosTheta = x0[i] * x1[i] + y0[i] * y1[i] + z0[i] * z1[i] + w0[i] * w1[i];
+			const float sign = cosTheta < 0.f ? -1.f : 1.f;
+			cosTheta *= sign;
+			const bool bLinear = cosTheta > 1.f - epsilon;
+			const float angle = std::acos(std::min(cosTheta, 1.f));
+			const float invSin = 1.f / std::max(std::sin(angle), epsilon);
+			const float k0 = bLinear ? 1.f - s[i] : std::sin((1.f - s[i]) * angle) * invSin;
+			const float k1 = sign * (bLinear ? s[i] : std::sin(s[i] * angle) * invSin);
+			const float x = k0 * x0[i] + k1 * x1[i];
+			const float y = k0 * y0[i] + k1 * y1[i];
+			const float z = k0 * z0[i] + k1 * z1[i];
+			const float w = k0 * w0[i] + k1 * w1[i];
+
+			// rotation matrix (same as glm::mat3_cast)
+			const float xx = x * x, yy = y * y, zz = z * z;
+			const float xy = x * y, xz = x * z, yz = y * z;
+			const float wx = w * x, wy = w * y, wz = w * z;
+			r00[i] = 1.f - 2.f * (yy + zz); r01[i] = 2.f * (xy + wz); r02[i] = 2.f * (xz - wy);
+			r10[i] = 2.f * (xy - wz); r11[i] = 1.f - 2.f * (xx + zz); r12[i] = 2.f * (yz + wx);
+			r20[i] = 2.f * (xz + wy); r21[i] = 2.f * (yz - wx); r22[i] = 1.f - 2.f * (xx + yy);
+		}
+
+		out.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			dmat3x4& mat = out[i];
+			for (unsigned col = 0; col < 3; ++col)
+			{
+				for (unsigned row = 0; row < 3; ++row)
+					ColRow3x4(mat, col, row) = rot_[col * 3 + row][i];
+				ColRow3x4(mat, col, 3) = tr_[col][i];
+			}
+		}
+	}
+
+	void BoundingBoxGrid::Build(const std::vector<BoundingBox>& boxes)
+	{
+		boxes_ = boxes;
+		bounds_ = BoundingBox();
+		for (const auto& box : boxes_)
+		{
+			for (size_t c = 0; c < 3; ++c)
+			{
+				bounds_.min[c] = std::min(bounds_.min[c], box.min[c]);
+				bounds_.max[c] = std::max(bounds_.max[c], box.max[c]);
+			}
+		}
+		cellStart_.clear();
+		cellBoxes_.clear();
+		if (boxes_.empty())
+		{
+			dims_ = { 0, 0, 0 };
+			return;
+		}
+
+		// About 8 cells per box, up to 32 per axis.
+		const std::uint32_t maxDim = std::clamp<std::uint32_t>(
+			2 * static_cast<std::uint32_t>(std::ceil(std::cbrt(static_cast<double>(boxes_.size())))), 1, 32);
+		for (size_t c = 0; c < 3; ++c)
+		{
+			const double extent = bounds_.max[c] - bounds_.min[c];
+			dims_[c] = extent > 0.0 ? maxDim : 1;
+			invCellSize_[c] = extent > 0.0 ? dims_[c] / extent : 0.0;
+		}
+
+		// Count the boxes per cell, then fill the cells (compressed rows).
+		const size_t cellCount = size_t(dims_[0]) * dims_[1] * dims_[2];
+		cellStart_.assign(cellCount + 1, 0);
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (std::uint32_t b = 0; b < boxes_.size(); ++b)
+			{
+				const auto first = CellOf(boxes_[b].min);
+				const auto last = CellOf(boxes_[b].max);
+				for (std::uint32_t k = first[2]; k <= last[2]; ++k)
+					for (std::uint32_t j = first[1]; j <= last[1]; ++j)
+						for (std::uint32_t i = first[0]; i <= last[0]; ++i)
+						{
+							const size_t cell = CellIndex({ i, j, k });
+							if (pass == 0)
+								++cellStart_[cell + 1];
+							else
+								cellBoxes_[cellStart_[cell]++] = b;
+						}
+			}
+			if (pass == 0)
+			{
+				for (size_t c = 0; c < cellCount; ++c)
+					cellStart_[c + 1] += cellStart_[c];
+				cellBoxes_.resize(cellStart_[cellCount]);
+			}
+			else
+			{
+				// cellStart_[c] now points at the end of cell c: shift back.
+				for (size_t c = cellCount; c > 0; --c)
+					cellStart_[c] = cellStart_[c - 1];
+				cellStart_[0] = 0;
+			}
+		}
+	}
+
+	std::array<std::uint32_t, 3> BoundingBoxGrid::CellOf(const double3& p) const
+	{
+		std::array<std::uint32_t, 3> cell;
+		for (size_t c = 0; c < 3; ++c)
+		{
+			const double f = std::floor((p[c] - bounds_.min[c]) * invCellSize_[c]);
+			cell[c] = static_cast<std::uint32_t>(std::clamp(f, 0.0, double(dims_[c] - 1)));
+		}
+		return cell;
+	}
+
+	bool BoundingBoxGrid::Contains(const double3& p) const
+	{
+		if (boxes_.empty() || !bounds_.Contains(p))
+			return false;
+		const size_t cell = CellIndex(CellOf(p));
+		for (std::uint32_t n = cellStart_[cell]; n < cellStart_[cell + 1]; ++n)
+		{
+			if (boxes_[cellBoxes_[n]].Contains(p))
+				return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,75 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframeBatch.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#ifndef SDK_CPPMODULES
+	#include <array>
+	#include <cstdint>
+	#include <vector>
+	#ifndef MODULE_EXPORT
+		#define MODULE_EXPORT
+	#endif // !MODULE_EXPORT
+#endif
+
+#include <Core/Tools/Tools.h>
+#include <Core/Tools/Types.h>
+#include <Core/Visualization/KeyframeAnimation.h>
+
+MODULE_EXPORT namespace AdvViz::SDK
+{
+	/// Keyframe pairs of many animated items, gathered as structure-of-arrays so that all the items
+	/// can be interpolated in a single (vectorizable) pass.
+	/// Sampling is the same as AnimationKeyframeInfo::GetInterpolatedValue: linear interpolation of
+	/// the translation, spherical interpolation of the rotation.
+	class ADVVIZ_LINK KeyframeBatch
+	{
+	public:
+		std::size_t GetCount() const { return factor_.size(); }
+		void Clear();
+
+		/// Add the keyframes of result surrounding the given time. Returns false (and adds nothing) if
+		/// time is not covered by result.
+		bool Add(const IAnimationKeyframeInfo::TimelineResult& result, float time);
+
+		/// Compute the transform of all the items (in the coordinate system of the keyframes).
+		/// out is resized to GetCount().
+		void Interpolate(std::vector<dmat3x4>& out);
+
+	private:
+		std::vector<float> factor_; // interpolation factor between the 2 keyframes, in [0, 1]
+		std::array<std::vector<float>, 3> tr0_, tr1_;
+		std::array<std::vector<float>, 4> q0_, q1_; // x, y, z, w
+		// interpolation results
+		std::array<std::vector<float>, 3> tr_;
+		std::array<std::vector<float>, 9> rot_; // column major
+	};
+
+	/// Uniform grid over a set of bounding boxes, to quickly find whether a point is in one of them.
+	class ADVVIZ_LINK BoundingBoxGrid
+	{
+	public:
+		void Build(const std::vector<BoundingBox>& boxes);
+		bool Contains(const double3& p) const;
+
+	private:
+		std::array<std::uint32_t, 3> CellOf(const double3& p) const;
+		std::size_t CellIndex(const std::array<std::uint32_t, 3>& cell) const
+		{
+			return (cell[2] * dims_[1] + cell[1]) * dims_[0] + cell[0];
+		}
+
+		std::vector<BoundingBox> boxes_;
+		BoundingBox bounds_;
+		std::array<std::uint32_t, 3> dims_ = { 0, 0, 0 };
+		double3 invCellSize_ = { 0, 0, 0 };
+		// boxes overlapping cell c are cellBoxes_[cellStart_[c] .. cellStart_[c+1]]
+		std::vector<std::uint32_t> cellStart_;
+		std::vector<std::uint32_t> cellBoxes_;
+	};
+}
@@ -0,0 +1,236 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframeCodec.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "KeyframeCodec.h"
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+namespace AdvViz::SDK::KeyframeCodec
+{
+	static_assert(std::endian::native == std::endian::little, "binary keyframes are stored in little-endian");
+
+	namespace
+	{
+		constexpr char Magic[4] = { 'A', 'V', 'K', 'F' };
+		constexpr std::string_view Base64Magic = "QVZLRg"; // base64 of "AVKF"
+		constexpr std::uint16_t Version = 1;
+
+		enum EFlag : std::uint16_t
+		{
+			HasScales = 0x1,
+			HasStateIds = 0x2,
+		};
+
+		struct SHeader
+		{
+			char magic[4];
+			std::uint16_t version;
+			std::uint16_t flags;
+			std::uint32_t keyframeCount;
+			float timeBegin, timeEnd;
+			std::uint32_t reserved; // keeps the doubles aligned
+			double bboxMin[3], bboxMax[3];
+		};
+		static_assert(sizeof(SHeader) == 72);
+
+		std::atomic<EEncoding> preferredEncoding = EEncoding::Json;
+
+		template<typename T>
+		void Append(std::vector<std::uint8_t>& out, const T* data, std::size_t count)
+		{
+			if (count == 0)
+				return;
+			std::size_t const offset = out.size();
+			out.resize(offset + count * sizeof(T));
+			std::memcpy(out.data() + offset, data, count * sizeof(T));
+		}
+
+		template<typename T>
+		bool Read(const std::uint8_t*& data, const std::uint8_t* end, std::vector<T>& dest, std::size_t count)
+		{
+			if (static_cast<std::size_t>(end - data) < count * sizeof(T))
+				return false;
+			dest.resize(count);
+			if (count > 0)
+				std::memcpy(dest.data(), data, count * sizeof(T));
+			data += count * sizeof(T);
+			return true;
+		}
+
+		bool StartsWith(const std::uint8_t* data, std::size_t size, const char* prefix, std::size_t prefixSize)
+		{
+			return size >= prefixSize && std::memcmp(data, prefix, prefixSize) == 0;
+		}
+	}
+
+	void SetPreferredEncoding(EEncoding encoding)
+	{
+		preferredEncoding = encoding;
+	}
+
+	EEncoding GetPreferredEncoding()
+	{
+		return preferredEncoding;
+	}
+
+	const char* GetAcceptHeader(EEncoding encoding)
+	{
+		switch (encoding)
+		{
+		case EEncoding::Binary: return "application/octet-stream, application/json;q=0.5";
+		case EEncoding::Base64: return "text/plain, application/json;q=0.5";
+		case EEncoding::Json: break;
+		}
+		return "application/json";
+	}
+
+	void Encode(const IAnimationKeyframeInfo::TimelineResult& result, std::vector<std::uint8_t>& out)
+	{
+		std::size_t const count = result.translations.size() / 3;
+		BE_ASSERT(result.quaternions.size() == count * 4);
+		bool const bScales = result.scales && result.scales->size() == count * 3;
+		bool const bStateIds = result.stateIds && result.stateIds->size() == count;
+
+		SHeader header = {};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.flags = static_cast<std::uint16_t>((bScales ? HasScales : 0) | (bStateIds ? HasStateIds : 0));
+		header.keyframeCount = static_cast<std::uint32_t>(count);
+		header.timeBegin = result.timeRange.begin;
+		header.timeEnd = result.timeRange.end;
+		for (int i = 0; i < 3; ++i)
+		{
+			header.bboxMin[i] = result.boundingBox.min[i];
+			header.bboxMax[i] = result.boundingBox.max[i];
+		}
+
+		out.clear();
+		out.reserve(sizeof(SHeader) + count * (10 * sizeof(float) + 1));
+		Append(out, &header, 1);
+		Append(out, result.translations.data(), count * 3);
+		Append(out, result.quaternions.data(), count * 4);
+		if (bScales)
+			Append(out, result.scales->data(), count * 3);
+		if (bStateIds)
+			Append(out, result.stateIds->data(), count);
+	}
+
+	std::string EncodeBase64(const IAnimationKeyframeInfo::TimelineResult& result)
+	{
+		static constexpr char Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::vector<std::uint8_t> data;
+		Encode(result, data);
+		std::string str;
+		str.reserve((data.size() + 2) / 3 * 4);
+		std::size_t i = 0;
+		for (; i + 2 < data.size(); i += 3)
+		{
+			std::uint32_t const n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+			str += Alphabet[(n >> 18) & 63];
+			str += Alphabet[(n >> 12) & 63];
+			str += Alphabet[(n >> 6) & 63];
+			str += Alphabet[n & 63];
+		}
+		if (i < data.size())
+		{
+			std::uint32_t n = data[i] << 16;
+			if (i + 1 < data.size())
+				n |= data[i + 1] << 8;
+			str += Alphabet[(n >> 18) & 63];
+			str += Alphabet[(n >> 12) & 63];
+			str += (i + 1 < data.size()) ? Alphabet[(n >> 6) & 63] : '=';
+			str += '=';
+		}
+		return str;
+	}
+
+	expected<void, std::string> Decode(const std::uint8_t* data, std::size_t size, IAnimationKeyframeInfo::TimelineResult& result)
+	{
+		if (size < sizeof(SHeader) || !StartsWith(data, size, Magic, sizeof(Magic)))
+			return make_unexpected("not binary keyframes");
+		SHeader header;
+		std::memcpy(&header, data, sizeof(SHeader));
+		if (header.version != Version)
+			return make_unexpected("unsupported binary keyframes version " + std::to_string(header.version));
+
+		const std::uint8_t* cur = data + sizeof(SHeader);
+		const std::uint8_t* const end = data + size;
+		std::size_t const count = header.keyframeCount;
+		if (!Read(cur, end, result.translations, count * 3)
+			|| !Read(cur, end, result.quaternions, count * 4))
+			return make_unexpected("truncated binary keyframes");
+		if (header.flags & HasScales)
+		{
+			if (!Read(cur, end, result.scales.emplace(), count * 3))
+				return make_unexpected("truncated binary keyframes");
+		}
+		else
+			result.scales.reset();
+		if (header.flags & HasStateIds)
+		{
+			if (!Read(cur, end, result.stateIds.emplace(), count))
+				return make_unexpected("truncated binary keyframes");
+		}
+		else
+			result.stateIds.reset();
+
+		result.timeRange.begin = header.timeBegin;
+		result.timeRange.end = header.timeEnd;
+		for (int i = 0; i < 3; ++i)
+		{
+			result.boundingBox.min[i] = header.bboxMin[i];
+			result.boundingBox.max[i] = header.bboxMax[i];
+		}
+		return {};
+	}
+
+	EEncoding DetectEncoding(const Http::Response& response)
+	{
+		if (response.rawdata_ && StartsWith(response.rawdata_->data(), response.rawdata_->size(), Magic, sizeof(Magic)))
+			return EEncoding::Binary;
+		const auto* body = reinterpret_cast<const std::uint8_t*>(response.second.data());
+		if (StartsWith(body, response.second.size(), Magic, sizeof(Magic)))
+			return EEncoding::Binary;
+		if (StartsWith(body, response.second.size(), Base64Magic.data(), Base64Magic.size()))
+			return EEncoding::Base64;
+		return EEncoding::Json;
+	}
+
+	expected<bool, std::string> DecodeResponse(const Http::Response& response, const Http& http, IAnimationKeyframeInfo::TimelineResult& result)
+	{
+		expected<void, std::string> ret;
+		switch (DetectEncoding(response))
+		{
+		case EEncoding::Json:
+			return false;
+
+		case EEncoding::Binary:
+			// Unreal only provides binary content through rawdata_, cpr keeps it in the body.
+			if (response.rawdata_ && StartsWith(response.rawdata_->data(), response.rawdata_->size(), Magic, sizeof(Magic)))
+				ret = Decode(response.rawdata_->data(), response.rawdata_->size(), result);
+			else
+				ret = Decode(reinterpret_cast<const std::uint8_t*>(response.second.data()), response.second.size(), result);
+			break;
+
+		case EEncoding::Base64:
+		{
+			thread_local Http::RawData buffer; // reused from one response to the next
+			if (!http.DecodeBase64(response.second, buffer))
+				return make_unexpected(std::string("invalid base64 keyframes"));
+			ret = Decode(buffer.data(), buffer.size(), result);
+			break;
+		}
+		}
+		if (!ret)
+			return make_unexpected(ret.error());
+		return true;
+	}
+}
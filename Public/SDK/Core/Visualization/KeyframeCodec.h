@@ -0,0 +1,58 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframeCodec.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#ifndef SDK_CPPMODULES
+	#include <cstdint>
+	#include <string>
+	#include <vector>
+	#ifndef MODULE_EXPORT
+		#define MODULE_EXPORT
+	#endif // !MODULE_EXPORT
+#endif
+
+#include <Core/Network/Network.h>
+#include <Core/Visualization/KeyframeAnimation.h>
+
+/// Binary representation of keyframes, as an alternative to JSON float arrays.
+/// Layout (little-endian):
+///   header: "AVKF", uint16 version, uint16 flags (1: scales, 2: state ids), uint32 keyframe count,
+///           float time range begin/end, uint32 reserved, double bounding box min[3]/max[3]
+///   float translations[3 * count], float quaternions[4 * count],
+///   float scales[3 * count] (optional), int8 stateIds[count] (optional)
+/// The server can send it raw (application/octet-stream) or base64 encoded.
+MODULE_EXPORT namespace AdvViz::SDK::KeyframeCodec
+{
+	enum class EEncoding : std::uint8_t
+	{
+		Json,
+		Binary,
+		Base64,
+	};
+
+	/// Encoding requested when querying keyframes (Json by default). Servers not supporting the binary
+	/// format keep answering in JSON, which is still accepted.
+	ADVVIZ_LINK void SetPreferredEncoding(EEncoding encoding);
+	ADVVIZ_LINK EEncoding GetPreferredEncoding();
+	/// Value of the "accept" header for the given encoding.
+	ADVVIZ_LINK const char* GetAcceptHeader(EEncoding encoding);
+
+	ADVVIZ_LINK void Encode(const IAnimationKeyframeInfo::TimelineResult& result, std::vector<std::uint8_t>& out);
+	ADVVIZ_LINK std::string EncodeBase64(const IAnimationKeyframeInfo::TimelineResult& result);
+
+	/// Decode binary keyframes: data is copied once, straight into the buffers of result.
+	ADVVIZ_LINK expected<void, std::string> Decode(const std::uint8_t* data, std::size_t size, IAnimationKeyframeInfo::TimelineResult& result);
+
+	/// Encoding of a response body (Json if it is not one of the binary formats).
+	ADVVIZ_LINK EEncoding DetectEncoding(const Http::Response& response);
+
+	/// Decode the keyframes of a binary (raw or base64) response. Returns false if the response is not
+	/// binary (it must then be parsed as JSON), or an error if the binary data is invalid.
+	ADVVIZ_LINK expected<bool, std::string> DecodeResponse(const Http::Response& response, const Http& http, IAnimationKeyframeInfo::TimelineResult& result);
+}
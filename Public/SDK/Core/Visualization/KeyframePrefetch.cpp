@@ -0,0 +1,219 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframePrefetch.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "KeyframePrefetch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AdvViz::SDK
+{
+	void KeyframePrefetcher::SetConfig(const Config& config)
+	{
+		std::vector<WindowPtr> evicted;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			config_ = config;
+			evicted = EvictIfNeeded();
+		}
+		NotifyEvicted(evicted);
+	}
+
+	KeyframePrefetcher::Config KeyframePrefetcher::GetConfig() const
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		return config_;
+	}
+
+	TimeRange KeyframePrefetcher::WindowAt(float time) const
+	{
+		TimeRange window;
+		window.begin = std::floor(time / config_.windowDuration) * config_.windowDuration;
+		window.end = window.begin + config_.windowDuration;
+		return window;
+	}
+
+	KeyframePrefetcher::Plan KeyframePrefetcher::Update(float time, float speed)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		frame_.fetch_add(1, std::memory_order_relaxed);
+
+		Plan plan;
+		const float direction = (speed == 0.f) ? lastDirection_ : (speed < 0.f ? -1.f : 1.f);
+		const float rate = std::fabs(speed);
+
+		// A jump or a change of direction makes the pending requests useless.
+		if (hasLastTime_ && (std::fabs(time - lastTime_) > config_.scrubThreshold || direction != lastDirection_))
+		{
+			plan.scrubbed = true;
+			hasLastQuery_ = false;
+		}
+		hasLastTime_ = true;
+		lastTime_ = time;
+		lastDirection_ = direction;
+
+		// Current window: the one containing time, or the next one shortly before reaching it.
+		plan.current = WindowAt(time + direction * config_.switchAhead * std::max(rate, 1.f));
+		if (!hasLastQuery_ || plan.current.begin != lastQueryWindow_.begin || std::fabs(time - lastQueryTime_) > config_.refreshInterval)
+		{
+			plan.queryCurrent = true;
+			if (!hasLastQuery_ || std::fabs(time - lastPrefetchTime_) > config_.prefetchInterval)
+			{
+				prefetched_.clear();
+				lastPrefetchTime_ = time;
+			}
+			hasLastQuery_ = true;
+			lastQueryTime_ = time;
+			lastQueryWindow_ = plan.current;
+		}
+
+		// Windows ahead, in the playback direction, reached within the lookahead duration.
+		wanted_.clear();
+		wanted_.insert(WindowAt(time));
+		wanted_.insert(plan.current);
+		const float reach = config_.lookahead * rate;
+		for (unsigned k = 1; k <= config_.maxWindowsAhead; ++k)
+		{
+			TimeRange window;
+			window.begin = plan.current.begin + direction * k * config_.windowDuration;
+			window.end = window.begin + config_.windowDuration;
+			const float distance = (direction > 0.f) ? window.begin - time : time - window.end;
+			if (distance > reach || window.end <= 0.f)
+				break;
+			wanted_.insert(window);
+			if (prefetched_.insert(window).second)
+				plan.ahead.push_back(window);
+		}
+		return plan;
+	}
+
+	void KeyframePrefetcher::Reset()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		hasLastTime_ = false;
+		hasLastQuery_ = false;
+		prefetched_.clear();
+		wanted_.clear();
+	}
+
+	bool KeyframePrefetcher::IsWanted(const TimeRange& range) const
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		return wanted_.find(range) != wanted_.end();
+	}
+
+	void KeyframePrefetcher::Insert(const WindowPtr& window)
+	{
+		if (window->data_)
+			window->bytes_ = GetByteSize(window->data_->GetRAutoLock().Get());
+		Touch(*window);
+
+		std::vector<WindowPtr> evicted;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			windows_.push_back(window);
+			cachedBytes_ += window->bytes_;
+			evicted = EvictIfNeeded();
+		}
+		NotifyEvicted(evicted);
+	}
+
+	void KeyframePrefetcher::NotifyEvicted(const std::vector<WindowPtr>& evicted)
+	{
+		for (auto const& window : evicted)
+		{
+			if (window->onEvict_)
+				window->onEvict_();
+		}
+	}
+
+	std::vector<KeyframePrefetcher::WindowPtr> KeyframePrefetcher::EvictIfNeeded()
+	{
+		std::vector<WindowPtr> evicted;
+		if (cachedBytes_ <= config_.byteBudget)
+			return evicted;
+
+		// Evict down to 7/8 of the budget, so that it does not happen again at the next insertion.
+		// Windows used in the current frame are kept.
+		const std::size_t target = config_.byteBudget - config_.byteBudget / 8;
+		const std::uint64_t frame = frame_.load(std::memory_order_relaxed);
+		// Windows can be touched concurrently: sort a snapshot of their last use.
+		std::vector<std::pair<std::uint64_t, WindowPtr>> byLastUse;
+		byLastUse.reserve(windows_.size());
+		for (auto& window : windows_)
+			byLastUse.emplace_back(window->lastUse_.load(std::memory_order_relaxed), std::move(window));
+		std::sort(byLastUse.begin(), byLastUse.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		std::size_t count = 0;
+		for (; count < byLastUse.size() && cachedBytes_ > target; ++count)
+		{
+			if (byLastUse[count].first >= frame)
+				break;
+			cachedBytes_ -= byLastUse[count].second->bytes_;
+		}
+		windows_.clear();
+		evicted.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+			evicted.push_back(std::move(byLastUse[i].second));
+		for (std::size_t i = count; i < byLastUse.size(); ++i)
+			windows_.push_back(std::move(byLastUse[i].second));
+		evictions_ += count;
+		return evicted;
+	}
+
+	void KeyframePrefetcher::Clear()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		windows_.clear();
+		cachedBytes_ = 0;
+	}
+
+	void KeyframePrefetcher::OnRequest()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		++requests_;
+	}
+
+	void KeyframePrefetcher::OnResponse(double latencyMs, bool bCancelled)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		++responses_;
+		if (bCancelled)
+			++cancelled_;
+		lastLatency_ = latencyMs;
+		totalLatency_ += latencyMs;
+		maxLatency_ = std::max(maxLatency_, latencyMs);
+	}
+
+	KeyframePrefetcher::Counters KeyframePrefetcher::GetCounters() const
+	{
+		Counters counters;
+		counters.hits = hits_.load(std::memory_order_relaxed);
+		counters.misses = misses_.load(std::memory_order_relaxed);
+		std::unique_lock<std::mutex> lock(mutex_);
+		counters.requests = requests_;
+		counters.cancelled = cancelled_;
+		counters.evictions = evictions_;
+		counters.cachedBytes = cachedBytes_;
+		counters.cachedWindows = windows_.size();
+		counters.lastLatency = lastLatency_;
+		counters.averageLatency = responses_ ? totalLatency_ / responses_ : 0.0;
+		counters.maxLatency = maxLatency_;
+		return counters;
+	}
+
+	std::size_t KeyframePrefetcher::GetByteSize(const IAnimationKeyframeInfo::TimelineResult& result)
+	{
+		std::size_t bytes = sizeof(result)
+			+ (result.translations.size() + result.quaternions.size()) * sizeof(float);
+		if (result.scales)
+			bytes += result.scales->size() * sizeof(float);
+		if (result.stateIds)
+			bytes += result.stateIds->size() * sizeof(std::int8_t);
+		return bytes;
+	}
+}
@@ -0,0 +1,139 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: KeyframePrefetch.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#ifndef SDK_CPPMODULES
+	#include <atomic>
+	#include <cstdint>
+	#include <functional>
+	#include <memory>
+	#include <mutex>
+	#include <set>
+	#include <vector>
+	#ifndef MODULE_EXPORT
+		#define MODULE_EXPORT
+	#endif // !MODULE_EXPORT
+#endif
+
+#include <Core/Tools/Tools.h>
+#include <Core/Visualization/KeyframeAnimation.h>
+
+MODULE_EXPORT namespace AdvViz::SDK
+{
+	/// Decides which keyframe windows to load around the playback time (depending on the playback speed
+	/// and direction), and keeps the loaded windows under a memory budget: the least recently used
+	/// windows are evicted first.
+	class ADVVIZ_LINK KeyframePrefetcher
+	{
+	public:
+		struct Config
+		{
+			float windowDuration = 20.f;	// duration of the queried windows (s)
+			float refreshInterval = 1.f;	// playback duration after which the current window is queried again (s)
+			float prefetchInterval = 5.f;	// playback duration after which the windows ahead are queried again (s)
+			float switchAhead = 1.f;		// switch to the next window this long before reaching it (s, at speed 1)
+			float lookahead = 10.f;			// windows starting within lookahead * |speed| seconds are prefetched
+			unsigned maxWindowsAhead = 2;
+			float scrubThreshold = 10.f;	// a larger jump of the playback time is a scrub (s)
+			std::size_t byteBudget = std::size_t(512) << 20;
+		};
+
+		struct Counters
+		{
+			std::uint64_t hits = 0;			// items whose keyframes were loaded when needed
+			std::uint64_t misses = 0;		// items whose keyframes were not loaded (yet)
+			std::uint64_t requests = 0;
+			std::uint64_t cancelled = 0;	// requests dropped because their window was no longer needed
+			std::uint64_t evictions = 0;
+			std::size_t cachedBytes = 0;
+			std::size_t cachedWindows = 0;
+			// Time between a request and its response, in milliseconds.
+			double lastLatency = 0.0;
+			double averageLatency = 0.0;
+			double maxLatency = 0.0;
+		};
+
+		/// Queries to make after a call to Update.
+		struct Plan
+		{
+			TimeRange current;				// window of the items to display
+			bool queryCurrent = false;		// (re)query the items of the current window
+			std::vector<TimeRange> ahead;	// windows to prefetch, closest first
+			bool scrubbed = false;			// the requests in progress were made stale
+		};
+
+		/// A loaded window. Its owner removes it from its own container in onEvict_.
+		struct Window
+		{
+			TSharedLockableData<IAnimationKeyframeInfo::TimelineResult> data_;
+			TimeRange range_;
+			std::size_t bytes_ = 0;
+			std::atomic<std::uint64_t> lastUse_ = 0; // frame of the last use
+			std::function<void()> onEvict_;
+		};
+		using WindowPtr = std::shared_ptr<Window>;
+
+		void SetConfig(const Config& config);
+		Config GetConfig() const;
+
+		/// To be called once per frame with the playback time and speed (negative when playing backward).
+		Plan Update(float time, float speed);
+		/// Forget the playback state: the next Update will query everything again.
+		void Reset();
+
+		/// Whether a window is still needed. Requests for windows no longer needed are dropped.
+		bool IsWanted(const TimeRange& range) const;
+
+		/// Add a loaded window (already referenced by its owner). Windows are evicted if the budget is exceeded.
+		void Insert(const WindowPtr& window);
+		/// Mark the window as used in the current frame.
+		void Touch(Window& window) const { window.lastUse_.store(frame_.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+		/// Remove all the windows (without calling their onEvict_).
+		void Clear();
+
+		void OnHit() { hits_.fetch_add(1, std::memory_order_relaxed); }
+		void OnMiss() { misses_.fetch_add(1, std::memory_order_relaxed); }
+		void OnRequest();
+		void OnResponse(double latencyMs, bool bCancelled);
+		Counters GetCounters() const;
+
+		/// Memory used by keyframes.
+		static std::size_t GetByteSize(const IAnimationKeyframeInfo::TimelineResult& result);
+
+	private:
+		TimeRange WindowAt(float time) const; // window containing time
+		/// Removes the windows to evict from the cache and returns them: their onEvict_ must be called
+		/// once mutex_ is released, since it locks the keyframes of the owner.
+		std::vector<WindowPtr> EvictIfNeeded();
+		static void NotifyEvicted(const std::vector<WindowPtr>& evicted);
+
+		mutable std::mutex mutex_;
+		Config config_;
+
+		// playback state
+		bool hasLastTime_ = false;
+		float lastTime_ = 0.f;
+		float lastDirection_ = 1.f;
+		bool hasLastQuery_ = false;
+		float lastQueryTime_ = 0.f;
+		TimeRange lastQueryWindow_;
+		float lastPrefetchTime_ = 0.f;
+		std::set<TimeRange> prefetched_;
+		std::set<TimeRange> wanted_;
+
+		// cache
+		std::atomic<std::uint64_t> frame_ = 0;
+		std::vector<WindowPtr> windows_;
+		std::size_t cachedBytes_ = 0;
+
+		std::atomic<std::uint64_t> hits_ = 0, misses_ = 0;
+		std::uint64_t requests_ = 0, responses_ = 0, cancelled_ = 0, evictions_ = 0;
+		double lastLatency_ = 0.0, totalLatency_ = 0.0, maxLatency_ = 0.0;
+	};
+}
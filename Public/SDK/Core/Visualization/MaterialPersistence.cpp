@@ -14,12 +14,16 @@
 #include "Core/ITwinAPI/ITwinMaterial.h"
 #include <Core/Json/Json.h>
 #include "Core/Network/HttpGetWithLink.h"
+#include <Core/Tools/DelayedCall.h>
 #include "Config.h"
 #include <Core/Visualization/AsyncHelpers.h>
 #include <Core/Visualization/SavableItem.h>
 
 #include <fmt/format.h>
 
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -65,19 +69,46 @@ namespace AdvViz::SDK
 
 		void RequestDeleteITwinMaterialsInDB(std::optional<std::string> const& specificIModelID = std::nullopt);
 
+		/// Texture upload shared by all the channels using a same texture (ie. a same file content).
+		struct STextureUpload;
+		using TextureUploadPtr = std::shared_ptr<STextureUpload>;
+		struct STextureUpload
+		{
+			std::string filePath;
+			// Destination filename on the decoration service: set once the content of the file is hashed,
+			// unless the texture is uploaded again under a known name.
+			std::string uploadName;
+			std::string decorationId;
+			// Channels to update once the texture is on the server. They belong to the copy of the data
+			// being saved, kept alive by callbackPtr.
+			std::vector<ITwinChannelMap*> channels;
+			std::shared_ptr<AsyncRequestGroupCallback> callbackPtr;
+			// Uploads of the same content (from other paths) started meanwhile, completed with this one.
+			std::vector<TextureUploadPtr> followers;
+			int attempt = 0;
+		};
+		/// Uploads started by a same saving operation, by local path.
+		using TextureUploadMap = std::unordered_map<std::string, TextureUploadPtr>;
+
 		/// Start the (asynchronous) upload of given texture if needed.
-		/// Returns true if an upload request was actually started.
+		/// Returns true if an upload was started for this file (it can still turn out to be on the server
+		/// already, once the file is hashed).
 		bool AsyncUploadChannelTextureIfNeeded(
 			std::shared_ptr<AsyncRequestGroupCallback> const& callbackPtr,
 			ITwinChannelMap& texMap,
-			std::string const& decorationId);
+			std::string const& decorationId,
+			TextureUploadMap& uploads);
 
 		/// Start the (asynchronous) upload of all textures needing it.
 		/// Returns the number of upload requests started.
 		size_t AsyncUploadTexuresIfNeeded(
 			std::shared_ptr<AsyncRequestGroupCallback> const& callbackPtr,
 			ITwinMaterial& material,
-			std::string const& decorationId);
+			std::string const& decorationId,
+			TextureUploadMap& uploads);
+
+		void SetUploadedTexturesIndexPath(std::filesystem::path const& indexPath);
+		void OnDecorationTextureFetchFailed(std::string const& textureId);
 
 		void BuildDecorationFilesURL(std::string const& decorationId);
 
@@ -173,10 +204,40 @@ namespace AdvViz::SDK
 		void AsyncSaveMaterials(const std::string& decorationId,
 			std::shared_ptr<IModelMaterialMap> dataIO,
 			std::function<void(bool)>&& onDataSavedFunc = {});
+
+		/// Returns the destination filename of the given texture, based on the hash of its content, or an
+		/// empty string if the file cannot be read.
+		std::string GetTextureUploadName(std::string const& filePath);
+		void EnqueueTextureUpload(TextureUploadPtr const& upload);
+		void OnTextureUploadNameComputed(TextureUploadPtr const& upload, std::string const& uploadName);
+		void StartPendingTextureUploads();
+		void PostTextureFile(TextureUploadPtr const& upload);
+		void OnTextureUploadDone(TextureUploadPtr const& upload, long httpCode);
+		void CompleteTextureUpload(TextureUploadPtr const& upload, bool bUploaded);
+		void StartTextureReuploads();
+
+		/// Content hash of a local texture, valid as long as the file is not modified.
+		struct SFileContentHash
+		{
+			std::uintmax_t fileSize = 0;
+			std::filesystem::file_time_type lastWriteTime;
+			uint64_t hash = 0;
+		};
+
 		struct SThreadSafeData
 		{
 			IModelMaterialMap data_;
-			std::unordered_map<std::string, std::string> localToDecoTexId_;
+			std::unordered_map<std::string, SFileContentHash> localTextureHashes_;
+			// Textures known to be on the server, as "decorationId/uploadName", with the local path they
+			// were uploaded from.
+			std::unordered_map<std::string, std::string> uploadedTextures_;
+			std::filesystem::path uploadedTexturesIndexPath_; // persists uploadedTextures_ if not empty
+			// Uploads in progress (pending or running), as "decorationId/uploadName".
+			std::unordered_map<std::string, TextureUploadPtr> activeUploads_;
+			std::deque<TextureUploadPtr> pendingUploads_;
+			int runningUploads_ = 0;
+			// Textures to upload again, because they could not be fetched from the server.
+			std::vector<TextureUploadPtr> reuploads_;
 			PerIModelTextureSet perIModelTextures_;
 			std::unordered_set<std::string> loadedIModelIds_; // fully loaded model IDs.
 			std::set<std::string> iModelsForMaterialCollection_;
@@ -597,76 +658,410 @@ namespace AdvViz::SDK
 		}
 	}
 
+	namespace
+	{
+		/// Number of texture uploads (multipart POST requests) running at the same time.
+		constexpr int MAX_CONCURRENT_TEXTURE_UPLOADS = 4;
+		/// Attempts for each texture upload, in case of transient errors.
+		constexpr int MAX_TEXTURE_UPLOAD_ATTEMPTS = 3;
+
+		/// Hash of the content of a file. It starts from FNV-1a, but mixes 8-byte words (with an extra
+		/// xor-shift) since textures can be large, so it is a custom hash matching no standard one.
+		/// It must never change: the names of the textures uploaded to the decoration service, which are
+		/// referenced by the saved materials and recorded in the index of uploaded textures, depend on it.
+		std::optional<uint64_t> ComputeFileContentHash(std::filesystem::path const& filePath)
+		{
+			std::ifstream file(filePath, std::ios::binary);
+			if (!file)
+				return std::nullopt;
+			constexpr uint64_t FNV_PRIME = 0x100000001b3;
+			uint64_t hash = 0xcbf29ce484222325;
+			std::vector<char> buffer(1 << 16);
+			while (file)
+			{
+				file.read(buffer.data(), buffer.size());
+				size_t const size = static_cast<size_t>(file.gcount());
+				size_t i = 0;
+				for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+				{
+					uint64_t word;
+					std::memcpy(&word, buffer.data() + i, sizeof(uint64_t));
+					hash = (hash ^ word) * FNV_PRIME;
+					hash ^= hash >> 29;
+				}
+				for (; i < size; ++i)
+				{
+					hash = (hash ^ uint64_t(static_cast<unsigned char>(buffer[i]))) * FNV_PRIME;
+				}
+			}
+			if (!file.eof())
+				return std::nullopt;
+			return hash;
+		}
+
+		/// Rewrites the index of uploaded textures: a Json object mapping each key to the local path of the
+		/// uploaded texture (either of which may contain any character).
+		void WriteUploadedTexturesIndex(std::filesystem::path const& indexPath,
+			std::unordered_map<std::string, std::string> const& uploadedTextures)
+		{
+			std::ofstream(indexPath, std::ios::trunc) << Json::ToString(uploadedTextures);
+		}
+
+		/// Whether a failed upload is worth retrying (network failure, timeout, rate limit or server error).
+		inline bool IsTransientUploadError(long httpCode)
+		{
+			return httpCode <= 0 || httpCode == 408 || httpCode == 429 || httpCode >= 500;
+		}
+
+		inline std::string GetUploadedTextureKey(std::string const& decorationId, std::string const& uploadName)
+		{
+			return decorationId + "/" + uploadName;
+		}
+	}
+
+	std::string MaterialPersistenceManager::Impl::GetTextureUploadName(std::string const& filePath)
+	{
+		std::error_code ec;
+		std::filesystem::path const texPath(filePath);
+		std::uintmax_t const fileSize = std::filesystem::file_size(texPath, ec);
+		std::filesystem::file_time_type const lastWriteTime = ec
+			? std::filesystem::file_time_type() : std::filesystem::last_write_time(texPath, ec);
+		if (ec)
+		{
+			BE_LOGE("ITwinDecoration", "Cannot access texture " << filePath << " - " << ec.message());
+			return {};
+		}
+
+		std::optional<uint64_t> contentHash;
+		{
+			auto thdata = thdata_.GetRAutoLock();
+			auto const itHash = thdata->localTextureHashes_.find(filePath);
+			if (itHash != thdata->localTextureHashes_.end()
+				&& itHash->second.fileSize == fileSize
+				&& itHash->second.lastWriteTime == lastWriteTime)
+			{
+				contentHash = itHash->second.hash;
+			}
+		}
+		if (!contentHash)
+		{
+			contentHash = ComputeFileContentHash(texPath);
+			if (!contentHash)
+			{
+				BE_LOGE("ITwinDecoration", "Cannot read texture " << filePath);
+				return {};
+			}
+			auto thdata = thdata_.GetAutoLock();
+			thdata->localTextureHashes_[filePath] = SFileContentHash{ fileSize, lastWriteTime, *contentHash };
+		}
+
+		// The destination filename is made of the hash of the content, so that a same texture is stored
+		// once, whatever its path, and the basename, for easier debugging.
+		return fmt::format("{0:#x}_{1}", *contentHash, texPath.filename().generic_string());
+	}
+
+	void MaterialPersistenceManager::Impl::SetUploadedTexturesIndexPath(std::filesystem::path const& indexPath)
+	{
+		auto thdata = thdata_.GetAutoLock();
+		thdata->uploadedTexturesIndexPath_ = indexPath;
+		if (indexPath.empty())
+			return;
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(indexPath, ec))
+		{
+			std::unordered_map<std::string, std::string> uploadedTextures;
+			std::ifstream indexFile(indexPath);
+			std::string parseError;
+			if (Json::FromStream(uploadedTextures, indexFile, parseError))
+				thdata->uploadedTextures_.merge(uploadedTextures);
+			// Else the textures will just be uploaded again.
+		}
+		std::filesystem::create_directories(indexPath.parent_path(), ec);
+	}
+
+	void MaterialPersistenceManager::Impl::OnDecorationTextureFetchFailed(std::string const& textureId)
+	{
+		std::string const keySuffix = "/" + textureId;
+		bool bHasReuploads = false;
+		{
+			// The texture was probably removed from the server (or never fully uploaded): forget it, so that
+			// it is uploaded again, now if its local file is known, or else upon next saving.
+			auto thdata = thdata_.GetAutoLock();
+			bool bIndexChanged = false;
+			for (auto it = thdata->uploadedTextures_.begin(); it != thdata->uploadedTextures_.end(); )
+			{
+				auto const& [key, filePath] = *it;
+				if (!key.ends_with(keySuffix))
+				{
+					++it;
+					continue;
+				}
+				BE_LOGW("ITwinDecoration", "Texture " << key << " could not be fetched - it will be uploaded again");
+				if (!filePath.empty())
+				{
+					auto upload = std::make_shared<STextureUpload>();
+					upload->filePath = filePath;
+					upload->uploadName = textureId;
+					upload->decorationId = key.substr(0, key.size() - keySuffix.size());
+					thdata->reuploads_.push_back(upload);
+					bHasReuploads = true;
+				}
+				it = thdata->uploadedTextures_.erase(it);
+				bIndexChanged = true;
+			}
+			if (bIndexChanged && !thdata->uploadedTexturesIndexPath_.empty())
+			{
+				WriteUploadedTexturesIndex(thdata->uploadedTexturesIndexPath_, thdata->uploadedTextures_);
+			}
+		}
+		if (bHasReuploads)
+		{
+			// Fetching textures is done in worker threads, whereas uploads are handled by the main thread.
+			Tools::GetTaskManager().AddTask([this, isValidLambda = isThisValid_]()
+			{
+				if (*isValidLambda)
+					StartTextureReuploads();
+			}, Tools::ITaskManager::EType::main);
+		}
+	}
+
+	void MaterialPersistenceManager::Impl::StartTextureReuploads()
+	{
+		std::vector<TextureUploadPtr> reuploads;
+		{
+			auto thdata = thdata_.GetAutoLock();
+			reuploads.swap(thdata->reuploads_);
+		}
+		if (reuploads.empty())
+			return;
+		// The materials referencing these textures are already saved: only the files have to be uploaded.
+		std::shared_ptr<AsyncRequestGroupCallback> callbackPtr =
+			std::make_shared<AsyncRequestGroupCallback>([](bool bSuccess)
+		{
+			if (!bSuccess)
+			{
+				BE_LOGE("ITwinDecoration", "Some textures which could not be fetched failed to be uploaded again");
+			}
+		}, isThisValid_);
+		for (auto const& upload : reuploads)
+		{
+			upload->callbackPtr = callbackPtr;
+			EnqueueTextureUpload(upload);
+		}
+		callbackPtr->OnFirstLevelRequestsRegistered();
+	}
+
 	bool MaterialPersistenceManager::Impl::AsyncUploadChannelTextureIfNeeded(
 		std::shared_ptr<AsyncRequestGroupCallback> const& callbackPtr,
 		ITwinChannelMap& texMap,
-		std::string const& decorationId)
+		std::string const& decorationId,
+		TextureUploadMap& uploads)
 	{
 		if (texMap.eSource != ETextureSource::LocalDisk)
 			return false;
 		if (!texMap.HasTexture())
 			return false;
 
+		// Several channels can share the same upload. Channels using the same content from different paths
+		// will be grouped once the files are hashed.
 		std::string const filePath = texMap.texture;
-
+		auto& upload = uploads[filePath];
+		if (upload)
 		{
-			// See if this texture has been uploaded before (typically if a same texture is used in multiple
-			// materials).
-			auto thdata = thdata_.GetRAutoLock();
-			auto itDecoId = thdata->localToDecoTexId_.find(filePath);
-			if (itDecoId != thdata->localToDecoTexId_.end())
-			{
-				texMap.texture = itDecoId->second;
-				texMap.eSource = ETextureSource::Decoration;
-				return false;
-			}
+			upload->channels.push_back(&texMap);
+			return false;
 		}
+		upload = std::make_shared<STextureUpload>();
+		upload->filePath = filePath;
+		upload->decorationId = decorationId;
+		upload->channels.push_back(&texMap);
+		upload->callbackPtr = callbackPtr;
+		EnqueueTextureUpload(upload);
+		return true;
+	}
 
-		// For the destination filename, we will encode the full path and append the basename, for easier
-		// debugging.
-		std::error_code ec;
-		std::filesystem::path const texPath(texMap.texture);
-		size_t const pathHash = std::hash<std::string>()(
-			std::filesystem::canonical(texPath, ec).generic_string());
-		std::string const basename = fmt::format("{0:#x}_{1}",
-			pathHash, texPath.filename().generic_string());
-
-		BE_LOGI("ITwinDecoration", "Uploading texture " << filePath << " as " << basename << "...");
+	void MaterialPersistenceManager::Impl::EnqueueTextureUpload(TextureUploadPtr const& upload)
+	{
+		upload->callbackPtr->AddRequestToWait(); // once for all attempts
 
-		AsyncPostFile(GetHttp(), callbackPtr,
-			[this, &texMap, filePath, basename](const Http::Response& r)
+		// Reading and hashing the whole file is done in a worker thread, not to block the thread starting
+		// the save. The result is then processed by the main thread, like the upload requests.
+		Tools::GetTaskManager().AddTask([this, isValidLambda = isThisValid_, upload]()
 		{
-			// Note that texMap is still valid because it's owned by the shared dataIO wrapped in
-			// callbackPtr...
-			bool const uploaded = (r.first == 200 || r.first == 201 || r.first == 409);  //409 is Conflict, meaning the file is already uploaded.
-			if (uploaded)
+			if (!*isValidLambda)
+				return;
+			std::string const uploadName = GetTextureUploadName(upload->filePath);
+			Tools::GetTaskManager().AddTask([this, isValidLambda, upload, uploadName]()
 			{
-				// Replace the identifier in the channel.
-				texMap.texture = basename;
-				texMap.eSource = ETextureSource::Decoration;
+				if (*isValidLambda && upload->callbackPtr->IsValid())
+					OnTextureUploadNameComputed(upload, uploadName);
+			}, Tools::ITaskManager::EType::main);
+		}, Tools::ITaskManager::EType::background);
+	}
 
-				auto thdata = thdata_.GetAutoLock();
-				thdata->localToDecoTexId_.emplace(filePath, basename);
+	void MaterialPersistenceManager::Impl::OnTextureUploadNameComputed(TextureUploadPtr const& upload,
+		std::string const& uploadName)
+	{
+		if (uploadName.empty())
+		{
+			// The file cannot be read (already logged): the channels keep referencing the local file.
+			upload->callbackPtr->OnRequestDone(true);
+			return;
+		}
+		if (!upload->uploadName.empty() && upload->uploadName != uploadName)
+		{
+			BE_LOGE("ITwinDecoration", "Texture " << upload->filePath << " was modified since its upload as "
+				<< upload->uploadName << " - cannot upload it again");
+			upload->callbackPtr->OnRequestDone(false);
+			return;
+		}
+		upload->uploadName = uploadName;
 
-				BE_LOGI("ITwinDecoration", "Uploaded texture " << filePath);
+		std::string const uploadedKey = GetUploadedTextureKey(upload->decorationId, upload->uploadName);
+		bool bAlreadyUploaded = false;
+		{
+			auto thdata = thdata_.GetAutoLock();
+			// See if this texture has been uploaded before (in this session or a previous one, and typically
+			// if a same texture is used in multiple materials).
+			if (thdata->uploadedTextures_.contains(uploadedKey))
+			{
+				bAlreadyUploaded = true;
 			}
 			else
 			{
-				BE_LOGE("ITwinDecoration", "Failed upload of texture " << filePath << " - error code: " << r.first);
+				auto const [itActive, bInserted] = thdata->activeUploads_.try_emplace(uploadedKey, upload);
+				if (!bInserted)
+				{
+					// Same content as an upload in progress.
+					itActive->second->followers.push_back(upload);
+					return;
+				}
+				thdata->pendingUploads_.push_back(upload);
+			}
+		}
+		if (bAlreadyUploaded)
+		{
+			CompleteTextureUpload(upload, true);
+			return;
+		}
+		StartPendingTextureUploads();
+	}
+
+	void MaterialPersistenceManager::Impl::StartPendingTextureUploads()
+	{
+		std::vector<TextureUploadPtr> uploadsToStart;
+		{
+			auto thdata = thdata_.GetAutoLock();
+			while (thdata->runningUploads_ < MAX_CONCURRENT_TEXTURE_UPLOADS && !thdata->pendingUploads_.empty())
+			{
+				uploadsToStart.push_back(std::move(thdata->pendingUploads_.front()));
+				thdata->pendingUploads_.pop_front();
+				thdata->runningUploads_++;
 			}
-			return uploaded;
+		}
+		for (auto const& upload : uploadsToStart)
+		{
+			PostTextureFile(upload);
+		}
+	}
+
+	void MaterialPersistenceManager::Impl::PostTextureFile(TextureUploadPtr const& upload)
+	{
+		BE_LOGI("ITwinDecoration", "Uploading texture " << upload->filePath << " as " << upload->uploadName << "...");
+
+		GetHttp()->AsyncPostFile(
+			[this, isValidLambda = isThisValid_, upload](const Http::Response& r)
+		{
+			if (!*isValidLambda || !upload->callbackPtr->IsValid())
+				return;
+			OnTextureUploadDone(upload, r.first);
 		},
-			"decorations/" + decorationId + "/files",
+			"decorations/" + upload->decorationId + "/files",
 			"file",
-			filePath,
-			{ { "filename", basename } });
-		return true;
+			upload->filePath,
+			{ { "filename", upload->uploadName } },
+			{},
+			Http::EAsyncCallbackExecutionMode::MainThread);
+	}
+
+	void MaterialPersistenceManager::Impl::OnTextureUploadDone(TextureUploadPtr const& upload, long httpCode)
+	{
+		bool const uploaded = (httpCode == 200 || httpCode == 201 || httpCode == 409);  //409 is Conflict, meaning the file is already uploaded.
+		if (!uploaded && IsTransientUploadError(httpCode) && upload->attempt + 1 < MAX_TEXTURE_UPLOAD_ATTEMPTS)
+		{
+			// Retry after a delay, keeping the upload slot.
+			upload->attempt++;
+			float const delayInSeconds = float(1 << upload->attempt);
+			BE_LOGW("ITwinDecoration", "Failed upload of texture " << upload->filePath << " - error code: "
+				<< httpCode << " - will retry after " << delayInSeconds << "s");
+			auto retryFunc = [this, isValidLambda = isThisValid_, upload]()
+			{
+				if (*isValidLambda)
+					PostTextureFile(upload);
+				return DelayedCall::EReturnedValue::Done;
+			};
+			if (!UniqueDelayedCall("MatIOTextureUpload_" + GetUploadedTextureKey(upload->decorationId, upload->uploadName),
+				std::function<DelayedCall::EReturnedValue()>(retryFunc), delayInSeconds))
+			{
+				// No support for delayed calls: retry at once.
+				retryFunc();
+			}
+			return;
+		}
+
+		std::string const uploadedKey = GetUploadedTextureKey(upload->decorationId, upload->uploadName);
+		if (uploaded)
+		{
+			auto thdata = thdata_.GetAutoLock();
+			if (thdata->uploadedTextures_.try_emplace(uploadedKey, upload->filePath).second
+				&& !thdata->uploadedTexturesIndexPath_.empty())
+			{
+				WriteUploadedTexturesIndex(thdata->uploadedTexturesIndexPath_, thdata->uploadedTextures_);
+			}
+
+			BE_LOGI("ITwinDecoration", "Uploaded texture " << upload->filePath);
+		}
+		else
+		{
+			BE_LOGE("ITwinDecoration", "Failed upload of texture " << upload->filePath << " - error code: " << httpCode);
+		}
+
+		std::vector<TextureUploadPtr> followers;
+		{
+			auto thdata = thdata_.GetAutoLock();
+			thdata->runningUploads_--;
+			thdata->activeUploads_.erase(uploadedKey);
+			followers.swap(upload->followers);
+		}
+		StartPendingTextureUploads();
+		CompleteTextureUpload(upload, uploaded);
+		for (auto const& follower : followers)
+		{
+			CompleteTextureUpload(follower, uploaded);
+		}
+	}
+
+	void MaterialPersistenceManager::Impl::CompleteTextureUpload(TextureUploadPtr const& upload, bool bUploaded)
+	{
+		if (bUploaded)
+		{
+			// Replace the identifier in the channels.
+			// Note that they are still valid because they are owned by the shared dataIO wrapped in
+			// callbackPtr...
+			for (ITwinChannelMap* texMap : upload->channels)
+			{
+				texMap->texture = upload->uploadName;
+				texMap->eSource = ETextureSource::Decoration;
+			}
+		}
+		upload->callbackPtr->OnRequestDone(bUploaded);
 	}
 
 	size_t MaterialPersistenceManager::Impl::AsyncUploadTexuresIfNeeded(
 		std::shared_ptr<AsyncRequestGroupCallback> const& callbackPtr,
 		ITwinMaterial& material,
-		std::string const& decorationId)
+		std::string const& decorationId,
+		TextureUploadMap& uploads)
 	{
 		size_t nUploadStarted = 0;
 		for (uint8_t chanIndex(0) ; chanIndex < (uint8_t)EChannelType::ENUM_END; ++chanIndex)
@@ -678,7 +1073,7 @@ namespace AdvViz::SDK
 				// We need a mutable ITwinChannelMap here, as we may change the map's ID or source.
 				ITwinChannelMap& chanMapRef = material.GetMutableChannelMap(chan);
 				if (AsyncUploadChannelTextureIfNeeded(
-					callbackPtr, chanMapRef, decorationId))
+					callbackPtr, chanMapRef, decorationId, uploads))
 				{
 					nUploadStarted++;
 				}
@@ -928,12 +1323,14 @@ namespace AdvViz::SDK
 
 		OnStartSave();
 
-		// First upload textures if needed, and update texture identifiers accordingly.
+		// First upload textures if needed, and update texture identifiers accordingly. Each texture is
+		// uploaded once, however many materials use it.
+		TextureUploadMap uploads;
 		for (auto& [iModelID, materialMap] : *dataIO)
 		{
 			for (auto& [matID, matInfo] : materialMap)
 			{
-				AsyncUploadTexuresIfNeeded(onUploadFinished, matInfo.settings, decorationId);
+				AsyncUploadTexuresIfNeeded(onUploadFinished, matInfo.settings, decorationId, uploads);
 			}
 		}
 
@@ -1629,6 +2026,16 @@ namespace AdvViz::SDK
 		return GetImpl().GetBaseURL(texSource);
 	}
 
+	void MaterialPersistenceManager::SetUploadedTexturesIndexPath(std::filesystem::path const& indexPath)
+	{
+		GetImpl().SetUploadedTexturesIndexPath(indexPath);
+	}
+
+	void MaterialPersistenceManager::OnDecorationTextureFetchFailed(std::string const& textureId)
+	{
+		GetImpl().OnDecorationTextureFetchFailed(textureId);
+	}
+
 	std::string MaterialPersistenceManager::GetRelativeURL(TextureKey const& textureKey) const
 	{
 		return GetImpl().GetRelativeURL(textureKey);
@@ -89,6 +89,15 @@ MODULE_EXPORT namespace AdvViz::SDK
 		/// packaged application: it should be used withing UE's file system API only.
 		void SetMaterialLibraryDirectory(std::string const& materialLibraryDirectory);
 
+		/// Set the file where the textures uploaded to the decoration service are recorded, so that they
+		/// are not uploaded again in later sessions. If empty, they are only known in current session.
+		void SetUploadedTexturesIndexPath(std::filesystem::path const& indexPath);
+
+		/// To be called when a texture of the decoration service could not be fetched: if it was recorded as
+		/// uploaded, the record is dropped, and the texture is uploaded again from its local file if known.
+		/// Can be called from any thread.
+		void OnDecorationTextureFetchFailed(std::string const& textureId);
+
 		/// Return the base url to access a texture stored in the decoration service or in the material
 		/// library.
 		std::string GetBaseURL(ETextureSource texSource) const;
@@ -308,7 +308,8 @@ namespace AdvViz::SDK
 					ISplinePtr spline = AddSpline();
 					FromJsonSpline(spline, row);
 					return {};
-				});
+				},
+				{ .maxConcurrentPages = 4 });
 
 			if (!ret)
 			{
@@ -336,7 +337,8 @@ namespace AdvViz::SDK
 				mapIdToPoint[point->GetId()] = pointPtr;
 
 				return {};
-			});
+			},
+			{ .maxConcurrentPages = 4 });
 
 			if (!ret)
 			{
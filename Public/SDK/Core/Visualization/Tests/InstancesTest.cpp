@@ -8,7 +8,9 @@
 
 #include "../Visualization.h"
 #include "../InstancesManager.h"
+#include <chrono>
 #include <filesystem>
+#include <iostream>
 #include <mutex>
 
 #include <catch2/catch_all.hpp>
@@ -426,3 +428,179 @@ TEST_CASE("Instances Manager")
 	}
 }
 
+
+namespace
+{
+	dmat3x4 MakeTranslation(double x, double y, double z)
+	{
+		return { 1, 0, 0, x,
+				 0, 1, 0, y,
+				 0, 0, 1, z };
+	}
+}
+
+TEST_CASE("Instances Store")
+{
+	SECTION("instances are handles to the store")
+	{
+		auto instanceManager = GetTestInstanceManager();
+		auto groupPtr = instanceManager->GetInstancesGroupByName(TEST_GROUP_NAME);
+		REQUIRE(groupPtr.get() != nullptr);
+		RefID const groupId = groupPtr->GetRAutoLock()->GetId();
+
+		auto store = instanceManager->GetInstancesStore("Animals/Bird.uasset", groupId);
+		REQUIRE(store.get() != nullptr);
+		CHECK(store->GetCount() == 4);
+
+		auto const& birds = instanceManager->GetInstancesByObjectRef("Animals/Bird.uasset", groupId);
+		{
+			auto inst0 = birds[0]->GetRAutoLock();
+			CHECK(inst0->GetStore() == store);
+			CHECK(store->GetColorShift(0) == inst0->GetColorShift());
+		}
+
+		// bulk update is visible through the instances
+		store->UpdateTransforms([](InstancesStore::Index index, dmat3x4& mat) {
+			mat = MakeTranslation(index, 2. * index, 0.);
+			return true;
+		});
+		for (size_t i = 0; i < birds.size(); ++i)
+		{
+			auto inst = birds[i]->GetRAutoLock();
+			CHECK(inst->GetTransform()[3] == static_cast<double>(i));
+			CHECK(inst->GetTransform()[7] == 2. * i);
+		}
+
+		// and instance updates are visible in the store
+		store->ClearDirtyFlags();
+		{
+			auto inst2 = birds[2]->GetAutoLock();
+			inst2->SetTransform(MakeTranslation(10., 0., 0.));
+			inst2->SetAnimId("anim");
+		}
+		CHECK(store->GetTransform(2)[3] == 10.);
+		CHECK(store->GetAnimId(2) == "anim");
+		CHECK(store->GetAnimId(1) == "");
+		CHECK(store->GetDirtyIndices() == std::vector<InstancesStore::Index>{ 2 });
+	}
+
+	SECTION("removal")
+	{
+		auto instanceManager = GetTestInstanceManager();
+		auto groupPtr = instanceManager->GetInstancesGroupByName(TEST_GROUP_NAME);
+		RefID const groupId = groupPtr->GetRAutoLock()->GetId();
+		std::string const objRef = "Animals/Bird.uasset";
+		auto store = instanceManager->GetInstancesStore(objRef, groupId);
+		REQUIRE(store.get() != nullptr);
+		store->UpdateTransforms([](InstancesStore::Index index, dmat3x4& mat) {
+			mat = MakeTranslation(index, 0., 0.);
+			return true;
+		});
+		IInstancePtr removedPtr = instanceManager->GetInstancesByObjectRef(objRef, groupId)[1];
+
+		// remove at swap: instance 3 takes the slot of instance 1
+		instanceManager->RemoveInstancesByObjectRef(objRef, groupId, { 1 }, true);
+		CHECK(store->GetCount() == 3);
+		CHECK(store->GetTransform(1)[3] == 3.);
+		{
+			auto removed = removedPtr->GetRAutoLock();
+			CHECK(removed->GetStore() == nullptr);
+			CHECK(removed->GetTransform()[3] == 1.);
+		}
+
+		// remove with shift
+		instanceManager->RemoveInstancesByObjectRef(objRef, groupId, { 0 }, false);
+		auto const& birds = instanceManager->GetInstancesByObjectRef(objRef, groupId);
+		REQUIRE(birds.size() == 2);
+		CHECK(store->GetCount() == 2);
+		for (size_t i = 0; i < birds.size(); ++i)
+		{
+			auto inst = birds[i]->GetRAutoLock();
+			CHECK(inst->GetTransform()[3] == store->GetTransform((InstancesStore::Index)i)[3]);
+		}
+		CHECK(store->GetTransform(0)[3] == 3.);
+		CHECK(store->GetTransform(1)[3] == 2.);
+	}
+
+	SECTION("bulk accessors across chunks")
+	{
+		InstancesStore store;
+		size_t const count = 3 * InstancesStore::ChunkSize + 17;
+		store.Resize(count);
+		std::vector<dmat3x4> mats(count);
+		for (size_t i = 0; i < count; ++i)
+			mats[i] = MakeTranslation((double)i, 0., 0.);
+		store.SetTransforms(0, count, mats.data());
+
+		std::vector<dmat3x4> read(100);
+		InstancesStore::Index const first = InstancesStore::ChunkSize - 50;
+		store.GetTransforms(first, read.size(), read.data());
+		for (size_t i = 0; i < read.size(); ++i)
+			CHECK(read[i][3] == (double)(first + i));
+
+		double sum = 0.;
+		store.ForEachTransform([&sum](InstancesStore::Index, dmat3x4 const& mat) { sum += mat[3]; });
+		CHECK(sum == (double)(count * (count - 1) / 2));
+	}
+}
+
+// Compares the packed store with one lockable IInstance per instance, at 1M instances.
+// Hidden by default, run with: VisualizationTest "[benchmark]"
+TEST_CASE("Instances Store: benchmark", "[.][benchmark]")
+{
+	using Clock = std::chrono::steady_clock;
+	auto toMs = [](Clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+	size_t const count = 1000000;
+
+	// Legacy layout: each instance owns its data, behind its own lock.
+	{
+		auto start = Clock::now();
+		SharedInstVect instances;
+		instances.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			IInstance* inst = IInstance::New();
+			inst->SetTransform(MakeTranslation((double)i, 0., 0.));
+			instances.push_back(Tools::MakeSharedLockableDataPtr(inst));
+		}
+		auto loaded = Clock::now();
+		double sum = 0.;
+		for (auto const& instPtr : instances)
+		{
+			auto inst = instPtr->GetRAutoLock();
+			sum += inst->GetTransform()[3];
+		}
+		auto iterated = Clock::now();
+		for (auto const& instPtr : instances)
+		{
+			auto inst = instPtr->GetAutoLock();
+			dmat3x4 mat = inst->GetTransform();
+			mat[7] += 1.;
+			inst->SetTransform(mat);
+		}
+		auto updated = Clock::now();
+		CHECK(sum > 0.);
+		std::cout << "Instances (legacy) - load: " << toMs(loaded - start) << " ms, iterate: "
+			<< toMs(iterated - loaded) << " ms, update: " << toMs(updated - iterated) << " ms" << std::endl;
+	}
+
+	// Packed store, bulk accessors.
+	{
+		auto start = Clock::now();
+		InstancesStore store;
+		store.Resize(count);
+		std::vector<dmat3x4> mats(count);
+		for (size_t i = 0; i < count; ++i)
+			mats[i] = MakeTranslation((double)i, 0., 0.);
+		store.SetTransforms(0, count, mats.data());
+		auto loaded = Clock::now();
+		double sum = 0.;
+		store.ForEachTransform([&sum](InstancesStore::Index, dmat3x4 const& mat) { sum += mat[3]; });
+		auto iterated = Clock::now();
+		store.UpdateTransforms([](InstancesStore::Index, dmat3x4& mat) { mat[7] += 1.; return true; });
+		auto updated = Clock::now();
+		CHECK(sum > 0.);
+		std::cout << "Instances (store) - load: " << toMs(loaded - start) << " ms, iterate: "
+			<< toMs(iterated - loaded) << " ms, update: " << toMs(updated - iterated) << " ms" << std::endl;
+	}
+}
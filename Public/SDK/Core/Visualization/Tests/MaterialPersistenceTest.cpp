@@ -0,0 +1,237 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: MaterialPersistenceTest.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "../Visualization.h"
+#include "../MaterialPersistence.h"
+#include <Core/ITwinAPI/ITwinMaterial.h>
+#include <Core/Json/Json.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <catch2/catch_all.hpp>
+#include <httpmockserver/mock_server.h>
+#include <httpmockserver/port_searcher.h>
+#include "Mock.h"
+
+using namespace AdvViz::SDK;
+
+bool WaitForAsyncTask(std::atomic_bool& taskFinished, int maxSeconds);
+void SetDefaultConfig();
+
+namespace
+{
+	size_t CountOccurrences(std::string const& data, std::string const& pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = data.find(pattern); pos != std::string::npos; pos = data.find(pattern, pos + 1))
+			++count;
+		return count;
+	}
+}
+
+TEST_CASE("MaterialPersistence:TextureUploads")
+{
+	try {
+		SetDefaultConfig();
+		HTTPMock* mock = GetHttpMock();
+		REQUIRE(mock != nullptr);
+
+		// Textures: the 2 "wood" files have the same content, and should thus be uploaded only once.
+		std::filesystem::path const testDir = std::filesystem::temp_directory_path() / "MatIOTextureUploads";
+		std::filesystem::remove_all(testDir);
+		std::filesystem::create_directories(testDir / "a");
+		std::filesystem::create_directories(testDir / "b");
+		std::string const woodContent(20000, 'w');
+		std::ofstream(testDir / "a" / "wood.png", std::ios::binary) << woodContent;
+		std::ofstream(testDir / "b" / "wood.png", std::ios::binary) << woodContent;
+		std::ofstream(testDir / "a" / "stone.png", std::ios::binary) << std::string(30000, 's');
+		std::vector<std::string> const texturePaths = {
+			(testDir / "a" / "wood.png").string(),
+			(testDir / "b" / "wood.png").string(),
+			(testDir / "a" / "stone.png").string()
+		};
+		std::filesystem::path const indexPath = testDir / "index" / "UploadedTextures.json";
+
+		std::mutex serverMutex;
+		size_t woodUploads = 0, stoneUploads = 0;
+		int runningUploads = 0, maxRunningUploads = 0;
+		size_t savedWoodMaps = 0, savedStoneMaps = 0;
+		bool bFailNextStoneUpload = true;
+
+		auto const respKeyPostFiles = std::pair("POST", "/advviz/v1/decorations/TEST_MATIO_ID/files");
+		auto const respKeyPostMaterials = std::pair("POST", "/advviz/v1/decorations/TEST_MATIO_ID/materials");
+		auto const respKeyPutMaterials = std::pair("PUT", "/advviz/v1/decorations/TEST_MATIO_ID/materials");
+		mock->responseFctWithData_[respKeyPostFiles] =
+			[&](const std::string& data)
+		{
+			bool bFail = false;
+			{
+				std::unique_lock<std::mutex> lock(serverMutex);
+				maxRunningUploads = std::max(maxRunningUploads, ++runningUploads);
+				if (data.find("_stone.png") != std::string::npos)
+				{
+					++stoneUploads;
+					// Transient error for the 1st attempt: the upload should be retried.
+					bFail = bFailNextStoneUpload;
+					bFailNextStoneUpload = false;
+				}
+				else if (data.find("_wood.png") != std::string::npos)
+				{
+					++woodUploads;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			std::unique_lock<std::mutex> lock(serverMutex);
+			--runningUploads;
+			if (bFail)
+				return HTTPMock::Response2(503, "Service Unavailable");
+			return HTTPMock::Response2(201, "{}");
+		};
+		auto const onMaterialsSaved = [&](const std::string& data)
+		{
+			std::unique_lock<std::mutex> lock(serverMutex);
+			savedWoodMaps += CountOccurrences(data, "_wood.png");
+			savedStoneMaps += CountOccurrences(data, "_stone.png");
+		};
+		mock->responseFctWithData_[respKeyPostMaterials] =
+			[&](const std::string& data)
+		{
+			onMaterialsSaved(data);
+			// Same materials as the ones posted
+			return HTTPMock::Response2(201, std::string(data));
+		};
+		mock->responseFctWithData_[respKeyPutMaterials] =
+			[&](const std::string& data)
+		{
+			onMaterialsSaved(data);
+			return HTTPMock::Response2(200,
+				"{\"numUpdated\":" + std::to_string(CountOccurrences(data, "\"id\":")) + "}");
+		};
+
+		// 3 iModels x 8 materials, each using one of the textures above.
+		auto const setMaterials = [&](MaterialPersistenceManager& matIOMngr, double roughness)
+		{
+			for (int iModel = 0; iModel < 3; ++iModel)
+			{
+				for (uint64_t matID = 0; matID < 8; ++matID)
+				{
+					ITwinMaterial material;
+					material.SetChannelIntensity(EChannelType::Roughness, roughness);
+					material.SetChannelColorMap(EChannelType::Color,
+						ITwinChannelMap{ .texture = texturePaths[matID % texturePaths.size()] });
+					matIOMngr.SetMaterialSettings("iModel" + std::to_string(iModel), matID, material);
+				}
+			}
+		};
+		auto const saveAndWait = [](MaterialPersistenceManager& matIOMngr)
+		{
+			std::atomic_bool saveFinished = false;
+			std::atomic_bool saveSucceeded = false;
+			matIOMngr.AsyncSaveDataOnServer("TEST_MATIO_ID",
+				[&saveFinished, &saveSucceeded](bool bSuccess)
+			{
+				saveSucceeded = bSuccess;
+				saveFinished = true;
+			});
+			REQUIRE(WaitForAsyncTask(saveFinished, 20));
+			REQUIRE(saveSucceeded);
+			REQUIRE(!matIOMngr.NeedUpdateDB());
+		};
+
+		{
+			MaterialPersistenceManager matIOMngr;
+			matIOMngr.SetUploadedTexturesIndexPath(indexPath);
+			setMaterials(matIOMngr, 0.5);
+			saveAndWait(matIOMngr);
+			// One upload per distinct content, plus the retry of the failed one.
+			CHECK(woodUploads == 1);
+			CHECK(stoneUploads == 2);
+			CHECK(maxRunningUploads <= 4);
+			// All materials reference the uploaded textures.
+			CHECK(savedWoodMaps == 18);
+			CHECK(savedStoneMaps == 6);
+
+			// Saving again does not upload anything.
+			setMaterials(matIOMngr, 0.75);
+			saveAndWait(matIOMngr);
+			CHECK(woodUploads == 1);
+			CHECK(stoneUploads == 2);
+			CHECK(savedWoodMaps == 2 * 18);
+			CHECK(savedStoneMaps == 2 * 6);
+		}
+		{
+			// Uploaded textures are also known in a new session, thanks to the index file.
+			MaterialPersistenceManager matIOMngr;
+			matIOMngr.SetUploadedTexturesIndexPath(indexPath);
+			setMaterials(matIOMngr, 0.25);
+			saveAndWait(matIOMngr);
+			CHECK(woodUploads == 1);
+			CHECK(stoneUploads == 2);
+			CHECK(savedWoodMaps == 3 * 18);
+		}
+		{
+			// A texture which cannot be fetched from the server is uploaded again, from the recorded path.
+			std::string woodKey, woodPath;
+			{
+				std::unordered_map<std::string, std::string> uploadedTextures;
+				std::ifstream indexFile(indexPath);
+				std::string parseError;
+				REQUIRE(Json::FromStream(uploadedTextures, indexFile, parseError));
+				for (auto const& [key, filePath] : uploadedTextures)
+				{
+					if (key.ends_with("_wood.png"))
+					{
+						woodKey = key;
+						woodPath = filePath;
+					}
+				}
+			}
+			REQUIRE(woodKey.starts_with("TEST_MATIO_ID/"));
+			CHECK((woodPath == texturePaths[0] || woodPath == texturePaths[1]));
+			MaterialPersistenceManager matIOMngr;
+			matIOMngr.SetUploadedTexturesIndexPath(indexPath);
+			matIOMngr.OnDecorationTextureFetchFailed(woodKey.substr(woodKey.find('/') + 1));
+			for (int i = 0; i < 100; ++i)
+			{
+				{
+					std::unique_lock<std::mutex> lock(serverMutex);
+					if (woodUploads == 2 && runningUploads == 0)
+						break;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			}
+			CHECK(woodUploads == 2);
+			CHECK(stoneUploads == 2);
+			// Once uploaded again, it is recorded again.
+			setMaterials(matIOMngr, 0.125);
+			saveAndWait(matIOMngr);
+			CHECK(woodUploads == 2);
+			CHECK(stoneUploads == 2);
+		}
+		{
+			// Without index, the textures are uploaded again.
+			MaterialPersistenceManager matIOMngr;
+			setMaterials(matIOMngr, 0.25);
+			saveAndWait(matIOMngr);
+			CHECK(woodUploads == 3);
+			CHECK(stoneUploads == 3);
+		}
+
+		mock->responseFctWithData_.erase(respKeyPostFiles);
+		mock->responseFctWithData_.erase(respKeyPostMaterials);
+		mock->responseFctWithData_.erase(respKeyPutMaterials);
+		std::filesystem::remove_all(testDir);
+	}
+	catch (std::string& error)
+	{
+		FAIL("Error: " << error);
+	}
+}
@@ -7,7 +7,14 @@
 +--------------------------------------------------------------------------------------*/
 
 #include "../Visualization.h"
+#include "../KeyframeBatch.h"
+#include "../KeyframeCodec.h"
+#include "../KeyframePrefetch.h"
+#include <chrono>
+#include <cmath>
 #include <filesystem>
+#include <iostream>
+#include <random>
 
 #include <catch2/catch_all.hpp>
 #include "Mock.h"
@@ -231,10 +238,449 @@ TEST_CASE("LoadKeyframeAnimation") {
 					auto ret4 = keyframesInfo->QueryKeyframes(result, 0.0, 1.0);
 					CHECK(ret4.has_value() == true);
 					REQUIRE(result.translations.size() == 30);
+
+					SECTION("Binary keyframes")
+					{
+						const IAnimationKeyframeInfo::TimelineResult expected = result;
+						for (auto encoding : { KeyframeCodec::EEncoding::Binary, KeyframeCodec::EEncoding::Base64 })
+						{
+							KeyframeCodec::SetPreferredEncoding(encoding);
+
+							// server not supporting binary keyframes: JSON is still accepted
+							IAnimationKeyframeInfo::TimelineResult resultJson;
+							CHECK(keyframesInfo->QueryKeyframes(resultJson, 0.0, 1.0).has_value());
+							CHECK(resultJson.translations == expected.translations);
+
+							mock->responseFct_[respKey2] = [encoding, &expected] {
+								if (encoding == KeyframeCodec::EEncoding::Base64)
+									return HTTPMock::Response2(200, KeyframeCodec::EncodeBase64(expected));
+								std::vector<std::uint8_t> data;
+								KeyframeCodec::Encode(expected, data);
+								return HTTPMock::Response2(200, std::string(data.begin(), data.end()));
+								};
+							IAnimationKeyframeInfo::TimelineResult resultBinary;
+							REQUIRE(keyframesInfo->QueryKeyframes(resultBinary, 0.0, 1.0).has_value());
+							CHECK(resultBinary.translations == expected.translations);
+							CHECK(resultBinary.quaternions == expected.quaternions);
+							CHECK(resultBinary.timeRange.begin == expected.timeRange.begin);
+							CHECK(resultBinary.timeRange.end == expected.timeRange.end);
+							CHECK(resultBinary.boundingBox.max == expected.boundingBox.max);
+							CHECK(!resultBinary.scales.has_value());
+						}
+						KeyframeCodec::SetPreferredEncoding(KeyframeCodec::EEncoding::Json);
+						mock->responseFct_.erase(respKey2);
+					}
+
+					SECTION("Prefetch cache")
+					{
+						// room for 2 windows and a half
+						KeyframePrefetcher prefetcher;
+						KeyframePrefetcher::Config config;
+						config.byteBudget = KeyframePrefetcher::GetByteSize(result) * 5 / 2;
+						prefetcher.SetConfig(config);
+						std::vector<KeyframePrefetcher::WindowPtr> windows;
+						std::set<int> evicted;
+						for (int i = 0; i < 3; ++i)
+						{
+							prefetcher.Update(20.f * i, 1.f); // next frame
+							if (i == 2)
+								prefetcher.Touch(*windows[0]);
+							auto window = std::make_shared<KeyframePrefetcher::Window>();
+							window->range_ = TimeRange{ 20.f * i, 20.f * (i + 1) };
+							IAnimationKeyframeInfo::TimelineResult keyframes;
+							REQUIRE(keyframesInfo->QueryKeyframes(keyframes, window->range_.begin, 20.0));
+							window->data_ = MakeSharedLockableData<IAnimationKeyframeInfo::TimelineResult>(std::move(keyframes));
+							window->onEvict_ = [&evicted, i] { evicted.insert(i); };
+							prefetcher.Insert(window);
+							windows.push_back(window);
+						}
+						// the least recently used window is evicted
+						CHECK(evicted == std::set<int>{ 1 });
+						auto counters = prefetcher.GetCounters();
+						CHECK(counters.evictions == 1);
+						CHECK(counters.cachedWindows == 2);
+						CHECK(counters.cachedBytes <= config.byteBudget);
+					}
+				}
+			}
+		}
+	}
+
+}
+
+TEST_CASE("KeyframePrefetcher")
+{
+	using namespace AdvViz::SDK;
+
+	KeyframePrefetcher prefetcher;
+	auto const Window = [](float begin) { return TimeRange{ begin, begin + 20.f }; };
+
+	SECTION("Playing forward")
+	{
+		auto plan = prefetcher.Update(0.f, 1.f);
+		CHECK(plan.queryCurrent);
+		CHECK(plan.current.begin == 0.f);
+		CHECK(plan.ahead.empty()); // next window beyond the lookahead
+		CHECK(!prefetcher.Update(0.5f, 1.f).queryCurrent);
+		CHECK(prefetcher.Update(1.6f, 1.f).queryCurrent); // refresh
+		prefetcher.Update(6.f, 1.f);
+		plan = prefetcher.Update(11.f, 1.f);
+		REQUIRE(plan.ahead.size() == 1);
+		CHECK(plan.ahead[0].begin == 20.f);
+		CHECK(prefetcher.IsWanted(Window(20.f)));
+		CHECK(prefetcher.Update(11.5f, 1.f).ahead.empty()); // already requested
+		plan = prefetcher.Update(19.5f, 1.f);
+		CHECK(plan.current.begin == 20.f); // switch before the end of the window
+		CHECK(prefetcher.IsWanted(Window(0.f))); // still displayed
+		CHECK(!plan.scrubbed);
+	}
+
+	SECTION("Faster playback prefetches further")
+	{
+		auto plan = prefetcher.Update(0.f, 5.f);
+		REQUIRE(plan.ahead.size() == 2);
+		CHECK(plan.ahead[0].begin == 20.f);
+		CHECK(plan.ahead[1].begin == 40.f);
+		CHECK(prefetcher.Update(0.1f, 0.f).ahead.empty()); // paused
+	}
+
+	SECTION("Playing backward")
+	{
+		auto plan = prefetcher.Update(45.f, -1.f);
+		CHECK(plan.current.begin == 40.f);
+		REQUIRE(plan.ahead.size() == 1);
+		CHECK(plan.ahead[0].begin == 20.f);
+		CHECK(!prefetcher.Update(44.5f, -1.f).scrubbed);
+		CHECK(prefetcher.Update(44.5f, 1.f).scrubbed); // change of direction
+	}
+
+	SECTION("Scrubbing")
+	{
+		prefetcher.Update(5.f, 1.f);
+		prefetcher.Update(11.f, 1.f);
+		CHECK(prefetcher.IsWanted(Window(20.f)));
+		auto plan = prefetcher.Update(75.f, 1.f);
+		CHECK(plan.scrubbed);
+		CHECK(plan.queryCurrent);
+		CHECK(plan.current.begin == 60.f);
+		CHECK(!prefetcher.IsWanted(Window(0.f)));
+		CHECK(!prefetcher.IsWanted(Window(20.f)));
+		CHECK(prefetcher.IsWanted(Window(60.f)));
+
+		prefetcher.Reset();
+		CHECK(!prefetcher.IsWanted(Window(60.f)));
+		plan = prefetcher.Update(0.f, 1.f);
+		CHECK(!plan.scrubbed);
+		CHECK(plan.queryCurrent);
+	}
+
+	SECTION("Counters")
+	{
+		prefetcher.OnRequest();
+		prefetcher.OnRequest();
+		prefetcher.OnResponse(10.0, false);
+		prefetcher.OnResponse(30.0, true);
+		prefetcher.OnHit();
+		prefetcher.OnMiss();
+		prefetcher.OnMiss();
+		auto counters = prefetcher.GetCounters();
+		CHECK(counters.requests == 2);
+		CHECK(counters.cancelled == 1);
+		CHECK(counters.hits == 1);
+		CHECK(counters.misses == 2);
+		CHECK(counters.lastLatency == 30.0);
+		CHECK(counters.averageLatency == 20.0);
+		CHECK(counters.maxLatency == 30.0);
+	}
+}
+
+namespace
+{
+	// Random path of keyframeCount keys, covering [0, duration].
+	AdvViz::SDK::IAnimationKeyframeInfo::TimelineResult MakeRandomTimeline(std::mt19937& rng, size_t keyframeCount, float duration)
+	{
+		std::uniform_real_distribution<float> dist(-1.f, 1.f);
+		AdvViz::SDK::IAnimationKeyframeInfo::TimelineResult result;
+		for (size_t k = 0; k < keyframeCount; ++k)
+		{
+			for (int c = 0; c < 3; ++c)
+				result.translations.push_back(100.f * dist(rng));
+			float q[4] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+			float const norm = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+			for (int c = 0; c < 4; ++c)
+				result.quaternions.push_back(q[c] / norm);
+		}
+		result.timeRange.begin = 0.f;
+		result.timeRange.end = duration;
+		return result;
+	}
+}
+
+TEST_CASE("KeyframeBatch")
+{
+	using namespace AdvViz::SDK;
+
+	std::mt19937 rng(42);
+	std::unique_ptr<IAnimationKeyframeInfo> info(IAnimationKeyframeInfo::New());
+
+	SECTION("Interpolation matches GetInterpolatedValue")
+	{
+		KeyframeBatch batch;
+		std::vector<IAnimationKeyframeInfo::TimelineValue> expected;
+		std::uniform_real_distribution<float> timeDist(0.f, 19.99f);
+		for (int i = 0; i < 1000; ++i)
+		{
+			auto result = MakeRandomTimeline(rng, 20, 20.f);
+			if (i == 0) // identical consecutive keys
+				std::copy_n(result.quaternions.begin(), 4, result.quaternions.begin() + 4);
+			float const time = (i == 0) ? 0.5f : timeDist(rng);
+			IAnimationKeyframeInfo::TimelineValue value;
+			REQUIRE(info->GetInterpolatedValue(result, time, value));
+			REQUIRE(batch.Add(result, time));
+			expected.push_back(value);
+		}
+		IAnimationKeyframeInfo::TimelineResult empty;
+		CHECK(!batch.Add(empty, 0.f));
+		CHECK(batch.GetCount() == expected.size());
+
+		std::vector<dmat3x4> transforms;
+		batch.Interpolate(transforms);
+		REQUIRE(transforms.size() == expected.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			const dmat3x4& mat = transforms[i];
+			for (unsigned c = 0; c < 3; ++c)
+				CHECK(std::abs(ColRow3x4(mat, c, 3) - expected[i].translation[c]) < 1e-4);
+			// Rotating a vector must give the same result as the quaternion.
+			const auto& q = expected[i].quaternion; // x, y, z, w
+			const double v[3] = { 1.0, 2.0, 3.0 };
+			// v' = v + 2w(u x v) + 2u x (u x v)
+			const double u[3] = { q[0], q[1], q[2] };
+			const double uv[3] = { u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0] };
+			const double uuv[3] = { u[1] * uv[2] - u[2] * uv[1], u[2] * uv[0] - u[0] * uv[2], u[0] * uv[1] - u[1] * uv[0] };
+			for (unsigned r = 0; r < 3; ++r)
+			{
+				const double rotated = v[r] + 2.0 * (q[3] * uv[r] + uuv[r]);
+				double fromMatrix = 0.0;
+				for (unsigned c = 0; c < 3; ++c)
+					fromMatrix += ColRow3x4(mat, c, r) * v[c];
+				CHECK(std::abs(fromMatrix - rotated) < 1e-4);
+			}
+		}
+
+		batch.Clear();
+		CHECK(batch.GetCount() == 0);
+	}
+
+	SECTION("Grid culling matches brute force")
+	{
+		std::uniform_real_distribution<double> posDist(-1000.0, 1000.0);
+		std::uniform_real_distribution<double> sizeDist(1.0, 300.0);
+		for (size_t boxCount : { 0, 1, 5, 40 })
+		{
+			std::vector<BoundingBox> boxes(boxCount);
+			for (auto& box : boxes)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					box.min[c] = posDist(rng);
+					box.max[c] = box.min[c] + sizeDist(rng);
 				}
 			}
+			BoundingBoxGrid grid;
+			grid.Build(boxes);
+			for (int i = 0; i < 10000; ++i)
+			{
+				double3 p = { posDist(rng), posDist(rng), posDist(rng) };
+				if (boxCount > 0 && i % 10 == 0) // points on the border of a box
+					p = boxes[i % boxCount].max;
+				bool bExpected = false;
+				for (const auto& box : boxes)
+					bExpected = bExpected || box.Contains(p);
+				CHECK(grid.Contains(p) == bExpected);
+			}
+		}
+
+		// flat box
+		BoundingBox flat;
+		flat.min = { 0.0, 0.0, 5.0 };
+		flat.max = { 10.0, 10.0, 5.0 };
+		BoundingBoxGrid grid;
+		grid.Build({ flat });
+		CHECK(grid.Contains(double3{ 5.0, 5.0, 5.0 }));
+		CHECK(!grid.Contains(double3{ 5.0, 5.0, 5.1 }));
+	}
+}
+
+TEST_CASE("KeyframeBatch: benchmark", "[.][benchmark]")
+{
+	using namespace AdvViz::SDK;
+	using Clock = std::chrono::steady_clock;
+
+	const size_t itemCount = 50000;
+	std::mt19937 rng(42);
+	std::vector<IAnimationKeyframeInfo::TimelineResult> results;
+	for (size_t i = 0; i < itemCount; ++i)
+		results.push_back(MakeRandomTimeline(rng, 20, 20.f));
+	std::vector<BoundingBox> boxes(8);
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		boxes[i].min = { -100.0 + 25.0 * i, -100.0, -100.0 };
+		boxes[i].max = { -80.0 + 25.0 * i, 100.0, 100.0 };
+	}
+	std::unique_ptr<IAnimationKeyframeInfo> info(IAnimationKeyframeInfo::New());
+
+	const float time = 7.3f;
+	auto start = Clock::now();
+	size_t visibleLegacy = 0;
+	for (const auto& result : results)
+	{
+		IAnimationKeyframeInfo::TimelineValue value;
+		if (!info->GetInterpolatedValue(result, time, value))
+			continue;
+		double3 pos = { value.translation[0], value.translation[1], value.translation[2] };
+		for (const auto& box : boxes)
+		{
+			if (box.Contains(pos))
+			{
+				++visibleLegacy;
+				break;
+			}
 		}
 	}
+	auto const legacyTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	start = Clock::now();
+	KeyframeBatch batch;
+	for (const auto& result : results)
+		batch.Add(result, time);
+	std::vector<dmat3x4> transforms;
+	batch.Interpolate(transforms);
+	BoundingBoxGrid grid;
+	grid.Build(boxes);
+	size_t visibleBatch = 0;
+	for (const auto& mat : transforms)
+	{
+		if (grid.Contains(double3{ ColRow3x4(mat, 0, 3), ColRow3x4(mat, 1, 3), ColRow3x4(mat, 2, 3) }))
+			++visibleBatch;
+	}
+	auto const batchTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	CHECK(visibleBatch == visibleLegacy);
+	std::cout << "KeyframeBatch (" << itemCount << " items): per item " << legacyTime << " ms, batched " << batchTime << " ms" << std::endl;
+}
+
+TEST_CASE("KeyframeCodec")
+{
+	using namespace AdvViz::SDK;
+
+	IAnimationKeyframeInfo::TimelineResult result;
+	std::mt19937 rng(7);
+	result = MakeRandomTimeline(rng, 33, 10.f);
+	result.scales.emplace(33 * 3, 2.f);
+	result.stateIds.emplace(33, std::int8_t(-3));
+	result.boundingBox.min = { -1.0, -2.0, -3.0 };
+	result.boundingBox.max = { 1.0, 2.0, 3.0 };
+
+	std::vector<std::uint8_t> data;
+	KeyframeCodec::Encode(result, data);
+
+	SECTION("Round trip")
+	{
+		IAnimationKeyframeInfo::TimelineResult decoded;
+		REQUIRE(KeyframeCodec::Decode(data.data(), data.size(), decoded));
+		CHECK(decoded.translations == result.translations);
+		CHECK(decoded.quaternions == result.quaternions);
+		CHECK(decoded.scales == result.scales);
+		CHECK(decoded.stateIds == result.stateIds);
+		CHECK(decoded.boundingBox.min == result.boundingBox.min);
+		CHECK(decoded.boundingBox.max == result.boundingBox.max);
+		CHECK(decoded.timeRange.begin == result.timeRange.begin);
+		CHECK(decoded.timeRange.end == result.timeRange.end);
+	}
+
+	SECTION("Invalid data")
+	{
+		IAnimationKeyframeInfo::TimelineResult decoded;
+		CHECK(!KeyframeCodec::Decode(data.data(), data.size() - 1, decoded));
+		CHECK(!KeyframeCodec::Decode(data.data(), 10, decoded));
+		data[0] = 'X';
+		CHECK(!KeyframeCodec::Decode(data.data(), data.size(), decoded));
+	}
 
+	SECTION("Encoding detection")
+	{
+		Http::Response response(200, std::string(data.begin(), data.end()));
+		CHECK(KeyframeCodec::DetectEncoding(response) == KeyframeCodec::EEncoding::Binary);
+		response.second = KeyframeCodec::EncodeBase64(result);
+		CHECK(KeyframeCodec::DetectEncoding(response) == KeyframeCodec::EEncoding::Base64);
+		response.rawdata_ = std::make_shared<Http::RawData>(data);
+		CHECK(KeyframeCodec::DetectEncoding(response) == KeyframeCodec::EEncoding::Binary);
+		response.rawdata_.reset();
+		response.second = "{\"translations\":[]}";
+		CHECK(KeyframeCodec::DetectEncoding(response) == KeyframeCodec::EEncoding::Json);
+	}
 }
 
+TEST_CASE("KeyframeCodec: benchmark", "[.][benchmark]")
+{
+	using namespace AdvViz::SDK;
+	using Clock = std::chrono::steady_clock;
+
+	SetDefaultConfig();
+	HTTPMock* mock = GetHttpMock();
+	REQUIRE(mock != nullptr);
+
+	// 10 minutes at 30 fps
+	std::mt19937 rng(42);
+	const IAnimationKeyframeInfo::TimelineResult result = MakeRandomTimeline(rng, 18000, 600.f);
+	struct SKeyframesJson
+	{
+		std::vector<float> translations;
+		std::vector<float> quaternions;
+		TimeRange timeRange;
+	};
+	const SKeyframesJson json{ result.translations, result.quaternions, result.timeRange };
+	std::vector<std::uint8_t> binary;
+	KeyframeCodec::Encode(result, binary);
+	const std::map<KeyframeCodec::EEncoding, std::string> bodies = {
+		{ KeyframeCodec::EEncoding::Json, Json::ToString(json) },
+		{ KeyframeCodec::EEncoding::Binary, std::string(binary.begin(), binary.end()) },
+		{ KeyframeCodec::EEncoding::Base64, KeyframeCodec::EncodeBase64(result) },
+	};
+
+	const HTTPMock::RequestKey key = std::pair("GET", "/advviz/v1/benchmark/keyframes");
+	const auto& http = GetDefaultHttp();
+	const int iterations = 20;
+	for (const auto& [encoding, body] : bodies)
+	{
+		mock->responseFct_[key] = [&body] { return HTTPMock::Response2(200, std::string(body)); };
+		double requestTime = 0.0, parseTime = 0.0;
+		for (int i = 0; i < iterations; ++i)
+		{
+			auto start = Clock::now();
+			auto response = http->Get("benchmark/keyframes", { {"accept", KeyframeCodec::GetAcceptHeader(encoding)} });
+			REQUIRE(response.first == 200);
+			auto received = Clock::now();
+			IAnimationKeyframeInfo::TimelineResult decoded;
+			if (encoding == KeyframeCodec::EEncoding::Json)
+			{
+				SKeyframesJson parsed;
+				REQUIRE(Json::FromString(parsed, response.second));
+				decoded.translations = std::move(parsed.translations);
+			}
+			else
+			{
+				auto ret = KeyframeCodec::DecodeResponse(response, *http, decoded);
+				REQUIRE((ret && ret.value()));
+			}
+			CHECK(decoded.translations.size() == result.translations.size());
+			requestTime += std::chrono::duration<double, std::milli>(received - start).count();
+			parseTime += std::chrono::duration<double, std::milli>(Clock::now() - received).count();
+		}
+		const char* names[] = { "json", "binary", "base64" };
+		std::cout << "Keyframes " << names[(int)encoding] << ": " << body.size() << " bytes, request "
+			<< requestTime / iterations << " ms, parse " << parseTime / iterations << " ms" << std::endl;
+	}
+	mock->responseFct_.erase(key);
+}
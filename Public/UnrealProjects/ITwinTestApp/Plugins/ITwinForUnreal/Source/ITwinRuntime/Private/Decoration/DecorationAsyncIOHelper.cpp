@@ -73,7 +73,7 @@ namespace ITwin
 			AdvViz::SDK::GetDefaultHttp()->GetAccessToken()->Get(),
 			getAssetAccessor(),
 			getAsyncSystem(),
-			[&Buffer](std::vector<uint8_t> const& TexBuffer)
+			[&Buffer](std::span<uint8_t const> TexBuffer)
 		{
 			if (!TexBuffer.empty()) {
 				Buffer.Append(
@@ -162,6 +162,11 @@ namespace ITwin
 				return false;
 			}
 		});
+
+		// Keep the reduced textures computed by ResampleTextureBuffer from one session to the next.
+		FString const ThumbnailCacheDir = FPaths::Combine(
+			FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir()), TEXT("ITwin"), TEXT("TextureThumbnails"));
+		BeUtils::GltfMaterialTuner::SetThumbnailCacheDirectory(std::filesystem::path(*ThumbnailCacheDir));
 	}
 }
 
@@ -348,6 +353,10 @@ void FDecorationAsyncIOHelper::InitDecorationService(UWorld* WorldContextObject)
 	materialPersistenceMngr = std::make_shared<MaterialPersistenceManager>();
 	FString const MaterialLibraryPath = FITwinMaterialLibrary::GetBentleyLibraryPath();
 	materialPersistenceMngr->SetMaterialLibraryDirectory(TCHAR_TO_UTF8(*MaterialLibraryPath));
+	// Remember uploaded textures from one session to the next, to avoid uploading them again.
+	FString const UploadedTexturesIndex = FPaths::Combine(
+		FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir()), TEXT("ITwin"), TEXT("UploadedTextures.json"));
+	materialPersistenceMngr->SetUploadedTexturesIndexPath(std::filesystem::path(*UploadedTexturesIndex));
 	AITwinIModel::SetMaterialPersistenceManager(materialPersistenceMngr);
 
 	if (bUseDecorationService)
@@ -902,76 +911,55 @@ void FDecorationAsyncIOHelper::AsyncLoadMaterials(
 				}
 			}
 
-			if (!ITwin::ResolveDecorationTextures(*materialPersistenceMngrPtr,
-				materialPersistenceMngrPtr->GetDecorationTexturesByIModel(),
-				imodelToMatHelper))
-			{
-				OnFinishCallback(AdvViz::make_unexpected("Failed to resolve decoration textures"));
-				return;
-			}
-
-			// Mark iModels just loaded in the manager, now that the *whole* process (including texture resolution)
-			// is done.
+			// Do not block this thread while decoration textures are downloaded: the loading is finished when
+			// they are stored.
+			std::vector<std::string> loadedIModelIds;
+			loadedIModelIds.reserve(imodelToMatHelper.size());
 			for (auto const& [iModelId, _] : imodelToMatHelper)
 			{
-				materialPersistenceMngrPtr->SetLoadedModel(iModelId, true);
+				loadedIModelIds.push_back(iModelId);
 			}
+			ITwin::ResolveDecorationTexturesAsync(*materialPersistenceMngrPtr,
+				materialPersistenceMngrPtr->GetDecorationTexturesByIModel(),
+				imodelToMatHelper,
+				/*bResolveLocalDiskTextures*/false,
+				[OnFinishCallback, materialPersistenceMngrPtr, loadedIModelIds = std::move(loadedIModelIds), exp]()
+			{
+				// Mark iModels just loaded in the manager, now that the *whole* process (including texture
+				// resolution) is done.
+				for (auto const& iModelId : loadedIModelIds)
+				{
+					materialPersistenceMngrPtr->SetLoadedModel(iModelId, true);
+				}
 
-			OnFinishCallback(exp);
+				OnFinishCallback(exp);
+			});
 		}, specificModels);
 }
 
 namespace Detail
 {
 
-// Scoped W-Lock doing nothing if a lock is provided from outside
-struct [[nodiscard]] OptionalWLock
-{
-	OptionalWLock(BeUtils::GltfMaterialHelper& MatHelper, BeUtils::WLock const* pLock = nullptr)
-		: ExternalLock(pLock)
-	{
-		if (ExternalLock)
-		{
-			BE_ASSERT(ExternalLock->mutex() == &MatHelper.GetMutex());
-		}
-		else
-		{
-			LocalLock.emplace(MatHelper.GetMutex());
-		}
-	}
-
-	BeUtils::WLock const& GetLock() const {
-		BE_ASSERT(ExternalLock || LocalLock);
-		return ExternalLock ? *ExternalLock : *LocalLock;
-	}
-
-	BeUtils::WLock const* const ExternalLock = nullptr;
-	std::optional<BeUtils::WLock> LocalLock;
-};
-
-
-void ResolveTexturesMatchingSource(
+CesiumAsync::Future<bool> ResolveTexturesMatchingSourceAsync(
 	AdvViz::SDK::ETextureSource TexSource,
 	AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
 	AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
-	std::map<std::string, AITwinIModel::GltfMaterialHelperPtr> const& imodelToMatHelper,
-	BeUtils::WLock const* pLock = nullptr)
+	std::map<std::string, AITwinIModel::GltfMaterialHelperPtr> const& imodelToMatHelper)
 {
 	if (!ensure(AdvViz::SDK::GetDefaultHttp()->GetAccessToken()))
 	{
-		return;
+		return getAsyncSystem().createResolvedFuture(false);
 	}
-	return BeUtils::ResolveTexturesMatchingSource(
+	return BeUtils::ResolveTexturesMatchingSourceAsync(
 		TexSource, matPersistenceMngr, perModelTextures, imodelToMatHelper,
 		AdvViz::SDK::GetDefaultHttp()->GetAccessToken()->Get(),
-		getAssetAccessor(), getAsyncSystem(), pLock);
+		getAssetAccessor(), getAsyncSystem());
 }
 
 void ResolveTexturesLocatedOnDisk(
 	std::unordered_map<AdvViz::SDK::TextureKey, std::string> const& LocalTextures,
 	AITwinIModel::GltfMaterialHelperPtr gltfMatHelper,
-	std::filesystem::path const& textureDir,
-	BeUtils::WLock const* pLock = nullptr)
+	std::filesystem::path const& textureDir)
 {
 	// Remark: following merge with Cesium 2.14.1, we no longer use #resolveExternalData for local textures
 	// (using the file:/// protocol): it does not work at all in packaged version...
@@ -1003,8 +991,7 @@ void ResolveTexturesLocatedOnDisk(
 	}
 	// Dispatch the read images.
 	{
-		OptionalWLock OptLock(*gltfMatHelper, pLock);
-		auto const& lock = OptLock.GetLock();
+		BeUtils::WLock lock(gltfMatHelper->GetMutex());
 
 		imgIndex = 0;
 
@@ -1027,24 +1014,22 @@ void ResolveTexturesLocatedOnDisk(
 	}
 }
 
-}
-
-bool ITwin::ResolveDecorationTextures(
+CesiumAsync::Future<bool> ResolveDecorationTextures(
 	AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
 	AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
 	std::map<std::string, AITwinIModel::GltfMaterialHelperPtr> const& imodelToMatHelper,
-	bool bResolveLocalDiskTextures /*= false*/,
-	BeUtils::WLock const* pLock /*= nullptr*/)
+	bool bResolveLocalDiskTextures)
 {
 	// Following merge with cesium-unreal v2.14.1, we need to provide a valid base URL to
 	// #resolveExternalData, so as a quick fix I am now downloading Decoration and Library textures
 	// separately (and will ask cesium team whether the new behavior of
 	// Uri::resolve("", "https://toto.com", true) should really be just "toto.com" as it is now...)
-	Detail::ResolveTexturesMatchingSource(AdvViz::SDK::ETextureSource::Decoration,
+	// Decoration textures are downloaded while we read the textures located on disk.
+	CesiumAsync::Future<bool> DecorationTexturesFuture = ResolveTexturesMatchingSourceAsync(
+		AdvViz::SDK::ETextureSource::Decoration,
 		matPersistenceMngr,
 		perModelTextures,
-		imodelToMatHelper,
-		pLock);
+		imodelToMatHelper);
 
 	// For the Material Library (local files which are packaged in Carrot context), we no longer use
 	// #resolveExternalData - also since v2.14.1, which broke this case as well, but only in packaged mode.
@@ -1073,15 +1058,43 @@ bool ITwin::ResolveDecorationTextures(
 				LocalDiskTexMap.emplace(texKey, texKey.id);
 			}
 		}
-		Detail::ResolveTexturesLocatedOnDisk(MatLibraryTexMap, glTFMatHelper,
-			MatLibraryDir, pLock);
+		ResolveTexturesLocatedOnDisk(MatLibraryTexMap, glTFMatHelper, MatLibraryDir);
 
 		if (bResolveLocalDiskTextures)
 		{
-			Detail::ResolveTexturesLocatedOnDisk(LocalDiskTexMap, glTFMatHelper,
-				{}, pLock);
+			ResolveTexturesLocatedOnDisk(LocalDiskTexMap, glTFMatHelper, {});
 		}
 	}
+	return DecorationTexturesFuture;
+}
+
+}
+
+void ITwin::ResolveDecorationTexturesAsync(
+	AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+	AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+	std::map<std::string, AITwinIModel::GltfMaterialHelperPtr> const& imodelToMatHelper,
+	bool bResolveLocalDiskTextures,
+	std::function<void()>&& onResolved)
+{
+	Detail::ResolveDecorationTextures(matPersistenceMngr, perModelTextures, imodelToMatHelper,
+		bResolveLocalDiskTextures)
+		.thenImmediately([onResolved = std::move(onResolved)](bool /*bDecorationTexturesOK*/)
+	{
+		// Failures are logged by BeUtils, and do not prevent the materials from being loaded (as before).
+		onResolved();
+	});
+}
+
+bool ITwin::ResolveDecorationTextures(
+	AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+	AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+	std::map<std::string, AITwinIModel::GltfMaterialHelperPtr> const& imodelToMatHelper,
+	bool bResolveLocalDiskTextures /*= false*/)
+{
+	// Failures are logged by BeUtils, and do not prevent the materials from being loaded (as before).
+	Detail::ResolveDecorationTextures(matPersistenceMngr, perModelTextures, imodelToMatHelper,
+		bResolveLocalDiskTextures).wait();
 	return true;
 }
 
@@ -22,6 +22,7 @@
 #include <Network/UEHttp.h>
 
 // UE headers
+#include <Misc/CoreDelegates.h>
 #include <Misc/MessageDialog.h>
 
 
@@ -79,9 +80,25 @@ void FITwinStartup::CommonStartup(FString const& ModuleName)
 
 	const std::string ModuleNameUTF8 = TCHAR_TO_UTF8(*ModuleName);
 	Tools::InitAssertHandler(ModuleNameUTF8);
+	// SDK logs are written by a background thread: write the pending ones before Unreal reports a crash.
+	static bool bFlushLogOnSystemError = false;
+	if (!bFlushLogOnSystemError)
+	{
+		bFlushLogOnSystemError = true;
+		FCoreDelegates::OnHandleSystemError.AddStatic(&Tools::FlushLog);
+	}
 	BE_LOGI("App", "========== Starting Unreal '" << ModuleNameUTF8 << "' module ==========");
 }
 
+/*static*/
+void FITwinStartup::CommonShutdown()
+{
+	BE_LOGI("App", "========== Shutting down Unreal module ==========");
+	// Stop the SDK log writer thread now: it must not be joined later by a static destructor, which would
+	// run under the loader lock when the module is unloaded.
+	AdvViz::SDK::Tools::ShutdownLog();
+}
+
 void FITwinStartup::EnableVR()
 {
 	AITwinAnnotation::EnableVR();
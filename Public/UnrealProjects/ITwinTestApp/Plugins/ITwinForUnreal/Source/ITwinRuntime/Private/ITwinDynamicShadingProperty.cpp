@@ -55,12 +55,12 @@ FITwinDynamicShadingProperty<DataType, NumChannels>::FITwinDynamicShadingPropert
 	, TextureDataBytesPerRow(TextureDimension * TextureDataBytesPerPixel)
 	, TextureDataBytesTotal(TextureDimension * TextureDataBytesPerRow)
 	, TextureComponentsPerRow(NumChannels * (size_t)TextureDimension)
-	, TextureDataTransferBuffer(TextureDimension * TextureComponentsPerRow, DataType(0))
-	, TextureRegion(0, 0, 0, 0, TextureDimension, TextureDimension)
+	, DirtyRegions(static_cast<uint32>(TextureDimension), static_cast<uint32>(TextureDimension))
 	, OwnerPtr(InOwnerPtr)
 {
 	// Yes, TextureData contains DataType values, not uint8!
 	TextureData.resize(TextureDimension * TextureComponentsPerRow, DataType(0));
+	TransferData->Data.reserve(TextureData.size());
 	InitializeTexture(FillWithValue);
 }
 
@@ -214,54 +214,75 @@ bool FITwinDynamicShadingProperty<DataType, NumChannels>::UpdateTexture()
 		BE_LOGW("ITwinRender", "Dynamic Texture's update attempt while Texture isn't init'd or already GC'd!");
 		return true;
 	}
-	if (!bNeedUpdate)
+	if (!DirtyRegions.IsDirty())
 	{
 		return false;
 	}
 	auto* TextureRHI = ((FTexture2DResource*)Texture->GetResource())->GetTexture2DRHI();
-	// tested in UpdateTextureRegions too but bNeedUpdate requires this early exit
+	// tested in UpdateTextureRegions too but the dirty regions require this early exit
 	if (!TextureRHI)
 	{
 		return true;
 	}
 
-	bNeedUpdate = false;
+	// Only upload the modified parts of the texture: most updates (highlight, 4D colors...) modify a few
+	// features at a time, ie. a few pixels, whereas there may be thousands of such textures.
+	DirtyRegions.Coalesce(DirtyRects);
+	DirtyRegions.Clear();
 	// Note: UpdateTextureRegions passes the data *pointer* to RHIUpdateTexture2D (in a deferred manner, of
 	// course, since the function is called on the render thread). Only RHIUpdateTexture2D copies the data!
 	// => thus we need to copy TextureData in a second buffer, so that we do not modify the values while they
-	// are read by the render thread / RHI thread.
-	// Also note we protect the data from deletion by copying the shared pointers of both the transfer buffer
-	// and "this" instance in the lambda capture list below. The 'Texture' and 'TextureRegion' members are
-	// thus protected because FITwinSceneTile::Unload no longer destroys the texture if update messages are
-	// still pending.
-	std::shared_ptr<DataVec> TransferBuffer;
+	// are read by the render thread / RHI thread. The same goes for the regions.
+	// Also note we protect the data from deletion by copying the shared pointers of both the transfer data
+	// and "this" instance in the lambda capture list below. The 'Texture' member is thus protected because
+	// FITwinSceneTile::Unload no longer destroys the texture if update messages are still pending.
+	std::shared_ptr<FTransferData> Transfer;
 	if (UpdateTasksInProgress > 0)
 	{
-		// Here we need to allocate another buffer, since TextureDataTransferBuffer is already in use...
-		// Note that TextureRegion is never modified, so it can be shared by all tasks without problem.
-		TransferBuffer = std::make_shared<DataVec>();
-		*TransferBuffer = TextureData;
+		// Here we need to allocate another buffer, since TransferData is already in use...
+		Transfer = std::make_shared<FTransferData>();
 	}
 	else
 	{
 		// I wanted to avoid needless copies by swapping vectors instead, along with a bNeedCopyOnWrite flag
-		// so that only in that case write methods would copy TextureDataTransferBuffer back into TextureData
+		// so that only in that case write methods would copy the transfer buffer back into TextureData
 		// before writing. But to actually avoid the copy (when the update message is handled before any new
 		// write is attempted to the texture), we would also need to swap back the vectors in the
 		// clean-up function, which is not possible safely since we use no mutex to synchronize it with the
 		// game thread execution flow.
 		// We could do it in the future if we have to use a mutex for some other imperious reason, or if it is
 		// found preferable performance-wise.
-		TextureDataTransferBuffer = TextureData;
+		Transfer = TransferData;
+	}
+	// Pack the dirty rectangles one below the other, at their original X position (see FTransferData).
+	uint32 PackedRows = 0;
+	for (auto const& Rect : DirtyRects)
+	{
+		PackedRows += Rect.height;
+	}
+	Transfer->Data.resize(PackedRows * TextureComponentsPerRow);
+	Transfer->Regions.clear();
+	uint32 SrcY = 0;
+	for (auto const& Rect : DirtyRects)
+	{
+		Transfer->Regions.emplace_back(Rect.x, Rect.y, Rect.x, SrcY, Rect.width, Rect.height);
+		size_t const RectComponentsOffset = Rect.x * (size_t)NumChannels;
+		for (uint32 Row = 0; Row < Rect.height; ++Row)
+		{
+			memcpy(&Transfer->Data[(SrcY + Row) * TextureComponentsPerRow + RectComponentsOffset],
+				&TextureData[(Rect.y + Row) * TextureComponentsPerRow + RectComponentsOffset],
+				Rect.width * TextureDataBytesPerPixel);
+		}
+		SrcY += Rect.height;
 	}
 	// Use the cleanup function (executed by the RHI thread) to decrement this counter when the update is done
 	UpdateTasksInProgress++;
 
-	Texture->UpdateTextureRegions(0/*Mip*/, 1/*NumRegions*/, &TextureRegion,
-		TextureDataBytesPerRow, TextureDataBytesPerPixel,
-		reinterpret_cast<uint8*>(TransferBuffer ? TransferBuffer->data() : TextureDataTransferBuffer.data()),
+	Texture->UpdateTextureRegions(0/*Mip*/, static_cast<uint32>(Transfer->Regions.size()),
+		Transfer->Regions.data(), TextureDataBytesPerRow, TextureDataBytesPerPixel,
+		reinterpret_cast<uint8*>(Transfer->Data.data()),
 		[ this, ThisOwnerPtr = this->OwnerPtr/*extend "this" lifetime until end of clean-up lambda*/,
-		  ShTransferBuffer = TransferBuffer ]
+		  Transfer ]
 		(uint8* /*SrcData*/, const FUpdateTextureRegion2D* /*Regions*/)
 		{
 			// Just testing *IsValidLambda (now removed) was not thread-safe: the CPU might have switched to the
@@ -290,7 +311,7 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixel(uint32 const
 		*TexPtr = ChanVal;
 		++TexPtr;
 	}
-	InvalidateTexture();
+	InvalidatePixel(Pixel);
 }
 
 template<typename DataType, int NumChannels>
@@ -311,7 +332,7 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixel(uint32 const
 		}
 		++TexPtr;
 	}
-	InvalidateTexture();
+	InvalidatePixel(Pixel);
 }
 
 template<typename DataType, int NumChannels>
@@ -362,7 +383,7 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixel(int32 X, int3
 		*TexPtr = ChanVal;
 		++TexPtr;
 	}
-	InvalidateTexture();
+	DirtyRegions.MarkPixel(static_cast<uint32>(X), static_cast<uint32>(Y));
 }
 
 template<typename DataType, int NumChannels>
@@ -379,7 +400,7 @@ template<typename DataType, int NumChannels>
 void FITwinDynamicShadingProperty<DataType, NumChannels>::SetAllPixelsAlpha(DataType const Value)
 {
 	DataType* TexPtr = (&TextureData[0]) + Detail::GetTextureAlphaChannelIndex<DataType, NumChannels>();
-	for (uint32 Pixel = 0; Pixel < TotalUsedPixels; TexPtr += NumChannels)
+	for (uint32 Pixel = 0; Pixel < TotalUsedPixels; ++Pixel, TexPtr += NumChannels)
 	{
 		*TexPtr = Value;
 	}
@@ -395,7 +416,7 @@ bool FITwinDynamicShadingProperty<DataType, NumChannels>::WriteTextureToFile(FSt
 #if ITWIN_SAVE_DYNTEX_TO_FILE()
 	if (!IsValid(Texture))
 		return false;
-	if (bNeedUpdate)
+	if (DirtyRegions.IsDirty())
 	{
 		UpdateTexture();
 	}
@@ -14,6 +14,10 @@
 #include "RHITypes.h"
 #include "UObject/NameTypes.h"
 
+#include <Compil/BeforeNonUnrealIncludes.h>
+	#include <BeUtils/Misc/DirtyRegions.h>
+#include <Compil/AfterNonUnrealIncludes.h>
+
 #include <array>
 #include <atomic>
 #include <memory>
@@ -28,6 +32,7 @@ class UMaterialInstanceDynamic;
 /// properties usable from a material shader. Currently supported template combinations are:
 ///		* uint8 with 4 channels: uncompressed, ie lossless
 ///		* float with 1 or 4 channels: should use a high-quality low compression format
+/// Writes are tracked (see BeUtils::DirtyRegions) so that UpdateTexture only uploads the modified regions.
 ///
 /// Bootstrapped from https://dev.epicgames.com/community/learning/tutorials/ow9v/...
 ///						.../unreal-engine-creating-a-runtime-editable-texture-in-c
@@ -73,7 +78,7 @@ public:
 	void SetAllPixelsAlpha(DataType const Value);
 	void SetAllPixelsExceptAlpha(std::array<DataType, NumChannels> const& Value);
 
-	/// Update Texture Object from Texture Data
+	/// Update Texture Object from Texture Data: only the regions modified since the last update are uploaded.
 	/// \return A flag telling whether the texture is "dirty", ie either the texture resource isn't even ready
 	///		yet, and the call couldn't actually process the update request, or it is ready and an update
 	///		render command was enqueued. The return value will be false as soon as the asynchronous command
@@ -107,10 +112,21 @@ private:
 
 	using DataVec = std::vector<DataType>;
 	DataVec TextureData;
-	bool bNeedUpdate = true;
-	/// Copy of TextureData used only for the asynchronous update of the Unreal texture.
-	DataVec TextureDataTransferBuffer;
-	// See comment above "TextureDataTransferBuffer = TextureData;" in UpdateTexture
+	/// Parts of TextureData modified since the last update (the whole texture initially).
+	BeUtils::DirtyRegions DirtyRegions;
+	std::vector<BeUtils::DirtyRegions::Rect> DirtyRects; ///< Temporary, kept to avoid reallocations
+	/// Copy of the modified parts of TextureData, used only for the asynchronous update of the Unreal
+	/// texture: the modified rectangles are packed one below the other, keeping their X position and the row
+	/// pitch of TextureData, since UpdateTextureRegions uses the same source buffer and pitch for all regions.
+	struct FTransferData
+	{
+		DataVec Data;
+		/// Regions passed to UpdateTextureRegions, which only copies the pointer: like Data, they need to
+		/// persist until the update is done.
+		std::vector<FUpdateTextureRegion2D> Regions;
+	};
+	std::shared_ptr<FTransferData> const TransferData = std::make_shared<FTransferData>();
+	// See comment above "Transfer = TransferData;" in UpdateTexture
 	//bool bNeedCopyOnWrite = false;
 
 	/// Number of (asynchronous) update task which are currently stacked in the render thread. The counter is
@@ -128,7 +144,6 @@ private:
 	/// we don't have to hold it by a UPROPERTY, which would mean having this class a UCLASS/USTRUCT, and in
 	/// turn all classes that hold them, etc. (question: would a TStrongPtr work, too?)
 	UTexture2D* Texture = nullptr;
-	FUpdateTextureRegion2D const TextureRegion;
 
 	/// Instances of this class need to persist until the last UpdateTexture message has been processed by the
 	/// render (or RHI?) thread: this is done by copying the shared_ptr ensuring this instance's lifetime in
@@ -139,8 +154,10 @@ private:
 
 	void InitializeTexture(std::optional<std::array<DataType, NumChannels>> const& FillWithValue);
 
-	/// Mark the texture for future update (should be called whenever we modify a pixel in TextureData...)
-	void InvalidateTexture() { bNeedUpdate = true; }
+	/// Mark the texture for future update (should be called whenever we modify pixels in TextureData...)
+	void InvalidateTexture() { DirtyRegions.MarkAll(); }
+	/// Mark a single pixel for future update
+	void InvalidatePixel(uint32 const Pixel) { DirtyRegions.MarkPixel(Pixel); }
 
 	/// Returns whether the texture can be attached to a material instance: one can update material(s) with
 	/// our texture only if the latter has been completely updated at least once.
@@ -123,8 +123,8 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixelsAlpha(
 	for (auto&& Pixel : Pixels)
 	{
 		TextureData[Pixel.value() * NumChannels + Channel] = Value;
+		InvalidatePixel(Pixel.value());
 	}
-	InvalidateTexture();
 }
 
 template<typename DataType, int NumChannels>
@@ -144,8 +144,8 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixelsExceptAlpha(
 				TextureData[Pixel.value() * NumChannels + c] = Value[c];
 			}
 		}
+		InvalidatePixel(Pixel.value());
 	}
-	InvalidateTexture();
 }
 
 template<typename DataType, int NumChannels>
@@ -157,9 +157,8 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixels(
 		return;
 	for (auto&& Pixel : Pixels)
 	{
-		SetPixel(Pixel, Value);
+		SetPixel(Pixel, Value); // invalidates the pixel
 	}
-	InvalidateTexture();
 }
 
 template<typename DataType, int NumChannels>
@@ -172,7 +171,6 @@ void FITwinDynamicShadingProperty<DataType, NumChannels>::SetPixels(
 		return;
 	for (auto&& Pixel : Pixels)
 	{
-		SetPixel(Pixel, Value, Mask);
+		SetPixel(Pixel, Value, Mask); // invalidates the pixel
 	}
-	InvalidateTexture();
 }
@@ -38,9 +38,11 @@
 #include <Cesium3DTilesetLoadFailureDetails.h>
 #include <CesiumFeaturesMetadataComponent.h>
 #include <CesiumWgs84Ellipsoid.h>
+#include <Network/ElementsMetadataSnapshot.h>
 #include <Network/JsonQueriesCache.h>
 #include <Timeline/Timeline.h>
 
+#include <Async/Async.h>
 #include <Components/DirectionalLightComponent.h>
 #include <Components/LightComponent.h>
 #include <Components/StaticMeshComponent.h>
@@ -64,6 +66,7 @@
 #include <Misc/EngineVersionComparison.h>
 #include <Serialization/JsonReader.h>
 #include <Serialization/JsonSerializer.h>
+#include <Tasks/Task.h>
 #include <TimerManager.h>
 #include <UObject/ConstructorHelpers.h>
 #include <UObject/StrongObjectPtr.h>
@@ -80,9 +83,12 @@
 #	include <Core/Tools/DelayedCall.h>
 #include <Compil/AfterNonUnrealIncludes.h>
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <optional>
 #include <unordered_set>
+#include <variant>
 
 
 namespace ITwin
@@ -627,18 +633,25 @@ public:
 	/// Used to query info about all Elements of the iModel by reading rows from its database tables through
 	/// a paginated series of HTTP RPC requests. We use a single instance for the bulk of the needed metadata
 	/// combined in a single ECSQL query (parent-child relationships, bounding boxes, Federation GUIDs and
-	/// Source Element IDs) and another instance to (concurrently) get the Construction Detailing Elements parent IDs.
+	/// Source Element IDs), followed by a (much smaller) query for the Construction Detailing Elements
+	/// parent IDs.
+	/// Once the number of rows is known, several pages are requested (or read from the cache) concurrently,
+	/// and parsed on worker threads. Parsed pages are then applied to the scene mapping in the game thread,
+	/// in order, so that Elements are always indexed the same. The final result is saved as a binary
+	/// snapshot in the cache folder (specific to the changeset), which later sessions load in one go.
 	class FQueryElementMetadataPageByPage
 	{
 	public:
 		enum class EState {
-			NotStarted, Running, NeedRestart, Finished, StoppedOnError, Cancelled
+			NotStarted, Running, Finished, StoppedOnError, Cancelled
 		};
 		static constexpr double MetadataRatioInTotalProgress = 0.5;
 
 		void Cancel()
 		{
 			ITwinHttp::FLock Lock(Mutex);
+			if (EState::Running == State)
+				UE_LOG(LogITwin, Display, TEXT("%s: queries cancelled."), *BatchMsg);
 			State = EState::Cancelled;
 		}
 
@@ -648,7 +661,6 @@ public:
 			switch (State)
 			{
 			case EState::NotStarted:
-			case EState::NeedRestart:
 				return 0.;
 			case EState::Finished:
 				return 100.;
@@ -659,43 +671,94 @@ public:
 			}
 			if (TotalRowsExpected > 0)
 			{
-				if (bQueryingConstructionDetailingParentIDs)
+				if (EPhase::ConstructionDetailing == Phase)
 					return 96.;
-				// Hack, the rest is for bQueryingConstructionDetailingParentIDs which progress is not handled
-				return 0.96 * std::min(100., (100. * QueryRowStart) / TotalRowsExpected);
+				// Hack, the rest is for the Construction Detailing phase which progress is not handled
+				return 0.96 * std::min(100., (100. * NextPageToApply * QueryRowCount) / TotalRowsExpected);
 			}
 			else
 				return 0.;
 		}
 
 	private:
+		enum class EPhase {
+			/// Single "page" with the number of Elements, to know how many pages to request concurrently
+			TableCount,
+			Metadata,
+			ConstructionDetailing
+		};
+		/// Content of a page parsed on a worker thread, to be applied in the game thread
+		struct FParsedPage
+		{
+			/// Number of rows received, used to detect the last page
+			int NumRows = 0;
+			std::optional<int> TableCount;
+			std::vector<FITwinElementMetadata> Metadata;
+			/// Encoded for the snapshot (see QueriesCache::FElementsMetadataSnapshot), only when it will be saved
+			TArray<uint8> EncodedMetadata;
+			std::vector<ITwinElementID> ElementIDs;
+		};
+		struct FPage
+		{
+			AdvViz::SDK::ITwinAPIRequestInfo const* RequestInfo = nullptr;
+			std::optional<FParsedPage> Parsed;
+		};
+		struct FPendingRequest
+		{
+			uint32 Generation = 0;
+			int Page = 0;
+		};
+		using FReply = std::variant<QueriesCache::FCacheHit, FString>;
+
 		AITwinIModel& Owner;
 		EElementsMetadata const KindOfMetadata;
 		FString ECSQLQueryString;
 		FString const ECSQLQueryCount;
 		FString const BatchMsg;
-		std::optional<AdvViz::SDK::ITwinAPIRequestInfo> RequestInfo;
 		FString LastCacheFolderUsed;
+		/// Path of the snapshot to load or save, empty when the cache is not used.
+		FString SnapshotPath;
 		FJsonQueriesCache Cache;
+		QueriesCache::FElementsMetadataSnapshot Snapshot;
 		mutable ITwinHttp::FMutex Mutex;
 
 		EState State = EState::NotStarted;
-		int QueryRowStart = 0, TotalRowsParsed = 0, TotalRowsExpected = -1;
-		/// Temp hack to avoid too many conflicts with Laurent's optimization branch: NOT querying concurrently,
-		/// and NOT handling progression feedback either...
-		bool bQueryingConstructionDetailingParentIDs = false;
+		EPhase Phase = EPhase::TableCount;
+		int TotalRowsParsed = 0, TotalRowsExpected = -1;
 		bool bIgnoreMissingConstructionDetailingECClass = false;
-		HttpRequestID CurrentRequestID;
+		/// Incremented upon each restart, to ignore the replies and parsed pages of previous queries.
+		uint32 Generation = 0;
+		/// Pages of the current phase not yet applied, by index.
+		std::map<int, FPage> Pages;
+		int NextPageToRequest = 0, NextPageToApply = 0, NumPagesToRequest = 0;
+		/// Emitted requests, protected by Mutex (request IDs may be notified from another thread).
+		TMap<HttpRequestID, FPendingRequest> PendingRequests;
+		/// Never shrinks until the queries are finished, because the web services keep a pointer to the
+		/// request info until the request is actually emitted (which may happen after a restart).
+		std::deque<AdvViz::SDK::ITwinAPIRequestInfo> RequestInfos;
+		/// Parsing tasks use Cache: they must be completed before it is uninitialized.
+		TArray<UE::Tasks::FTask> ParsingTasks;
 		/// Down from 50K to 32K to accommodate bounding boxes, because server reply is capped to 8MB!
 		static constexpr int QueryRowCount = 32000;
+		/// Maximum number of pages requested or parsed but not yet applied: same budget as other paginated
+		/// queries (see SimultaneousRequestsAllowed in FITwinSchedulesImport), which also bounds the memory
+		/// used by the parsed pages waiting for previous ones.
+		static constexpr int SimultaneousRequestsAllowed = 6;
 
 		void DoRestart()
 		{
 			Owner.ScheduleDownloadPercentComplete = 0.;
-			QueryRowStart = TotalRowsParsed = 0;
+			TotalRowsParsed = 0;
 			TotalRowsExpected = -1;
-			ECSQLQueryString = GetCombinedMetadataQueryString();
-			bQueryingConstructionDetailingParentIDs = bIgnoreMissingConstructionDetailingECClass = false;
+			bIgnoreMissingConstructionDetailingECClass = false;
+			++Generation;
+			Pages.clear();
+			Snapshot.Reset();
+			SnapshotPath.Empty();
+			{
+				ITwinHttp::FLock Lock(Mutex);
+				State = EState::Running;
+			}
 			FString const CacheFolder = QueriesCache::GetCacheFolder(
 				QueriesCache::ESubtype::ElementsMetadataCombined,
 				Owner.ServerConnection->Environment, Owner.ITwinId, Owner.IModelId, Owner.ResolvedChangesetId);
@@ -708,7 +771,15 @@ public:
 				}
 				LastCacheFolderUsed = CacheFolder;
 			}
-			QueryNextPage();
+			if (Cache.IsValid())
+			{
+				SnapshotPath = FPaths::Combine(CacheFolder, QueriesCache::FElementsMetadataSnapshot::FileName);
+				LoadSnapshot();
+			}
+			else
+			{
+				StartQueries();
+			}
 		}
 
 		FString GetCombinedMetadataQueryString()
@@ -720,209 +791,368 @@ public:
 				+ TEXT(" LEFT JOIN bis.GeometricElement3d b ON b.ECInstanceId = e.ECInstanceId");
 		}
 
-	public:
-		FQueryElementMetadataPageByPage(AITwinIModel& InOwner, EElementsMetadata const InKindOfMetadata)
-			: Owner(InOwner)
-			, KindOfMetadata(InKindOfMetadata)
-			, ECSQLQueryString(GetCombinedMetadataQueryString())
-			, ECSQLQueryCount(TEXT("SELECT COUNT(*) FROM bis.Element"))
-			, BatchMsg(FString(TEXT("iModel Elements metadata for ")) + InOwner.GetActorNameOrLabel())
-			, Cache(InOwner)
+		/// Called on the game thread with the results of tasks posted in the given generation.
+		/// \return Whether the queries are still running in this generation.
+		bool IsStillRunning(uint32 const InGeneration) const
 		{
-			ensure(KindOfMetadata == EElementsMetadata::Combined);//only handling this case now
+			return InGeneration == Generation && EState::Running == GetState();
 		}
 
-		EState GetState() const
+		/// Calls a method on this instance in the game thread, unless the owner was destroyed in the meantime.
+		template<typename TFunc>
+		void CallOnGameThread(TFunc&& Func)
 		{
-			ITwinHttp::FLock Lock(Mutex);
-			return State;
+			AsyncTask(ENamedThreads::GameThread,
+				[OwnerPtr = TWeakObjectPtr<AITwinIModel>(&Owner), Func = std::forward<TFunc>(Func)]() mutable
+				{
+					if (OwnerPtr.IsValid() && OwnerPtr->Impl && OwnerPtr->Impl->ElementsMetadataQuerying)
+						Func(*OwnerPtr->Impl->ElementsMetadataQuerying);
+				});
 		}
 
-		void Restart()
+		template<typename TFunc>
+		void LaunchTask(TFunc&& Func)
 		{
-			if (EState::NotStarted == State || EState::Finished == State || EState::StoppedOnError == State)
-			{
-				UninitializeCache(); // reinit, we may have a new changesetId for example
-				UE_LOG(LogITwin, Display, TEXT("%s queries (re)starting..."), *BatchMsg);
-				DoRestart();
-			}
-			else
-			{
-				State = EState::NeedRestart;
-			}
+			ParsingTasks.RemoveAll([](UE::Tasks::FTask const& Task) { return Task.IsCompleted(); });
+			ParsingTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, std::forward<TFunc>(Func)));
 		}
 
-		void SetCurrentRequestID(HttpRequestID const& ReqID)
+		void WaitForParsingTasks()
 		{
-			ITwinHttp::FLock Lock(Mutex);
-			CurrentRequestID = ReqID;
+			UE::Tasks::Wait(ParsingTasks);
+			ParsingTasks.Empty();
 		}
 
-		bool TestIsCurrentRequestID(HttpRequestID const& ReqID) const
+		void LoadSnapshot()
 		{
-			ITwinHttp::FLock Lock(Mutex);
-			return (CurrentRequestID == ReqID);
+			LaunchTask([this, Path = SnapshotPath, InGeneration = Generation]
+			{
+				std::vector<FITwinElementMetadata> Metadata;
+				std::vector<ITwinElementID> ParentIDs;
+				bool const bLoaded = QueriesCache::FElementsMetadataSnapshot::Load(Path, Metadata, ParentIDs);
+				CallOnGameThread([InGeneration, bLoaded, Metadata = std::move(Metadata),
+								  ParentIDs = std::move(ParentIDs)](FQueryElementMetadataPageByPage& This)
+				{
+					This.OnSnapshotLoaded(InGeneration, bLoaded, Metadata, ParentIDs);
+				});
+			});
 		}
 
-		void QueryNextPage()
+		void OnSnapshotLoaded(uint32 const InGeneration, bool const bLoaded,
+			std::vector<FITwinElementMetadata> const& Metadata, std::vector<ITwinElementID> const& ParentIDs)
 		{
-			if (EState::Cancelled == State)
-			{
-				UE_LOG(LogITwin, Display, TEXT("%s: queries cancelled."), *BatchMsg);
+			if (!IsStillRunning(InGeneration))
 				return;
-			}
-			State = EState::Running;
-			RequestInfo.emplace(Owner.WebServices->InfosToQueryIModel(
-				Owner.ITwinId, Owner.IModelId, Owner.ResolvedChangesetId,
-				(TotalRowsExpected == -1) ? ECSQLQueryCount : ECSQLQueryString, QueryRowStart, QueryRowCount));
-			if (TotalRowsExpected != -1)
-				QueryRowStart += QueryRowCount;
-			auto const Hit = Cache.IsValid() ? Cache.LookUp(*RequestInfo, Mutex) : std::nullopt;
-			if (Hit)
+			if (!bLoaded)
 			{
-				SetCurrentRequestID({});
-				OnQueryCompleted({}, true, Cache.Read(*Hit));
-				// Now just return, ie read only one response per tick even if everything's in the cache.
-				// The alternative, while still not blocking the game thread, would be to use a worker thread,
-				// but there is no synchronization mechanism on SceneMapping to allow that yet.
-			}
-			else
-			{
-				AdvViz::SDK::FilterErrorFunc funcIgnoreMissingConstructionDetailing;
-				if (bQueryingConstructionDetailingParentIDs)
-				{
-					funcIgnoreMissingConstructionDetailing =
-						[this](long/*statusCode*/, std::string const& requestError, bool& bAllowRetry, bool& bLogError)
-					{
-						if (requestError.find("ECClass 'Construction.ConstructionDetailingElementSplitsGeometricElement3d' does not exist")
-							!= std::string::npos)
-						{
-							bAllowRetry = false;
-							bLogError = false;
-							// Flag the error to be ignored in OnQueryCompleted so that finalization can happen
-							// and 4D actually become available!
-							bIgnoreMissingConstructionDetailingECClass = true;
-						}
-					};
-				}
-				Owner.WebServices->QueryIModelRows({}, {}, {}, {}, 0, 0, // everything's in RequestInfo
-					std::bind(&FQueryElementMetadataPageByPage::SetCurrentRequestID, this,
-							  std::placeholders::_1),
-					&(*RequestInfo), std::move(funcIgnoreMissingConstructionDetailing));
+				StartQueries();
+				return;
 			}
+			auto& SceneMapping = GetInternals(Owner).SceneMapping;
+			TotalRowsExpected = (int)Metadata.size();
+			SceneMapping.ReserveIModelMetadata(TotalRowsExpected);
+			TotalRowsParsed = SceneMapping.ApplyIModelMetadata(Metadata);
+			SceneMapping.ApplyConstructionDetailingParentIDs(ParentIDs);
+			UE_LOG(LogITwin, Display, TEXT("%s: total loaded from snapshot: %d."), *BatchMsg, TotalRowsParsed);
+			Finish(/*bSaveSnapshot*/false);
 		}
 
-		/// \return Whether the reply was to a request emitted by this instance of metadata requester, and was
-		///			thus parsed here.
-		bool OnQueryCompleted(HttpRequestID const& RequestID, bool const bSuccess,
-			std::variant<FString, TSharedPtr<FJsonObject>> const& QueryResult)
+		void StartQueries()
 		{
-			bool const bFromCache = (QueryResult.index() == 1);
-			if (!bFromCache && !TestIsCurrentRequestID(RequestID))
+			if (Cache.IsValid())
 			{
-				return false; // we didn't emit this request
+				// All pages share the same url: get them in memory before they are read
+				Cache.Preload(Owner.WebServices->InfosToQueryIModel(Owner.ITwinId, Owner.IModelId,
+					Owner.ResolvedChangesetId, ECSQLQueryString, 0, QueryRowCount));
 			}
-			if (EState::Cancelled == State)
+			StartPhase(EPhase::TableCount, 1);
+		}
+
+		void StartPhase(EPhase const InPhase, int const NumPages)
+		{
+			Phase = InPhase;
+			if (EPhase::ConstructionDetailing == Phase)
 			{
-				UE_LOG(LogITwin, Display, TEXT("%s: queries cancelled."), *BatchMsg);
-				return true;
+				// Instead of "SELECT DISTINCT TargetECInstanceId FROM ..." to get only a list of unique IDs for
+				// the parents, we could use "GROUP BY" if we wanted to get also the ECInstanceId of any child of
+				// each TargetECInstanceId, for example
+				ECSQLQueryString = FString(TEXT("SELECT DISTINCT TargetECInstanceId"))
+					+ TEXT(" FROM Construction.ConstructionDetailingElementSplitsGeometricElement3d");
 			}
-			if (EState::NeedRestart == State)
+			else
 			{
-				UE_LOG(LogITwin, Display, TEXT("%s: queries interrupted, will restart..."), *BatchMsg);
-				DoRestart();
-				return true;
+				ECSQLQueryString = GetCombinedMetadataQueryString();
 			}
-			if (!bSuccess && !bIgnoreMissingConstructionDetailingECClass)
+			Pages.clear();
+			NextPageToRequest = NextPageToApply = 0;
+			NumPagesToRequest = NumPages;
+			RequestPages();
+		}
+
+		void RequestPages()
+		{
+			while (NextPageToRequest < NumPagesToRequest
+				&& (NextPageToRequest - NextPageToApply) < SimultaneousRequestsAllowed
+				&& IsStillRunning(Generation))
 			{
-				State = EState::StoppedOnError;
-				return true;
+				RequestPage(NextPageToRequest++);
 			}
-			int RowsParsed = 0;
-			bool bHasReceivedTableCount = false;
-			TSharedPtr<FJsonObject> JsonObj;
-			if (bFromCache)
+		}
+
+		void RequestPage(int const PageIdx)
+		{
+			FPage& Page = Pages[PageIdx];
+			Page.RequestInfo = &RequestInfos.emplace_back(Owner.WebServices->InfosToQueryIModel(
+				Owner.ITwinId, Owner.IModelId, Owner.ResolvedChangesetId,
+				(EPhase::TableCount == Phase) ? ECSQLQueryCount : ECSQLQueryString, PageIdx * QueryRowCount,
+				QueryRowCount));
+			auto const Hit = Cache.IsValid() ? Cache.LookUp(*Page.RequestInfo, Mutex) : std::nullopt;
+			if (Hit)
 			{
-				JsonObj = std::get<1>(QueryResult);
+				ParsePage(PageIdx, *Hit);
+				return;
 			}
-			else
+			AdvViz::SDK::FilterErrorFunc funcIgnoreMissingConstructionDetailing;
+			if (EPhase::ConstructionDetailing == Phase)
 			{
-				if (Cache.IsValid())
-					Cache.Write(*RequestInfo, std::get<0>(QueryResult), true, Mutex);
-				auto Reader = TJsonReaderFactory<TCHAR>::Create(std::get<0>(QueryResult));
-				if (!FJsonSerializer::Deserialize(Reader, JsonObj))
-					JsonObj.Reset();
+				funcIgnoreMissingConstructionDetailing =
+					[this](long/*statusCode*/, std::string const& requestError, bool& bAllowRetry, bool& bLogError)
+				{
+					if (requestError.find("ECClass 'Construction.ConstructionDetailingElementSplitsGeometricElement3d' does not exist")
+						!= std::string::npos)
+					{
+						bAllowRetry = false;
+						bLogError = false;
+						// Flag the error to be ignored in OnQueryCompleted so that finalization can happen
+						// and 4D actually become available!
+						bIgnoreMissingConstructionDetailingECClass = true;
+					}
+				};
 			}
-			auto& IModelInternals = GetInternals(Owner);
-			if (JsonObj.IsValid())
+			Owner.WebServices->QueryIModelRows({}, {}, {}, {}, 0, 0, // everything's in RequestInfo
+				[this, Pending = FPendingRequest{ Generation, PageIdx }](HttpRequestID const& RequestID)
+				{
+					ITwinHttp::FLock Lock(Mutex);
+					PendingRequests.Add(RequestID, Pending);
+				},
+				Page.RequestInfo, std::move(funcIgnoreMissingConstructionDetailing));
+		}
+
+		/// Reads and parses the reply on a worker thread, then hands the result over to the game thread.
+		void ParsePage(int const PageIdx, FReply&& Reply)
+		{
+			EPhase const ParsedPhase = Phase;
+			bool const bEncodeForSnapshot = !SnapshotPath.IsEmpty();
+			LaunchTask([this, PageIdx, ParsedPhase, bEncodeForSnapshot, InGeneration = Generation,
+						Reply = std::move(Reply)]
 			{
+				TSharedPtr<FJsonObject> JsonObj;
+				if (Reply.index() == 0)
+				{
+					JsonObj = Cache.Read(std::get<0>(Reply));
+				}
+				else
+				{
+					auto Reader = TJsonReaderFactory<TCHAR>::Create(std::get<1>(Reply));
+					if (!FJsonSerializer::Deserialize(Reader, JsonObj))
+						JsonObj.Reset();
+				}
+				FParsedPage Parsed;
 				TArray<TSharedPtr<FJsonValue>> const* JsonRows = nullptr;
-				if (JsonObj->TryGetArrayField(TEXT("data"), JsonRows))
+				if (JsonObj.IsValid() && JsonObj->TryGetArrayField(TEXT("data"), JsonRows))
 				{
-					if (TotalRowsExpected == -1)
+					Parsed.NumRows = JsonRows->Num();
+					switch (ParsedPhase)
 					{
+					case EPhase::TableCount:
 						if (ensure(JsonRows->Num() == 1))
 						{
 							auto const& Entries = (*JsonRows)[0]->AsArray();
-							if (ensure(!Entries.IsEmpty() && Entries[0]->TryGetNumber(TotalRowsExpected)))
-							{
-								bHasReceivedTableCount = true;
-								if (TotalRowsExpected > 0)
-									IModelInternals.SceneMapping.ReserveIModelMetadata(TotalRowsExpected);
-							}
+							int TableCount = 0;
+							if (ensure(!Entries.IsEmpty() && Entries[0]->TryGetNumber(TableCount)))
+								Parsed.TableCount = TableCount;
 						}
+						break;
+					case EPhase::Metadata:
+						FITwinSceneMapping::ExtractIModelMetadata(*JsonRows, Parsed.Metadata);
+						if (bEncodeForSnapshot)
+							QueriesCache::FElementsMetadataSnapshot::EncodeMetadata(Parsed.Metadata,
+																					 Parsed.EncodedMetadata);
+						break;
+					case EPhase::ConstructionDetailing:
+						FITwinSceneMapping::ExtractElementIDs(*JsonRows, Parsed.ElementIDs);
+						break;
 					}
-					else if (!bQueryingConstructionDetailingParentIDs)
+				}
+				CallOnGameThread([InGeneration, PageIdx, Parsed = std::move(Parsed)]
+					(FQueryElementMetadataPageByPage& This) mutable
+				{
+					This.OnPageParsed(InGeneration, PageIdx, std::move(Parsed));
+				});
+			});
+		}
+
+		void OnPageParsed(uint32 const InGeneration, int const PageIdx, FParsedPage&& Parsed)
+		{
+			if (!IsStillRunning(InGeneration))
+				return;
+			auto const Found = Pages.find(PageIdx);
+			if (!ensure(Found != Pages.end()))
+				return;
+			Found->second.Parsed.emplace(std::move(Parsed));
+			ApplyParsedPages();
+		}
+
+		/// Applies the parsed pages following the last page applied, then requests more pages, or starts
+		/// the next phase when all pages were applied.
+		void ApplyParsedPages()
+		{
+			auto& SceneMapping = GetInternals(Owner).SceneMapping;
+			for (auto It = Pages.find(NextPageToApply); It != Pages.end() && It->second.Parsed;
+				 It = Pages.find(NextPageToApply))
+			{
+				FParsedPage const& Parsed = *It->second.Parsed;
+				switch (Phase)
+				{
+				case EPhase::TableCount:
+					if (Parsed.TableCount)
 					{
-						RowsParsed = IModelInternals.SceneMapping.ParseIModelMetadata(*JsonRows);
-						TotalRowsParsed += RowsParsed;
+						TotalRowsExpected = *Parsed.TableCount;
+						if (TotalRowsExpected > 0)
+							SceneMapping.ReserveIModelMetadata(TotalRowsExpected);
+						UE_LOG(LogITwin, Display, TEXT("%s: table count retrieved: %d..."), *BatchMsg,
+							TotalRowsExpected);
+						StartPhase(EPhase::Metadata,
+							std::max(1, (TotalRowsExpected + QueryRowCount - 1) / QueryRowCount));
 					}
 					else
 					{
-						RowsParsed = IModelInternals.SceneMapping.ParseConstructionDetailingParentIDs(*JsonRows);
+						StartPhase(EPhase::ConstructionDetailing, 1);
 					}
+					return;
+				case EPhase::Metadata:
+					TotalRowsParsed += SceneMapping.ApplyIModelMetadata(Parsed.Metadata);
+					Snapshot.AppendMetadata(Parsed.EncodedMetadata, (int32)Parsed.Metadata.size());
+					break;
+				case EPhase::ConstructionDetailing:
+					SceneMapping.ApplyConstructionDetailingParentIDs(Parsed.ElementIDs);
+					Snapshot.AppendConstructionDetailingParentIDs(Parsed.ElementIDs);
+					break;
 				}
+				// The table count is only a hint (our query generates duplicates in some iModels), the last
+				// page is the first one which is not full
+				if (Parsed.NumRows >= QueryRowCount && NextPageToApply + 1 == NumPagesToRequest)
+					++NumPagesToRequest;
+				Pages.erase(It);
+				++NextPageToApply;
 			}
-			if (RowsParsed > 0 || bHasReceivedTableCount)
+			if (NextPageToApply < NumPagesToRequest)
 			{
-				if (bHasReceivedTableCount)
+				if (EPhase::Metadata == Phase)
 				{
-					UE_LOG(LogITwin, Display, TEXT("%s: table count retrieved from %s: %d..."), *BatchMsg,
-						bFromCache ? TEXT("cache") : TEXT("remote"), TotalRowsExpected);
+					UE_LOG(LogITwin, Verbose, TEXT("%s: retrieved %d, asking for more..."), *BatchMsg,
+						TotalRowsParsed);
+					Owner.Impl->UpdateIModel4DLoadProgress();
 				}
-				else
-				{
-					UE_LOG(LogITwin, Verbose, TEXT("%s: retrieved from %s: %d, asking for more..."), *BatchMsg,
-						bFromCache ? TEXT("cache") : TEXT("remote"), TotalRowsParsed);
-					if (TotalRowsExpected != -1)
-					{
-						Owner.Impl->UpdateIModel4DLoadProgress();
-					}
-				}
-				QueryNextPage();
+				RequestPages();
 			}
-			else if (!bQueryingConstructionDetailingParentIDs)
+			else if (EPhase::Metadata == Phase)
 			{
-				bQueryingConstructionDetailingParentIDs = true;
-				QueryRowStart = 0;
-				// Instead of "SELECT DISTINCT TargetECInstanceId FROM ..." to get only a list of unique IDs for the
-				// parents, we could use "GROUP BY" if we wanted to get also the ECInstanceId of any child of each
-				// TargetECInstanceId, for example
-				ECSQLQueryString = FString(TEXT("SELECT DISTINCT TargetECInstanceId"))
-					+ TEXT(" FROM Construction.ConstructionDetailingElementSplitsGeometricElement3d");
-				QueryNextPage();
+				StartPhase(EPhase::ConstructionDetailing, 1);
 			}
 			else
 			{
-				UE_LOG(LogITwin, Display, TEXT("%s: total retrieved from %s: %d."), *BatchMsg,
-					/*likely all retrieved from same source...*/bFromCache ? TEXT("cache") : TEXT("remote"),
-					TotalRowsParsed);
-				// This call will release hold of the cache folder, which will "often" allow reuse by cloned
-				// actor when entering PIE (unless it was not yet finished downloading, of course)
-				UninitializeCache();
-				IModelInternals.SceneMapping.FinishedParsingIModelMetadata();
-				State = EState::Finished;
+				UE_LOG(LogITwin, Display, TEXT("%s: total retrieved: %d."), *BatchMsg, TotalRowsParsed);
+				Finish(/*bSaveSnapshot*/true);
+			}
+		}
+
+		void Finish(bool const bSaveSnapshot)
+		{
+			if (bSaveSnapshot && !SnapshotPath.IsEmpty())
+			{
+				UE::Tasks::Launch(UE_SOURCE_LOCATION,
+					[Path = SnapshotPath, ToSave = MakeShared<QueriesCache::FElementsMetadataSnapshot>(
+						std::move(Snapshot))]
+					{
+						ToSave->Save(Path);
+					});
+			}
+			Snapshot.Reset();
+			RequestInfos.clear();
+			// This call will release hold of the cache folder, which will "often" allow reuse by cloned
+			// actor when entering PIE (unless it was not yet finished downloading, of course)
+			UninitializeCache();
+			GetInternals(Owner).SceneMapping.FinishedParsingIModelMetadata();
+			ITwinHttp::FLock Lock(Mutex);
+			State = EState::Finished;
+		}
+
+	public:
+		FQueryElementMetadataPageByPage(AITwinIModel& InOwner, EElementsMetadata const InKindOfMetadata)
+			: Owner(InOwner)
+			, KindOfMetadata(InKindOfMetadata)
+			, ECSQLQueryString(GetCombinedMetadataQueryString())
+			, ECSQLQueryCount(TEXT("SELECT COUNT(*) FROM bis.Element"))
+			, BatchMsg(FString(TEXT("iModel Elements metadata for ")) + InOwner.GetActorNameOrLabel())
+			, Cache(InOwner)
+		{
+			ensure(KindOfMetadata == EElementsMetadata::Combined);//only handling this case now
+		}
+
+		~FQueryElementMetadataPageByPage()
+		{
+			WaitForParsingTasks();
+		}
+
+		EState GetState() const
+		{
+			ITwinHttp::FLock Lock(Mutex);
+			return State;
+		}
+
+		/// Replies and parsed pages of the queries currently running, if any, will be ignored.
+		void Restart()
+		{
+			WaitForParsingTasks();
+			UninitializeCache(); // reinit, we may have a new changesetId for example
+			UE_LOG(LogITwin, Display, TEXT("%s queries (re)starting..."), *BatchMsg);
+			DoRestart();
+		}
+
+		/// \return Whether the reply was to a request emitted by this instance of metadata requester, and was
+		///			thus handled here.
+		bool OnQueryCompleted(HttpRequestID const& RequestID, bool const bSuccess, FString const& QueryResult)
+		{
+			FPendingRequest Pending;
+			{
+				ITwinHttp::FLock Lock(Mutex);
+				if (!PendingRequests.RemoveAndCopyValue(RequestID, Pending))
+					return false; // we didn't emit this request
+			}
+			if (!IsStillRunning(Pending.Generation))
+				return true;
+			auto const Found = Pages.find(Pending.Page);
+			if (!ensure(Found != Pages.end()))
+				return true;
+			if (!bSuccess)
+			{
+				if (bIgnoreMissingConstructionDetailingECClass)
+				{
+					// Same as an empty reply
+					Found->second.Parsed.emplace();
+					ApplyParsedPages();
+				}
+				else
+				{
+					ITwinHttp::FLock Lock(Mutex);
+					State = EState::StoppedOnError;
+				}
+				return true;
 			}
+			if (Cache.IsValid())
+				Cache.Write(*Found->second.RequestInfo, QueryResult, true, Mutex);
+			ParsePage(Pending.Page, QueryResult);
 			return true;
 		}
 
@@ -934,6 +1164,7 @@ public:
 
 		void OnIModelUninit()
 		{
+			WaitForParsingTasks();
 			UninitializeCache();
 		}
 
@@ -31,4 +31,6 @@ void FITwinRuntimeModule::ShutdownModule()
 	FITwinStyle::Shutdown();
 
 	Super::ShutdownModule();
+
+	FITwinStartup::CommonShutdown();
 }
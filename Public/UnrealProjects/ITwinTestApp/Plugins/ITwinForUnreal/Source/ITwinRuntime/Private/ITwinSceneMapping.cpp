@@ -641,11 +641,12 @@ bool FITwinSceneMapping::ParseElementBBox(TSharedPtr<FJsonValue> const& BBoxLow,
 	return true;
 }
 
-int FITwinSceneMapping::ParseIModelMetadata(TArray<TSharedPtr<FJsonValue>> const& JsonRows)
+/*static*/
+int FITwinSceneMapping::ExtractIModelMetadata(TArray<TSharedPtr<FJsonValue>> const& JsonRows,
+											  std::vector<FITwinElementMetadata>& OutMetadata)
 {
 	int GoodSrcIDs = 0, GoodFedGUIDs = 0, EmptyFedGUIDs = 0, EmptySrcIDs = 0, NoBBoxElems = 0;
-	auto& GuidMap = FederatedElementGUIDs.get<IndexByGUID>();
-	auto& SourceIdMap = SourceElementIDs.get<IndexBySourceID>();
+	OutMetadata.reserve(OutMetadata.size() + (size_t)JsonRows.Num());
 	int i = 0;
 	for (auto const& Row : JsonRows)
 	{
@@ -656,33 +657,63 @@ int FITwinSceneMapping::ParseIModelMetadata(TArray<TSharedPtr<FJsonValue>> const
 		if (!ensure(ITwin::NOT_ELEMENT != ElemId))
 			continue;
 		++i;
-		ITwinScene::ElemIdx InVec = ITwinScene::NOT_ELEM;
-		FITwinElement& Elem = ElementForSLOW(ElemId, &InVec);
-		if (ITwinScene::NOT_ELEM != Elem.ParentInVec)
-			continue; // already known - our SQL query indeed generates duplicates in some iModels, why...?
-		if (Entries.Num() >= 3)
-			NoBBoxElems += (ParseElementBBox(Entries[1], Entries[2], Elem.BBox) ? 0 : 1);
+		FITwinElementMetadata& Metadata = OutMetadata.emplace_back();
+		Metadata.ElementID = ElemId;
+		FBox ElemBBox;
+		if (Entries.Num() >= 3 && ParseElementBBox(Entries[1], Entries[2], ElemBBox))
+			Metadata.BBox.emplace(ElemBBox);
 		else
 			++NoBBoxElems;
-		ITwinElementID const ParentId = (Entries.Num() < 4 || Entries[3]->IsNull())
+		Metadata.ParentID = (Entries.Num() < 4 || Entries[3]->IsNull())
 			? ITwin::NOT_ELEMENT : ITwin::ParseElementID(Entries[3]->AsString());
-		if (ITwin::NOT_ELEMENT != ParentId)
+		FGuid FedGuid;
+		if (Entries.Num() < 5)
+			++EmptyFedGUIDs;
+		else if (ParseSomeElementIdentifier<FGuid>(Entries[4], FedGuid, GoodFedGUIDs, EmptyFedGUIDs))
+			Metadata.FederationGuid.emplace(FedGuid);
+		if (Entries.Num() < 6)
+			++EmptySrcIDs;
+		else
+			ParseSomeElementIdentifier<FString>(Entries[5], Metadata.SourceElementID, GoodSrcIDs, EmptySrcIDs);
+	}
+	if (GoodFedGUIDs != JsonRows.Num() || GoodSrcIDs != JsonRows.Num() || NoBBoxElems != 0)
+	{
+		int const OtherErr = (2 * JsonRows.Num() - EmptyFedGUIDs - EmptySrcIDs) - GoodFedGUIDs - GoodSrcIDs;
+		UE_LOG(ITwinSceneMap, Display, TEXT("When parsing Element metadata: out of %d entries received, %d have no valid BBox, %d had no Federation GUID, %d had no Source Element ID%s"),
+			JsonRows.Num(), NoBBoxElems, EmptyFedGUIDs, EmptySrcIDs, OtherErr
+			? (*FString::Printf(
+				TEXT(", %d Federation GUIDs or Source Element IDs were incomplete or could not be parsed"),
+				OtherErr))
+			: TEXT(""));
+	}
+	return i;
+}
+
+int FITwinSceneMapping::ApplyIModelMetadata(std::vector<FITwinElementMetadata> const& Metadata)
+{
+	auto& GuidMap = FederatedElementGUIDs.get<IndexByGUID>();
+	auto& SourceIdMap = SourceElementIDs.get<IndexBySourceID>();
+	for (auto const& Row : Metadata)
+	{
+		ITwinScene::ElemIdx InVec = ITwinScene::NOT_ELEM;
+		FITwinElement& Elem = ElementForSLOW(Row.ElementID, &InVec);
+		if (ITwinScene::NOT_ELEM != Elem.ParentInVec)
+			continue; // already known - our SQL query indeed generates duplicates in some iModels, why...?
+		if (Row.BBox)
+			Elem.BBox = *Row.BBox;
+		if (ITwin::NOT_ELEMENT != Row.ParentID)
 		{
-			FITwinElement& ParentElem = ElementForSLOW(ParentId, &Elem.ParentInVec);
+			FITwinElement& ParentElem = ElementForSLOW(Row.ParentID, &Elem.ParentInVec);
 			// TODO_GCO: optimize with a first loop that creates all ParentElem and counts their children,
 			// exploiting the fact that children of the same parent "seem" to be contiguous (but let's not
 			// assume it's always the case...), then a second loop that reserves the SubElems vectors and
 			// fills them
 			ParentElem.SubElemsInVec.push_back(InVec);
 		}
-		if (Entries.Num() >= 5)
-			ParseSomeElementIdentifier<FGuid>(GuidMap, InVec, Entries[4], GoodFedGUIDs, EmptyFedGUIDs);
-		else
-			++EmptyFedGUIDs;
-		if (Entries.Num() >= 6)
-			ParseSomeElementIdentifier<FString>(SourceIdMap, InVec, Entries[5], GoodSrcIDs, EmptySrcIDs);
-		else
-			++EmptySrcIDs;
+		if (Row.FederationGuid)
+			InsertSomeElementIdentifier(GuidMap, InVec, *Row.FederationGuid);
+		if (!Row.SourceElementID.IsEmpty())
+			InsertSomeElementIdentifier(SourceIdMap, InVec, Row.SourceElementID);
 	}
 	// check there is no loop in the parent-child graph, it would be fatal
 	size_t const Count = AllElements.size();
@@ -719,22 +750,13 @@ int FITwinSceneMapping::ParseIModelMetadata(TArray<TSharedPtr<FJsonValue>> const
 		BE_LOGE("ITwinAPI", "Loop found in iModel Elements hierarchy, it will be IGNORED!");
 		return 0;
 	}
-	if (GoodFedGUIDs != JsonRows.Num() || GoodSrcIDs != JsonRows.Num() || NoBBoxElems != 0)
-	{
-		int const OtherErr = (2 * JsonRows.Num() - EmptyFedGUIDs - EmptySrcIDs) - GoodFedGUIDs - GoodSrcIDs;
-		UE_LOG(ITwinSceneMap, Display, TEXT("When parsing Element metadata: out of %d entries received, %d have no valid BBox, %d had no Federation GUID, %d had no Source Element ID%s"),
-			JsonRows.Num(), NoBBoxElems, EmptyFedGUIDs, EmptySrcIDs, OtherErr
-			? (*FString::Printf(
-				TEXT(", %d Federation GUIDs or Source Element IDs were incomplete or could not be parsed"),
-				OtherErr))
-			: TEXT(""));
-	}
-	return i;
+	return (int)Metadata.size();
 }
 
-template<typename TSomeID, typename TMapByRank>
-bool FITwinSceneMapping::ParseSomeElementIdentifier(TMapByRank& OutIDMap, ITwinScene::ElemIdx const ElemIdx,
-	TSharedPtr<FJsonValue> const& Entry, int& GoodEntry, int& EmptyEntry)
+/*static*/
+template<typename TSomeID>
+bool FITwinSceneMapping::ParseSomeElementIdentifier(TSharedPtr<FJsonValue> const& Entry, TSomeID& OutID,
+	int& GoodEntry, int& EmptyEntry)
 {
 	FString SomeIdStr;
 	if (!Entry->TryGetString(SomeIdStr))
@@ -742,21 +764,28 @@ bool FITwinSceneMapping::ParseSomeElementIdentifier(TMapByRank& OutIDMap, ITwinS
 	if (SomeIdStr.IsEmpty())
 	{
 		++EmptyEntry;
-		return true;
+		return false;
 	}
-	TSomeID SomeID;
 	if constexpr (std::is_same<TSomeID, FGuid>())
 	{
 		if (SomeIdStr.Len() < 36
-			|| !FGuid::ParseExact(SomeIdStr, EGuidFormats::DigitsWithHyphensLower, SomeID))
+			|| !FGuid::ParseExact(SomeIdStr, EGuidFormats::DigitsWithHyphensLower, OutID))
 		{
 			return false;
 		}
 	}
 	else
 	{
-		std::swap(SomeID, SomeIdStr);
+		std::swap(OutID, SomeIdStr);
 	}
+	++GoodEntry;
+	return true;
+}
+
+template<typename TSomeID, typename TMapByRank>
+void FITwinSceneMapping::InsertSomeElementIdentifier(TMapByRank& OutIDMap, ITwinScene::ElemIdx const ElemIdx,
+													 TSomeID const& SomeID)
+{
 	auto SourceEntry = OutIDMap.emplace(typename TMapByRank::value_type{ ElemIdx, SomeID });
 	if (SourceEntry.second)
 	{
@@ -779,14 +808,13 @@ bool FITwinSceneMapping::ParseSomeElementIdentifier(TMapByRank& OutIDMap, ITwinS
 		}
 		ElementFor(ElemIdx).DuplicatesList = FirstSourceElem.DuplicatesList;
 	}
-	++GoodEntry;
-	return true;
 }
 
-int FITwinSceneMapping::ParseConstructionDetailingParentIDs(TArray<TSharedPtr<FJsonValue>> const& JsonRows)
+/*static*/
+void FITwinSceneMapping::ExtractElementIDs(TArray<TSharedPtr<FJsonValue>> const& JsonRows,
+										   std::vector<ITwinElementID>& OutIDs)
 {
-	int i = 0;
-	ConstructionDetailingParentsToHide.reserve(ConstructionDetailingParentsToHide.size() + (size_t)JsonRows.Num());
+	OutIDs.reserve(OutIDs.size() + (size_t)JsonRows.Num());
 	for (auto const& Row : JsonRows)
 	{
 		auto const& Entries = Row->AsArray();
@@ -795,12 +823,19 @@ int FITwinSceneMapping::ParseConstructionDetailingParentIDs(TArray<TSharedPtr<FJ
 		ITwinElementID const ElemId = ITwin::ParseElementID(Entries[0]->AsString());
 		if (!ensure(ITwin::NOT_ELEMENT != ElemId))
 			continue;
-		++i;
+		OutIDs.push_back(ElemId);
+	}
+}
+
+void FITwinSceneMapping::ApplyConstructionDetailingParentIDs(std::vector<ITwinElementID> const& ParentIDs)
+{
+	ConstructionDetailingParentsToHide.reserve(ConstructionDetailingParentsToHide.size() + ParentIDs.size());
+	for (auto const ElemId : ParentIDs)
+	{
 		ITwinScene::ElemIdx InVec = ITwinScene::NOT_ELEM;
 		(void)ElementForSLOW(ElemId, &InVec);
 		ConstructionDetailingParentsToHide.push_back(InVec); // unique by design of the ECSQL query
 	}
-	return i;
 }
 
 FITwinSceneMapping::FDuplicateElementsVec const& FITwinSceneMapping::GetDuplicateElements(
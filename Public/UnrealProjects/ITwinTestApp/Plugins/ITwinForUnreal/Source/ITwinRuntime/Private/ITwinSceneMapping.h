@@ -750,6 +750,20 @@ public:
 	FSubElemsVec SubElemsInVec;
 };
 
+/// Metadata of an Element as read from a row of the combined ECSQL query of iModel Elements metadata.
+/// Extracted independently of the scene mapping (see FITwinSceneMapping::ExtractIModelMetadata) so that
+/// the rows can be parsed on worker threads, or loaded from a snapshot saved by a previous session.
+struct FITwinElementMetadata
+{
+	ITwinElementID ElementID = ITwin::NOT_ELEMENT;
+	ITwinElementID ParentID = ITwin::NOT_ELEMENT;
+	/// Only set when the row had a valid (ie. non-empty) bounding box
+	std::optional<FBox> BBox;
+	std::optional<FGuid> FederationGuid;
+	/// Empty when the row had none
+	FString SourceElementID;
+};
+
 /// Helper used to postpone texture updates at the end of its scope.
 struct [[nodiscard]] FITwinTextureUpdateDisabler
 {
@@ -925,8 +939,18 @@ public:
 	[[nodiscard]] bool FindGUIDForElement(ITwinElementID const Elem, FGuid& Found) const;
 	void ReserveIModelMetadata(int TotalElements);
 	void FinishedParsingIModelMetadata();
-	int ParseIModelMetadata(TArray<TSharedPtr<FJsonValue>> const& JsonRows);
-	int ParseConstructionDetailingParentIDs(TArray<TSharedPtr<FJsonValue>> const& JsonRows);
+	/// Reads the rows of the combined Elements metadata query, without modifying the scene mapping: can be
+	/// called from any thread.
+	/// \return Number of rows read with a valid ElementID
+	static int ExtractIModelMetadata(TArray<TSharedPtr<FJsonValue>> const& JsonRows,
+									 std::vector<FITwinElementMetadata>& OutMetadata);
+	/// Inserts Elements metadata obtained from ExtractIModelMetadata: for use in the game thread only.
+	/// \return Number of Elements processed, or zero in case of error in the parent-child relationships
+	int ApplyIModelMetadata(std::vector<FITwinElementMetadata> const& Metadata);
+	/// Reads the Element IDs from the first column of ECSQL rows: can be called from any thread.
+	static void ExtractElementIDs(TArray<TSharedPtr<FJsonValue>> const& JsonRows,
+								  std::vector<ITwinElementID>& OutIDs);
+	void ApplyConstructionDetailingParentIDs(std::vector<ITwinElementID> const& ParentIDs);
 	FDuplicateElementsVec const& GetDuplicateElements(ITwinElementID const ElemID) const;
 	std::vector<ITwinScene::ElemIdx> const& GetConstructionDetailingParentsToHide() const;
 	FString ToString() const;
@@ -1071,11 +1095,14 @@ public:
 		uint64_t ITwinMaterialID);
 
 private:
+	template<typename TSomeID>
+	static bool ParseSomeElementIdentifier(TSharedPtr<FJsonValue> const& Entry, TSomeID& OutID,
+		int& GoodEntry, int& EmptyEntry);
 	template<typename TSomeID, typename TMapByRank>
-	bool ParseSomeElementIdentifier(TMapByRank& OutIDMap, ITwinScene::ElemIdx const ElemIdx,
-		TSharedPtr<FJsonValue> const& Entry, int& GoodEntry, int& EmptyEntry);
-	bool ParseElementBBox(TSharedPtr<FJsonValue> const& BBoxLow, TSharedPtr<FJsonValue> const& BBoxHigh,
-						  FBox& ElemBBox);
+	void InsertSomeElementIdentifier(TMapByRank& OutIDMap, ITwinScene::ElemIdx const ElemIdx,
+									 TSomeID const& SomeID);
+	static bool ParseElementBBox(TSharedPtr<FJsonValue> const& BBoxLow, TSharedPtr<FJsonValue> const& BBoxHigh,
+								 FBox& ElemBBox);
 	void ApplySelectingAndHiding(FITwinSceneTile& SceneTile);
 
 	template<typename Container>
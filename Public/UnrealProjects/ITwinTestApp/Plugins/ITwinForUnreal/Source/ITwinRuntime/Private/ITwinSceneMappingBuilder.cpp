@@ -48,6 +48,7 @@
 #include <set>
 
 #include <Compil/BeforeNonUnrealIncludes.h>
+#	include <BeUtils/Gltf/ExtensionITwinFeatureRanges.h>
 #	include <BeUtils/Gltf/ExtensionITwinMaterial.h>
 #	include <BeUtils/Gltf/ExtensionITwinMaterialID.h>
 #	include <Core/ITwinAPI/ITwinMaterial.h>
@@ -299,15 +300,9 @@ void UITwinSceneMappingBuilder::OnTileMeshPrimitiveLoaded(ICesiumLoadedTilePrimi
 	FITwinElement* pElemStruct = &Dummy;
 	ITwinElementID LastElem = ITwin::NOT_ELEMENT;
 	ITwinFeatureID LastFeature = ITwin::NOT_FEATURE;
-	for (int64_t VtxIndex = VertexBegin; VtxIndex < VertexEnd; ++VtxIndex)
+	// Records a run of vertices sharing the same (valid) feature.
+	auto const AddFeatureVertices = [&](const int64 FeatureID)
 	{
-		const int64 FeatureID =
-			UCesiumFeatureIdSetBlueprintLibrary::GetFeatureIDForVertex(
-				FeatureIdSet,
-				static_cast<int64>(VtxIndex));
-		if (FeatureID < 0)
-			continue;
-
 		const ITwinFeatureID ITwinFeatID = ITwinFeatureID(FeatureID);
 		FITwinElementFeaturesInTile* pElemInTile = nullptr;
 		if (ITwinFeatID != LastFeature) // almost always the same => optimize
@@ -414,6 +409,33 @@ void UITwinSceneMappingBuilder::OnTileMeshPrimitiveLoaded(ICesiumLoadedTilePrimi
 			}
 			pElemStruct->bHasMesh = true;
 		}
+	};
+	// The GltfTuner precomputes the feature ranges in a worker thread: only the tiles it did not tune (or
+	// tuned with an older version) need reading the feature ID of each vertex here.
+	auto const* FeatureRangesExt = pMeshPrimitive->getExtension<BeUtils::ExtensionITwinFeatureRanges>();
+	if (FeatureRangesExt)
+	{
+		for (auto const& Range : FeatureRangesExt->ranges)
+		{
+			// Skirt vertices are not covered by the table, but let's not rely on that.
+			if (std::max<int64_t>(Range.firstVertex, VertexBegin)
+				< std::min<int64_t>(int64_t(Range.firstVertex) + Range.vertexCount, VertexEnd))
+			{
+				AddFeatureVertices(Range.featureId);
+			}
+		}
+	}
+	else
+	{
+		for (int64_t VtxIndex = VertexBegin; VtxIndex < VertexEnd; ++VtxIndex)
+		{
+			const int64 FeatureID =
+				UCesiumFeatureIdSetBlueprintLibrary::GetFeatureIDForVertex(
+					FeatureIdSet,
+					static_cast<int64>(VtxIndex));
+			if (FeatureID >= 0)
+				AddFeatureVertices(FeatureID);
+		}
 	}
 	if (IModel->Synchro4DSchedules)
 		GetInternals(*IModel->Synchro4DSchedules).OnNewTileMeshBuilt(TileRank, std::move(MeshElemSceneRanks));
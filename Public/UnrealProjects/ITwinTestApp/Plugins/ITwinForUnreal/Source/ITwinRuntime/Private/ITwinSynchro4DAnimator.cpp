@@ -71,8 +71,13 @@ class FITwinSynchro4DAnimator::FImpl
 	/// even though the animation is applied over several ticks (which means AnimationTime <= ScheduleTime)
 	double AnimationTime = 0;
 	/// Next timeline to process in ApplyAnimation so, when zero, it means the state of all timelines is
-	/// consistent with AnimationTime.
+	/// consistent with AnimationTime. When TimelinesToUpdate is set, this is an index in it, otherwise in the
+	/// timelines container.
 	size_t NextTimelineToUpdate = 0;
+	/// When only the time has changed since the animation was last applied, only the timelines whose time
+	/// range intersects the time increment need to be visited (see MainTimelineBase::GetTimelinesInTimeRange):
+	/// this contains their indices, for the whole update loop.
+	std::optional<std::vector<uint32_t>> TimelinesToUpdate;
 	/// Whether applying all timelines has touched at least one property texture
 	bool bHasUpdatedSomething = false;
 	/// We need to store the flag passed to ApplyAnimation so that the information persists over the several
@@ -557,12 +562,29 @@ void FITwinSynchro4DAnimator::FImpl::ApplyAnimation(bool const bForceUpdateAll)
 		if (ITwin::NOT_ELEMENT == (*DebugElem))
 			DebugElem.reset();
 	}
+	if (NextTimelineToUpdate == 0)
+	{
+		TimelinesToUpdate.reset();
+		// New or modified timelines must all be visited, whatever their time range (see ApplyTimeline), and
+		// the time index needs to account for their new ranges.
+		if (GetInternals(Owner.Owner).Timeline().TestNewOrModifiedAndResetFlag() || !Timeline.HasTimeIndex())
+		{
+			GetInternals(Owner.Owner).Timeline().FinalizeTimeIndex();
+		}
+		else if (TimeIncrement)
+		{
+			TimelinesToUpdate.emplace();
+			Timeline.GetTimelinesInTimeRange({ TimeIncrement->first, TimeIncrement->second }, *TimelinesToUpdate);
+		}
+	}
 	auto&& AllTimelines = Timeline.GetContainer();
 	size_t const FirstTimelineUpdated = NextTimelineToUpdate;
-	size_t const NumberOfTimelines = AllTimelines.size();
+	size_t const NumberOfTimelines = TimelinesToUpdate ? TimelinesToUpdate->size() : AllTimelines.size();
 	for ( ; NextTimelineToUpdate < NumberOfTimelines; ++NextTimelineToUpdate)
 	{
-		ApplyTimeline(*AllTimelines[NextTimelineToUpdate], TimeIncrement, {}, /*bOnlyVisibleTiles*/true);
+		size_t const TimelineIndex =
+			TimelinesToUpdate ? (*TimelinesToUpdate)[NextTimelineToUpdate] : NextTimelineToUpdate;
+		ApplyTimeline(*AllTimelines[TimelineIndex], TimeIncrement, {}, /*bOnlyVisibleTiles*/true);
 		if (FPlatformTime::Seconds() >= TimelineUpdateEnd)
 		{
 			++NextTimelineToUpdate;
@@ -65,6 +65,13 @@ namespace ITwin
 		TWeakObjectPtr<UMaterialInstanceDynamic> const* SupposedPreviousMaterial /*= nullptr*/);
 }
 
+struct FITwinIModelMaterialHandler::FPendingMaterialLoad
+{
+	AdvViz::SDK::TextureKeySet Textures;
+	bool bResolveLocalDiskTextures = false;
+	std::vector<std::pair<uint64_t, AdvViz::SDK::ITwinMaterial>> Materials;
+};
+
 
 FITwinIModelMaterialHandler::FITwinIModelMaterialHandler()
 {
@@ -355,7 +362,8 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 	if (!ensure(ITwin::IsMLMaterialPredictionEnabled()))
 		return;
 
-	BeUtils::WLock Lock(GltfMatHelper->GetMutex());
+	// The lock is released while textures are resolved (see below).
+	std::optional<BeUtils::WLock> Lock(std::in_place, GltfMatHelper->GetMutex());
 
 	if (!bSuccess || Prediction.data.empty())
 	{
@@ -387,6 +395,7 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 	MaterialMLPredictions.reserve(Prediction.data.size());
 
 	std::unordered_map<uint64_t, std::string> MatIDToName;
+	FPendingMaterialLoad PendingLoad;
 
 	// Reload/Save material customizations from/to a file in order to create a collection of materials for
 	// the predefined material categories (Wood, Steel, Aluminum etc.)
@@ -411,8 +420,8 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 		if (MatIOMngr->LoadMaterialCollection(MaterialDirectory / "materials.json",
 			IModelId, TextureUsageMap, MatIDToName) > 0)
 		{
-			// Resolve textures, if any.
-			GltfMatHelper->AppendTextureUsageMap(TextureUsageMap, Lock);
+			// Textures, if any, are resolved along with those of the materials loaded below.
+			GltfMatHelper->AppendTextureUsageMap(TextureUsageMap, *Lock);
 			AdvViz::SDK::PerIModelTextureSet const& perModelTextures =
 				MatIOMngr->GetDecorationTexturesByIModel();
 			auto itIModelTex = perModelTextures.find(IModelId);
@@ -420,15 +429,7 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 				itIModelTex != perModelTextures.end() && !itIModelTex->second.empty();
 			if (bHasLoadedTextures)
 			{
-				AdvViz::SDK::PerIModelTextureSet IModelTextures;
-				IModelTextures.emplace(IModelId, itIModelTex->second);
-
-				std::map<std::string, std::shared_ptr<BeUtils::GltfMaterialHelper>> IModelIdToMatHelper;
-				IModelIdToMatHelper.emplace(IModelId, GltfMatHelper);
-
-				ITwin::ResolveDecorationTextures(*MatIOMngr,
-					IModelTextures,
-					IModelIdToMatHelper, false, &Lock);
+				PendingLoad.Textures.insert(itIModelTex->second.begin(), itIModelTex->second.end());
 			}
 		}
 	}
@@ -517,7 +518,7 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 				AdvViz::SDK::ITwinMaterial NewMaterial;
 				[[maybe_unused]] bool const bLoadOK = LoadMaterialWithoutRetuning(NewMaterial, MatID,
 					FITwinMaterialLibrary::GetBeLibraryPathForLoading(mappingIt->AssetPath),
-					IModel.IModelId, Lock);
+					IModel.IModelId, *Lock, PendingLoad);
 				ensureMsgf(bLoadOK, TEXT("Could not load material from %s"), *mappingIt->AssetPath);
 			}
 		}
@@ -530,6 +531,12 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 		MatPredictionEntry.MatID = MatID;
 	}
 
+	// Resolve the textures without holding the lock of the material helper, and set the definition of the
+	// materials loaded from the library before creating their slots.
+	Lock.reset();
+	FinishMaterialLoading(PendingLoad, IModel.IModelId);
+	Lock.emplace(GltfMatHelper->GetMutex());
+
 	// Then create the corresponding entries in the material helper (important for edition), and enable
 	// material tuning if we do have a custom definition.
 	{
@@ -543,13 +550,13 @@ void FITwinIModelMaterialHandler::UpdateModelFromMatMLPrediction(bool bSuccess,
 			// material tuning if we do have a custom definition.
 			auto const MatInfo = GltfMatHelper->CreateITwinMaterialSlot(MatID,
 																		TCHAR_TO_UTF8(*CustomMat.Name),
-																		Lock);
+																		*Lock);
 			if (MatInfo.second && AdvViz::SDK::HasCustomSettings(*MatInfo.second))
 			{
 				CustomMat.bAdvancedConversion = true;
 
 				// Perform texture conversions at once.
-				TexConverter.ConvertTexturesToGltf(MatID, Lock);
+				TexConverter.ConvertTexturesToGltf(MatID, *Lock);
 			}
 		}
 	}
@@ -1464,6 +1471,7 @@ bool FITwinIModelMaterialHandler::LoadMaterialWithoutRetuning(
 	FMaterialAssetInfo const& MaterialAssetInfo,
 	FString const& IModelId,
 	BeUtils::WLock const& Lock,
+	FPendingMaterialLoad& OutPendingLoad,
 	LoadOptions const& Options /*= {}*/)
 {
 	using namespace AdvViz::SDK;
@@ -1556,32 +1564,52 @@ bool FITwinIModelMaterialHandler::LoadMaterialWithoutRetuning(
 		}
 	}
 
-	// Resolve the textures, if any (they should all exist in the Material Library...)
+	// The textures, if any (they should all exist in the Material Library...), will be resolved once the
+	// lock is released, and the material definition will be set afterwards.
 	if (!NewTextures.empty())
+	{
+		GltfMatHelper->AppendTextureUsageMap(NewTextureUsageMap, Lock);
+
+		OutPendingLoad.Textures.insert(NewTextures.begin(), NewTextures.end());
+		if (TexSource == ETextureSource::LocalDisk)
+			OutPendingLoad.bResolveLocalDiskTextures = true;
+	}
+	OutPendingLoad.Materials.emplace_back(MaterialId, NewMaterial);
+
+	return true;
+}
+
+bool FITwinIModelMaterialHandler::FinishMaterialLoading(FPendingMaterialLoad& PendingLoad,
+	FString const& IModelId)
+{
+	auto const& MatIOMngr = GetPersistenceManager();
+	if (!PendingLoad.Textures.empty() && ensure(MatIOMngr))
 	{
 		// Use maps with just one ID here...
 		std::string const imodelId = TCHAR_TO_UTF8(*IModelId);
 
-		PerIModelTextureSet PerModelTextures;
+		AdvViz::SDK::PerIModelTextureSet PerModelTextures;
 		std::map<std::string, std::shared_ptr<BeUtils::GltfMaterialHelper>> imodelIdToMatHelper;
-		PerModelTextures.emplace(imodelId, NewTextures);
+		PerModelTextures.emplace(imodelId, std::move(PendingLoad.Textures));
 		imodelIdToMatHelper.emplace(imodelId, GltfMatHelper);
 
-		GltfMatHelper->AppendTextureUsageMap(NewTextureUsageMap, Lock);
-
+		// The material edition needs the textures at once, but at least the material helper is not locked
+		// while they are downloaded (only while they are stored).
 		if (!ITwin::ResolveDecorationTextures(
 			*MatIOMngr,
 			PerModelTextures,
 			imodelIdToMatHelper,
-			/*bResolveLocalDiskTextures =*/ TexSource == ETextureSource::LocalDisk,
-			&Lock))
+			PendingLoad.bResolveLocalDiskTextures))
 		{
 			return false;
 		}
 	}
 
-	GltfMatHelper->SetMaterialFullDefinition(MaterialId, NewMaterial, Lock);
-
+	BeUtils::WLock Lock(GltfMatHelper->GetMutex());
+	for (auto const& [MaterialId, NewMaterial] : PendingLoad.Materials)
+	{
+		GltfMatHelper->SetMaterialFullDefinition(MaterialId, NewMaterial, Lock);
+	}
 	return true;
 }
 
@@ -1610,6 +1638,7 @@ bool FITwinIModelMaterialHandler::LoadMaterialFromAssetFile(uint64_t MaterialId,
 	std::string CurrentAlphaMode;
 	ITwinMaterial NewMaterial;
 
+	FPendingMaterialLoad PendingLoad;
 	{
 		BeUtils::WLock Lock(GltfMatHelper->GetMutex());
 
@@ -1618,11 +1647,15 @@ bool FITwinIModelMaterialHandler::LoadMaterialFromAssetFile(uint64_t MaterialId,
 
 		// Actually load the material.
 		if (!LoadMaterialWithoutRetuning(NewMaterial, MaterialId, MaterialAssetInfo, IModelId,
-										 Lock, Options))
+										 Lock, PendingLoad, Options))
 		{
 			return false;
 		}
 	}
+	if (!FinishMaterialLoading(PendingLoad, IModelId))
+	{
+		return false;
+	}
 
 	if (Options.CustomizeMaterialFunc)
 	{
@@ -170,13 +170,25 @@ public:
 		UITwinMaterialDefaultTexturesHolder const& DefaultTexturesHolder,
 		LoadOptions const& Options = {});
 
+	//! Materials loaded while the material helper is locked, and the textures they use. They are committed
+	//! by #FinishMaterialLoading, once the lock is released.
+	struct FPendingMaterialLoad;
+
+	//! Loads a material, without resolving its textures nor setting its definition in the material helper
+	//! yet: both are added to OutPendingLoad.
 	bool LoadMaterialWithoutRetuning(AdvViz::SDK::ITwinMaterial& OutNewMaterial,
 		uint64_t MaterialId,
 		FMaterialAssetInfo const& MaterialAssetInfo,
 		FString const& IModelId,
 		BeUtils::WLock const& Lock,
+		FPendingMaterialLoad& OutPendingLoad,
 		LoadOptions const& Options = {});
 
+	//! Resolves the textures of the pending materials, and then sets their definition in the material
+	//! helper. The lock of the material helper must not be held by the caller, as textures may have to be
+	//! downloaded.
+	bool FinishMaterialLoading(FPendingMaterialLoad& PendingLoad, FString const& IModelId);
+
 
 	//-----------------------------------------------------------------------------------
 	// ML-based material prediction
@@ -83,7 +83,7 @@ namespace
 			std::make_shared<std::string const>(TCHAR_TO_ANSI(*AccessToken)),
 			getAssetAccessor(),
 			getAsyncSystem(),
-			[&TextureDstPath](std::vector<uint8_t> const& TexBuffer)
+			[&TextureDstPath](std::span<uint8_t const> TexBuffer)
 		{
 			bool bSaveOK = false;
 			if (!TexBuffer.empty())
@@ -0,0 +1,220 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ElementsMetadataSnapshot.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "ElementsMetadataSnapshot.h"
+
+#include <ITwinSceneMapping.h>
+
+#include <HAL/FileManager.h>
+#include <Misc/Crc.h>
+#include <Misc/FileHelper.h>
+#include <Serialization/MemoryReader.h>
+#include <Serialization/MemoryWriter.h>
+
+#include <ITwinRuntime/Private/Compil/BeforeNonUnrealIncludes.h>
+#	include <Core/Tools/Log.h>
+#include <ITwinRuntime/Private/Compil/AfterNonUnrealIncludes.h>
+
+#include <cstring>
+
+namespace QueriesCache {
+
+namespace {
+
+	constexpr uint32 SNAPSHOT_MAGIC = 0x444D4549; // "IEMD"
+	constexpr uint32 SNAPSHOT_VERSION = 1;
+
+	struct FSnapshotHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumElements;
+		uint32 NumParentIDs;
+		uint64 MetadataSize;
+	};
+	static_assert(sizeof(FSnapshotHeader) == 24);
+
+	enum EMetadataFlags : uint8
+	{
+		HasBBox = 1,
+		HasFederationGuid = 2,
+		HasSourceElementID = 4,
+	};
+
+	/// Smallest encoded Element: IDs and flags
+	constexpr int64 MIN_ENCODED_SIZE = 2 * sizeof(uint64) + sizeof(uint8);
+
+	void SerializeVector(FArchive& Ar, FVector& Vec)
+	{
+		Ar << Vec.X << Vec.Y << Vec.Z;
+	}
+
+} // ns anonymous
+
+/*static*/
+const TCHAR* FElementsMetadataSnapshot::FileName = TEXT("ElementsMetadata.bin");
+
+/*static*/
+void FElementsMetadataSnapshot::EncodeMetadata(std::vector<FITwinElementMetadata> const& Metadata,
+											   TArray<uint8>& OutBytes)
+{
+	FMemoryWriter Ar(OutBytes, /*bIsPersistent*/true, /*bSetOffset: append*/true);
+	for (auto const& Row : Metadata)
+	{
+		uint64 ElementID = Row.ElementID.value();
+		uint64 ParentID = Row.ParentID.value();
+		uint8 Flags = (Row.BBox ? HasBBox : 0)
+			| (Row.FederationGuid ? HasFederationGuid : 0)
+			| (Row.SourceElementID.IsEmpty() ? 0 : HasSourceElementID);
+		Ar << ElementID << ParentID << Flags;
+		if (Row.BBox)
+		{
+			FBox BBox = *Row.BBox;
+			SerializeVector(Ar, BBox.Min);
+			SerializeVector(Ar, BBox.Max);
+		}
+		if (Row.FederationGuid)
+		{
+			FGuid Guid = *Row.FederationGuid;
+			Ar << Guid;
+		}
+		if (!Row.SourceElementID.IsEmpty())
+		{
+			FString SourceElementID = Row.SourceElementID;
+			Ar << SourceElementID;
+		}
+	}
+}
+
+void FElementsMetadataSnapshot::AppendMetadata(TArray<uint8> const& EncodedMetadata, int32 const NumElements)
+{
+	MetadataBytes.Append(EncodedMetadata);
+	ElementCount += NumElements;
+}
+
+void FElementsMetadataSnapshot::AppendConstructionDetailingParentIDs(
+	std::vector<ITwinElementID> const& ParentIDs)
+{
+	ConstructionDetailingParentIDs.insert(ConstructionDetailingParentIDs.end(), ParentIDs.begin(),
+										  ParentIDs.end());
+}
+
+void FElementsMetadataSnapshot::Reset()
+{
+	MetadataBytes.Empty();
+	ElementCount = 0;
+	ConstructionDetailingParentIDs.clear();
+}
+
+bool FElementsMetadataSnapshot::Save(FString const& Path) const
+{
+	FSnapshotHeader const Header{ SNAPSHOT_MAGIC, SNAPSHOT_VERSION, (uint32)ElementCount,
+		(uint32)ConstructionDetailingParentIDs.size(), (uint64)MetadataBytes.Num() };
+	TArray<uint8> Bytes;
+	Bytes.Reserve(sizeof(Header) + MetadataBytes.Num()
+		+ ConstructionDetailingParentIDs.size() * sizeof(uint64) + sizeof(uint32));
+	Bytes.Append(reinterpret_cast<uint8 const*>(&Header), sizeof(Header));
+	Bytes.Append(MetadataBytes);
+	for (auto const ParentID : ConstructionDetailingParentIDs)
+	{
+		uint64 const Value = ParentID.value();
+		Bytes.Append(reinterpret_cast<uint8 const*>(&Value), sizeof(Value));
+	}
+	uint32 const Crc = FCrc::MemCrc32(Bytes.GetData(), Bytes.Num());
+	Bytes.Append(reinterpret_cast<uint8 const*>(&Crc), sizeof(Crc));
+
+	FString const TmpPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TmpPath)
+		|| !IFileManager::Get().Move(*Path, *TmpPath, /*bReplace*/true))
+	{
+		BE_LOGW("ITwinQuery", "Could not save Elements metadata snapshot " << TCHAR_TO_UTF8(*Path));
+		IFileManager::Get().Delete(*TmpPath);
+		return false;
+	}
+	return true;
+}
+
+/*static*/
+bool FElementsMetadataSnapshot::Load(FString const& Path, std::vector<FITwinElementMetadata>& OutMetadata,
+	std::vector<ITwinElementID>& OutConstructionDetailingParentIDs)
+{
+	OutMetadata.clear();
+	OutConstructionDetailingParentIDs.clear();
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+		return false;
+	FSnapshotHeader Header;
+	if (Bytes.Num() < (int64)(sizeof(Header) + sizeof(uint32)))
+	{
+		BE_LOGW("ITwinQuery", "Truncated Elements metadata snapshot " << TCHAR_TO_UTF8(*Path));
+		return false;
+	}
+	std::memcpy(&Header, Bytes.GetData(), sizeof(Header));
+	if (Header.Magic != SNAPSHOT_MAGIC || Header.Version != SNAPSHOT_VERSION)
+	{
+		BE_LOGI("ITwinQuery", "Ignoring Elements metadata snapshot of unknown version " << Header.Version);
+		return false;
+	}
+	uint32 Crc;
+	int64 const CrcOffset = Bytes.Num() - (int64)sizeof(Crc);
+	std::memcpy(&Crc, Bytes.GetData() + CrcOffset, sizeof(Crc));
+	int64 const MetadataEnd = (int64)sizeof(Header) + (int64)Header.MetadataSize;
+	if (Crc != FCrc::MemCrc32(Bytes.GetData(), CrcOffset)
+		|| MetadataEnd + (int64)Header.NumParentIDs * (int64)sizeof(uint64) != CrcOffset
+		|| (int64)Header.NumElements * MIN_ENCODED_SIZE > (int64)Header.MetadataSize)
+	{
+		BE_LOGW("ITwinQuery", "Corrupt Elements metadata snapshot " << TCHAR_TO_UTF8(*Path));
+		return false;
+	}
+
+	FMemoryReader Ar(Bytes, /*bIsPersistent*/true);
+	Ar.Seek(sizeof(Header));
+	OutMetadata.resize(Header.NumElements);
+	for (auto& Row : OutMetadata)
+	{
+		uint64 ElementID = 0, ParentID = 0;
+		uint8 Flags = 0;
+		Ar << ElementID << ParentID << Flags;
+		Row.ElementID = ITwinElementID(ElementID);
+		Row.ParentID = ITwinElementID(ParentID);
+		if (Flags & HasBBox)
+		{
+			FBox BBox(ForceInit);
+			SerializeVector(Ar, BBox.Min);
+			SerializeVector(Ar, BBox.Max);
+			BBox.IsValid = 1;
+			Row.BBox.emplace(BBox);
+		}
+		if (Flags & HasFederationGuid)
+		{
+			FGuid Guid;
+			Ar << Guid;
+			Row.FederationGuid.emplace(Guid);
+		}
+		if (Flags & HasSourceElementID)
+			Ar << Row.SourceElementID;
+		if (Ar.IsError())
+			break;
+	}
+	if (Ar.IsError() || Ar.Tell() != MetadataEnd)
+	{
+		BE_LOGW("ITwinQuery", "Could not decode Elements metadata snapshot " << TCHAR_TO_UTF8(*Path));
+		OutMetadata.clear();
+		return false;
+	}
+	OutConstructionDetailingParentIDs.resize(Header.NumParentIDs);
+	for (uint32 i = 0; i < Header.NumParentIDs; ++i)
+	{
+		uint64 ParentID;
+		std::memcpy(&ParentID, Bytes.GetData() + MetadataEnd + i * sizeof(uint64), sizeof(ParentID));
+		OutConstructionDetailingParentIDs[i] = ITwinElementID(ParentID);
+	}
+	return true;
+}
+
+} // ns QueriesCache
@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ElementsMetadataSnapshot.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <Containers/Array.h>
+#include <Containers/UnrealString.h>
+#include <HAL/Platform.h>
+#include <ITwinElementID.h>
+
+#include <vector>
+
+struct FITwinElementMetadata;
+
+namespace QueriesCache {
+
+/// Compact binary snapshot of the metadata of all Elements of an iModel, as obtained from the paginated
+/// ECSQL queries of FQueryElementMetadataPageByPage (see ITwinIModel.cpp). It is saved in the cache folder
+/// of these queries, which is specific to the iModel's changeset, once all pages have been parsed, so
+/// that the next sessions can load everything in one go instead of reading and parsing each cached page.
+///
+/// Pages are encoded (typically on the worker threads parsing them) with EncodeMetadata, then appended
+/// in the order in which they are applied to the scene mapping, to keep the same Element ranks when the
+/// snapshot is loaded.
+///
+/// File layout: a header (magic, version, counts), the encoded metadata, the Construction Detailing
+/// parent IDs, then the checksum of all of the above.
+class FElementsMetadataSnapshot
+{
+public:
+	/// Name of the snapshot file in the cache folder
+	static const TCHAR* FileName;
+
+	static void EncodeMetadata(std::vector<FITwinElementMetadata> const& Metadata, TArray<uint8>& OutBytes);
+	/// \param EncodedMetadata Bytes obtained from EncodeMetadata
+	void AppendMetadata(TArray<uint8> const& EncodedMetadata, int32 const NumElements);
+	void AppendConstructionDetailingParentIDs(std::vector<ITwinElementID> const& ParentIDs);
+	void Reset();
+	[[nodiscard]] int32 NumElements() const { return ElementCount; }
+
+	/// Writes the snapshot in a temporary file first, then renames it, so that an interrupted write never
+	/// leaves a truncated snapshot behind.
+	bool Save(FString const& Path) const;
+	/// \return false if the file is missing, of an unknown version or corrupted, in which case the output
+	///		vectors are left empty.
+	[[nodiscard]] static bool Load(FString const& Path, std::vector<FITwinElementMetadata>& OutMetadata,
+		std::vector<ITwinElementID>& OutConstructionDetailingParentIDs);
+
+private:
+	TArray<uint8> MetadataBytes;
+	int32 ElementCount = 0;
+	std::vector<ITwinElementID> ConstructionDetailingParentIDs;
+};
+
+} // ns QueriesCache
@@ -8,6 +8,7 @@
 
 #include "JsonQueriesCache.h"
 #include "JsonQueriesCacheInit.h"
+#include "PackedJsonStore.h"
 #include <Hashing/UnrealString.h>
 #include <ITwinIModelSettings.h>
 #include <ITwinServerConnection.h>
@@ -19,6 +20,7 @@
 #include <ITwinRuntime/Private/Compil/AfterNonUnrealIncludes.h>
 
 #include <Interfaces/IHttpResponse.h>
+#include <HAL/FileManager.h>
 #include <Misc/FileHelper.h>
 #include <Misc/Paths.h>
 #include <Serialization/JsonReader.h>
@@ -91,6 +93,8 @@ class FJsonQueriesCacheManager
 	int64 MaxSize = 4 * 1073741824ULL; // 4GB;
 	FCacheMRU MRU;
 	std::unordered_map<FString, FCacheMRU::iterator> Caches;
+	/// Growth of the caches in use since the size limit was last enforced, see OnCacheGrown
+	int64 GrowthSinceLastCheck = 0;
 
 public:
 	static std::shared_ptr<FJsonQueriesCacheManager> Get()
@@ -250,6 +254,34 @@ public:
 		CleanLeastRecentlyUsed();
 	}
 
+	void SetSizeOnDisk(FCacheMRU::iterator const& Entry, int64 const SizeOnDisk)
+	{
+		std::lock_guard<std::mutex> Lock(CommonMux);
+		Entry->SizeOnDisk = SizeOnDisk;
+	}
+
+	/// Updates the size of a cache in use, and enforces the size limit when the caches in use have grown
+	/// significantly since the last check: unused caches are deleted first, least recently used first.
+	/// \return Size to which the passed cache should be compacted, when deleting the unused caches was not
+	///		enough to fit the limit.
+	[[nodiscard]] std::optional<int64> OnCacheGrown(FCacheMRU::iterator const& Entry, int64 const SizeOnDisk)
+	{
+		std::lock_guard<std::mutex> Lock(CommonMux);
+		GrowthSinceLastCheck += SizeOnDisk - Entry->SizeOnDisk;
+		Entry->SizeOnDisk = SizeOnDisk;
+		if (GrowthSinceLastCheck < MaxSize / 32)
+			return std::nullopt;
+		GrowthSinceLastCheck = 0;
+		CleanLeastRecentlyUsed();
+		int64 TotalSize = 0;
+		for (auto&& Other : MRU)
+			TotalSize += Other.SizeOnDisk;
+		if (TotalSize <= MaxSize)
+			return std::nullopt;
+		// Only caches in use remain: shrink this one with some margin, to avoid compacting it again soon
+		return std::max<int64>(0, SizeOnDisk - (TotalSize - MaxSize) - MaxSize / 16);
+	}
+
 	std::optional<FCacheMRU::iterator> InitializeThis(FString CacheFolder,
 		EITwinEnvironment const Environment, FString const& DisplayName)
 	{
@@ -282,6 +314,45 @@ public:
 
 }; // class FJsonQueriesCacheManager
 
+/// Key of a query in the packed store: the verb and url, then the payload for POST requests. Queries of a
+/// same "family" thus share a key prefix, see FJsonQueriesCache::Preload.
+std::string MakeStoreKey(FString const& Verb, FString const& Url, FString const* Payload = nullptr)
+{
+	FString Key = Verb + TEXT(" ") + Url + TEXT("\n");
+	if (Payload)
+		Key += *Payload;
+	return std::string(TCHAR_TO_UTF8(*Key));
+}
+
+inline FString ToUnrealString(AdvViz::SDK::Tools::StringWithEncoding const& ContentString)
+{
+	if (ContentString.GetEncoding() == AdvViz::SDK::Tools::EStringEncoding::Utf8)
+		return UTF8_TO_TCHAR(ContentString.str().c_str());
+	else
+		return ANSI_TO_TCHAR(ContentString.str().c_str());
+}
+
+std::string MakeStoreKey(AdvViz::SDK::ITwinAPIRequestInfo const& Req)
+{
+	if (AdvViz::SDK::EVerb::Post == Req.Verb)
+	{
+		FString const Payload = ToUnrealString(Req.ContentString);
+		return MakeStoreKey(ITwinHttp::GetVerbString(Req.Verb), Req.UrlSuffix.c_str(), &Payload);
+	}
+	return MakeStoreKey(ITwinHttp::GetVerbString(Req.Verb), Req.UrlSuffix.c_str());
+}
+
+std::string MakeStoreKey(FHttpRequestPtr const& Req)
+{
+	if (Req->GetVerb() == TEXT("POST"))
+	{
+		auto&& ContentAsArray = Req->GetContent();
+		FString const Payload(ContentAsArray.Num(), UTF8_TO_TCHAR(ContentAsArray.GetData()));
+		return MakeStoreKey(Req->GetVerb(), Req->GetURL(), &Payload);
+	}
+	return MakeStoreKey(Req->GetVerb(), Req->GetURL());
+}
+
 } // anon. ns.
 
 class FJsonQueriesCache::FImpl
@@ -293,7 +364,24 @@ public:
 	bool bIsRecordingForSimulation = false;
 	bool bIsUnitTesting = false;
 	int RecorderTimestamp = 0;
+	/// Only used for session simulation, and to convert caches written with one file per reply
 	QueriesCache::FSessionMap SessionMap;
+	QueriesCache::FPackedJsonStore Store;
+
+	std::optional<QueriesCache::FCacheHit> Find(FString const& Verb, FString const& Url,
+		FString const* Payload = nullptr)
+	{
+		if (Store.IsOpen())
+		{
+			if (auto const Id = Store.Find(MakeStoreKey(Verb, Url, Payload)))
+				return QueriesCache::FCacheHit(*Id);
+			return std::nullopt;
+		}
+		auto const It = Payload ? SessionMap.find(QueriesCache::FQueryKey(Url, *Payload)) : SessionMap.find(Url);
+		if (SessionMap.end() != It)
+			return QueriesCache::FCacheHit(It->second);
+		return std::nullopt;
+	}
 };
 
 FJsonQueriesCache::FJsonQueriesCache(UObject const& Owner) : Impl(MakePimpl<FImpl>())
@@ -321,8 +409,14 @@ void FJsonQueriesCache::Uninitialize()
 {
 	if (IsValid() && Impl->Manager)
 	{
+		if (Impl->Store.IsOpen())
+		{
+			Impl->Manager->SetSizeOnDisk(Impl->Entry, Impl->Store.GetSizeOnDisk());
+			Impl->Store.Close(); // before MarkAsUsed, which can delete this cache's folder
+		}
 		Impl->Manager->MarkAsUsed(*this, Impl->Entry, FJsonQueriesCacheManager::EUseFlag::Unloading);
 	}
+	Impl->Store.Close();
 	Impl->Manager.reset();
 	Impl->PathBase.Empty();
 	QueriesCache::FSessionMap Tmp;
@@ -334,7 +428,10 @@ void FJsonQueriesCache::Uninitialize()
 void FJsonQueriesCache::ClearFromDisk()
 {
 	if (IsValid())
+	{
+		Impl->Store.Close(); // mapped files cannot be deleted on all platforms
 		IFileManager::Get().DeleteDirectory(*Impl->PathBase, /*requireExists*/false, /*recurse*/true);
+	}
 }
 
 bool FJsonQueriesCache::Initialize(FString CacheFolder, EITwinEnvironment const Environment,
@@ -366,9 +463,13 @@ bool FJsonQueriesCache::Initialize(FString CacheFolder, EITwinEnvironment const
 	}
 	Impl->PathBase = CacheFolder;
 	FString ParseError;
+	// Only iterates on reply files when simulating, or when converting a cache to the packed store
 	QueriesCache::FRecordDirIterator DirIter(Impl->SessionMap, nullptr, ParseError, &Impl->RecorderTimestamp);
-	if (IFileManager::Get().IterateDirectory(*CacheFolder, DirIter))
+	if (IFileManager::Get().IterateDirectory(*CacheFolder, DirIter) && DirIter.ParseFiles()
+		&& (Impl->bIsRecordingForSimulation || ConvertToStore(CacheFolder)))
 	{
+		if (Impl->Store.IsOpen())
+			Impl->Manager->SetSizeOnDisk(Impl->Entry, Impl->Store.GetSizeOnDisk());
 		// set "InUse" and update timestamp (see also dtor...)
 		Impl->Manager->MarkAsUsed(*this, Impl->Entry, FJsonQueriesCacheManager::EUseFlag::Loading);
 		return true;
@@ -378,15 +479,63 @@ bool FJsonQueriesCache::Initialize(FString CacheFolder, EITwinEnvironment const
 		BE_LOGE("ITwinQuery", "Error loading cache: " << TCHAR_TO_UTF8(*ParseError)
 			<< " --> Clearing cache folder " << TCHAR_TO_UTF8(*CacheFolder)
 			<< " to avoid mixing corrupt and new data");
+		Impl->Store.Close();
 		IFileManager::Get().DeleteDirectory(*CacheFolder, /*requireExists*/false, /*recurse*/true);
 		Uninitialize();
 		// was reset and folder deleted, but set them up again to use for recording what we will (re-)download
 		Impl->PathBase = CacheFolder;
 		ensure(IFileManager::Get().MakeDirectory(*CacheFolder, /*recurse*/true));
+		if (!InbIsRecordingForSimulation)
+			Impl->Store.Open(CacheFolder);
 		return false;
 	}
 }
 
+bool FJsonQueriesCache::ConvertToStore(FString const& CacheFolder)
+{
+	if (!Impl->Store.Open(CacheFolder))
+		return false;
+	if (Impl->SessionMap.empty())
+		return true;
+	BE_LOGI("ITwinQuery", "Converting " << Impl->SessionMap.size() << " cache files to a packed store in "
+		<< TCHAR_TO_UTF8(*CacheFolder));
+	for (auto&& [Key, ReplyPath] : Impl->SessionMap)
+	{
+		if (ReplyPath.IsEmpty())
+			continue; // failed query
+		TSharedPtr<FJsonObject> const Reply = Read(QueriesCache::FCacheHit(ReplyPath));
+		if (!Reply)
+		{
+			BE_LOGW("ITwinQuery", "Skipping unreadable cache file " << TCHAR_TO_UTF8(*ReplyPath));
+			continue;
+		}
+		FString ReplyString;
+		FJsonSerializer::Serialize(Reply.ToSharedRef(),
+			TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&ReplyString));
+		FTCHARToUTF8 const Utf8Reply(*ReplyString, ReplyString.Len());
+		std::string_view const Value(reinterpret_cast<const char*>(Utf8Reply.Get()), Utf8Reply.Length());
+		std::visit([this, Value](auto&& UrlOrKey)
+			{
+				using T = std::decay_t<decltype(UrlOrKey)>;
+				if constexpr (std::is_same_v<T, FString>)
+					Impl->Store.Append(MakeStoreKey(TEXT("GET"), UrlOrKey), Value);
+				else if constexpr (std::is_same_v<T, QueriesCache::FQueryKey>)
+					Impl->Store.Append(MakeStoreKey(TEXT("POST"), UrlOrKey.first, &UrlOrKey.second), Value);
+				else static_assert(always_false_v<T>, "non-exhaustive visitor!");
+			},
+			Key);
+	}
+	if (!Impl->Store.Commit())
+		return false;
+	Impl->SessionMap.clear();
+	TArray<FString> ReplyFiles;
+	IFileManager::Get().FindFiles(ReplyFiles, *FPaths::Combine(CacheFolder, TEXT("*.json")),
+		/*files*/true, /*directories*/false);
+	for (FString const& ReplyFile : ReplyFiles)
+		IFileManager::Get().Delete(*FPaths::Combine(CacheFolder, ReplyFile));
+	return true;
+}
+
 FJsonQueriesCache::~FJsonQueriesCache()
 {
 	if (Impl->Manager) // this case happens when in Editor only (not PIE) then closing Unreal
@@ -402,7 +551,7 @@ bool FJsonQueriesCache::LoadSessionSimulation(FString const& SimulateFromFolder)
 		QueriesCache::FReplayMap ReplayMap;
 		FString ParseError;
 		QueriesCache::FRecordDirIterator DirIter(Impl->SessionMap, &ReplayMap, ParseError);
-		if (IFileManager::Get().IterateDirectory(*Impl->PathBase, DirIter))
+		if (IFileManager::Get().IterateDirectory(*Impl->PathBase, DirIter) && DirIter.ParseFiles())
 			return true;
 		BE_LOGE("ITwinQuery", "Error parsing simulation data from " << TCHAR_TO_UTF8(*SimulateFromFolder)
 			<< ": " << TCHAR_TO_UTF8(*ParseError));
@@ -414,6 +563,12 @@ void FJsonQueriesCache::Write(AdvViz::SDK::ITwinAPIRequestInfo const& CompletedR
 	FString const& QueryResult, bool const bConnectedSuccessfully, ITwinHttp::FMutex& Mutex,
 	int const QueryTimestamp/*= -1*/)
 {
+	if (!Impl->bIsRecordingForSimulation)
+	{
+		if (ensure(bConnectedSuccessfully)) // we shouldn't write unsuccessful replies in the cache...
+			WriteToStore(MakeStoreKey(CompletedRequest), QueryResult);
+		return;
+	}
 	auto JsonObj = MakeShared<FJsonObject>();
 	ToJson(CompletedRequest, JsonObj);
 	Write(JsonObj, bConnectedSuccessfully ? 200 : 500/*we don't get the actual code from SDK...*/,
@@ -425,7 +580,8 @@ void FJsonQueriesCache::Write(FHttpRequestPtr const& CompletedRequest, FHttpResp
 	bool const bConnectedSuccessfully, ITwinHttp::FMutex& Mutex, int const QueryTimestamp/*= -1*/)
 {
 	auto JsonObj = MakeShared<FJsonObject>();
-	ToJson(CompletedRequest, JsonObj);
+	if (Impl->bIsRecordingForSimulation)
+		ToJson(CompletedRequest, JsonObj);
 	if (Response)
 	{
 		FString Reply = Response->GetContentAsString();
@@ -443,14 +599,43 @@ void FJsonQueriesCache::Write(FHttpRequestPtr const& CompletedRequest, FHttpResp
 					+ Reply.RightChop(Index + 1);
 			}
 		}
-		Write(JsonObj, Response->GetResponseCode(), Reply, bConnectedSuccessfully, bRequestSucceeded,
-			  Mutex, QueryTimestamp);
+		if (Impl->bIsRecordingForSimulation)
+		{
+			Write(JsonObj, Response->GetResponseCode(), Reply, bConnectedSuccessfully, bRequestSucceeded,
+				  Mutex, QueryTimestamp);
+		}
+		// we shouldn't write unsuccessful replies in the cache...
+		else if (ensure(bRequestSucceeded) && bConnectedSuccessfully)
+		{
+			WriteToStore(MakeStoreKey(CompletedRequest), Reply);
+		}
 	}
-	else
+	else if (Impl->bIsRecordingForSimulation)
 	{
 		Write(JsonObj, 418/* https://en.wikipedia.org/wiki/HTTP_418 */, {}, bConnectedSuccessfully, false,
 			  Mutex, QueryTimestamp);
 	}
+	else ensure(false);
+}
+
+void FJsonQueriesCache::WriteToStore(std::string const& StoreKey, FString const& ContentAsString)
+{
+	if (!ensure(IsValid()))
+		return;
+	FTCHARToUTF8 const Content(*ContentAsString, ContentAsString.Len());
+	if (!Impl->Store.Append(StoreKey,
+			std::string_view(reinterpret_cast<const char*>(Content.Get()), Content.Length())))
+	{
+		return; // error already logged
+	}
+	if (!Impl->Manager)
+		return;
+	// Enforce the size limit now rather than at the next (un)initialization of a cache
+	if (auto const CompactTo = Impl->Manager->OnCacheGrown(Impl->Entry, Impl->Store.GetSizeOnDisk()))
+	{
+		BE_LOGI("ITwinQuery", "Cache size limit reached, compacting " << TCHAR_TO_UTF8(*Impl->PathBase));
+		Impl->Manager->SetSizeOnDisk(Impl->Entry, Impl->Store.Compact(*CompactTo));
+	}
 }
 
 void FJsonQueriesCache::Write(TSharedRef<FJsonObject>& JsonObj, int const ResponseCode,
@@ -459,13 +644,11 @@ void FJsonQueriesCache::Write(TSharedRef<FJsonObject>& JsonObj, int const Respon
 {
 	if (!ensure(IsValid()))
 		return;
-	if (Impl->bIsRecordingForSimulation)
-	{
-		ensure(QueryTimestamp != -1);
-		JsonObj->SetNumberField(TEXT("toQuery"), QueryTimestamp);
-	}
-	else 
-		ensure(bRequestSucceeded); // we shouldn't write unsuccessful replies in the cache...
+	// Replies are written to the packed store unless recording for simulation
+	if (!ensure(Impl->bIsRecordingForSimulation))
+		return;
+	ensure(QueryTimestamp != -1);
+	JsonObj->SetNumberField(TEXT("toQuery"), QueryTimestamp);
 	JsonObj->SetBoolField(TEXT("connectedSuccessfully"), bConnectedSuccessfully);
 	JsonObj->SetNumberField(TEXT("responseCode"), ResponseCode);
 	FString JsonString;
@@ -488,9 +671,7 @@ void FJsonQueriesCache::Write(TSharedRef<FJsonObject>& JsonObj, int const Respon
 		else check(false);
 	}
 	FString const Path = FPaths::Combine(Impl->PathBase,
-		Impl->bIsRecordingForSimulation
-			? FString::Printf(TEXT("%08d_res_%08d.json"), Impl->RecorderTimestamp, QueryTimestamp)
-			: FString::Printf(TEXT("%08d.json"), Impl->RecorderTimestamp));
+		FString::Printf(TEXT("%08d_res_%08d.json"), Impl->RecorderTimestamp, QueryTimestamp));
 	++Impl->RecorderTimestamp;
 	if (FFileHelper::SaveStringToFile(JsonString, *Path, FFileHelper::EEncodingOptions::ForceUTF8))
 	{
@@ -502,17 +683,6 @@ void FJsonQueriesCache::Write(TSharedRef<FJsonObject>& JsonObj, int const Respon
 	}
 }
 
-namespace
-{
-	inline FString ToUnrealString(AdvViz::SDK::Tools::StringWithEncoding const& ContentString)
-	{
-		if (ContentString.GetEncoding() == AdvViz::SDK::Tools::EStringEncoding::Utf8)
-			return UTF8_TO_TCHAR(ContentString.str().c_str());
-		else
-			return ANSI_TO_TCHAR(ContentString.str().c_str());
-	}
-}
-
 void FJsonQueriesCache::ToJson(AdvViz::SDK::ITwinAPIRequestInfo const& Req, TSharedRef<FJsonObject>& JsonObj) 
 	const
 {
@@ -596,67 +766,68 @@ void FJsonQueriesCache::RecordQuery(FHttpRequestPtr const& Request, ITwinHttp::F
 	}
 }
 
-std::optional<QueriesCache::FSessionMap::const_iterator> FJsonQueriesCache::LookUp(
+std::optional<QueriesCache::FCacheHit> FJsonQueriesCache::LookUp(
 	AdvViz::SDK::ITwinAPIRequestInfo const& Request, ITwinHttp::FMutex& Mutex) const
 {
 	ITwinHttp::FLock Lock(Mutex);
-	QueriesCache::FSessionMap::const_iterator It;
 	switch (Request.Verb)
 	{
 	case ITwinHttp::EVerb::Get:
-		It = Impl->SessionMap.find(Request.UrlSuffix.c_str());
-		break;
+		return Impl->Find(TEXT("GET"), Request.UrlSuffix.c_str());
 	case ITwinHttp::EVerb::Post:
 	{
-		It = Impl->SessionMap.find(
-			QueriesCache::FQueryKey(Request.UrlSuffix.c_str(), ToUnrealString(Request.ContentString)));
-		break;
+		FString const Payload = ToUnrealString(Request.ContentString);
+		return Impl->Find(TEXT("POST"), Request.UrlSuffix.c_str(), &Payload);
 	}
 	default:
 		ensure(false); // unimplemented
 		return {};
 	}
-	if (Impl->SessionMap.end() != It)
-		return It;
-	else return std::nullopt;
 }
 
-std::optional<QueriesCache::FSessionMap::const_iterator> FJsonQueriesCache::LookUp(
+std::optional<QueriesCache::FCacheHit> FJsonQueriesCache::LookUp(
 	FHttpRequestPtr const& Request, ITwinHttp::EVerb const Verb, ITwinHttp::FMutex& Mutex) const
 {
 	ITwinHttp::FLock Lock(Mutex);
-	QueriesCache::FSessionMap::const_iterator It;
 	switch (Verb)
 	{
 	case ITwinHttp::EVerb::Get:
-		It = Impl->SessionMap.find(Request->GetURL());
-		break;
+		return Impl->Find(TEXT("GET"), Request->GetURL());
 	case ITwinHttp::EVerb::Post:
 	{
 		auto&& ContentAsArray = Request->GetContent();
-		It = Impl->SessionMap.find(QueriesCache::FQueryKey(
-			Request->GetURL(),
-			FString(ContentAsArray.Num(), UTF8_TO_TCHAR(ContentAsArray.GetData()))));
-		break;
+		FString const Payload(ContentAsArray.Num(), UTF8_TO_TCHAR(ContentAsArray.GetData()));
+		return Impl->Find(TEXT("POST"), Request->GetURL(), &Payload);
 	}
 	default:
 		ensure(false); // unimplemented
 		return {};
 	}
-	if (Impl->SessionMap.end() != It)
-		return It;
-	else return std::nullopt;
 }
 
-TSharedPtr<FJsonObject> FJsonQueriesCache::Read(QueriesCache::FSessionMap::const_iterator const It) const
+void FJsonQueriesCache::Preload(AdvViz::SDK::ITwinAPIRequestInfo const& FamilyRequest) const
 {
-	if (Impl->SessionMap.end() != It)
+	if (!Impl->Store.IsOpen())
+		return;
+	int64 const Hinted = Impl->Store.Preload(
+		MakeStoreKey(ITwinHttp::GetVerbString(FamilyRequest.Verb), FamilyRequest.UrlSuffix.c_str()));
+	if (Hinted > 0)
 	{
+		BE_LOGI("ITwinQuery", "Preloading " << (Hinted >> 10) << "KB of cached replies for "
+			<< FamilyRequest.ShortName);
+	}
+}
+
+TSharedPtr<FJsonObject> FJsonQueriesCache::Read(QueriesCache::FCacheHit const& Hit) const
+{
+	TSharedPtr<FJsonObject> JsonObject;
+	if (FString const* ReplyPath = std::get_if<FString>(&Hit))
+	{
+		// Reply file of a simulation session, or of a cache being converted to the packed store
 		FString FileContent;
-		if (!FFileHelper::LoadFileToString(FileContent, *It->second))
+		if (ReplyPath->IsEmpty() || !FFileHelper::LoadFileToString(FileContent, **ReplyPath))
 			return {};
 		auto Reader = TJsonReaderFactory<TCHAR>::Create(FileContent);
-		TSharedPtr<FJsonObject> JsonObject;
 		if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
 			return {};
 		TSharedPtr<FJsonObject> const* ReplyObj;
@@ -665,8 +836,13 @@ TSharedPtr<FJsonObject> FJsonQueriesCache::Read(QueriesCache::FSessionMap::const
 		else
 			return {};
 	}
-	else
-	{
+	std::string Value;
+	if (!Impl->Store.Read(std::get<uint32>(Hit), Value))
 		return {};
-	}
+	FUTF8ToTCHAR const Converted(reinterpret_cast<const ANSICHAR*>(Value.data()), (int32)Value.size());
+	FString const Content(Converted.Length(), Converted.Get());
+	auto Reader = TJsonReaderFactory<TCHAR>::Create(Content);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+		return {};
+	return JsonObject;
 }
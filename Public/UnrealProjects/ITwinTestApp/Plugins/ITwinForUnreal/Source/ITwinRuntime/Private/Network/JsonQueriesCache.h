@@ -21,6 +21,9 @@
 	#include <boost/container_hash/hash.hpp>
 #include <Compil/AfterNonUnrealIncludes.h>
 
+#include <optional>
+#include <string>
+
 namespace AdvViz::SDK { struct ITwinAPIRequestInfo; }
 
 enum class EITwinEnvironment : uint8;
@@ -51,14 +54,20 @@ namespace QueriesCache
 /// Initialize to set the folder from which to load the available cache entries and into which
 /// new entries can be recorded.
 ///
+/// Replies are stored in a QueriesCache::FPackedJsonStore, except when recording a session for simulation,
+/// which uses one file per query and reply for easier inspection. Caches written with the former
+/// one-file-per-reply layout are converted when initialized.
+///
 /// A disk size limit (default 2GB) applies to all caches of a given ServerEnvironment (QA/PROD/DEV).
-/// Cache cleaning only happens when initializing or releasing a cache, to avoid synchronizing on all
-/// Read/Write operations.
+/// Unused caches are cleaned when initializing or releasing a cache, and also when caches in use have
+/// grown significantly, in which case the growing cache may also be compacted, least recently used
+/// replies first.
 ///
-/// Thread-safety: Read/Write operations are synchronized using a user-supplied mutex, which thus only
-/// protects against concurrent operations on the same cache instance. Synchronization of operations
-/// using all caches (like LRU-cleaning) is done using an internal mutex, only in the "Initialize" and
-/// destructor methods, so that it does not affect I/O operations of cache instances currently in use.
+/// Thread-safety: LookUp operations are synchronized using a user-supplied mutex, which thus only
+/// protects against concurrent operations on the same cache instance, while the packed store has its own
+/// mutex. Synchronization of operations using all caches (like LRU-cleaning) is done using an internal
+/// mutex, only in the "Initialize" and destructor methods, and every few dozen MB written, so that it does
+/// not affect I/O operations of cache instances currently in use.
 ///
 /// TODO_GCO: only GET and POST requests are supported at the moment.
 class FJsonQueriesCache
@@ -71,6 +80,9 @@ class FJsonQueriesCache
 	void Write(TSharedRef<FJsonObject>& JsonObj, int const ResponseCode,
 		FString const& ContentAsString, bool const bConnectedSuccessfully, bool const bRequestSucceeded,
 		ITwinHttp::FMutex& Mutex, int const QueryTimestamp);
+	void WriteToStore(std::string const& StoreKey, FString const& ContentAsString);
+	/// Converts a cache written with one file per reply, loaded in the SessionMap, to the packed store
+	[[nodiscard]] bool ConvertToStore(FString const& CacheFolder);
 
 public:
 	explicit FJsonQueriesCache(UObject const& Owner);
@@ -92,22 +104,27 @@ public:
 	void ClearFromDisk();
 
 	/// Read a request's reply from the cache, based on the handle returned by one of the LookUp methods
-	[[nodiscard]] TSharedPtr<FJsonObject> Read(QueriesCache::FSessionMap::const_iterator const It) const;
+	[[nodiscard]] TSharedPtr<FJsonObject> Read(QueriesCache::FCacheHit const& Hit) const;
 
 	/// Look up the response to an Unreal Http request in the cache. Note: AcceptHeader, ContentType and
 	/// custom headers are not taken into account for indexing. When non-empty, pass the resulting
-	/// iterator to Read to actually load and parse the response Json.
+	/// handle to Read to actually load and parse the response Json.
 	/// \return Empty object on cache miss
-	[[nodiscard]] std::optional<QueriesCache::FSessionMap::const_iterator> LookUp(
+	[[nodiscard]] std::optional<QueriesCache::FCacheHit> LookUp(
 		FHttpRequestPtr const& Request, ITwinHttp::EVerb const Verb, ITwinHttp::FMutex& Mutex) const;
 
 	/// Look up the response to an AdvViz::SDK request in the cache. Note: AcceptHeader, ContentType and
 	/// custom headers are not taken into account for indexing. When non-empty, pass the resulting
-	/// iterator to Read to actually load and parse the response Json
+	/// handle to Read to actually load and parse the response Json
 	/// \return Empty object on cache miss
-	[[nodiscard]] std::optional<QueriesCache::FSessionMap::const_iterator> LookUp(
+	[[nodiscard]] std::optional<QueriesCache::FCacheHit> LookUp(
 		AdvViz::SDK::ITwinAPIRequestInfo const& RequestInfo, ITwinHttp::FMutex& Mutex) const;
 
+	/// Hints the system to load all the cached replies to a "family" of queries, ie. queries using the same
+	/// verb and url but different payloads, like the pages of a paginated ECSQL query, before they are
+	/// looked up and read one by one.
+	void Preload(AdvViz::SDK::ITwinAPIRequestInfo const& FamilyRequest) const;
+
 	/// Save the response to an Unreal Http query in the cache
 	/// \parameter CompletedRequest Request for which we just obtained a response
 	/// \parameter QueryTimestamp Only relevant for bIsRecordingForSimulation. TODO_GCO: Could use RequestID
@@ -17,8 +17,10 @@
 
 #include <Misc/Paths.h>
 
+#include <algorithm>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace QueriesCache {
 
@@ -44,7 +46,7 @@ struct FRflQuery
 /// Well, be it skipped or not, parsing is not what takes the most time by far :/ On HS2, reading all
 /// cache files took almost 6s, but only one second less without any parsing at all...
 /// I should save replies as separate files (and/or all request metadata in a single file/DB), but for now
-/// I'm just truncating the files (see LoadCacheFileToStringWithoutReply)
+/// I'm just truncating the files (see CacheFileWithoutReply)
 struct FRflReply
 {
 	/// Replaces inheritance which is not supported out of the box - see:
@@ -57,8 +59,37 @@ struct FRflReply
 
 bool FRecordDirIterator::Visit(const TCHAR* Filename, bool bIsDirectory) /*override*/
 {
-	if (bIsDirectory || FPaths::GetCleanFilename(Filename).ToLower() == MRU_TIMESTAMP)
-		return true;
+	// Skip cache.txt and the files of the packed store
+	if (!bIsDirectory && FPaths::GetExtension(Filename).ToLower() == TEXT("json"))
+		Filenames.Add(Filename);
+	return true;
+}
+
+bool FRecordDirIterator::ParseFiles()
+{
+	// Bounds the number of files mapped at the same time
+	constexpr int32 FilesPerBatch = 1024;
+	std::vector<std::filesystem::path> Paths;
+	for (int32 Begin = 0; Begin < Filenames.Num(); Begin += FilesPerBatch)
+	{
+		int32 const End = std::min(Begin + FilesPerBatch, Filenames.Num());
+		Paths.clear();
+		for (int32 i = Begin; i < End; ++i)
+			Paths.emplace_back(*Filenames[i]);
+		std::vector<AdvViz::SDK::Tools::CacheFileWithoutReply> const Files =
+			AdvViz::SDK::Tools::LoadCacheFilesWithoutReply(Paths);
+		for (int32 i = Begin; i < End; ++i)
+		{
+			if (!ParseFile(Filenames[i], Files[i - Begin].GetJson()))
+				return false;
+		}
+	}
+	Filenames.Empty();
+	return true;
+}
+
+bool FRecordDirIterator::ParseFile(FString const& Filename, std::string_view const FileString)
+{
 	TArray<FString> OutArray;
 	if (FPaths::GetBaseFilename(FString(Filename)).ParseIntoArray(OutArray, TEXT("_")) <= 1)
 	{
@@ -74,15 +105,12 @@ bool FRecordDirIterator::Visit(const TCHAR* Filename, bool bIsDirectory) /*overr
 		*pRecorderTimestamp = std::max(*pRecorderTimestamp, Timestamp + 1);
 	bool bIsReply = false;
 	std::string RflParseError;
-	if (!std::filesystem::exists(std::filesystem::path(Filename)))
-		{ ensure(false); return false; }
-	std::string const FileString = AdvViz::SDK::Tools::LoadCacheFileToStringWithoutReply(Filename);
 	if (FileString.empty())
 		{ ensure(false); return false; }
 	if (!bSimulationMode || (OutArray.Num() == 3 && OutArray[1] == TEXT("res"))) // reply
 	{
 		FRflReply Reply = { FRflQuery{} };
-		if (!AdvViz::SDK::Json::FromString(Reply, FileString, RflParseError))
+		if (!AdvViz::SDK::Json::FromStringView(Reply, FileString, RflParseError))
 		{
 			ParsingError = RflParseError.c_str();
 			ensure(false); return false;
@@ -141,7 +169,7 @@ bool FRecordDirIterator::Visit(const TCHAR* Filename, bool bIsDirectory) /*overr
 	else if (/*bSimulationMode &&*/OutArray.Num() == 2 && OutArray[1] == TEXT("req")) // query
 	{
 		FRflQuery Query;
-		if (!AdvViz::SDK::Json::FromString(Query, FileString, RflParseError))
+		if (!AdvViz::SDK::Json::FromStringView(Query, FileString, RflParseError))
 		{
 			ParsingError = RflParseError.c_str();
 			ensure(false); return false;
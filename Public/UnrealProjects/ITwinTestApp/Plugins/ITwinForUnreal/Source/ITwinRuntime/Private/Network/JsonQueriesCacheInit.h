@@ -13,6 +13,8 @@
 
 #include <GenericPlatform/GenericPlatformFile.h>
 
+#include <string_view>
+
 namespace QueriesCache {
 
 static const TCHAR* MRU_TIMESTAMP = TEXT("cache.txt");
@@ -34,7 +36,15 @@ public:
 	{
 	}
 
+	/// Only collects the cache files: call ParseFiles once the iteration is over.
 	virtual bool Visit(const TCHAR* Filename, bool bIsDirectory) override;
+	/// Loads the collected files (in parallel, by batches) and parses them in the order they were visited.
+	bool ParseFiles();
+
+private:
+	bool ParseFile(FString const& Filename, std::string_view const FileString);
+
+	TArray<FString> Filenames;
 };
 
 } // ns QueriesCache
@@ -30,6 +30,9 @@ namespace QueriesCache
 	using FQueryKey = std::pair<FString/*url*/, FString/*payload*/>;
 	using FSessionMap
 		= std::unordered_map<std::variant<FString/*url*/, FQueryKey>, FString/*reply filepath*/>;
+	/// Handle to a cached reply, as returned by FJsonQueriesCache::LookUp: either the path of a reply file
+	/// (session simulation), or the Id of a record of the cache's FPackedJsonStore
+	using FCacheHit = std::variant<FString/*reply filepath*/, uint32/*record Id*/>;
 	/// Map of the queries/replies sent/received in the order in which it happened during a session
 	using FReplayMap = std::map<int32/*Timestamp*/,
 		std::variant</*get or post query:*/FString/*url*/, FQueryKey,
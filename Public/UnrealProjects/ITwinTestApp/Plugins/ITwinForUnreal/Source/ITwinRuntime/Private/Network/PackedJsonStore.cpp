@@ -0,0 +1,976 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: PackedJsonStore.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include "PackedJsonStore.h"
+
+#include <Async/MappedFileHandle.h>
+#include <GenericPlatform/GenericPlatformFile.h>
+#include <HAL/PlatformFileManager.h>
+#include <Hash/CityHash.h>
+#include <Misc/Crc.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include <ITwinRuntime/Private/Compil/BeforeNonUnrealIncludes.h>
+#	include <Core/Tools/Log.h>
+#include <ITwinRuntime/Private/Compil/AfterNonUnrealIncludes.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace QueriesCache {
+
+namespace {
+
+	constexpr uint32 RECORD_MAGIC = 0x314E534A; // "JSN1"
+	constexpr uint32 INDEX_MAGIC = 0x31584449; // "IDX1"
+	constexpr uint32 INDEX_VERSION = 1;
+	constexpr uint32 JOURNAL_MAGIC = 0x314C4E4A; // "JNL1"
+	/// Beyond this number of segments, or proportion of dead records, the store is compacted when opened.
+	constexpr size_t MAX_SEGMENTS = 8;
+	constexpr int64 MAX_DEAD_BYTES_RATIO = 4;
+	/// Number of appends after which the new records are journaled, to bound the recovery scan after a
+	/// crash.
+	constexpr int32 APPENDS_PER_COMMIT = 64;
+
+	/// Record layout in segments: this header, then the key, then the value.
+	struct FRecordHeader
+	{
+		uint32 Magic;
+		uint32 KeySize;
+		uint32 ValueSize;
+		uint32 Crc; ///< Of the key and value
+	};
+	static_assert(sizeof(FRecordHeader) == 16);
+
+	/// Index layout: this header, then NumSegments FIndexSegment, then NumRecords FIndexRecord, then the
+	/// checksum of all of the above.
+	struct FIndexHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 Generation;
+		uint32 Session;
+		uint32 NumSegments;
+		uint32 NumRecords;
+		uint32 Padding;
+	};
+	static_assert(sizeof(FIndexHeader) == 32);
+
+	struct FIndexSegment
+	{
+		uint32 Number;
+		uint32 Padding;
+		uint64 CommittedSize;
+	};
+	static_assert(sizeof(FIndexSegment) == 16);
+
+	struct FIndexRecord
+	{
+		uint64 KeyHash;
+		uint64 Offset;
+		uint32 SegmentNumber;
+		uint32 KeySize;
+		uint32 ValueSize;
+		uint32 LastUse;
+	};
+	static_assert(sizeof(FIndexRecord) == 32);
+
+	/// Journal layout: this header, then blocks made of a FJournalBlock, NumRecords FIndexRecord, and the
+	/// checksum of the block.
+	struct FJournalHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 Generation; ///< Of the index the journal applies to
+	};
+	static_assert(sizeof(FJournalHeader) == 16);
+
+	struct FJournalBlock
+	{
+		uint32 SegmentNumber; ///< Segment written by the session
+		uint32 NumRecords;
+		uint64 SegmentSize; ///< Size of the segment covered by the block and the previous ones
+	};
+	static_assert(sizeof(FJournalBlock) == 16);
+
+	IPlatformFile& GetPlatformFile()
+	{
+		return FPlatformFileManager::Get().GetPlatformFile();
+	}
+
+	uint64 HashKey(std::string_view const Key)
+	{
+		return CityHash64(Key.data(), static_cast<uint32>(Key.size()));
+	}
+
+	uint32 RecordCrc(std::string_view const Key, std::string_view const Value)
+	{
+		return FCrc::MemCrc32(Value.data(), static_cast<int32>(Value.size()),
+			FCrc::MemCrc32(Key.data(), static_cast<int32>(Key.size())));
+	}
+
+	FString GetSegmentPath(FString const& Folder, uint32 const Number)
+	{
+		return FPaths::Combine(Folder, FString::Printf(TEXT("store_%08u.dat"), Number));
+	}
+
+	FString GetIndexPath(FString const& Folder, uint64 const Generation)
+	{
+		return FPaths::Combine(Folder, (Generation % 2) ? TEXT("store.idx1") : TEXT("store.idx0"));
+	}
+
+	FString GetJournalPath(FString const& Folder)
+	{
+		return FPaths::Combine(Folder, TEXT("store.jnl"));
+	}
+
+	/// Returns the number of a segment file from its name, if it is one.
+	std::optional<uint32> ParseSegmentNumber(const TCHAR* Filename)
+	{
+		FString const Name = FPaths::GetCleanFilename(Filename);
+		if (!Name.StartsWith(TEXT("store_")) || !Name.EndsWith(TEXT(".dat")))
+			return std::nullopt;
+		FString const Number = Name.Mid(6, Name.Len() - 10);
+		if (Number.IsEmpty() || !Number.IsNumeric())
+			return std::nullopt;
+		return static_cast<uint32>(FCString::Strtoui64(*Number, nullptr, 10));
+	}
+
+} // anon. ns.
+
+struct FPackedJsonStore::FSegment
+{
+	uint32 Number = 0;
+	FString Path;
+	/// The region is declared after the file handle so that it is released first.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> Region;
+	/// Only used when memory mapping is not supported.
+	TArray<uint8> LoadedData;
+	/// Start of the data mapped (or loaded) when the store was opened, and its size.
+	uint8 const* Data = nullptr;
+	int64 DataSize = 0;
+	/// Only for the segment receiving the records of this session, which are read back with it.
+	TUniquePtr<IFileHandle> Writer;
+	/// Size of the valid records of the segment.
+	int64 Size = 0;
+
+	bool Map()
+	{
+		int64 const FileSize = GetPlatformFile().FileSize(*Path);
+		if (FileSize <= 0)
+			return false;
+		FOpenMappedResult Mapped = GetPlatformFile().OpenMappedEx(*Path);
+		if (Mapped.HasValue())
+		{
+			MappedFile = Mapped.StealValue();
+			Region.Reset(MappedFile->MapRegion(0, FileSize));
+		}
+		if (Region)
+		{
+			Data = Region->GetMappedPtr();
+			DataSize = Region->GetMappedSize();
+		}
+		else
+		{
+			Region.Reset();
+			MappedFile.Reset();
+			if (!FFileHelper::LoadFileToArray(LoadedData, *Path))
+				return false;
+			Data = LoadedData.GetData();
+			DataSize = LoadedData.Num();
+		}
+		Size = DataSize;
+		return true;
+	}
+};
+
+struct FPackedJsonStore::FRecord
+{
+	/// Records are sorted by Id, which are not contiguous once compaction has dropped evicted records.
+	FRecordId Id = 0;
+	uint64 KeyHash = 0;
+	/// Offset of the record header in its segment.
+	int64 Offset = 0;
+	/// Index in Segments, or -1 when the record was evicted (or replaced).
+	int32 Segment = -1;
+	uint32 KeySize = 0;
+	uint32 ValueSize = 0;
+	uint32 LastUse = 0;
+
+	int64 TotalSize() const { return sizeof(FRecordHeader) + int64(KeySize) + ValueSize; }
+	bool IsLive() const { return Segment >= 0; }
+};
+
+FPackedJsonStore::FPackedJsonStore()
+{
+}
+
+FPackedJsonStore::~FPackedJsonStore()
+{
+	Close();
+}
+
+bool FPackedJsonStore::Exists(FString const& InFolder)
+{
+	if (GetPlatformFile().FileExists(*GetIndexPath(InFolder, 0))
+		|| GetPlatformFile().FileExists(*GetIndexPath(InFolder, 1)))
+	{
+		return true;
+	}
+	bool bFoundSegment = false;
+	GetPlatformFile().IterateDirectory(*InFolder, [&bFoundSegment](const TCHAR* Filename, bool bIsDirectory)
+		{
+			bFoundSegment = !bIsDirectory && ParseSegmentNumber(Filename).has_value();
+			return !bFoundSegment;
+		});
+	return bFoundSegment;
+}
+
+bool FPackedJsonStore::IsOpen() const
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	return bIsOpen;
+}
+
+void FPackedJsonStore::Reset()
+{
+	Segments.clear();
+	Records.clear();
+	ByKeyHash.clear();
+	WriteSegment = -1;
+	NextSegmentNumber = 0;
+	Session = 0;
+	IndexGeneration = 0;
+	LiveBytes = 0;
+	IndexSize = 0;
+	JournalSize = 0;
+	NextRecordId = 0;
+	FirstUnjournaled = 0;
+	AppendsSinceCommit = 0;
+	bIsOpen = false;
+	bIndexDirty = false;
+}
+
+bool FPackedJsonStore::Open(FString const& InFolder, bool const bCompactIfNeeded/*= true*/)
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	Reset();
+	if (!GetPlatformFile().DirectoryExists(*InFolder))
+		return false;
+	Folder = InFolder;
+	std::vector<uint32> Numbers;
+	GetPlatformFile().IterateDirectory(*Folder, [&Numbers](const TCHAR* Filename, bool bIsDirectory)
+		{
+			if (!bIsDirectory)
+			{
+				if (auto const Number = ParseSegmentNumber(Filename))
+					Numbers.push_back(*Number);
+			}
+			return true;
+		});
+	std::sort(Numbers.begin(), Numbers.end());
+	for (uint32 const Number : Numbers)
+	{
+		NextSegmentNumber = std::max(NextSegmentNumber, Number + 1);
+		auto Segment = std::make_unique<FSegment>();
+		Segment->Number = Number;
+		Segment->Path = GetSegmentPath(Folder, Number);
+		if (Segment->Map())
+			Segments.push_back(std::move(Segment));
+		else // empty (or unreadable) segment
+			GetPlatformFile().DeleteFile(*Segment->Path);
+	}
+	// Scan the segments, or their part appended after the last commit of the index and journal
+	std::vector<int64> CommittedSizes = LoadIndex();
+	ReplayJournal(CommittedSizes);
+	for (int32 Idx = 0; Idx < (int32)Segments.size(); ++Idx)
+	{
+		if (Segments[Idx]->Size > CommittedSizes[Idx])
+		{
+			ScanSegment(Idx, CommittedSizes[Idx]);
+			bIndexDirty = true;
+		}
+	}
+	++Session;
+	bIsOpen = true;
+	FirstUnjournaled = NextRecordId;
+	int64 SegmentsSize = 0;
+	for (auto const& Segment : Segments)
+		SegmentsSize += Segment->Size;
+	if (bCompactIfNeeded && (Segments.size() > MAX_SEGMENTS
+		|| (SegmentsSize - LiveBytes) * MAX_DEAD_BYTES_RATIO > SegmentsSize))
+	{
+		CompactLocked(std::numeric_limits<int64>::max());
+	}
+	else if (bIndexDirty)
+	{
+		CommitLocked();
+	}
+	return true;
+}
+
+std::vector<int64> FPackedJsonStore::LoadIndex()
+{
+	std::vector<int64> CommittedSizes(Segments.size(), 0);
+	// Use the most recent valid slot
+	TArray<uint8> Index;
+	uint64 BestGeneration = 0;
+	for (uint64 Slot = 0; Slot < 2; ++Slot)
+	{
+		TArray<uint8> Content;
+		if (!FFileHelper::LoadFileToArray(Content, *GetIndexPath(Folder, Slot), FILEREAD_Silent)
+			|| Content.Num() < int32(sizeof(FIndexHeader) + sizeof(uint32)))
+		{
+			continue;
+		}
+		FIndexHeader Header;
+		std::memcpy(&Header, Content.GetData(), sizeof(Header));
+		int64 const ExpectedSize = sizeof(FIndexHeader) + int64(Header.NumSegments) * sizeof(FIndexSegment)
+			+ int64(Header.NumRecords) * sizeof(FIndexRecord) + sizeof(uint32);
+		uint32 Crc = 0;
+		if (Header.Magic != INDEX_MAGIC || Header.Version != INDEX_VERSION || Content.Num() != ExpectedSize)
+			continue;
+		std::memcpy(&Crc, Content.GetData() + Content.Num() - sizeof(uint32), sizeof(uint32));
+		if (Crc != FCrc::MemCrc32(Content.GetData(), Content.Num() - int32(sizeof(uint32))))
+		{
+			BE_LOGW("ITwinQuery", "Corrupt cache index " << TCHAR_TO_UTF8(*GetIndexPath(Folder, Slot)));
+			continue;
+		}
+		if (Index.IsEmpty() || Header.Generation > BestGeneration)
+		{
+			BestGeneration = Header.Generation;
+			Index = MoveTemp(Content);
+		}
+	}
+	if (Index.IsEmpty())
+		return CommittedSizes;
+
+	FIndexHeader Header;
+	std::memcpy(&Header, Index.GetData(), sizeof(Header));
+	IndexGeneration = Header.Generation;
+	Session = Header.Session;
+	IndexSize = Index.Num();
+	uint8 const* Cursor = Index.GetData() + sizeof(FIndexHeader);
+	// Maps segment numbers to indices in Segments
+	std::unordered_map<uint32, int32> SegmentIndices;
+	uint32 MaxIndexedNumber = 0;
+	for (uint32 i = 0; i < Header.NumSegments; ++i, Cursor += sizeof(FIndexSegment))
+	{
+		FIndexSegment IndexSegment;
+		std::memcpy(&IndexSegment, Cursor, sizeof(IndexSegment));
+		MaxIndexedNumber = std::max(MaxIndexedNumber, IndexSegment.Number);
+		auto const Found = std::find_if(Segments.begin(), Segments.end(),
+			[&IndexSegment](auto const& Segment) { return Segment->Number == IndexSegment.Number; });
+		if (Found == Segments.end())
+		{
+			BE_LOGW("ITwinQuery", "Missing cache segment " << IndexSegment.Number << " in "
+				<< TCHAR_TO_UTF8(*Folder));
+			continue;
+		}
+		int32 const Idx = int32(Found - Segments.begin());
+		SegmentIndices[IndexSegment.Number] = Idx;
+		CommittedSizes[Idx] = std::min(int64(IndexSegment.CommittedSize), (*Found)->Size);
+	}
+	for (uint32 i = 0; i < Header.NumRecords; ++i, Cursor += sizeof(FIndexRecord))
+	{
+		FIndexRecord IndexRecord;
+		std::memcpy(&IndexRecord, Cursor, sizeof(IndexRecord));
+		auto const Found = SegmentIndices.find(IndexRecord.SegmentNumber);
+		if (Found == SegmentIndices.end())
+			continue;
+		FRecord Record;
+		Record.KeyHash = IndexRecord.KeyHash;
+		Record.Offset = int64(IndexRecord.Offset);
+		Record.Segment = Found->second;
+		Record.KeySize = IndexRecord.KeySize;
+		Record.ValueSize = IndexRecord.ValueSize;
+		Record.LastUse = IndexRecord.LastUse;
+		if (Record.Offset + Record.TotalSize() > CommittedSizes[Record.Segment])
+			continue;
+		Record.Id = NextRecordId++;
+		LiveBytes += Record.TotalSize();
+		ByKeyHash.emplace(Record.KeyHash, Record.Id);
+		Records.push_back(Record);
+	}
+	// Unindexed segments older than the indexed ones are leftovers of a compaction interrupted after its
+	// index was committed: all their live records were copied. Newer ones are scanned by the caller.
+	for (int32 Idx = (int32)Segments.size() - 1; Idx >= 0; --Idx)
+	{
+		if (Segments[Idx]->Number < MaxIndexedNumber && !SegmentIndices.contains(Segments[Idx]->Number))
+		{
+			FString const Path = Segments[Idx]->Path;
+			Segments.erase(Segments.begin() + Idx);
+			CommittedSizes.erase(CommittedSizes.begin() + Idx);
+			GetPlatformFile().DeleteFile(*Path);
+			// Segment indices of the records after the erased one are shifted
+			for (FRecord& Record : Records)
+			{
+				if (Record.Segment > Idx)
+					--Record.Segment;
+			}
+		}
+	}
+	return CommittedSizes;
+}
+
+void FPackedJsonStore::ReplayJournal(std::vector<int64>& CommittedSizes)
+{
+	FString const Path = GetJournalPath(Folder);
+	TArray<uint8> Journal;
+	if (IndexSize == 0 || !FFileHelper::LoadFileToArray(Journal, *Path, FILEREAD_Silent)
+		|| Journal.Num() < int32(sizeof(FJournalHeader)))
+	{
+		return;
+	}
+	FJournalHeader Header;
+	std::memcpy(&Header, Journal.GetData(), sizeof(Header));
+	if (Header.Magic != JOURNAL_MAGIC || Header.Version != INDEX_VERSION
+		|| Header.Generation != IndexGeneration)
+	{
+		return; // journal of a previous index, whose records are all in the current one
+	}
+	int64 Cursor = sizeof(FJournalHeader);
+	std::string Buffer;
+	while (Cursor + int64(sizeof(FJournalBlock) + sizeof(uint32)) <= Journal.Num())
+	{
+		FJournalBlock Block;
+		std::memcpy(&Block, Journal.GetData() + Cursor, sizeof(Block));
+		int64 const BlockSize = sizeof(FJournalBlock) + int64(Block.NumRecords) * sizeof(FIndexRecord);
+		uint32 Crc = 0;
+		if (Cursor + BlockSize + int64(sizeof(uint32)) > Journal.Num())
+			break;
+		std::memcpy(&Crc, Journal.GetData() + Cursor + BlockSize, sizeof(uint32));
+		if (Crc != FCrc::MemCrc32(Journal.GetData() + Cursor, int32(BlockSize)))
+			break;
+		auto const Found = std::find_if(Segments.begin(), Segments.end(),
+			[&Block](auto const& Segment) { return Segment->Number == Block.SegmentNumber; });
+		if (Found != Segments.end())
+		{
+			int32 const Idx = int32(Found - Segments.begin());
+			CommittedSizes[Idx] = std::max(CommittedSizes[Idx],
+				std::min(int64(Block.SegmentSize), (*Found)->Size));
+			uint8 const* RecordData = Journal.GetData() + Cursor + sizeof(FJournalBlock);
+			for (uint32 i = 0; i < Block.NumRecords; ++i, RecordData += sizeof(FIndexRecord))
+			{
+				FIndexRecord IndexRecord;
+				std::memcpy(&IndexRecord, RecordData, sizeof(IndexRecord));
+				FRecord Record;
+				Record.KeyHash = IndexRecord.KeyHash;
+				Record.Offset = int64(IndexRecord.Offset);
+				Record.Segment = Idx;
+				Record.KeySize = IndexRecord.KeySize;
+				Record.ValueSize = IndexRecord.ValueSize;
+				Record.LastUse = IndexRecord.LastUse;
+				if (Record.Offset + Record.TotalSize() > CommittedSizes[Idx])
+					continue;
+				// Replaces the record with the same key, if any, like when it was appended
+				AddRecord(Record, GetKey(Record, Buffer));
+			}
+		}
+		Cursor += BlockSize + sizeof(uint32);
+	}
+	JournalSize = Cursor;
+	if (Cursor < Journal.Num())
+	{
+		// Block partially written when the application was stopped: blocks appended after it would be
+		// ignored, so the index must be rewritten (which resets the journal).
+		BE_LOGW("ITwinQuery", "Ignoring " << (Journal.Num() - Cursor) << " bytes at the end of "
+			<< TCHAR_TO_UTF8(*Path));
+		bIndexDirty = true;
+	}
+}
+
+void FPackedJsonStore::ScanSegment(int32 const SegmentIdx, int64 const From)
+{
+	FSegment& Segment = *Segments[SegmentIdx];
+	int64 Offset = From;
+	int32 Recovered = 0;
+	while (Offset + int64(sizeof(FRecordHeader)) <= Segment.DataSize)
+	{
+		FRecordHeader Header;
+		std::memcpy(&Header, Segment.Data + Offset, sizeof(Header));
+		int64 const DataEnd = Offset + int64(sizeof(Header)) + Header.KeySize + Header.ValueSize;
+		if (Header.Magic != RECORD_MAGIC || DataEnd > Segment.DataSize)
+			break;
+		std::string_view const Key(reinterpret_cast<const char*>(Segment.Data + Offset + sizeof(Header)),
+			Header.KeySize);
+		std::string_view const Value(Key.data() + Key.size(), Header.ValueSize);
+		if (Header.Crc != RecordCrc(Key, Value))
+			break;
+		FRecord Record;
+		Record.KeyHash = HashKey(Key);
+		Record.Offset = Offset;
+		Record.Segment = SegmentIdx;
+		Record.KeySize = Header.KeySize;
+		Record.ValueSize = Header.ValueSize;
+		Record.LastUse = Session;
+		AddRecord(Record, Key);
+		Offset = DataEnd;
+		++Recovered;
+	}
+	if (Offset < Segment.Size)
+	{
+		// Record partially written when the application was stopped: it will be dropped by compaction.
+		BE_LOGW("ITwinQuery", "Ignoring " << (Segment.Size - Offset) << " bytes at the end of "
+			<< TCHAR_TO_UTF8(*Segment.Path));
+		Segment.Size = Offset;
+	}
+	if (Recovered > 0)
+	{
+		BE_LOGI("ITwinQuery", "Recovered " << Recovered << " unindexed records from "
+			<< TCHAR_TO_UTF8(*Segment.Path));
+	}
+}
+
+FPackedJsonStore::FRecordId FPackedJsonStore::AddRecord(FRecord Record, std::string_view const Key)
+{
+	std::string Buffer;
+	auto const Range = ByKeyHash.equal_range(Record.KeyHash);
+	for (auto It = Range.first; It != Range.second; ++It)
+	{
+		if (GetKey(*GetRecord(It->second), Buffer) == Key)
+		{
+			Evict(It->second); // invalidates It, but we're done
+			break;
+		}
+	}
+	Record.Id = NextRecordId++;
+	LiveBytes += Record.TotalSize();
+	ByKeyHash.emplace(Record.KeyHash, Record.Id);
+	Records.push_back(Record);
+	return Record.Id;
+}
+
+FPackedJsonStore::FRecord const* FPackedJsonStore::GetRecord(FRecordId const Id) const
+{
+	auto const Found = std::lower_bound(Records.begin(), Records.end(), Id,
+		[](FRecord const& Record, FRecordId const Value) { return Record.Id < Value; });
+	return (Found != Records.end() && Found->Id == Id) ? &*Found : nullptr;
+}
+
+FPackedJsonStore::FRecord* FPackedJsonStore::GetRecord(FRecordId const Id)
+{
+	return const_cast<FRecord*>(std::as_const(*this).GetRecord(Id));
+}
+
+void FPackedJsonStore::Evict(FRecordId const Id)
+{
+	FRecord* const Found = GetRecord(Id);
+	if (!Found || !Found->IsLive())
+		return;
+	FRecord& Record = *Found;
+	auto const Range = ByKeyHash.equal_range(Record.KeyHash);
+	for (auto It = Range.first; It != Range.second; ++It)
+	{
+		if (It->second == Id)
+		{
+			ByKeyHash.erase(It);
+			break;
+		}
+	}
+	LiveBytes -= Record.TotalSize();
+	Record.Segment = -1;
+	bIndexDirty = true;
+}
+
+bool FPackedJsonStore::ReadBytes(FSegment const& Segment, int64 const Offset, int64 const Size,
+	uint8* Dest) const
+{
+	if (Offset + Size <= Segment.DataSize)
+	{
+		std::memcpy(Dest, Segment.Data + Offset, Size);
+		return true;
+	}
+	// Record appended during this session
+	if (!Segment.Writer || !Segment.Writer->Flush() || !Segment.Writer->Seek(Offset))
+		return false;
+	bool const bRead = Segment.Writer->Read(Dest, Size);
+	Segment.Writer->SeekFromEnd(0);
+	return bRead;
+}
+
+std::string_view FPackedJsonStore::GetKey(FRecord const& Record, std::string& Buffer) const
+{
+	if (!Record.IsLive())
+		return {};
+	FSegment const& Segment = *Segments[Record.Segment];
+	int64 const KeyOffset = Record.Offset + sizeof(FRecordHeader);
+	if (KeyOffset + Record.KeySize <= Segment.DataSize)
+		return std::string_view(reinterpret_cast<const char*>(Segment.Data + KeyOffset), Record.KeySize);
+	Buffer.resize(Record.KeySize);
+	if (!ReadBytes(Segment, KeyOffset, Record.KeySize, reinterpret_cast<uint8*>(Buffer.data())))
+		return {};
+	return Buffer;
+}
+
+std::optional<FPackedJsonStore::FRecordId> FPackedJsonStore::Find(std::string_view const Key)
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	std::string Buffer;
+	auto const Range = ByKeyHash.equal_range(HashKey(Key));
+	for (auto It = Range.first; It != Range.second; ++It)
+	{
+		FRecord& Record = *GetRecord(It->second);
+		if (Record.KeySize == Key.size() && GetKey(Record, Buffer) == Key)
+		{
+			if (Record.LastUse != Session)
+			{
+				Record.LastUse = Session;
+				bIndexDirty = true;
+			}
+			return It->second;
+		}
+	}
+	return std::nullopt;
+}
+
+bool FPackedJsonStore::Read(FRecordId const Id, std::string& OutValue) const
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	FRecord const* const Found = GetRecord(Id);
+	if (!Found || !Found->IsLive())
+		return false;
+	FRecord const& Record = *Found;
+	OutValue.resize(Record.ValueSize);
+	return ReadBytes(*Segments[Record.Segment], Record.Offset + sizeof(FRecordHeader) + Record.KeySize,
+		Record.ValueSize, reinterpret_cast<uint8*>(OutValue.data()));
+}
+
+bool FPackedJsonStore::CreateWriteSegment()
+{
+	auto Segment = std::make_unique<FSegment>();
+	Segment->Number = NextSegmentNumber++;
+	Segment->Path = GetSegmentPath(Folder, Segment->Number);
+	Segment->Writer.Reset(GetPlatformFile().OpenWrite(*Segment->Path, /*bAppend*/false, /*bAllowRead*/true));
+	if (!Segment->Writer)
+	{
+		BE_LOGE("ITwinQuery", "Could not create cache file " << TCHAR_TO_UTF8(*Segment->Path));
+		return false;
+	}
+	WriteSegment = (int32)Segments.size();
+	Segments.push_back(std::move(Segment));
+	return true;
+}
+
+std::optional<FPackedJsonStore::FRecordId> FPackedJsonStore::Append(std::string_view const Key,
+	std::string_view const Value)
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	if (!bIsOpen || Key.size() > std::numeric_limits<int32>::max()
+		|| Value.size() > std::numeric_limits<int32>::max())
+	{
+		return std::nullopt;
+	}
+	if (WriteSegment < 0 && !CreateWriteSegment())
+		return std::nullopt;
+	FSegment& Segment = *Segments[WriteSegment];
+	FRecordHeader const Header{ RECORD_MAGIC, uint32(Key.size()), uint32(Value.size()), RecordCrc(Key, Value) };
+	if (!Segment.Writer->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header))
+		|| !Segment.Writer->Write(reinterpret_cast<const uint8*>(Key.data()), Key.size())
+		|| !Segment.Writer->Write(reinterpret_cast<const uint8*>(Value.data()), Value.size()))
+	{
+		BE_LOGE("ITwinQuery", "Could not write to cache file " << TCHAR_TO_UTF8(*Segment.Path));
+		// Whatever was written will be ignored when scanning the segment
+		Segment.Writer->SeekFromEnd(0);
+		Segment.Size = Segment.Writer->Tell();
+		return std::nullopt;
+	}
+	FRecord Record;
+	Record.KeyHash = HashKey(Key);
+	Record.Offset = Segment.Size;
+	Record.Segment = WriteSegment;
+	Record.KeySize = Header.KeySize;
+	Record.ValueSize = Header.ValueSize;
+	Record.LastUse = Session;
+	Segment.Size += Record.TotalSize();
+	FRecordId const Id = AddRecord(Record, Key);
+	bIndexDirty = true;
+	if (++AppendsSinceCommit >= APPENDS_PER_COMMIT)
+		JournalLocked();
+	return Id;
+}
+
+bool FPackedJsonStore::Commit()
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	return CommitLocked();
+}
+
+bool FPackedJsonStore::CommitLocked()
+{
+	if (!bIsOpen)
+		return false;
+	AppendsSinceCommit = 0;
+	// Records must be on disk before the index referencing them
+	if (WriteSegment >= 0)
+		Segments[WriteSegment]->Writer->Flush(/*bFullFlush*/true);
+	TArray<uint8> Index;
+	Index.Reserve(int32(sizeof(FIndexHeader) + Segments.size() * sizeof(FIndexSegment)
+		+ Records.size() * sizeof(FIndexRecord) + sizeof(uint32)));
+	auto const Append = [&Index](auto const& Pod)
+		{ Index.Append(reinterpret_cast<const uint8*>(&Pod), int32(sizeof(Pod))); };
+	uint32 NumRecords = 0;
+	for (FRecord const& Record : Records)
+		NumRecords += Record.IsLive() ? 1 : 0;
+	Append(FIndexHeader{ INDEX_MAGIC, INDEX_VERSION, IndexGeneration + 1, Session, uint32(Segments.size()),
+						 NumRecords, 0 });
+	for (auto const& Segment : Segments)
+		Append(FIndexSegment{ Segment->Number, 0, uint64(Segment->Size) });
+	for (FRecord const& Record : Records)
+	{
+		if (Record.IsLive())
+		{
+			Append(FIndexRecord{ Record.KeyHash, uint64(Record.Offset), Segments[Record.Segment]->Number,
+								 Record.KeySize, Record.ValueSize, Record.LastUse });
+		}
+	}
+	Append(FCrc::MemCrc32(Index.GetData(), Index.Num()));
+	// Write the slot not holding the current index, so that it is still valid if we crash meanwhile
+	FString const Path = GetIndexPath(Folder, IndexGeneration + 1);
+	TUniquePtr<IFileHandle> File(GetPlatformFile().OpenWrite(*Path));
+	if (!File || !File->Write(Index.GetData(), Index.Num()) || !File->Flush(/*bFullFlush*/true))
+	{
+		BE_LOGE("ITwinQuery", "Could not write cache index " << TCHAR_TO_UTF8(*Path));
+		return false;
+	}
+	++IndexGeneration;
+	IndexSize = Index.Num();
+	bIndexDirty = false;
+	// Start a new journal for this index
+	FirstUnjournaled = NextRecordId;
+	FJournalHeader const JournalHeader{ JOURNAL_MAGIC, INDEX_VERSION, IndexGeneration };
+	TUniquePtr<IFileHandle> Journal(GetPlatformFile().OpenWrite(*GetJournalPath(Folder)));
+	if (Journal && Journal->Write(reinterpret_cast<const uint8*>(&JournalHeader), sizeof(JournalHeader)))
+		JournalSize = sizeof(JournalHeader);
+	else
+		JournalSize = 0; // next commits will rewrite the index
+	return true;
+}
+
+bool FPackedJsonStore::JournalLocked()
+{
+	AppendsSinceCommit = 0;
+	if (!bIsOpen || WriteSegment < 0)
+		return false;
+	// Rewriting the whole index every few appends would make filling the cache quadratic: append the new
+	// records to the journal instead, until it gets larger than the index.
+	TArray<uint8> Block;
+	auto const Append = [&Block](auto const& Pod)
+		{ Block.Append(reinterpret_cast<const uint8*>(&Pod), int32(sizeof(Pod))); };
+	FSegment& Segment = *Segments[WriteSegment];
+	auto const First = std::lower_bound(Records.begin(), Records.end(), FirstUnjournaled,
+		[](FRecord const& Record, FRecordId const Value) { return Record.Id < Value; });
+	uint32 NumRecords = 0;
+	for (auto It = First; It != Records.end(); ++It)
+		NumRecords += It->IsLive() ? 1 : 0;
+	if (NumRecords == 0)
+		return true;
+	int64 const BlockSize = sizeof(FJournalBlock) + int64(NumRecords) * sizeof(FIndexRecord) + sizeof(uint32);
+	if (JournalSize == 0 || JournalSize + BlockSize > IndexSize)
+		return CommitLocked();
+	Block.Reserve(int32(BlockSize));
+	Append(FJournalBlock{ Segment.Number, NumRecords, uint64(Segment.Size) });
+	for (auto It = First; It != Records.end(); ++It)
+	{
+		// Only the write segment receives records after the index was committed
+		if (It->IsLive())
+		{
+			Append(FIndexRecord{ It->KeyHash, uint64(It->Offset), Segment.Number, It->KeySize, It->ValueSize,
+								 It->LastUse });
+		}
+	}
+	Append(FCrc::MemCrc32(Block.GetData(), Block.Num()));
+	// Records must be on disk before the journal referencing them
+	Segment.Writer->Flush(/*bFullFlush*/true);
+	FString const Path = GetJournalPath(Folder);
+	TUniquePtr<IFileHandle> Journal(GetPlatformFile().OpenWrite(*Path, /*bAppend*/true));
+	if (!Journal || !Journal->Write(Block.GetData(), Block.Num()) || !Journal->Flush(/*bFullFlush*/true))
+	{
+		// Blocks appended after a partially written one would be ignored
+		BE_LOGE("ITwinQuery", "Could not write cache journal " << TCHAR_TO_UTF8(*Path));
+		Journal.Reset();
+		return CommitLocked();
+	}
+	JournalSize += Block.Num();
+	FirstUnjournaled = NextRecordId;
+	return true;
+}
+
+void FPackedJsonStore::Close()
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	if (bIsOpen && bIndexDirty)
+		CommitLocked();
+	Reset();
+}
+
+int64 FPackedJsonStore::Preload(std::string_view const KeyPrefix) const
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	struct FSpan { int32 Segment; int64 Begin, End; };
+	std::vector<FSpan> Spans;
+	std::string Buffer;
+	for (FRecord const& Record : Records)
+	{
+		if (Record.IsLive() && Record.KeySize >= KeyPrefix.size()
+			&& GetKey(Record, Buffer).starts_with(KeyPrefix))
+		{
+			Spans.push_back({ Record.Segment, Record.Offset, Record.Offset + Record.TotalSize() });
+		}
+	}
+	std::sort(Spans.begin(), Spans.end(), [](FSpan const& A, FSpan const& B)
+		{ return std::tie(A.Segment, A.Begin) < std::tie(B.Segment, B.Begin); });
+	int64 Hinted = 0;
+	for (size_t i = 0; i < Spans.size(); )
+	{
+		// Merge contiguous records, which is the common case for the pages of a query
+		FSpan Merged = Spans[i++];
+		while (i < Spans.size() && Spans[i].Segment == Merged.Segment && Spans[i].Begin == Merged.End)
+			Merged.End = Spans[i++].End;
+		FSegment const& Segment = *Segments[Merged.Segment];
+		Merged.End = std::min(Merged.End, Segment.DataSize);
+		if (Merged.Begin >= Merged.End)
+			continue; // written this session: the OS likely still has it in cache
+		if (Segment.Region)
+			Segment.Region->PreloadHint(Merged.Begin, Merged.End - Merged.Begin);
+		Hinted += Merged.End - Merged.Begin;
+	}
+	return Hinted;
+}
+
+int64 FPackedJsonStore::Compact(int64 const MaxSizeOnDisk)
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	return CompactLocked(MaxSizeOnDisk);
+}
+
+int64 FPackedJsonStore::CompactLocked(int64 const MaxSizeOnDisk)
+{
+	if (!bIsOpen)
+		return 0;
+	// Keep the most recently used records (then the most recently written) that fit the requested size,
+	// including the index
+	// Indices in Records, which are only reordered at the end
+	std::vector<size_t> Live;
+	for (size_t i = 0; i < Records.size(); ++i)
+	{
+		if (Records[i].IsLive())
+			Live.push_back(i);
+	}
+	std::sort(Live.begin(), Live.end(), [this](size_t const A, size_t const B)
+		{
+			FRecord const& RA = Records[A];
+			FRecord const& RB = Records[B];
+			return std::tie(RA.LastUse, Segments[RA.Segment]->Number, RA.Offset)
+				 > std::tie(RB.LastUse, Segments[RB.Segment]->Number, RB.Offset);
+		});
+	int64 Budget = MaxSizeOnDisk - 2 * int64(sizeof(FIndexHeader) + sizeof(uint32));
+	size_t NumKept = 0;
+	for (; NumKept < Live.size(); ++NumKept)
+	{
+		Budget -= Records[Live[NumKept]].TotalSize() + 2 * int64(sizeof(FIndexRecord));
+		if (Budget < 0)
+			break;
+	}
+	for (size_t i = NumKept; i < Live.size(); ++i)
+		Evict(Records[Live[i]].Id);
+	Live.resize(NumKept);
+	// Copy the records in the order they were written, so that the pages of a query remain contiguous
+	std::sort(Live.begin(), Live.end(), [this](size_t const A, size_t const B)
+		{
+			return std::make_pair(Segments[Records[A].Segment]->Number, Records[A].Offset)
+				 < std::make_pair(Segments[Records[B].Segment]->Number, Records[B].Offset);
+		});
+	std::vector<std::unique_ptr<FSegment>> OldSegments;
+	OldSegments.swap(Segments);
+	WriteSegment = -1;
+	std::vector<int64> NewOffsets;
+	NewOffsets.reserve(Live.size());
+	if (!Live.empty())
+	{
+		if (!CreateWriteSegment())
+		{
+			Segments.swap(OldSegments);
+			return GetSizeOnDiskLocked();
+		}
+		FSegment& NewSegment = *Segments[WriteSegment];
+		std::vector<uint8> Buffer;
+		for (size_t const i : Live)
+		{
+			FRecord const& Record = Records[i];
+			Buffer.resize(Record.TotalSize());
+			if (!ReadBytes(*OldSegments[Record.Segment], Record.Offset, Record.TotalSize(), Buffer.data())
+				|| !NewSegment.Writer->Write(Buffer.data(), Buffer.size()))
+			{
+				BE_LOGE("ITwinQuery", "Error compacting cache " << TCHAR_TO_UTF8(*Folder));
+				NewSegment.Writer.Reset();
+				GetPlatformFile().DeleteFile(*NewSegment.Path);
+				Segments.swap(OldSegments);
+				WriteSegment = -1;
+				return GetSizeOnDiskLocked();
+			}
+			NewOffsets.push_back(NewSegment.Size);
+			NewSegment.Size += Record.TotalSize();
+		}
+		// Map the new segment, new records will go to yet another segment
+		NewSegment.Writer->Flush(/*bFullFlush*/true);
+		NewSegment.Writer.Reset();
+		WriteSegment = -1;
+		if (!NewSegment.Map())
+		{
+			BE_LOGE("ITwinQuery", "Error mapping compacted cache " << TCHAR_TO_UTF8(*NewSegment.Path));
+			GetPlatformFile().DeleteFile(*NewSegment.Path);
+			Segments.swap(OldSegments);
+			return GetSizeOnDiskLocked();
+		}
+	}
+	for (size_t i = 0; i < Live.size(); ++i)
+	{
+		Records[Live[i]].Segment = 0;
+		Records[Live[i]].Offset = NewOffsets[i];
+	}
+	// Drop the evicted records, which would otherwise be kept in memory for the whole session
+	std::erase_if(Records, [](FRecord const& Record) { return !Record.IsLive(); });
+	// Old segments are only deleted once the index referencing the new one is committed
+	bIndexDirty = true;
+	CommitLocked();
+	for (auto& Segment : OldSegments)
+	{
+		FString const Path = Segment->Path;
+		Segment.reset(); // unmap before deleting
+		GetPlatformFile().DeleteFile(*Path);
+	}
+	return GetSizeOnDiskLocked();
+}
+
+int64 FPackedJsonStore::GetSizeOnDisk() const
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	return GetSizeOnDiskLocked();
+}
+
+int64 FPackedJsonStore::GetSizeOnDiskLocked() const
+{
+	int64 Size = 2 * IndexSize + JournalSize; // both slots
+	for (auto const& Segment : Segments)
+		Size += Segment->Size;
+	return Size;
+}
+
+int32 FPackedJsonStore::Num() const
+{
+	std::lock_guard<std::mutex> Lock(Mux);
+	return (int32)ByKeyHash.size();
+}
+
+} // ns QueriesCache
@@ -0,0 +1,143 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: PackedJsonStore.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+
+#pragma once
+
+#include <Containers/UnrealString.h>
+#include <HAL/Platform.h>
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace QueriesCache {
+
+/// Packed storage of the replies of a FJsonQueriesCache: instead of one file per reply, which made opening
+/// a large cache (tens of thousands of queries for the metadata of a big iModel) very slow, records are
+/// appended to a few "segment" files read through memory mapping, and an index of the records is loaded
+/// in one go at startup.
+///
+/// Files in the store folder:
+///	- store_NNNNNNNN.dat: segments of records (key + value, with a checksum). Segments are never modified
+///		once written, except by compaction which rewrites the live records in a new segment, then deletes
+///		the old ones. Each session appends to its own segment, so that mapped segments never change.
+///	- store.idx0 and store.idx1: two slots for the index, committed alternately. The index with the
+///		highest generation and a valid checksum is used, so that a crash while committing the index
+///		leaves the previous one intact. The index is only rewritten when the store is opened, closed or
+///		compacted, or when the journal gets larger than the index.
+///	- store.jnl: journal of the records appended since the index was committed, written every few
+///		appends. It is ignored unless its generation matches the index's. Records appended after the
+///		last journal block are recovered by scanning the end of the segments.
+///
+/// Thread-safety: all methods are synchronized with an internal mutex, only held while locating and
+/// copying records, and while compacting.
+class FPackedJsonStore
+{
+public:
+	/// Stable identifier of a record for the whole session, even after compaction (as long as the record
+	/// was not evicted).
+	using FRecordId = uint32;
+
+	FPackedJsonStore();
+	~FPackedJsonStore();
+	FPackedJsonStore(FPackedJsonStore const&) = delete;
+	FPackedJsonStore& operator=(FPackedJsonStore const&) = delete;
+
+	/// Loads the index and maps the segments of a store: the folder must exist.
+	/// \param bCompactIfNeeded Compacts the store when too much of it is dead records or it is split in
+	///		many segments.
+	/// \return false if the folder does not exist.
+	bool Open(FString const& Folder, bool const bCompactIfNeeded = true);
+	/// Commits the index and releases all files.
+	void Close();
+	bool IsOpen() const;
+	/// Tells whether the folder contains a store (ie. at least a segment or an index).
+	[[nodiscard]] static bool Exists(FString const& Folder);
+
+	/// Look up the record for a key, which becomes the most recently used one.
+	[[nodiscard]] std::optional<FRecordId> Find(std::string_view const Key);
+	/// Copies a record's value: returns false if the record was evicted by a compaction.
+	bool Read(FRecordId const Id, std::string& OutValue) const;
+	/// Appends a record, replacing any previous record with the same key.
+	std::optional<FRecordId> Append(std::string_view const Key, std::string_view const Value);
+	/// Writes the full index for the records appended so far (see class comment).
+	bool Commit();
+
+	/// Hints the system to load in memory all the records whose key starts with a given prefix, typically
+	/// the (paginated) replies to a same request, in the order they were written.
+	/// \return Number of bytes hinted.
+	int64 Preload(std::string_view const KeyPrefix) const;
+
+	/// Rewrites the live records in a new segment, dropping the least recently used records if needed to
+	/// fit the requested size.
+	/// \return Size on disk after compaction.
+	int64 Compact(int64 const MaxSizeOnDisk);
+
+	[[nodiscard]] int64 GetSizeOnDisk() const;
+	/// Number of live records.
+	[[nodiscard]] int32 Num() const;
+
+private:
+	struct FSegment;
+	struct FRecord;
+
+	mutable std::mutex Mux;
+	FString Folder;
+	std::vector<std::unique_ptr<FSegment>> Segments;
+	/// Sorted by Id. Evicted records are only removed by compaction.
+	std::vector<FRecord> Records;
+	std::unordered_multimap<uint64, FRecordId> ByKeyHash;
+	/// Segment receiving the records of this session, created on first Append.
+	int32 WriteSegment = -1;
+	uint32 NextSegmentNumber = 0;
+	/// Incremented each time the store is opened, used for LRU eviction of records.
+	uint32 Session = 0;
+	uint64 IndexGeneration = 0;
+	int64 LiveBytes = 0;
+	int64 IndexSize = 0;
+	/// 0 if the journal could not be created.
+	int64 JournalSize = 0;
+	FRecordId NextRecordId = 0;
+	/// First record (if not evicted) neither in the index nor in the journal.
+	FRecordId FirstUnjournaled = 0;
+	int32 AppendsSinceCommit = 0;
+	bool bIsOpen = false;
+	bool bIndexDirty = false;
+
+	void Reset();
+	/// Loads the most recent valid index, and returns the size of each segment covered by it.
+	std::vector<int64> LoadIndex();
+	/// Adds the records of the journal to those of the index, and extends the size of their segment covered
+	/// by the index accordingly.
+	void ReplayJournal(std::vector<int64>& CommittedSizes);
+	void ScanSegment(int32 const SegmentIdx, int64 const From);
+	FRecordId AddRecord(FRecord Record, std::string_view const Key);
+	FRecord const* GetRecord(FRecordId const Id) const;
+	FRecord* GetRecord(FRecordId const Id);
+	void Evict(FRecordId const Id);
+	std::string_view GetKey(FRecord const& Record, std::string& Buffer) const;
+	bool ReadBytes(FSegment const& Segment, int64 const Offset, int64 const Size, uint8* Dest) const;
+	bool CreateWriteSegment();
+	bool CommitLocked();
+	/// Appends the records appended since the last commit to the journal, or commits the index if the
+	/// journal has grown too large.
+	bool JournalLocked();
+	int64 CompactLocked(int64 const MaxSizeOnDisk);
+	int64 GetSizeOnDiskLocked() const;
+};
+
+} // ns QueriesCache
@@ -247,7 +247,7 @@ void FReusableJsonQueries::FImpl::FRequestHandler::CleanUp(
 		// Do not write to cache the result of the initial "RequestSchedules" query which
 		// ProcessJsonResponseFunc actually initializes the cache: this would write duplicates of the
 		// same over and over (since this initial query can never by definition be read from the cache)
-		// which raises a sanity check error in FRecordDirIterator::Visit.
+		// which raises a sanity check error in FRecordDirIterator::ParseFile.
 		// QueryTimestamp's test against -1 skips the Write call: semantically it would seem cleaner
 		// to have this additional test, but it would not work when resetting a corrupted cache because
 		// in that case Initialize has returned false and TryLocalCache is not set...
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Async.h"
 #include "Tasks/Task.h"
 
 #include <ITwinRuntime/Private/Compil/BeforeNonUnrealIncludes.h>
@@ -22,14 +23,46 @@ public:
 	FUETask() {};
 	UE::Tasks::FTask Task_;
 
+	//! State of a main task, run either by the game thread or by Wait when it is called from the game thread.
+	struct FMainTaskState
+	{
+		std::function<void()> Fct;
+		std::atomic<bool> bStarted = false;
+		UE::Tasks::FTaskEvent Done{ UE_SOURCE_LOCATION };
+
+		//! Runs the functor unless it was already started.
+		bool TryRun()
+		{
+			if (bStarted.exchange(true))
+				return false;
+			Fct();
+			Done.Trigger();
+			return true;
+		}
+	};
+	std::shared_ptr<FMainTaskState> MainTask_;
+
 	bool IsCompleted() override  { return Task_.IsCompleted(); }
-	void Wait() override { Task_.Wait(); }
+	void Wait() override
+	{
+		if (MainTask_ && IsInGameThread())
+		{
+			// Blocking would prevent the game thread from ever running the task: run it now instead.
+			if (!MainTask_->TryRun() && !MainTask_->Done.IsCompleted())
+			{
+				ensureMsgf(false, TEXT("A main task cannot be waited for from within itself"));
+				return;
+			}
+		}
+		Task_.Wait();
+	}
 };
 
 class FUETaskManager : public AdvViz::SDK::Tools::TaskManager, AdvViz::SDK::Tools::TypeId<FUETaskManager>
 {
 public:
-	FUETaskManager() {};
+	// Tasks are scheduled by Unreal: no need for the workers of the default SDK implementation.
+	FUETaskManager() : AdvViz::SDK::Tools::TaskManager(0) {};
 	static void Init()
 	{
 		AdvViz::SDK::Tools::TaskManager::SetNewFct([]() {
@@ -73,7 +106,26 @@ public:
 	std::shared_ptr<AdvViz::SDK::Tools::ITask> AddTask(const std::function<void()>& fct, EType type, EPriority priority)
 	{
 		FUETask* p = new FUETask();
-		p->Task_ = UE::Tasks::Launch(UE_SOURCE_LOCATION, [fct]() {fct();}, GetUETaskPriority(type, priority));
+		if (type == EType::main && IsInGameThread())
+		{
+			// Already on the game thread: run it now, the (default) returned task is completed.
+			fct();
+		}
+		else if (type == EType::main)
+		{
+			// Main tasks are run by the game thread: the returned task completes once it has run.
+			p->MainTask_ = std::make_shared<FUETask::FMainTaskState>();
+			p->MainTask_->Fct = fct;
+			AsyncTask(ENamedThreads::GameThread, [MainTask = p->MainTask_]()
+			{
+				MainTask->TryRun();
+			});
+			p->Task_ = UE::Tasks::Launch(UE_SOURCE_LOCATION, []() {}, UE::Tasks::Prerequisites(p->MainTask_->Done));
+		}
+		else
+		{
+			p->Task_ = UE::Tasks::Launch(UE_SOURCE_LOCATION, [fct]() {fct();}, GetUETaskPriority(type, priority));
+		}
 		return std::shared_ptr<AdvViz::SDK::Tools::ITask>(static_cast<AdvViz::SDK::Tools::ITask*>(p));
 	}
 
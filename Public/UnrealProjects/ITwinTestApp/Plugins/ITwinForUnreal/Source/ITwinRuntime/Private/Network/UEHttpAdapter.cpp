@@ -103,16 +103,18 @@ AdvViz::SDK::Http::Response ConvertUnrealHttpResponse(
 	if (connectedSuccessfully && UEResponse.IsValid())
 	{
 		Response.first = UEResponse->GetResponseCode();
-		Response.second = TCHAR_TO_UTF8(*UEResponse->GetContentAsString());
-		if (SDKRequestPtr && SDKRequestPtr->NeedRawData() && UEResponse->GetContentLength() > 0)
+		// Binary content (keyframes...) is corrupted by the conversion to string: always provide it as
+		// raw data only, without paying for a useless (and potentially large) conversion.
+		const bool bIsBinaryContent = UEResponse->GetContentType().StartsWith(TEXT("application/octet-stream"));
+		if (!bIsBinaryContent)
+		{
+			Response.second = TCHAR_TO_UTF8(*UEResponse->GetContentAsString());
+		}
+		if (((SDKRequestPtr && SDKRequestPtr->NeedRawData()) || bIsBinaryContent) && UEResponse->GetContentLength() > 0)
 		{
 			// In case we receive some binary data, we may want to get it and not just a (truncated) string...
 			const TArray<uint8>& content = UEResponse->GetContent();
-			Response.rawdata_ = std::make_shared<AdvViz::SDK::Http::RawData>();
-			AdvViz::SDK::Http::RawData& rawdata(*Response.rawdata_);
-			rawdata.reserve(content.Num());
-			for (uint8 b : content)
-				rawdata.push_back(b);
+			Response.rawdata_ = std::make_shared<AdvViz::SDK::Http::RawData>(content.GetData(), content.GetData() + content.Num());
 		}
 		if (Response.first != 0)
 		{
@@ -17,6 +17,7 @@
 #include <Engine/LocalPlayer.h>
 #include <Engine/World.h>
 #include <Engine/Engine.h>
+#include <Misc/App.h>
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include <SceneView.h>
@@ -72,6 +73,8 @@ public:
 struct AITwinKeyframePath::FImpl
 {
 	float time_ = 0.0f;
+	//! Animation seconds per real second during the last tick (0 when the time is frozen).
+	float playbackRate_ = 0.0f;
 	float nextTimeStep;
 	std::shared_ptr<AdvViz::SDK::IKeyframeAnimator> keyframeAnimator;
 	ALevelBounds* LevelBounds_ = nullptr;
@@ -192,6 +195,10 @@ void AITwinKeyframePath::Tick(float DeltaTime)
 	Super::Tick(DeltaTime);
 	if(!FreezeTime)
 		Impl->time_ += DeltaTime;
+	// DeltaTime includes the time dilation, unlike the application delta time.
+	const double RealDeltaTime = FApp::GetDeltaTime();
+	Impl->playbackRate_ = (FreezeTime || RealDeltaTime <= 0.)
+		? 0.f : static_cast<float>(DeltaTime / RealDeltaTime);
 
 	if (Impl->time_ > LoopTime)
 	{
@@ -288,6 +295,7 @@ void AITwinKeyframePath::Tick(float DeltaTime)
 			}
 		}
 
+		Impl->keyframeAnimator->SetPlaybackSpeed(Impl->playbackRate_);
 		Impl->keyframeAnimator->Process(Impl->time_, Impl->boundingBoxes_, bCameraMove);
 	}
 
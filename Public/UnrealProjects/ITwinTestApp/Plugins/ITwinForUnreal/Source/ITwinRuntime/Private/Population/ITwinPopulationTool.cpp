@@ -138,9 +138,13 @@ glm::dvec3 FUESplineCurve::GetTangentAtCoord(value_type const& u) const
 	};
 }
 
-size_t FUESplineCurve::PointCount(const bool /*accountForCyclicity*/) const
+size_t FUESplineCurve::PointCount(const bool accountForCyclicity) const
 {
-	return static_cast<size_t>(UESpline.GetNumberOfSplinePoints());
+	size_t const NumPoints = static_cast<size_t>(UESpline.GetNumberOfSplinePoints());
+	// For a closed loop, the first point also ends the last segment.
+	if (accountForCyclicity && NumPoints > 0 && IsCyclic())
+		return NumPoints + 1;
+	return NumPoints;
 }
 
 glm::dvec3 FUESplineCurve::GetPositionAtIndex(size_t idx) const
@@ -1730,8 +1734,6 @@ uint32 AITwinPopulationTool::FImpl::PopulateSpline(AITwinSplineHelper const& Tar
 		Population->RemoveAllInstances();
 	}
 
-	FUESplineCurve const Curve(*TargetSpline.GetSplineComponent());
-
 	BeUtils::SplineSamplingParameters SamplingParams;
 	SamplingParams.samplingMode = (TargetSpline.GetUsage() == EITwinSplineUsage::PopulationZone)
 		? BeUtils::ESplineSamplingMode::Interior
@@ -1739,7 +1741,7 @@ uint32 AITwinPopulationTool::FImpl::PopulateSpline(AITwinSplineHelper const& Tar
 	//SamplingParams.fixedNbInstances = 10;
 	//SamplingParams.fixedSpacing = glm::dvec2(5. * 100); // 5m
 
-	// The transformation to world is "baked" in FUESplineCurve.
+	// The transformation to world is "baked" in FUESplineCurve, which the sampling helper is based on.
 	BeUtils::TransformHolder const IdentityTsf;
 
 	FVector SplineOrigin, SplineExtent;
@@ -1764,7 +1766,7 @@ uint32 AITwinPopulationTool::FImpl::PopulateSpline(AITwinSplineHelper const& Tar
 	glm::dvec3 const AverageInstanceDims = AccumBBoxDims / (double)EditedPopulationsActors.size();
 
 	std::vector<glm::dvec3> Positions;
-	BeUtils::SampleSpline(Curve, IdentityTsf, SamplingBox, AverageInstanceDims, SamplingParams, Positions);
+	BeUtils::SampleSpline(TargetSpline.GetSamplingHelper(), IdentityTsf, SamplingBox, AverageInstanceDims, SamplingParams, Positions);
 
 	if (Positions.empty())
 		return 0;
@@ -20,9 +20,11 @@
 #include <GameFramework/PlayerController.h>
 #include <IncludeCesium3DTileset.h>
 #include <ITwinTilesetAccess.h>
+#include <Population/ITwinPopulationTool.h>
 
 #include <Compil/BeforeNonUnrealIncludes.h>
 #	include <BeHeaders/Compil/EnumSwitchCoverage.h>
+#	include <BeUtils/SplineSampling/SplineHelper.h>
 #	include <SDK/Core/Tools/Assert.h>
 #	include <SDK/Core/Visualization/Spline.h>
 #include <Compil/AfterNonUnrealIncludes.h>
@@ -97,6 +99,16 @@ struct AITwinSplineHelper::FImpl
 		bool bNeedUpdateTracingData = true;
 	};
 	mutable FTracingData TracingData;
+
+	struct FSamplingData
+	{
+		/// Spline component seen as a BeUtils curve (in world coordinates).
+		TUniquePtr<FUESplineCurve> Curve;
+
+		/// Helper caching the arc-length tables of the curve, used to populate the spline.
+		TUniquePtr<BeUtils::SplineHelper> Helper;
+	};
+	mutable FSamplingData SamplingData;
 	bool bSelected = false;
 	int32 SelectedPointIndex = -1;
 
@@ -195,6 +207,10 @@ struct AITwinSplineHelper::FImpl
 	void InvalidateTracingData() { TracingData.bNeedUpdateTracingData = true; }
 	bool DoesLineIntersectSplinePolygon(const FVector& Start, const FVector& End) const;
 
+	BeUtils::SplineHelper const& GetSamplingHelper() const;
+	void InvalidateSamplingData();
+	void OnSplinePointMoved(int32 pointIndex);
+
 	FVector const& GetBarycenter() const {
 		if (TracingData.bNeedUpdateTracingData)
 			UpdateTracingData();
@@ -241,6 +257,8 @@ void AITwinSplineHelper::FImpl::Initialize(
 
 	Owner.SplineComponent = splineComp;
 	Spline = splinePtr2;
+	SamplingData.Helper.Reset();
+	SamplingData.Curve.Reset();
 
 	size_t numberOfPoints = 0;
 	int32 numberOfSplinePoints = 0;
@@ -397,6 +415,7 @@ void AITwinSplineHelper::FImpl::UpdateSplineFromAVizToUE()
 	}
 
 	InvalidateTracingData();
+	InvalidateSamplingData();
 
 	// Update tangent mode
 	bool isSameModeForAllPoints = true;
@@ -617,6 +636,7 @@ void AITwinSplineHelper::FImpl::SetTangentMode(const EITwinTangentMode mode)
 	}
 
 	SplineComp.UpdateSpline();
+	InvalidateSamplingData();
 
 	UpdateSplineFromUEtoAViz();
 
@@ -630,6 +650,8 @@ void AITwinSplineHelper::FImpl::SetTransform(const FTransform& NewTransform, boo
 		Polygon.SetActorTransform(NewTransform);
 	});
 	InvalidateTracingData();
+	// The sampled curve is expressed in world coordinates.
+	InvalidateSamplingData();
 
 	if (Spline)
 	{
@@ -710,6 +732,7 @@ void AITwinSplineHelper::FImpl::SetLocationAtSplinePoint(int32 pointIndex, const
 
 	InvalidateTracingData();
 	SplineComp.UpdateSpline();
+	OnSplinePointMoved(pointIndex);
 
 	// Update the AdvViz::SDK spline (for the saving of points)
 	if (Spline)
@@ -874,6 +897,7 @@ void AITwinSplineHelper::FImpl::DeletePoint(int32 pointIndex)
 		UpdateMeshComponentsForPoint(ITwinSpline::GetPrevIndex(prevPointIndex, numPoints, isLoop));
 	}
 	InvalidateTracingData();
+	InvalidateSamplingData();
 }
 
 void AITwinSplineHelper::FImpl::DuplicatePoint(int32 pointIndex)
@@ -894,6 +918,7 @@ void AITwinSplineHelper::FImpl::DuplicatePoint(int32 pointIndex)
 	SplineComp.SetTangentsAtSplinePoint(pointIndex, arriveTangent, FVector(0), SPL_LOCAL, false);
 	SplineComp.SetTangentsAtSplinePoint(pointIndex + 1, FVector(0), leaveTangent, SPL_LOCAL, false);
 	SplineComp.UpdateSpline();
+	InvalidateSamplingData();
 	AddMeshComponentsForPoint(pointIndex);
 
 	CHECK_NUMBER_OF_SPLINE_MESH_COMPONENTS();
@@ -1032,6 +1057,8 @@ void AITwinSplineHelper::FImpl::SetClosedLoop(bool bInClosedLoop, bool bUpdateSp
 
 	if (bPropertyChanged)
 	{
+		InvalidateSamplingData();
+
 		// Add or remove the last segment, depending on the new closed loop state
 		const int32 NbSplinePoints = Owner.GetNumberOfSplinePoints();
 		if (bInClosedLoop && ensure(Owner.SplineMeshComponents.Num() == NbSplinePoints - 1))
@@ -1130,6 +1157,35 @@ void AITwinSplineHelper::FImpl::InsertPointInSecondaryCartographicPolygons(int32
 	}
 }
 
+BeUtils::SplineHelper const& AITwinSplineHelper::FImpl::GetSamplingHelper() const
+{
+	check(Owner.SplineComponent);
+	if (!SamplingData.Helper)
+	{
+		SamplingData.Curve = MakeUnique<FUESplineCurve>(*Owner.SplineComponent);
+		SamplingData.Helper = MakeUnique<BeUtils::SplineHelper>(SamplingData.Curve.Get());
+	}
+	return *SamplingData.Helper;
+}
+
+void AITwinSplineHelper::FImpl::InvalidateSamplingData()
+{
+	if (SamplingData.Helper)
+	{
+		SamplingData.Helper->InvalidateCache();
+	}
+}
+
+void AITwinSplineHelper::FImpl::OnSplinePointMoved(int32 pointIndex)
+{
+	// Only the spans around the moved point (whose tangents may have been recomputed as well) need to be
+	// sampled again.
+	if (SamplingData.Helper && ensure(pointIndex >= 0))
+	{
+		SamplingData.Helper->OnControlPointMoved(static_cast<size_t>(pointIndex));
+	}
+}
+
 void AITwinSplineHelper::FImpl::UpdateTracingData() const
 {
 	FPoly& Polygon = TracingData.SplinePolygon;
@@ -1568,6 +1624,11 @@ void AITwinSplineHelper::SetTransformFromUserInteraction(const FTransform& NewTr
 	SetTransform(FinalTransform, true);
 }
 
+BeUtils::SplineHelper const& AITwinSplineHelper::GetSamplingHelper() const
+{
+	return Impl->GetSamplingHelper();
+}
+
 FVector AITwinSplineHelper::GetLocationAtSplinePoint(int32 pointIndex) const
 {
 	return Impl->GetLocationAtSplinePoint(pointIndex);
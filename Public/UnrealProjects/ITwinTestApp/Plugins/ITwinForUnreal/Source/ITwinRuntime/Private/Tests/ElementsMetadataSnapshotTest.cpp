@@ -0,0 +1,120 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: ElementsMetadataSnapshotTest.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <CoreMinimal.h>
+#include <Dom/JsonObject.h>
+#include <HAL/FileManager.h>
+#include <Misc/AutomationTest.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+#include <Serialization/JsonReader.h>
+#include <Serialization/JsonSerializer.h>
+
+#include <ITwinSceneMapping.h>
+#include <Network/ElementsMetadataSnapshot.h>
+
+#ifdef WITH_TESTS
+
+namespace ITwin::ElementsMetadataSnapshotTest {
+
+/// Rows in the same format as the replies to the combined ECSQL query for Elements metadata
+const TCHAR* JsonReply = TEXT(R"json({"data":[
+	["0x10", {"X":0,"Y":0,"Z":0}, {"X":10,"Y":20,"Z":30}, null, "0c7bda36-5de8-4b6b-9e80-3ba2a1e2ee3f", "src-A"],
+	["0x11", {"X":1,"Y":1,"Z":1}, {"X":2,"Y":2,"Z":2}, "0x10", "", "src-B"],
+	["0x12", null, null, "0x10", "7a1a4cb4-8e5f-4d26-bc9b-6b4e6b0e31c2", ""],
+	["0x13", {"X":5,"Y":5,"Z":5}, {"X":5,"Y":5,"Z":5}, "0x11", "not-a-guid", "src-B"]
+]})json");
+
+bool Equals(FITwinElementMetadata const& A, FITwinElementMetadata const& B)
+{
+	return A.ElementID == B.ElementID && A.ParentID == B.ParentID
+		&& A.BBox.has_value() == B.BBox.has_value() && (!A.BBox || A.BBox->Equals(*B.BBox))
+		&& A.FederationGuid == B.FederationGuid && A.SourceElementID == B.SourceElementID;
+}
+
+} // namespace ITwin::ElementsMetadataSnapshotTest
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FElementsMetadataSnapshotTest,
+	"Bentley.ITwinForUnreal.ITwinRuntime.ElementsMetadataSnapshot",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FElementsMetadataSnapshotTest::RunTest(const FString& /*Parameters*/)
+{
+	using namespace ITwin::ElementsMetadataSnapshotTest;
+	using QueriesCache::FElementsMetadataSnapshot;
+
+	TSharedPtr<FJsonObject> JsonObj;
+	UTEST_TRUE("Parse reply", FJsonSerializer::Deserialize(TJsonReaderFactory<TCHAR>::Create(JsonReply), JsonObj));
+	std::vector<FITwinElementMetadata> Metadata;
+	UTEST_EQUAL("Extracted", FITwinSceneMapping::ExtractIModelMetadata(JsonObj->GetArrayField(TEXT("data")),
+																		Metadata), 4);
+	UTEST_EQUAL("Rows", (int)Metadata.size(), 4);
+	UTEST_TRUE("BBox", Metadata[0].BBox.has_value() && Metadata[0].BBox->Max == FVector(10, 20, 30));
+	UTEST_FALSE("No BBox", Metadata[2].BBox.has_value());
+	UTEST_FALSE("Empty BBox", Metadata[3].BBox.has_value());
+	UTEST_TRUE("No parent", Metadata[0].ParentID == ITwin::NOT_ELEMENT);
+	UTEST_TRUE("Parent", Metadata[3].ParentID == ITwinElementID(0x11));
+	UTEST_TRUE("Federation GUID", Metadata[0].FederationGuid.has_value());
+	UTEST_FALSE("Empty Federation GUID", Metadata[1].FederationGuid.has_value());
+	UTEST_FALSE("Invalid Federation GUID", Metadata[3].FederationGuid.has_value());
+	UTEST_EQUAL("Source Element ID", Metadata[1].SourceElementID, FString(TEXT("src-B")));
+
+	// Encode in two batches, like two pages of the query
+	FElementsMetadataSnapshot Snapshot;
+	TArray<uint8> Encoded;
+	std::vector<FITwinElementMetadata> const FirstPage(Metadata.begin(), Metadata.begin() + 1);
+	std::vector<FITwinElementMetadata> const SecondPage(Metadata.begin() + 1, Metadata.end());
+	FElementsMetadataSnapshot::EncodeMetadata(FirstPage, Encoded);
+	Snapshot.AppendMetadata(Encoded, (int32)FirstPage.size());
+	Encoded.Reset();
+	FElementsMetadataSnapshot::EncodeMetadata(SecondPage, Encoded);
+	Snapshot.AppendMetadata(Encoded, (int32)SecondPage.size());
+	Snapshot.AppendConstructionDetailingParentIDs({ ITwinElementID(0x11) });
+	UTEST_EQUAL("Num", Snapshot.NumElements(), 4);
+
+	FString const Folder = FPaths::ConvertRelativePathToFull(
+		FPaths::ProjectIntermediateDir() / TEXT("ElementsMetadataSnapshotTests"));
+	IFileManager::Get().MakeDirectory(*Folder, /*recurse*/true);
+	FString const Path = Folder / FElementsMetadataSnapshot::FileName;
+	UTEST_TRUE("Save", Snapshot.Save(Path));
+	std::vector<FITwinElementMetadata> Loaded;
+	std::vector<ITwinElementID> ParentIDs;
+	UTEST_TRUE("Load", FElementsMetadataSnapshot::Load(Path, Loaded, ParentIDs));
+	UTEST_EQUAL("Loaded all", (int)Loaded.size(), (int)Metadata.size());
+	for (size_t i = 0; i < Metadata.size(); ++i)
+		UTEST_TRUE("Same metadata", Equals(Loaded[i], Metadata[i]));
+	UTEST_TRUE("Same parent IDs", ParentIDs.size() == 1 && ParentIDs[0] == ITwinElementID(0x11));
+
+	// Loading the snapshot or parsing the rows must give the same scene mapping
+	FITwinSceneMapping FromRows(false), FromSnapshot(false);
+	UTEST_EQUAL("Applied rows", FromRows.ApplyIModelMetadata(Metadata), 4);
+	UTEST_EQUAL("Applied snapshot", FromSnapshot.ApplyIModelMetadata(Loaded), 4);
+	for (FITwinSceneMapping const* SceneMapping : { &FromRows, &FromSnapshot })
+	{
+		UTEST_EQUAL("Elements", (int)SceneMapping->NumElements(), 4);
+		FITwinElement const& Root = SceneMapping->GetElement(ITwinElementID(0x10));
+		UTEST_EQUAL("Children", (int)Root.SubElemsInVec.size(), 2);
+		ITwinElementID FoundID = ITwin::NOT_ELEMENT;
+		UTEST_TRUE("GUID", SceneMapping->FindElementIDForGUID(*Metadata[2].FederationGuid, FoundID)
+			&& FoundID == ITwinElementID(0x12));
+		UTEST_EQUAL("Duplicate source IDs",
+			(int)SceneMapping->GetDuplicateElements(ITwinElementID(0x13)).size(), 2);
+	}
+
+	// A corrupted snapshot is rejected
+	TArray<uint8> Bytes;
+	UTEST_TRUE("Read back", FFileHelper::LoadFileToArray(Bytes, *Path));
+	Bytes[Bytes.Num() / 2] ^= 0xFF;
+	UTEST_TRUE("Write corrupted", FFileHelper::SaveArrayToFile(Bytes, *Path));
+	UTEST_FALSE("Corrupted", FElementsMetadataSnapshot::Load(Path, Loaded, ParentIDs));
+	UTEST_TRUE("Nothing loaded", Loaded.empty() && ParentIDs.empty());
+	UTEST_FALSE("Missing", FElementsMetadataSnapshot::Load(Folder / TEXT("none.bin"), Loaded, ParentIDs));
+	IFileManager::Get().DeleteDirectory(*Folder, /*requireExists*/false, /*recurse*/true);
+	return true;
+}
+
+#endif // WITH_TESTS
@@ -0,0 +1,209 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: PackedJsonStoreTest.cpp $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#include <CoreMinimal.h>
+#include <HAL/FileManager.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/AutomationTest.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+
+#include <Network/JsonQueriesCacheInit.h>
+#include <Network/PackedJsonStore.h>
+
+#include <string>
+
+#ifdef WITH_TESTS
+
+namespace ITwin::PackedJsonStoreTest {
+
+FString GetTestFolder(const TCHAR* SubFolder)
+{
+	FString const Folder = FPaths::ConvertRelativePathToFull(
+		FPaths::ProjectIntermediateDir() / TEXT("PackedJsonStoreTests") / SubFolder);
+	IFileManager::Get().DeleteDirectory(*Folder, /*requireExists*/false, /*recurse*/true);
+	IFileManager::Get().MakeDirectory(*Folder, /*recurse*/true);
+	return Folder;
+}
+
+/// Keys and values like those of the paginated ECSQL queries for iModel metadata.
+std::string MakeKey(int const Page)
+{
+	return "POST https://api.bentley.com/imodels/query\n{\"query\":\"SELECT ...\",\"offset\":"
+		+ std::to_string(Page) + "}";
+}
+
+std::string MakeValue(int const Page, int const Size)
+{
+	std::string Value = "{\"data\":[";
+	while ((int)Value.size() < Size)
+		Value += "[\"0x" + std::to_string(Page) + "\",1.5,-2.25,\"" + std::to_string(Value.size()) + "\"],";
+	Value.back() = ']';
+	return Value + "}";
+}
+
+} // namespace ITwin::PackedJsonStoreTest
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPackedJsonStoreTest, "Bentley.ITwinForUnreal.ITwinRuntime.PackedJsonStore",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+bool FPackedJsonStoreTest::RunTest(const FString& /*Parameters*/)
+{
+	using namespace ITwin::PackedJsonStoreTest;
+	using QueriesCache::FPackedJsonStore;
+	FString const Folder = GetTestFolder(TEXT("Basics"));
+	constexpr int NumRecords = 300;
+	std::string Value;
+	{
+		FPackedJsonStore Store;
+		UTEST_TRUE("Open", Store.Open(Folder));
+		UTEST_EQUAL("Empty", Store.Num(), 0);
+		for (int i = 0; i < NumRecords; ++i)
+			UTEST_TRUE("Append", Store.Append(MakeKey(i), MakeValue(i, 100 + i)).has_value());
+		// Records of the current session are read back from the segment being written
+		auto const Id = Store.Find(MakeKey(42));
+		UTEST_TRUE("Found", Id.has_value() && Store.Read(*Id, Value));
+		UTEST_TRUE("Same value", Value == MakeValue(42, 142));
+		UTEST_FALSE("Unknown key", Store.Find("GET https://api.bentley.com/").has_value());
+		Store.Append(MakeKey(7), "{}");
+		UTEST_EQUAL("Replaced", Store.Num(), NumRecords);
+	}
+	{
+		FPackedJsonStore Store;
+		UTEST_TRUE("Reopen", Store.Open(Folder));
+		UTEST_EQUAL("Reloaded", Store.Num(), NumRecords);
+		for (int i = 0; i < NumRecords; ++i)
+		{
+			auto const Id = Store.Find(MakeKey(i));
+			UTEST_TRUE("Found", Id.has_value() && Store.Read(*Id, Value));
+			UTEST_TRUE("Same value", Value == ((i == 7) ? std::string("{}") : MakeValue(i, 100 + i)));
+		}
+		UTEST_TRUE("Preload", Store.Preload("POST https://api.bentley.com/imodels/query\n") > 0);
+		UTEST_EQUAL("Preload nothing", Store.Preload("GET "), 0);
+	}
+	// Lost index and partially written record, as if the application had crashed
+	IFileManager::Get().Delete(*(Folder / TEXT("store.idx0")));
+	IFileManager::Get().Delete(*(Folder / TEXT("store.idx1")));
+	TArray<FString> Segments;
+	IFileManager::Get().FindFiles(Segments, *(Folder / TEXT("store_*.dat")), true, false);
+	UTEST_FALSE("Has segments", Segments.IsEmpty());
+	{
+		TArray<uint8> Garbage;
+		Garbage.Init(0x2A, 11);
+		FFileHelper::SaveArrayToFile(Garbage, *(Folder / Segments.Last()), &IFileManager::Get(),
+			FILEWRITE_Append);
+	}
+	{
+		FPackedJsonStore Store;
+		UTEST_TRUE("Open after crash", Store.Open(Folder));
+		UTEST_EQUAL("Recovered", Store.Num(), NumRecords);
+		auto const Id = Store.Find(MakeKey(NumRecords - 1));
+		UTEST_TRUE("Found", Id.has_value() && Store.Read(*Id, Value));
+		UTEST_TRUE("Same value", Value == MakeValue(NumRecords - 1, 100 + NumRecords - 1));
+	}
+	// LRU compaction: the records used in the latest session should be kept first
+	{
+		FPackedJsonStore Store;
+		UTEST_TRUE("Open", Store.Open(Folder));
+		int64 const SizeBefore = Store.GetSizeOnDisk();
+		std::optional<FPackedJsonStore::FRecordId> RecentlyUsed;
+		for (int i = 0; i < 10; ++i)
+			RecentlyUsed = Store.Find(MakeKey(i));
+		Store.Append("GET https://api.bentley.com/new", "{\"new\":true}");
+		int64 const SizeAfter = Store.Compact(SizeBefore / 10);
+		UTEST_TRUE("Compacted", SizeAfter <= SizeBefore / 10);
+		UTEST_TRUE("Ids are stable", RecentlyUsed.has_value() && Store.Read(*RecentlyUsed, Value));
+		UTEST_TRUE("Same value", Value == MakeValue(9, 109));
+		for (int i = 0; i < 10; ++i)
+			UTEST_TRUE("Recently used record kept", Store.Find(MakeKey(i)).has_value());
+		UTEST_TRUE("New record kept", Store.Find("GET https://api.bentley.com/new").has_value());
+		UTEST_FALSE("Old record evicted", Store.Find(MakeKey(NumRecords / 2)).has_value());
+		int32 const NumKept = Store.Num();
+		Store.Close();
+		UTEST_TRUE("Open", Store.Open(Folder));
+		UTEST_EQUAL("Same records", Store.Num(), NumKept);
+		UTEST_TRUE("Everything compacted", Store.Compact(0) < 100);
+		UTEST_EQUAL("Nothing left", Store.Num(), 0);
+	}
+	IFileManager::Get().DeleteDirectory(*Folder, /*requireExists*/false, /*recurse*/true);
+	return true;
+}
+
+/// Compares the time needed to open a cache and read all its replies, between the former layout (one file
+/// per reply) and the packed store.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPackedJsonStorePerfTest,
+	"Bentley.ITwinForUnreal.ITwinRuntime.PackedJsonStorePerf",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FPackedJsonStorePerfTest::RunTest(const FString& /*Parameters*/)
+{
+	using namespace ITwin::PackedJsonStoreTest;
+	using QueriesCache::FPackedJsonStore;
+	constexpr int NumRecords = 20'000;
+	constexpr int ValueSize = 4096;
+	FString const FilesFolder = GetTestFolder(TEXT("PerfFiles"));
+	FString const StoreFolder = GetTestFolder(TEXT("PerfStore"));
+	{
+		FPackedJsonStore Store;
+		UTEST_TRUE("Open", Store.Open(StoreFolder));
+		for (int i = 0; i < NumRecords; ++i)
+		{
+			std::string const Value = MakeValue(i, ValueSize);
+			Store.Append(MakeKey(i), Value);
+			// Same format as FJsonQueriesCache used to write
+			FString const Payload = FString::Printf(TEXT("{\\\"query\\\":\\\"SELECT ...\\\",\\\"offset\\\":%d}"), i);
+			FString const File = FString::Printf(TEXT("{\n\t\"url\": \"https://api.bentley.com/imodels/query\",\n"
+				"\t\"verb\": \"POST\",\n\t\"payload\": \"%s\",\n\t\"connectedSuccessfully\": true,\n"
+				"\t\"responseCode\": 200,\n\t\"reply\": \n%s\n}"), *Payload, UTF8_TO_TCHAR(Value.c_str()));
+			FFileHelper::SaveStringToFile(File, *(FilesFolder / FString::Printf(TEXT("%08d.json"), i)),
+				FFileHelper::EEncodingOptions::ForceUTF8);
+		}
+	}
+
+	double StartTime = FPlatformTime::Seconds();
+	QueriesCache::FSessionMap SessionMap;
+	FString ParseError;
+	int RecorderTimestamp = 0;
+	QueriesCache::FRecordDirIterator DirIter(SessionMap, nullptr, ParseError, &RecorderTimestamp);
+	UTEST_TRUE("Iterate files", IFileManager::Get().IterateDirectory(*FilesFolder, DirIter));
+	UTEST_TRUE("Parse files", DirIter.ParseFiles());
+	double const FilesOpenTime = FPlatformTime::Seconds() - StartTime;
+	int64 FilesBytes = 0;
+	for (auto const& [Key, ReplyPath] : SessionMap)
+	{
+		FString Content;
+		FFileHelper::LoadFileToString(Content, *ReplyPath);
+		FilesBytes += Content.Len();
+	}
+	double const FilesTime = FPlatformTime::Seconds() - StartTime;
+	UTEST_EQUAL("All files", (int)SessionMap.size(), NumRecords);
+
+	StartTime = FPlatformTime::Seconds();
+	FPackedJsonStore Store;
+	UTEST_TRUE("Open", Store.Open(StoreFolder));
+	double const StoreOpenTime = FPlatformTime::Seconds() - StartTime;
+	Store.Preload("POST https://api.bentley.com/imodels/query\n");
+	int64 StoreBytes = 0;
+	std::string Value;
+	for (int i = 0; i < NumRecords; ++i)
+	{
+		if (auto const Id = Store.Find(MakeKey(i)); Id && Store.Read(*Id, Value))
+			StoreBytes += (int64)Value.size();
+	}
+	double const StoreTime = FPlatformTime::Seconds() - StartTime;
+	UTEST_EQUAL("All records", Store.Num(), NumRecords);
+	UTEST_TRUE("Read everything", StoreBytes >= int64(NumRecords) * ValueSize);
+
+	AddInfo(FString::Printf(TEXT("Warm start with %d replies: one file per reply %.3fs (opening %.3fs, %lld "
+		"chars), packed store %.3fs (opening %.3fs, %lld bytes)"), NumRecords, FilesTime, FilesOpenTime,
+		(long long)FilesBytes, StoreTime, StoreOpenTime, (long long)StoreBytes));
+	Store.Close();
+	IFileManager::Get().DeleteDirectory(*FilesFolder, /*requireExists*/false, /*recurse*/true);
+	IFileManager::Get().DeleteDirectory(*StoreFolder, /*requireExists*/false, /*recurse*/true);
+	return true;
+}
+
+#endif // WITH_TESTS
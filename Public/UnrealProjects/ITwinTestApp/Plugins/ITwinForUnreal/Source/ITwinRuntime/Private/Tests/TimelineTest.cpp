@@ -9,13 +9,17 @@
 // From vue.git/viewer/Code/Tools/UnitTests/ScheduleTests.cpp
 
 #include <CoreMinimal.h>
+#include <Math/RandomStream.h>
 #include <Math/Vector.h>
+#include <HAL/PlatformTime.h>
 #include <Misc/AutomationTest.h>
 #include <Misc/LowLevelTestAdapter.h>
 
 #include <Hashing/UnrealMath.h>
 #include <Timeline/Definition.h>
 
+#include <set>
+
 #ifdef WITH_TESTS
 
 namespace ITwin::Timeline {
@@ -481,6 +485,122 @@ void MainTimelineAddSpec::Define()
 		});
 }
 
+namespace ITwin::Timeline {
+
+/// Former implementation of PropertyTimeline::GetStateAtTime's keyframe lookup, on a std::set, used as
+/// reference in the test below: returns the index of the first keyframe not before time.
+template<class _Entry>
+size_t SetBasedLowerBound(std::set<_Entry> const& Entries, double const time)
+{
+	return std::distance(Entries.cbegin(), std::lower_bound(Entries.cbegin(), Entries.cend(), time,
+		[](const auto& x, double y) { return x.Time < y; }));
+}
+
+} // namespace ITwin::Timeline
+
+/// Compares the flat keyframe storage of PropertyTimeline with the std::set it replaced, on a timeline with
+/// many keyframes, and checks that lookups (with and without the help of the cursor) give the same results.
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTimelineLookupPerfTest, "Bentley.ITwinForUnreal.ITwinRuntime.TimelinePerf",
+	EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+bool FTimelineLookupPerfTest::RunTest(const FString& /*Parameters*/)
+{
+	using namespace ITwin::Timeline;
+	constexpr int NumKeyframes = 100'000;
+	PropertyTimeline<Test_Visibility> Timeline;
+	std::set<PropertyEntry<Test_Visibility>> SetBased;
+	FRandomStream Random(42);
+	std::vector<PropertyEntry<Test_Visibility>> Entries(NumKeyframes);
+	for (int i = 0; i < NumKeyframes; ++i)
+	{
+		// Shuffled times, since there is no guarantee keyframes are added in chronological order.
+		Entries[i].Time = (i * 7919) % NumKeyframes;
+		Entries[i].Interpolation = EInterpolation::Linear;
+		Entries[i].test_value_ = Random.FRand();
+	}
+	double StartTime = FPlatformTime::Seconds();
+	for (auto const& Entry : Entries)
+		Timeline.Values.insert(Entry);
+	// Out of order entries are merged on the first read access.
+	UTEST_EQUAL("Keyframe count", Timeline.Values.size(), size_t(NumKeyframes));
+	double const FlatInsertTime = FPlatformTime::Seconds() - StartTime;
+	StartTime = FPlatformTime::Seconds();
+	for (auto const& Entry : Entries)
+		SetBased.insert(Entry);
+	double const SetInsertTime = FPlatformTime::Seconds() - StartTime;
+	UTEST_EQUAL("Same keyframe count", Timeline.Values.size(), SetBased.size());
+	AddInfo(FString::Printf(TEXT("Insert %d shuffled keyframes: std::set %.3fs, flat %.3fs"), NumKeyframes,
+		SetInsertTime, FlatInsertTime));
+
+	// Set iterators are only bidirectional: each lookup is linear, so only sample a few times.
+	constexpr int NumSetLookups = 1000;
+	StartTime = FPlatformTime::Seconds();
+	size_t Checksum = 0;
+	for (int i = 0; i < NumSetLookups; ++i)
+		Checksum += SetBasedLowerBound(SetBased, (i + 0.5) * NumKeyframes / NumSetLookups);
+	double const SetLookupTime = (FPlatformTime::Seconds() - StartTime) / NumSetLookups;
+
+	// Playback: increasing times, in small steps.
+	constexpr int NumPlaybackLookups = 10 * NumKeyframes;
+	StartTime = FPlatformTime::Seconds();
+	for (int i = 0; i < NumPlaybackLookups; ++i)
+	{
+		Checksum += Timeline.GetStateAtTime((i + 0.5) * NumKeyframes / NumPlaybackLookups,
+			StateAtEntryTimeBehavior::UseLeftInterval, nullptr) ? 1 : 0;
+	}
+	double const PlaybackLookupTime = (FPlatformTime::Seconds() - StartTime) / NumPlaybackLookups;
+
+	// Scrubbing: random times, the cursor does not help.
+	constexpr int NumScrubLookups = NumKeyframes;
+	StartTime = FPlatformTime::Seconds();
+	for (int i = 0; i < NumScrubLookups; ++i)
+	{
+		Checksum += Timeline.GetStateAtTime(Random.FRandRange(-1., NumKeyframes),
+			StateAtEntryTimeBehavior::UseLeftInterval, nullptr) ? 1 : 0;
+	}
+	double const ScrubLookupTime = (FPlatformTime::Seconds() - StartTime) / NumScrubLookups;
+	AddInfo(FString::Printf(TEXT("Lookup in %d keyframes: std::set %.2fus, flat (playback) %.3fus, "
+		"flat (scrubbing) %.3fus (checksum %llu)"), NumKeyframes, 1e6 * SetLookupTime,
+		1e6 * PlaybackLookupTime, 1e6 * ScrubLookupTime, (unsigned long long)Checksum));
+
+	// Check the results against the set, alternating increasing times (cursor), exact keyframe times and
+	// random times.
+	for (int i = 0; i < NumSetLookups; ++i)
+	{
+		double const Time = (i % 3 == 0) ? (i * 0.25)
+			: ((i % 3 == 1) ? double(Random.RandRange(0, NumKeyframes - 1)) : Random.FRandRange(-1., NumKeyframes));
+		size_t const Expected = SetBasedLowerBound(SetBased, Time);
+		if (!TestEqual("Same lower bound", Timeline.Values.LowerBound(Time), Expected))
+			return false;
+		auto const State = Timeline.GetStateAtTime(Time, StateAtEntryTimeBehavior::UseLeftInterval, nullptr);
+		UTEST_TRUE("Has state", State.has_value());
+		if (Expected < SetBased.size() && Expected > 0 && Time != Timeline.Values[Expected].Time)
+		{
+			auto const& Entry0 = Timeline.Values[Expected - 1];
+			auto const& Entry1 = Timeline.Values[Expected];
+			float const u = float((Time - Entry0.Time) / (Entry1.Time - Entry0.Time));
+			TestTrue("Interpolated value", AreApproxEqualGeneric(State->test_value_,
+				Entry0.test_value_ * (1.f - u) + Entry1.test_value_ * u));
+		}
+	}
+
+	// Batch evaluation gives the same results as individual calls.
+	std::vector<PropertyTimeline<Test_Visibility>> Timelines(3);
+	Timelines[0] = Timeline;
+	Timelines[2].Values.insert(Timeline.Values[10]);
+	std::vector<PropertyTimeline<Test_Visibility> const*> TimelinePtrs;
+	for (auto const& T : Timelines)
+		TimelinePtrs.push_back(&T);
+	std::vector<std::optional<Test_Visibility>> States(Timelines.size());
+	PropertyTimeline<Test_Visibility>::GetStatesAtTime(TimelinePtrs, 1234.5,
+		StateAtEntryTimeBehavior::UseLeftInterval, nullptr, States);
+	for (size_t i = 0; i < Timelines.size(); ++i)
+	{
+		TestTrue("Same batch state", AreApproxEqualGeneric(States[i],
+			Timelines[i].GetStateAtTime(1234.5, StateAtEntryTimeBehavior::UseLeftInterval, nullptr)));
+	}
+	return true;
+}
+
 // No I/O (yet?) in ITwinRuntime
 //
 //IMPLEMENT_SIMPLE_AUTOMATION_TEST(TestReadWrite, "Bentley.ITwinForUnreal.ITwinRuntime.Timeline", \
@@ -0,0 +1,337 @@
+/*--------------------------------------------------------------------------------------+
+|
+|     $Source: TimeOrderedEntries.h $
+|
+|  $Copyright: (c) 2026 Bentley Systems, Incorporated. All rights reserved. $
+|
++--------------------------------------------------------------------------------------*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ITwin::Timeline
+{
+
+//! Keyframes of a PropertyTimeline, ordered by time. Replaces the std::set we used to have, which made each
+//! lookup walk the nodes one by one (set iterators are only bidirectional) and allocated each entry separately.
+//! - Keyframe times are stored in a flat sorted array, apart from the keyframes themselves, so that searching
+//!   for a time only touches contiguous doubles.
+//! - The index found by the last search is remembered, so that evaluating the timeline at increasing times,
+//!   which is what happens during playback, does not need to search at all most of the time.
+//! - Keyframes are stored in chunks of growing size and never move once added: references returned by
+//!   insert() remain valid until clear() or destruction (see ElementTimelineEx::SetTransformationAt, whose
+//!   result is referenced by cutting plane keyframes).
+//! - Entries added in chronological order are appended at once. The others are appended to a pending list,
+//!   which is sorted and merged with the sorted entries only once, on the next read access: keyframes are
+//!   often loaded in random order, and inserting each of them at its place in the arrays would cost O(N^2).
+//!   Several threads can read concurrently (the first one merges the pending entries), but not while another
+//!   thread adds or removes entries.
+//! Like with std::set, inserting an entry with the same time as an existing entry does nothing.
+template<class _Entry>
+class TimeOrderedEntries
+{
+	using FSortedEntries = std::vector<_Entry const*>;
+
+public:
+	class const_iterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = _Entry;
+		using difference_type = std::ptrdiff_t;
+		using pointer = _Entry const*;
+		using reference = _Entry const&;
+
+		const_iterator() = default;
+		explicit const_iterator(typename FSortedEntries::const_iterator const InIt) : It(InIt) {}
+
+		reference operator*() const { return **It; }
+		pointer operator->() const { return *It; }
+		reference operator[](difference_type const N) const { return *It[N]; }
+		const_iterator& operator++() { ++It; return *this; }
+		const_iterator operator++(int) { return const_iterator(It++); }
+		const_iterator& operator--() { --It; return *this; }
+		const_iterator operator--(int) { return const_iterator(It--); }
+		const_iterator& operator+=(difference_type const N) { It += N; return *this; }
+		const_iterator& operator-=(difference_type const N) { It -= N; return *this; }
+		const_iterator operator+(difference_type const N) const { return const_iterator(It + N); }
+		const_iterator operator-(difference_type const N) const { return const_iterator(It - N); }
+		friend const_iterator operator+(difference_type const N, const_iterator const& X) { return X + N; }
+		difference_type operator-(const_iterator const& Other) const { return It - Other.It; }
+		bool operator==(const_iterator const& Other) const = default;
+		auto operator<=>(const_iterator const& Other) const = default;
+
+	private:
+		typename FSortedEntries::const_iterator It;
+	};
+	using iterator = const_iterator;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+	using reverse_iterator = const_reverse_iterator;
+	using value_type = _Entry;
+	using size_type = size_t;
+
+	TimeOrderedEntries() = default;
+	TimeOrderedEntries(TimeOrderedEntries const& Other) { *this = Other; }
+	TimeOrderedEntries(TimeOrderedEntries&& Other) noexcept { *this = std::move(Other); }
+	TimeOrderedEntries& operator=(TimeOrderedEntries const& Other);
+	TimeOrderedEntries& operator=(TimeOrderedEntries&& Other) noexcept;
+
+	[[nodiscard]] bool empty() const { return size() == 0; }
+	[[nodiscard]] size_t size() const { MergePending(); return SortedTimes.size(); }
+	[[nodiscard]] const_iterator begin() const { MergePending(); return const_iterator(SortedEntries.cbegin()); }
+	[[nodiscard]] const_iterator end() const { MergePending(); return const_iterator(SortedEntries.cend()); }
+	[[nodiscard]] const_iterator cbegin() const { return begin(); }
+	[[nodiscard]] const_iterator cend() const { return end(); }
+	[[nodiscard]] const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	[[nodiscard]] const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+	[[nodiscard]] _Entry const& front() const { MergePending(); return *SortedEntries.front(); }
+	[[nodiscard]] _Entry const& back() const { MergePending(); return *SortedEntries.back(); }
+	[[nodiscard]] _Entry const& operator[](size_t const Index) const { MergePending(); return *SortedEntries[Index]; }
+	//! Times of all entries, in increasing order.
+	[[nodiscard]] std::span<double const> Times() const { MergePending(); return SortedTimes; }
+
+	//! Adds an entry, unless there is already one at the same time.
+	//! \return The entry stored for this time: the new entry, or the existing one. When both were added out of
+	//!		order, the duplicate is only detected when merging them, and the returned entry then becomes a copy
+	//!		of the existing one.
+	_Entry const& insert(_Entry const& Entry) { return Emplace(Entry); }
+	_Entry const& insert(_Entry&& Entry) { return Emplace(std::move(Entry)); }
+	//! Removes the last entry (in time order). Its storage is reclaimed if it was the last entry stored.
+	void pop_back();
+	void clear();
+
+	//! Index of the first entry which time is not less than Time (like std::lower_bound), or size().
+	[[nodiscard]] size_t LowerBound(double const Time) const { return FindBound<false>(Time); }
+	//! Index of the first entry which time is greater than Time (like std::upper_bound), or size().
+	[[nodiscard]] size_t UpperBound(double const Time) const { return FindBound<true>(Time); }
+
+private:
+	template<class _EntryRef> _Entry const& Emplace(_EntryRef&& Entry);
+	template<bool bUpper> size_t FindBound(double const Time) const;
+	//! Sorts the pending entries and merges them into the sorted arrays, if needed.
+	void MergePending() const
+	{
+		if (MergeState.load(std::memory_order_acquire) != EMergeState::Sorted)
+			MergePendingSlow();
+	}
+	void MergePendingSlow() const;
+	_Entry& NewSlot();
+
+	//! Size of the first chunk of Storage, the next ones are each twice as large as the previous one.
+	static constexpr size_t FirstChunkSize = 2;
+
+	//! Mutable because the pending entries are merged on the first read access (see MergePending).
+	mutable std::vector<double> SortedTimes;
+	//! Pointers to the entries (in Storage), in the same order as SortedTimes.
+	mutable FSortedEntries SortedEntries;
+	//! Entries added out of order and not merged yet, in insertion order.
+	mutable std::vector<_Entry*> PendingEntries;
+	enum EMergeState : uint8_t { Sorted, Pending, Merging };
+	mutable std::atomic<uint8_t> MergeState = EMergeState::Sorted;
+	std::vector<std::unique_ptr<_Entry[]>> Storage;
+	//! Number of slots in, and number of slots used in the last chunk of Storage.
+	size_t LastChunkSize = 0, UsedInLastChunk = 0;
+	//! Result of the last search: this is only a hint, hence the relaxed atomic, which allows concurrent
+	//! evaluations of the same timeline.
+	mutable std::atomic<uint32_t> Cursor = 0;
+};
+
+template<class _Entry>
+TimeOrderedEntries<_Entry>& TimeOrderedEntries<_Entry>::operator=(TimeOrderedEntries const& Other)
+{
+	if (this == &Other)
+		return *this;
+	clear();
+	if (!Other.empty()) // note: this merges the pending entries of Other
+	{
+		// Copy all entries to a single chunk.
+		Storage.emplace_back(new _Entry[Other.size()]);
+		LastChunkSize = UsedInLastChunk = Other.size();
+		SortedTimes = Other.SortedTimes;
+		SortedEntries.resize(Other.size());
+		for (size_t i = 0; i < Other.size(); ++i)
+		{
+			Storage.back()[i] = Other[i];
+			SortedEntries[i] = &Storage.back()[i];
+		}
+	}
+	Cursor.store(Other.Cursor.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	return *this;
+}
+
+template<class _Entry>
+TimeOrderedEntries<_Entry>& TimeOrderedEntries<_Entry>::operator=(TimeOrderedEntries&& Other) noexcept
+{
+	if (this == &Other)
+		return *this;
+	// Moving the chunks does not move the entries, so the pointers in SortedEntries remain valid.
+	SortedTimes = std::move(Other.SortedTimes);
+	SortedEntries = std::move(Other.SortedEntries);
+	PendingEntries = std::move(Other.PendingEntries);
+	MergeState.store(Other.MergeState.exchange(EMergeState::Sorted, std::memory_order_acq_rel),
+		std::memory_order_release);
+	Storage = std::move(Other.Storage);
+	LastChunkSize = std::exchange(Other.LastChunkSize, 0);
+	UsedInLastChunk = std::exchange(Other.UsedInLastChunk, 0);
+	Cursor.store(Other.Cursor.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	Other.clear();
+	return *this;
+}
+
+template<class _Entry>
+_Entry& TimeOrderedEntries<_Entry>::NewSlot()
+{
+	if (UsedInLastChunk == LastChunkSize)
+	{
+		LastChunkSize = Storage.empty() ? FirstChunkSize : (2 * LastChunkSize);
+		Storage.emplace_back(new _Entry[LastChunkSize]);
+		UsedInLastChunk = 0;
+	}
+	return Storage.back()[UsedInLastChunk++];
+}
+
+template<class _Entry>
+template<class _EntryRef>
+_Entry const& TimeOrderedEntries<_Entry>::Emplace(_EntryRef&& Entry)
+{
+	double const Time = Entry.Time;
+	// Entries are usually added in chronological order: append them directly in that case.
+	if (PendingEntries.empty() && (SortedTimes.empty() || SortedTimes.back() < Time))
+	{
+		_Entry& Stored = NewSlot();
+		Stored = std::forward<_EntryRef>(Entry);
+		SortedTimes.push_back(Time);
+		SortedEntries.push_back(&Stored);
+		return Stored;
+	}
+	// Cheap check for duplicates among the sorted entries (duplicates among pending entries are only
+	// detected when merging).
+	auto const TimeIt = std::lower_bound(SortedTimes.begin(), SortedTimes.end(), Time);
+	if (TimeIt != SortedTimes.end() && *TimeIt == Time)
+		return *SortedEntries[TimeIt - SortedTimes.begin()];
+	_Entry& Stored = NewSlot();
+	Stored = std::forward<_EntryRef>(Entry);
+	PendingEntries.push_back(&Stored);
+	MergeState.store(EMergeState::Pending, std::memory_order_release);
+	return Stored;
+}
+
+template<class _Entry>
+void TimeOrderedEntries<_Entry>::MergePendingSlow() const
+{
+	uint8_t State = EMergeState::Pending;
+	if (!MergeState.compare_exchange_strong(State, EMergeState::Merging, std::memory_order_acquire))
+	{
+		// Another reader is merging: wait for it.
+		while (MergeState.load(std::memory_order_acquire) != EMergeState::Sorted)
+			std::this_thread::yield();
+		return;
+	}
+	// Stable sort: among pending entries with the same time, the first one added wins.
+	std::stable_sort(PendingEntries.begin(), PendingEntries.end(),
+		[](_Entry const* A, _Entry const* B) { return A->Time < B->Time; });
+	std::vector<double> MergedTimes;
+	FSortedEntries MergedEntries;
+	MergedTimes.reserve(SortedTimes.size() + PendingEntries.size());
+	MergedEntries.reserve(SortedTimes.size() + PendingEntries.size());
+	size_t SortedIdx = 0;
+	for (_Entry* Pending : PendingEntries)
+	{
+		for (; SortedIdx < SortedTimes.size() && SortedTimes[SortedIdx] < Pending->Time; ++SortedIdx)
+		{
+			MergedTimes.push_back(SortedTimes[SortedIdx]);
+			MergedEntries.push_back(SortedEntries[SortedIdx]);
+		}
+		if (!MergedTimes.empty() && MergedTimes.back() == Pending->Time)
+		{
+			// Duplicate of a pending entry added before: the reference returned by insert() must remain
+			// usable, so make it a copy of the entry kept.
+			*Pending = *MergedEntries.back();
+			continue;
+		}
+		// (Duplicates of sorted entries were already rejected by Emplace.)
+		MergedTimes.push_back(Pending->Time);
+		MergedEntries.push_back(Pending);
+	}
+	MergedTimes.insert(MergedTimes.end(), SortedTimes.begin() + SortedIdx, SortedTimes.end());
+	MergedEntries.insert(MergedEntries.end(), SortedEntries.begin() + SortedIdx, SortedEntries.end());
+	SortedTimes = std::move(MergedTimes);
+	SortedEntries = std::move(MergedEntries);
+	PendingEntries.clear();
+	PendingEntries.shrink_to_fit();
+	Cursor.store(0, std::memory_order_relaxed);
+	MergeState.store(EMergeState::Sorted, std::memory_order_release);
+}
+
+template<class _Entry>
+void TimeOrderedEntries<_Entry>::pop_back()
+{
+	MergePending();
+	_Entry const* const Last = SortedEntries.back();
+	SortedTimes.pop_back();
+	SortedEntries.pop_back();
+	// Entries never move, so only the last slot used can be given back.
+	if (UsedInLastChunk > 0 && Last == &Storage.back()[UsedInLastChunk - 1])
+	{
+		Storage.back()[--UsedInLastChunk] = _Entry{};
+		if (UsedInLastChunk == 0)
+		{
+			Storage.pop_back();
+			LastChunkSize = Storage.empty() ? 0 : (LastChunkSize / 2);
+			UsedInLastChunk = LastChunkSize;
+		}
+	}
+}
+
+template<class _Entry>
+void TimeOrderedEntries<_Entry>::clear()
+{
+	SortedTimes.clear();
+	SortedEntries.clear();
+	PendingEntries.clear();
+	MergeState.store(EMergeState::Sorted, std::memory_order_release);
+	Storage.clear();
+	LastChunkSize = UsedInLastChunk = 0;
+	Cursor.store(0, std::memory_order_relaxed);
+}
+
+template<class _Entry>
+template<bool bUpper>
+size_t TimeOrderedEntries<_Entry>::FindBound(double const Time) const
+{
+	MergePending();
+	size_t const Num = SortedTimes.size();
+	auto const IsBefore = [Time](double const EntryTime)
+		{ return bUpper ? (EntryTime <= Time) : (EntryTime < Time); };
+	// Index is the bound if all entries before it are before Time, and the others are not.
+	auto const IsBound = [&](size_t const Index)
+		{
+			return (Index == 0 || IsBefore(SortedTimes[Index - 1]))
+				&& (Index == Num || !IsBefore(SortedTimes[Index]));
+		};
+	size_t Index = std::min<size_t>(Cursor.load(std::memory_order_relaxed), Num);
+	if (!IsBound(Index))
+	{
+		// During playback, time is most often still in the same interval, or has moved on to the next one.
+		if (Index < Num && IsBound(Index + 1))
+			++Index;
+		else if constexpr (bUpper)
+			Index = std::upper_bound(SortedTimes.begin(), SortedTimes.end(), Time) - SortedTimes.begin();
+		else
+			Index = std::lower_bound(SortedTimes.begin(), SortedTimes.end(), Time) - SortedTimes.begin();
+		Cursor.store(static_cast<uint32_t>(Index), std::memory_order_relaxed);
+	}
+	return Index;
+}
+
+} // namespace ITwin::Timeline
@@ -213,7 +213,7 @@ PTransform const& ElementTimelineEx::SetTransformationAt(double const Time, FVec
 	Entry.Position = InPosition;
 	Entry.Rotation = InRotation;
 	Entry.DefrdAnchor = DefrdAnchor;
-	return *Transform.Values.insert(Entry).first;
+	return Transform.Values.insert(Entry);
 }
 
 void ElementTimelineEx::SetTransformationDisabledAt(double const Time, EInterpolation const Interp)
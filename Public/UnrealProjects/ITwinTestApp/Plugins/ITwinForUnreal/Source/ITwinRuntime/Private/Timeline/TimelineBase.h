@@ -10,15 +10,19 @@
 
 #include "CoreMinimal.h"
 #include <Timeline/TimeInSeconds.h>
+#include <Timeline/TimeOrderedEntries.h>
 
 #include <Compil/BeforeNonUnrealIncludes.h>
 	#include <BeHeaders/Compil/Attributes.h>
 	#include <BeHeaders/Util/Enumerations.h>
+	#include <BeUtils/Misc/IntervalIndex.h>
 #include <Compil/AfterNonUnrealIncludes.h>
 
 #include <limits>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <unordered_set>
 
 class FJsonObject;
@@ -92,11 +96,9 @@ class PropertyTimeline
 {
 public:
 	using PropertyValues = _PropertyValues;
-	//! Property keyframes, ordered by PropertyEntryBase::Time. Using an std::set to have them naturally
-	//! ordered (since there is no guarantee they are added in chronological order), but for efficiency
-	//! it might be a good idea(?) to use a mere std::list and a fast_pool_allocator (TODO_GCO) since
-	//! timelines have usually very few keyframes (2-3!).
-	using FTimeOrderedProperties = std::set<PropertyEntry<_PropertyValues>>;
+	//! Property keyframes, ordered by PropertyEntryBase::Time (there is no guarantee they are added in
+	//! chronological order). See TimeOrderedEntries about the layout and the lookup "cursor".
+	using FTimeOrderedProperties = TimeOrderedEntries<PropertyEntry<_PropertyValues>>;
 	FTimeOrderedProperties Values;
 	//! Removes duplicate, useless entries that may exist at the end of the list.
 	void Prune();
@@ -105,6 +107,19 @@ public:
 	//! Returns the interpolated property values at the given time.
 	[[nodiscard]] std::optional<_PropertyValues> GetStateAtTime(double time,
 		StateAtEntryTimeBehavior entryTimeBehavior, void* userData) const;
+	//! Evaluates several timelines at the same time, eg. the same property of all the Elements animated
+	//! in a tick: OutStates[i] receives Timelines[i]->GetStateAtTime(time, entryTimeBehavior, userData).
+	//! The keyframe lookups are done for all timelines before interpolating, so that the sequence of
+	//! (cheap, cursor-assisted) searches is not interleaved with the interpolation code.
+	static void GetStatesAtTime(std::span<PropertyTimeline const* const> Timelines, double time,
+		StateAtEntryTimeBehavior entryTimeBehavior, void* userData,
+		std::span<std::optional<_PropertyValues>> OutStates);
+
+private:
+	//! Returns the interpolated property values at the given time, given the index of the first entry
+	//! not before (UseLeftInterval) or after (UseRightInterval) time.
+	[[nodiscard]] std::optional<_PropertyValues> GetStateAtIndex(double time, size_t entryIndex,
+		void* userData) const;
 };
 
 template<class _Base, class _ObjectState>
@@ -154,11 +169,23 @@ public:
 	void IncludeTimeRange(const FTimeRangeInSeconds& CustomRange);
 	ObjectTimelinePtr const& AddTimeline(const ObjectTimelinePtr& object);
 
+	//! Builds the index of the time ranges of the timelines used by GetTimelinesInTimeRange. Must be called
+	//! again when timelines have been added, or when keyframes have been added to existing timelines
+	//! (removing keyframes is harmless, it will only make GetTimelinesInTimeRange return too many timelines).
+	void FinalizeTimeIndex();
+	[[nodiscard]] bool HasTimeIndex() const { return bHasTimeIndex; }
+	//! Appends to Out the indices (in the container) of the timelines whose time range intersects Range,
+	//! in increasing order: the state of the other timelines is the same at Range.first and Range.second.
+	//! Requires FinalizeTimeIndex to have been called.
+	void GetTimelinesInTimeRange(FTimeRangeInSeconds const& Range, std::vector<uint32_t>& Out) const;
+
 protected:
 	TimelineObjectContainer Container;
 
 private:
 	FTimeRangeInSeconds TimeRange = ITwin::Time::InitForMinMax();
+	BeUtils::IntervalIndex TimeIndex;
+	bool bHasTimeIndex = false;
 };
 
 } // namespace ITwin::Timeline
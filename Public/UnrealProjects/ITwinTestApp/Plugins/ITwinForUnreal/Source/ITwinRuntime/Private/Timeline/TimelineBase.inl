@@ -37,13 +37,13 @@ void PropertyTimeline<_PropertyValues>::Prune()
 	// for the user, because he expects to see the same dates as in Synchro.
 	std::optional<PropertyEntry<_PropertyValues>> lastEntry;
 	while (Values.size() >= 2 &&
-		static_cast<_PropertyValues const&>(*Values.rbegin())
-			== static_cast<_PropertyValues const&>(*(++Values.rbegin())))
+		static_cast<_PropertyValues const&>(Values[Values.size() - 1])
+			== static_cast<_PropertyValues const&>(Values[Values.size() - 2]))
 	{
 		// Remember last entry.
 		if (!lastEntry)
-			lastEntry = std::move(*Values.rbegin());
-		Values.erase(--Values.end());
+			lastEntry = Values.back();
+		Values.pop_back();
 	}
 	// If last entry has been removed, restore it.
 	if (lastEntry)
@@ -64,25 +64,53 @@ std::optional<_PropertyValues> PropertyTimeline<_PropertyValues>::GetStateAtTime
 {
 	if (Values.empty())
 		return {};
-	// "auto entryIt" resolves to a std::forward_iterator (at least in VS2022 17.8.5) and fails to compile,
-	// because we need a std::bidirectional_iterator, which std::set::[const_]iterator actually is...!
-	//const auto entryIt = ...
-	typename FTimeOrderedProperties::const_iterator entryIt =
+	return GetStateAtIndex(time,
 		(entryTimeBehavior == StateAtEntryTimeBehavior::UseLeftInterval)
-		? std::lower_bound(Values.cbegin(), Values.cend(), time,
-						   [](const auto& x, double y) { return x.Time < y; })
-		: std::upper_bound(Values.cbegin(), Values.cend(), time,
-						   [](double x, auto const& y) { return x < y.Time; });
-	if (entryIt == Values.cbegin())
-		return *entryIt;
-	if (entryIt == Values.cend())
-		return *Values.rbegin();
-	const auto& entry1 = *(entryIt);
+			? Values.LowerBound(time) : Values.UpperBound(time),
+		userData);
+}
+
+template<class _PropertyValues>
+/*static*/ void PropertyTimeline<_PropertyValues>::GetStatesAtTime(
+	std::span<PropertyTimeline const* const> Timelines, double time,
+	StateAtEntryTimeBehavior entryTimeBehavior, void* userData,
+	std::span<std::optional<_PropertyValues>> OutStates)
+{
+	check(Timelines.size() == OutStates.size());
+	static constexpr size_t NoEntry = std::numeric_limits<size_t>::max();
+	std::vector<size_t> entryIndices(Timelines.size(), NoEntry);
+	for (size_t i = 0; i < Timelines.size(); ++i)
+	{
+		auto const& Values = Timelines[i]->Values;
+		if (!Values.empty())
+		{
+			entryIndices[i] = (entryTimeBehavior == StateAtEntryTimeBehavior::UseLeftInterval)
+				? Values.LowerBound(time) : Values.UpperBound(time);
+		}
+	}
+	for (size_t i = 0; i < Timelines.size(); ++i)
+	{
+		if (entryIndices[i] == NoEntry)
+			OutStates[i].reset();
+		else
+			OutStates[i] = Timelines[i]->GetStateAtIndex(time, entryIndices[i], userData);
+	}
+}
+
+template<class _PropertyValues>
+std::optional<_PropertyValues> PropertyTimeline<_PropertyValues>::GetStateAtIndex(double time,
+	size_t entryIndex, void* userData) const
+{
+	if (entryIndex == 0)
+		return Values.front();
+	if (entryIndex == Values.size())
+		return Values.back();
+	const auto& entry1 = Values[entryIndex];
 	if (time == entry1.Time)
 		return entry1;
 	// TODO_GCO: contradicting the purpose of StateAtEntryTimeBehavior here, because it feels so nonsensical!
 	// Remove StateAtEntryTimeBehavior entirely unless a good reason is found for such a behavior (see enum doc)
-	const auto& entry0 = *(--entryIt);
+	const auto& entry0 = Values[entryIndex - 1];
 	if (time == entry0.Time)
 		return entry0;
 	switch (entry0.Interpolation)
@@ -140,8 +168,8 @@ FTimeRangeInSeconds ObjectTimeline<_Metadata>::GetTimeRange() const
 		{
 			if (propertyTimeline.Values.empty())
 				return;
-			timeRange.first = std::min(timeRange.first, propertyTimeline.Values.begin()->Time);
-			timeRange.second = std::max(timeRange.second, propertyTimeline.Values.rbegin()->Time);
+			timeRange.first = std::min(timeRange.first, propertyTimeline.Values.front().Time);
+			timeRange.second = std::max(timeRange.second, propertyTimeline.Values.back().Time);
 		});
 	return timeRange;
 }
@@ -246,4 +274,27 @@ std::shared_ptr<_ObjectTimeline> const& MainTimelineBase<_ObjectTimeline>::AddTi
 	return Container.back();
 }
 
+template<class _ObjectTimeline>
+void MainTimelineBase<_ObjectTimeline>::FinalizeTimeIndex()
+{
+	std::vector<BeUtils::IntervalIndex::Interval> Intervals;
+	Intervals.reserve(Container.size());
+	for (size_t Index = 0; Index < Container.size(); ++Index)
+	{
+		auto const ObjectTimeRange = Container[Index]->GetTimeRange();
+		// Empty timelines have an empty range (see InitForMinMax), which the index ignores.
+		Intervals.push_back({ ObjectTimeRange.first, ObjectTimeRange.second, static_cast<uint32_t>(Index) });
+	}
+	TimeIndex.Build(std::move(Intervals));
+	bHasTimeIndex = true;
+}
+
+template<class _ObjectTimeline>
+void MainTimelineBase<_ObjectTimeline>::GetTimelinesInTimeRange(FTimeRangeInSeconds const& Range,
+	std::vector<uint32_t>& Out) const
+{
+	check(bHasTimeIndex);
+	TimeIndex.Query(Range.first, Range.second, Out);
+}
+
 } // namespace ITwin::Timeline
@@ -18,6 +18,9 @@ public:
 	//! ITwinForUnreal plugin.
 	static void CommonStartup(const FString& ModuleName);
 
+	//! Counterpart of CommonStartup, to be called when the iTwinRuntime module is shut down.
+	static void CommonShutdown();
+
 	//! Propose to attach the debugger if applicable (restricted to development/debug builds).
 	static void ProposeAttachDebugger(const FString& ContextInfo = {});
 
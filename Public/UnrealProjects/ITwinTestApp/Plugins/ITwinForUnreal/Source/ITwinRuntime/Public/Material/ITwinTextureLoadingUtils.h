@@ -19,6 +19,7 @@
 #include <ITwinRuntime/Private/Compil/AfterNonUnrealIncludes.h>
 
 #include <filesystem>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -38,12 +39,24 @@ namespace BeUtils {
 
 namespace ITwin
 {
+	//! Resolves the textures used by the given iModels: textures located on disk are read at once, whereas
+	//! decoration textures are downloaded without blocking the caller. The material helpers must not be
+	//! locked by the caller (each one is only locked while its images are stored).
+	//! \param onResolved Called once all textures are stored, in the thread completing the download.
+	//!		Failures are logged, and do not prevent the materials from being loaded.
+	void ResolveDecorationTexturesAsync(
+		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
+		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
+		std::map<std::string, BeUtils::GltfMaterialHelperPtr> const& imodelToMatHelper,
+		bool bResolveLocalDiskTextures,
+		std::function<void()>&& onResolved);
+
+	//! Same as ResolveDecorationTexturesAsync, but waits for the textures to be stored.
 	bool ResolveDecorationTextures(
 		AdvViz::SDK::MaterialPersistenceManager& matPersistenceMngr,
 		AdvViz::SDK::PerIModelTextureSet const& perModelTextures,
 		std::map<std::string, BeUtils::GltfMaterialHelperPtr> const& imodelToMatHelper,
-		bool bResolveLocalDiskTextures = false,
-		BeUtils::WLock const* pLock = nullptr);
+		bool bResolveLocalDiskTextures = false);
 
 	UTexture2D* ResolveAsUnrealTexture(
 		BeUtils::GltfMaterialHelper& GltfMatHelper,
@@ -33,7 +33,7 @@ public:
 	FUESplineCurve(USplineComponent const& InSpline);
 	virtual glm::dvec3 GetPositionAtCoord(value_type const& u) const override;
 	virtual glm::dvec3 GetTangentAtCoord(value_type const& u) const override;
-	virtual size_t PointCount(const bool /*accountForCyclicity*/) const override;
+	virtual size_t PointCount(const bool accountForCyclicity) const override;
 	virtual glm::dvec3 GetPositionAtIndex(size_t idx) const override;
 	virtual bool IsCyclic() const override;
 
@@ -36,6 +36,11 @@ class ACesiumCartographicPolygon;
 class ACesiumGeoreference;
 class FITwinTilesetAccess;
 
+namespace BeUtils
+{
+	class SplineHelper;
+}
+
 
 //! This class is used to edit a spline.
 //! It handles the synchronization of points between a USplineComponent (to which instances
@@ -62,6 +67,11 @@ public:
 	//! Returns the USplineMeshComponent of this spline helper.
 	USplineComponent* GetSplineComponent() const { return SplineComponent.Get(); }
 
+	//! Returns the helper used to sample the spline component (in world coordinates). It is kept with
+	//! the spline so that its arc-length tables are only updated around the edited points.
+	//! The spline component must be valid.
+	BeUtils::SplineHelper const& GetSamplingHelper() const;
+
 	//! Returns the AdvViz::SDK::ISpline of this spline helper.
 	AdvViz::SDK::ISplinePtr GetAVizSpline() const;
 
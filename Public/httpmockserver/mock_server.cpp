@@ -33,6 +33,9 @@ class MockServer::Server {
     /// MicroHTTPD server instance.
     std::unique_ptr<MHD_Daemon, void(*)(MHD_Daemon*)> daemon;
   public:
+    /// Whether each connection is served in its own thread.
+    bool threadPerConnection = false;
+
     /// Initialize server with no daemon running.
     explicit Server(MockServer &mock)
       : mock(mock), daemon(nullptr, &MHD_stop_daemon)
@@ -50,7 +53,10 @@ class MockServer::Server {
             throw std::runtime_error("Invalid port for MockServer!");
         }
         daemon.reset(MHD_start_daemon(
-                MHD_USE_SELECT_INTERNALLY, (uint16_t)port, NULL, NULL,
+                threadPerConnection
+                    ? (MHD_USE_THREAD_PER_CONNECTION | MHD_USE_SELECT_INTERNALLY)
+                    : MHD_USE_SELECT_INTERNALLY,
+                (uint16_t)port, NULL, NULL,
                 &static_handlerCallback, this, MHD_OPTION_END));
 
         if (!daemon) {
@@ -150,6 +156,14 @@ int MockServer::getPort() const {
 }
 
 
+void MockServer::setThreadPerConnection(bool threadPerConnection) {
+    if (server->isRunning()) {
+        throw std::runtime_error("MockServer has been already started!");
+    }
+    server->threadPerConnection = threadPerConnection;
+}
+
+
 template <typename T>
 struct KeyValueIteratorTrait {
     static const MHD_ValueKind arg_kind
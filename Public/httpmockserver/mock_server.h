@@ -70,6 +70,13 @@ class MockServer: public IMockServer {
     /// Return port number server is running on.
     int getPort() const;
   protected:
+    /**
+     * Serve each connection in its own thread, so that concurrent requests
+     * are handled in parallel (eg. when responseHandler() simulates latency).
+     * Must be called before the server is started.
+     */
+    void setThreadPerConnection(bool threadPerConnection);
+
     /// Key-Value storage
     struct KeyValue {
         std::string key;